@@ -17,6 +17,8 @@ Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
     #define _ADORAD_
 #endif // _ADORAD_
 
+// The compiler uses the hash functions (see compiler/incremental.c)
+#define CORETEN_INCLUDE_HASH_H
 #define CORETEN_IMPL
     #include <adorad/core/adcore.h>
 #undef CORETEN_IMPL
@@ -26,3 +28,19 @@ Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
 #include <adorad/compiler/lexer.h>
 #include <adorad/compiler/ast.h>
 #include <adorad/compiler/parser.h>
+#include <adorad/compiler/checker.h>
+#include <adorad/compiler/module.h>
+#include <adorad/compiler/incremental.h>
+#include <adorad/compiler/cgen.h>
+#include <adorad/compiler/ir.h>
+#include <adorad/compiler/opt.h>
+#include <adorad/compiler/comptime.h>
+#include <adorad/compiler/vm.h>
+#include <adorad/compiler/x64.h>
+#include <adorad/runtime/tensor.h>
+#include <adorad/runtime/matmul.h>
+#include <adorad/runtime/sort.h>
+#include <adorad/runtime/vmath.h>
+#include <adorad/runtime/hypercomplex.h>
+#include <adorad/runtime/map.h>
+#include <adorad/runtime/format.h>
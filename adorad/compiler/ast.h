@@ -18,6 +18,7 @@ Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
 #include <adorad/core/vector.h>
 #include <adorad/compiler/location.h>
 #include <adorad/compiler/tokens.h>
+#include <adorad/compiler/types.h>
 
 typedef struct AstNode AstNode;
 typedef enum AstNodeKind AstNodeKind;
@@ -108,6 +109,7 @@ typedef struct {
 } AstNodeAttribute;
 
 typedef struct {
+    Buff* name;
     AstNode* type;
     bool is_const;
     bool is_mutable;
@@ -545,6 +547,13 @@ typedef struct {
     Buff* value;
 } AstNodeCharLiteral;
 
+// A piece of a format string: literal text, then a hole (except for the last piece)
+typedef struct {
+    Buff* text;        // as spelled (escape sequences unresolved), with `{{` and `}}` already folded
+    AstNode* expr;     // null for the text after the last hole
+    Buff* spec;        // what comes after the `:` of the hole (null if there isn't one)
+} AstNodeFormatPart;
+
 typedef struct {
     Buff* value;
     bool is_special;   // format / raw string
@@ -553,6 +562,7 @@ typedef struct {
         AstNodeStringLiteralRaw,    // `r"abc"`
         AstNodeStringLiteralFormat  // `f"name = {name}"`
     } type;
+    Vec* parts;        // of `AstNodeFormatPart`, for a format string
 } AstNodeStringLiteral;
 
 // This can be one of:
@@ -642,6 +652,7 @@ typedef enum {
     PrefixOpKindInvalid,
     PrefixOpKindBoolNot,   // KEYWORD(not)
     PrefixOpKindNegation,  // !var
+    PrefixOpKindMinus,     // -var
     PrefixOpKindAddrOf,    // &var
     PrefixOpKindOptional,  // ?
 } PrefixOpKind;
@@ -669,6 +680,7 @@ typedef struct {
     Token* allow_zero_token;
     bool is_const;
     bool is_volatile;
+    bool is_tensor;     // `Tensor<child_type, size>`: `size` is the rank
 } AstNodeArrayType;
 
 typedef struct {
@@ -683,6 +695,7 @@ typedef struct {
 struct AstNode {
     AstNodeKind kind; // type of AST Node
     Loc* loc;
+    TypeId type;      // resolved type (set by the checker; TYPE_ID_NONE until then)
 
     union {
         AstNodeIdentifier* identifier;
@@ -0,0 +1,1502 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <adorad/compiler/cgen.h>
+#include <adorad/core/debug.h>
+#include <adorad/core/misc.h>
+
+// What every generated header starts with: the primitive types, and the little runtime support the generated code
+// needs
+static const char* cgen_prelude =
+    "// Generated by the Adorad compiler. Do not edit.\n"
+    "#pragma once\n"
+    "#include <stdbool.h>\n"
+    "#include <stdint.h>\n"
+    "#include <stdlib.h>\n"
+    "#include <string.h>\n"
+    "\n"
+    "typedef void adorad_Void;\n"
+    "typedef bool adorad_Bool;\n"
+    "typedef uint8_t adorad_Byte;\n"
+    "typedef int32_t adorad_Rune;\n"
+    "typedef int8_t adorad_Int8;\n"
+    "typedef int16_t adorad_Int16;\n"
+    "typedef int32_t adorad_Int;\n"
+    "typedef int64_t adorad_Int64;\n"
+    "typedef float adorad_Float32;\n"
+    "typedef double adorad_Float64;\n"
+    "typedef uint16_t adorad_UInt16;\n"
+    "typedef uint32_t adorad_UInt32;\n"
+    "typedef uint64_t adorad_UInt64;\n"
+    "typedef struct { const char* data; int64_t len; } adorad_String;\n"
+    "\n"
+    "#define ADORAD_STR(s)           ((adorad_String){ (s), sizeof(s) - 1 })\n"
+    "#define ADORAD_STR_INIT(s)      { (s), sizeof(s) - 1 }\n"
+    "#define adorad_unreachable()    abort()\n"
+    "\n"
+    "static inline adorad_Bool adorad_string_eq(adorad_String a, adorad_String b) {\n"
+    "    return a.len == b.len && memcmp(a.data, b.data, (size_t)a.len) == 0;\n"
+    "}\n"
+    "\n"
+    "static inline adorad_String adorad_string_concat(adorad_String a, adorad_String b) {\n"
+    "    char* data = (char*)malloc((size_t)(a.len + b.len) + 1);\n"
+    "    if(!data)\n"
+    "        abort();\n"
+    "    memcpy(data, a.data, (size_t)a.len);\n"
+    "    memcpy(data + a.len, b.data, (size_t)b.len);\n"
+    "    data[a.len + b.len] = 0;\n"
+    "    return (adorad_String){ data, a.len + b.len };\n"
+    "}\n"
+    "\n"
+    "// Integer division and shifts stop the program where the VM reports an error\n"
+    "static inline int64_t adorad_div(int64_t a, int64_t b) {\n"
+    "    if(b == 0 || (a == INT64_MIN && b == -1))\n"
+    "        abort();\n"
+    "    return a / b;\n"
+    "}\n"
+    "\n"
+    "static inline int64_t adorad_mod(int64_t a, int64_t b) {\n"
+    "    if(b == 0 || (a == INT64_MIN && b == -1))\n"
+    "        abort();\n"
+    "    return a % b;\n"
+    "}\n"
+    "\n"
+    "static inline uint64_t adorad_divu(uint64_t a, uint64_t b) {\n"
+    "    if(b == 0)\n"
+    "        abort();\n"
+    "    return a / b;\n"
+    "}\n"
+    "\n"
+    "static inline uint64_t adorad_modu(uint64_t a, uint64_t b) {\n"
+    "    if(b == 0)\n"
+    "        abort();\n"
+    "    return a % b;\n"
+    "}\n"
+    "\n"
+    "static inline uint64_t adorad_shl(uint64_t a, uint64_t n, uint64_t bits) {\n"
+    "    if(n >= bits)\n"
+    "        abort();\n"
+    "    return a << n;\n"
+    "}\n"
+    "\n"
+    "static inline int64_t adorad_shr(int64_t a, uint64_t n, uint64_t bits) {\n"
+    "    if(n >= bits)\n"
+    "        abort();\n"
+    "    return a < 0 ? ~(~a >> n) : a >> n;\n"
+    "}\n"
+    "\n"
+    "static inline uint64_t adorad_shru(uint64_t a, uint64_t n, uint64_t bits) {\n"
+    "    if(n >= bits)\n"
+    "        abort();\n"
+    "    return a >> n;\n"
+    "}\n"
+    "\n";
+
+// Names that locals can't have in C: keywords, and the names of the C headers included by the prelude
+static const char* cgen_reserved[] = {
+    "auto", "bool", "break", "case", "char", "const", "continue", "default", "do", "double", "else", "enum", "extern",
+    "false", "float", "for", "goto", "if", "inline", "int", "long", "register", "restrict", "return", "short",
+    "signed", "sizeof", "static", "struct", "switch", "true", "typedef", "union", "unsigned", "void", "volatile",
+    "while", "abort", "malloc", "memcmp", "memcpy", "size_t",
+};
+
+// A local variable (or parameter) in scope
+typedef struct {
+    Buff* name;
+    UInt32 suffix;      // the local is called `<name>__<suffix>` in C (0 if it's just `<name>`)
+} CGenLocal;
+
+// An enclosing loop
+typedef struct {
+    Buff* label;        // null if unlabeled
+    UInt32 id;          // labeled loops end in `adorad_continue<id>:`, and are followed by `adorad_break<id>:`
+} CGenLoop;
+
+// Everything needed to generate the code of a single unit. Like in the checker, every unit gets its own context.
+typedef struct {
+    CGen* gen;
+    CheckerUnit* unit;
+    CGenDecl* decl;
+    StrBuilder* out;        // where the code goes
+    Vec* locals;            // `CGenLocal`s in scope (innermost last)
+    Vec* declared;          // names (`Buff*`) of every local declared in the function so far
+    UInt64 scope_begin;     // index in `locals` at which the innermost scope begins
+    Vec* loops;             // `CGenLoop`s (innermost last)
+    UInt32 indent;
+    UInt32 num_names;       // counter for renamed locals and temporaries
+    Type* ret_type;
+} CGenCtx;
+
+static void cgen_expr(CGenCtx* ctx, AstNode* node);
+static void cgen_stmt(CGenCtx* ctx, AstNode* node);
+
+// Report an error at `node` (or at the unit's declaration, if `node` has no location)
+ATTRIBUTE_PRINTF(3, 4)
+static void cgen_error(CGenCtx* ctx, AstNode* node, const char* format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    Loc* loc = SOME(node) && SOME(node->loc) ? node->loc : ctx->unit->decl->loc;
+    CheckerDiagnostic diag;
+    diag.fname = SOME(loc) ? loc->fname : null;
+    diag.line = SOME(loc) ? loc->line : 0;
+    diag.col = SOME(loc) ? loc->col : 0;
+    diag.msg = cast(char*)malloc(strlen(buffer) + 1);
+    CORETEN_ENFORCE_NN(diag.msg, "Could not allocate memory. Memory full.");
+    strcpy(diag.msg, buffer);
+
+    if(NONE(ctx->decl->diagnostics))
+        ctx->decl->diagnostics = VEC_NEW(CheckerDiagnostic, 4);
+    vec_push(ctx->decl->diagnostics, &diag);
+}
+
+// Can values of type `type` be represented in C (yet)?
+static bool cgen_is_supported(Type* type) {
+    switch(type->kind) {
+        case AdoradTypeBool:
+        case AdoradTypeByte:
+        case AdoradTypeString:
+        case AdoradTypeRune:
+        case AdoradTypeInt8:
+        case AdoradTypeInt16:
+        case AdoradTypeInt:
+        case AdoradTypeInt64:
+        case AdoradTypeFloat32:
+        case AdoradTypeFloat64:
+        case AdoradTypeUInt16:
+        case AdoradTypeUInt32:
+        case AdoradTypeUInt64:
+        case AdoradTypeVoid:
+            return true;
+        case AdoradTypePointer:
+        case AdoradTypeOptional:
+        case AdoradTypeSlice:
+            return type->elem->kind != AdoradTypeVoid && cgen_is_supported(type->elem);
+        case AdoradTypeArray:
+            return type->len > 0 && type->elem->kind != AdoradTypeVoid && cgen_is_supported(type->elem);
+        case AdoradTypeFunc:
+            for(UInt32 i = 0; i < type->num_params; i++)
+                if(!cgen_is_supported(type->params[i]))
+                    return false;
+            return cgen_is_supported(type->ret);
+        default:
+            return false;
+    }
+}
+
+// The name of `type` in C, without the `adorad_` prefix. Every type constructor is a fixed prefix followed by the
+// names of its operands, so different types never get the same name.
+static void cgen_mangle(StrBuilder* out, Type* type) {
+    switch(type->kind) {
+        case AdoradTypePointer: strbuilder_append_cstr(out, "Ptr_"); cgen_mangle(out, type->elem); break;
+        case AdoradTypeOptional: strbuilder_append_cstr(out, "Opt_"); cgen_mangle(out, type->elem); break;
+        case AdoradTypeSlice: strbuilder_append_cstr(out, "Slice_"); cgen_mangle(out, type->elem); break;
+        case AdoradTypeArray:
+            strbuilder_appendf(out, "Arr%" CORETEN_PRIu64 "_", type->len);
+            cgen_mangle(out, type->elem);
+            break;
+        case AdoradTypeFunc:
+            strbuilder_appendf(out, "Fn%s%u_", type->is_variadic ? "v" : "", type->num_params);
+            for(UInt32 i = 0; i < type->num_params; i++) {
+                cgen_mangle(out, type->params[i]);
+                strbuilder_append_char(out, '_');
+            }
+            cgen_mangle(out, type->ret);
+            break;
+        default: strbuilder_append_cstr(out, type->name); break;
+    }
+}
+
+// Append the C spelling of `type` (the type of `node`)
+static void cgen_type(CGenCtx* ctx, AstNode* node, Type* type) {
+    if(!cgen_is_supported(type)) {
+        char buf[64];
+        type_to_str(type, buf, sizeof(buf));
+        cgen_error(ctx, node, "The C backend doesn't support values of type `%s` yet", buf);
+    } else if(type->kind >= AdoradTypePointer) {
+        vec_push(ctx->decl->types, &type->id);
+    }
+    strbuilder_append_cstr(ctx->out, CGEN_PREFIX);
+    cgen_mangle(ctx->out, type);
+}
+
+static inline bool cgen_name_eq(Buff* a, Buff* b) {
+    return a->len == b->len && memcmp(a->data, b->data, a->len) == 0;
+}
+
+static void cgen_indent(CGenCtx* ctx) {
+    strbuilder_append_repeat(ctx->out, ' ', 4 * cast(UInt64)ctx->indent);
+}
+
+// Locals keep their name unless it's reserved in C, it's one of ours (`ad_*`, `adorad_*`), it could be a macro
+// (no lowercase letters), or it's been used for another local of the function already
+static bool cgen_is_plain_name(CGenCtx* ctx, Buff* name) {
+    if(strncmp(name->data, "ad_", 3) == 0 || strncmp(name->data, CGEN_PREFIX, strlen(CGEN_PREFIX)) == 0 || strstr(name->data, "__"))
+        return false;
+    bool has_lowercase = false;
+    for(UInt64 i = 0; i < name->len; i++)
+        has_lowercase |= name->data[i] >= 'a' && name->data[i] <= 'z';
+    if(!has_lowercase)
+        return false;
+
+    // Every reserved name is short
+    for(UInt64 i = 0; name->len <= 8 && i < sizeof(cgen_reserved) / sizeof(cgen_reserved[0]); i++)
+        if(strcmp(name->data, cgen_reserved[i]) == 0)
+            return false;
+    for(UInt64 i = 0; i < vec_size(ctx->declared); i++)
+        if(cgen_name_eq(*cast(Buff**)vec_at(ctx->declared, i), name))
+            return false;
+    return true;
+}
+
+// Pick the C name of a new local. It's only in scope after `cgen_declare_local()`.
+static CGenLocal cgen_new_local(CGenCtx* ctx, Buff* name) {
+    CGenLocal local = { .name = name, .suffix = 0 };
+    if(!cgen_is_plain_name(ctx, name))
+        local.suffix = ++ctx->num_names;
+    vec_push(ctx->declared, &name);
+    return local;
+}
+
+static void cgen_declare_local(CGenCtx* ctx, CGenLocal* local) {
+    vec_push(ctx->locals, local);
+}
+
+static void cgen_local_name(CGenCtx* ctx, CGenLocal* local) {
+    strbuilder_append_n(ctx->out, local->name->data, local->name->len);
+    if(local->suffix > 0)
+        strbuilder_appendf(ctx->out, "__%u", local->suffix);
+}
+
+// Append the C name of a top-level declaration
+static void cgen_global_name(CGenCtx* ctx, Symbol* symbol) {
+    AstNode* decl = symbol->decl;
+    bool is_extern = decl->kind == AstNodeKindFuncDecl && decl->data.decl->func_decl->no_body;
+    if(!is_extern)
+        strbuilder_append_cstr(ctx->out, "ad_");
+    strbuilder_append_n(ctx->out, symbol->name->data, symbol->name->len);
+}
+
+static void cgen_identifier(CGenCtx* ctx, AstNode* node) {
+    Buff* name = node->data.identifier->name;
+    for(UInt64 i = vec_size(ctx->locals); i > 0; i--) {
+        CGenLocal* local = cast(CGenLocal*)vec_at(ctx->locals, i - 1);
+        if(cgen_name_eq(local->name, name)) {
+            cgen_local_name(ctx, local);
+            return;
+        }
+    }
+    cgen_global_name(ctx, checker_lookup(ctx->gen->checker, name->data, name->len));
+}
+
+// Append `node` converted to `to` (for everything the checker accepts as assignable, but C doesn't)
+static void cgen_convert(CGenCtx* ctx, Type* to, AstNode* node) {
+    Type* from = type_get(node->type);
+    if(to == from || NONE(to)) {
+        cgen_expr(ctx, node);
+    } else if(to->kind == AdoradTypeOptional && from->kind == AdoradTypeNull) {
+        strbuilder_append_cstr(ctx->out, "((");
+        cgen_type(ctx, node, to);
+        strbuilder_append_cstr(ctx->out, "){ 0 })");
+    } else if(to->kind == AdoradTypeOptional) {
+        strbuilder_append_cstr(ctx->out, "((");
+        cgen_type(ctx, node, to);
+        strbuilder_append_cstr(ctx->out, "){ ");
+        cgen_convert(ctx, to->elem, node);
+        strbuilder_append_cstr(ctx->out, ", true })");
+    } else if(to->kind == AdoradTypeSlice && from->kind == AdoradTypeArray) {
+        strbuilder_append_cstr(ctx->out, "((");
+        cgen_type(ctx, node, to);
+        strbuilder_append_cstr(ctx->out, "){ (");
+        cgen_expr(ctx, node);
+        strbuilder_appendf(ctx->out, ").data, %" CORETEN_PRIu64 " })", from->len);
+    } else if(type_is_numeric(to) && type_is_numeric(from)) {
+        strbuilder_append_cstr(ctx->out, "((");
+        cgen_type(ctx, node, to);
+        strbuilder_append_cstr(ctx->out, ")");
+        cgen_expr(ctx, node);
+        strbuilder_append_cstr(ctx->out, ")");
+    } else {
+        char to_buf[64];
+        char from_buf[64];
+        type_to_str(to, to_buf, sizeof(to_buf));
+        type_to_str(from, from_buf, sizeof(from_buf));
+        cgen_error(ctx, node, "The C backend doesn't support converting `%s` to `%s` yet", from_buf, to_buf);
+    }
+}
+
+static void cgen_int_literal(CGenCtx* ctx, AstNode* node) {
+    // The checker made sure the literal fits in its type
+    UInt64 value = 0;
+    checker_int_literal_value(node->data.literal->int_value->value, &value);
+    // Formatted by hand: there are a lot of these, and `printf()` is slow
+    char digits[24];
+    char* end = digits + sizeof(digits);
+    char* begin = end;
+    if(value > INT64_MAX)
+        *--begin = 'u';
+    do {
+        *--begin = cast(char)('0' + value % 10);
+        value /= 10;
+    } while(value > 0);
+
+    strbuilder_append_cstr(ctx->out, "((");
+    cgen_type(ctx, node, type_get(node->type));
+    strbuilder_append_char(ctx->out, ')');
+    strbuilder_append_n(ctx->out, begin, cast(UInt64)(end - begin));
+    strbuilder_append_char(ctx->out, ')');
+}
+
+static void cgen_float_literal(CGenCtx* ctx, AstNode* node) {
+    Buff* value = node->data.literal->float_value->value;
+    for(UInt64 i = 0; i < value->len; i++)
+        if(value->data[i] != '_')
+            strbuilder_append_char(ctx->out, value->data[i]);
+    if(type_get(node->type)->kind == AdoradTypeFloat32)
+        strbuilder_append_char(ctx->out, 'f');
+}
+
+// Adorad's escape sequences are mostly C's. The ones that aren't are rewritten as (3-digit) octal escapes, so they
+// can't run into the characters after them.
+static void cgen_escaped(CGenCtx* ctx, Buff* value) {
+    for(UInt64 i = 0; i < value->len; i++) {
+        char ch = value->data[i];
+        switch(ch) {
+            case '\n': strbuilder_append_cstr(ctx->out, "\\n"); break;
+            case '\r': strbuilder_append_cstr(ctx->out, "\\r"); break;
+            case '\t': strbuilder_append_cstr(ctx->out, "\\t"); break;
+            case '?': strbuilder_append_cstr(ctx->out, "\\?"); break;     // no trigraphs
+            case '"': strbuilder_append_cstr(ctx->out, "\\\""); break;
+            case '\\':
+                if(++i == value->len) {
+                    strbuilder_append_cstr(ctx->out, "\\\\");
+                    break;
+                }
+                ch = value->data[i];
+                if(ch == 'e')
+                    strbuilder_append_cstr(ctx->out, "\\033");
+                else if(ch >= '0' && ch <= '7')
+                    strbuilder_appendf(ctx->out, "\\00%c", ch);
+                else {
+                    strbuilder_append_char(ctx->out, '\\');
+                    strbuilder_append_char(ctx->out, ch);
+                }
+                break;
+            default: strbuilder_append_char(ctx->out, ch); break;
+        }
+    }
+}
+
+static void cgen_string_literal(CGenCtx* ctx, AstNode* node) {
+    if(node->data.literal->str_value->type == AstNodeStringLiteralFormat) {
+        cgen_error(ctx, node, "The C backend doesn't support format strings yet");
+        return;
+    }
+    Buff* value = node->data.literal->str_value->value;
+    strbuilder_append_cstr(ctx->out, "ADORAD_STR(\"");
+    // The lexer spells the empty string `""`
+    if(!(value->len == 2 && value->data[0] == '"' && value->data[1] == '"'))
+        cgen_escaped(ctx, value);
+    strbuilder_append_cstr(ctx->out, "\")");
+}
+
+static const char* cgen_binary_op_str(BinaryOpKind op) {
+    switch(op) {
+        case BinaryOpKindAssignmentMult: return "*=";
+        case BinaryOpKindAssignmentDiv: return "/=";
+        case BinaryOpKindAssignmentMod: return "%=";
+        case BinaryOpKindAssignmentPlus: return "+=";
+        case BinaryOpKindAssignmentMinus: return "-=";
+        case BinaryOpKindAssignmentBitshiftLeft: return "<<=";
+        case BinaryOpKindAssignmentBitshiftRight: return ">>=";
+        case BinaryOpKindAssignmentBitAnd: return "&=";
+        case BinaryOpKindAssignmentBitXor: return "^=";
+        case BinaryOpKindAssignmentBitOr: return "|=";
+        case BinaryOpKindAssignmentEquals: return "=";
+        case BinaryOpKindCmpEqual: return "==";
+        case BinaryOpKindCmpNotEqual: return "!=";
+        case BinaryOpKindCmpLessThan: return "<";
+        case BinaryOpKindCmpGreaterThan: return ">";
+        case BinaryOpKindCmpLessThanorEqualTo: return "<=";
+        case BinaryOpKindCmpGreaterThanorEqualTo: return ">=";
+        case BinaryOpKindBoolAnd: return "&&";
+        case BinaryOpKindBoolOr: return "||";
+        case BinaryOpKindBitAnd: return "&";
+        case BinaryOpKindBitOr: return "|";
+        case BinaryOpKindBitXor: return "^";
+        case BinaryOpKindBitshitLeft: return "<<";
+        case BinaryOpKindBitshitRight: return ">>";
+        case BinaryOpKindAdd: return "+";
+        case BinaryOpKindSubtract: return "-";
+        case BinaryOpKindMult: return "*";
+        case BinaryOpKindDiv: return "/";
+        case BinaryOpKindMod: return "%";
+        default: return null;
+    }
+}
+
+// `==` and `!=`
+static void cgen_equality(CGenCtx* ctx, AstNode* node) {
+    AstNodeBinaryOpExpr* binop = node->data.expr->binary_op_expr;
+    Type* lhs = type_get(binop->lhs->type);
+    Type* rhs = type_get(binop->rhs->type);
+    bool is_equal = binop->op == BinaryOpKindCmpEqual;
+
+    if(lhs->kind == AdoradTypeNull || rhs->kind == AdoradTypeNull) {
+        // `x == null`
+        AstNode* optional = lhs->kind == AdoradTypeNull ? binop->rhs : binop->lhs;
+        if(type_get(optional->type)->kind != AdoradTypeOptional) {
+            strbuilder_append_cstr(ctx->out, is_equal ? "false" : "true");
+            return;
+        }
+        strbuilder_append_cstr(ctx->out, is_equal ? "(!(" : "((");
+        cgen_expr(ctx, optional);
+        strbuilder_append_cstr(ctx->out, ").some)");
+    } else if(lhs->kind == AdoradTypeString) {
+        strbuilder_append_cstr(ctx->out, is_equal ? "adorad_string_eq(" : "!adorad_string_eq(");
+        cgen_expr(ctx, binop->lhs);
+        strbuilder_append_cstr(ctx->out, ", ");
+        cgen_expr(ctx, binop->rhs);
+        strbuilder_append_cstr(ctx->out, ")");
+    } else if(lhs->kind == AdoradTypeOptional || rhs->kind == AdoradTypeOptional || lhs->kind == AdoradTypeArray ||
+              lhs->kind == AdoradTypeSlice) {
+        char buf[64];
+        type_to_str(lhs, buf, sizeof(buf));
+        cgen_error(ctx, node, "The C backend doesn't support comparing values of type `%s` yet", buf);
+    } else {
+        strbuilder_append_cstr(ctx->out, "(");
+        cgen_expr(ctx, binop->lhs);
+        strbuilder_append_cstr(ctx->out, is_equal ? " == " : " != ");
+        cgen_expr(ctx, binop->rhs);
+        strbuilder_append_cstr(ctx->out, ")");
+    }
+}
+
+// The C operator of the arithmetic operators, and of the compound assignments that do arithmetic
+static const char* cgen_arith_op(BinaryOpKind op, bool* is_assignment) {
+    *is_assignment = true;
+    switch(op) {
+        case BinaryOpKindAssignmentPlus: return "+";
+        case BinaryOpKindAssignmentMinus: return "-";
+        case BinaryOpKindAssignmentMult: return "*";
+        case BinaryOpKindAssignmentDiv: return "/";
+        case BinaryOpKindAssignmentMod: return "%";
+        case BinaryOpKindAssignmentBitshiftLeft: return "<<";
+        case BinaryOpKindAssignmentBitshiftRight: return ">>";
+        case BinaryOpKindAssignmentBitAnd: return "&";
+        case BinaryOpKindAssignmentBitXor: return "^";
+        case BinaryOpKindAssignmentBitOr: return "|";
+        default: break;
+    }
+    *is_assignment = false;
+    switch(op) {
+        case BinaryOpKindAdd: return "+";
+        case BinaryOpKindSubtract: return "-";
+        case BinaryOpKindMult: return "*";
+        case BinaryOpKindDiv: return "/";
+        case BinaryOpKindMod: return "%";
+        case BinaryOpKindBitshitLeft: return "<<";
+        case BinaryOpKindBitshitRight: return ">>";
+        case BinaryOpKindBitAnd: return "&";
+        case BinaryOpKindBitXor: return "^";
+        case BinaryOpKindBitOr: return "|";
+        default: return null;
+    }
+}
+
+// Integer arithmetic wraps around like it does in the VM: it's done on `uint64_t`s (which can't overflow, and aren't
+// promoted to `int` like narrow operands are), and every result is converted back to `type`. Division and shifts go
+// through the prelude, which stops the program where the VM reports an error.
+static void cgen_int_arith(CGenCtx* ctx, AstNode* node, Type* type, const char* op, AstNode* lhs, AstNode* rhs) {
+    bool is_signed = type_is_signed(type);
+    const char* helper = null;
+    switch(op[0]) {
+        case '/': helper = is_signed ? "adorad_div" : "adorad_divu"; break;
+        case '%': helper = is_signed ? "adorad_mod" : "adorad_modu"; break;
+        case '<': helper = "adorad_shl"; break;
+        case '>': helper = is_signed ? "adorad_shr" : "adorad_shru"; break;
+        default: break;
+    }
+    strbuilder_append_cstr(ctx->out, "((");
+    cgen_type(ctx, node, type);
+    strbuilder_append_cstr(ctx->out, ")");
+    if(NONE(helper)) {
+        strbuilder_append_cstr(ctx->out, "((uint64_t)");
+        cgen_expr(ctx, lhs);
+        strbuilder_appendf(ctx->out, " %s (uint64_t)", op);
+        cgen_expr(ctx, rhs);
+        strbuilder_append_cstr(ctx->out, "))");
+        return;
+    }
+    // Signed operands are sign-extended: `INT8_MIN / -1` is fine in 64 bits, and `>>` shifts the sign in
+    strbuilder_appendf(ctx->out, "%s(%s", helper, is_signed && op[0] != '<' ? "(int64_t)" : "(uint64_t)");
+    cgen_expr(ctx, lhs);
+    strbuilder_append_cstr(ctx->out, ", (uint64_t)");
+    cgen_expr(ctx, rhs);
+    if(op[0] == '<' || op[0] == '>')
+        strbuilder_appendf(ctx->out, ", %" CORETEN_PRIu64, cast(UInt64)type_size(type) * 8);
+    strbuilder_append_cstr(ctx->out, "))");
+}
+
+static void cgen_binary_op(CGenCtx* ctx, AstNode* node) {
+    AstNodeBinaryOpExpr* binop = node->data.expr->binary_op_expr;
+    Type* lhs = type_get(binop->lhs->type);
+    switch(binop->op) {
+        case BinaryOpKindCmpEqual:
+        case BinaryOpKindCmpNotEqual:
+            cgen_equality(ctx, node);
+            return;
+
+        case BinaryOpKindAssignmentEquals:
+            strbuilder_append_cstr(ctx->out, "(");
+            cgen_expr(ctx, binop->lhs);
+            strbuilder_append_cstr(ctx->out, " = ");
+            cgen_convert(ctx, lhs, binop->rhs);
+            strbuilder_append_cstr(ctx->out, ")");
+            return;
+
+        case BinaryOpKindAdd:
+        case BinaryOpKindAssignmentPlus:
+            if(lhs->kind != AdoradTypeString)
+                break;
+            // Strings are concatenated
+            strbuilder_append_cstr(ctx->out, "(");
+            if(binop->op == BinaryOpKindAssignmentPlus) {
+                cgen_expr(ctx, binop->lhs);
+                strbuilder_append_cstr(ctx->out, " = ");
+            }
+            strbuilder_append_cstr(ctx->out, "adorad_string_concat(");
+            cgen_expr(ctx, binop->lhs);
+            strbuilder_append_cstr(ctx->out, ", ");
+            cgen_expr(ctx, binop->rhs);
+            strbuilder_append_cstr(ctx->out, "))");
+            return;
+
+        default:
+            break;
+    }
+
+    const char* op = cgen_binary_op_str(binop->op);
+    if(NONE(op)) {
+        cgen_error(ctx, node, "The C backend doesn't support this operator yet");
+        return;
+    }
+    bool is_assignment;
+    const char* arith = cgen_arith_op(binop->op, &is_assignment);
+    if(SOME(arith) && type_is_integer(lhs)) {
+        strbuilder_append_cstr(ctx->out, "(");
+        if(is_assignment) {
+            cgen_expr(ctx, binop->lhs);
+            strbuilder_append_cstr(ctx->out, " = ");
+        }
+        cgen_int_arith(ctx, node, lhs, arith, binop->lhs, binop->rhs);
+        strbuilder_append_cstr(ctx->out, ")");
+        return;
+    }
+    strbuilder_append_cstr(ctx->out, "(");
+    cgen_expr(ctx, binop->lhs);
+    strbuilder_appendf(ctx->out, " %s ", op);
+    cgen_expr(ctx, binop->rhs);
+    strbuilder_append_cstr(ctx->out, ")");
+}
+
+static void cgen_prefix_op(CGenCtx* ctx, AstNode* node) {
+    AstNodePrefixOpExpr* prefix = node->data.prefix_op_expr;
+    Type* type = type_get(node->type);
+    if(prefix->op == PrefixOpKindMinus && type_is_integer(type)) {
+        // Wraps around like the rest of the arithmetic: `-INT8_MIN` is `INT8_MIN`
+        strbuilder_append_cstr(ctx->out, "((");
+        cgen_type(ctx, node, type);
+        strbuilder_append_cstr(ctx->out, ")(0 - (uint64_t)");
+        cgen_expr(ctx, prefix->expr);
+        strbuilder_append_cstr(ctx->out, "))");
+        return;
+    }
+    switch(prefix->op) {
+        case PrefixOpKindBoolNot:
+        case PrefixOpKindNegation: strbuilder_append_cstr(ctx->out, "(!"); break;
+        case PrefixOpKindMinus: strbuilder_append_cstr(ctx->out, "(-"); break;
+        case PrefixOpKindAddrOf: strbuilder_append_cstr(ctx->out, "(&"); break;
+        default:
+            cgen_error(ctx, node, "The C backend doesn't support this operator yet");
+            return;
+    }
+    cgen_expr(ctx, prefix->expr);
+    strbuilder_append_cstr(ctx->out, ")");
+}
+
+static void cgen_call(CGenCtx* ctx, AstNode* node) {
+    AstNodeFuncCallExpr* call = node->data.expr->func_call_expr;
+    if(checker_tensor_method(node) != CheckerTensorMethodNone) {
+        cgen_error(ctx, node, "The C backend doesn't support tensor methods yet");
+        return;
+    }
+    Type* callee = type_get(call->func_call_expr->type);
+    cgen_expr(ctx, call->func_call_expr);
+    strbuilder_append_cstr(ctx->out, "(");
+    for(UInt64 i = 0; i < vec_size(call->params); i++) {
+        if(i > 0)
+            strbuilder_append_cstr(ctx->out, ", ");
+        AstNode* arg = cast(AstNode*)vec_at(call->params, i);
+        cgen_convert(ctx, i < callee->num_params ? callee->params[i] : null, arg);
+    }
+    strbuilder_append_cstr(ctx->out, ")");
+}
+
+// Can `value` (of type `type`) be spelled as a C constant?
+static bool cgen_is_constant(Type* type, ComptimeValue* value) {
+    switch(type->kind) {
+        case AdoradTypeOptional: return value->is_null || cgen_is_constant(type->elem, value);
+        case AdoradTypeFloat32:
+        case AdoradTypeFloat64: return isfinite(value->fimm);
+        case AdoradTypeVoid:
+        case AdoradTypeBool:
+        case AdoradTypeRune:
+        case AdoradTypeString:
+        case AdoradTypeFunc: return true;
+        default: return type_is_integer(type);
+    }
+}
+
+// `value` as a C constant. Static initializers can't have compound literals.
+static void cgen_constant(CGenCtx* ctx, Type* type, ComptimeValue* value, bool in_initializer) {
+    switch(type->kind) {
+        case AdoradTypeOptional:
+            if(!in_initializer) {
+                strbuilder_append_cstr(ctx->out, "((");
+                cgen_type(ctx, ctx->unit->decl, type);
+                strbuilder_append_char(ctx->out, ')');
+            }
+            if(value->is_null) {
+                strbuilder_append_cstr(ctx->out, "{ 0 }");
+            } else {
+                strbuilder_append_cstr(ctx->out, "{ ");
+                cgen_constant(ctx, type->elem, value, in_initializer);
+                strbuilder_append_cstr(ctx->out, ", true }");
+            }
+            if(!in_initializer)
+                strbuilder_append_char(ctx->out, ')');
+            break;
+        case AdoradTypeString:
+            strbuilder_append_cstr(ctx->out, in_initializer ? "ADORAD_STR_INIT(\"" : "ADORAD_STR(\"");
+            // The lexer spells the empty string `""`
+            if(!(value->str->len == 2 && value->str->data[0] == '"' && value->str->data[1] == '"'))
+                cgen_escaped(ctx, value->str);
+            strbuilder_append_cstr(ctx->out, "\")");
+            break;
+        case AdoradTypeFunc:
+            cgen_global_name(ctx, value->func);
+            break;
+        case AdoradTypeBool:
+            strbuilder_append_cstr(ctx->out, value->imm ? "true" : "false");
+            break;
+        case AdoradTypeVoid:
+            strbuilder_append_cstr(ctx->out, "((void)0)");
+            break;
+        default:
+            strbuilder_append_cstr(ctx->out, "((");
+            cgen_type(ctx, ctx->unit->decl, type);
+            strbuilder_append_char(ctx->out, ')');
+            if(type_is_float(type))
+                strbuilder_appendf(ctx->out, "%.17g", value->fimm);
+            else if(!type_is_signed(type))
+                strbuilder_appendf(ctx->out, "%" CORETEN_PRIu64 "u", value->imm);
+            else if(cast(Int64)value->imm == INT64_MIN)
+                strbuilder_append_cstr(ctx->out, "(-9223372036854775807 - 1)");
+            else
+                strbuilder_appendf(ctx->out, "%lld", cast(long long)cast(Int64)value->imm);
+            strbuilder_append_char(ctx->out, ')');
+            break;
+    }
+}
+
+// The value of `node` if it was computed at compile time (and can be spelled in C)
+static ComptimeValue* cgen_comptime_value(CGenCtx* ctx, AstNode* node) {
+    if(NONE(ctx->gen->comptime))
+        return null;
+    ComptimeValue* value = comptime_value_of(ctx->gen->comptime, node);
+    return SOME(value) && cgen_is_constant(type_get(node->type), value) ? value : null;
+}
+
+// The value of `symbol`, if it's a `[comptime]` global whose value is known
+static ComptimeValue* cgen_comptime_global(CGenCtx* ctx, Symbol* symbol) {
+    if(NONE(ctx->gen->comptime))
+        return null;
+    ComptimeValue* value = comptime_global(ctx->gen->comptime, symbol->unit);
+    return SOME(value) && cgen_is_constant(symbol->type, value) ? value : null;
+}
+
+static void cgen_expr(CGenCtx* ctx, AstNode* node) {
+    // Calls to `[comptime]` functions, and `[comptime]` expressions
+    ComptimeValue* value = cgen_comptime_value(ctx, node);
+    if(SOME(value)) {
+        cgen_constant(ctx, type_get(node->type), value, false);
+        return;
+    }
+
+    switch(node->kind) {
+        case AstNodeKindIntLiteral: cgen_int_literal(ctx, node); break;
+        case AstNodeKindFloatLiteral: cgen_float_literal(ctx, node); break;
+        case AstNodeKindStringLiteral: cgen_string_literal(ctx, node); break;
+        case AstNodeKindBoolLiteral:
+            strbuilder_append_cstr(ctx->out, node->data.literal->bool_value->value ? "true" : "false");
+            break;
+        case AstNodeKindCharLiteral:
+            strbuilder_append_cstr(ctx->out, "((adorad_Rune)'");
+            cgen_escaped(ctx, node->data.literal->char_value->value);
+            strbuilder_append_cstr(ctx->out, "')");
+            break;
+
+        case AstNodeKindIdentifier: cgen_identifier(ctx, node); break;
+        case AstNodeKindGroupedExpr: cgen_expr(ctx, node->data.expr->grouped_expr->expr); break;
+        case AstNodeKindAttributeExpr: cgen_expr(ctx, node->data.expr->attr_expr->expr); break;
+        case AstNodeKindPrefixOpExpr: cgen_prefix_op(ctx, node); break;
+        case AstNodeKindBinaryOpExpr: cgen_binary_op(ctx, node); break;
+        case AstNodeKindFuncCallExpr: cgen_call(ctx, node); break;
+
+        default:
+            // `null` is only ever used through `cgen_convert()` (and `if`/`match`/... don't have a value)
+            cgen_error(ctx, node, "The C backend doesn't support this kind of expression yet");
+            break;
+    }
+}
+
+// Generate `node` as a block, even if it's a single statement
+static void cgen_block(CGenCtx* ctx, AstNode* node) {
+    UInt64 prev_scope_begin = ctx->scope_begin;
+    ctx->scope_begin = vec_size(ctx->locals);
+    strbuilder_append_cstr(ctx->out, "{\n");
+    ctx->indent++;
+
+    if(node->kind == AstNodeKindBlock) {
+        Vec* statements = node->data.stmt->block_stmt->statements;
+        for(UInt64 i = 0; i < vec_size(statements); i++)
+            cgen_stmt(ctx, cast(AstNode*)vec_at(statements, i));
+    } else {
+        cgen_stmt(ctx, node);
+    }
+
+    ctx->indent--;
+    cgen_indent(ctx);
+    strbuilder_append_cstr(ctx->out, "}");
+    while(vec_size(ctx->locals) > ctx->scope_begin)
+        vec_pop(ctx->locals);
+    ctx->scope_begin = prev_scope_begin;
+}
+
+static void cgen_if(CGenCtx* ctx, AstNode* node) {
+    AstNodeIfExpr* if_expr = node->data.expr->if_expr;
+    strbuilder_append_cstr(ctx->out, "if(");
+    cgen_expr(ctx, if_expr->condition);
+    strbuilder_append_cstr(ctx->out, ") ");
+    cgen_block(ctx, if_expr->if_body);
+
+    if(SOME(if_expr->else_node)) {
+        strbuilder_append_cstr(ctx->out, " else ");
+        if(if_expr->else_node->kind == AstNodeKindIfExpr)
+            cgen_if(ctx, if_expr->else_node);
+        else
+            cgen_block(ctx, if_expr->else_node);
+    }
+}
+
+// `match` becomes a chain of `if`s on a temporary holding the subject, which is only evaluated once
+static void cgen_match(CGenCtx* ctx, AstNode* node) {
+    AstNodeMatchExpr* match = node->data.expr->match_expr;
+    Type* subject = type_get(match->expr->type);
+    UInt32 tmp = ++ctx->num_names;
+
+    strbuilder_append_cstr(ctx->out, "{\n");
+    ctx->indent++;
+    cgen_indent(ctx);
+    cgen_type(ctx, match->expr, subject);
+    strbuilder_appendf(ctx->out, " adorad_tmp%u = ", tmp);
+    cgen_expr(ctx, match->expr);
+    strbuilder_append_cstr(ctx->out, ";\n");
+
+    for(UInt64 i = 0; i < vec_size(match->branches); i++) {
+        AstNodeMatchBranchExpr* branch = (cast(AstNode*)vec_at(match->branches, i))->data.expr->match_branch_expr;
+        AstNode* cond = branch->cond_node;
+        if(i == 0)
+            cgen_indent(ctx);
+        else
+            strbuilder_append_cstr(ctx->out, " else ");
+
+        if(branch->is_range) {
+            // `begin..end` doesn't include `end`
+            AstNodeMatchRangeExpr* range = cond->data.expr->match_range_expr;
+            strbuilder_append_cstr(ctx->out, "if(");
+            cgen_convert(ctx, subject, range->begin);
+            strbuilder_appendf(ctx->out, " <= adorad_tmp%u && adorad_tmp%u < ", tmp, tmp);
+            cgen_convert(ctx, subject, range->end);
+            strbuilder_append_cstr(ctx->out, ") ");
+        } else if(subject->kind == AdoradTypeString) {
+            strbuilder_appendf(ctx->out, "if(adorad_string_eq(adorad_tmp%u, ", tmp);
+            cgen_expr(ctx, cond);
+            strbuilder_append_cstr(ctx->out, ")) ");
+        } else {
+            strbuilder_appendf(ctx->out, "if(adorad_tmp%u == ", tmp);
+            cgen_convert(ctx, subject, cond);
+            strbuilder_append_cstr(ctx->out, ") ");
+        }
+        cgen_block(ctx, branch->block_node);
+    }
+    if(vec_size(match->branches) > 0)
+        strbuilder_append_char(ctx->out, '\n');
+
+    ctx->indent--;
+    cgen_indent(ctx);
+    strbuilder_append_cstr(ctx->out, "}");
+}
+
+// `loop`s become `while`/`for` loops. Labeled ones get C labels to `goto` for `break :label` and `continue :label`.
+static void cgen_loop(CGenCtx* ctx, AstNode* node) {
+    AstNodeLoopExpr* loop = node->data.expr->loop_expr;
+    CGenLoop entry = { .label = loop->label, .id = SOME(loop->label) ? ++ctx->num_names : 0 };
+    UInt64 prev_scope_begin = ctx->scope_begin;
+    ctx->scope_begin = vec_size(ctx->locals);
+    // The variable of a C-style loop gets a scope of its own (like the labels of a labeled loop)
+    bool has_scope = node->kind == AstNodeKindLoopCExpr && loop->loop_c_expr->has_init;
+    if(has_scope || SOME(loop->label)) {
+        strbuilder_append_cstr(ctx->out, "{\n");
+        ctx->indent++;
+    }
+
+    Vec* statements = null;
+    if(node->kind == AstNodeKindLoopInfExpr) {
+        AstNodeLoopInfExpr* loop_inf = loop->loop_inf_expr;
+        if(has_scope || SOME(loop->label))
+            cgen_indent(ctx);
+        strbuilder_append_cstr(ctx->out, "while(");
+        if(SOME(loop_inf->cond))
+            cgen_expr(ctx, loop_inf->cond);
+        else
+            strbuilder_append_cstr(ctx->out, "true");
+        strbuilder_append_cstr(ctx->out, ") ");
+        statements = loop_inf->statements;
+    } else if(node->kind == AstNodeKindLoopCExpr) {
+        AstNodeLoopCExpr* loop_c = loop->loop_c_expr;
+        if(loop_c->has_init)
+            cgen_stmt(ctx, loop_c->init);
+        if(has_scope || SOME(loop->label))
+            cgen_indent(ctx);
+        strbuilder_append_cstr(ctx->out, "for(; ");
+        if(loop_c->has_cond)
+            cgen_expr(ctx, loop_c->cond);
+        strbuilder_append_cstr(ctx->out, "; ");
+        if(loop_c->has_updation)
+            cgen_expr(ctx, loop_c->updation);
+        strbuilder_append_cstr(ctx->out, ") ");
+        statements = loop_c->statements;
+    } else {
+        // `loop i in begin..end` (`end` is evaluated once, and isn't included)
+        AstNodeLoopInExpr* loop_in = loop->loop_in_expr;
+        AstNodeMatchRangeExpr* range = loop_in->cond->data.expr->match_range_expr;
+        Type* type = type_get(loop_in->cond->type);
+        CGenLocal local = cgen_new_local(ctx, loop_in->val_var);
+        UInt32 end = ++ctx->num_names;
+        if(SOME(loop->label))
+            cgen_indent(ctx);
+        strbuilder_append_cstr(ctx->out, "for(");
+        cgen_type(ctx, loop_in->cond, type);
+        strbuilder_append_char(ctx->out, ' ');
+        cgen_local_name(ctx, &local);
+        strbuilder_append_cstr(ctx->out, " = ");
+        cgen_convert(ctx, type, range->begin);
+        strbuilder_appendf(ctx->out, ", adorad_tmp%u = ", end);
+        cgen_convert(ctx, type, range->end);
+        strbuilder_append_cstr(ctx->out, "; ");
+        cgen_local_name(ctx, &local);
+        strbuilder_appendf(ctx->out, " < adorad_tmp%u; ", end);
+        cgen_local_name(ctx, &local);
+        strbuilder_append_cstr(ctx->out, "++) ");
+        cgen_declare_local(ctx, &local);
+        statements = loop_in->statements;
+    }
+
+    // The body
+    UInt64 body_scope_begin = ctx->scope_begin;
+    ctx->scope_begin = vec_size(ctx->locals);
+    vec_push(ctx->loops, &entry);
+    strbuilder_append_cstr(ctx->out, "{\n");
+    ctx->indent++;
+    for(UInt64 i = 0; i < vec_size(statements); i++)
+        cgen_stmt(ctx, cast(AstNode*)vec_at(statements, i));
+    if(SOME(loop->label)) {
+        cgen_indent(ctx);
+        strbuilder_appendf(ctx->out, "adorad_continue%u: ;\n", entry.id);
+    }
+    ctx->indent--;
+    cgen_indent(ctx);
+    strbuilder_append_cstr(ctx->out, "}");
+    vec_pop(ctx->loops);
+
+    if(has_scope || SOME(loop->label)) {
+        strbuilder_append_char(ctx->out, '\n');
+        if(SOME(loop->label)) {
+            cgen_indent(ctx);
+            strbuilder_appendf(ctx->out, "adorad_break%u: ;\n", entry.id);
+        }
+        ctx->indent--;
+        cgen_indent(ctx);
+        strbuilder_append_cstr(ctx->out, "}");
+    }
+    while(vec_size(ctx->locals) > body_scope_begin)
+        vec_pop(ctx->locals);
+    ctx->scope_begin = prev_scope_begin;
+}
+
+// `break`/`continue`
+static void cgen_branch(CGenCtx* ctx, AstNode* node) {
+    Buff* name = node->data.stmt->branch_stmt->name;
+    bool is_break = node->kind == AstNodeKindBreak;
+    if(NONE(name)) {
+        strbuilder_append_cstr(ctx->out, is_break ? "break;" : "continue;");
+        return;
+    }
+    for(UInt64 i = vec_size(ctx->loops); i > 0; i--) {
+        CGenLoop* loop = cast(CGenLoop*)vec_at(ctx->loops, i - 1);
+        if(SOME(loop->label) && cgen_name_eq(loop->label, name)) {
+            strbuilder_appendf(ctx->out, "goto adorad_%s%u;", is_break ? "break" : "continue", loop->id);
+            return;
+        }
+    }
+    unreachable();
+}
+
+static void cgen_local_var(CGenCtx* ctx, AstNode* node) {
+    AstNodeVariable* var = node->data.scope_obj->var;
+    Type* type = type_get(node->type);
+    CGenLocal local = cgen_new_local(ctx, var->name);
+
+    cgen_type(ctx, node, type);
+    strbuilder_append_char(ctx->out, ' ');
+    cgen_local_name(ctx, &local);
+    strbuilder_append_cstr(ctx->out, " = ");
+    if(SOME(var->init_expr))
+        cgen_convert(ctx, type, var->init_expr);
+    else
+        strbuilder_append_cstr(ctx->out, "{ 0 }");
+    strbuilder_append_char(ctx->out, ';');
+
+    // Declared after its initializer, so `put x = x + 1` refers to an outer `x`
+    cgen_declare_local(ctx, &local);
+}
+
+static void cgen_stmt(CGenCtx* ctx, AstNode* node) {
+    cgen_indent(ctx);
+    switch(node->kind) {
+        case AstNodeKindVariableDecl: cgen_local_var(ctx, node); break;
+        case AstNodeKindBlock: cgen_block(ctx, node); break;
+        case AstNodeKindIfExpr: cgen_if(ctx, node); break;
+        case AstNodeKindMatchExpr: cgen_match(ctx, node); break;
+        case AstNodeKindLoopInfExpr:
+        case AstNodeKindLoopCExpr:
+        case AstNodeKindLoopInExpr: cgen_loop(ctx, node); break;
+        case AstNodeKindBreak:
+        case AstNodeKindContinue: cgen_branch(ctx, node); break;
+        case AstNodeKindUnreachable: strbuilder_append_cstr(ctx->out, "adorad_unreachable();"); break;
+        case AstNodeKindReturn: {
+            AstNode* expr = node->data.stmt->return_stmt->expr;
+            strbuilder_append_cstr(ctx->out, "return");
+            if(SOME(expr)) {
+                strbuilder_append_char(ctx->out, ' ');
+                cgen_convert(ctx, ctx->ret_type, expr);
+            }
+            strbuilder_append_char(ctx->out, ';');
+            break;
+        }
+        default:
+            cgen_expr(ctx, node);
+            strbuilder_append_char(ctx->out, ';');
+            break;
+    }
+    strbuilder_append_char(ctx->out, '\n');
+}
+
+// `Ret name(Params...)`, without the parameter names unless `with_names`
+static void cgen_signature(CGenCtx* ctx, Symbol* symbol, bool with_names) {
+    Type* type = symbol->type;
+    Vec* params = symbol->decl->data.decl->func_decl->params->data.param_list->params;
+    cgen_type(ctx, symbol->decl, type->ret);
+    strbuilder_append_char(ctx->out, ' ');
+    cgen_global_name(ctx, symbol);
+    strbuilder_append_char(ctx->out, '(');
+
+    for(UInt32 i = 0; i < type->num_params; i++) {
+        AstNode* param = cast(AstNode*)vec_at(params, i);
+        if(i > 0)
+            strbuilder_append_cstr(ctx->out, ", ");
+        cgen_type(ctx, param, type->params[i]);
+        if(with_names) {
+            CGenLocal local = cgen_new_local(ctx, param->data.param_decl->name);
+            strbuilder_append_char(ctx->out, ' ');
+            cgen_local_name(ctx, &local);
+            cgen_declare_local(ctx, &local);
+        }
+    }
+    if(type->num_params == 0)
+        strbuilder_append_cstr(ctx->out, "void");
+    else if(type->is_variadic)
+        strbuilder_append_cstr(ctx->out, ", ...");
+    strbuilder_append_char(ctx->out, ')');
+}
+
+static void cgen_func(CGenCtx* ctx, Symbol* symbol) {
+    AstNodeFuncDecl* func = symbol->decl->data.decl->func_decl;
+    if(func->no_body || NONE(func->body))
+        return;
+
+    ctx->ret_type = symbol->type->ret;
+    cgen_signature(ctx, symbol, true);
+    // Parameters live in the same scope as the function body's top-level statements
+    strbuilder_append_cstr(ctx->out, " {\n");
+    ctx->indent++;
+    Vec* statements = func->body->data.stmt->block_stmt->statements;
+    for(UInt64 i = 0; i < vec_size(statements); i++)
+        cgen_stmt(ctx, cast(AstNode*)vec_at(statements, i));
+    ctx->indent--;
+    strbuilder_append_cstr(ctx->out, "}\n\n");
+}
+
+// Globals are zero-initialized, and then set by `adorad_init()` (see `cgen_global_init()`). `[comptime]` globals are
+// initialized statically instead.
+static void cgen_global_var(CGenCtx* ctx, Symbol* symbol) {
+    cgen_type(ctx, symbol->decl, symbol->type);
+    strbuilder_append_char(ctx->out, ' ');
+    cgen_global_name(ctx, symbol);
+    ComptimeValue* value = cgen_comptime_global(ctx, symbol);
+    if(SOME(value)) {
+        strbuilder_append_cstr(ctx->out, " = ");
+        cgen_constant(ctx, symbol->type, value, true);
+    }
+    strbuilder_append_cstr(ctx->out, ";\n\n");
+}
+
+static void cgen_global_init(CGenCtx* ctx, Symbol* symbol) {
+    AstNode* init_expr = symbol->decl->data.scope_obj->var->init_expr;
+    if(NONE(init_expr) || SOME(cgen_comptime_global(ctx, symbol)))
+        return;
+
+    ctx->indent = 1;
+    cgen_indent(ctx);
+    cgen_global_name(ctx, symbol);
+    strbuilder_append_cstr(ctx->out, " = ");
+    cgen_convert(ctx, symbol->type, init_expr);
+    strbuilder_append_cstr(ctx->out, ";\n");
+}
+
+// Runs on the thread pool, once for every unit
+static void cgen_unit_task(void* arg, UInt64 index, UInt32 worker) {
+    CGen* gen = cast(CGen*)arg;
+    CheckerUnit* unit = cast(CheckerUnit*)vec_at(gen->checker->units, index);
+    CGenDecl* decl = cast(CGenDecl*)vec_at(gen->decls, index);
+    Symbol* symbol = unit->symbol;
+
+    CGenCtx ctx = {0};
+    ctx.gen = gen;
+    ctx.unit = unit;
+    ctx.decl = decl;
+    ctx.locals = VEC_NEW(CGenLocal, 8);
+    ctx.declared = VEC_NEW(Buff*, 8);
+    ctx.loops = VEC_NEW(CGenLoop, 4);
+
+    // The prototype (or `extern` declaration) goes into the header
+    ctx.out = decl->proto;
+    if(symbol->kind == SymbolKindFunc) {
+        cgen_signature(&ctx, symbol, false);
+    } else {
+        strbuilder_append_cstr(ctx.out, "extern ");
+        cgen_type(&ctx, symbol->decl, symbol->type);
+        strbuilder_append_char(ctx.out, ' ');
+        cgen_global_name(&ctx, symbol);
+    }
+    strbuilder_append_cstr(ctx.out, ";\n");
+
+    // If the signature can't be generated, the definition can't either (and would only report the same errors)
+    ctx.out = decl->code;
+    if(NONE(decl->diagnostics) && symbol->kind == SymbolKindFunc) {
+        cgen_func(&ctx, symbol);
+    } else if(NONE(decl->diagnostics)) {
+        cgen_global_var(&ctx, symbol);
+        ctx.out = decl->init;
+        cgen_global_init(&ctx, symbol);
+    }
+
+    vec_free(ctx.locals);
+    vec_free(ctx.declared);
+    vec_free(ctx.loops);
+}
+
+static int cgen_strcmp(const void* a, const void* b) {
+    return strcmp(*cast(char* const*)a, *cast(char* const*)b);
+}
+
+// Mark `type` and everything it's made of as used
+static void cgen_mark_type(UInt8* used, Type* type) {
+    if(type->kind < AdoradTypePointer || used[type->id])
+        return;
+    used[type->id] = 1;
+    if(SOME(type->elem))
+        cgen_mark_type(used, type->elem);
+    for(UInt32 i = 0; i < type->num_params; i++)
+        cgen_mark_type(used, type->params[i]);
+    if(SOME(type->ret))
+        cgen_mark_type(used, type->ret);
+}
+
+static UInt32 cgen_type_depth(Type* type) {
+    UInt32 depth = 0;
+    if(SOME(type->elem))
+        depth = cgen_type_depth(type->elem);
+    for(UInt32 i = 0; i < type->num_params; i++) {
+        UInt32 param_depth = cgen_type_depth(type->params[i]);
+        depth = param_depth > depth ? param_depth : depth;
+    }
+    if(SOME(type->ret)) {
+        UInt32 ret_depth = cgen_type_depth(type->ret);
+        depth = ret_depth > depth ? ret_depth : depth;
+    }
+    return type->kind >= AdoradTypePointer ? depth + 1 : depth;
+}
+
+// The typedefs of every composite type used, after the types they're made of. To keep the output the same from
+// one build to the next (TypeIds depend on the order types were created in), they're sorted by depth and name, not
+// by TypeId.
+static void cgen_typedefs(CGen* gen) {
+    UInt32 num_types = type_count();
+    UInt8* used = cast(UInt8*)calloc(num_types + 1, 1);
+    CORETEN_ENFORCE_NN(used, "Could not allocate memory. Memory full.");
+    for(UInt64 i = 0; i < vec_size(gen->decls); i++) {
+        Vec* types = (cast(CGenDecl*)vec_at(gen->decls, i))->types;
+        for(UInt64 j = 0; j < vec_size(types); j++)
+            cgen_mark_type(used, type_get(*cast(TypeId*)vec_at(types, j)));
+    }
+
+    // "<depth>_<name>" sorts by depth, then by name (names can't start with a digit)
+    Vec* keys = VEC_NEW(char*, 16);
+    StrBuilder* key = strbuilder_new(64);
+    for(UInt32 id = 1; id <= num_types; id++) {
+        if(!used[id])
+            continue;
+        Type* type = type_get(id);
+        strbuilder_clear(key);
+        strbuilder_appendf(key, "%08u_", cgen_type_depth(type));
+        cgen_mangle(key, type);
+        strbuilder_appendf(key, "|%u", id);
+        char* copy = cast(char*)malloc(key->len + 1);
+        CORETEN_ENFORCE_NN(copy, "Could not allocate memory. Memory full.");
+        memcpy(copy, key->data, key->len + 1);
+        vec_push(keys, &copy);
+    }
+    if(vec_size(keys) > 0)
+        qsort(vec_at(keys, 0), vec_size(keys), sizeof(char*), cgen_strcmp);
+
+    StrBuilder* out = gen->header;
+    StrBuilder* name = strbuilder_new(64);
+    StrBuilder* elem = strbuilder_new(64);
+    for(UInt64 i = 0; i < vec_size(keys); i++) {
+        char* copy = *cast(char**)vec_at(keys, i);
+        Type* type = type_get(cast(TypeId)strtoul(strrchr(copy, '|') + 1, null, 10));
+        free(copy);
+
+        strbuilder_clear(name);
+        cgen_mangle(name, type);
+        strbuilder_clear(elem);
+        if(SOME(type->elem))
+            cgen_mangle(elem, type->elem);
+
+        switch(type->kind) {
+            case AdoradTypePointer:
+                strbuilder_appendf(out, "typedef adorad_%s* adorad_%s;\n", elem->data, name->data);
+                break;
+            case AdoradTypeOptional:
+                strbuilder_appendf(out, "typedef struct { adorad_%s value; adorad_Bool some; } adorad_%s;\n",
+                                   elem->data, name->data);
+                break;
+            case AdoradTypeSlice:
+                strbuilder_appendf(out, "typedef struct { adorad_%s* data; int64_t len; } adorad_%s;\n", elem->data,
+                                   name->data);
+                break;
+            case AdoradTypeArray:
+                strbuilder_appendf(out, "typedef struct { adorad_%s data[%" CORETEN_PRIu64 "]; } adorad_%s;\n",
+                                   elem->data, type->len, name->data);
+                break;
+            case AdoradTypeFunc:
+                strbuilder_append_cstr(out, "typedef adorad_");
+                cgen_mangle(out, type->ret);
+                strbuilder_appendf(out, " (*adorad_%s)(", name->data);
+                for(UInt32 p = 0; p < type->num_params; p++) {
+                    strbuilder_append_cstr(out, p > 0 ? ", adorad_" : "adorad_");
+                    cgen_mangle(out, type->params[p]);
+                }
+                if(type->num_params == 0)
+                    strbuilder_append_cstr(out, "void");
+                else if(type->is_variadic)
+                    strbuilder_append_cstr(out, ", ...");
+                strbuilder_append_cstr(out, ");\n");
+                break;
+            default:
+                break;
+        }
+    }
+    if(vec_size(keys) > 0)
+        strbuilder_append_char(out, '\n');
+
+    strbuilder_free(name);
+    strbuilder_free(elem);
+    strbuilder_free(key);
+    vec_free(keys);
+    free(used);
+}
+
+// Append the initializer of the global variable `index` to `out`, after the globals it depends on (through any
+// number of functions). `state` is 0 for units not visited yet, 1 for units being visited, and 2 for units done.
+static void cgen_init_in_order(CGen* gen, UInt64 index, UInt8* state, StrBuilder* out) {
+    if(state[index] != 0)
+        return;
+    state[index] = 1;
+
+    CheckerUnit* unit = cast(CheckerUnit*)vec_at(gen->checker->units, index);
+    for(UInt64 i = 0; SOME(unit->deps) && i < vec_size(unit->deps); i++) {
+        Buff* name = *cast(Buff**)vec_at(unit->deps, i);
+        Symbol* dep = checker_lookup(gen->checker, name->data, name->len);
+        if(SOME(dep))
+            cgen_init_in_order(gen, dep->unit, state, out);
+    }
+
+    StrBuilder* init = (cast(CGenDecl*)vec_at(gen->decls, index))->init;
+    strbuilder_append_n(out, init->data, init->len);
+    state[index] = 2;
+}
+
+// `adorad_init()`, and the C `main()` if there's an Adorad `main()`
+static void cgen_entry_points(CGen* gen, StrBuilder* out) {
+    UInt64 num_decls = vec_size(gen->decls);
+    UInt8* state = cast(UInt8*)calloc(num_decls + 1, 1);
+    CORETEN_ENFORCE_NN(state, "Could not allocate memory. Memory full.");
+
+    strbuilder_append_cstr(out, "void adorad_init(void) {\n");
+    for(UInt64 i = 0; i < num_decls; i++)
+        cgen_init_in_order(gen, i, state, out);
+    strbuilder_append_cstr(out, "}\n");
+    free(state);
+
+    Symbol* main_func = checker_lookup(gen->checker, "main", 4);
+    if(NONE(main_func) || main_func->kind != SymbolKindFunc || main_func->decl->data.decl->func_decl->no_body)
+        return;
+
+    Type* ret = main_func->type->ret;
+    strbuilder_append_cstr(out, "\nint main(void) {\n    adorad_init();\n");
+    if(type_is_integer(ret))
+        strbuilder_append_cstr(out, "    return (int)ad_main();\n}\n");
+    else
+        strbuilder_append_cstr(out, "    ad_main();\n    return 0;\n}\n");
+}
+
+static void cgen_decl_clear(CGenDecl* decl) {
+    strbuilder_clear(decl->proto);
+    strbuilder_clear(decl->code);
+    strbuilder_clear(decl->init);
+    vec_clear(decl->types);
+    if(SOME(decl->diagnostics)) {
+        for(UInt64 i = 0; i < vec_size(decl->diagnostics); i++)
+            free((cast(CheckerDiagnostic*)vec_at(decl->diagnostics, i))->msg);
+        vec_free(decl->diagnostics);
+        decl->diagnostics = null;
+    }
+}
+
+CGen* cgen_new(UInt32 num_threads, UInt32 num_units) {
+    CORETEN_ENFORCE(num_units > 0, "Need at least one translation unit");
+    CGen* gen = cast(CGen*)calloc(1, sizeof(CGen));
+    CORETEN_ENFORCE_NN(gen, "Could not allocate memory. Memory full.");
+    gen->pool = threadpool_new(num_threads);
+    gen->num_units = num_units;
+    gen->decls = VEC_NEW(CGenDecl, 16);
+    gen->header = strbuilder_new(1 << 14);
+    gen->units = VEC_NEW(StrBuilder*, num_units);
+    for(UInt32 i = 0; i < num_units; i++) {
+        StrBuilder* unit = strbuilder_new(1 << 16);
+        vec_push(gen->units, &unit);
+    }
+    gen->diagnostics = VEC_NEW(CheckerDiagnostic, 4);
+    return gen;
+}
+
+static void cgen_clear_diagnostics(CGen* gen) {
+    for(UInt64 i = 0; i < vec_size(gen->diagnostics); i++)
+        free((cast(CheckerDiagnostic*)vec_at(gen->diagnostics, i))->msg);
+    vec_clear(gen->diagnostics);
+}
+
+void cgen_free(CGen* gen) {
+    if(NONE(gen))
+        return;
+
+    for(UInt64 i = 0; i < vec_size(gen->decls); i++) {
+        CGenDecl* decl = cast(CGenDecl*)vec_at(gen->decls, i);
+        cgen_decl_clear(decl);
+        strbuilder_free(decl->proto);
+        strbuilder_free(decl->code);
+        strbuilder_free(decl->init);
+        vec_free(decl->types);
+    }
+    for(UInt64 i = 0; i < vec_size(gen->units); i++)
+        strbuilder_free(*cast(StrBuilder**)vec_at(gen->units, i));
+    cgen_clear_diagnostics(gen);
+
+    vec_free(gen->decls);
+    vec_free(gen->units);
+    vec_free(gen->diagnostics);
+    strbuilder_free(gen->header);
+    threadpool_free(gen->pool);
+    free(gen->name);
+    free(gen);
+}
+
+UInt64 cgen_generate(CGen* gen, Checker* checker, const char* name) {
+    CORETEN_ENFORCE(vec_size(checker->diagnostics) == 0, "Can't generate code for a program with errors");
+    gen->checker = checker;
+    free(gen->name);
+    gen->name = cast(char*)malloc(strlen(name) + 1);
+    CORETEN_ENFORCE_NN(gen->name, "Could not allocate memory. Memory full.");
+    strcpy(gen->name, name);
+    cgen_clear_diagnostics(gen);
+
+    // One `CGenDecl` per unit, reusing the buffers of the previous build
+    UInt64 num_decls = vec_size(checker->units);
+    for(UInt64 i = 0; i < vec_size(gen->decls); i++)
+        cgen_decl_clear(cast(CGenDecl*)vec_at(gen->decls, i));
+    while(vec_size(gen->decls) < num_decls) {
+        CGenDecl decl = {0};
+        decl.proto = strbuilder_new(128);
+        decl.code = strbuilder_new(1024);
+        decl.init = strbuilder_new(0);
+        decl.types = VEC_NEW(TypeId, 8);
+        vec_push(gen->decls, &decl);
+    }
+    while(vec_size(gen->decls) > num_decls) {
+        CGenDecl* decl = cast(CGenDecl*)vec_at(gen->decls, vec_size(gen->decls) - 1);
+        strbuilder_free(decl->proto);
+        strbuilder_free(decl->code);
+        strbuilder_free(decl->init);
+        vec_free(decl->types);
+        vec_pop(gen->decls);
+    }
+
+    threadpool_parallel_for(gen->pool, num_decls, cgen_unit_task, gen);
+
+    // Diagnostics, in declaration order
+    for(UInt64 i = 0; i < num_decls; i++) {
+        CGenDecl* decl = cast(CGenDecl*)vec_at(gen->decls, i);
+        for(UInt64 j = 0; SOME(decl->diagnostics) && j < vec_size(decl->diagnostics); j++)
+            vec_push(gen->diagnostics, vec_at(decl->diagnostics, j));
+        vec_free(decl->diagnostics);
+        decl->diagnostics = null;
+    }
+
+    // The header: types, then prototypes
+    strbuilder_clear(gen->header);
+    strbuilder_append_cstr(gen->header, cgen_prelude);
+    cgen_typedefs(gen);
+    UInt64 total = 0;
+    for(UInt64 i = 0; i < num_decls; i++) {
+        CGenDecl* decl = cast(CGenDecl*)vec_at(gen->decls, i);
+        strbuilder_append_n(gen->header, decl->proto->data, decl->proto->len);
+        total += decl->code->len;
+    }
+    strbuilder_append_cstr(gen->header, "void adorad_init(void);\n");
+
+    // Split the declarations into contiguous runs of about `total / num_units` bytes each
+    UInt32 num_units = gen->num_units;
+    UInt64 target = (total + num_units - 1) / num_units;
+    UInt64 done = 0;
+    UInt32 u = 0;
+    for(UInt32 i = 0; i < num_units; i++) {
+        StrBuilder* unit = *cast(StrBuilder**)vec_at(gen->units, i);
+        strbuilder_clear(unit);
+        strbuilder_appendf(unit, "// Generated by the Adorad compiler. Do not edit.\n#include \"%s.h\"\n\n", gen->name);
+    }
+    for(UInt64 i = 0; i < num_decls; i++) {
+        CGenDecl* decl = cast(CGenDecl*)vec_at(gen->decls, i);
+        if(u + 1 < num_units && done >= target * (u + 1))
+            u++;
+        StrBuilder* unit = *cast(StrBuilder**)vec_at(gen->units, u);
+        strbuilder_append_n(unit, decl->code->data, decl->code->len);
+        done += decl->code->len;
+    }
+    cgen_entry_points(gen, *cast(StrBuilder**)vec_at(gen->units, 0));
+
+    return vec_size(gen->diagnostics);
+}
+
+typedef struct {
+    CGen* gen;
+    const char* dir;
+    volatile UInt64 num_failed;
+} CGenWriteCtx;
+
+// Write `sb` to `path`. The stream is unbuffered, so the whole file goes out in a single `write()`.
+static bool cgen_write_file(const char* path, StrBuilder* sb) {
+    FILE* file = fopen(path, "wb");
+    if(NONE(file))
+        return false;
+    setvbuf(file, null, _IONBF, 0);
+    bool ok = fwrite(sb->data, 1, sb->len, file) == sb->len;
+    return (fclose(file) == 0) && ok;
+}
+
+static void cgen_write_task(void* arg, UInt64 index, UInt32 worker) {
+    CGenWriteCtx* ctx = cast(CGenWriteCtx*)arg;
+    CGen* gen = ctx->gen;
+    UInt64 len = strlen(ctx->dir) + strlen(gen->name) + 32;
+    char* path = cast(char*)malloc(len);
+    CORETEN_ENFORCE_NN(path, "Could not allocate memory. Memory full.");
+
+    const char* sep = ctx->dir[0] == nullchar ? "" : "/";
+    StrBuilder* sb = null;
+    if(index == 0) {
+        snprintf(path, len, "%s%s%s.h", ctx->dir, sep, gen->name);
+        sb = gen->header;
+    } else {
+        snprintf(path, len, "%s%s%s_%u.c", ctx->dir, sep, gen->name, cast(UInt32)(index - 1));
+        sb = *cast(StrBuilder**)vec_at(gen->units, index - 1);
+    }
+    if(!cgen_write_file(path, sb))
+        atomic64_fetch_add(&ctx->num_failed, 1);
+    free(path);
+}
+
+bool cgen_write(CGen* gen, const char* dir) {
+    CORETEN_ENFORCE_NN(gen->name, "Nothing has been generated yet");
+    CGenWriteCtx ctx = { .gen = gen, .dir = dir, .num_failed = 0 };
+    threadpool_parallel_for(gen->pool, cast(UInt64)gen->num_units + 1, cgen_write_task, &ctx);
+    return ctx.num_failed == 0;
+}
+
+void cgen_print_diagnostics(CGen* gen, FILE* stream) {
+    for(UInt64 i = 0; i < vec_size(gen->diagnostics); i++) {
+        CheckerDiagnostic* diag = cast(CheckerDiagnostic*)vec_at(gen->diagnostics, i);
+        fprintf(stream, "%s:%u:%u: error: %s\n", SOME(diag->fname) ? diag->fname->data : "<unknown>", diag->line,
+                diag->col, diag->msg);
+    }
+}
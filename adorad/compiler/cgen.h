@@ -0,0 +1,82 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#ifndef ADORAD_CGEN_H
+#define ADORAD_CGEN_H
+
+#include <stdio.h>
+#include <adorad/core/types.h>
+#include <adorad/core/vector.h>
+#include <adorad/core/thread.h>
+#include <adorad/core/strbuilder.h>
+#include <adorad/compiler/checker.h>
+#include <adorad/compiler/comptime.h>
+
+/*
+    The C Backend.
+
+    Turns everything a `Checker` checked into C11 that can be compiled with GCC, Clang, MSVC or TCC.
+
+    The output is a header (`<name>.h`: the types, the prototypes of every function and the `extern` declaration of
+    every global) and `num_units` translation units (`<name>_<i>.c`), so the C compiler can compile them in parallel.
+    The C code of every top-level declaration is generated in parallel into its own buffer, and the declarations are
+    then split into contiguous runs of roughly equal size, one per translation unit. Every file is assembled in
+    memory and written to disk with a single `write()`.
+    The buffers are kept around, so a `CGen` used for several builds doesn't reallocate them.
+
+    Naming:
+        - every type `T` is spelled `adorad_T` (`adorad_Int`, `adorad_Opt_Int`, `adorad_Fn2_Int_Int_Int`, ...),
+        - top-level functions and variables are prefixed with `ad_` (functions without a body keep their name,
+          so they can be implemented in C),
+        - locals keep their name, unless it's taken (by a C keyword, or an earlier local of the same function).
+    Global variables are initialized by `adorad_init()`, in dependency order - except for `[comptime]` ones whose
+    value is known (see `CGen.comptime`), which are initialized statically. If the program has a `main()`, the
+    generated C `main()` calls it first; otherwise, whoever links with the generated code has to.
+*/
+
+// The prefix of the C names of types, and of the runtime support the generated code comes with
+#define CGEN_PREFIX     "adorad_"
+
+typedef struct CGenDecl {
+    StrBuilder* proto;      // the prototype/`extern` declaration (for the header)
+    StrBuilder* code;       // C code of the declaration
+    StrBuilder* init;       // the statement initializing a global variable (empty for functions)
+    Vec* types;             // `TypeId`s of the composite types the code uses (may have duplicates)
+    Vec* diagnostics;       // `CheckerDiagnostic`s. null if there are none
+} CGenDecl;
+
+typedef struct CGen {
+    ThreadPool* pool;
+    UInt32 num_units;       // number of translation units
+    Checker* checker;       // of the last `cgen_generate()`
+    Comptime* comptime;     // can be null. Set it to emit the `[comptime]` globals it evaluated as constants
+    char* name;             // base name of the generated files
+
+    Vec* decls;             // `CGenDecl`s, one for every `CheckerUnit` (reused across builds)
+    StrBuilder* header;     // the contents of `<name>.h`
+    Vec* units;             // `StrBuilder*`s: the contents of every `<name>_<i>.c`
+    Vec* diagnostics;       // `CheckerDiagnostic`s of the last `cgen_generate()`, in declaration order
+} CGen;
+
+// `num_threads` is the number of threads generating (and writing) code (0 = one per CPU).
+// `num_units` is the number of translation units to split the output into (at least 1).
+CGen* cgen_new(UInt32 num_threads, UInt32 num_units);
+void cgen_free(CGen* gen);
+// Generate C for everything `checker` checked (which must have succeeded). `name` is the base name of the
+// generated files. Returns the number of errors (things the C backend doesn't support yet).
+UInt64 cgen_generate(CGen* gen, Checker* checker, const char* name);
+// Write the header and every translation unit of the last `cgen_generate()` into `dir`. Returns false on failure.
+bool cgen_write(CGen* gen, const char* dir);
+void cgen_print_diagnostics(CGen* gen, FILE* stream);
+
+#endif // ADORAD_CGEN_H
@@ -0,0 +1,1535 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <adorad/compiler/checker.h>
+#include <adorad/core/debug.h>
+#include <adorad/core/misc.h>
+#include <adorad/runtime/tensor.h>
+
+// Resolution states of a `Symbol`
+enum {
+    SymbolStateUnresolved,
+    SymbolStateResolving,
+    SymbolStateResolved,
+};
+
+// A local variable (or parameter) in scope
+typedef struct {
+    Buff* name;
+    Type* type;
+    bool is_mutable;
+} CheckerLocal;
+
+// Everything needed to check a single unit. Every unit gets its own context, which is what lets units be checked
+// in parallel.
+typedef struct {
+    Checker* checker;
+    CheckerUnit* unit;
+    Vec* locals;            // `CheckerLocal`s in scope (innermost last)
+    UInt64 scope_begin;     // index in `locals` at which the innermost scope begins
+    Type* ret_type;         // return type of the function being checked (null outside of functions)
+    Vec* loops;             // labels (`Buff*`, null if unlabeled) of the enclosing loops (innermost last). null
+                            // until the first loop
+} CheckerCtx;
+
+#define INVALID_TYPE            type_primitive(AdoradTypeInvalid)
+#define IS_INVALID(type)        ((type)->kind == AdoradTypeInvalid)
+#define TYPE_STR(type, buf)     (type_to_str((type), (buf), sizeof(buf)), (buf))
+
+static Type* checker_resolve_symbol(Checker* checker, Symbol* symbol);
+static Type* checker_check_expr(CheckerCtx* ctx, AstNode* node, Type* expected);
+static void checker_check_condition(CheckerCtx* ctx, AstNode* cond, const char* keyword);
+static void checker_check_stmt(CheckerCtx* ctx, AstNode* node);
+
+// FNV-1a
+static inline UInt64 checker_hash(const char* data, UInt64 len) {
+    UInt64 hash = 14695981039346656037ULL;
+    for(UInt64 i = 0; i < len; i++) {
+        hash ^= cast(Byte)data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static void symtab_init(SymbolTable* table, UInt64 num_symbols) {
+    // Keep the load factor at 50% or lower, so probe sequences stay short (and the table never fills up)
+    UInt64 capacity = 16;
+    while(capacity < 2 * num_symbols)
+        capacity <<= 1;
+
+    table->slots = cast(Symbol* volatile*)calloc(capacity, sizeof(Symbol*));
+    CORETEN_ENFORCE_NN(table->slots, "Could not allocate memory. Memory full.");
+    table->mask = capacity - 1;
+}
+
+// Insert `symbol`, unless there's a symbol of the same name already. Returns the symbol that ends up in the table.
+static Symbol* symtab_insert(SymbolTable* table, Symbol* symbol) {
+    UInt64 i = checker_hash(symbol->name->data, symbol->name->len) & table->mask;
+    while(true) {
+        Symbol* existing = cast(Symbol*)atomicptr_load(cast(void* volatile*)&table->slots[i]);
+        if(NONE(existing)) {
+            if(atomicptr_cas(cast(void* volatile*)&table->slots[i], null, symbol))
+                return symbol;
+            // Someone else claimed the slot first
+            existing = cast(Symbol*)atomicptr_load(cast(void* volatile*)&table->slots[i]);
+        }
+        if(buff_cmp(existing->name, symbol->name))
+            return existing;
+        i = (i + 1) & table->mask;
+    }
+}
+
+static Symbol* symtab_lookup(SymbolTable* table, const char* name, UInt64 len) {
+    if(NONE(table->slots))
+        return null;
+
+    UInt64 i = checker_hash(name, len) & table->mask;
+    while(true) {
+        Symbol* symbol = cast(Symbol*)atomicptr_load(cast(void* volatile*)&table->slots[i]);
+        if(NONE(symbol))
+            return null;
+        if(symbol->name->len == len && memcmp(symbol->name->data, name, len) == 0)
+            return symbol;
+        i = (i + 1) & table->mask;
+    }
+}
+
+static void checker_ctx_init(CheckerCtx* ctx, Checker* checker, CheckerUnit* unit) {
+    ctx->checker = checker;
+    ctx->unit = unit;
+    ctx->locals = VEC_NEW(CheckerLocal, 8);
+    ctx->scope_begin = 0;
+    ctx->ret_type = null;
+    ctx->loops = null;
+}
+
+static void checker_ctx_free(CheckerCtx* ctx) {
+    vec_free(ctx->locals);
+    if(SOME(ctx->loops))
+        vec_free(ctx->loops);
+}
+
+// Report an error at `node` (or at the unit's declaration, if `node` has no location)
+ATTRIBUTE_PRINTF(3, 4)
+static void checker_error(CheckerCtx* ctx, AstNode* node, const char* format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    Loc* loc = SOME(node) && SOME(node->loc) ? node->loc : ctx->unit->decl->loc;
+    CheckerDiagnostic diag;
+    diag.fname = SOME(loc) ? loc->fname : null;
+    diag.line = SOME(loc) ? loc->line : 0;
+    diag.col = SOME(loc) ? loc->col : 0;
+    diag.msg = cast(char*)malloc(strlen(buffer) + 1);
+    CORETEN_ENFORCE_NN(diag.msg, "Could not allocate memory. Memory full.");
+    strcpy(diag.msg, buffer);
+
+    if(NONE(ctx->unit->diagnostics))
+        ctx->unit->diagnostics = VEC_NEW(CheckerDiagnostic, 4);
+    vec_push(ctx->unit->diagnostics, &diag);
+}
+
+// Report an error if a value of type `from` (the type of `node`) can't be used as a `to`
+static void checker_expect_assignable(CheckerCtx* ctx, AstNode* node, Type* to, Type* from) {
+    char to_buf[64];
+    char from_buf[64];
+    if(!type_is_assignable(to, from))
+        checker_error(ctx, node, "Cannot use a value of type `%s` as `%s`", TYPE_STR(from, from_buf),
+                      TYPE_STR(to, to_buf));
+}
+
+static CheckerLocal* checker_find_local(CheckerCtx* ctx, Buff* name, UInt64 scope_begin) {
+    for(UInt64 i = vec_size(ctx->locals); i > scope_begin; i--) {
+        CheckerLocal* local = cast(CheckerLocal*)vec_at(ctx->locals, i - 1);
+        if(buff_cmp(local->name, name))
+            return local;
+    }
+    return null;
+}
+
+static void checker_declare_local(CheckerCtx* ctx, AstNode* node, Buff* name, Type* type, bool is_mutable) {
+    if(SOME(checker_find_local(ctx, name, ctx->scope_begin)))
+        checker_error(ctx, node, "`%s` is already declared in this scope", name->data);
+
+    CheckerLocal local = { .name = name, .type = type, .is_mutable = is_mutable };
+    vec_push(ctx->locals, &local);
+}
+
+bool checker_int_literal_value(Buff* literal, UInt64* value) {
+    const char* c = literal->data;
+    const char* end = literal->data + literal->len;
+    UInt64 base = 10;
+    if(end - c > 2 && c[0] == '0') {
+        switch(c[1]) {
+            case 'x': case 'X': base = 16; c += 2; break;
+            case 'b': case 'B': base = 2; c += 2; break;
+            case 'o': case 'O': base = 8; c += 2; break;
+        }
+    }
+
+    // `result * base + digit` overflows iff `result > limit`, or `result == limit && digit > last_digit`
+    UInt64 limit = UINT64_MAX / base;
+    UInt64 last_digit = UINT64_MAX % base;
+    UInt64 result = 0;
+    for(; c < end; c++) {
+        UInt64 digit = 0;
+        if(*c == '_')
+            continue;
+        else if(*c >= '0' && *c <= '9')
+            digit = cast(UInt64)(*c - '0');
+        else if(*c >= 'a' && *c <= 'f')
+            digit = cast(UInt64)(*c - 'a' + 10);
+        else if(*c >= 'A' && *c <= 'F')
+            digit = cast(UInt64)(*c - 'A' + 10);
+        else
+            return false;
+
+        if(digit >= base || result > limit || (result == limit && digit > last_digit))
+            return false;
+        result = result * base + digit;
+    }
+    *value = result;
+    return true;
+}
+
+// Report an error if `elem` can't be the element type of a slice/array
+static bool checker_element_type(CheckerCtx* ctx, AstNode* node, Type* elem) {
+    if(elem->kind == AdoradTypeVoid) {
+        checker_error(ctx, node, "Cannot have a slice or an array of `Void`");
+        return false;
+    }
+    return true;
+}
+
+// `Tensor<elem, N>` (`node`)
+static Type* checker_resolve_tensor_type(CheckerCtx* ctx, AstNode* node, Type* elem) {
+    AstNode* size = node->data.array_type->size;
+    UInt64 rank = 0;
+    char buf[64];
+    if(IS_INVALID(elem))
+        return elem;
+    if(NONE(type_tensor_for(elem))) {
+        checker_error(ctx, node, "A tensor can't hold values of type `%s`", TYPE_STR(elem, buf));
+        return INVALID_TYPE;
+    }
+    if(!checker_int_literal_value(size->data.literal->int_value->value, &rank) || rank < 1 || rank > TENSOR_MAX_RANK) {
+        checker_error(ctx, size, "A tensor has 1 to %d dimensions", TENSOR_MAX_RANK);
+        return INVALID_TYPE;
+    }
+    size->type = type_primitive(AdoradTypeUInt64)->id;
+    return rank == 1 ? type_tensor_for(elem) : type_tensor_of(elem, rank);
+}
+
+static Type* checker_resolve_type(CheckerCtx* ctx, AstNode* node) {
+    Type* type = INVALID_TYPE;
+    switch(node->kind) {
+        case AstNodeKindTypeExpr: {
+            AstNodeTypeExpr* type_expr = node->data.expr->type_expr;
+            type = checker_resolve_type(ctx, type_expr->expr);
+            if(IS_INVALID(type))
+                break;
+            if(type_expr->is_address)
+                type = type_pointer_to(type);
+            else if(type_expr->is_optional)
+                type = type_optional_of(type);
+            else if(type_expr->is_slice_expr)
+                type = checker_element_type(ctx, node, type) ? type_slice_of(type) : INVALID_TYPE;
+            break;
+        }
+        case AstNodeKindArrayType: {
+            AstNodeArrayType* array_type = node->data.array_type;
+            type = checker_resolve_type(ctx, array_type->child_type);
+            if(array_type->is_tensor) {
+                type = checker_resolve_tensor_type(ctx, node, type);
+                break;
+            }
+            if(IS_INVALID(type) || !checker_element_type(ctx, node, type))
+                break;
+
+            // Until constant expressions are supported, the length has to be spelled out
+            UInt64 len = 0;
+            AstNode* size = array_type->size;
+            if(size->kind != AstNodeKindIntLiteral || !checker_int_literal_value(size->data.literal->int_value->value, &len)) {
+                checker_error(ctx, size, "The length of an array must be an integer literal");
+                type = INVALID_TYPE;
+                break;
+            }
+            checker_check_expr(ctx, size, type_primitive(AdoradTypeUInt64));
+            type = type_array_of(type, len);
+            break;
+        }
+        case AstNodeKindIdentifier: {
+            Buff* name = node->data.identifier->name;
+            type = type_from_name(name->data, name->len);
+            if(NONE(type)) {
+                checker_error(ctx, node, "Unknown type `%s`", name->data);
+                type = INVALID_TYPE;
+            }
+            break;
+        }
+        default:
+            checker_error(ctx, node, "Expected a type");
+            break;
+    }
+
+    node->type = type->id;
+    return type;
+}
+
+// The type of an integer literal used where an `expected` is (see `checker_check_expr()`)
+static Type* checker_int_literal_type(Type* expected) {
+    Type* type = SOME(expected) && expected->kind == AdoradTypeOptional ? expected->elem : expected;
+    return SOME(type) && type_is_numeric(type) ? type : type_primitive(AdoradTypeInt);
+}
+
+// Report an error if the integer literal `node` doesn't fit in its type. The literal of `-128` is `128`, which only
+// fits in an `Int8` because it's negated.
+static void checker_check_int_range(CheckerCtx* ctx, AstNode* node, bool is_negated) {
+    Type* type = type_get(node->type);
+    if(type_is_float(type))
+        return;
+    UInt64 bits = cast(UInt64)type_size(type) * 8;
+    UInt64 max = bits == 64 ? UINT64_MAX : (1ULL << bits) - 1;
+    if(type_is_signed(type))
+        max = (1ULL << (bits - 1)) - (is_negated ? 0 : 1);
+
+    UInt64 value = 0;
+    Buff* literal = node->data.literal->int_value->value;
+    char buf[64];
+    if(!checker_int_literal_value(literal, &value) || value > max)
+        checker_error(ctx, node, "The integer literal `%s%s` doesn't fit in `%s`", is_negated ? "-" : "", literal->data,
+                      TYPE_STR(type, buf));
+}
+
+// Untyped literals take on the type of their context
+static bool checker_is_untyped_literal(AstNode* node) {
+    switch(node->kind) {
+        case AstNodeKindIntLiteral:
+        case AstNodeKindFloatLiteral:
+            return true;
+        case AstNodeKindGroupedExpr:
+            return checker_is_untyped_literal(node->data.expr->grouped_expr->expr);
+        case AstNodeKindPrefixOpExpr:
+            return node->data.prefix_op_expr->op == PrefixOpKindMinus &&
+                   checker_is_untyped_literal(node->data.prefix_op_expr->expr);
+        default:
+            return false;
+    }
+}
+
+// Remember that the unit being checked refers to the top-level declaration `name`
+static void checker_add_dep(CheckerCtx* ctx, Buff* name) {
+    CheckerUnit* unit = ctx->unit;
+    if(NONE(unit->deps))
+        unit->deps = VEC_NEW(Buff*, 4);
+    for(UInt64 i = 0; i < vec_size(unit->deps); i++)
+        if(buff_cmp(*cast(Buff**)vec_at(unit->deps, i), name))
+            return;
+    vec_push(unit->deps, &name);
+}
+
+// Returns the type of the variable/function `node` refers to.
+// If `is_mutable` isn't null, it's set to whether `node` can be assigned to.
+static Type* checker_check_identifier(CheckerCtx* ctx, AstNode* node, bool* is_mutable) {
+    Buff* name = node->data.identifier->name;
+    CheckerLocal* local = checker_find_local(ctx, name, 0);
+    if(SOME(local)) {
+        if(SOME(is_mutable))
+            *is_mutable = local->is_mutable;
+        return local->type;
+    }
+
+    checker_add_dep(ctx, name);
+    Symbol* symbol = symtab_lookup(&ctx->checker->globals, name->data, name->len);
+    if(NONE(symbol)) {
+        checker_error(ctx, node, "Undeclared identifier `%s`", name->data);
+        return INVALID_TYPE;
+    }
+
+    // Only possible in pass 1 (global initializers that depend on other globals)
+    if(symbol->state != SymbolStateResolved) {
+        if(symbol->state == SymbolStateResolving) {
+            checker_error(ctx, node, "The initializer of `%s` depends on itself", name->data);
+            return INVALID_TYPE;
+        }
+        checker_resolve_symbol(ctx->checker, symbol);
+    }
+
+    if(SOME(is_mutable))
+        *is_mutable = symbol->kind == SymbolKindVariable && symbol->is_mutable;
+    return symbol->type;
+}
+
+static const char* checker_binary_op_str(BinaryOpKind op) {
+    switch(op) {
+        case BinaryOpKindAssignmentMult: return "*=";
+        case BinaryOpKindAssignmentDiv: return "/=";
+        case BinaryOpKindAssignmentMod: return "%=";
+        case BinaryOpKindAssignmentPlus: return "+=";
+        case BinaryOpKindAssignmentMinus: return "-=";
+        case BinaryOpKindAssignmentBitshiftLeft: return "<<=";
+        case BinaryOpKindAssignmentBitshiftRight: return ">>=";
+        case BinaryOpKindAssignmentBitAnd: return "&=";
+        case BinaryOpKindAssignmentBitXor: return "^=";
+        case BinaryOpKindAssignmentBitOr: return "|=";
+        case BinaryOpKindAssignmentEquals: return "=";
+        case BinaryOpKindCmpEqual: return "==";
+        case BinaryOpKindCmpNotEqual: return "!=";
+        case BinaryOpKindCmpLessThan: return "<";
+        case BinaryOpKindCmpGreaterThan: return ">";
+        case BinaryOpKindCmpLessThanorEqualTo: return "<=";
+        case BinaryOpKindCmpGreaterThanorEqualTo: return ">=";
+        case BinaryOpKindBoolAnd: return "&&";
+        case BinaryOpKindBoolOr: return "||";
+        case BinaryOpKindBitAnd: return "&";
+        case BinaryOpKindBitOr: return "|";
+        case BinaryOpKindBitXor: return "^";
+        case BinaryOpKindBitshitLeft: return "<<";
+        case BinaryOpKindBitshitRight: return ">>";
+        case BinaryOpKindAdd: return "+";
+        case BinaryOpKindSubtract: return "-";
+        case BinaryOpKindMult: return "*";
+        case BinaryOpKindDiv: return "/";
+        case BinaryOpKindMod: return "%";
+        default: return "<invalid>";
+    }
+}
+
+// Is `op` (or its compound assignment) defined for operands of type `type`?
+static bool checker_binary_op_accepts(BinaryOpKind op, Type* type) {
+    switch(op) {
+        case BinaryOpKindAdd:
+        case BinaryOpKindAssignmentPlus:
+            return type_is_numeric(type) || type->kind == AdoradTypeString;
+        case BinaryOpKindSubtract:
+        case BinaryOpKindMult:
+        case BinaryOpKindDiv:
+        case BinaryOpKindAssignmentMinus:
+        case BinaryOpKindAssignmentMult:
+        case BinaryOpKindAssignmentDiv:
+            return type_is_numeric(type);
+        case BinaryOpKindCmpLessThan:
+        case BinaryOpKindCmpGreaterThan:
+        case BinaryOpKindCmpLessThanorEqualTo:
+        case BinaryOpKindCmpGreaterThanorEqualTo:
+            return type_is_numeric(type) || type->kind == AdoradTypeRune;
+        case BinaryOpKindMod:
+        case BinaryOpKindBitAnd:
+        case BinaryOpKindBitOr:
+        case BinaryOpKindBitXor:
+        case BinaryOpKindBitshitLeft:
+        case BinaryOpKindBitshitRight:
+        case BinaryOpKindAssignmentMod:
+        case BinaryOpKindAssignmentBitAnd:
+        case BinaryOpKindAssignmentBitOr:
+        case BinaryOpKindAssignmentBitXor:
+        case BinaryOpKindAssignmentBitshiftLeft:
+        case BinaryOpKindAssignmentBitshiftRight:
+            return type_is_integer(type);
+        default:
+            return true;
+    }
+}
+
+// Check both operands of a binary operator, and return the type they have in common
+static Type* checker_check_operands(CheckerCtx* ctx, AstNode* node, Type* expected) {
+    AstNodeBinaryOpExpr* binop = node->data.expr->binary_op_expr;
+    Type* lhs = null;
+    Type* rhs = null;
+
+    // `1 + x` is just as valid as `x + 1`
+    if(checker_is_untyped_literal(binop->lhs) && !checker_is_untyped_literal(binop->rhs)) {
+        rhs = checker_check_expr(ctx, binop->rhs, expected);
+        lhs = checker_check_expr(ctx, binop->lhs, rhs);
+    } else {
+        lhs = checker_check_expr(ctx, binop->lhs, expected);
+        rhs = checker_check_expr(ctx, binop->rhs, lhs);
+    }
+
+    if(IS_INVALID(lhs) || IS_INVALID(rhs))
+        return INVALID_TYPE;
+    if(type_is_assignable(lhs, rhs))
+        return lhs;
+    if(type_is_assignable(rhs, lhs))
+        return rhs;
+
+    char lhs_buf[64];
+    char rhs_buf[64];
+    checker_error(ctx, node, "Mismatched types `%s` and `%s` for `%s`", TYPE_STR(lhs, lhs_buf),
+                  TYPE_STR(rhs, rhs_buf), checker_binary_op_str(binop->op));
+    return INVALID_TYPE;
+}
+
+// `tensor[i][j]...`: one `Int64` subscript for every dimension. The inner accesses (`tensor[i]`) get the tensor's type.
+static Type* checker_check_index(CheckerCtx* ctx, AstNode* node) {
+    AstNode* tensor = node;
+    UInt32 num_subscripts = 0;
+    while(tensor->kind == AstNodeKindArrayAccessExpr) {
+        tensor = tensor->data.array_access_expr->array_ref_expr;
+        num_subscripts++;
+    }
+    Type* type = checker_check_expr(ctx, tensor, null);
+    Type* int64 = type_primitive(AdoradTypeInt64);
+    // In the order they're written in (`[i]` is the innermost access)
+    for(UInt32 d = 0; d < num_subscripts; d++) {
+        AstNode* access = node;
+        for(UInt32 i = d + 1; i < num_subscripts; i++)
+            access = access->data.array_access_expr->array_ref_expr;
+        AstNode* subscript = access->data.array_access_expr->subscript;
+        checker_expect_assignable(ctx, subscript, int64, checker_check_expr(ctx, subscript, int64));
+        if(access != node)
+            access->type = type->id;
+    }
+    if(IS_INVALID(type))
+        return type;
+
+    char buf[64];
+    UInt32 rank = type_tensor_rank(type);
+    if(rank == 0) {
+        checker_error(ctx, node, "Values of type `%s` can't be indexed", TYPE_STR(type, buf));
+        return INVALID_TYPE;
+    }
+    if(num_subscripts != rank) {
+        checker_error(ctx, node, "A `%s` takes %u ind%s; got %u", TYPE_STR(type, buf), rank, rank == 1 ? "ex" : "ices",
+                      num_subscripts);
+        return INVALID_TYPE;
+    }
+    return type_tensor_elem(type);
+}
+
+// `tensor[lower..upper:step]` (every part is optional): a slice of a tensor of one dimension, of the same type
+static Type* checker_check_slice(CheckerCtx* ctx, AstNode* node) {
+    AstNodeSliceExpr* slice = node->data.expr->slice_expr;
+    Type* type = checker_check_expr(ctx, slice->array_ref_expr, null);
+    Type* int64 = type_primitive(AdoradTypeInt64);
+    AstNode* bounds[] = { slice->lower, slice->upper, slice->step };
+    for(UInt32 i = 0; i < 3; i++)
+        if(SOME(bounds[i]))
+            checker_expect_assignable(ctx, bounds[i], int64, checker_check_expr(ctx, bounds[i], int64));
+    if(IS_INVALID(type))
+        return type;
+
+    char buf[64];
+    UInt32 rank = type_tensor_rank(type);
+    if(rank != 1) {
+        if(rank == 0)
+            checker_error(ctx, node, "Values of type `%s` can't be sliced", TYPE_STR(type, buf));
+        else
+            checker_error(ctx, node, "Only tensors of one dimension can be sliced; got a `%s`", TYPE_STR(type, buf));
+        return INVALID_TYPE;
+    }
+    return type;
+}
+
+static Type* checker_check_assignment(CheckerCtx* ctx, AstNode* node) {
+    AstNodeBinaryOpExpr* binop = node->data.expr->binary_op_expr;
+    Type* lhs = null;
+    if(binop->lhs->kind == AstNodeKindIdentifier) {
+        bool is_mutable = false;
+        lhs = checker_check_identifier(ctx, binop->lhs, &is_mutable);
+        binop->lhs->type = lhs->id;
+        if(!IS_INVALID(lhs) && !is_mutable) {
+            Buff* name = binop->lhs->data.identifier->name;
+            if(lhs->kind == AdoradTypeFunc)
+                checker_error(ctx, binop->lhs, "Cannot assign to function `%s`", name->data);
+            else
+                checker_error(ctx, binop->lhs, "Cannot assign to `%s`, which isn't `mutable`", name->data);
+        }
+    } else if(binop->lhs->kind == AstNodeKindArrayAccessExpr) {
+        // The elements of a tensor can always be assigned to (like they can always be appended to)
+        lhs = checker_check_expr(ctx, binop->lhs, null);
+    } else {
+        lhs = checker_check_expr(ctx, binop->lhs, null);
+        if(!IS_INVALID(lhs))
+            checker_error(ctx, binop->lhs, "Cannot assign to this expression");
+    }
+
+    Type* rhs = checker_check_expr(ctx, binop->rhs, lhs);
+    if(IS_INVALID(lhs) || IS_INVALID(rhs))
+        return type_primitive(AdoradTypeVoid);
+
+    char buf[64];
+    if(!checker_binary_op_accepts(binop->op, lhs))
+        checker_error(ctx, node, "`%s` is not defined for `%s`", checker_binary_op_str(binop->op), TYPE_STR(lhs, buf));
+    else
+        checker_expect_assignable(ctx, binop->rhs, lhs, rhs);
+    return type_primitive(AdoradTypeVoid);
+}
+
+static Type* checker_check_binary_op(CheckerCtx* ctx, AstNode* node, Type* expected) {
+    AstNodeBinaryOpExpr* binop = node->data.expr->binary_op_expr;
+    Type* bool_type = type_primitive(AdoradTypeBool);
+    Type* type = null;
+    char buf[64];
+
+    switch(binop->op) {
+        case BinaryOpKindAssignmentMult:
+        case BinaryOpKindAssignmentDiv:
+        case BinaryOpKindAssignmentMod:
+        case BinaryOpKindAssignmentPlus:
+        case BinaryOpKindAssignmentMinus:
+        case BinaryOpKindAssignmentBitshiftLeft:
+        case BinaryOpKindAssignmentBitshiftRight:
+        case BinaryOpKindAssignmentBitAnd:
+        case BinaryOpKindAssignmentBitXor:
+        case BinaryOpKindAssignmentBitOr:
+        case BinaryOpKindAssignmentEquals:
+            return checker_check_assignment(ctx, node);
+
+        case BinaryOpKindBoolAnd:
+        case BinaryOpKindBoolOr:
+            type = checker_check_expr(ctx, binop->lhs, bool_type);
+            checker_expect_assignable(ctx, binop->lhs, bool_type, type);
+            type = checker_check_expr(ctx, binop->rhs, bool_type);
+            checker_expect_assignable(ctx, binop->rhs, bool_type, type);
+            return bool_type;
+
+        case BinaryOpKindCmpEqual:
+        case BinaryOpKindCmpNotEqual:
+        case BinaryOpKindCmpLessThan:
+        case BinaryOpKindCmpGreaterThan:
+        case BinaryOpKindCmpLessThanorEqualTo:
+        case BinaryOpKindCmpGreaterThanorEqualTo:
+            type = checker_check_operands(ctx, node, null);
+            if(!IS_INVALID(type) && !checker_binary_op_accepts(binop->op, type))
+                checker_error(ctx, node, "`%s` is not defined for `%s`", checker_binary_op_str(binop->op),
+                              TYPE_STR(type, buf));
+            return bool_type;
+
+        default:
+            type = checker_check_operands(ctx, node, expected);
+            if(!IS_INVALID(type) && !checker_binary_op_accepts(binop->op, type)) {
+                checker_error(ctx, node, "`%s` is not defined for `%s`", checker_binary_op_str(binop->op),
+                              TYPE_STR(type, buf));
+                return INVALID_TYPE;
+            }
+            return type;
+    }
+}
+
+static Type* checker_check_prefix_op(CheckerCtx* ctx, AstNode* node, Type* expected) {
+    AstNodePrefixOpExpr* prefix = node->data.prefix_op_expr;
+    Type* bool_type = type_primitive(AdoradTypeBool);
+    Type* type = null;
+    char buf[64];
+
+    switch(prefix->op) {
+        case PrefixOpKindBoolNot:
+        case PrefixOpKindNegation:
+            type = checker_check_expr(ctx, prefix->expr, bool_type);
+            checker_expect_assignable(ctx, prefix->expr, bool_type, type);
+            return bool_type;
+        case PrefixOpKindMinus:
+            if(prefix->expr->kind == AstNodeKindIntLiteral) {
+                type = checker_int_literal_type(expected);
+                prefix->expr->type = type->id;
+                checker_check_int_range(ctx, prefix->expr, true);
+            } else {
+                type = checker_check_expr(ctx, prefix->expr, expected);
+            }
+            if(!IS_INVALID(type) && !(type_is_numeric(type) && type_is_signed(type))) {
+                checker_error(ctx, node, "Cannot negate a value of type `%s`", TYPE_STR(type, buf));
+                return INVALID_TYPE;
+            }
+            return type;
+        case PrefixOpKindAddrOf:
+            type = checker_check_expr(ctx, prefix->expr, null);
+            if(IS_INVALID(type))
+                return type;
+            if(prefix->expr->kind != AstNodeKindIdentifier || type->kind == AdoradTypeFunc) {
+                checker_error(ctx, node, "Can only take the address of a variable");
+                return INVALID_TYPE;
+            }
+            return type_pointer_to(type);
+        default:
+            checker_error(ctx, node, "Unsupported prefix operator");
+            return INVALID_TYPE;
+    }
+}
+
+// The variable `filter()`/`map()` bind each element to
+static Buff checker_it_name = { "it", 2 };
+
+CheckerTensorMethod checker_tensor_method(AstNode* node) {
+    if(node->kind != AstNodeKindFuncCallExpr)
+        return CheckerTensorMethodNone;
+    AstNode* callee = node->data.expr->func_call_expr->func_call_expr;
+    if(callee->kind != AstNodeKindFieldAccessExpr)
+        return CheckerTensorMethodNone;
+
+    static const char* names[] = { null, "filter", "map", "sum", "min", "max", "count", "clone", "sort" };
+    Buff* name = callee->data.field_access_expr->field_name;
+    for(int i = CheckerTensorMethodFilter; i <= CheckerTensorMethodSort; i++)
+        if(name->len == strlen(names[i]) && strncmp(name->data, names[i], name->len) == 0)
+            return cast(CheckerTensorMethod)i;
+    return CheckerTensorMethodNone;
+}
+
+// The variables `sort()` binds two elements to
+static Buff checker_a_name = { "a", 1 };
+static Buff checker_b_name = { "b", 1 };
+
+// Is `y` the expression `x`, with `a` and `b` swapped? Adds the ones `x` uses to `*uses` (1 for `a`, 2 for `b`).
+static bool checker_is_mirrored(AstNode* x, AstNode* y, UInt32* uses) {
+    if(x->kind != y->kind)
+        return false;
+    switch(x->kind) {
+        case AstNodeKindIdentifier: {
+            Buff* name = x->data.identifier->name;
+            Buff* other = y->data.identifier->name;
+            if(buff_cmp(name, &checker_a_name)) {
+                *uses |= 1;
+                return buff_cmp(other, &checker_b_name);
+            }
+            if(buff_cmp(name, &checker_b_name)) {
+                *uses |= 2;
+                return buff_cmp(other, &checker_a_name);
+            }
+            return buff_cmp(name, other);
+        }
+        case AstNodeKindIntLiteral:
+            return buff_cmp(x->data.literal->int_value->value, y->data.literal->int_value->value);
+        case AstNodeKindFloatLiteral:
+            return buff_cmp(x->data.literal->float_value->value, y->data.literal->float_value->value);
+        case AstNodeKindCharLiteral:
+            return buff_cmp(x->data.literal->char_value->value, y->data.literal->char_value->value);
+        case AstNodeKindBoolLiteral:
+            return x->data.literal->bool_value->value == y->data.literal->bool_value->value;
+        case AstNodeKindGroupedExpr:
+            return checker_is_mirrored(x->data.expr->grouped_expr->expr, y->data.expr->grouped_expr->expr, uses);
+        case AstNodeKindPrefixOpExpr:
+            return x->data.prefix_op_expr->op == y->data.prefix_op_expr->op &&
+                   checker_is_mirrored(x->data.prefix_op_expr->expr, y->data.prefix_op_expr->expr, uses);
+        case AstNodeKindBinaryOpExpr: {
+            AstNodeBinaryOpExpr* bx = x->data.expr->binary_op_expr;
+            AstNodeBinaryOpExpr* by = y->data.expr->binary_op_expr;
+            return bx->op == by->op && checker_is_mirrored(bx->lhs, by->lhs, uses) &&
+                   checker_is_mirrored(bx->rhs, by->rhs, uses);
+        }
+        case AstNodeKindArrayAccessExpr: {
+            AstNodeArrayAccessExpr* ax = x->data.array_access_expr;
+            AstNodeArrayAccessExpr* ay = y->data.array_access_expr;
+            return checker_is_mirrored(ax->array_ref_expr, ay->array_ref_expr, uses) &&
+                   checker_is_mirrored(ax->subscript, ay->subscript, uses);
+        }
+        case AstNodeKindFieldAccessExpr:
+            return buff_cmp(x->data.field_access_expr->field_name, y->data.field_access_expr->field_name) &&
+                   checker_is_mirrored(x->data.field_access_expr->struct_expr, y->data.field_access_expr->struct_expr,
+                                       uses);
+        case AstNodeKindFuncCallExpr: {
+            AstNodeFuncCallExpr* cx = x->data.expr->func_call_expr;
+            AstNodeFuncCallExpr* cy = y->data.expr->func_call_expr;
+            if(vec_size(cx->params) != vec_size(cy->params) ||
+               !checker_is_mirrored(cx->func_call_expr, cy->func_call_expr, uses))
+                return false;
+            for(UInt64 i = 0; i < vec_size(cx->params); i++)
+                if(!checker_is_mirrored(cast(AstNode*)vec_at(cx->params, i), cast(AstNode*)vec_at(cy->params, i), uses))
+                    return false;
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+AstNode* checker_sort_key(AstNode* node, bool* descending) {
+    Vec* params = node->data.expr->func_call_expr->params;
+    *descending = false;
+    if(vec_size(params) != 1)
+        return null;
+    AstNode* cond = cast(AstNode*)vec_at(params, 0);
+    while(cond->kind == AstNodeKindGroupedExpr)
+        cond = cond->data.expr->grouped_expr->expr;
+    if(cond->kind != AstNodeKindBinaryOpExpr)
+        return null;
+
+    AstNodeBinaryOpExpr* cmp = cond->data.expr->binary_op_expr;
+    bool greater = false;
+    switch(cmp->op) {
+        case BinaryOpKindCmpLessThan:
+        case BinaryOpKindCmpLessThanorEqualTo: greater = false; break;
+        case BinaryOpKindCmpGreaterThan:
+        case BinaryOpKindCmpGreaterThanorEqualTo: greater = true; break;
+        default: return null;
+    }
+    // The side that uses `a` (and only `a`) is the key
+    UInt32 uses = 0;
+    if(!checker_is_mirrored(cmp->lhs, cmp->rhs, &uses))
+        return null;
+    if(uses == 1) {
+        *descending = greater;
+        return cmp->lhs;
+    }
+    if(uses == 2) {
+        *descending = !greater;
+        return cmp->rhs;
+    }
+    return null;
+}
+
+// The condition of `tensor.sort(cond)`, with `a` and `b` (two elements of type `elem`) in a scope of their own
+static void checker_check_sort(CheckerCtx* ctx, AstNode* node, Type* elem) {
+    AstNode* cond = cast(AstNode*)vec_at(node->data.expr->func_call_expr->params, 0);
+    UInt64 prev_scope_begin = ctx->scope_begin;
+    UInt64 vars_begin = vec_size(ctx->locals);
+    ctx->scope_begin = vars_begin;
+    checker_declare_local(ctx, node, &checker_a_name, elem, false);
+    checker_declare_local(ctx, node, &checker_b_name, elem, false);
+    checker_check_condition(ctx, cond, "sort");
+    while(vec_size(ctx->locals) > vars_begin)
+        vec_pop(ctx->locals);
+    ctx->scope_begin = prev_scope_begin;
+    if(type_get(cond->type)->kind != AdoradTypeBool)
+        return;
+
+    bool descending = false;
+    AstNode* key = checker_sort_key(node, &descending);
+    char buf[64];
+    if(NONE(key)) {
+        checker_error(ctx, cond, "The condition of a `sort` must compare the same expression of `a` and `b` "
+                                 "(like `a %% 10 < b %% 10`)");
+        return;
+    }
+    // The keys are computed into a tensor
+    Type* type = type_get(key->type);
+    if(!IS_INVALID(type) && NONE(type_tensor_for(type)))
+        checker_error(ctx, key, "Can't sort by values of type `%s`", TYPE_STR(type, buf));
+}
+
+// `tensor.method(args)`. The callee (the field access) gets the type of the method.
+static Type* checker_check_tensor_method(CheckerCtx* ctx, AstNode* node) {
+    AstNodeFuncCallExpr* call = node->data.expr->func_call_expr;
+    AstNode* callee = call->func_call_expr;
+    AstNodeFieldAccessExpr* access = callee->data.field_access_expr;
+    Type* receiver = checker_check_expr(ctx, access->struct_expr, null);
+    UInt64 num_args = vec_size(call->params);
+    char buf[64];
+    callee->type = INVALID_TYPE->id;
+    if(IS_INVALID(receiver))
+        return INVALID_TYPE;
+
+    Type* elem = type_tensor_elem(receiver);
+    CheckerTensorMethod method = checker_tensor_method(node);
+    if(NONE(elem)) {
+        checker_error(ctx, callee, "Values of type `%s` don't have methods", TYPE_STR(receiver, buf));
+        return INVALID_TYPE;
+    }
+    if(method == CheckerTensorMethodNone) {
+        checker_error(ctx, callee, "Tensors don't have a method `%s`", access->field_name->data);
+        return INVALID_TYPE;
+    }
+
+    bool takes_expr = method == CheckerTensorMethodFilter || method == CheckerTensorMethodMap;
+    if(method == CheckerTensorMethodSort && num_args > 1) {
+        checker_error(ctx, node, "Expected at most 1 argument; got %" CORETEN_PRIu64, num_args);
+        return INVALID_TYPE;
+    }
+    if(method != CheckerTensorMethodSort && num_args != (takes_expr ? 1 : 0)) {
+        checker_error(ctx, node, "Expected %s argument%s; got %" CORETEN_PRIu64, takes_expr ? "1" : "no",
+                      takes_expr ? "" : "s", num_args);
+        return INVALID_TYPE;
+    }
+
+    Type* result = null;
+    switch(method) {
+        case CheckerTensorMethodSum:
+        case CheckerTensorMethodMin:
+        case CheckerTensorMethodMax: result = elem; break;
+        case CheckerTensorMethodCount: result = type_primitive(AdoradTypeInt64); break;
+        case CheckerTensorMethodClone: result = receiver; break;
+        case CheckerTensorMethodSort:
+            if(num_args == 1)
+                checker_check_sort(ctx, node, elem);
+            result = type_primitive(AdoradTypeVoid);
+            break;
+        default: {
+            // The argument is checked with `it` in a scope of its own
+            AstNode* arg = cast(AstNode*)vec_at(call->params, 0);
+            UInt64 prev_scope_begin = ctx->scope_begin;
+            UInt64 vars_begin = vec_size(ctx->locals);
+            ctx->scope_begin = vars_begin;
+            checker_declare_local(ctx, node, &checker_it_name, elem, false);
+            if(method == CheckerTensorMethodFilter) {
+                checker_check_condition(ctx, arg, "filter");
+                result = type_tensor_for(elem);
+            } else {
+                Type* type = checker_check_expr(ctx, arg, elem);
+                result = IS_INVALID(type) ? type : type_tensor_for(type);
+                if(NONE(result)) {
+                    checker_error(ctx, arg, "A tensor can't hold values of type `%s`", TYPE_STR(type, buf));
+                    result = INVALID_TYPE;
+                }
+            }
+            while(vec_size(ctx->locals) > vars_begin)
+                vec_pop(ctx->locals);
+            ctx->scope_begin = prev_scope_begin;
+            break;
+        }
+    }
+
+    Type* param = elem;
+    callee->type = type_func(&param, takes_expr ? 1 : 0, false, result)->id;
+    return result;
+}
+
+static Type* checker_check_call(CheckerCtx* ctx, AstNode* node) {
+    AstNodeFuncCallExpr* call = node->data.expr->func_call_expr;
+    if(call->func_call_expr->kind == AstNodeKindFieldAccessExpr)
+        return checker_check_tensor_method(ctx, node);
+    Type* callee = checker_check_expr(ctx, call->func_call_expr, null);
+    Vec* args = call->params;
+    UInt64 num_args = vec_size(args);
+    char buf[64];
+
+    bool is_callable = callee->kind == AdoradTypeFunc;
+    if(!is_callable && !IS_INVALID(callee))
+        checker_error(ctx, node, "A value of type `%s` cannot be called", TYPE_STR(callee, buf));
+    if(is_callable && (num_args < callee->num_params || (num_args > callee->num_params && !callee->is_variadic)))
+        checker_error(ctx, node, "Expected %s%u argument%s; got %" CORETEN_PRIu64, callee->is_variadic ? "at least " : "",
+                      callee->num_params, callee->num_params == 1 ? "" : "s", num_args);
+
+    for(UInt64 i = 0; i < num_args; i++) {
+        AstNode* arg = cast(AstNode*)vec_at(args, i);
+        Type* param = is_callable && i < callee->num_params ? callee->params[i] : null;
+        Type* type = checker_check_expr(ctx, arg, param);
+        if(SOME(param))
+            checker_expect_assignable(ctx, arg, param, type);
+        else if(type->kind == AdoradTypeVoid)
+            checker_error(ctx, arg, "This argument has no value");
+    }
+
+    return is_callable ? callee->ret : INVALID_TYPE;
+}
+
+// `keyword` is the statement `cond` is the condition of
+static void checker_check_condition(CheckerCtx* ctx, AstNode* cond, const char* keyword) {
+    Type* bool_type = type_primitive(AdoradTypeBool);
+    Type* type = checker_check_expr(ctx, cond, bool_type);
+    char buf[64];
+    if(!type_is_assignable(bool_type, type))
+        checker_error(ctx, cond, "The condition of %s `%s` must be a `Bool`; got `%s`", keyword[0] == 'i' ? "an" : "a",
+                      keyword, TYPE_STR(type, buf));
+}
+
+static void checker_check_if(CheckerCtx* ctx, AstNode* node) {
+    AstNodeIfExpr* if_expr = node->data.expr->if_expr;
+    checker_check_condition(ctx, if_expr->condition, "if");
+    checker_check_stmt(ctx, if_expr->if_body);
+    if(SOME(if_expr->else_node))
+        checker_check_stmt(ctx, if_expr->else_node);
+}
+
+static void checker_check_return(CheckerCtx* ctx, AstNode* node) {
+    AstNode* expr = node->data.stmt->return_stmt->expr;
+    Type* ret = ctx->ret_type;
+    char buf[64];
+    if(NONE(ret)) {
+        checker_error(ctx, node, "`return` outside of a function");
+        return;
+    }
+
+    if(NONE(expr)) {
+        if(ret->kind != AdoradTypeVoid && !IS_INVALID(ret))
+            checker_error(ctx, node, "Missing return value of type `%s`", TYPE_STR(ret, buf));
+        return;
+    }
+
+    Type* type = checker_check_expr(ctx, expr, ret);
+    if(ret->kind == AdoradTypeVoid)
+        checker_error(ctx, expr, "This function doesn't return a value");
+    else
+        checker_expect_assignable(ctx, expr, ret, type);
+}
+
+static void checker_check_match(CheckerCtx* ctx, AstNode* node) {
+    AstNodeMatchExpr* match = node->data.expr->match_expr;
+    Type* subject = checker_check_expr(ctx, match->expr, null);
+    for(UInt64 i = 0; i < vec_size(match->branches); i++) {
+        AstNode* branch = cast(AstNode*)vec_at(match->branches, i);
+        AstNodeMatchBranchExpr* branch_expr = branch->data.expr->match_branch_expr;
+        AstNode* cond = branch_expr->cond_node;
+        if(branch_expr->is_range) {
+            AstNodeMatchRangeExpr* range = cond->data.expr->match_range_expr;
+            checker_expect_assignable(ctx, range->begin, subject, checker_check_expr(ctx, range->begin, subject));
+            checker_expect_assignable(ctx, range->end, subject, checker_check_expr(ctx, range->end, subject));
+            cond->type = subject->id;
+        } else {
+            checker_expect_assignable(ctx, cond, subject, checker_check_expr(ctx, cond, subject));
+        }
+        checker_check_stmt(ctx, branch_expr->block_node);
+        branch->type = type_primitive(AdoradTypeVoid)->id;
+    }
+}
+
+// `begin..end` of a `loop ... in`. Returns the type of the loop variable.
+static Type* checker_check_range(CheckerCtx* ctx, AstNode* node) {
+    AstNodeMatchRangeExpr* range = node->data.expr->match_range_expr;
+    Type* begin = checker_check_expr(ctx, range->begin, null);
+    Type* end = checker_check_expr(ctx, range->end, begin);
+    Type* type = type_is_assignable(begin, end) ? begin : end;
+    char buf[64];
+    if(IS_INVALID(begin) || IS_INVALID(end)) {
+        type = INVALID_TYPE;
+    } else if(!type_is_integer(type)) {
+        checker_error(ctx, node, "A range must be of integers; got `%s`", TYPE_STR(type, buf));
+        type = INVALID_TYPE;
+    } else {
+        checker_expect_assignable(ctx, range->begin, type, begin);
+        checker_expect_assignable(ctx, range->end, type, end);
+    }
+    node->type = type->id;
+    return type;
+}
+
+// `loop`s have two scopes: the loop variables, and the body
+static void checker_check_loop(CheckerCtx* ctx, AstNode* node) {
+    AstNodeLoopExpr* loop = node->data.expr->loop_expr;
+    UInt64 prev_scope_begin = ctx->scope_begin;
+    UInt64 vars_begin = vec_size(ctx->locals);
+    ctx->scope_begin = vars_begin;
+
+    Vec* statements = null;
+    switch(node->kind) {
+        case AstNodeKindLoopInfExpr:
+            if(SOME(loop->loop_inf_expr->cond))
+                checker_check_condition(ctx, loop->loop_inf_expr->cond, "loop");
+            statements = loop->loop_inf_expr->statements;
+            break;
+        case AstNodeKindLoopCExpr:
+            if(loop->loop_c_expr->has_init)
+                checker_check_stmt(ctx, loop->loop_c_expr->init);
+            if(loop->loop_c_expr->has_cond)
+                checker_check_condition(ctx, loop->loop_c_expr->cond, "loop");
+            if(loop->loop_c_expr->has_updation)
+                checker_check_stmt(ctx, loop->loop_c_expr->updation);
+            statements = loop->loop_c_expr->statements;
+            break;
+        case AstNodeKindLoopInExpr: {
+            AstNodeLoopInExpr* loop_in = loop->loop_in_expr;
+            Type* type = INVALID_TYPE;
+            if(loop_in->is_range) {
+                type = checker_check_range(ctx, loop_in->cond);
+            } else {
+                checker_check_expr(ctx, loop_in->cond, null);
+                checker_error(ctx, loop_in->cond, "Only ranges can be iterated over yet");
+            }
+            checker_declare_local(ctx, node, loop_in->val_var, type, false);
+            statements = loop_in->statements;
+            break;
+        }
+        default:
+            unreachable();
+    }
+
+    if(NONE(ctx->loops))
+        ctx->loops = VEC_NEW(Buff*, 4);
+    vec_push(ctx->loops, &loop->label);
+    ctx->scope_begin = vec_size(ctx->locals);
+    for(UInt64 i = 0; i < vec_size(statements); i++)
+        checker_check_stmt(ctx, cast(AstNode*)vec_at(statements, i));
+    vec_pop(ctx->loops);
+
+    while(vec_size(ctx->locals) > vars_begin)
+        vec_pop(ctx->locals);
+    ctx->scope_begin = prev_scope_begin;
+}
+
+// `break`/`continue`
+static void checker_check_branch(CheckerCtx* ctx, AstNode* node) {
+    AstNodeBranchStatement* branch = node->data.stmt->branch_stmt;
+    const char* keyword = node->kind == AstNodeKindBreak ? "break" : "continue";
+    if(SOME(branch->expr)) {
+        checker_check_expr(ctx, branch->expr, null);
+        checker_error(ctx, branch->expr, "Loops don't have a value, so `break` can't have one");
+    }
+
+    UInt64 num_loops = SOME(ctx->loops) ? vec_size(ctx->loops) : 0;
+    if(num_loops == 0) {
+        checker_error(ctx, node, "`%s` outside of a loop", keyword);
+        return;
+    }
+    if(NONE(branch->name))
+        return;
+    for(UInt64 i = num_loops; i > 0; i--) {
+        Buff* label = *cast(Buff**)vec_at(ctx->loops, i - 1);
+        if(SOME(label) && buff_cmp(label, branch->name))
+            return;
+    }
+    checker_error(ctx, node, "There's no loop labeled `%s` to `%s`", branch->name->data, keyword);
+}
+
+static void checker_check_block(CheckerCtx* ctx, AstNode* node, bool new_scope) {
+    UInt64 prev_scope_begin = ctx->scope_begin;
+    if(new_scope)
+        ctx->scope_begin = vec_size(ctx->locals);
+
+    Vec* statements = node->data.stmt->block_stmt->statements;
+    for(UInt64 i = 0; i < vec_size(statements); i++)
+        checker_check_stmt(ctx, cast(AstNode*)vec_at(statements, i));
+
+    if(new_scope) {
+        while(vec_size(ctx->locals) > ctx->scope_begin)
+            vec_pop(ctx->locals);
+        ctx->scope_begin = prev_scope_begin;
+    }
+    node->type = type_primitive(AdoradTypeVoid)->id;
+}
+
+bool checker_format_kind(Type* type, FormatKind* kind) {
+    switch(type->kind) {
+        case AdoradTypeFloat32: *kind = FormatKindFloat32; return true;
+        case AdoradTypeFloat64: *kind = FormatKindFloat64; return true;
+        case AdoradTypeBool: *kind = FormatKindBool; return true;
+        case AdoradTypeRune: *kind = FormatKindRune; return true;
+        case AdoradTypeString: *kind = FormatKindString; return true;
+        default:
+            if(!type_is_integer(type))
+                return false;
+            *kind = type_is_signed(type) ? FormatKindInt : FormatKindUInt;
+            return true;
+    }
+}
+
+// Every hole of a format string needs a value that can be written, and a spec that fits it
+static void checker_check_format_string(CheckerCtx* ctx, AstNode* node) {
+    Vec* parts = node->data.literal->str_value->parts;
+    char buf[64];
+    for(UInt64 i = 0; i < vec_size(parts); i++) {
+        AstNodeFormatPart* part = cast(AstNodeFormatPart*)vec_at(parts, i);
+        if(NONE(part->expr))
+            continue;
+        Type* type = checker_check_expr(ctx, part->expr, null);
+        if(IS_INVALID(type))
+            continue;
+
+        FormatKind kind;
+        FormatSpec spec = {0};
+        spec.precision = -1;
+        if(!checker_format_kind(type, &kind))
+            checker_error(ctx, part->expr, "Values of type `%s` can't be formatted", TYPE_STR(type, buf));
+        else if(SOME(part->spec) && !format_parse_spec(part->spec->data, part->spec->len, &spec))
+            checker_error(ctx, part->expr, "Invalid format spec `%s`", part->spec->data);
+        else if(!format_spec_accepts(spec, kind))
+            checker_error(ctx, part->expr, "The format spec `%s` can't be used for values of type `%s`",
+                          part->spec->data, TYPE_STR(type, buf));
+    }
+}
+
+static Type* checker_check_expr(CheckerCtx* ctx, AstNode* node, Type* expected) {
+    // Literals are typed by what they're used as, through an optional (`?Int`) if needed
+    Type* literal_type = SOME(expected) && expected->kind == AdoradTypeOptional ? expected->elem : expected;
+    Type* type = type_primitive(AdoradTypeVoid);
+
+    switch(node->kind) {
+        case AstNodeKindIntLiteral:
+            type = checker_int_literal_type(expected);
+            node->type = type->id;
+            checker_check_int_range(ctx, node, false);
+            break;
+        case AstNodeKindFloatLiteral:
+            type = SOME(literal_type) && type_is_float(literal_type) ? literal_type : type_primitive(AdoradTypeFloat32);
+            break;
+        case AstNodeKindCharLiteral: type = type_primitive(AdoradTypeRune); break;
+        case AstNodeKindStringLiteral:
+            if(node->data.literal->str_value->type == AstNodeStringLiteralFormat)
+                checker_check_format_string(ctx, node);
+            type = type_primitive(AdoradTypeString);
+            break;
+        case AstNodeKindBoolLiteral: type = type_primitive(AdoradTypeBool); break;
+        case AstNodeKindNilLiteral: type = type_primitive(AdoradTypeNull); break;
+
+        case AstNodeKindIdentifier: type = checker_check_identifier(ctx, node, null); break;
+        case AstNodeKindGroupedExpr: type = checker_check_expr(ctx, node->data.expr->grouped_expr->expr, expected); break;
+        case AstNodeKindAttributeExpr: type = checker_check_expr(ctx, node->data.expr->attr_expr->expr, expected); break;
+        case AstNodeKindPrefixOpExpr: type = checker_check_prefix_op(ctx, node, expected); break;
+        case AstNodeKindBinaryOpExpr: type = checker_check_binary_op(ctx, node, expected); break;
+        case AstNodeKindFuncCallExpr: type = checker_check_call(ctx, node); break;
+        case AstNodeKindArrayAccessExpr: type = checker_check_index(ctx, node); break;
+        case AstNodeKindSliceExpr: type = checker_check_slice(ctx, node); break;
+
+        // These don't have a value
+        case AstNodeKindIfExpr: checker_check_if(ctx, node); break;
+        case AstNodeKindMatchExpr: checker_check_match(ctx, node); break;
+        case AstNodeKindReturn: checker_check_return(ctx, node); break;
+        case AstNodeKindBlock: checker_check_block(ctx, node, true); break;
+        case AstNodeKindLoopInfExpr:
+        case AstNodeKindLoopCExpr:
+        case AstNodeKindLoopInExpr: checker_check_loop(ctx, node); break;
+        case AstNodeKindBreak:
+        case AstNodeKindContinue: checker_check_branch(ctx, node); break;
+        case AstNodeKindUnreachable:
+            break;
+
+        default:
+            checker_error(ctx, node, "The checker doesn't support this kind of expression yet");
+            type = INVALID_TYPE;
+            break;
+    }
+
+    node->type = type->id;
+    return type;
+}
+
+// The type of a variable declared without a type annotation
+static Type* checker_infer_var_type(CheckerCtx* ctx, AstNode* node, Type* init_type) {
+    Buff* name = node->data.scope_obj->var->name;
+    switch(init_type->kind) {
+        case AdoradTypeVoid:
+            checker_error(ctx, node, "`%s` is initialized with an expression that has no value", name->data);
+            return INVALID_TYPE;
+        case AdoradTypeNull:
+            checker_error(ctx, node, "Cannot infer the type of `%s` from `null`", name->data);
+            return INVALID_TYPE;
+        default:
+            return init_type;
+    }
+}
+
+// Resolve the type annotation of a variable (which must have one)
+static Type* checker_resolve_var_type(CheckerCtx* ctx, AstNode* node) {
+    AstNodeVariable* var = node->data.scope_obj->var;
+    Type* type = checker_resolve_type(ctx, var->type_expr);
+    if(type->kind == AdoradTypeVoid) {
+        checker_error(ctx, var->type_expr, "Variable `%s` cannot be `void`", var->name->data);
+        return INVALID_TYPE;
+    }
+    return type;
+}
+
+static void checker_check_var_init(CheckerCtx* ctx, AstNode* node, Type* type) {
+    AstNode* init_expr = node->data.scope_obj->var->init_expr;
+    if(SOME(init_expr))
+        checker_expect_assignable(ctx, init_expr, type, checker_check_expr(ctx, init_expr, type));
+}
+
+static void checker_check_local_var(CheckerCtx* ctx, AstNode* node) {
+    AstNodeVariable* var = node->data.scope_obj->var;
+    Type* type = null;
+    if(SOME(var->type_expr)) {
+        type = checker_resolve_var_type(ctx, node);
+        checker_check_var_init(ctx, node, type);
+    } else {
+        type = checker_infer_var_type(ctx, node, checker_check_expr(ctx, var->init_expr, null));
+    }
+    node->type = type->id;
+
+    // Declared after its initializer is checked, so `put x = x + 1` refers to an outer `x`
+    checker_declare_local(ctx, node, var->name, type, var->is_mutable);
+}
+
+static void checker_check_stmt(CheckerCtx* ctx, AstNode* node) {
+    switch(node->kind) {
+        case AstNodeKindVariableDecl: checker_check_local_var(ctx, node); break;
+        default: checker_check_expr(ctx, node, null); break;
+    }
+}
+
+static Vec* checker_loop_statements(AstNode* node) {
+    switch(node->kind) {
+        case AstNodeKindLoopInfExpr: return node->data.expr->loop_expr->loop_inf_expr->statements;
+        case AstNodeKindLoopCExpr: return node->data.expr->loop_expr->loop_c_expr->statements;
+        default: return node->data.expr->loop_expr->loop_in_expr->statements;
+    }
+}
+
+// Can a `break` in `node` leave the loop labeled `label`, which `node` is `depth` loops deep in?
+static bool checker_breaks_out(AstNode* node, Buff* label, UInt32 depth) {
+    Vec* statements = null;
+    switch(node->kind) {
+        case AstNodeKindBreak: {
+            Buff* name = node->data.stmt->branch_stmt->name;
+            return NONE(name) ? depth == 0 : SOME(label) && buff_cmp(name, label);
+        }
+        case AstNodeKindBlock:
+            statements = node->data.stmt->block_stmt->statements;
+            break;
+        case AstNodeKindIfExpr: {
+            AstNodeIfExpr* if_expr = node->data.expr->if_expr;
+            return checker_breaks_out(if_expr->if_body, label, depth) ||
+                   (SOME(if_expr->else_node) && checker_breaks_out(if_expr->else_node, label, depth));
+        }
+        case AstNodeKindMatchExpr: {
+            Vec* branches = node->data.expr->match_expr->branches;
+            for(UInt64 i = 0; i < vec_size(branches); i++) {
+                AstNode* branch = cast(AstNode*)vec_at(branches, i);
+                if(checker_breaks_out(branch->data.expr->match_branch_expr->block_node, label, depth))
+                    return true;
+            }
+            return false;
+        }
+        case AstNodeKindLoopInfExpr:
+        case AstNodeKindLoopCExpr:
+        case AstNodeKindLoopInExpr: {
+            // An inner loop with the same label hides ours
+            Buff* inner = node->data.expr->loop_expr->label;
+            if(SOME(label) && SOME(inner) && buff_cmp(label, inner))
+                label = null;
+            statements = checker_loop_statements(node);
+            depth++;
+            break;
+        }
+        default:
+            return false;
+    }
+
+    for(UInt64 i = 0; i < vec_size(statements); i++)
+        if(checker_breaks_out(cast(AstNode*)vec_at(statements, i), label, depth))
+            return true;
+    return false;
+}
+
+// Does control never reach the end of `node`?
+static bool checker_stmt_terminates(AstNode* node) {
+    switch(node->kind) {
+        case AstNodeKindReturn:
+        case AstNodeKindUnreachable:
+            return true;
+        case AstNodeKindBlock: {
+            Vec* statements = node->data.stmt->block_stmt->statements;
+            for(UInt64 i = 0; i < vec_size(statements); i++)
+                if(checker_stmt_terminates(cast(AstNode*)vec_at(statements, i)))
+                    return true;
+            return false;
+        }
+        case AstNodeKindIfExpr: {
+            AstNodeIfExpr* if_expr = node->data.expr->if_expr;
+            return SOME(if_expr->else_node) && checker_stmt_terminates(if_expr->if_body) &&
+                   checker_stmt_terminates(if_expr->else_node);
+        }
+        case AstNodeKindLoopInfExpr:
+        case AstNodeKindLoopCExpr: {
+            // A loop without a condition only ends with a `break`
+            bool has_cond = node->kind == AstNodeKindLoopInfExpr ? SOME(node->data.expr->loop_expr->loop_inf_expr->cond) :
+                                                                   node->data.expr->loop_expr->loop_c_expr->has_cond;
+            if(has_cond)
+                return false;
+            Vec* statements = checker_loop_statements(node);
+            for(UInt64 i = 0; i < vec_size(statements); i++)
+                if(checker_breaks_out(cast(AstNode*)vec_at(statements, i), node->data.expr->loop_expr->label, 0))
+                    return false;
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+static Type* checker_resolve_signature(CheckerCtx* ctx, AstNodeFuncDecl* func) {
+    AstNodeParamList* param_list = func->params->data.param_list;
+    UInt64 num_params = vec_size(param_list->params);
+    Type** params = null;
+    if(num_params > 0) {
+        params = cast(Type**)malloc(num_params * sizeof(Type*));
+        CORETEN_ENFORCE_NN(params, "Could not allocate memory. Memory full.");
+    }
+
+    for(UInt64 i = 0; i < num_params; i++) {
+        AstNode* param = cast(AstNode*)vec_at(param_list->params, i);
+        Type* type = checker_resolve_type(ctx, param->data.param_decl->type);
+        if(type->kind == AdoradTypeVoid) {
+            checker_error(ctx, param, "Parameter `%s` cannot be `void`", param->data.param_decl->name->data);
+            type = INVALID_TYPE;
+        }
+        param->type = type->id;
+        params[i] = type;
+    }
+
+    Type* ret = SOME(func->return_type) ? checker_resolve_type(ctx, func->return_type) : type_primitive(AdoradTypeVoid);
+    Type* type = type_func(params, cast(UInt32)num_params, param_list->is_variadic, ret);
+    free(params);
+    return type;
+}
+
+// Pass 1: resolve the type of a top-level declaration
+static Type* checker_resolve_symbol(Checker* checker, Symbol* symbol) {
+    if(symbol->state == SymbolStateResolved)
+        return symbol->type;
+    CORETEN_ENFORCE(symbol->state == SymbolStateUnresolved);
+
+    CheckerUnit* unit = cast(CheckerUnit*)vec_at(checker->units, symbol->unit);
+    CheckerCtx ctx;
+    checker_ctx_init(&ctx, checker, unit);
+    symbol->state = SymbolStateResolving;
+
+    Type* type = null;
+    if(symbol->kind == SymbolKindFunc) {
+        type = checker_resolve_signature(&ctx, symbol->decl->data.decl->func_decl);
+    } else if(SOME(symbol->decl->data.scope_obj->var->type_expr)) {
+        // The initializer is checked in pass 2
+        type = checker_resolve_var_type(&ctx, symbol->decl);
+    } else {
+        // Other signatures may depend on this one, so the initializer has to be checked now
+        AstNode* init_expr = symbol->decl->data.scope_obj->var->init_expr;
+        type = checker_infer_var_type(&ctx, symbol->decl, checker_check_expr(&ctx, init_expr, null));
+        unit->is_checked = true;
+    }
+
+    symbol->type = type;
+    symbol->decl->type = type->id;
+    symbol->state = SymbolStateResolved;
+    checker_ctx_free(&ctx);
+    return type;
+}
+
+static void checker_check_func_body(CheckerCtx* ctx, AstNode* node) {
+    AstNodeFuncDecl* func = node->data.decl->func_decl;
+    Type* type = type_get(node->type);
+    if(func->no_body || NONE(func->body))
+        return;
+
+    // Parameters live in the same scope as the function body's top-level statements
+    ctx->ret_type = type->ret;
+    Vec* params = func->params->data.param_list->params;
+    for(UInt64 i = 0; i < vec_size(params); i++) {
+        AstNode* param = cast(AstNode*)vec_at(params, i);
+        checker_declare_local(ctx, param, param->data.param_decl->name, type->params[i], false);
+    }
+    checker_check_block(ctx, func->body, false);
+
+    if(type->ret->kind != AdoradTypeVoid && !IS_INVALID(type->ret) && !checker_stmt_terminates(func->body))
+        checker_error(ctx, node, "Function `%s` doesn't return a value on every path", func->name->data);
+}
+
+// Pass 2: runs on the thread pool, once for every unit
+static void checker_check_unit_task(void* arg, UInt64 index, UInt32 worker) {
+    Checker* checker = cast(Checker*)arg;
+    CheckerUnit* unit = cast(CheckerUnit*)vec_at(checker->units, index);
+    if(unit->is_checked)
+        return;
+
+    CheckerCtx ctx;
+    checker_ctx_init(&ctx, checker, unit);
+    if(unit->decl->kind == AstNodeKindFuncDecl)
+        checker_check_func_body(&ctx, unit->decl);
+    else
+        checker_check_var_init(&ctx, unit->decl, unit->symbol->type);
+    unit->is_checked = true;
+    checker_ctx_free(&ctx);
+}
+
+Checker* checker_new(UInt32 num_threads) {
+    Checker* checker = cast(Checker*)calloc(1, sizeof(Checker));
+    CORETEN_ENFORCE_NN(checker, "Could not allocate memory. Memory full.");
+    checker->pool = threadpool_new(num_threads);
+    checker->units = VEC_NEW(CheckerUnit, 16);
+    checker->diagnostics = VEC_NEW(CheckerDiagnostic, 4);
+    return checker;
+}
+
+void checker_free(Checker* checker) {
+    if(NONE(checker))
+        return;
+
+    for(UInt64 i = 0; i < vec_size(checker->units); i++) {
+        CheckerUnit* unit = cast(CheckerUnit*)vec_at(checker->units, i);
+        free(unit->symbol);
+        vec_free(unit->diagnostics);
+        vec_free(unit->deps);
+    }
+    for(UInt64 i = 0; i < vec_size(checker->diagnostics); i++)
+        free((cast(CheckerDiagnostic*)vec_at(checker->diagnostics, i))->msg);
+
+    vec_free(checker->units);
+    vec_free(checker->diagnostics);
+    free(cast(void*)checker->globals.slots);
+    threadpool_free(checker->pool);
+    free(checker);
+}
+
+UInt64 checker_check(Checker* checker, Parser** parsers, UInt64 num_parsers) {
+    CORETEN_ENFORCE(vec_size(checker->units) == 0, "A Checker can only check one set of files");
+
+    // Every top-level function/variable is a unit
+    for(UInt64 p = 0; p < num_parsers; p++) {
+        Vec* nodelist = parsers[p]->nodelist;
+        for(UInt64 i = 0; i < vec_size(nodelist); i++) {
+            AstNode* decl = cast(AstNode*)vec_at(nodelist, i);
+            if(decl->kind != AstNodeKindFuncDecl && decl->kind != AstNodeKindVariableDecl)
+                continue;
+
+            CheckerUnit unit = { .decl = decl };
+            vec_push(checker->units, &unit);
+        }
+    }
+    UInt64 num_units = vec_size(checker->units);
+
+    // Pass 1 (serial): register every declaration, then resolve their signatures
+    symtab_init(&checker->globals, num_units);
+    for(UInt64 i = 0; i < num_units; i++) {
+        CheckerUnit* unit = cast(CheckerUnit*)vec_at(checker->units, i);
+        Symbol* symbol = cast(Symbol*)calloc(1, sizeof(Symbol));
+        CORETEN_ENFORCE_NN(symbol, "Could not allocate memory. Memory full.");
+        symbol->decl = unit->decl;
+        symbol->unit = cast(UInt32)i;
+        symbol->state = SymbolStateUnresolved;
+        if(unit->decl->kind == AstNodeKindFuncDecl) {
+            symbol->kind = SymbolKindFunc;
+            symbol->name = unit->decl->data.decl->func_decl->name;
+        } else {
+            symbol->kind = SymbolKindVariable;
+            symbol->name = unit->decl->data.scope_obj->var->name;
+            symbol->is_mutable = unit->decl->data.scope_obj->var->is_mutable;
+        }
+        unit->symbol = symbol;
+
+        CheckerCtx ctx = { .checker = checker, .unit = unit };
+        if(NONE(symbol->name))
+            checker_error(&ctx, unit->decl, "Top-level functions must have a name");
+        else if(symtab_insert(&checker->globals, symbol) != symbol)
+            checker_error(&ctx, unit->decl, "Redefinition of `%s`", symbol->name->data);
+    }
+    for(UInt64 i = 0; i < num_units; i++)
+        checker_resolve_symbol(checker, (cast(CheckerUnit*)vec_at(checker->units, i))->symbol);
+    if(SOME(checker->filter)) {
+        for(UInt64 i = 0; i < num_units; i++) {
+            CheckerUnit* unit = cast(CheckerUnit*)vec_at(checker->units, i);
+            if(!unit->is_checked && !checker->filter(checker->filter_ctx, checker, unit))
+                unit->is_checked = unit->is_skipped = true;
+        }
+    }
+
+    // Pass 2 (parallel): function bodies and the remaining global initializers
+    threadpool_parallel_for(checker->pool, num_units, checker_check_unit_task, checker);
+
+    // Diagnostics, in declaration order
+    for(UInt64 i = 0; i < num_units; i++) {
+        CheckerUnit* unit = cast(CheckerUnit*)vec_at(checker->units, i);
+        if(NONE(unit->diagnostics))
+            continue;
+        unit->num_errors = cast(UInt32)vec_size(unit->diagnostics);
+        for(UInt64 j = 0; j < vec_size(unit->diagnostics); j++)
+            vec_push(checker->diagnostics, vec_at(unit->diagnostics, j));
+        vec_free(unit->diagnostics);
+        unit->diagnostics = null;
+    }
+    return vec_size(checker->diagnostics);
+}
+
+Symbol* checker_lookup(Checker* checker, const char* name, UInt64 len) {
+    return symtab_lookup(&checker->globals, name, len);
+}
+
+void checker_print_diagnostics(Checker* checker, FILE* stream) {
+    for(UInt64 i = 0; i < vec_size(checker->diagnostics); i++) {
+        CheckerDiagnostic* diag = cast(CheckerDiagnostic*)vec_at(checker->diagnostics, i);
+        fprintf(stream, "%s:%u:%u: error: %s\n", SOME(diag->fname) ? diag->fname->data : "<unknown>", diag->line,
+                diag->col, diag->msg);
+    }
+}
@@ -0,0 +1,133 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#ifndef ADORAD_CHECKER_H
+#define ADORAD_CHECKER_H
+
+#include <stdio.h>
+#include <adorad/core/types.h>
+#include <adorad/core/buffer.h>
+#include <adorad/core/vector.h>
+#include <adorad/core/thread.h>
+#include <adorad/compiler/ast.h>
+#include <adorad/compiler/parser.h>
+#include <adorad/compiler/types.h>
+#include <adorad/runtime/format.h>
+
+/*
+    The Adorad Type Checker.
+
+    Every top-level function and variable declaration is an independent unit of work. Checking happens in two passes:
+        1. (serial) Every declaration is registered in the global symbol table, and its signature is resolved: the
+           parameter and return types of functions, and the types of global variables. A global without a type
+           annotation has its initializer checked here, since other signatures may depend on it.
+        2. (parallel) Function bodies and the remaining global initializers are checked on a thread pool.
+           By now, the global symbol table is read-only and every unit only writes to its own AST and diagnostics,
+           so units never wait on each other.
+
+    Diagnostics are reported in declaration order, no matter how many threads are used.
+*/
+
+typedef enum {
+    SymbolKindFunc,
+    SymbolKindVariable,
+} SymbolKind;
+
+// A top-level declaration
+typedef struct Symbol {
+    SymbolKind kind;
+    Buff* name;
+    AstNode* decl;      // the FuncDecl/VariableDecl node
+    Type* type;         // null until resolved in pass 1
+    bool is_mutable;
+    UInt32 unit;        // index of the declaring `CheckerUnit`
+    UInt8 state;        // resolution state (pass 1 only)
+} Symbol;
+
+// The global symbol table.
+// Open addressing with linear probing: a slot is claimed with a CAS and never emptied again, so lookups never need
+// a lock (and are plain loads once pass 1 is over).
+typedef struct SymbolTable {
+    Symbol* volatile* slots;
+    UInt64 mask;        // capacity - 1 (the capacity is a power of 2)
+} SymbolTable;
+
+typedef struct CheckerDiagnostic {
+    Buff* fname;        // can be null
+    UInt32 line;
+    UInt32 col;
+    char* msg;
+} CheckerDiagnostic;
+
+typedef struct CheckerUnit {
+    AstNode* decl;
+    Symbol* symbol;
+    Vec* diagnostics;   // `CheckerDiagnostic`s. null if there are none (and after they're merged into the Checker's)
+    Vec* deps;          // names (`Buff*`) of the top-level declarations the unit refers to, whether they exist or not.
+                        // null if there are none
+    UInt32 num_errors;
+    bool is_checked;    // nothing left to do in pass 2
+    bool is_skipped;    // pass 2 was skipped (see `Checker.filter`)
+} CheckerUnit;
+
+typedef struct Checker Checker;
+
+// Called (serially) between the two passes, for every unit that pass 2 would check. Returning false skips the unit.
+typedef bool (*CheckerFilter)(void* ctx, Checker* checker, CheckerUnit* unit);
+
+struct Checker {
+    ThreadPool* pool;
+    SymbolTable globals;
+    Vec* units;         // `CheckerUnit`s, in declaration order
+    Vec* diagnostics;   // `CheckerDiagnostic`s of all units, in declaration order
+    CheckerFilter filter;   // can be null
+    void* filter_ctx;
+};
+
+// The methods of tensors. `filter()` and `map()` take an expression of `it` (the element at hand), and a chain of them
+// (`xs.filter(it > 0).map(it * 2).sum()`) is a single loop over `xs` (see <adorad/compiler/ir.h>).
+typedef enum CheckerTensorMethod {
+    CheckerTensorMethodNone,    // not a call to a tensor method
+    CheckerTensorMethodFilter,  // `filter(cond)`: the elements `cond` is true for
+    CheckerTensorMethodMap,     // `map(expr)`: `expr` of every element
+    CheckerTensorMethodSum,     // `sum()`
+    CheckerTensorMethodMin,     // `min()` (of at least one element)
+    CheckerTensorMethodMax,     // `max()` (of at least one element)
+    CheckerTensorMethodCount,   // `count()`: the number of elements, as an `Int64`
+    CheckerTensorMethodClone,   // `clone()`: a copy of the tensor that owns its elements (slices share them)
+    CheckerTensorMethodSort,    // `sort()`, `sort(a > b)`, `sort(key(a) < key(b))`: see `checker_sort_key()`
+} CheckerTensorMethod;
+
+// `num_threads` is the number of threads checking function bodies (0 = one per CPU)
+Checker* checker_new(UInt32 num_threads);
+void checker_free(Checker* checker);
+// Check the top-level declarations of `parsers` (which must have been parsed already) as one global scope.
+// Every checked expression/declaration has its `AstNode.type` set. Returns the number of errors.
+UInt64 checker_check(Checker* checker, Parser** parsers, UInt64 num_parsers);
+// Returns the top-level declaration `name` (or null)
+Symbol* checker_lookup(Checker* checker, const char* name, UInt64 len);
+// Parse the spelling of an integer literal (`42`, `0x2A`, `1_000`, ...). Returns false if it doesn't fit in 64 bits.
+bool checker_int_literal_value(Buff* literal, UInt64* value);
+// The tensor method `node` calls (going by its name: whether the receiver is a tensor is up to the checker)
+CheckerTensorMethod checker_tensor_method(AstNode* node);
+// The key `xs.sort(cond)` sorts the elements of `xs` by: `cond` compares (`<`, `<=`, `>` or `>=`) the same expression
+// of `a` and of `b`, and the key is the side that uses `a` (`a` itself for `a > b`). `*descending` is set to whether
+// the smaller key goes last. Returns null for `xs.sort()` (which sorts in ascending order), and if `cond` isn't such a
+// comparison.
+AstNode* checker_sort_key(AstNode* node, bool* descending);
+// How a value of type `type` goes into a hole of a format string. Returns false if it can't.
+bool checker_format_kind(Type* type, FormatKind* kind);
+// Print all diagnostics as `file:line:col: error: message`
+void checker_print_diagnostics(Checker* checker, FILE* stream);
+
+#endif // ADORAD_CHECKER_H
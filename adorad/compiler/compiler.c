@@ -11,4 +11,15 @@ SPDX-License-Identifier: MIT
 Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
 */
 
-#include <adorad/compiler/compiler.h>
\ No newline at end of file
+#include <adorad/core/os_defs.h>
+#include <adorad/compiler/compiler.h>
+
+OutputArch output_arch_host() {
+#if defined(CORETEN_ARCH_X86_64)
+    return OutputArchAmd64;
+#elif defined(CORETEN_ARCH_ARM64)
+    return OutputArchArm64;
+#else
+    return OutputArchAuto;
+#endif
+}
@@ -11,6 +11,9 @@ SPDX-License-Identifier: MIT
 Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
 */
 
+#ifndef ADORAD_COMPILER_H
+#define ADORAD_COMPILER_H
+
 typedef enum {
     TimeFormatTime__hhmm12,
     TimeFormatTime__hhmm24,
@@ -67,3 +70,8 @@ typedef enum {
     OutputArchRv32,
     OutputArchI386,
 } OutputArch;
+
+// The architecture the compiler runs on (`OutputArchAuto` if it isn't one of the above)
+OutputArch output_arch_host();
+
+#endif // ADORAD_COMPILER_H
@@ -0,0 +1,925 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <adorad/compiler/comptime.h>
+#include <adorad/compiler/opt.h>
+
+enum {
+    ComptimeGlobalUnknown,
+    ComptimeGlobalBusy,     // being evaluated (so reading it again is a cycle)
+    ComptimeGlobalKnown,
+};
+
+struct ComptimeMemo {
+    IrFunc* func;           // null for an empty slot
+    UInt64 hash;
+    ComptimeValue* args;
+    ComptimeValue result;
+};
+
+#define COMPTIME_MEMO_INIT_CAP  256
+
+static bool comptime_fail(Comptime* ct, const char* format, ...) {
+    // The first error is the innermost one
+    if(SOME(ct->error))
+        return false;
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    ct->error = cast(char*)malloc(strlen(buffer) + 1);
+    CORETEN_ENFORCE_NN(ct->error, "Could not allocate memory. Memory full.");
+    strcpy(ct->error, buffer);
+    return false;
+}
+
+// Start a new evaluation, with a fresh budget
+static void comptime_begin(Comptime* ct) {
+    ct->total_steps += ct->steps;
+    ct->steps = 0;
+    ct->memory = 0;
+    free(ct->error);
+    ct->error = null;
+}
+
+static bool comptime_alloc(Comptime* ct, UInt64 bytes) {
+    ct->memory += bytes;
+    if(ct->memory > ct->max_memory)
+        return comptime_fail(ct, "it needs more than %" CORETEN_PRIu64 " bytes of memory", ct->max_memory);
+    return true;
+}
+
+static inline const char* comptime_name(IrFunc* func) {
+    return func->symbol->name->data;
+}
+
+static inline IrFunc* comptime_func_of(Comptime* ct, Symbol* symbol) {
+    return *cast(IrFunc**)vec_at(ct->module->funcs, symbol->unit);
+}
+
+static bool comptime_is_comptime_func(Symbol* symbol) {
+    return symbol->kind == SymbolKindFunc && symbol->decl->data.decl->func_decl->is_comptime;
+}
+
+static bool comptime_is_comptime_var(Symbol* symbol) {
+    return symbol->kind == SymbolKindVariable && symbol->decl->data.scope_obj->var->is_comptime;
+}
+
+// Values ----------------------------------------------------------------------------------------------------------
+
+// The lexer spells the empty string `""`
+static inline UInt64 comptime_str_len(Buff* str) {
+    return str->len == 2 && str->data[0] == '"' && str->data[1] == '"' ? 0 : str->len;
+}
+
+// A new string of `len` bytes (to be filled in by the caller)
+static Buff* comptime_new_str(Comptime* ct, UInt64 len) {
+    char* data = cast(char*)calloc(len + 1, 1);
+    CORETEN_ENFORCE_NN(data, "Could not allocate memory. Memory full.");
+    Buff* str = buff_new(data);
+    str->len = len;
+    vec_push(ct->strings, &str);
+    return str;
+}
+
+static bool comptime_concat(Comptime* ct, Buff* a, Buff* b, ComptimeValue* out) {
+    UInt64 len_a = comptime_str_len(a);
+    UInt64 len_b = comptime_str_len(b);
+    if(len_b == 0 || len_a == 0) {
+        out->str = len_b == 0 ? a : b;
+        return true;
+    }
+    if(!comptime_alloc(ct, len_a + len_b + 1))
+        return false;
+    Buff* str = comptime_new_str(ct, len_a + len_b);
+    memcpy(str->data, a->data, len_a);
+    memcpy(str->data + len_a, b->data, len_b);
+    out->str = str;
+    return true;
+}
+
+static inline Type* comptime_payload_type(Type* type) {
+    return type->kind == AdoradTypeOptional ? type->elem : type;
+}
+
+static UInt64 comptime_hash_value(UInt64 hash, Type* type, ComptimeValue* value) {
+    hash = (hash ^ value->is_null) * 1099511628211ULL;
+    if(value->is_null)
+        return hash;
+    type = comptime_payload_type(type);
+    if(type->kind == AdoradTypeString) {
+        UInt64 len = comptime_str_len(value->str);
+        for(UInt64 i = 0; i < len; i++)
+            hash = (hash ^ cast(Byte)value->str->data[i]) * 1099511628211ULL;
+        return (hash ^ len) * 1099511628211ULL;
+    }
+    // `imm` covers `fimm` (bit for bit, so NaNs are equal to themselves) and `func` as well
+    return (hash ^ value->imm) * 1099511628211ULL;
+}
+
+static bool comptime_values_equal(Type* type, ComptimeValue* a, ComptimeValue* b) {
+    if(a->is_null || b->is_null)
+        return a->is_null == b->is_null;
+    type = comptime_payload_type(type);
+    if(type->kind == AdoradTypeString) {
+        UInt64 len = comptime_str_len(a->str);
+        return len == comptime_str_len(b->str) && memcmp(a->str->data, b->str->data, len) == 0;
+    }
+    return a->imm == b->imm;
+}
+
+// The zero value of `type` (what variables without an initializer start with)
+static ComptimeValue comptime_zero(Comptime* ct, Type* type) {
+    ComptimeValue value = {0};
+    value.is_null = type->kind == AdoradTypeOptional;
+    if(type->kind == AdoradTypeString)
+        value.str = *cast(Buff**)vec_at(ct->strings, 0);
+    return value;
+}
+
+// Memoization -----------------------------------------------------------------------------------------------------
+
+// A call can only see its arguments (and immutable globals). Unless one of them is a pointer, it has no way to change
+// anything either, so its result only depends on the values of its arguments.
+static bool comptime_is_pure(Type* type) {
+    for(UInt32 i = 0; i < type->num_params; i++)
+        if(type->params[i]->kind == AdoradTypePointer)
+            return false;
+    return type->ret->kind != AdoradTypePointer && !type->is_variadic;
+}
+
+static UInt64 comptime_hash_call(IrFunc* func, ComptimeValue* args) {
+    Type* type = func->symbol->type;
+    UInt64 hash = (14695981039346656037ULL ^ func->symbol->unit) * 1099511628211ULL;
+    for(UInt32 i = 0; i < type->num_params; i++)
+        hash = comptime_hash_value(hash, type->params[i], &args[i]);
+    return hash;
+}
+
+static ComptimeMemo* comptime_memo_find(Comptime* ct, IrFunc* func, UInt64 hash, ComptimeValue* args) {
+    Type* type = func->symbol->type;
+    for(UInt64 i = hash & ct->memo_mask;; i = (i + 1) & ct->memo_mask) {
+        ComptimeMemo* memo = &ct->memo[i];
+        if(NONE(memo->func))
+            return memo;
+        if(memo->func != func || memo->hash != hash)
+            continue;
+        bool is_equal = true;
+        for(UInt32 p = 0; p < type->num_params && is_equal; p++)
+            is_equal = comptime_values_equal(type->params[p], &memo->args[p], &args[p]);
+        if(is_equal)
+            return memo;
+    }
+}
+
+static void comptime_memo_grow(Comptime* ct) {
+    ComptimeMemo* old = ct->memo;
+    UInt64 old_cap = ct->memo_mask + 1;
+    ct->memo = cast(ComptimeMemo*)calloc(2 * old_cap, sizeof(ComptimeMemo));
+    CORETEN_ENFORCE_NN(ct->memo, "Could not allocate memory. Memory full.");
+    ct->memo_mask = 2 * old_cap - 1;
+    for(UInt64 i = 0; i < old_cap; i++) {
+        if(NONE(old[i].func))
+            continue;
+        UInt64 slot = old[i].hash & ct->memo_mask;
+        while(SOME(ct->memo[slot].func))
+            slot = (slot + 1) & ct->memo_mask;
+        ct->memo[slot] = old[i];
+    }
+    free(old);
+}
+
+static void comptime_memo_put(Comptime* ct, IrFunc* func, UInt64 hash, ComptimeValue* args, ComptimeValue* result) {
+    if(2 * (ct->memo_size + 1) > ct->memo_mask + 1)
+        comptime_memo_grow(ct);
+    ComptimeMemo* memo = comptime_memo_find(ct, func, hash, args);
+    UInt32 num_params = func->symbol->type->num_params;
+    memo->func = func;
+    memo->hash = hash;
+    memo->args = cast(ComptimeValue*)malloc((num_params + 1) * sizeof(ComptimeValue));
+    CORETEN_ENFORCE_NN(memo->args, "Could not allocate memory. Memory full.");
+    memcpy(memo->args, args, num_params * sizeof(ComptimeValue));
+    memo->result = *result;
+    ct->memo_size++;
+}
+
+// Instructions ----------------------------------------------------------------------------------------------------
+
+static bool comptime_convert(Comptime* ct, Type* from, Type* to, ComptimeValue* in, ComptimeValue* out) {
+    *out = *in;
+    if(to->kind == AdoradTypeOptional) {
+        out->is_null = from->kind == AdoradTypeNull || (from->kind == AdoradTypeOptional && in->is_null);
+        if(out->is_null)
+            out->imm = 0;
+        else if(from->kind != AdoradTypeOptional)
+            return comptime_convert(ct, from, to->elem, in, out);
+        return true;
+    }
+    if(type_is_float(to)) {
+        if(type_is_float(from))
+            out->fimm = opt_round(to, in->fimm);
+        else if(opt_int_bits(from) > 0)
+            out->fimm = opt_round(to, type_is_signed(from) ? cast(double)cast(Int64)in->imm : cast(double)in->imm);
+        return true;
+    }
+    if(opt_int_bits(to) > 0 && type_is_float(from)) {
+        double value = in->fimm;
+        bool fits = type_is_signed(to) ? value > -9223372036854775809.0 && value < 9223372036854775808.0 :
+                                         value > -1.0 && value < 18446744073709551616.0;
+        if(!fits) {
+            char to_buf[64];
+            type_to_str(to, to_buf, sizeof(to_buf));
+            return comptime_fail(ct, "`%g` doesn't fit in `%s`", value, to_buf);
+        }
+        out->imm = opt_normalize(to, type_is_signed(to) ? cast(UInt64)cast(Int64)value : cast(UInt64)value);
+        return true;
+    }
+    if(opt_int_bits(to) > 0)
+        out->imm = opt_normalize(to, in->imm);
+    return true;
+}
+
+static inline Type* comptime_operand_type(IrFunc* func, IrInst* inst) {
+    return type_get(ir_inst(func, *cast(IrValue*)vec_at(func->operands, inst->operands))->type);
+}
+
+// The value of an instruction that only depends on its operands (`ops`)
+static bool comptime_apply(Comptime* ct, IrFunc* func, IrInst* inst, ComptimeValue* ops, ComptimeValue* out) {
+    IrOp op = cast(IrOp)inst->op;
+    Type* type = inst->type != TYPE_ID_NONE ? type_get(inst->type) : null;
+    ComptimeValue result = {0};
+
+    switch(op) {
+        case IrOpConst: result.imm = opt_normalize(type, inst->imm); break;
+        case IrOpConstFloat: result.fimm = inst->fimm; break;
+        case IrOpConstString: result.str = inst->str; break;
+        case IrOpNull: result.is_null = true; break;
+        case IrOpZero: result = comptime_zero(ct, type); break;
+        case IrOpFunc: result.func = inst->symbol; break;
+
+        case IrOpNeg:
+            if(type_is_float(type))
+                result.fimm = -ops[0].fimm;
+            else
+                result.imm = opt_normalize(type, 0 - ops[0].imm);
+            break;
+        case IrOpNot: result.imm = !ops[0].imm; break;
+
+        case IrOpAdd: case IrOpSub: case IrOpMul: case IrOpDiv: case IrOpMod:
+        case IrOpAnd: case IrOpOr: case IrOpXor: case IrOpShl: case IrOpShr:
+            if(type_is_float(type)) {
+                if(!opt_fold_float(op, ops[0].fimm, ops[1].fimm, &result.fimm))
+                    return comptime_fail(ct, "`%s` of floats in `%s`", ir_op_name(op), comptime_name(func));
+                result.fimm = opt_round(type, result.fimm);
+            } else if(!opt_fold_int(op, type, ops[0].imm, ops[1].imm, &result.imm)) {
+                if(op == IrOpShl || op == IrOpShr)
+                    return comptime_fail(ct, "shift by %" CORETEN_PRIu64 " bits in `%s`", ops[1].imm,
+                                         comptime_name(func));
+                if(ops[1].imm == 0)
+                    return comptime_fail(ct, "division by zero in `%s`", comptime_name(func));
+                return comptime_fail(ct, "division overflows in `%s`", comptime_name(func));
+            }
+            break;
+        case IrOpConcat:
+            if(!comptime_concat(ct, ops[0].str, ops[1].str, &result))
+                return false;
+            break;
+
+        case IrOpEq: case IrOpNe: case IrOpLt: case IrOpLe: case IrOpGt: case IrOpGe: {
+            Type* operand_type = comptime_operand_type(func, inst);
+            if(type_is_float(operand_type))
+                result.imm = opt_compare_float(op, ops[0].fimm, ops[1].fimm);
+            else if(opt_int_bits(operand_type) > 0 || operand_type->kind == AdoradTypeRune)
+                result.imm = opt_compare_int(op, type_is_signed(operand_type), ops[0].imm, ops[1].imm);
+            else if(op == IrOpEq || op == IrOpNe)
+                // Strings are compared as spelled
+                result.imm = comptime_values_equal(operand_type, &ops[0], &ops[1]) == (op == IrOpEq);
+            else
+                return comptime_fail(ct, "`%s` can't be evaluated at compile time", ir_op_name(op));
+            break;
+        }
+        case IrOpIsNull: result.imm = ops[0].is_null; break;
+        case IrOpConvert: {
+            Type* from = comptime_operand_type(func, inst);
+            if(!comptime_convert(ct, from, type, &ops[0], &result))
+                return false;
+            break;
+        }
+
+        default:
+            return comptime_fail(ct, "`%s` can't be evaluated at compile time", ir_op_name(op));
+    }
+    *out = result;
+    return true;
+}
+
+static bool comptime_call_func(Comptime* ct, IrFunc* func, ComptimeValue* args, ComptimeValue* result);
+
+static bool comptime_global_value(Comptime* ct, Symbol* symbol, ComptimeValue* out) {
+    if(symbol->is_mutable)
+        return comptime_fail(ct, "`%s` is mutable, so its value is only known at run time", symbol->name->data);
+
+    UInt32 unit = symbol->unit;
+    if(ct->global_states[unit] == ComptimeGlobalKnown) {
+        *out = ct->globals[unit];
+        return true;
+    }
+    if(ct->global_states[unit] == ComptimeGlobalBusy)
+        return comptime_fail(ct, "the value of `%s` depends on itself", symbol->name->data);
+
+    IrFunc* init = comptime_func_of(ct, symbol);
+    bool ok = true;
+    if(vec_size(init->blocks) == 0) {
+        *out = comptime_zero(ct, symbol->type);
+    } else {
+        ct->global_states[unit] = ComptimeGlobalBusy;
+        ok = comptime_call_func(ct, init, null, out);
+    }
+    // A failure may just be the budget of the evaluation that needed it, so it's tried again the next time
+    ct->global_states[unit] = ok ? ComptimeGlobalKnown : ComptimeGlobalUnknown;
+    if(ok)
+        ct->globals[unit] = *out;
+    return ok;
+}
+
+// Run `func`, whose frame (one value per instruction) is `values`
+static bool comptime_exec(Comptime* ct, IrFunc* func, ComptimeValue* args, ComptimeValue* values,
+                          ComptimeValue* result) {
+    // Nothing changes the IR while it runs, so all of it can be read straight from the arrays
+    IrInst* insts = cast(IrInst*)vec_begin(func->insts);
+    IrValue* operands = cast(IrValue*)vec_begin(func->operands);
+    IrBlock* blocks = cast(IrBlock*)vec_begin(func->blocks);
+    UInt32 block = 0;
+    UInt32 prev = IR_NONE;
+
+    for(;;) {
+        IrBlock* b = &blocks[block];
+
+        // Phis take their values all at once, from the edge the block was entered through
+        UInt64 num_phis = vec_size(b->phis);
+        if(num_phis > 0) {
+            UInt32* preds = cast(UInt32*)vec_begin(b->preds);
+            IrValue* phis = cast(IrValue*)vec_begin(b->phis);
+            UInt32 pred = 0;
+            while(preds[pred] != prev)
+                pred++;
+            vec_clear(ct->scratch);
+            for(UInt64 i = 0; i < num_phis; i++)
+                vec_push(ct->scratch, &values[operands[insts[phis[i]].operands + pred]]);
+            ComptimeValue* moved = cast(ComptimeValue*)vec_begin(ct->scratch);
+            for(UInt64 i = 0; i < num_phis; i++)
+                values[phis[i]] = moved[i];
+        }
+
+        UInt64 num_insts = vec_size(b->insts);
+        IrValue* body = cast(IrValue*)vec_begin(b->insts);
+        for(UInt64 i = 0; i < num_insts; i++) {
+            IrValue value = body[i];
+            IrInst* inst = &insts[value];
+            IrValue* ops = &operands[inst->operands];
+            if(++ct->steps > ct->max_steps)
+                return comptime_fail(ct, "it takes more than %" CORETEN_PRIu64 " steps", ct->max_steps);
+
+            switch(inst->op) {
+                case IrOpNop: break;
+                case IrOpParam: values[value] = args[inst->imm]; break;
+
+                case IrOpSlot: {
+                    if(!comptime_alloc(ct, sizeof(ComptimeValue)))
+                        return false;
+                    ComptimeValue cell = comptime_zero(ct, type_get(inst->type)->elem);
+                    values[value].imm = vec_size(ct->cells);
+                    values[value].is_null = false;
+                    vec_push(ct->cells, &cell);
+                    break;
+                }
+                case IrOpLoad:
+                case IrOpStore: {
+                    UInt64 cell = values[ops[0]].imm;
+                    if(cell >= vec_size(ct->cells))
+                        return comptime_fail(ct, "`%s` uses a pointer to a local that no longer exists",
+                                             comptime_name(func));
+                    ComptimeValue* slot = cast(ComptimeValue*)vec_at(ct->cells, cell);
+                    if(inst->op == IrOpLoad)
+                        values[value] = *slot;
+                    else
+                        *slot = values[ops[1]];
+                    break;
+                }
+
+                case IrOpLoadGlobal:
+                    if(!comptime_global_value(ct, inst->symbol, &values[value]))
+                        return false;
+                    break;
+                case IrOpStoreGlobal:
+                case IrOpGlobalAddr:
+                    return comptime_fail(ct, "`%s` can't change the global `%s` at compile time", comptime_name(func),
+                                         inst->symbol->name->data);
+
+                case IrOpCall: {
+                    IrFunc* callee = comptime_func_of(ct, values[ops[0]].func);
+                    UInt32 num_args = inst->num_operands - 1;
+                    ComptimeValue* call_args = cast(ComptimeValue*)malloc((num_args + 1) * sizeof(ComptimeValue));
+                    CORETEN_ENFORCE_NN(call_args, "Could not allocate memory. Memory full.");
+                    for(UInt32 a = 0; a < num_args; a++)
+                        call_args[a] = values[ops[1 + a]];
+                    bool ok = comptime_call_func(ct, callee, call_args, &values[value]);
+                    free(call_args);
+                    if(!ok)
+                        return false;
+                    break;
+                }
+
+                case IrOpJump:
+                    prev = block;
+                    block = inst->targets[0];
+                    break;
+                case IrOpBranch:
+                    prev = block;
+                    block = inst->targets[values[ops[0]].imm ? 0 : 1];
+                    break;
+                case IrOpReturn:
+                    if(inst->num_operands > 0) {
+                        *result = values[ops[0]];
+                    } else {
+                        ComptimeValue none = {0};
+                        *result = none;
+                    }
+                    return true;
+                case IrOpUnreachable:
+                    return comptime_fail(ct, "`%s` reached `unreachable`", comptime_name(func));
+
+                default: {
+                    ComptimeValue in[2];
+                    for(UInt32 o = 0; o < inst->num_operands && o < 2; o++)
+                        in[o] = values[ops[o]];
+                    if(!comptime_apply(ct, func, inst, in, &values[value]))
+                        return false;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+static bool comptime_run(Comptime* ct, IrFunc* func, ComptimeValue* args, ComptimeValue* result) {
+    if(vec_size(func->blocks) == 0)
+        return comptime_fail(ct, "`%s` doesn't have a body", comptime_name(func));
+    if(ct->depth >= ct->max_depth)
+        return comptime_fail(ct, "calls are nested more than %u deep", ct->max_depth);
+
+    UInt64 num_insts = vec_size(func->insts);
+    UInt64 frame_size = num_insts * sizeof(ComptimeValue);
+    if(!comptime_alloc(ct, frame_size))
+        return false;
+    ComptimeValue* values = cast(ComptimeValue*)calloc(num_insts + 1, sizeof(ComptimeValue));
+    CORETEN_ENFORCE_NN(values, "Could not allocate memory. Memory full.");
+    UInt64 cells_base = vec_size(ct->cells);
+
+    ct->depth++;
+    bool ok = comptime_exec(ct, func, args, values, result);
+    ct->depth--;
+
+    // Stack slots go away with the call
+    ct->memory -= frame_size + (vec_size(ct->cells) - cells_base) * sizeof(ComptimeValue);
+    ct->cells->core.len = cells_base;
+    free(values);
+    return ok;
+}
+
+static bool comptime_call_func(Comptime* ct, IrFunc* func, ComptimeValue* args, ComptimeValue* result) {
+    Type* type = func->symbol->type;
+    // Global initializers are called too (they're only ever evaluated once)
+    bool is_pure = func->symbol->kind == SymbolKindFunc && comptime_is_pure(type);
+    UInt64 hash = 0;
+    if(is_pure) {
+        hash = comptime_hash_call(func, args);
+        ComptimeMemo* memo = comptime_memo_find(ct, func, hash, args);
+        if(SOME(memo->func)) {
+            ct->memo_hits++;
+            ct->steps++;
+            *result = memo->result;
+            return true;
+        }
+        ct->memo_misses++;
+    }
+
+    if(!comptime_run(ct, func, args, result))
+        return false;
+    if(is_pure)
+        comptime_memo_put(ct, func, hash, args, result);
+    return true;
+}
+
+bool comptime_call(Comptime* ct, IrFunc* func, ComptimeValue* args, ComptimeValue* result) {
+    comptime_begin(ct);
+    return comptime_call_func(ct, func, args, result);
+}
+
+// Rewriting the IR ------------------------------------------------------------------------------------------------
+
+static void comptime_error(Comptime* ct, Symbol* symbol, const char* format, ...) {
+    char buffer[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    Loc* loc = symbol->decl->loc;
+    CheckerDiagnostic diag;
+    diag.fname = SOME(loc) ? loc->fname : null;
+    diag.line = SOME(loc) ? loc->line : 0;
+    diag.col = SOME(loc) ? loc->col : 0;
+    diag.msg = cast(char*)malloc(strlen(buffer) + 1);
+    CORETEN_ENFORCE_NN(diag.msg, "Could not allocate memory. Memory full.");
+    strcpy(diag.msg, buffer);
+    vec_push(ct->diagnostics, &diag);
+}
+
+// A new instruction at index `*at` of the entry block (which dominates everything)
+static IrValue comptime_insert(IrFunc* func, UInt32* at, IrOp op, TypeId type) {
+    IrValue value = ir_new_inst(func, 0, op, type);
+    Vec* insts = ir_block(func, 0)->insts;
+    vec_push(insts, &value);
+    UInt64 size = vec_size(insts);
+    memmove(vec_at(insts, *at + 1), vec_at(insts, *at), (size - 1 - *at) * sizeof(IrValue));
+    *cast(IrValue*)vec_at(insts, *at) = value;
+    (*at)++;
+    return value;
+}
+
+// The IR of `value` (of type `type`). Returns IR_NONE if there is none (`Void`), or it can't be spelled as IR.
+static IrValue comptime_materialize(Comptime* ct, IrFunc* func, UInt32* at, Type* type, ComptimeValue* value) {
+    IrValue result = IR_NONE;
+    switch(type->kind) {
+        case AdoradTypeVoid:
+            return IR_NONE;
+        case AdoradTypeOptional: {
+            if(value->is_null)
+                return comptime_insert(func, at, IrOpNull, type->id);
+            IrValue payload = comptime_materialize(ct, func, at, type->elem, value);
+            if(payload == IR_NONE)
+                return IR_NONE;
+            result = comptime_insert(func, at, IrOpConvert, type->id);
+            ir_alloc_operands(func, result, 1);
+            ir_set_operand(func, result, 0, payload);
+            return result;
+        }
+        case AdoradTypeString:
+            result = comptime_insert(func, at, IrOpConstString, type->id);
+            ir_inst(func, result)->str = value->str;
+            return result;
+        case AdoradTypeFloat32:
+        case AdoradTypeFloat64:
+            result = comptime_insert(func, at, IrOpConstFloat, type->id);
+            ir_inst(func, result)->fimm = value->fimm;
+            return result;
+        case AdoradTypeFunc:
+            result = comptime_insert(func, at, IrOpFunc, type->id);
+            ir_inst(func, result)->symbol = value->func;
+            return result;
+        default:
+            if(opt_int_bits(type) == 0 && type->kind != AdoradTypeRune) {
+                char buf[64];
+                type_to_str(type, buf, sizeof(buf));
+                comptime_fail(ct, "a value of type `%s` can't be a constant", buf);
+                return IR_NONE;
+            }
+            result = comptime_insert(func, at, IrOpConst, type->id);
+            ir_inst(func, result)->imm = value->imm;
+            return result;
+    }
+}
+
+// Make `value` (which was evaluated) `replacement`. Calls go away; everything else is left to dead code elimination.
+static void comptime_replace(IrFunc* func, IrValue value, IrValue replacement) {
+    if(replacement != IR_NONE)
+        ir_replace_uses(func, value, replacement);
+    IrInst* inst = ir_inst(func, value);
+    if(inst->op != IrOpCall)
+        return;
+
+    Vec* insts = ir_block(func, inst->block)->insts;
+    for(UInt64 i = 0; i < vec_size(insts); i++) {
+        if(*cast(IrValue*)vec_at(insts, i) == value) {
+            memmove(vec_at(insts, i), vec_at(insts, i + 1), (vec_size(insts) - i - 1) * sizeof(IrValue));
+            vec_pop(insts);
+            break;
+        }
+    }
+    ir_kill(func, value);
+    ir_inst(func, value)->forward = replacement;
+}
+
+// Replace the initializer of a global with its value
+static bool comptime_replace_init(Comptime* ct, IrFunc* func, ComptimeValue* value) {
+    for(UInt64 i = 0; i < vec_size(func->insts); i++)
+        ir_kill(func, cast(IrValue)i);
+    for(UInt64 i = 0; i < vec_size(func->blocks); i++) {
+        IrBlock* block = ir_block(func, cast(UInt32)i);
+        vec_clear(block->phis);
+        vec_clear(block->insts);
+        vec_clear(block->preds);
+    }
+
+    UInt32 at = 0;
+    IrValue result = comptime_materialize(ct, func, &at, func->symbol->type, value);
+    if(result == IR_NONE)
+        return false;
+    IrValue ret = ir_new_inst(func, 0, IrOpReturn, TYPE_ID_NONE);
+    ir_alloc_operands(func, ret, 1);
+    ir_set_operand(func, ret, 0, result);
+    vec_push(ir_block(func, 0)->insts, &ret);
+    ir_order_blocks(func);
+    return true;
+}
+
+static inline IrValue comptime_resolve(IrFunc* func, IrValue value) {
+    while(value != IR_NONE && ir_inst(func, value)->op == IrOpNop)
+        value = ir_inst(func, value)->forward;
+    return value;
+}
+
+// What a function that isn't running knows at compile time: `value` can't depend on its parameters, or on anything
+// that depends on control flow. `cache` has a slot for each of the first `num_cached` values.
+static bool comptime_eval(Comptime* ct, IrFunc* func, IrValue value, ComptimeValue* out, ComptimeValue* cache,
+                          UInt8* is_cached, UInt64 num_cached) {
+    if(value < num_cached && is_cached[value]) {
+        *out = cache[value];
+        return true;
+    }
+    if(++ct->steps > ct->max_steps)
+        return comptime_fail(ct, "it takes more than %" CORETEN_PRIu64 " steps", ct->max_steps);
+
+    IrInst inst = *ir_inst(func, value);
+    ComptimeValue result = {0};
+    switch(inst.op) {
+        case IrOpParam: case IrOpPhi: case IrOpSlot: case IrOpLoad: case IrOpGlobalAddr:
+            return comptime_fail(ct, "it depends on a value that's only known at run time");
+
+        case IrOpLoadGlobal:
+            if(!comptime_global_value(ct, inst.symbol, &result))
+                return false;
+            break;
+
+        case IrOpCall: {
+            ComptimeValue* args = cast(ComptimeValue*)malloc(inst.num_operands * sizeof(ComptimeValue));
+            CORETEN_ENFORCE_NN(args, "Could not allocate memory. Memory full.");
+            bool ok = true;
+            for(UInt32 i = 0; i < inst.num_operands && ok; i++)
+                ok = comptime_eval(ct, func, ir_operand(func, value, i), &args[i], cache, is_cached, num_cached);
+            if(ok)
+                ok = comptime_call_func(ct, comptime_func_of(ct, args[0].func), args + 1, &result);
+            free(args);
+            if(!ok)
+                return false;
+            break;
+        }
+
+        default: {
+            ComptimeValue ops[2];
+            for(UInt32 i = 0; i < inst.num_operands && i < 2; i++)
+                if(!comptime_eval(ct, func, ir_operand(func, value, i), &ops[i], cache, is_cached, num_cached))
+                    return false;
+            if(!comptime_apply(ct, func, &inst, ops, &result))
+                return false;
+            break;
+        }
+    }
+
+    if(value < num_cached) {
+        cache[value] = result;
+        is_cached[value] = 1;
+    }
+    *out = result;
+    return true;
+}
+
+// Is `value` a call to a `[comptime]` function, or a read of a `[comptime]` global?
+static bool comptime_is_comptime_call(IrFunc* func, IrValue value) {
+    if(ir_inst(func, value)->op != IrOpCall)
+        return false;
+    IrInst* callee = ir_inst(func, ir_operand(func, value, 0));
+    return callee->op == IrOpFunc && comptime_is_comptime_func(callee->symbol);
+}
+
+// Evaluate the reads of `[comptime]` globals and the `IrFunc.comptime` values of `func`
+static UInt64 comptime_func(Comptime* ct, IrFunc* func) {
+    Vec* targets = VEC_NEW(IrComptime, 8);
+    for(UInt64 b = 0; b < vec_size(func->blocks); b++) {
+        Vec* insts = ir_block(func, cast(UInt32)b)->insts;
+        for(UInt64 i = 0; i < vec_size(insts); i++) {
+            IrComptime target = { *cast(IrValue*)vec_at(insts, i), null };
+            IrInst* inst = ir_inst(func, target.value);
+            if(inst->op == IrOpLoadGlobal && comptime_is_comptime_var(inst->symbol))
+                vec_push(targets, &target);
+        }
+    }
+    for(UInt64 i = 0; SOME(func->comptime) && i < vec_size(func->comptime); i++)
+        vec_push(targets, vec_at(func->comptime, i));
+    if(vec_size(targets) == 0) {
+        vec_free(targets);
+        return 0;
+    }
+
+    UInt64 num_cached = vec_size(func->insts);
+    ComptimeValue* cache = cast(ComptimeValue*)malloc((num_cached + 1) * sizeof(ComptimeValue));
+    UInt8* is_cached = cast(UInt8*)calloc(num_cached + 1, 1);
+    UInt8* is_done = cast(UInt8*)calloc(num_cached + 1, 1);
+    CORETEN_ENFORCE(SOME(cache) && SOME(is_cached) && SOME(is_done), "Could not allocate memory. Memory full.");
+
+    // Constants go after the parameters
+    UInt32 at = 0;
+    Vec* entry = ir_block(func, 0)->insts;
+    while(at < vec_size(entry) && ir_inst(func, *cast(IrValue*)vec_at(entry, at))->op == IrOpParam)
+        at++;
+
+    UInt64 num_errors = 0;
+    for(UInt64 i = 0; i < vec_size(targets); i++) {
+        IrComptime target = *cast(IrComptime*)vec_at(targets, i);
+        // A call to a `[comptime]` function can be a `[comptime]` expression too
+        if(target.value < num_cached && is_done[target.value])
+            continue;
+        if(target.value < num_cached)
+            is_done[target.value] = 1;
+        IrValue value = comptime_resolve(func, target.value);
+        if(value == IR_NONE)
+            continue;
+        IrInst inst = *ir_inst(func, value);
+        // A read of a `[comptime]` global that couldn't be evaluated has already been reported
+        if(inst.op == IrOpLoadGlobal && ct->global_states[inst.symbol->unit] != ComptimeGlobalKnown)
+            continue;
+
+        comptime_begin(ct);
+        ComptimeValue result;
+        IrValue replacement = IR_NONE;
+        bool ok = comptime_eval(ct, func, value, &result, cache, is_cached, num_cached);
+        if(ok && inst.type != TYPE_ID_NONE) {
+            replacement = comptime_materialize(ct, func, &at, type_get(inst.type), &result);
+            ok = replacement != IR_NONE;
+        }
+        if(!ok) {
+            if(comptime_is_comptime_call(func, value))
+                comptime_error(ct, func->symbol, "Couldn't evaluate the call to `%s` at compile time: %s",
+                               ir_inst(func, ir_operand(func, value, 0))->symbol->name->data, ct->error);
+            else
+                comptime_error(ct, func->symbol, "Couldn't evaluate a `[comptime]` expression in `%s`: %s",
+                               comptime_name(func), ct->error);
+            num_errors++;
+            continue;
+        }
+        comptime_replace(func, value, replacement);
+        if(SOME(target.node)) {
+            ComptimeNode known = { target.node, result };
+            vec_push(ct->nodes, &known);
+        }
+    }
+
+    free(cache);
+    free(is_cached);
+    free(is_done);
+    vec_free(targets);
+    return num_errors;
+}
+
+static int comptime_node_cmp(const void* a, const void* b) {
+    uintptr_t x = cast(uintptr_t)(cast(const ComptimeNode*)a)->node;
+    uintptr_t y = cast(uintptr_t)(cast(const ComptimeNode*)b)->node;
+    return x < y ? -1 : x > y;
+}
+
+UInt64 comptime_module(Comptime* ct) {
+    UInt64 num_errors = 0;
+    UInt64 num_funcs = vec_size(ct->module->funcs);
+
+    // `[comptime]` globals first, so every read of one can be replaced by its value
+    for(UInt64 i = 0; i < num_funcs; i++) {
+        IrFunc* func = *cast(IrFunc**)vec_at(ct->module->funcs, i);
+        Symbol* symbol = func->symbol;
+        if(!comptime_is_comptime_var(symbol))
+            continue;
+        if(symbol->is_mutable) {
+            comptime_error(ct, symbol, "`[comptime]` variable `%s` can't be `mutable`", symbol->name->data);
+            num_errors++;
+            continue;
+        }
+        comptime_begin(ct);
+        ComptimeValue value;
+        bool ok = comptime_global_value(ct, symbol, &value);
+        if(ok && vec_size(func->blocks) > 0)
+            ok = comptime_replace_init(ct, func, &value);
+        if(!ok) {
+            ct->global_states[symbol->unit] = ComptimeGlobalUnknown;
+            comptime_error(ct, symbol, "Couldn't evaluate `%s` at compile time: %s", symbol->name->data, ct->error);
+            num_errors++;
+        }
+    }
+
+    // The bodies of `[comptime]` functions only ever run at compile time, so there's nothing to do in them
+    for(UInt64 i = 0; i < num_funcs; i++) {
+        IrFunc* func = *cast(IrFunc**)vec_at(ct->module->funcs, i);
+        if(vec_size(func->blocks) > 0 && !comptime_is_comptime_func(func->symbol) &&
+           !comptime_is_comptime_var(func->symbol))
+            num_errors += comptime_func(ct, func);
+    }
+    comptime_begin(ct);
+    if(vec_size(ct->nodes) > 0)
+        qsort(vec_begin(ct->nodes), vec_size(ct->nodes), sizeof(ComptimeNode), comptime_node_cmp);
+    return num_errors;
+}
+
+ComptimeValue* comptime_value_of(Comptime* ct, AstNode* node) {
+    UInt64 lo = 0;
+    UInt64 hi = vec_size(ct->nodes);
+    while(lo < hi) {
+        UInt64 mid = lo + (hi - lo) / 2;
+        ComptimeNode* known = cast(ComptimeNode*)vec_at(ct->nodes, mid);
+        if(known->node == node)
+            return &known->value;
+        if(cast(uintptr_t)known->node < cast(uintptr_t)node)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return null;
+}
+
+ComptimeValue* comptime_global(Comptime* ct, UInt32 unit) {
+    IrFunc* func = *cast(IrFunc**)vec_at(ct->module->funcs, unit);
+    if(!comptime_is_comptime_var(func->symbol) || ct->global_states[unit] != ComptimeGlobalKnown)
+        return null;
+    return &ct->globals[unit];
+}
+
+Comptime* comptime_new(IrModule* module) {
+    Comptime* ct = cast(Comptime*)calloc(1, sizeof(Comptime));
+    CORETEN_ENFORCE_NN(ct, "Could not allocate memory. Memory full.");
+    ct->module = module;
+    ct->max_steps = COMPTIME_MAX_STEPS;
+    ct->max_memory = COMPTIME_MAX_MEMORY;
+    ct->max_depth = COMPTIME_MAX_DEPTH;
+
+    UInt64 num_funcs = vec_size(module->funcs);
+    ct->globals = cast(ComptimeValue*)calloc(num_funcs + 1, sizeof(ComptimeValue));
+    ct->global_states = cast(UInt8*)calloc(num_funcs + 1, 1);
+    ct->memo = cast(ComptimeMemo*)calloc(COMPTIME_MEMO_INIT_CAP, sizeof(ComptimeMemo));
+    CORETEN_ENFORCE(SOME(ct->globals) && SOME(ct->global_states) && SOME(ct->memo),
+                    "Could not allocate memory. Memory full.");
+    ct->memo_mask = COMPTIME_MEMO_INIT_CAP - 1;
+    ct->cells = VEC_NEW(ComptimeValue, 64);
+    ct->scratch = VEC_NEW(ComptimeValue, 16);
+    ct->strings = VEC_NEW(Buff*, 16);
+    ct->nodes = VEC_NEW(ComptimeNode, 16);
+    ct->diagnostics = VEC_NEW(CheckerDiagnostic, 4);
+    // The empty string (the zero value of `String`) is always the first one
+    memcpy(comptime_new_str(ct, 2)->data, "\"\"", 2);
+    return ct;
+}
+
+void comptime_free(Comptime* ct) {
+    if(NONE(ct))
+        return;
+    for(UInt64 i = 0; i <= ct->memo_mask; i++)
+        free(ct->memo[i].args);
+    for(UInt64 i = 0; i < vec_size(ct->strings); i++) {
+        Buff* str = *cast(Buff**)vec_at(ct->strings, i);
+        free(str->data);
+        buff_free(str);
+    }
+    for(UInt64 i = 0; i < vec_size(ct->diagnostics); i++)
+        free((cast(CheckerDiagnostic*)vec_at(ct->diagnostics, i))->msg);
+    free(ct->globals);
+    free(ct->global_states);
+    free(ct->memo);
+    free(ct->error);
+    vec_free(ct->cells);
+    vec_free(ct->scratch);
+    vec_free(ct->strings);
+    vec_free(ct->nodes);
+    vec_free(ct->diagnostics);
+    free(ct);
+}
+
+void comptime_print_diagnostics(Comptime* ct, FILE* stream) {
+    for(UInt64 i = 0; i < vec_size(ct->diagnostics); i++) {
+        CheckerDiagnostic* diag = cast(CheckerDiagnostic*)vec_at(ct->diagnostics, i);
+        fprintf(stream, "%s:%u:%u: error: %s\n", SOME(diag->fname) ? diag->fname->data : "<unknown>", diag->line,
+                diag->col, diag->msg);
+    }
+}
@@ -0,0 +1,116 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#ifndef ADORAD_COMPTIME_H
+#define ADORAD_COMPTIME_H
+
+#include <stdio.h>
+#include <adorad/core/types.h>
+#include <adorad/core/vector.h>
+#include <adorad/compiler/ir.h>
+
+/*
+    Compile-time evaluation.
+
+    What has to be known at compile time:
+        - `[comptime] put x = ...`: the initializer of the global (or local) variable,
+        - `[comptime] <expr>`: the expression,
+        - calls to `[comptime] func`s (from functions that aren't `[comptime]` themselves).
+    `comptime_module()` evaluates all of these and replaces them with constants in the IR, so it has to run after
+    `ir_lower()` and before `opt_module()`. The C backend (which works on the AST) emits the value of a `[comptime]`
+    global as a static initializer, so it doesn't have to be computed by `adorad_init()` at startup, and every other
+    expression that was evaluated as a constant (see `CGen.comptime`).
+
+    The evaluator interprets the IR directly: every function already is a flat array of instructions whose operands are
+    indices into a flat array of values, so a call is a dispatch loop over `IrFunc.insts` with one `ComptimeValue` per
+    instruction. Anything that depends on a mutable global, a function without a body, or a run-time value can't be
+    evaluated at compile time, and is reported.
+
+    Every call whose arguments and result aren't pointers is pure (it can't see or change anything but its arguments),
+    so its result is memoized, keyed by the callee and a hash of the argument values: the same call is only ever
+    evaluated once per module, no matter how often (or how recursively) it's made.
+
+    Every evaluation (of one variable, expression or call) has a budget - a number of instructions it may execute, an
+    amount of memory it may use (frames, stack slots and strings), and a call depth - so a runaway loop or recursion
+    is reported instead of hanging the compiler. Evaluation is serial (results are shared through the memo table).
+*/
+
+#define COMPTIME_MAX_STEPS      (UInt64)(1 << 24)
+#define COMPTIME_MAX_MEMORY     (UInt64)(64 << 20)
+#define COMPTIME_MAX_DEPTH      512
+
+// A value known at compile time. What it holds depends on its type: integers, `Bool`s and `Rune`s are `imm`
+// (normalized like `IrOpConst`), floats are `fimm`, strings are `str` (as spelled, escape sequences and all),
+// functions are `func`, and pointers are `imm` (the index of a stack slot). `?T` is a `T` with `is_null` set.
+typedef struct ComptimeValue {
+    union {
+        UInt64 imm;
+        double fimm;
+        Buff* str;
+        Symbol* func;
+    };
+    bool is_null;
+} ComptimeValue;
+
+// An expression whose value was computed at compile time
+typedef struct ComptimeNode {
+    AstNode* node;
+    ComptimeValue value;
+} ComptimeNode;
+
+typedef struct ComptimeMemo ComptimeMemo;
+
+typedef struct Comptime {
+    IrModule* module;
+    UInt64 max_steps;       // budgets of a single evaluation (COMPTIME_MAX_* by default)
+    UInt64 max_memory;
+    UInt32 max_depth;
+
+    ComptimeValue* globals; // the value of every global that was evaluated, by unit
+    UInt8* global_states;   // by unit: not evaluated (yet), being evaluated, or known
+    ComptimeMemo* memo;     // results of pure calls (open addressing)
+    UInt64 memo_mask;       // capacity - 1
+    UInt64 memo_size;
+    Vec* cells;             // `ComptimeValue`s: stack slots of the calls being evaluated
+    Vec* scratch;           // `ComptimeValue`s: the phis of the block being entered
+    Vec* strings;           // `Buff*`s created by the evaluator
+    Vec* nodes;             // `ComptimeNode`s, sorted by `node` (once `comptime_module()` is done)
+    Vec* diagnostics;       // `CheckerDiagnostic`s of `comptime_module()`
+
+    // The evaluation in progress
+    UInt64 steps;
+    UInt64 memory;
+    UInt32 depth;
+    char* error;
+
+    // Statistics (over all evaluations)
+    UInt64 total_steps;
+    UInt64 memo_hits;
+    UInt64 memo_misses;
+} Comptime;
+
+Comptime* comptime_new(IrModule* module);
+void comptime_free(Comptime* ct);
+// Evaluate everything that has to be known at compile time (see above), and replace it with constants.
+// Returns the number of errors.
+UInt64 comptime_module(Comptime* ct);
+// Call `func` with `args` at compile time. Returns false if it can't be evaluated (`ct->error` says why).
+bool comptime_call(Comptime* ct, IrFunc* func, ComptimeValue* args, ComptimeValue* result);
+// The value of expression `node` (a call to a `[comptime]` function, a `[comptime]` expression, or the initializer of a
+// `[comptime]` local), or null if it wasn't evaluated. Safe to call from any thread once `comptime_module()` is done.
+ComptimeValue* comptime_value_of(Comptime* ct, AstNode* node);
+// The value of the `[comptime]` global variable of unit `unit`, or null if it isn't one (or it couldn't be evaluated)
+ComptimeValue* comptime_global(Comptime* ct, UInt32 unit);
+void comptime_print_diagnostics(Comptime* ct, FILE* stream);
+
+#endif // ADORAD_COMPTIME_H
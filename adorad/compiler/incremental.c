@@ -0,0 +1,380 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <adorad/compiler/incremental.h>
+#include <adorad/core/debug.h>
+#include <adorad/core/hash.h>
+#include <adorad/core/misc.h>
+
+// File format (native byte order):
+//      magic, version, number of modules
+//      per module: path, number of declarations
+//      per declaration: name, content hash, interface hash, had errors (1 byte), number of deps, deps
+// Strings are a UInt32 length followed by the bytes (no null terminator).
+#define INCDB_MAGIC     "ADINCDB\n"
+#define INCDB_VERSION   1
+
+static char* incdb_strndup(const char* str, UInt64 len) {
+    char* copy = cast(char*)malloc(len + 1);
+    CORETEN_ENFORCE_NN(copy, "Could not allocate memory. Memory full.");
+    memcpy(copy, str, len);
+    copy[len] = nullchar;
+    return copy;
+}
+
+static void incdecl_free(IncDecl* decl) {
+    free(decl->name);
+    for(UInt64 i = 0; i < vec_size(decl->deps); i++)
+        free(*cast(char**)vec_at(decl->deps, i));
+    vec_free(decl->deps);
+}
+
+static void incmodule_free_decls(Vec* decls) {
+    for(UInt64 i = 0; i < vec_size(decls); i++)
+        incdecl_free(cast(IncDecl*)vec_at(decls, i));
+    vec_free(decls);
+}
+
+static int incdecl_cmp(const void* a, const void* b) {
+    return strcmp((cast(const IncDecl*)a)->name, (cast(const IncDecl*)b)->name);
+}
+
+static IncDecl* incmodule_find(IncModule* module, const char* name, UInt64 len) {
+    if(NONE(module) || vec_size(module->decls) == 0)
+        return null;
+
+    char* key = incdb_strndup(name, len);
+    IncDecl probe = { .name = key };
+    IncDecl* decl = cast(IncDecl*)bsearch(&probe, vec_at(module->decls, 0), vec_size(module->decls), sizeof(IncDecl),
+                                          incdecl_cmp);
+    free(key);
+    return decl;
+}
+
+// Returns the record of the module at `path` (creating an empty one if needed). `db->lock` must be held.
+static IncModule* incdb_module(IncDb* db, const char* path, UInt64 len) {
+    for(UInt64 i = 0; i < vec_size(db->modules); i++) {
+        IncModule* module = *cast(IncModule**)vec_at(db->modules, i);
+        if(strlen(module->path) == len && memcmp(module->path, path, len) == 0)
+            return module;
+    }
+
+    IncModule* module = cast(IncModule*)calloc(1, sizeof(IncModule));
+    CORETEN_ENFORCE_NN(module, "Could not allocate memory. Memory full.");
+    module->path = incdb_strndup(path, len);
+    module->decls = VEC_NEW(IncDecl, 16);
+    vec_push(db->modules, &module);
+    return module;
+}
+
+UInt64 incdb_content_hash(Parser* parser, AstNode* decl) {
+    UInt64 index = cast(UInt64)(decl - cast(AstNode*)vec_at(parser->nodelist, 0));
+    ParserSpan* span = cast(ParserSpan*)vec_at(parser->spans, index);
+
+    UInt64 hash = 0;
+    for(UInt32 i = span->begin; i < span->end; i++) {
+        Token* tok = cast(Token*)vec_at(parser->toklist, i);
+        hash = hash_murmur64_seed(&tok->kind, sizeof(tok->kind), hash);
+        if(SOME(tok->value) && tok->value->len > 0)
+            hash = hash_murmur64_seed(tok->value->data, cast(Ll)tok->value->len, hash);
+    }
+    return hash;
+}
+
+UInt64 incdb_interface_hash(Symbol* symbol) {
+    char buffer[256];
+    type_to_str(symbol->type, buffer, sizeof(buffer));
+    UInt64 hash = hash_murmur64(buffer, cast(Ll)strlen(buffer));
+    UInt8 flags[2] = { cast(UInt8)symbol->kind, cast(UInt8)symbol->is_mutable };
+    return hash_murmur64_seed(flags, sizeof(flags), hash);
+}
+
+typedef struct {
+    IncDb* db;
+    IncModule* prev;    // the module as of the last build
+    Parser* parser;
+} IncCheckCtx;
+
+// Does `unit` have to be checked again?
+static bool incdb_filter(void* arg, Checker* checker, CheckerUnit* unit) {
+    IncCheckCtx* ctx = cast(IncCheckCtx*)arg;
+    Buff* name = unit->symbol->name;
+    if(NONE(name))
+        return true;
+
+    IncDecl* prev = incmodule_find(ctx->prev, name->data, name->len);
+    if(NONE(prev) || prev->had_errors || prev->content_hash != incdb_content_hash(ctx->parser, unit->decl))
+        return true;
+
+    for(UInt64 i = 0; i < vec_size(prev->deps); i++) {
+        char* dep_name = *cast(char**)vec_at(prev->deps, i);
+        UInt64 len = strlen(dep_name);
+        IncDecl* prev_dep = incmodule_find(ctx->prev, dep_name, len);
+        Symbol* dep = checker_lookup(checker, dep_name, len);
+        if(NONE(prev_dep) != NONE(dep))
+            return true;
+        if(SOME(dep) && prev_dep->interface_hash != incdb_interface_hash(dep))
+            return true;
+    }
+    return false;
+}
+
+// The record of `unit`, after it has been checked (or skipped)
+static IncDecl incdb_record(IncCheckCtx* ctx, CheckerUnit* unit) {
+    Buff* name = unit->symbol->name;
+    IncDecl decl = {0};
+    decl.name = incdb_strndup(name->data, name->len);
+    decl.content_hash = incdb_content_hash(ctx->parser, unit->decl);
+    decl.interface_hash = incdb_interface_hash(unit->symbol);
+    decl.had_errors = unit->num_errors > 0;
+    decl.deps = VEC_NEW(char*, 4);
+
+    if(unit->is_skipped) {
+        // Nothing it depends on changed, so neither did its dependencies
+        IncDecl* prev = incmodule_find(ctx->prev, name->data, name->len);
+        for(UInt64 i = 0; i < vec_size(prev->deps); i++) {
+            char* dep = *cast(char**)vec_at(prev->deps, i);
+            char* copy = incdb_strndup(dep, strlen(dep));
+            vec_push(decl.deps, &copy);
+        }
+    } else if(SOME(unit->deps)) {
+        for(UInt64 i = 0; i < vec_size(unit->deps); i++) {
+            Buff* dep = *cast(Buff**)vec_at(unit->deps, i);
+            char* copy = incdb_strndup(dep->data, dep->len);
+            vec_push(decl.deps, &copy);
+        }
+    }
+    return decl;
+}
+
+UInt64 incdb_check(IncDb* db, Checker* checker, Parser* parser) {
+    Buff* path = parser->fullpath;
+    mutex_lock(&db->lock);
+    IncModule* module = incdb_module(db, path->data, path->len);
+    mutex_unlock(&db->lock);
+
+    // Only this call touches `module` (every module is checked once per build)
+    IncCheckCtx ctx = { .db = db, .prev = module, .parser = parser };
+    checker->filter = incdb_filter;
+    checker->filter_ctx = &ctx;
+    UInt64 num_errors = checker_check(checker, &parser, 1);
+    checker->filter = null;
+    checker->filter_ctx = null;
+
+    Vec* decls = VEC_NEW(IncDecl, vec_size(checker->units) + 1);
+    UInt64 num_skipped = 0;
+    for(UInt64 i = 0; i < vec_size(checker->units); i++) {
+        CheckerUnit* unit = cast(CheckerUnit*)vec_at(checker->units, i);
+        num_skipped += unit->is_skipped;
+        if(SOME(unit->symbol->name)) {
+            IncDecl decl = incdb_record(&ctx, unit);
+            vec_push(decls, &decl);
+        }
+    }
+    if(vec_size(decls) > 0)
+        qsort(vec_at(decls, 0), vec_size(decls), sizeof(IncDecl), incdecl_cmp);
+
+    incmodule_free_decls(module->decls);
+    module->decls = decls;
+    atomic64_fetch_add(&db->num_skipped, num_skipped);
+    atomic64_fetch_add(&db->num_checked, vec_size(checker->units) - num_skipped);
+    return num_errors;
+}
+
+typedef struct {
+    IncDb* db;
+    volatile UInt64 num_errors;
+} IncGraphCtx;
+
+static void incdb_check_module_task(void* arg, Module* module, UInt32 worker) {
+    IncGraphCtx* ctx = cast(IncGraphCtx*)arg;
+    module->checker = checker_new(1);
+    atomic64_fetch_add(&ctx->num_errors, incdb_check(ctx->db, module->checker, module->parser));
+}
+
+UInt64 incdb_check_graph(IncDb* db, ModuleGraph* graph) {
+    IncGraphCtx ctx = { .db = db, .num_errors = 0 };
+    modgraph_run(graph, incdb_check_module_task, &ctx);
+    return ctx.num_errors;
+}
+
+IncDb* incdb_open(const char* path) {
+    IncDb* db = cast(IncDb*)calloc(1, sizeof(IncDb));
+    CORETEN_ENFORCE_NN(db, "Could not allocate memory. Memory full.");
+    db->path = incdb_strndup(path, strlen(path));
+    db->modules = VEC_NEW(IncModule*, 16);
+    mutex_init(&db->lock);
+
+    FILE* file = fopen(path, "rb");
+    if(NONE(file))
+        return db;
+
+    // Anything unexpected means the database is thrown away (and everything is checked again)
+    bool ok = true;
+    #define READ(ptr, size)     (ok = ok && fread((ptr), 1, (size), file) == (size))
+
+    char magic[8];
+    UInt32 version = 0;
+    UInt32 num_modules = 0;
+    READ(magic, sizeof(magic));
+    READ(&version, sizeof(version));
+    ok = ok && memcmp(magic, INCDB_MAGIC, sizeof(magic)) == 0 && version == INCDB_VERSION;
+    READ(&num_modules, sizeof(num_modules));
+
+    char* str = null;
+    UInt32 str_len = 0;
+    #define READ_STR()  do {                                                     \
+        str = null;                                                              \
+        READ(&str_len, sizeof(str_len));                                         \
+        if(ok && str_len < (1U << 20)) {                                         \
+            str = cast(char*)malloc(str_len + 1);                                \
+            CORETEN_ENFORCE_NN(str, "Could not allocate memory. Memory full.");  \
+            READ(str, str_len);                                                  \
+            str[str_len] = nullchar;                                             \
+        }                                                                        \
+        ok = ok && SOME(str);                                                    \
+    } while(0)
+
+    for(UInt32 m = 0; ok && m < num_modules; m++) {
+        UInt32 num_decls = 0;
+        READ_STR();
+        READ(&num_decls, sizeof(num_decls));
+        if(!ok) {
+            free(str);
+            break;
+        }
+
+        IncModule* module = cast(IncModule*)calloc(1, sizeof(IncModule));
+        CORETEN_ENFORCE_NN(module, "Could not allocate memory. Memory full.");
+        module->path = str;
+        module->decls = VEC_NEW(IncDecl, cast(UInt64)num_decls + 1);
+        vec_push(db->modules, &module);
+
+        for(UInt32 d = 0; ok && d < num_decls; d++) {
+            IncDecl decl = {0};
+            UInt8 had_errors = 0;
+            UInt32 num_deps = 0;
+            READ_STR();
+            decl.name = str;
+            READ(&decl.content_hash, sizeof(decl.content_hash));
+            READ(&decl.interface_hash, sizeof(decl.interface_hash));
+            READ(&had_errors, sizeof(had_errors));
+            READ(&num_deps, sizeof(num_deps));
+            decl.had_errors = had_errors != 0;
+            decl.deps = VEC_NEW(char*, cast(UInt64)num_deps + 1);
+            for(UInt32 i = 0; ok && i < num_deps; i++) {
+                READ_STR();
+                if(ok)
+                    vec_push(decl.deps, &str);
+                else
+                    free(str);
+            }
+            vec_push(module->decls, &decl);
+        }
+    }
+    #undef READ_STR
+    #undef READ
+    fclose(file);
+
+    if(!ok) {
+        for(UInt64 i = 0; i < vec_size(db->modules); i++) {
+            IncModule* module = *cast(IncModule**)vec_at(db->modules, i);
+            incmodule_free_decls(module->decls);
+            free(module->path);
+            free(module);
+        }
+        vec_free(db->modules);
+        db->modules = VEC_NEW(IncModule*, 16);
+    }
+    return db;
+}
+
+bool incdb_save(IncDb* db) {
+    // Write to a temporary file first, so an interrupted build never leaves a broken database behind
+    UInt64 path_len = strlen(db->path);
+    char* tmp_path = cast(char*)malloc(path_len + 5);
+    CORETEN_ENFORCE_NN(tmp_path, "Could not allocate memory. Memory full.");
+    memcpy(tmp_path, db->path, path_len);
+    memcpy(tmp_path + path_len, ".tmp", 5);
+
+    FILE* file = fopen(tmp_path, "wb");
+    if(NONE(file)) {
+        free(tmp_path);
+        return false;
+    }
+
+    bool ok = true;
+    #define WRITE(ptr, size)    (ok = ok && fwrite((ptr), 1, (size), file) == (size))
+    #define WRITE_STR(s)        do {                            \
+        UInt32 len_ = cast(UInt32)strlen(s);                    \
+        WRITE(&len_, sizeof(len_));                             \
+        WRITE((s), len_);                                       \
+    } while(0)
+
+    UInt32 version = INCDB_VERSION;
+    UInt32 num_modules = cast(UInt32)vec_size(db->modules);
+    WRITE(INCDB_MAGIC, 8);
+    WRITE(&version, sizeof(version));
+    WRITE(&num_modules, sizeof(num_modules));
+    for(UInt64 m = 0; m < vec_size(db->modules); m++) {
+        IncModule* module = *cast(IncModule**)vec_at(db->modules, m);
+        UInt32 num_decls = cast(UInt32)vec_size(module->decls);
+        WRITE_STR(module->path);
+        WRITE(&num_decls, sizeof(num_decls));
+        for(UInt64 d = 0; d < vec_size(module->decls); d++) {
+            IncDecl* decl = cast(IncDecl*)vec_at(module->decls, d);
+            UInt8 had_errors = decl->had_errors;
+            UInt32 num_deps = cast(UInt32)vec_size(decl->deps);
+            WRITE_STR(decl->name);
+            WRITE(&decl->content_hash, sizeof(decl->content_hash));
+            WRITE(&decl->interface_hash, sizeof(decl->interface_hash));
+            WRITE(&had_errors, sizeof(had_errors));
+            WRITE(&num_deps, sizeof(num_deps));
+            for(UInt64 i = 0; i < vec_size(decl->deps); i++)
+                WRITE_STR(*cast(char**)vec_at(decl->deps, i));
+        }
+    }
+    #undef WRITE_STR
+    #undef WRITE
+
+    ok = (fclose(file) == 0) && ok;
+#if defined(CORETEN_OS_WINDOWS)
+    // `rename()` doesn't replace existing files on Windows
+    if(ok)
+        remove(db->path);
+#endif // CORETEN_OS_WINDOWS
+    ok = ok && rename(tmp_path, db->path) == 0;
+    if(!ok)
+        remove(tmp_path);
+    free(tmp_path);
+    return ok;
+}
+
+void incdb_free(IncDb* db) {
+    if(NONE(db))
+        return;
+
+    for(UInt64 i = 0; i < vec_size(db->modules); i++) {
+        IncModule* module = *cast(IncModule**)vec_at(db->modules, i);
+        incmodule_free_decls(module->decls);
+        free(module->path);
+        free(module);
+    }
+    vec_free(db->modules);
+    mutex_destroy(&db->lock);
+    free(db->path);
+    free(db);
+}
@@ -0,0 +1,79 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#ifndef ADORAD_INCREMENTAL_H
+#define ADORAD_INCREMENTAL_H
+
+#include <adorad/core/types.h>
+#include <adorad/core/vector.h>
+#include <adorad/core/thread.h>
+#include <adorad/compiler/parser.h>
+#include <adorad/compiler/checker.h>
+#include <adorad/compiler/module.h>
+
+/*
+    The Incremental Compilation Database.
+
+    For every top-level function and variable of every module, the database remembers (across builds, on disk):
+        1. a hash of its contents (its tokens - so whitespace and comments don't count),
+        2. a hash of its interface (its kind, type and mutability - what the code using it depends on), and
+        3. the names of the top-level declarations it refers to.
+    On a rebuild, every module is parsed and its signatures are resolved as usual (which is cheap), but the bodies
+    of declarations are only checked again if
+        - their contents changed,
+        - the interface of something they refer to changed (or it appeared/disappeared), or
+        - they had errors the last time.
+    Skipped declarations are marked with `CheckerUnit.is_skipped`, so the backends can reuse what they generated
+    the last time.
+*/
+
+typedef struct IncDecl {
+    char* name;
+    UInt64 content_hash;
+    UInt64 interface_hash;
+    bool had_errors;
+    Vec* deps;          // names (`char*`) of the top-level declarations it refers to
+} IncDecl;
+
+typedef struct IncModule {
+    char* path;
+    Vec* decls;         // `IncDecl`s, sorted by name
+} IncModule;
+
+typedef struct IncDb {
+    char* path;         // where the database is saved
+    Vec* modules;       // `IncModule*`s
+    Mutex lock;         // guards `modules` (modules are checked in parallel)
+
+    // Statistics of the current build
+    volatile UInt64 num_checked;
+    volatile UInt64 num_skipped;
+} IncDb;
+
+// Open the database at `path`. If it doesn't exist (or can't be read), the database starts out empty - which just
+// means everything is checked.
+IncDb* incdb_open(const char* path);
+void incdb_free(IncDb* db);
+// Write the database to disk. Returns false on failure.
+bool incdb_save(IncDb* db);
+// Check the module parsed by `parser` with `checker`, skipping every declaration that hasn't changed since the last
+// build, and update the database. Returns the number of errors.
+UInt64 incdb_check(IncDb* db, Checker* checker, Parser* parser);
+// `incdb_check()` every module of `graph` (wave by wave, like `modgraph_check()`). Returns the number of errors.
+UInt64 incdb_check_graph(IncDb* db, ModuleGraph* graph);
+
+// Hashes used by the database
+UInt64 incdb_content_hash(Parser* parser, AstNode* decl);
+UInt64 incdb_interface_hash(Symbol* symbol);
+
+#endif // ADORAD_INCREMENTAL_H
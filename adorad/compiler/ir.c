@@ -0,0 +1,2093 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <adorad/compiler/ir.h>
+#include <adorad/runtime/tensor.h>
+#include <adorad/core/debug.h>
+
+// The value of an SSA variable at the end of a block. Open addressing with linear probing, keyed by
+// `(variable << 32) | block`.
+typedef struct {
+    UInt64 key;
+    IrValue value;
+} IrDef;
+
+typedef struct {
+    IrDef* slots;
+    UInt64 mask;        // capacity - 1 (the capacity is a power of 2)
+    UInt64 count;
+} IrDefMap;
+
+#define IR_DEF_EMPTY    UINT64_MAX
+
+typedef struct {
+    UInt32 var;
+    IrValue phi;
+} IrIncompletePhi;
+
+// Construction state of a block
+typedef struct {
+    bool is_sealed;             // all of its predecessors are known
+    Vec* incomplete_phis;       // `IrIncompletePhi`s waiting for the block to be sealed. null if there are none
+} IrBlockState;
+
+// A local variable (or parameter) in scope
+typedef struct {
+    Buff* name;
+    UInt32 var;         // the SSA variable (IR_NONE if the local lives in `slot`)
+    IrValue slot;       // IR_NONE unless the local's address is taken
+    TypeId type;
+} IrLocal;
+
+// An enclosing loop
+typedef struct {
+    Buff* label;        // null if unlabeled
+    UInt32 break_block;
+    UInt32 continue_block;
+} IrLoop;
+
+// Everything needed to lower a single unit. Like in the checker, every unit gets its own builder.
+typedef struct {
+    Checker* checker;
+    IrFunc* func;
+    UInt32 block;           // the block being lowered into (IR_NONE if the code being lowered can never run)
+    Vec* states;            // `IrBlockState`s, one for every block
+    Vec* var_types;         // `TypeId`s, one for every SSA variable
+    IrDefMap defs;
+    Vec* locals;            // `IrLocal`s in scope (innermost last)
+    UInt64 scope_begin;     // index in `locals` at which the innermost scope begins
+    Vec* loops;             // `IrLoop`s (innermost last)
+    Vec* addr_taken;        // names (`Buff*`) of the locals `&` is applied to anywhere in the function
+    TypeId ret_type;
+} IrBuilder;
+
+static IrValue ir_lower_expr(IrBuilder* b, AstNode* node);
+static void ir_lower_stmt(IrBuilder* b, AstNode* node);
+static void ir_lower_cond(IrBuilder* b, AstNode* node, UInt32 if_true, UInt32 if_false);
+static IrValue ir_read_var(IrBuilder* b, UInt32 var, UInt32 block);
+
+static const char* ir_op_names[IrOpCount] = {
+    "nop", "param", "const", "const", "const", "null", "zero", "func", "load_global", "store_global", "global_addr",
+    "slot", "load", "store", "tensor_new", "tensor_len", "tensor_get",
+    "tensor_push", "tensor_dim", "tensor_set", "tensor_slice", "tensor_clone", "tensor_sort", "tensor_sort_by_key",
+    "bounds_check", "add", "sub", "mul", "div", "mod", "and", "or", "xor", "shl", "shr", "neg", "not",
+    "concat", "format", "eq", "ne", "lt", "le", "gt", "ge", "is_null", "convert", "call", "phi", "jump", "branch", "return",
+    "unreachable",
+};
+
+const char* ir_op_name(IrOp op) {
+    return op < IrOpCount ? ir_op_names[op] : "<invalid>";
+}
+
+static inline int ir_hex_digit(char ch) {
+    if(ch >= '0' && ch <= '9')
+        return ch - '0';
+    if(ch >= 'a' && ch <= 'f')
+        return ch - 'a' + 10;
+    if(ch >= 'A' && ch <= 'F')
+        return ch - 'A' + 10;
+    return -1;
+}
+
+UInt64 ir_unescape(Buff* spelled, char* out) {
+    const char* data = spelled->data;
+    UInt64 len = spelled->len;
+    // The lexer spells the empty string `""`
+    if(len == 2 && data[0] == '"' && data[1] == '"')
+        len = 0;
+
+    UInt64 n = 0;
+    for(UInt64 i = 0; i < len; i++) {
+        char ch = data[i];
+        if(ch != '\\' || i + 1 == len) {
+            out[n++] = ch;
+            continue;
+        }
+        ch = data[++i];
+        switch(ch) {
+            case 'n': out[n++] = '\n'; break;
+            case 'r': out[n++] = '\r'; break;
+            case 't': out[n++] = '\t'; break;
+            case 'a': out[n++] = '\a'; break;
+            case 'b': out[n++] = '\b'; break;
+            case 'f': out[n++] = '\f'; break;
+            case 'v': out[n++] = '\v'; break;
+            case 'e': out[n++] = '\033'; break;
+            case 'x': {
+                int value = 0;
+                int digits = 0;
+                while(digits < 2 && i + 1 < len && ir_hex_digit(data[i + 1]) >= 0) {
+                    value = value * 16 + ir_hex_digit(data[++i]);
+                    digits++;
+                }
+                out[n++] = digits > 0 ? cast(char)value : 'x';
+                break;
+            }
+            default:
+                out[n++] = ch >= '0' && ch <= '7' ? cast(char)(ch - '0') : ch;
+                break;
+        }
+    }
+    out[n] = nullchar;
+    return n;
+}
+
+bool ir_is_terminator(IrOp op) {
+    return op >= IrOpJump && op <= IrOpUnreachable;
+}
+
+IrInst* ir_inst(IrFunc* func, IrValue value) {
+    return cast(IrInst*)vec_at(func->insts, value);
+}
+
+IrValue ir_operand(IrFunc* func, IrValue value, UInt32 index) {
+    return *cast(IrValue*)vec_at(func->operands, ir_inst(func, value)->operands + index);
+}
+
+IrBlock* ir_block(IrFunc* func, UInt32 index) {
+    return cast(IrBlock*)vec_at(func->blocks, index);
+}
+
+// Remove element `index` of `vec`, keeping the order of the rest
+static void ir_vec_remove(Vec* vec, UInt64 index) {
+    UInt64 size = vec_size(vec);
+    if(index + 1 < size)
+        memmove(vec_at(vec, index), vec_at(vec, index + 1), (size - index - 1) * vec->core.objsize);
+    vec_pop(vec);
+}
+
+void ir_kill(IrFunc* func, IrValue value) {
+    IrInst* inst = ir_inst(func, value);
+    for(UInt32 i = 0; i < inst->num_operands; i++)
+        ir_set_operand(func, value, i, IR_NONE);
+    inst = ir_inst(func, value);
+    inst->op = IrOpNop;
+    inst->num_operands = 0;
+    inst->forward = IR_NONE;
+}
+
+UInt32 ir_successors(IrFunc* func, UInt32 block, UInt32* succs) {
+    Vec* insts = ir_block(func, block)->insts;
+    if(vec_size(insts) == 0)
+        return 0;
+    IrInst* term = ir_inst(func, *cast(IrValue*)vec_at(insts, vec_size(insts) - 1));
+    UInt32 num_succs = term->op == IrOpJump ? 1 : term->op == IrOpBranch ? 2 : 0;
+    for(UInt32 i = 0; i < num_succs; i++)
+        succs[i] = term->targets[i];
+    return num_succs;
+}
+
+// Uses -----------------------------------------------------------------------------------------------------------
+
+static void ir_add_use(IrFunc* func, IrValue value, IrValue user, UInt32 operand) {
+    IrInst* inst = ir_inst(func, value);
+    IrUse use = { .user = user, .operand = operand, .next = inst->uses };
+    inst->uses = cast(UInt32)vec_size(func->uses);
+    inst->num_uses++;
+    vec_push(func->uses, &use);
+}
+
+static void ir_remove_use(IrFunc* func, IrValue value, UInt32 operand) {
+    IrInst* inst = ir_inst(func, value);
+    UInt32* link = &inst->uses;
+    while(*link != IR_NONE) {
+        IrUse* use = cast(IrUse*)vec_at(func->uses, *link);
+        if(use->operand == operand) {
+            *link = use->next;
+            inst->num_uses--;
+            return;
+        }
+        link = &use->next;
+    }
+}
+
+void ir_alloc_operands(IrFunc* func, IrValue value, UInt32 num) {
+    IrInst* inst = ir_inst(func, value);
+    inst->operands = cast(UInt32)vec_size(func->operands);
+    inst->num_operands = num;
+    IrValue none = IR_NONE;
+    for(UInt32 i = 0; i < num; i++)
+        vec_push(func->operands, &none);
+}
+
+void ir_set_operand(IrFunc* func, IrValue user, UInt32 index, IrValue value) {
+    UInt32 slot = ir_inst(func, user)->operands + index;
+    IrValue* operand = cast(IrValue*)vec_at(func->operands, slot);
+    if(*operand != IR_NONE)
+        ir_remove_use(func, *operand, slot);
+    *operand = value;
+    if(value != IR_NONE)
+        ir_add_use(func, value, user, slot);
+}
+
+void ir_replace_uses(IrFunc* func, IrValue value, IrValue replacement) {
+    if(value == replacement)
+        return;
+
+    IrInst* inst = ir_inst(func, value);
+    IrInst* to = ir_inst(func, replacement);
+    UInt32 index = inst->uses;
+    while(index != IR_NONE) {
+        IrUse* use = cast(IrUse*)vec_at(func->uses, index);
+        UInt32 next = use->next;
+        *cast(IrValue*)vec_at(func->operands, use->operand) = replacement;
+        use->next = to->uses;
+        to->uses = index;
+        to->num_uses++;
+        index = next;
+    }
+    inst->uses = IR_NONE;
+    inst->num_uses = 0;
+}
+
+void ir_remove_pred(IrFunc* func, UInt32 block, UInt32 index) {
+    Vec* phis = ir_block(func, block)->phis;
+    for(UInt64 i = 0; i < vec_size(phis); i++) {
+        IrValue phi = *cast(IrValue*)vec_at(phis, i);
+        // Phis that were folded away stay in the list (as `Nop`s, without operands) until it's compacted
+        if(ir_inst(func, phi)->op != IrOpPhi)
+            continue;
+        UInt32 num_operands = ir_inst(func, phi)->num_operands;
+        for(UInt32 j = index; j + 1 < num_operands; j++)
+            ir_set_operand(func, phi, j, ir_operand(func, phi, j + 1));
+        ir_set_operand(func, phi, num_operands - 1, IR_NONE);
+        ir_inst(func, phi)->num_operands--;
+    }
+    ir_vec_remove(ir_block(func, block)->preds, index);
+}
+
+// Definitions -----------------------------------------------------------------------------------------------------
+
+static inline UInt64 ir_def_hash(UInt64 key) {
+    key *= 0x9E3779B97F4A7C15ULL;
+    return key ^ (key >> 32);
+}
+
+static void ir_defs_init(IrDefMap* map, UInt64 capacity) {
+    map->slots = cast(IrDef*)malloc(capacity * sizeof(IrDef));
+    CORETEN_ENFORCE_NN(map->slots, "Could not allocate memory. Memory full.");
+    for(UInt64 i = 0; i < capacity; i++)
+        map->slots[i].key = IR_DEF_EMPTY;
+    map->mask = capacity - 1;
+    map->count = 0;
+}
+
+static IrValue ir_defs_get(IrDefMap* map, UInt32 var, UInt32 block) {
+    UInt64 key = (cast(UInt64)var << 32) | block;
+    for(UInt64 i = ir_def_hash(key) & map->mask;; i = (i + 1) & map->mask) {
+        if(map->slots[i].key == key)
+            return map->slots[i].value;
+        if(map->slots[i].key == IR_DEF_EMPTY)
+            return IR_NONE;
+    }
+}
+
+static void ir_defs_put(IrDefMap* map, UInt32 var, UInt32 block, IrValue value) {
+    // Keep the load factor at 50% or lower
+    if(2 * (map->count + 1) > map->mask + 1) {
+        IrDefMap grown;
+        ir_defs_init(&grown, 2 * (map->mask + 1));
+        for(UInt64 i = 0; i <= map->mask; i++)
+            if(map->slots[i].key != IR_DEF_EMPTY)
+                ir_defs_put(&grown, cast(UInt32)(map->slots[i].key >> 32), cast(UInt32)map->slots[i].key,
+                            map->slots[i].value);
+        free(map->slots);
+        *map = grown;
+    }
+
+    UInt64 key = (cast(UInt64)var << 32) | block;
+    UInt64 i = ir_def_hash(key) & map->mask;
+    while(map->slots[i].key != key && map->slots[i].key != IR_DEF_EMPTY)
+        i = (i + 1) & map->mask;
+    if(map->slots[i].key == IR_DEF_EMPTY)
+        map->count++;
+    map->slots[i].key = key;
+    map->slots[i].value = value;
+}
+
+// Instructions and blocks -----------------------------------------------------------------------------------------
+
+IrValue ir_new_inst(IrFunc* func, UInt32 block, IrOp op, TypeId type) {
+    IrInst inst = {0};
+    inst.op = cast(UInt8)op;
+    inst.type = type;
+    inst.block = block;
+    inst.uses = IR_NONE;
+    IrValue value = cast(IrValue)vec_size(func->insts);
+    vec_push(func->insts, &inst);
+    return value;
+}
+
+// Append a new instruction to the current block
+static IrValue ir_emit(IrBuilder* b, IrOp op, TypeId type) {
+    CORETEN_ENFORCE(b->block != IR_NONE, "Expected a block to lower into");
+    IrValue value = ir_new_inst(b->func, b->block, op, type);
+    vec_push(ir_block(b->func, b->block)->insts, &value);
+    return value;
+}
+
+static IrValue ir_emit1(IrBuilder* b, IrOp op, TypeId type, IrValue a) {
+    IrValue value = ir_emit(b, op, type);
+    ir_alloc_operands(b->func, value, 1);
+    ir_set_operand(b->func, value, 0, a);
+    return value;
+}
+
+static IrValue ir_emit2(IrBuilder* b, IrOp op, TypeId type, IrValue a, IrValue c) {
+    IrValue value = ir_emit(b, op, type);
+    ir_alloc_operands(b->func, value, 2);
+    ir_set_operand(b->func, value, 0, a);
+    ir_set_operand(b->func, value, 1, c);
+    return value;
+}
+
+static IrValue ir_const(IrBuilder* b, TypeId type, UInt64 imm) {
+    IrValue value = ir_emit(b, IrOpConst, type);
+    ir_inst(b->func, value)->imm = imm;
+    return value;
+}
+
+// `value` (of `node`) has to be known at compile time (see `comptime_module()`)
+static void ir_add_comptime(IrBuilder* b, IrValue value, AstNode* node) {
+    if(value == IR_NONE)
+        return;
+    if(NONE(b->func->comptime))
+        b->func->comptime = VEC_NEW(IrComptime, 4);
+    IrComptime comptime = { value, node };
+    vec_push(b->func->comptime, &comptime);
+}
+
+static IrValue ir_new_phi(IrBuilder* b, UInt32 block, TypeId type) {
+    IrValue value = ir_new_inst(b->func, block, IrOpPhi, type);
+    vec_push(ir_block(b->func, block)->phis, &value);
+    return value;
+}
+
+UInt32 ir_add_block(IrFunc* func) {
+    IrBlock block;
+    block.phis = VEC_NEW(IrValue, 2);
+    block.insts = VEC_NEW(IrValue, 8);
+    block.preds = VEC_NEW(UInt32, 2);
+    vec_push(func->blocks, &block);
+    return cast(UInt32)vec_size(func->blocks) - 1;
+}
+
+static UInt32 ir_new_block(IrBuilder* b) {
+    IrBlockState state = { .is_sealed = false, .incomplete_phis = null };
+    vec_push(b->states, &state);
+    return ir_add_block(b->func);
+}
+
+// Continue lowering into `block`, unless nothing can ever jump to it
+static void ir_start_block(IrBuilder* b, UInt32 block) {
+    bool is_reachable = block == 0 || vec_size(ir_block(b->func, block)->preds) > 0;
+    b->block = is_reachable ? block : IR_NONE;
+}
+
+static void ir_jump(IrBuilder* b, UInt32 target) {
+    if(b->block == IR_NONE)
+        return;
+    IrValue jump = ir_emit(b, IrOpJump, TYPE_ID_NONE);
+    ir_inst(b->func, jump)->targets[0] = target;
+    vec_push(ir_block(b->func, target)->preds, &b->block);
+    b->block = IR_NONE;
+}
+
+static void ir_branch(IrBuilder* b, IrValue cond, UInt32 if_true, UInt32 if_false) {
+    if(b->block == IR_NONE)
+        return;
+    IrValue branch = ir_emit1(b, IrOpBranch, TYPE_ID_NONE, cond);
+    ir_inst(b->func, branch)->targets[0] = if_true;
+    ir_inst(b->func, branch)->targets[1] = if_false;
+    vec_push(ir_block(b->func, if_true)->preds, &b->block);
+    vec_push(ir_block(b->func, if_false)->preds, &b->block);
+    b->block = IR_NONE;
+}
+
+// SSA construction ------------------------------------------------------------------------------------------------
+
+static UInt32 ir_new_var(IrBuilder* b, TypeId type) {
+    vec_push(b->var_types, &type);
+    return cast(UInt32)vec_size(b->var_types) - 1;
+}
+
+// What a removed phi was replaced with
+static IrValue ir_resolve(IrFunc* func, IrValue value) {
+    while(value != IR_NONE && ir_inst(func, value)->op == IrOpNop && ir_inst(func, value)->forward != IR_NONE)
+        value = ir_inst(func, value)->forward;
+    return value;
+}
+
+// A phi whose operands are all the same value (or the phi itself) is just that value
+static IrValue ir_try_remove_trivial_phi(IrBuilder* b, IrValue phi) {
+    IrFunc* func = b->func;
+    IrValue same = IR_NONE;
+    UInt32 num_operands = ir_inst(func, phi)->num_operands;
+    for(UInt32 i = 0; i < num_operands; i++) {
+        IrValue operand = ir_operand(func, phi, i);
+        if(operand == same || operand == phi)
+            continue;
+        if(same != IR_NONE)
+            return phi;
+        same = operand;
+    }
+    // Only reachable through itself
+    if(same == IR_NONE)
+        return phi;
+
+    // Phis using this one may become trivial too
+    Vec* users = VEC_NEW(IrValue, 4);
+    for(UInt32 index = ir_inst(func, phi)->uses; index != IR_NONE;) {
+        IrUse* use = cast(IrUse*)vec_at(func->uses, index);
+        if(use->user != phi && ir_inst(func, use->user)->op == IrOpPhi)
+            vec_push(users, &use->user);
+        index = use->next;
+    }
+
+    for(UInt32 i = 0; i < num_operands; i++)
+        ir_set_operand(func, phi, i, IR_NONE);
+    ir_replace_uses(func, phi, same);
+    IrInst* inst = ir_inst(func, phi);
+    Vec* phis = ir_block(func, inst->block)->phis;
+    for(UInt64 i = 0; i < vec_size(phis); i++) {
+        if(*cast(IrValue*)vec_at(phis, i) == phi) {
+            ir_vec_remove(phis, i);
+            break;
+        }
+    }
+    inst->op = IrOpNop;
+    inst->num_operands = 0;
+    inst->forward = same;
+
+    for(UInt64 i = 0; i < vec_size(users); i++) {
+        IrValue user = *cast(IrValue*)vec_at(users, i);
+        if(ir_inst(func, user)->op == IrOpPhi)
+            ir_try_remove_trivial_phi(b, user);
+    }
+    vec_free(users);
+    return ir_resolve(func, same);
+}
+
+static IrValue ir_add_phi_operands(IrBuilder* b, UInt32 var, IrValue phi) {
+    IrFunc* func = b->func;
+    Vec* preds = ir_block(func, ir_inst(func, phi)->block)->preds;
+    UInt32 num_preds = cast(UInt32)vec_size(preds);
+    ir_alloc_operands(func, phi, num_preds);
+    for(UInt32 i = 0; i < num_preds; i++) {
+        UInt32 pred = *cast(UInt32*)vec_at(preds, i);
+        ir_set_operand(func, phi, i, ir_read_var(b, var, pred));
+    }
+    return ir_try_remove_trivial_phi(b, phi);
+}
+
+static void ir_write_var(IrBuilder* b, UInt32 var, UInt32 block, IrValue value) {
+    ir_defs_put(&b->defs, var, block, value);
+}
+
+static IrValue ir_read_var(IrBuilder* b, UInt32 var, UInt32 block) {
+    IrValue value = ir_defs_get(&b->defs, var, block);
+    if(value != IR_NONE)
+        return ir_resolve(b->func, value);
+
+    IrBlockState* state = cast(IrBlockState*)vec_at(b->states, block);
+    Vec* preds = ir_block(b->func, block)->preds;
+    TypeId type = *cast(TypeId*)vec_at(b->var_types, var);
+    if(!state->is_sealed) {
+        // Not all predecessors are known yet: the operands are added when they are
+        value = ir_new_phi(b, block, type);
+        IrIncompletePhi incomplete = { .var = var, .phi = value };
+        if(NONE(state->incomplete_phis))
+            state->incomplete_phis = VEC_NEW(IrIncompletePhi, 4);
+        vec_push(state->incomplete_phis, &incomplete);
+    } else if(vec_size(preds) == 1) {
+        value = ir_read_var(b, var, *cast(UInt32*)vec_at(preds, 0));
+    } else {
+        CORETEN_ENFORCE(vec_size(preds) > 0, "Read of a variable that was never written");
+        // The phi is written first, so a loop back to this block finds it
+        value = ir_new_phi(b, block, type);
+        ir_write_var(b, var, block, value);
+        value = ir_add_phi_operands(b, var, value);
+    }
+    ir_write_var(b, var, block, value);
+    return value;
+}
+
+// All predecessors of `block` are known
+static void ir_seal_block(IrBuilder* b, UInt32 block) {
+    IrBlockState* state = cast(IrBlockState*)vec_at(b->states, block);
+    if(state->is_sealed)
+        return;
+
+    // Adding operands can add more incomplete phis to the block
+    Vec* incomplete_phis = state->incomplete_phis;
+    for(UInt64 i = 0; SOME(incomplete_phis) && i < vec_size(incomplete_phis); i++) {
+        IrIncompletePhi incomplete = *cast(IrIncompletePhi*)vec_at(incomplete_phis, i);
+        ir_add_phi_operands(b, incomplete.var, incomplete.phi);
+    }
+    state = cast(IrBlockState*)vec_at(b->states, block);
+    if(SOME(state->incomplete_phis))
+        vec_free(state->incomplete_phis);
+    state->incomplete_phis = null;
+    state->is_sealed = true;
+}
+
+// Locals ----------------------------------------------------------------------------------------------------------
+
+static IrLocal* ir_find_local(IrBuilder* b, Buff* name) {
+    for(UInt64 i = vec_size(b->locals); i > 0; i--) {
+        IrLocal* local = cast(IrLocal*)vec_at(b->locals, i - 1);
+        if(local->name->len == name->len && memcmp(local->name->data, name->data, name->len) == 0)
+            return local;
+    }
+    return null;
+}
+
+static bool ir_is_addr_taken(IrBuilder* b, Buff* name) {
+    for(UInt64 i = 0; SOME(b->addr_taken) && i < vec_size(b->addr_taken); i++) {
+        Buff* taken = *cast(Buff**)vec_at(b->addr_taken, i);
+        if(taken->len == name->len && memcmp(taken->data, name->data, name->len) == 0)
+            return true;
+    }
+    return false;
+}
+
+// Declare a local initialized with `value`
+static void ir_declare_local(IrBuilder* b, Buff* name, TypeId type, IrValue value) {
+    IrLocal local = { .name = name, .var = IR_NONE, .slot = IR_NONE, .type = type };
+    if(ir_is_addr_taken(b, name)) {
+        local.slot = ir_emit(b, IrOpSlot, type_pointer_to(type_get(type))->id);
+        ir_emit2(b, IrOpStore, TYPE_ID_NONE, local.slot, value);
+    } else {
+        local.var = ir_new_var(b, type);
+        ir_write_var(b, local.var, b->block, value);
+    }
+    vec_push(b->locals, &local);
+}
+
+static void ir_pop_scope(IrBuilder* b, UInt64 scope_begin) {
+    while(vec_size(b->locals) > scope_begin)
+        vec_pop(b->locals);
+}
+
+// Collect the names of the locals `&` is applied to in `node`
+static void ir_find_addr_taken(IrBuilder* b, AstNode* node) {
+    if(NONE(node))
+        return;
+
+    Vec* children = null;
+    switch(node->kind) {
+        case AstNodeKindPrefixOpExpr: {
+            AstNodePrefixOpExpr* prefix = node->data.prefix_op_expr;
+            if(prefix->op == PrefixOpKindAddrOf && prefix->expr->kind == AstNodeKindIdentifier) {
+                if(NONE(b->addr_taken))
+                    b->addr_taken = VEC_NEW(Buff*, 4);
+                vec_push(b->addr_taken, &prefix->expr->data.identifier->name);
+            }
+            ir_find_addr_taken(b, prefix->expr);
+            return;
+        }
+        case AstNodeKindBinaryOpExpr:
+            ir_find_addr_taken(b, node->data.expr->binary_op_expr->lhs);
+            ir_find_addr_taken(b, node->data.expr->binary_op_expr->rhs);
+            return;
+        case AstNodeKindGroupedExpr: ir_find_addr_taken(b, node->data.expr->grouped_expr->expr); return;
+        case AstNodeKindAttributeExpr: ir_find_addr_taken(b, node->data.expr->attr_expr->expr); return;
+        case AstNodeKindVariableDecl: ir_find_addr_taken(b, node->data.scope_obj->var->init_expr); return;
+        case AstNodeKindReturn: ir_find_addr_taken(b, node->data.stmt->return_stmt->expr); return;
+        case AstNodeKindFieldAccessExpr: ir_find_addr_taken(b, node->data.field_access_expr->struct_expr); return;
+        case AstNodeKindArrayAccessExpr:
+            ir_find_addr_taken(b, node->data.array_access_expr->array_ref_expr);
+            ir_find_addr_taken(b, node->data.array_access_expr->subscript);
+            return;
+        case AstNodeKindSliceExpr: {
+            AstNodeSliceExpr* slice = node->data.expr->slice_expr;
+            ir_find_addr_taken(b, slice->array_ref_expr);
+            ir_find_addr_taken(b, slice->lower);
+            ir_find_addr_taken(b, slice->upper);
+            ir_find_addr_taken(b, slice->step);
+            return;
+        }
+        case AstNodeKindFuncCallExpr:
+            ir_find_addr_taken(b, node->data.expr->func_call_expr->func_call_expr);
+            children = node->data.expr->func_call_expr->params;
+            break;
+        case AstNodeKindIfExpr:
+            ir_find_addr_taken(b, node->data.expr->if_expr->condition);
+            ir_find_addr_taken(b, node->data.expr->if_expr->if_body);
+            ir_find_addr_taken(b, node->data.expr->if_expr->else_node);
+            return;
+        case AstNodeKindMatchExpr:
+            ir_find_addr_taken(b, node->data.expr->match_expr->expr);
+            children = node->data.expr->match_expr->branches;
+            break;
+        case AstNodeKindMatchBranch:
+            ir_find_addr_taken(b, node->data.expr->match_branch_expr->cond_node);
+            ir_find_addr_taken(b, node->data.expr->match_branch_expr->block_node);
+            return;
+        case AstNodeKindMatchRange:
+            ir_find_addr_taken(b, node->data.expr->match_range_expr->begin);
+            ir_find_addr_taken(b, node->data.expr->match_range_expr->end);
+            return;
+        case AstNodeKindBlock: children = node->data.stmt->block_stmt->statements; break;
+        case AstNodeKindLoopInfExpr:
+            ir_find_addr_taken(b, node->data.expr->loop_expr->loop_inf_expr->cond);
+            children = node->data.expr->loop_expr->loop_inf_expr->statements;
+            break;
+        case AstNodeKindLoopCExpr:
+            ir_find_addr_taken(b, node->data.expr->loop_expr->loop_c_expr->init);
+            ir_find_addr_taken(b, node->data.expr->loop_expr->loop_c_expr->cond);
+            ir_find_addr_taken(b, node->data.expr->loop_expr->loop_c_expr->updation);
+            children = node->data.expr->loop_expr->loop_c_expr->statements;
+            break;
+        case AstNodeKindLoopInExpr:
+            ir_find_addr_taken(b, node->data.expr->loop_expr->loop_in_expr->cond);
+            children = node->data.expr->loop_expr->loop_in_expr->statements;
+            break;
+        case AstNodeKindStringLiteral: {
+            Vec* parts = node->data.literal->str_value->parts;
+            for(UInt64 i = 0; SOME(parts) && i < vec_size(parts); i++)
+                ir_find_addr_taken(b, (cast(AstNodeFormatPart*)vec_at(parts, i))->expr);
+            return;
+        }
+        default:
+            return;
+    }
+
+    for(UInt64 i = 0; SOME(children) && i < vec_size(children); i++)
+        ir_find_addr_taken(b, cast(AstNode*)vec_at(children, i));
+}
+
+// Expressions -----------------------------------------------------------------------------------------------------
+
+// `value` converted to `to` (for everything the checker accepts as assignable)
+static IrValue ir_convert(IrBuilder* b, IrValue value, TypeId to) {
+    if(value == IR_NONE || to == TYPE_ID_NONE || ir_inst(b->func, value)->type == to)
+        return value;
+    return ir_emit1(b, IrOpConvert, to, value);
+}
+
+static IrValue ir_lower_converted(IrBuilder* b, AstNode* node, TypeId to) {
+    return ir_convert(b, ir_lower_expr(b, node), to);
+}
+
+static IrValue ir_lower_int_literal(IrBuilder* b, AstNode* node) {
+    // The checker made sure the literal fits in its type
+    UInt64 value = 0;
+    checker_int_literal_value(node->data.literal->int_value->value, &value);
+    // An integer literal can be used as a float
+    if(type_is_float(type_get(node->type))) {
+        IrValue constant = ir_emit(b, IrOpConstFloat, node->type);
+        ir_inst(b->func, constant)->fimm = cast(double)value;
+        return constant;
+    }
+    return ir_const(b, node->type, value);
+}
+
+static IrValue ir_lower_float_literal(IrBuilder* b, AstNode* node) {
+    Buff* spelling = node->data.literal->float_value->value;
+    char digits[64];
+    UInt64 len = 0;
+    for(UInt64 i = 0; i < spelling->len && len + 1 < sizeof(digits); i++)
+        if(spelling->data[i] != '_')
+            digits[len++] = spelling->data[i];
+    digits[len] = nullchar;
+
+    IrValue constant = ir_emit(b, IrOpConstFloat, node->type);
+    ir_inst(b->func, constant)->fimm = strtod(digits, null);
+    return constant;
+}
+
+static IrValue ir_lower_identifier(IrBuilder* b, AstNode* node) {
+    Buff* name = node->data.identifier->name;
+    IrLocal* local = ir_find_local(b, name);
+    if(SOME(local)) {
+        if(local->slot != IR_NONE)
+            return ir_emit1(b, IrOpLoad, local->type, local->slot);
+        return ir_read_var(b, local->var, b->block);
+    }
+
+    Symbol* symbol = checker_lookup(b->checker, name->data, name->len);
+    IrValue value = ir_emit(b, symbol->kind == SymbolKindFunc ? IrOpFunc : IrOpLoadGlobal, symbol->type->id);
+    ir_inst(b->func, value)->symbol = symbol;
+    return value;
+}
+
+static IrOp ir_binary_op(BinaryOpKind op) {
+    switch(op) {
+        case BinaryOpKindAdd: case BinaryOpKindAssignmentPlus: return IrOpAdd;
+        case BinaryOpKindSubtract: case BinaryOpKindAssignmentMinus: return IrOpSub;
+        case BinaryOpKindMult: case BinaryOpKindAssignmentMult: return IrOpMul;
+        case BinaryOpKindDiv: case BinaryOpKindAssignmentDiv: return IrOpDiv;
+        case BinaryOpKindMod: case BinaryOpKindAssignmentMod: return IrOpMod;
+        case BinaryOpKindBitAnd: case BinaryOpKindAssignmentBitAnd: return IrOpAnd;
+        case BinaryOpKindBitOr: case BinaryOpKindAssignmentBitOr: return IrOpOr;
+        case BinaryOpKindBitXor: case BinaryOpKindAssignmentBitXor: return IrOpXor;
+        case BinaryOpKindBitshitLeft: case BinaryOpKindAssignmentBitshiftLeft: return IrOpShl;
+        case BinaryOpKindBitshitRight: case BinaryOpKindAssignmentBitshiftRight: return IrOpShr;
+        case BinaryOpKindCmpEqual: return IrOpEq;
+        case BinaryOpKindCmpNotEqual: return IrOpNe;
+        case BinaryOpKindCmpLessThan: return IrOpLt;
+        case BinaryOpKindCmpLessThanorEqualTo: return IrOpLe;
+        case BinaryOpKindCmpGreaterThan: return IrOpGt;
+        case BinaryOpKindCmpGreaterThanorEqualTo: return IrOpGe;
+        default: return IrOpNop;
+    }
+}
+
+// `lhs op rhs`, where both have type `type` (`+` on strings is a `concat`)
+static IrValue ir_arith(IrBuilder* b, IrOp op, TypeId type, IrValue lhs, IrValue rhs) {
+    if(op == IrOpAdd && type_get(type)->kind == AdoradTypeString)
+        op = IrOpConcat;
+    return ir_emit2(b, op, type, ir_convert(b, lhs, type), ir_convert(b, rhs, type));
+}
+
+// The element offset of `tensor[i][j]...` (`node`) in `tensor` (which is lowered into `*tensor`): `(i * dim1 + j) *
+// dim2 + ...`, with every subscript checked against its dimension
+static IrValue ir_lower_index(IrBuilder* b, AstNode* node, IrValue* tensor) {
+    AstNode* subscripts[TENSOR_MAX_RANK];
+    UInt32 rank = 0;
+    AstNode* root = node;
+    for(; root->kind == AstNodeKindArrayAccessExpr; root = root->data.array_access_expr->array_ref_expr)
+        subscripts[rank++] = root->data.array_access_expr->subscript;
+
+    TypeId int64_type = type_primitive(AdoradTypeInt64)->id;
+    *tensor = ir_lower_expr(b, root);
+    IrValue offset = IR_NONE;
+    for(UInt32 d = 0; d < rank; d++) {
+        IrValue index = ir_lower_converted(b, subscripts[rank - 1 - d], int64_type);
+        IrValue dim = ir_emit1(b, IrOpTensorDim, int64_type, *tensor);
+        ir_inst(b->func, dim)->imm = d;
+        ir_emit2(b, IrOpBoundsCheck, TYPE_ID_NONE, index, dim);
+        offset = d == 0 ? index : ir_emit2(b, IrOpAdd, int64_type, ir_emit2(b, IrOpMul, int64_type, offset, dim), index);
+    }
+    return offset;
+}
+
+static IrValue ir_lower_tensor_get(IrBuilder* b, AstNode* node) {
+    IrValue tensor = IR_NONE;
+    IrValue offset = ir_lower_index(b, node, &tensor);
+    return ir_emit2(b, IrOpTensorGet, node->type, tensor, offset);
+}
+
+// `tensor[lower..upper:step]`
+static IrValue ir_lower_slice(IrBuilder* b, AstNode* node) {
+    AstNodeSliceExpr* slice = node->data.expr->slice_expr;
+    TypeId int64_type = type_primitive(AdoradTypeInt64)->id;
+    IrValue tensor = ir_lower_expr(b, slice->array_ref_expr);
+    IrValue lower = SOME(slice->lower) ? ir_lower_converted(b, slice->lower, int64_type) : ir_const(b, int64_type, 0);
+    IrValue upper = SOME(slice->upper) ? ir_lower_converted(b, slice->upper, int64_type) :
+                                         ir_emit1(b, IrOpTensorLen, int64_type, tensor);
+    IrValue step = SOME(slice->step) ? ir_lower_converted(b, slice->step, int64_type) : ir_const(b, int64_type, 1);
+
+    IrValue view = ir_emit(b, IrOpTensorSlice, node->type);
+    ir_alloc_operands(b->func, view, 4);
+    ir_set_operand(b->func, view, 0, tensor);
+    ir_set_operand(b->func, view, 1, lower);
+    ir_set_operand(b->func, view, 2, upper);
+    ir_set_operand(b->func, view, 3, step);
+    return view;
+}
+
+// `tensor[i][j]... = rhs` (or `op=`)
+static IrValue ir_lower_tensor_set(IrBuilder* b, AstNode* node) {
+    AstNodeBinaryOpExpr* binop = node->data.expr->binary_op_expr;
+    TypeId type = binop->lhs->type;
+    IrValue tensor = IR_NONE;
+    IrValue offset = ir_lower_index(b, binop->lhs, &tensor);
+    IrValue value = IR_NONE;
+    if(binop->op == BinaryOpKindAssignmentEquals) {
+        value = ir_lower_converted(b, binop->rhs, type);
+    } else {
+        IrValue old = ir_emit2(b, IrOpTensorGet, type, tensor, offset);
+        value = ir_arith(b, ir_binary_op(binop->op), type, old, ir_lower_expr(b, binop->rhs));
+    }
+
+    IrValue set = ir_emit(b, IrOpTensorSet, TYPE_ID_NONE);
+    ir_alloc_operands(b->func, set, 3);
+    ir_set_operand(b->func, set, 0, tensor);
+    ir_set_operand(b->func, set, 1, offset);
+    ir_set_operand(b->func, set, 2, value);
+    return IR_NONE;
+}
+
+static IrValue ir_lower_assignment(IrBuilder* b, AstNode* node) {
+    AstNodeBinaryOpExpr* binop = node->data.expr->binary_op_expr;
+    if(binop->lhs->kind == AstNodeKindArrayAccessExpr)
+        return ir_lower_tensor_set(b, node);
+    Buff* name = binop->lhs->data.identifier->name;
+    TypeId type = binop->lhs->type;
+    IrLocal* local = ir_find_local(b, name);
+    Symbol* symbol = NONE(local) ? checker_lookup(b->checker, name->data, name->len) : null;
+
+    IrValue value = IR_NONE;
+    if(binop->op == BinaryOpKindAssignmentEquals) {
+        value = ir_lower_converted(b, binop->rhs, type);
+    } else {
+        IrValue old = ir_lower_identifier(b, binop->lhs);
+        value = ir_arith(b, ir_binary_op(binop->op), type, old, ir_lower_expr(b, binop->rhs));
+    }
+
+    if(SOME(symbol)) {
+        IrValue store = ir_emit1(b, IrOpStoreGlobal, TYPE_ID_NONE, value);
+        ir_inst(b->func, store)->symbol = symbol;
+    } else if(local->slot != IR_NONE) {
+        ir_emit2(b, IrOpStore, TYPE_ID_NONE, local->slot, value);
+    } else {
+        ir_write_var(b, local->var, b->block, value);
+    }
+    return IR_NONE;
+}
+
+// `&&`/`||` as a value: the right-hand side is only evaluated if needed
+static IrValue ir_lower_logical(IrBuilder* b, AstNode* node) {
+    AstNodeBinaryOpExpr* binop = node->data.expr->binary_op_expr;
+    TypeId bool_type = type_primitive(AdoradTypeBool)->id;
+    bool is_and = binop->op == BinaryOpKindBoolAnd;
+
+    IrValue lhs = ir_lower_converted(b, binop->lhs, bool_type);
+    IrValue shortcut = ir_const(b, bool_type, is_and ? 0 : 1);
+    UInt32 lhs_block = b->block;
+    UInt32 rhs_block = ir_new_block(b);
+    UInt32 merge = ir_new_block(b);
+    if(is_and)
+        ir_branch(b, lhs, rhs_block, merge);
+    else
+        ir_branch(b, lhs, merge, rhs_block);
+
+    ir_seal_block(b, rhs_block);
+    ir_start_block(b, rhs_block);
+    IrValue rhs = ir_lower_converted(b, binop->rhs, bool_type);
+    ir_jump(b, merge);
+    ir_seal_block(b, merge);
+    ir_start_block(b, merge);
+
+    IrValue phi = ir_new_phi(b, merge, bool_type);
+    ir_alloc_operands(b->func, phi, 2);
+    Vec* preds = ir_block(b->func, merge)->preds;
+    for(UInt32 i = 0; i < 2; i++)
+        ir_set_operand(b->func, phi, i, *cast(UInt32*)vec_at(preds, i) == lhs_block ? shortcut : rhs);
+    return phi;
+}
+
+static IrValue ir_lower_comparison(IrBuilder* b, AstNode* node) {
+    AstNodeBinaryOpExpr* binop = node->data.expr->binary_op_expr;
+    TypeId bool_type = type_primitive(AdoradTypeBool)->id;
+    Type* lhs_type = type_get(binop->lhs->type);
+    Type* rhs_type = type_get(binop->rhs->type);
+    IrOp op = ir_binary_op(binop->op);
+
+    // `x == null`
+    if(lhs_type->kind == AdoradTypeNull || rhs_type->kind == AdoradTypeNull) {
+        AstNode* other = lhs_type->kind == AdoradTypeNull ? binop->rhs : binop->lhs;
+        IrValue value = ir_lower_expr(b, other);
+        if(type_get(other->type)->kind != AdoradTypeOptional)
+            return ir_const(b, bool_type, op == IrOpNe);
+        IrValue is_null = ir_emit1(b, IrOpIsNull, bool_type, value);
+        return op == IrOpEq ? is_null : ir_emit1(b, IrOpNot, bool_type, is_null);
+    }
+
+    TypeId type = type_is_assignable(lhs_type, rhs_type) ? lhs_type->id : rhs_type->id;
+    IrValue lhs = ir_lower_converted(b, binop->lhs, type);
+    IrValue rhs = ir_lower_converted(b, binop->rhs, type);
+    return ir_emit2(b, op, bool_type, lhs, rhs);
+}
+
+static IrValue ir_lower_binary_op(IrBuilder* b, AstNode* node) {
+    AstNodeBinaryOpExpr* binop = node->data.expr->binary_op_expr;
+    switch(binop->op) {
+        case BinaryOpKindAssignmentMult:
+        case BinaryOpKindAssignmentDiv:
+        case BinaryOpKindAssignmentMod:
+        case BinaryOpKindAssignmentPlus:
+        case BinaryOpKindAssignmentMinus:
+        case BinaryOpKindAssignmentBitshiftLeft:
+        case BinaryOpKindAssignmentBitshiftRight:
+        case BinaryOpKindAssignmentBitAnd:
+        case BinaryOpKindAssignmentBitXor:
+        case BinaryOpKindAssignmentBitOr:
+        case BinaryOpKindAssignmentEquals:
+            return ir_lower_assignment(b, node);
+
+        case BinaryOpKindBoolAnd:
+        case BinaryOpKindBoolOr:
+            return ir_lower_logical(b, node);
+
+        case BinaryOpKindCmpEqual:
+        case BinaryOpKindCmpNotEqual:
+        case BinaryOpKindCmpLessThan:
+        case BinaryOpKindCmpGreaterThan:
+        case BinaryOpKindCmpLessThanorEqualTo:
+        case BinaryOpKindCmpGreaterThanorEqualTo:
+            return ir_lower_comparison(b, node);
+
+        default: {
+            IrValue lhs = ir_lower_expr(b, binop->lhs);
+            IrValue rhs = ir_lower_expr(b, binop->rhs);
+            return ir_arith(b, ir_binary_op(binop->op), node->type, lhs, rhs);
+        }
+    }
+}
+
+static IrValue ir_lower_prefix_op(IrBuilder* b, AstNode* node) {
+    AstNodePrefixOpExpr* prefix = node->data.prefix_op_expr;
+    switch(prefix->op) {
+        case PrefixOpKindBoolNot:
+        case PrefixOpKindNegation:
+            return ir_emit1(b, IrOpNot, node->type, ir_lower_converted(b, prefix->expr, node->type));
+        case PrefixOpKindMinus:
+            return ir_emit1(b, IrOpNeg, node->type, ir_lower_converted(b, prefix->expr, node->type));
+        case PrefixOpKindAddrOf: {
+            // The checker only allows `&variable`
+            Buff* name = prefix->expr->data.identifier->name;
+            IrLocal* local = ir_find_local(b, name);
+            if(SOME(local))
+                return local->slot;
+            IrValue addr = ir_emit(b, IrOpGlobalAddr, node->type);
+            ir_inst(b->func, addr)->symbol = checker_lookup(b->checker, name->data, name->len);
+            return addr;
+        }
+        default:
+            unreachable();
+            return IR_NONE;
+    }
+}
+
+// The variable `filter()`/`map()` bind each element to
+static Buff ir_it_name = { "it", 2 };
+
+static IrValue ir_lower_tensor_chain(IrBuilder* b, AstNode* node) {
+    // The methods of the chain, from the first to the last (`node`)
+    Vec* stages = VEC_NEW(AstNode*, 4);
+    AstNode* source = node;
+    while(checker_tensor_method(source) != CheckerTensorMethodNone) {
+        vec_push(stages, &source);
+        source = source->data.expr->func_call_expr->func_call_expr->data.field_access_expr->struct_expr;
+    }
+    UInt64 num_stages = vec_size(stages);
+    CheckerTensorMethod last = checker_tensor_method(node);
+    bool makes_tensor = last == CheckerTensorMethodFilter || last == CheckerTensorMethodMap;
+    bool is_min_max = last == CheckerTensorMethodMin || last == CheckerTensorMethodMax;
+    TypeId int64_type = type_primitive(AdoradTypeInt64)->id;
+    TypeId bool_type = type_primitive(AdoradTypeBool)->id;
+
+    IrValue tensor = ir_lower_expr(b, source);
+    IrValue len = ir_emit1(b, IrOpTensorLen, int64_type, tensor);
+    IrValue out = IR_NONE;
+    UInt32 acc = IR_NONE;
+    UInt32 seen = IR_NONE;
+    if(makes_tensor) {
+        out = ir_emit1(b, IrOpTensorNew, node->type, len);
+    } else {
+        acc = ir_new_var(b, node->type);
+        ir_write_var(b, acc, b->block, last == CheckerTensorMethodCount ? ir_const(b, int64_type, 0) :
+                                                                          ir_emit(b, IrOpZero, node->type));
+        if(is_min_max) {
+            seen = ir_new_var(b, bool_type);
+            ir_write_var(b, seen, b->block, ir_const(b, bool_type, false));
+        }
+    }
+    UInt32 index = ir_new_var(b, int64_type);
+    ir_write_var(b, index, b->block, ir_const(b, int64_type, 0));
+
+    UInt32 header = ir_new_block(b);
+    UInt32 body = ir_new_block(b);
+    UInt32 latch = ir_new_block(b);
+    UInt32 exit = ir_new_block(b);
+    ir_jump(b, header);
+    ir_start_block(b, header);
+    IrValue i = ir_read_var(b, index, b->block);
+    ir_branch(b, ir_emit2(b, IrOpLt, bool_type, i, len), body, exit);
+
+    ir_seal_block(b, body);
+    ir_start_block(b, body);
+    TypeId elem_type = type_tensor_elem(type_get(source->type))->id;
+    IrValue elem = ir_emit2(b, IrOpTensorGet, elem_type, tensor, ir_read_var(b, index, b->block));
+    for(UInt64 s = 0; s < num_stages; s++) {
+        AstNode* stage = *cast(AstNode**)vec_at(stages, num_stages - 1 - s);
+        CheckerTensorMethod method = checker_tensor_method(stage);
+        if(method != CheckerTensorMethodFilter && method != CheckerTensorMethodMap)
+            continue;
+
+        AstNode* arg = cast(AstNode*)vec_at(stage->data.expr->func_call_expr->params, 0);
+        UInt64 prev_scope_begin = b->scope_begin;
+        b->scope_begin = vec_size(b->locals);
+        ir_declare_local(b, &ir_it_name, elem_type, elem);
+        if(method == CheckerTensorMethodFilter) {
+            // Elements that don't pass go straight to the next one
+            UInt32 pass = ir_new_block(b);
+            ir_lower_cond(b, arg, pass, latch);
+            ir_seal_block(b, pass);
+            ir_start_block(b, pass);
+        } else {
+            elem = ir_lower_expr(b, arg);
+            elem_type = arg->type;
+        }
+        ir_pop_scope(b, b->scope_begin);
+        b->scope_begin = prev_scope_begin;
+    }
+
+    if(b->block != IR_NONE) {
+        switch(last) {
+            case CheckerTensorMethodFilter:
+            case CheckerTensorMethodMap: ir_emit2(b, IrOpTensorPush, TYPE_ID_NONE, out, elem); break;
+            case CheckerTensorMethodSum:
+                ir_write_var(b, acc, b->block, ir_emit2(b, IrOpAdd, node->type, ir_read_var(b, acc, b->block), elem));
+                break;
+            case CheckerTensorMethodCount: {
+                IrValue count = ir_read_var(b, acc, b->block);
+                ir_write_var(b, acc, b->block, ir_emit2(b, IrOpAdd, int64_type, count, ir_const(b, int64_type, 1)));
+                break;
+            }
+            default: {
+                // The first element is taken as it is, and the others if they're less (or greater)
+                UInt32 compare = ir_new_block(b);
+                UInt32 take = ir_new_block(b);
+                ir_branch(b, ir_read_var(b, seen, b->block), compare, take);
+                ir_seal_block(b, compare);
+                ir_start_block(b, compare);
+                IrOp op = last == CheckerTensorMethodMin ? IrOpLt : IrOpGt;
+                ir_branch(b, ir_emit2(b, op, bool_type, elem, ir_read_var(b, acc, b->block)), take, latch);
+                ir_seal_block(b, take);
+                ir_start_block(b, take);
+                ir_write_var(b, acc, b->block, elem);
+                ir_write_var(b, seen, b->block, ir_const(b, bool_type, true));
+                break;
+            }
+        }
+    }
+    ir_jump(b, latch);
+    ir_seal_block(b, latch);
+    ir_start_block(b, latch);
+    i = ir_read_var(b, index, b->block);
+    ir_write_var(b, index, b->block, ir_emit2(b, IrOpAdd, int64_type, i, ir_const(b, int64_type, 1)));
+    ir_jump(b, header);
+    ir_seal_block(b, header);
+    ir_seal_block(b, exit);
+    ir_start_block(b, exit);
+    vec_free(stages);
+
+    if(makes_tensor)
+        return out;
+    if(is_min_max) {
+        // There's no minimum/maximum of no elements
+        UInt32 done = ir_new_block(b);
+        UInt32 empty = ir_new_block(b);
+        ir_branch(b, ir_read_var(b, seen, b->block), done, empty);
+        ir_seal_block(b, empty);
+        ir_start_block(b, empty);
+        ir_emit(b, IrOpUnreachable, TYPE_ID_NONE);
+        ir_seal_block(b, done);
+        ir_start_block(b, done);
+    }
+    return ir_read_var(b, acc, b->block);
+}
+
+// `tensor.clone()`. A chain of methods that makes a tensor (`xs.map(...).clone()`) already made a copy.
+static IrValue ir_lower_clone(IrBuilder* b, AstNode* node) {
+    AstNode* receiver = node->data.expr->func_call_expr->func_call_expr->data.field_access_expr->struct_expr;
+    CheckerTensorMethod method = checker_tensor_method(receiver);
+    IrValue tensor = ir_lower_expr(b, receiver);
+    if(method == CheckerTensorMethodFilter || method == CheckerTensorMethodMap || method == CheckerTensorMethodClone)
+        return tensor;
+    return ir_emit1(b, IrOpTensorClone, node->type, tensor);
+}
+
+// The variable `sort()` binds the element whose key is computed to
+static Buff ir_a_name = { "a", 1 };
+
+// `tensor.sort(cond)`. The key of every element is computed into a tensor first (in a loop like a chain's), so the
+// sort itself never runs any code of the function.
+static IrValue ir_lower_sort(IrBuilder* b, AstNode* node) {
+    AstNode* receiver = node->data.expr->func_call_expr->func_call_expr->data.field_access_expr->struct_expr;
+    bool descending = false;
+    AstNode* key = checker_sort_key(node, &descending);
+    IrValue tensor = ir_lower_expr(b, receiver);
+    if(NONE(key) || (key->kind == AstNodeKindIdentifier && buff_cmp(key->data.identifier->name, &ir_a_name))) {
+        IrValue sort = ir_emit1(b, IrOpTensorSort, TYPE_ID_NONE, tensor);
+        ir_inst(b->func, sort)->imm = descending;
+        return sort;
+    }
+
+    TypeId int64_type = type_primitive(AdoradTypeInt64)->id;
+    TypeId bool_type = type_primitive(AdoradTypeBool)->id;
+    TypeId elem_type = type_tensor_elem(type_get(receiver->type))->id;
+    IrValue len = ir_emit1(b, IrOpTensorLen, int64_type, tensor);
+    IrValue keys = ir_emit1(b, IrOpTensorNew, type_tensor_for(type_get(key->type))->id, len);
+    UInt32 index = ir_new_var(b, int64_type);
+    ir_write_var(b, index, b->block, ir_const(b, int64_type, 0));
+
+    UInt32 header = ir_new_block(b);
+    UInt32 body = ir_new_block(b);
+    UInt32 exit = ir_new_block(b);
+    ir_jump(b, header);
+    ir_start_block(b, header);
+    IrValue i = ir_read_var(b, index, b->block);
+    ir_branch(b, ir_emit2(b, IrOpLt, bool_type, i, len), body, exit);
+
+    ir_seal_block(b, body);
+    ir_start_block(b, body);
+    IrValue elem = ir_emit2(b, IrOpTensorGet, elem_type, tensor, i);
+    UInt64 prev_scope_begin = b->scope_begin;
+    b->scope_begin = vec_size(b->locals);
+    ir_declare_local(b, &ir_a_name, elem_type, elem);
+    ir_emit2(b, IrOpTensorPush, TYPE_ID_NONE, keys, ir_lower_expr(b, key));
+    ir_pop_scope(b, b->scope_begin);
+    b->scope_begin = prev_scope_begin;
+    ir_write_var(b, index, b->block, ir_emit2(b, IrOpAdd, int64_type, i, ir_const(b, int64_type, 1)));
+    ir_jump(b, header);
+    ir_seal_block(b, header);
+    ir_seal_block(b, exit);
+    ir_start_block(b, exit);
+
+    IrValue sort = ir_emit2(b, IrOpTensorSortByKey, TYPE_ID_NONE, tensor, keys);
+    ir_inst(b->func, sort)->imm = descending;
+    return sort;
+}
+
+static IrValue ir_lower_call(IrBuilder* b, AstNode* node) {
+    CheckerTensorMethod method = checker_tensor_method(node);
+    if(method == CheckerTensorMethodClone)
+        return ir_lower_clone(b, node);
+    if(method == CheckerTensorMethodSort)
+        return ir_lower_sort(b, node);
+    if(method != CheckerTensorMethodNone)
+        return ir_lower_tensor_chain(b, node);
+    AstNodeFuncCallExpr* call = node->data.expr->func_call_expr;
+    Type* callee_type = type_get(call->func_call_expr->type);
+    IrValue callee = ir_lower_expr(b, call->func_call_expr);
+
+    UInt32 num_args = cast(UInt32)vec_size(call->params);
+    IrValue* args = cast(IrValue*)malloc((num_args + 1) * sizeof(IrValue));
+    CORETEN_ENFORCE_NN(args, "Could not allocate memory. Memory full.");
+    for(UInt32 i = 0; i < num_args; i++) {
+        AstNode* arg = cast(AstNode*)vec_at(call->params, i);
+        TypeId param = i < callee_type->num_params ? callee_type->params[i]->id : TYPE_ID_NONE;
+        args[i] = ir_lower_converted(b, arg, param);
+    }
+
+    TypeId ret = callee_type->ret->kind == AdoradTypeVoid ? TYPE_ID_NONE : callee_type->ret->id;
+    IrValue value = ir_emit(b, IrOpCall, ret);
+    ir_alloc_operands(b->func, value, num_args + 1);
+    ir_set_operand(b->func, value, 0, callee);
+    for(UInt32 i = 0; i < num_args; i++)
+        ir_set_operand(b->func, value, i + 1, args[i]);
+    free(args);
+
+    IrInst* inst = ir_inst(b->func, callee);
+    if(inst->op == IrOpFunc && inst->symbol->decl->data.decl->func_decl->is_comptime)
+        ir_add_comptime(b, value, node);
+    return value;
+}
+
+// `f"..."`: its text (with the escape sequences resolved) and the specs of its holes become a `Format`, and all that's
+// left for run time is one `format` of the values of the holes
+static IrValue ir_lower_format_string(IrBuilder* b, AstNode* node) {
+    Vec* parts = node->data.literal->str_value->parts;
+    UInt32 num_holes = cast(UInt32)vec_size(parts) - 1;
+    IrValue* args = cast(IrValue*)malloc((num_holes + 1) * sizeof(IrValue));
+    CORETEN_ENFORCE_NN(args, "Could not allocate memory. Memory full.");
+    Format* format = format_new();
+    for(UInt32 i = 0; i <= num_holes; i++) {
+        AstNodeFormatPart* part = cast(AstNodeFormatPart*)vec_at(parts, i);
+        char* text = cast(char*)malloc(part->text->len + 1);
+        CORETEN_ENFORCE_NN(text, "Could not allocate memory. Memory full.");
+        format_add_text(format, text, ir_unescape(part->text, text));
+        free(text);
+        if(NONE(part->expr))
+            continue;
+
+        // The checker made sure both of these work
+        FormatKind kind = FormatKindInt;
+        FormatSpec spec = {0};
+        spec.precision = -1;
+        checker_format_kind(type_get(part->expr->type), &kind);
+        if(SOME(part->spec))
+            format_parse_spec(part->spec->data, part->spec->len, &spec);
+        format_add_hole(format, kind, spec);
+        args[i] = ir_lower_expr(b, part->expr);
+    }
+    if(NONE(b->func->formats))
+        b->func->formats = VEC_NEW(Format*, 4);
+    vec_push(b->func->formats, &format);
+
+    IrValue value = ir_emit(b, IrOpFormat, node->type);
+    ir_alloc_operands(b->func, value, num_holes);
+    for(UInt32 i = 0; i < num_holes; i++)
+        ir_set_operand(b->func, value, i, args[i]);
+    ir_inst(b->func, value)->format = format;
+    free(args);
+    return value;
+}
+
+// Returns IR_NONE for expressions that don't have a value
+static IrValue ir_lower_expr(IrBuilder* b, AstNode* node) {
+    if(b->block == IR_NONE)
+        return IR_NONE;
+
+    IrValue value = IR_NONE;
+    switch(node->kind) {
+        case AstNodeKindIntLiteral: return ir_lower_int_literal(b, node);
+        case AstNodeKindFloatLiteral: return ir_lower_float_literal(b, node);
+        case AstNodeKindBoolLiteral: return ir_const(b, node->type, node->data.literal->bool_value->value);
+        // Only single-byte runes so far
+        case AstNodeKindCharLiteral:
+            return ir_const(b, node->type, cast(Byte)node->data.literal->char_value->value->data[0]);
+        case AstNodeKindStringLiteral:
+            if(node->data.literal->str_value->type == AstNodeStringLiteralFormat)
+                return ir_lower_format_string(b, node);
+            value = ir_emit(b, IrOpConstString, node->type);
+            ir_inst(b->func, value)->str = node->data.literal->str_value->value;
+            return value;
+        case AstNodeKindNilLiteral: return ir_emit(b, IrOpNull, node->type);
+
+        case AstNodeKindIdentifier: return ir_lower_identifier(b, node);
+        case AstNodeKindGroupedExpr: return ir_lower_expr(b, node->data.expr->grouped_expr->expr);
+        case AstNodeKindAttributeExpr:
+            // `[comptime]` is the only attribute an expression can have
+            value = ir_lower_expr(b, node->data.expr->attr_expr->expr);
+            ir_add_comptime(b, value, node->data.expr->attr_expr->expr);
+            return value;
+        case AstNodeKindPrefixOpExpr: return ir_lower_prefix_op(b, node);
+        case AstNodeKindBinaryOpExpr: return ir_lower_binary_op(b, node);
+        case AstNodeKindFuncCallExpr: return ir_lower_call(b, node);
+        case AstNodeKindArrayAccessExpr: return ir_lower_tensor_get(b, node);
+        case AstNodeKindSliceExpr: return ir_lower_slice(b, node);
+
+        default:
+            // `if`, `match`, `loop`, ... don't have a value
+            ir_lower_stmt(b, node);
+            return IR_NONE;
+    }
+}
+
+// Statements ------------------------------------------------------------------------------------------------------
+
+// Branch to `if_true` or `if_false` depending on `node`. `&&`, `||` and `!` are lowered to control flow, and constant
+// conditions to plain jumps.
+static void ir_lower_cond(IrBuilder* b, AstNode* node, UInt32 if_true, UInt32 if_false) {
+    if(b->block == IR_NONE)
+        return;
+
+    switch(node->kind) {
+        case AstNodeKindGroupedExpr:
+            ir_lower_cond(b, node->data.expr->grouped_expr->expr, if_true, if_false);
+            return;
+        case AstNodeKindBoolLiteral:
+            ir_jump(b, node->data.literal->bool_value->value ? if_true : if_false);
+            return;
+        case AstNodeKindPrefixOpExpr: {
+            AstNodePrefixOpExpr* prefix = node->data.prefix_op_expr;
+            if(prefix->op == PrefixOpKindBoolNot || prefix->op == PrefixOpKindNegation) {
+                ir_lower_cond(b, prefix->expr, if_false, if_true);
+                return;
+            }
+            break;
+        }
+        case AstNodeKindBinaryOpExpr: {
+            AstNodeBinaryOpExpr* binop = node->data.expr->binary_op_expr;
+            if(binop->op != BinaryOpKindBoolAnd && binop->op != BinaryOpKindBoolOr)
+                break;
+            UInt32 rhs_block = ir_new_block(b);
+            if(binop->op == BinaryOpKindBoolAnd)
+                ir_lower_cond(b, binop->lhs, rhs_block, if_false);
+            else
+                ir_lower_cond(b, binop->lhs, if_true, rhs_block);
+            ir_seal_block(b, rhs_block);
+            ir_start_block(b, rhs_block);
+            ir_lower_cond(b, binop->rhs, if_true, if_false);
+            return;
+        }
+        default:
+            break;
+    }
+
+    IrValue cond = ir_lower_converted(b, node, type_primitive(AdoradTypeBool)->id);
+    ir_branch(b, cond, if_true, if_false);
+}
+
+// Lower `node` in a scope of its own
+static void ir_lower_scoped(IrBuilder* b, AstNode* node) {
+    UInt64 prev_scope_begin = b->scope_begin;
+    b->scope_begin = vec_size(b->locals);
+    ir_lower_stmt(b, node);
+    ir_pop_scope(b, b->scope_begin);
+    b->scope_begin = prev_scope_begin;
+}
+
+static void ir_lower_if(IrBuilder* b, AstNode* node) {
+    AstNodeIfExpr* if_expr = node->data.expr->if_expr;
+    UInt32 then_block = ir_new_block(b);
+    UInt32 else_block = SOME(if_expr->else_node) ? ir_new_block(b) : IR_NONE;
+    UInt32 merge = ir_new_block(b);
+    ir_lower_cond(b, if_expr->condition, then_block, SOME(if_expr->else_node) ? else_block : merge);
+
+    ir_seal_block(b, then_block);
+    ir_start_block(b, then_block);
+    ir_lower_scoped(b, if_expr->if_body);
+    ir_jump(b, merge);
+
+    if(SOME(if_expr->else_node)) {
+        ir_seal_block(b, else_block);
+        ir_start_block(b, else_block);
+        ir_lower_scoped(b, if_expr->else_node);
+        ir_jump(b, merge);
+    }
+    ir_seal_block(b, merge);
+    ir_start_block(b, merge);
+}
+
+// `match` is a chain of comparisons against the subject, which is only evaluated once
+static void ir_lower_match(IrBuilder* b, AstNode* node) {
+    AstNodeMatchExpr* match = node->data.expr->match_expr;
+    TypeId bool_type = type_primitive(AdoradTypeBool)->id;
+    TypeId type = match->expr->type;
+    IrValue subject = ir_lower_expr(b, match->expr);
+    UInt64 num_branches = vec_size(match->branches);
+    UInt32 merge = ir_new_block(b);
+
+    for(UInt64 i = 0; i < num_branches; i++) {
+        AstNodeMatchBranchExpr* branch = (cast(AstNode*)vec_at(match->branches, i))->data.expr->match_branch_expr;
+        UInt32 body = ir_new_block(b);
+        UInt32 next = i + 1 < num_branches ? ir_new_block(b) : merge;
+
+        if(branch->is_range) {
+            // `begin..end` doesn't include `end`
+            AstNodeMatchRangeExpr* range = branch->cond_node->data.expr->match_range_expr;
+            UInt32 upper = ir_new_block(b);
+            IrValue begin = ir_lower_converted(b, range->begin, type);
+            ir_branch(b, ir_emit2(b, IrOpLe, bool_type, begin, subject), upper, next);
+            ir_seal_block(b, upper);
+            ir_start_block(b, upper);
+            IrValue end = ir_lower_converted(b, range->end, type);
+            ir_branch(b, ir_emit2(b, IrOpLt, bool_type, subject, end), body, next);
+        } else {
+            IrValue value = ir_lower_converted(b, branch->cond_node, type);
+            ir_branch(b, ir_emit2(b, IrOpEq, bool_type, subject, value), body, next);
+        }
+
+        ir_seal_block(b, body);
+        ir_start_block(b, body);
+        ir_lower_scoped(b, branch->block_node);
+        ir_jump(b, merge);
+        if(next != merge) {
+            ir_seal_block(b, next);
+            ir_start_block(b, next);
+        }
+    }
+    if(num_branches == 0)
+        ir_jump(b, merge);
+    ir_seal_block(b, merge);
+    ir_start_block(b, merge);
+}
+
+// Every loop is a header (which checks the condition), a body, an optional latch (the update of a C-style loop, or
+// the increment of a `loop ... in`) and an exit. `continue` goes to the latch, or the header if there isn't one.
+static void ir_lower_loop(IrBuilder* b, AstNode* node) {
+    AstNodeLoopExpr* loop = node->data.expr->loop_expr;
+    UInt64 prev_scope_begin = b->scope_begin;
+    UInt64 vars_begin = vec_size(b->locals);
+    b->scope_begin = vars_begin;
+
+    UInt32 header = ir_new_block(b);
+    UInt32 body = ir_new_block(b);
+    UInt32 latch = node->kind == AstNodeKindLoopInfExpr ? IR_NONE : ir_new_block(b);
+    UInt32 exit = ir_new_block(b);
+    AstNode* cond = null;
+    AstNode* updation = null;
+    Vec* statements = null;
+    TypeId type = TYPE_ID_NONE;
+    IrValue end = IR_NONE;
+    IrLocal* counter = null;
+
+    switch(node->kind) {
+        case AstNodeKindLoopInfExpr:
+            cond = loop->loop_inf_expr->cond;
+            statements = loop->loop_inf_expr->statements;
+            break;
+        case AstNodeKindLoopCExpr:
+            if(loop->loop_c_expr->has_init)
+                ir_lower_stmt(b, loop->loop_c_expr->init);
+            cond = loop->loop_c_expr->cond;
+            updation = loop->loop_c_expr->updation;
+            statements = loop->loop_c_expr->statements;
+            break;
+        default: {
+            // `loop i in begin..end`: `end` is only evaluated once, and isn't included
+            AstNodeLoopInExpr* loop_in = loop->loop_in_expr;
+            AstNodeMatchRangeExpr* range = loop_in->cond->data.expr->match_range_expr;
+            type = loop_in->cond->type;
+            IrValue begin = ir_lower_converted(b, range->begin, type);
+            end = ir_lower_converted(b, range->end, type);
+            ir_declare_local(b, loop_in->val_var, type, begin);
+            counter = cast(IrLocal*)vec_at(b->locals, vec_size(b->locals) - 1);
+            statements = loop_in->statements;
+            break;
+        }
+    }
+
+    ir_jump(b, header);
+    ir_start_block(b, header);
+    if(SOME(counter)) {
+        IrValue value = counter->slot != IR_NONE ? ir_emit1(b, IrOpLoad, type, counter->slot) :
+                                                   ir_read_var(b, counter->var, b->block);
+        ir_branch(b, ir_emit2(b, IrOpLt, type_primitive(AdoradTypeBool)->id, value, end), body, exit);
+    } else if(SOME(cond)) {
+        ir_lower_cond(b, cond, body, exit);
+    } else {
+        ir_jump(b, body);
+    }
+
+    ir_seal_block(b, body);
+    ir_start_block(b, body);
+    IrLoop entry = { .label = loop->label, .break_block = exit, .continue_block = latch != IR_NONE ? latch : header };
+    vec_push(b->loops, &entry);
+    UInt64 body_begin = vec_size(b->locals);
+    b->scope_begin = body_begin;
+    for(UInt64 i = 0; i < vec_size(statements); i++)
+        ir_lower_stmt(b, cast(AstNode*)vec_at(statements, i));
+    ir_pop_scope(b, body_begin);
+    vec_pop(b->loops);
+
+    if(latch != IR_NONE) {
+        ir_jump(b, latch);
+        ir_seal_block(b, latch);
+        ir_start_block(b, latch);
+        if(SOME(counter) && b->block != IR_NONE) {
+            counter = cast(IrLocal*)vec_at(b->locals, vars_begin);
+            IrValue one = ir_const(b, type, 1);
+            if(counter->slot != IR_NONE) {
+                IrValue value = ir_emit1(b, IrOpLoad, type, counter->slot);
+                ir_emit2(b, IrOpStore, TYPE_ID_NONE, counter->slot, ir_emit2(b, IrOpAdd, type, value, one));
+            } else {
+                IrValue value = ir_read_var(b, counter->var, b->block);
+                ir_write_var(b, counter->var, b->block, ir_emit2(b, IrOpAdd, type, value, one));
+            }
+        }
+        if(SOME(updation))
+            ir_lower_stmt(b, updation);
+    }
+    ir_jump(b, header);
+    ir_seal_block(b, header);
+    ir_seal_block(b, exit);
+    ir_start_block(b, exit);
+
+    ir_pop_scope(b, vars_begin);
+    b->scope_begin = prev_scope_begin;
+}
+
+// `break`/`continue`
+static void ir_lower_branch(IrBuilder* b, AstNode* node) {
+    Buff* name = node->data.stmt->branch_stmt->name;
+    for(UInt64 i = vec_size(b->loops); i > 0; i--) {
+        IrLoop* loop = cast(IrLoop*)vec_at(b->loops, i - 1);
+        if(NONE(name) || (SOME(loop->label) && buff_cmp(loop->label, name))) {
+            ir_jump(b, node->kind == AstNodeKindBreak ? loop->break_block : loop->continue_block);
+            return;
+        }
+    }
+    unreachable();
+}
+
+static void ir_lower_local_var(IrBuilder* b, AstNode* node) {
+    AstNodeVariable* var = node->data.scope_obj->var;
+    IrValue value = IR_NONE;
+    if(SOME(var->init_expr)) {
+        value = ir_lower_expr(b, var->init_expr);
+        if(var->is_comptime)
+            ir_add_comptime(b, value, var->init_expr);
+        value = ir_convert(b, value, node->type);
+    } else {
+        value = ir_emit(b, IrOpZero, node->type);
+    }
+    // Declared after its initializer, so `put x = x + 1` refers to an outer `x`
+    ir_declare_local(b, var->name, node->type, value);
+}
+
+static void ir_lower_stmt(IrBuilder* b, AstNode* node) {
+    // Nothing can jump here
+    if(b->block == IR_NONE)
+        return;
+
+    switch(node->kind) {
+        case AstNodeKindVariableDecl: ir_lower_local_var(b, node); break;
+        case AstNodeKindBlock: {
+            Vec* statements = node->data.stmt->block_stmt->statements;
+            UInt64 prev_scope_begin = b->scope_begin;
+            b->scope_begin = vec_size(b->locals);
+            for(UInt64 i = 0; i < vec_size(statements); i++)
+                ir_lower_stmt(b, cast(AstNode*)vec_at(statements, i));
+            ir_pop_scope(b, b->scope_begin);
+            b->scope_begin = prev_scope_begin;
+            break;
+        }
+        case AstNodeKindIfExpr: ir_lower_if(b, node); break;
+        case AstNodeKindMatchExpr: ir_lower_match(b, node); break;
+        case AstNodeKindLoopInfExpr:
+        case AstNodeKindLoopCExpr:
+        case AstNodeKindLoopInExpr: ir_lower_loop(b, node); break;
+        case AstNodeKindBreak:
+        case AstNodeKindContinue: ir_lower_branch(b, node); break;
+        case AstNodeKindUnreachable:
+            ir_emit(b, IrOpUnreachable, TYPE_ID_NONE);
+            b->block = IR_NONE;
+            break;
+        case AstNodeKindReturn: {
+            AstNode* expr = node->data.stmt->return_stmt->expr;
+            IrValue value = SOME(expr) ? ir_lower_converted(b, expr, b->ret_type) : IR_NONE;
+            if(value != IR_NONE)
+                ir_emit1(b, IrOpReturn, TYPE_ID_NONE, value);
+            else
+                ir_emit(b, IrOpReturn, TYPE_ID_NONE);
+            b->block = IR_NONE;
+            break;
+        }
+        default:
+            ir_lower_expr(b, node);
+            break;
+    }
+}
+
+// Functions -------------------------------------------------------------------------------------------------------
+
+// The first successor of a block is visited last, so it's laid out right after the block.
+void ir_order_blocks(IrFunc* func) {
+    UInt32 num_blocks = cast(UInt32)vec_size(func->blocks);
+    if(num_blocks == 0)
+        return;
+    UInt32* order = cast(UInt32*)malloc(num_blocks * sizeof(UInt32));
+    UInt32* new_index = cast(UInt32*)malloc(num_blocks * sizeof(UInt32));
+    UInt32* stack = cast(UInt32*)malloc(2 * num_blocks * sizeof(UInt32));    // (block, next successor) pairs
+    CORETEN_ENFORCE(SOME(order) && SOME(new_index) && SOME(stack), "Could not allocate memory. Memory full.");
+    for(UInt32 i = 0; i < num_blocks; i++)
+        new_index[i] = IR_NONE;
+
+    // Iterative DFS, so long chains of blocks can't overflow the stack
+    UInt32 num_ordered = 0;
+    UInt32 depth = 1;
+    new_index[0] = 0;
+    stack[0] = 0;
+    stack[1] = 0;
+    while(depth > 0) {
+        UInt32 block = stack[2 * (depth - 1)];
+        UInt32* next = &stack[2 * (depth - 1) + 1];
+        UInt32 succs[2];
+        UInt32 num_succs = ir_successors(func, block, succs);
+        if(*next < num_succs) {
+            UInt32 succ = succs[num_succs - 1 - *next];
+            (*next)++;
+            if(new_index[succ] == IR_NONE) {
+                new_index[succ] = 0;
+                stack[2 * depth] = succ;
+                stack[2 * depth + 1] = 0;
+                depth++;
+            }
+        } else {
+            order[num_ordered++] = block;
+            depth--;
+        }
+    }
+
+    // Edges from unreachable blocks go away (with their phi operands), and so does everything in them
+    for(UInt32 i = 0; i < num_blocks; i++) {
+        if(new_index[i] == IR_NONE)
+            continue;
+        Vec* preds = ir_block(func, i)->preds;
+        for(UInt64 j = vec_size(preds); j > 0; j--)
+            if(new_index[*cast(UInt32*)vec_at(preds, j - 1)] == IR_NONE)
+                ir_remove_pred(func, i, cast(UInt32)j - 1);
+    }
+    for(UInt32 i = 0; i < num_blocks; i++) {
+        if(new_index[i] != IR_NONE)
+            continue;
+        IrBlock* block = ir_block(func, i);
+        for(UInt64 j = 0; j < vec_size(block->phis); j++)
+            ir_kill(func, *cast(IrValue*)vec_at(block->phis, j));
+        for(UInt64 j = 0; j < vec_size(block->insts); j++)
+            ir_kill(func, *cast(IrValue*)vec_at(block->insts, j));
+        vec_free(block->phis);
+        vec_free(block->insts);
+        vec_free(block->preds);
+    }
+
+    // `order` is the postorder
+    for(UInt32 i = 0; i < num_ordered; i++)
+        new_index[order[num_ordered - 1 - i]] = i;
+    Vec* blocks = VEC_NEW(IrBlock, num_ordered);
+    for(UInt32 i = 0; i < num_ordered; i++)
+        vec_push(blocks, ir_block(func, order[num_ordered - 1 - i]));
+    vec_free(func->blocks);
+    func->blocks = blocks;
+
+    for(UInt32 i = 0; i < num_ordered; i++) {
+        IrBlock* block = ir_block(func, i);
+        for(UInt64 j = 0; j < vec_size(block->preds); j++) {
+            UInt32* pred = cast(UInt32*)vec_at(block->preds, j);
+            *pred = new_index[*pred];
+        }
+        for(UInt64 j = 0; j < vec_size(block->phis); j++)
+            ir_inst(func, *cast(IrValue*)vec_at(block->phis, j))->block = i;
+        for(UInt64 j = 0; j < vec_size(block->insts); j++) {
+            IrInst* inst = ir_inst(func, *cast(IrValue*)vec_at(block->insts, j));
+            inst->block = i;
+            if(inst->op == IrOpJump || inst->op == IrOpBranch)
+                inst->targets[0] = new_index[inst->targets[0]];
+            if(inst->op == IrOpBranch)
+                inst->targets[1] = new_index[inst->targets[1]];
+        }
+    }
+
+    free(order);
+    free(new_index);
+    free(stack);
+}
+
+static void ir_builder_init(IrBuilder* b, Checker* checker, IrFunc* func) {
+    b->checker = checker;
+    b->func = func;
+    b->block = IR_NONE;
+    b->states = VEC_NEW(IrBlockState, 8);
+    b->var_types = VEC_NEW(TypeId, 8);
+    ir_defs_init(&b->defs, 64);
+    b->locals = VEC_NEW(IrLocal, 8);
+    b->scope_begin = 0;
+    b->loops = VEC_NEW(IrLoop, 4);
+    b->addr_taken = null;
+    b->ret_type = TYPE_ID_NONE;
+}
+
+static void ir_builder_free(IrBuilder* b) {
+    for(UInt64 i = 0; i < vec_size(b->states); i++) {
+        IrBlockState* state = cast(IrBlockState*)vec_at(b->states, i);
+        if(SOME(state->incomplete_phis))
+            vec_free(state->incomplete_phis);
+    }
+    vec_free(b->states);
+    vec_free(b->var_types);
+    free(b->defs.slots);
+    vec_free(b->locals);
+    vec_free(b->loops);
+    if(SOME(b->addr_taken))
+        vec_free(b->addr_taken);
+}
+
+static void ir_lower_func(IrBuilder* b, Symbol* symbol) {
+    AstNodeFuncDecl* func = symbol->decl->data.decl->func_decl;
+    Type* type = symbol->type;
+    ir_find_addr_taken(b, func->body);
+    b->ret_type = type->ret->kind == AdoradTypeVoid ? TYPE_ID_NONE : type->ret->id;
+
+    UInt32 entry = ir_new_block(b);
+    ir_seal_block(b, entry);
+    ir_start_block(b, entry);
+    // Parameters live in the same scope as the function body's top-level statements
+    Vec* params = func->params->data.param_list->params;
+    for(UInt32 i = 0; i < vec_size(params); i++) {
+        AstNode* param = cast(AstNode*)vec_at(params, i);
+        IrValue value = ir_emit(b, IrOpParam, type->params[i]->id);
+        ir_inst(b->func, value)->imm = i;
+        ir_declare_local(b, param->data.param_decl->name, type->params[i]->id, value);
+    }
+
+    Vec* statements = func->body->data.stmt->block_stmt->statements;
+    for(UInt64 i = 0; i < vec_size(statements); i++)
+        ir_lower_stmt(b, cast(AstNode*)vec_at(statements, i));
+    // The checker made sure every path of a function with a return value returns
+    if(b->block != IR_NONE)
+        ir_emit(b, b->ret_type == TYPE_ID_NONE ? IrOpReturn : IrOpUnreachable, TYPE_ID_NONE);
+}
+
+// The initializer of a global variable is a function returning its value
+static void ir_lower_global_init(IrBuilder* b, Symbol* symbol) {
+    AstNode* init_expr = symbol->decl->data.scope_obj->var->init_expr;
+    ir_find_addr_taken(b, init_expr);
+    b->ret_type = symbol->type->id;
+
+    UInt32 entry = ir_new_block(b);
+    ir_seal_block(b, entry);
+    ir_start_block(b, entry);
+    ir_emit1(b, IrOpReturn, TYPE_ID_NONE, ir_lower_converted(b, init_expr, symbol->type->id));
+}
+
+// Runs on the thread pool, once for every unit
+static void ir_lower_task(void* arg, UInt64 index, UInt32 worker) {
+    IrModule* module = cast(IrModule*)arg;
+    CheckerUnit* unit = cast(CheckerUnit*)vec_at(module->checker->units, index);
+    IrFunc* func = *cast(IrFunc**)vec_at(module->funcs, index);
+    Symbol* symbol = unit->symbol;
+
+    bool has_body = symbol->kind == SymbolKindFunc ? !symbol->decl->data.decl->func_decl->no_body &&
+                                                         SOME(symbol->decl->data.decl->func_decl->body) :
+                                                     SOME(symbol->decl->data.scope_obj->var->init_expr);
+    if(!has_body)
+        return;
+
+    IrBuilder b;
+    ir_builder_init(&b, module->checker, func);
+    if(symbol->kind == SymbolKindFunc)
+        ir_lower_func(&b, symbol);
+    else
+        ir_lower_global_init(&b, symbol);
+    ir_order_blocks(func);
+    ir_builder_free(&b);
+}
+
+IrModule* ir_lower(Checker* checker) {
+    CORETEN_ENFORCE(vec_size(checker->diagnostics) == 0, "Can't lower a program with errors");
+    IrModule* module = cast(IrModule*)calloc(1, sizeof(IrModule));
+    CORETEN_ENFORCE_NN(module, "Could not allocate memory. Memory full.");
+    module->checker = checker;
+
+    UInt64 num_units = vec_size(checker->units);
+    module->funcs = VEC_NEW(IrFunc*, num_units + 1);
+    for(UInt64 i = 0; i < num_units; i++) {
+        IrFunc* func = cast(IrFunc*)calloc(1, sizeof(IrFunc));
+        CORETEN_ENFORCE_NN(func, "Could not allocate memory. Memory full.");
+        func->symbol = (cast(CheckerUnit*)vec_at(checker->units, i))->symbol;
+        func->insts = VEC_NEW(IrInst, 32);
+        func->operands = VEC_NEW(IrValue, 32);
+        func->uses = VEC_NEW(IrUse, 32);
+        func->blocks = VEC_NEW(IrBlock, 4);
+        vec_push(module->funcs, &func);
+    }
+
+    threadpool_parallel_for(checker->pool, num_units, ir_lower_task, module);
+    return module;
+}
+
+void ir_module_free(IrModule* module) {
+    if(NONE(module))
+        return;
+
+    for(UInt64 i = 0; i < vec_size(module->funcs); i++) {
+        IrFunc* func = *cast(IrFunc**)vec_at(module->funcs, i);
+        for(UInt64 j = 0; j < vec_size(func->blocks); j++) {
+            IrBlock* block = ir_block(func, cast(UInt32)j);
+            vec_free(block->phis);
+            vec_free(block->insts);
+            vec_free(block->preds);
+        }
+        vec_free(func->blocks);
+        vec_free(func->insts);
+        vec_free(func->operands);
+        vec_free(func->uses);
+        if(SOME(func->comptime))
+            vec_free(func->comptime);
+        for(UInt64 j = 0; SOME(func->formats) && j < vec_size(func->formats); j++)
+            format_free(*cast(Format**)vec_at(func->formats, j));
+        if(SOME(func->formats))
+            vec_free(func->formats);
+        free(func);
+    }
+    vec_free(module->funcs);
+    free(module);
+}
+
+// Verification ----------------------------------------------------------------------------------------------------
+
+static bool ir_has_pred(IrBlock* block, UInt32 pred) {
+    for(UInt64 i = 0; i < vec_size(block->preds); i++)
+        if(*cast(UInt32*)vec_at(block->preds, i) == pred)
+            return true;
+    return false;
+}
+
+static const char* ir_verify_operands(IrFunc* func, IrValue value) {
+    IrInst* inst = ir_inst(func, value);
+    for(UInt32 i = 0; i < inst->num_operands; i++) {
+        IrValue operand = ir_operand(func, value, i);
+        if(operand == IR_NONE || operand >= vec_size(func->insts))
+            return "An operand is missing";
+        IrInst* def = ir_inst(func, operand);
+        if(def->op == IrOpNop)
+            return "An operand is a removed instruction";
+        if(def->type == TYPE_ID_NONE)
+            return "An operand doesn't have a value";
+
+        // The use must be in the operand's use list
+        bool found = false;
+        for(UInt32 index = def->uses; index != IR_NONE && !found;) {
+            IrUse* use = cast(IrUse*)vec_at(func->uses, index);
+            found = use->user == value && use->operand == inst->operands + i;
+            index = use->next;
+        }
+        if(!found)
+            return "A use is missing from a use list";
+    }
+    return null;
+}
+
+const char* ir_verify(IrFunc* func) {
+    UInt32 num_blocks = cast(UInt32)vec_size(func->blocks);
+    for(UInt32 i = 0; i < num_blocks; i++) {
+        IrBlock* block = ir_block(func, i);
+        if(vec_size(block->insts) == 0)
+            return "A block doesn't end with a terminator";
+        if(i > 0 && vec_size(block->preds) == 0)
+            return "A block (other than the entry) has no predecessors";
+
+        for(UInt64 j = 0; j < vec_size(block->phis); j++) {
+            IrValue value = *cast(IrValue*)vec_at(block->phis, j);
+            IrInst* inst = ir_inst(func, value);
+            if(inst->op != IrOpPhi || inst->block != i)
+                return "The phis of a block must be phis in that block";
+            if(inst->num_operands != vec_size(block->preds))
+                return "A phi must have one operand for every predecessor";
+            const char* error = ir_verify_operands(func, value);
+            if(SOME(error))
+                return error;
+        }
+
+        for(UInt64 j = 0; j < vec_size(block->insts); j++) {
+            IrValue value = *cast(IrValue*)vec_at(block->insts, j);
+            IrInst* inst = ir_inst(func, value);
+            bool is_last = j + 1 == vec_size(block->insts);
+            if(inst->block != i)
+                return "An instruction is in the wrong block";
+            if(inst->op == IrOpNop || inst->op == IrOpPhi)
+                return "A block's instructions can't be phis or removed";
+            if(ir_is_terminator(inst->op) != is_last)
+                return "A block must end with its only terminator";
+            const char* error = ir_verify_operands(func, value);
+            if(SOME(error))
+                return error;
+
+            UInt32 num_targets = inst->op == IrOpJump ? 1 : inst->op == IrOpBranch ? 2 : 0;
+            for(UInt32 k = 0; k < num_targets; k++)
+                if(inst->targets[k] >= num_blocks || !ir_has_pred(ir_block(func, inst->targets[k]), i))
+                    return "A jump target doesn't list the block as a predecessor";
+        }
+    }
+
+    // Use counts
+    for(UInt64 i = 0; i < vec_size(func->insts); i++) {
+        IrInst* inst = cast(IrInst*)vec_at(func->insts, i);
+        UInt32 count = 0;
+        for(UInt32 index = inst->uses; index != IR_NONE; count++) {
+            IrUse* use = cast(IrUse*)vec_at(func->uses, index);
+            if(*cast(IrValue*)vec_at(func->operands, use->operand) != i)
+                return "A use list has a stale use";
+            index = use->next;
+        }
+        if(count != inst->num_uses)
+            return "A use count is wrong";
+    }
+    return null;
+}
+
+// Dumping ---------------------------------------------------------------------------------------------------------
+
+static void ir_dump_type(StrBuilder* out, TypeId type) {
+    char buf[128];
+    type_to_str(type_get(type), buf, sizeof(buf));
+    strbuilder_append_cstr(out, buf);
+}
+
+static void ir_dump_value(StrBuilder* out, UInt32* numbers, IrValue value) {
+    strbuilder_appendf(out, "%%%u", numbers[value]);
+}
+
+// The text of `format`, with `{}` (or `{:spec}`) for its holes
+static void ir_dump_format(StrBuilder* out, const Format* format) {
+    strbuilder_append_cstr(out, " \"");
+    UInt64 at = 0;
+    for(UInt32 i = 0; i <= format->num_holes; i++) {
+        UInt64 end = i < format->num_holes ? format->holes[i].text_end : format->text_len;
+        for(; at < end; at++) {
+            char ch = format->text[at];
+            strbuilder_append_char(out, ch);
+            if(ch == '{' || ch == '}')
+                strbuilder_append_char(out, ch);
+        }
+        if(i == format->num_holes)
+            break;
+
+        FormatSpec spec = format->holes[i].spec;
+        strbuilder_append_char(out, '{');
+        if(spec.left || spec.plus || spec.zero || spec.width > 0 || spec.precision >= 0 || spec.verb != 0) {
+            strbuilder_append_char(out, ':');
+            if(spec.left)
+                strbuilder_append_char(out, '-');
+            if(spec.plus)
+                strbuilder_append_char(out, '+');
+            if(spec.zero)
+                strbuilder_append_char(out, '0');
+            if(spec.width > 0)
+                strbuilder_appendf(out, "%u", cast(UInt32)spec.width);
+            if(spec.precision >= 0)
+                strbuilder_appendf(out, ".%d", cast(int)spec.precision);
+            if(spec.verb != 0)
+                strbuilder_append_char(out, spec.verb);
+        }
+        strbuilder_append_char(out, '}');
+    }
+    strbuilder_append_char(out, '"');
+    if(format->num_holes > 0)
+        strbuilder_append_char(out, ',');
+}
+
+static void ir_dump_inst(IrFunc* func, StrBuilder* out, UInt32* numbers, IrValue value) {
+    IrInst* inst = ir_inst(func, value);
+    strbuilder_append_cstr(out, "    ");
+    if(inst->type != TYPE_ID_NONE) {
+        ir_dump_value(out, numbers, value);
+        strbuilder_append_cstr(out, ": ");
+        ir_dump_type(out, inst->type);
+        strbuilder_append_cstr(out, " = ");
+    }
+    strbuilder_append_cstr(out, ir_op_name(cast(IrOp)inst->op));
+
+    switch(inst->op) {
+        case IrOpParam: strbuilder_appendf(out, " %" CORETEN_PRIu64, inst->imm); break;
+        case IrOpConst: {
+            Type* type = type_get(inst->type);
+            if(type->kind == AdoradTypeBool)
+                strbuilder_append_cstr(out, inst->imm ? " true" : " false");
+            else if(type_is_signed(type))
+                strbuilder_appendf(out, " %lld", cast(long long)inst->imm);
+            else
+                strbuilder_appendf(out, " %" CORETEN_PRIu64, inst->imm);
+            break;
+        }
+        case IrOpConstFloat: {
+            // As short as possible, as long as it reads back the same
+            char buf[32];
+            snprintf(buf, sizeof(buf), "%g", inst->fimm);
+            if(strtod(buf, null) != inst->fimm)
+                snprintf(buf, sizeof(buf), "%.17g", inst->fimm);
+            strbuilder_appendf(out, " %s", buf);
+            break;
+        }
+        case IrOpConstString: {
+            // The lexer spells the empty string `""`
+            Buff* str = inst->str;
+            bool is_empty = str->len == 2 && str->data[0] == '"' && str->data[1] == '"';
+            strbuilder_append_cstr(out, " \"");
+            if(!is_empty)
+                strbuilder_append_n(out, str->data, str->len);
+            strbuilder_append_char(out, '"');
+            break;
+        }
+        case IrOpFormat: ir_dump_format(out, inst->format); break;
+        case IrOpFunc:
+        case IrOpLoadGlobal:
+        case IrOpStoreGlobal:
+        case IrOpGlobalAddr:
+            strbuilder_append_cstr(out, " @");
+            strbuilder_append_n(out, inst->symbol->name->data, inst->symbol->name->len);
+            if(inst->op == IrOpStoreGlobal)
+                strbuilder_append_char(out, ',');
+            break;
+        case IrOpPhi:
+            for(UInt32 i = 0; i < inst->num_operands; i++) {
+                UInt32 pred = *cast(UInt32*)vec_at(ir_block(func, inst->block)->preds, i);
+                strbuilder_append_cstr(out, i == 0 ? " [" : ", [");
+                ir_dump_value(out, numbers, ir_operand(func, value, i));
+                strbuilder_appendf(out, ", b%u]", pred);
+            }
+            strbuilder_append_char(out, '\n');
+            return;
+        case IrOpCall:
+            strbuilder_append_char(out, ' ');
+            ir_dump_value(out, numbers, ir_operand(func, value, 0));
+            strbuilder_append_char(out, '(');
+            for(UInt32 i = 1; i < inst->num_operands; i++) {
+                if(i > 1)
+                    strbuilder_append_cstr(out, ", ");
+                ir_dump_value(out, numbers, ir_operand(func, value, i));
+            }
+            strbuilder_append_cstr(out, ")\n");
+            return;
+        default:
+            break;
+    }
+
+    for(UInt32 i = 0; i < inst->num_operands; i++) {
+        strbuilder_append_cstr(out, i == 0 ? " " : ", ");
+        ir_dump_value(out, numbers, ir_operand(func, value, i));
+    }
+    if(inst->op == IrOpTensorDim || inst->op == IrOpTensorSort || inst->op == IrOpTensorSortByKey)
+        strbuilder_appendf(out, ", %" CORETEN_PRIu64, inst->imm);
+    else if(inst->op == IrOpJump)
+        strbuilder_appendf(out, " b%u", inst->targets[0]);
+    else if(inst->op == IrOpBranch)
+        strbuilder_appendf(out, ", b%u, b%u", inst->targets[0], inst->targets[1]);
+    strbuilder_append_char(out, '\n');
+}
+
+void ir_dump_func(IrFunc* func, StrBuilder* out) {
+    Symbol* symbol = func->symbol;
+    Type* type = symbol->type;
+    if(symbol->kind == SymbolKindFunc) {
+        strbuilder_append_cstr(out, "func @");
+        strbuilder_append_n(out, symbol->name->data, symbol->name->len);
+        strbuilder_append_char(out, '(');
+        for(UInt32 i = 0; i < type->num_params; i++) {
+            if(i > 0)
+                strbuilder_append_cstr(out, ", ");
+            ir_dump_type(out, type->params[i]->id);
+        }
+        if(type->is_variadic)
+            strbuilder_append_cstr(out, type->num_params > 0 ? ", ..." : "...");
+        strbuilder_append_char(out, ')');
+        if(type->ret->kind != AdoradTypeVoid) {
+            strbuilder_append_cstr(out, " -> ");
+            ir_dump_type(out, type->ret->id);
+        }
+    } else {
+        strbuilder_append_cstr(out, "global @");
+        strbuilder_append_n(out, symbol->name->data, symbol->name->len);
+        strbuilder_append_cstr(out, ": ");
+        ir_dump_type(out, type->id);
+    }
+    if(vec_size(func->blocks) == 0) {
+        strbuilder_append_char(out, '\n');
+        return;
+    }
+
+    // Values are numbered in the order they appear in
+    UInt32* numbers = cast(UInt32*)malloc((vec_size(func->insts) + 1) * sizeof(UInt32));
+    CORETEN_ENFORCE_NN(numbers, "Could not allocate memory. Memory full.");
+    UInt32 count = 0;
+    for(UInt64 i = 0; i < vec_size(func->blocks); i++) {
+        IrBlock* block = ir_block(func, cast(UInt32)i);
+        for(UInt64 j = 0; j < vec_size(block->phis); j++)
+            numbers[*cast(IrValue*)vec_at(block->phis, j)] = count++;
+        for(UInt64 j = 0; j < vec_size(block->insts); j++) {
+            IrValue value = *cast(IrValue*)vec_at(block->insts, j);
+            if(ir_inst(func, value)->type != TYPE_ID_NONE)
+                numbers[value] = count++;
+        }
+    }
+
+    strbuilder_append_cstr(out, " {\n");
+    for(UInt64 i = 0; i < vec_size(func->blocks); i++) {
+        IrBlock* block = ir_block(func, cast(UInt32)i);
+        strbuilder_appendf(out, "b%" CORETEN_PRIu64 ":\n", i);
+        for(UInt64 j = 0; j < vec_size(block->phis); j++)
+            ir_dump_inst(func, out, numbers, *cast(IrValue*)vec_at(block->phis, j));
+        for(UInt64 j = 0; j < vec_size(block->insts); j++)
+            ir_dump_inst(func, out, numbers, *cast(IrValue*)vec_at(block->insts, j));
+    }
+    strbuilder_append_cstr(out, "}\n");
+    free(numbers);
+}
+
+void ir_dump(IrModule* module, StrBuilder* out) {
+    for(UInt64 i = 0; i < vec_size(module->funcs); i++) {
+        if(i > 0)
+            strbuilder_append_char(out, '\n');
+        ir_dump_func(*cast(IrFunc**)vec_at(module->funcs, i), out);
+    }
+}
@@ -0,0 +1,232 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#ifndef ADORAD_IR_H
+#define ADORAD_IR_H
+
+#include <adorad/core/types.h>
+#include <adorad/core/buffer.h>
+#include <adorad/core/vector.h>
+#include <adorad/core/strbuilder.h>
+#include <adorad/compiler/types.h>
+#include <adorad/compiler/checker.h>
+#include <adorad/runtime/format.h>
+
+/*
+    The Adorad IR.
+
+    A typed SSA representation that sits between the checked AST and the backends, so optimizations and code
+    generators work on flat arrays instead of walking the `AstNode` tree.
+
+    Every function keeps all of its instructions in one contiguous array (`IrFunc.insts`), and all of their operands
+    in another (`IrFunc.operands`). An instruction is identified by its index - a 32-bit `IrValue` - which is also
+    the value it defines. A basic block is a list of instruction indices: its phis, then its body, which always ends
+    with exactly one terminator (`jump`, `branch`, `return` or `unreachable`).
+    Every value keeps a list of its uses, which is kept up to date as operands are set and replaced.
+
+    Lowering:
+        - Locals become SSA values as they are lowered ("Simple and Efficient Construction of Static Single
+          Assignment Form", Braun et al.), so no separate pass over the IR is needed. Only locals whose address is
+          taken live in memory (`slot`/`load`/`store`).
+        - `&&`/`||` in conditions become branches.
+        - Implicit conversions (`Int` to `Int64`, `T` to `?T`, ...) are explicit `convert`s.
+        - Code that can never run (after a `return`, `break`, ...) isn't lowered.
+        - A chain of tensor methods (`xs.filter(it > 0).map(it * it).sum()`, see `CheckerTensorMethod`) is fused into
+          a single loop over `xs`: every element goes through all of the `filter()`s and `map()`s (with `it` an SSA
+          value) before the next one is read, and only the last method (if it's a `filter()` or `map()`) makes a
+          tensor.
+        - `xs.sort(cond)` computes the key of every element (the side of `cond` that uses `a`, see
+          `checker_sort_key()`) in a loop of its own, with `a` an SSA value, and sorts `xs` by those keys
+          (`tensor_sort_by_key`). `xs.sort()` and `xs.sort(a > b)` sort the elements themselves (`tensor_sort`).
+        - `a[i][j]` on a tensor of rank 2 is a single `tensor_get` (or `tensor_set`) of element `i * dim1 + j` (tensors
+          of any rank are one buffer in row-major order), after every subscript is checked against its dimension.
+        - `xs[lower..upper:step]` is a `tensor_slice`, which doesn't copy (the parts left out are 0, `len` and 1).
+        - `f"..."` is a single `format` of the values of its holes: the literal text (with its escape sequences
+          resolved) and the spec of every hole are known at compile time, so at run time the length of the result is
+          worked out first and every piece is written straight into it (see <adorad/runtime/format.h>), rather than
+          concatenating one piece at a time.
+    Every function (and every global initializer) is lowered on its own, in parallel on the checker's thread pool.
+*/
+
+typedef UInt32 IrValue;
+
+#define IR_NONE     UINT32_MAX
+
+typedef enum IrOp {
+    IrOpNop,            // a removed instruction. `forward` is what it was replaced with (or IR_NONE)
+
+    // Values
+    IrOpParam,          // `imm`: index of the parameter
+    IrOpConst,          // an integer, `Bool` or `Rune`: `imm`
+    IrOpConstFloat,     // `fimm`
+    IrOpConstString,    // `str`: the literal, as it was spelled (escape sequences and all)
+    IrOpNull,           // `null`
+    IrOpZero,           // the zero value of the instruction's type (for variables without an initializer)
+    IrOpFunc,           // the function `symbol`
+    IrOpLoadGlobal,     // the value of the global variable `symbol`
+    IrOpStoreGlobal,    // (value): set the global variable `symbol`
+    IrOpGlobalAddr,     // the address of the global variable `symbol`
+    IrOpSlot,           // the address of a stack slot for a local whose address is taken
+    IrOpLoad,           // (address)
+    IrOpStore,          // (address, value)
+
+    // Tensors (see <adorad/runtime/tensor.h>)
+    IrOpTensorNew,      // (capacity: Int64): an empty tensor of the instruction's type
+    IrOpTensorLen,      // (tensor): its length, as an `Int64`
+    IrOpTensorGet,      // (tensor, index: Int64): an element
+    IrOpTensorPush,     // (tensor, value): append `value`
+    IrOpTensorDim,      // (tensor): the length of dimension `imm`, as an `Int64`
+    IrOpTensorSet,      // (tensor, index: Int64, value): set an element
+    IrOpTensorSlice,    // (tensor, lower: Int64, upper: Int64, step: Int64): a view of its elements (a run-time error
+                        // unless `0 <= lower <= upper <= len` and `step > 0`)
+    IrOpTensorClone,    // (tensor): a copy that owns its elements
+    IrOpTensorSort,     // (tensor): sort its elements in place (in descending order if `imm` is 1)
+    IrOpTensorSortByKey,  // (tensor, keys: a tensor as long): sort its elements in place by `keys`, like `IrOpTensorSort`
+    IrOpBoundsCheck,    // (index: Int64, length: Int64): a run-time error unless `0 <= index < length`
+
+    // Arithmetic. Both operands have the instruction's type.
+    IrOpAdd,
+    IrOpSub,
+    IrOpMul,
+    IrOpDiv,
+    IrOpMod,
+    IrOpAnd,
+    IrOpOr,
+    IrOpXor,
+    IrOpShl,
+    IrOpShr,
+    IrOpNeg,            // (value)
+    IrOpNot,            // (Bool)
+    IrOpConcat,         // (String, String)
+    IrOpFormat,         // (values...): the `String` `format` makes of them (one value per hole)
+
+    // Comparisons. Both operands have the same type, and the result is a `Bool`.
+    IrOpEq,
+    IrOpNe,
+    IrOpLt,
+    IrOpLe,
+    IrOpGt,
+    IrOpGe,
+    IrOpIsNull,         // (optional)
+
+    IrOpConvert,        // (value): converted to the instruction's type
+    IrOpCall,           // (callee, arguments...)
+    IrOpPhi,            // one operand for every predecessor of the block, in the same order as `IrBlock.preds`
+
+    // Terminators
+    IrOpJump,           // to `targets[0]`
+    IrOpBranch,         // (Bool): to `targets[0]` if true, `targets[1]` otherwise
+    IrOpReturn,         // (value) or nothing
+    IrOpUnreachable,
+
+    IrOpCount
+} IrOp;
+
+typedef struct IrInst {
+    UInt8 op;           // `IrOp`
+    TypeId type;        // of the value (TYPE_ID_NONE if the instruction doesn't have one)
+    UInt32 block;       // index of the block the instruction is in
+    UInt32 operands;    // index of the first operand in `IrFunc.operands`
+    UInt32 num_operands;
+    UInt32 uses;        // the first use (index in `IrFunc.uses`), or IR_NONE
+    UInt32 num_uses;
+    union {
+        UInt64 imm;
+        double fimm;
+        Buff* str;
+        Symbol* symbol;
+        const Format* format;
+        UInt32 targets[2];
+        IrValue forward;
+    };
+} IrInst;
+
+// `operand` of `user` is the value whose use list this is in
+typedef struct IrUse {
+    IrValue user;
+    UInt32 operand;     // index in `IrFunc.operands`
+    UInt32 next;        // the next use of the same value, or IR_NONE
+} IrUse;
+
+typedef struct IrBlock {
+    Vec* phis;          // `IrValue`s
+    Vec* insts;         // `IrValue`s. The last one is the terminator
+    Vec* preds;         // indices (`UInt32`) of the predecessors, in the order phi operands are in
+} IrBlock;
+
+// A value that has to be known at compile time: a call to a `[comptime]` function, a `[comptime]` expression, or the
+// initializer of a `[comptime]` local (see `comptime_module()`)
+typedef struct IrComptime {
+    IrValue value;
+    AstNode* node;      // the expression it's the value of
+} IrComptime;
+
+typedef struct IrFunc {
+    Symbol* symbol;     // the function, or the global variable this is the initializer of
+    Vec* insts;         // `IrInst`s
+    Vec* operands;      // `IrValue`s
+    Vec* uses;          // `IrUse`s
+    Vec* blocks;        // `IrBlock`s. The first one is the entry
+    Vec* comptime;      // `IrComptime`s, in the order they were lowered. null if there are none
+    Vec* formats;       // `Format*`s of the `format`s lowered in this function (inlined copies share them). null if
+                        // there are none
+} IrFunc;
+
+typedef struct IrModule {
+    Checker* checker;
+    Vec* funcs;         // `IrFunc*`s, one for every `CheckerUnit` (in declaration order). Functions without a body
+                        // and globals without an initializer have no blocks.
+} IrModule;
+
+// Lower everything `checker` checked (which must have succeeded)
+IrModule* ir_lower(Checker* checker);
+void ir_module_free(IrModule* module);
+
+IrInst* ir_inst(IrFunc* func, IrValue value);
+IrValue ir_operand(IrFunc* func, IrValue value, UInt32 index);
+IrBlock* ir_block(IrFunc* func, UInt32 index);
+bool ir_is_terminator(IrOp op);
+// The blocks `block` can jump to (at most 2). Returns how many there are.
+UInt32 ir_successors(IrFunc* func, UInt32 block, UInt32* succs);
+
+// Editing. None of these keep `IrInst*`/`IrBlock*` pointers valid, since the arrays they point into can grow.
+//
+// A new instruction (with no operands) in `block`. It isn't added to the block's list: that's up to the caller.
+IrValue ir_new_inst(IrFunc* func, UInt32 block, IrOp op, TypeId type);
+// Give `value` `num` operands (all IR_NONE, until they're set)
+void ir_alloc_operands(IrFunc* func, IrValue value, UInt32 num);
+// Set operand `index` of `user` to `value` (which can be IR_NONE), keeping the use lists up to date
+void ir_set_operand(IrFunc* func, IrValue user, UInt32 index, IrValue value);
+// Make every use of `value` a use of `replacement` instead
+void ir_replace_uses(IrFunc* func, IrValue value, IrValue replacement);
+// Drop the operands of `value` and turn it into a `nop`. It must be removed from its block by the caller.
+void ir_kill(IrFunc* func, IrValue value);
+// A new empty block, at the end
+UInt32 ir_add_block(IrFunc* func);
+// Remove predecessor `index` of `block`, and the matching operand of each of its phis
+void ir_remove_pred(IrFunc* func, UInt32 block, UInt32 index);
+// Put the blocks in reverse postorder, dropping the ones that can't be reached from the entry (and their edges)
+void ir_order_blocks(IrFunc* func);
+
+// Check the invariants above. Returns null if `func` is well-formed, and what's wrong otherwise.
+const char* ir_verify(IrFunc* func);
+// Append the textual form of `func`/`module` to `out`. Values and blocks are numbered in the order they appear in.
+void ir_dump_func(IrFunc* func, StrBuilder* out);
+void ir_dump(IrModule* module, StrBuilder* out);
+const char* ir_op_name(IrOp op);
+// Write the value of string literal `spelled` (an `IrOpConstString`) to `out`, with its escape sequences resolved (the
+// same way the C backend has the C compiler resolve them), followed by a nul. `out` needs `spelled->len + 1` bytes.
+// Returns the length of the value.
+UInt64 ir_unescape(Buff* spelled, char* out);
+
+#endif // ADORAD_IR_H
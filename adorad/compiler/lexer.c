@@ -115,6 +115,25 @@ void __lexer_error(Lexer* lexer, Error err, const char* fmt, ...) {
     exit(1);
 }
 
+// Report the first invalid UTF-8 sequence in the buffer and exit
+ATTRIBUTE_COLD
+static void lexer_invalid_utf8(Lexer* lexer) {
+    UInt64 offset = utf8_invalid_offset(lexer->buffer->data, lexer->buff_cap);
+    UInt32 line = 1;
+    UInt32 col = 1;
+    for(UInt64 i = 0; i < offset; i++) {
+        if(lexer->buffer->data[i] == '\n') {
+            ++line;
+            col = 1;
+        } else if((cast(Byte)lexer->buffer->data[i] & 0xc0) != 0x80) {
+            ++col;
+        }
+    }
+    lexer->loc->line = line;
+    lexer->loc->col = col;
+    lexer_error(ErrorInvalidCharacter, "Invalid UTF-8 byte `0x%02x`", cast(Byte)lexer->buffer->data[offset]);
+}
+
 #define ADVANCE()           lexer_advance(lexer)
 #define ADVANCEN(n)         lexer_advancen(lexer, (n))
 
@@ -327,6 +346,12 @@ static inline void lex_string(Lexer* lexer) {
     lexer->is_inside_str = true;
 
     while(ch != '"') {
+        if(ch == nullchar)
+            lexer_error(ErrorSyntaxError, "Unterminated string literal");
+        // UTF-8 continuation bytes don't start a new character (the buffer has already been validated)
+        if((cast(Byte)ch & 0xc0) == 0x80)
+            LEXER_DECREMENT_COLNO;
+
         if(ch == '\\') {
             // lexer_lex_esc_char(lexer);
             ch = ADVANCE();
@@ -346,6 +371,78 @@ static inline void lex_string(Lexer* lexer) {
     maketoken(lexer, STRING, str_value, prev_offset - 1, line, col - 1);
 }
 
+// Scan a format string (`f"..."`), starting from its `f`. Its value is everything between the quotes: the Parser splits
+// it into the literal text and the holes (`{expr}`, `{expr:spec}` or `${expr}`). A hole can contain strings of its
+// own, and `{{` and `}}` are literal braces.
+static inline void lex_format_string(Lexer* lexer) {
+    LEXER_LOG("Inside lex_format_string()");
+
+    UInt32 line = lexer->loc->line;
+    UInt32 col = lexer->loc->col;
+    UInt32 offset = lexer->offset - 1;
+    // Skip over the opening quote
+    CORETEN_ENFORCE(ADVANCE() == '"');
+    UInt32 prev_offset = lexer->offset;
+    UInt32 depth = 0;
+    lexer->is_inside_str = true;
+
+    char ch = ADVANCE();
+    while(ch != '"' || depth > 0) {
+        if(ch == nullchar)
+            lexer_error(ErrorSyntaxError, "Unterminated format string literal");
+        if((cast(Byte)ch & 0xc0) == 0x80)
+            LEXER_DECREMENT_COLNO;
+
+        if(ch == '\\') {
+            ADVANCE();
+        } else if(ch == '{') {
+            if(depth == 0 && LEXER_CURR_CHAR == '{')
+                ADVANCE();
+            else
+                ++depth;
+        } else if(ch == '}') {
+            if(depth > 0)
+                --depth;
+            else if(LEXER_CURR_CHAR == '}')
+                ADVANCE();
+            else
+                lexer_error(ErrorSyntaxError, "Single `}` in a format string literal. Did you mean `}}`?");
+        } else if(ch == '"') {
+            // A string inside a hole
+            ch = ADVANCE();
+            while(ch != '"') {
+                if(ch == nullchar)
+                    lexer_error(ErrorSyntaxError, "Unterminated string literal");
+                if(ch == '\\')
+                    ADVANCE();
+                ch = ADVANCE();
+            }
+        }
+        ch = ADVANCE();
+    }
+    lexer->is_inside_str = false;
+
+    // `lexer->offset - 1` so as to ignore the closing quote `"`
+    UInt32 str_length = lexer->offset - 1 - prev_offset;
+    Buff* str_value = str_length > 0 ? buff_slice(lexer->buffer, prev_offset, str_length) : BUFF_NEW("");
+    CORETEN_ENFORCE_NN(str_value, "`str_value` must not be null");
+    maketoken(lexer, FORMAT_STRING, str_value, offset, line, col - 1);
+}
+
+// Called right after the lead byte of a multi-byte character has been consumed.
+// If that character is XID_Continue, skip over the rest of its bytes and return true.
+// The buffer has already been validated (see `lexer_lex()`), so the character is decoded without any checks.
+static inline bool lexer_accept_unicode_identifier_char(Lexer* lexer) {
+    UInt32 nbytes;
+    Rune rune = utf8_decode(lexer->buffer->data + lexer->offset - 1, &nbytes);
+    if(!utf8_is_xid_continue(rune))
+        return false;
+
+    // The column moves once per character, not once per byte
+    lexer->offset += nbytes - 1;
+    return true;
+}
+
 // Returns whether `value` is a keyword or an identifier
 static inline TokenKind is_keyword_or_identifier(char* value) {
     // Search `tokenHash` for a match for `value`. 
@@ -365,7 +462,7 @@ static inline void lex_identifier(Lexer* lexer) {
     // When this function is called, we alread know that the first character statisfies the `case ALPHA`.
     // So, the remaining characters are ALPHA, DIGIT, or `_`
     // Still, we check it either way to ensure sanity.
-    CORETEN_ENFORCE(char_is_letter(prev(lexer)) || char_is_digit(prev(lexer)),
+    CORETEN_ENFORCE(char_is_letter(prev(lexer)) || char_is_digit(prev(lexer)) || cast(Byte)prev(lexer) >= 0x80,
                "This message means you've encountered a serious bug within Adorad. Please file an issue on "
                "Adorad's Github repo.\nError: `lex_identifier()` hasn't been called with a valid identifier character");
 
@@ -373,9 +470,15 @@ static inline void lex_identifier(Lexer* lexer) {
     UInt32 line = lexer->loc->line;
     UInt32 col = lexer->loc->col;
     int ident_length = 0;
+
+    // A non-ASCII first character has only had its lead byte consumed (`lexer_lex()` has already checked it)
+    if(cast(Byte)prev(lexer) >= 0x80)
+        lexer_accept_unicode_identifier_char(lexer);
     char ch = ADVANCE();
 
-    while(char_is_letter(ch) || char_is_digit(ch)) {
+    // ASCII first - only non-ASCII lead bytes need to be decoded
+    while(char_is_letter(ch) || char_is_digit(ch) ||
+          (cast(Byte)ch >= 0x80 && lexer_accept_unicode_identifier_char(lexer))) {
         ch = ADVANCE();
         ++ident_length;
     }
@@ -383,7 +486,9 @@ static inline void lex_identifier(Lexer* lexer) {
     if(ident_length > MAX_TOKEN_LENGTH)
         WARN("An identifier can never have more than 256 characters");
 
-    UInt32 offset_diff = lexer->offset - prev_offset;
+    // At the end of the buffer, `ADVANCE()` doesn't consume anything, so there's nothing to step back over
+    bool at_eof = ch == nullchar && lexer->offset >= lexer->buff_cap;
+    UInt32 offset_diff = lexer->offset - prev_offset + (at_eof ? 1 : 0);
     Buff* ident_value = buff_slice(lexer->buffer, prev_offset - 1, offset_diff);
     CORETEN_ENFORCE_NN(ident_value, "`ident_value` must not be null");
 
@@ -391,55 +496,51 @@ static inline void lex_identifier(Lexer* lexer) {
     TokenKind tokenkind = is_keyword_or_identifier(ident_value->data);
     maketoken(lexer, tokenkind, ident_value, prev_offset - 1, line, col - 1);
 
-    LEXER_DECREMENT_OFFSET;
+    if(!at_eof)
+        LEXER_DECREMENT_OFFSET;
 }
 
 // Attributes
 // Eg. [inline] or [comptime]
+// We enter here right after a `[` that is followed by a letter. If what follows isn't an attribute, the `[` is an
+// ordinary LSQUAREBRACK (like in `a[i]`), and nothing else is consumed.
 static inline void lex_attribute(Lexer* lexer) {
     LEXER_LOG("Inside lex_attribute()");
 
     UInt32 prev_offset = lexer->offset;
     UInt32 line = lexer->loc->line;
     UInt32 col = lexer->loc->col;
-    int attr_length = 0;
 
-    // Skip whitespace
-    while(LEXER_CURR_CHAR == ' ')
-        ADVANCE();
-    
-    char ch;
-    switch(LEXER_CURR_CHAR) {
-        // Possible attribute text
-        case ALPHA:
-            ch = ADVANCE();
-            while(char_is_letter(ch) || char_is_digit(ch)) {
-                ch = ADVANCE();
-                ++attr_length;
+    UInt32 attr_length = 0;
+    while(char_is_letter(peekn(lexer, attr_length)) || char_is_digit(peekn(lexer, attr_length)))
+        ++attr_length;
+
+    // Determine what kind of attribute this is (if any):
+    TokenKind kind = TOK_NULL;
+    if(peekn(lexer, attr_length) == ']') {
+        // Includes the `[` and the `]`
+        UInt32 len = attr_length + 2;
+        const char* attr_start = lexer->buffer->data + prev_offset - 1;
+        for(TokenKind i = TOK___ATTRIBUTES_BEGIN + 1; i < TOK___ATTRIBUTES_END; i++) {
+            if(strlen(tokenHash[i]) == len && strncmp(attr_start, tokenHash[i], len) == 0) {
+                kind = i;
+                break;
             }
+        }
+    }
 
-            UInt32 offset_diff = lexer->offset - prev_offset;
-            Buff* attr_value = buff_slice(lexer->buffer, prev_offset - 1, offset_diff);
-            CORETEN_ENFORCE_NN(attr_value, "`attr_value` must not be null");
-
-            // Determine what kind of attribute this is:
-            TokenKind kind = TOK_NULL;
-            for(TokenKind i = TOK___ATTRIBUTES_BEGIN; i < TOK___ATTRIBUTES_END; i++) {
-                if(strcmp(attr_value->data, tokenHash[i]) == 0) {
-                    kind = i;
-                    break;
-                }
-            }
+    if(kind == TOK_NULL) {
+        maketoken(lexer, LSQUAREBRACK, BUFF_NEW(null), prev_offset - 1, line, col - 1);
+        return;
+    }
 
-            CORETEN_ENFORCE(kind != TOK_NULL, "Compiler error. Expected `kind` to be an attribute");
-            
-            maketoken(lexer, kind, attr_value, prev_offset - 1, line, col - 1);
+    // Skip the attribute name and the `]`
+    for(UInt32 i = 0; i <= attr_length; i++)
+        ADVANCE();
 
-            LEXER_DECREMENT_OFFSET;
-            break;
-        default:
-            lexer_error(ErrorSyntaxError, "Expected an attribute"); break;
-    }
+    Buff* attr_value = buff_slice(lexer->buffer, prev_offset - 1, attr_length + 2);
+    CORETEN_ENFORCE_NN(attr_value, "`attr_value` must not be null");
+    maketoken(lexer, kind, attr_value, prev_offset - 1, line, col - 1);
 }
 
 // Numeric lexing! Finally, the feast can start.
@@ -448,140 +549,119 @@ static inline void lex_digit(Lexer* lexer) {
     // 0x... --> Hexadecimal ("0x"|"0X")[0-9A-Fa-f_]+
     // 0o... --> Octal       ("0o"|"0O")[0-7_]+
     // 0b... --> Binary      ("0b"|"0B")[01_]+
+    // [0-9_]+ (. [0-9_]+)? ([eE] [+-]? [0-9]+)? --> Integer or Float
     // This cannot be `lexer_advance(lexer)` because we enter here from `lexer_lex()` where we already
-    // know that the first char is a digit value. 
+    // know that the first char is a digit value (or the `.` of a fraction like `.25`).
     // This value needs to be captured as well in `token->value`
     char ch = prev(lexer);
     UInt32 prev_offset = lexer->offset - 1;
     UInt32 line = lexer->loc->line;
     UInt32 col = lexer->loc->col - 1;
-    TokenKind tokenkind = TOK_ILLEGAL;
-    int digit_length = 0; // no. of digits in the number
+    TokenKind tokenkind = INTEGER;
+    int digit_length = 1; // no. of characters in the number
 
-    CORETEN_ENFORCE(char_is_digit(ch));
-    while(char_is_digit(ch)) {
-        // Hex, Octal, or Binary?
-        if(ch == '0') {
-            ch = ADVANCE();
-            switch(ch) {
-                // Hex
-                case 'x': case 'X':;
-                    // Skip [xX]
-                    ch = ADVANCE();
-                    int hexcount = 0;
-                    while(char_is_hex_digit(ch)) {
-                        ++hexcount; 
-                        ch = ADVANCE();
-                    }
-                    if(hexcount == 0)
-                        lexer_error(ErrorSyntaxError, "Expected hexadecimal digits [0-9A-Fa-f] after `0x`");
-                    
-                    tokenkind = HEX_INT;
-                    digit_length = hexcount + 1; // Account for the '0'
-                    break;
-                // Binary
-                case 'b': case 'B':
-                    // Skip [bB]
-                    ch = ADVANCE();
-                    int bincount = 0;
-                    while(char_is_binary_digit(ch)) {
-                        ++bincount; 
-                        ch = ADVANCE();
-                    }
-                    if(bincount == 0)
-                        lexer_error(ErrorSyntaxError, "Expected binary digit [0-1] after `0b`");
-                    
-                    tokenkind = BIN_INT;
-                    digit_length = bincount + 1; // Account for the '0'
-                    break;
-                // Octal
-                // Depart from the (error-prone) C-style octals with an inital zero e.g 0123
-                // Instead, we support the `0o` or `0O` prefix, like 0o123
-                case 'o': case 'O':
-                    // Skip [oO]
-                    ch = ADVANCE();
-                    int octcount = 0;
-                    while(char_is_octal_digit(ch)) {
-                        ++octcount; 
-                        ch = ADVANCE();
-                    }
-                    if(octcount == 0)
-                        lexer_error(ErrorSyntaxError, "Expected octal digits [0-7] after `0o`");
-                    
-                    tokenkind = OCT_INT;
-                    digit_length = octcount + 1; // Account for the '0'
-                    break;
-                case ALPHA_EXCEPT_B_O_X:
-                    // Error
-                    lexer_error(ErrorSyntaxError, "Invalid character `%c`. Adorad currently supports [xXbBoO] after `0`", ch);
-                    break;
-                default:
-                    // An integer?
-                    // lexer_error(ErrorSyntaxError, "Cannot have an integer beginning with `0`");     
-                    break;               
-            } // switch(ch)
-        }
-        // Fractions, or Integer?
-        else {
-            // Normal Floats
-            if(ch == '.' || ch == '_') {
-                ch = ADVANCE();
-                if(ch == '_')
-                    lexer_error(ErrorSyntaxError, "Unexpected `_` near `.`");
-            }
-            
-            // Exponents (Float)
-            else if(ch == 'e' || ch == 'E') {
-                // Skip over [eE]
-                ch = ADVANCE();
-                if(ch == '+' || ch == '-') { 
-                    ch = ADVANCE();
-                } else {
-                    lexer_error(ErrorSyntaxError, "Expected [+-] after exponent `e`. Got `%c`", ch);
+    CORETEN_ENFORCE(char_is_digit(ch) || ch == '.');
+    char next = peek(lexer);
+    if(ch == '0' && (next == 'x' || next == 'X' || next == 'b' || next == 'B' || next == 'o' || next == 'O')) {
+        // Skip [xXbBoO]
+        ADVANCE();
+        int count = 0;
+        switch(next) {
+            // Hex
+            case 'x': case 'X':
+                while(char_is_hex_digit(peek(lexer)) || peek(lexer) == '_') {
+                    ++count;
+                    ADVANCE();
                 }
-                
-                int exp_digits = 0;
-                while(char_is_digit(ch)) {
-                    ch = ADVANCE();
-                    ++exp_digits;
+                if(count == 0)
+                    lexer_error(ErrorSyntaxError, "Expected hexadecimal digits [0-9A-Fa-f] after `0x`");
+                tokenkind = HEX_INT;
+                break;
+            // Binary
+            case 'b': case 'B':
+                while(char_is_binary_digit(peek(lexer)) || peek(lexer) == '_') {
+                    ++count;
+                    ADVANCE();
                 }
-                if(exp_digits == 0)
-                    lexer_error(ErrorSyntaxError, "Invalid character after exponent `e`. Expected a digit, got `%c`", ch);
-                
-                // (TODO) Verify this is correct
-                digit_length = exp_digits + 1; // Account for the prev digit
+                if(count == 0)
+                    lexer_error(ErrorSyntaxError, "Expected binary digit [0-1] after `0b`");
+                tokenkind = BIN_INT;
+                break;
+            // Octal
+            // Depart from the (error-prone) C-style octals with an inital zero e.g 0123
+            // Instead, we support the `0o` or `0O` prefix, like 0o123
+            default:
+                while(char_is_octal_digit(peek(lexer)) || peek(lexer) == '_') {
+                    ++count;
+                    ADVANCE();
+                }
+                if(count == 0)
+                    lexer_error(ErrorSyntaxError, "Expected octal digits [0-7] after `0o`");
+                tokenkind = OCT_INT;
+                break;
+        } // switch(next)
+        digit_length += count + 1;
+    } else {
+        bool is_float = ch == '.';
+        while(char_is_digit(peek(lexer)) || peek(lexer) == '_') {
+            ADVANCE();
+            ++digit_length;
+        }
+
+        // Fractions. A `..` is a range (`0..10`), and `1.foo` is a field access
+        if(!is_float && peek(lexer) == '.' && char_is_digit(peekn(lexer, 1))) {
+            is_float = true;
+            ADVANCE();
+            ++digit_length;
+            while(char_is_digit(peek(lexer)) || peek(lexer) == '_') {
+                ADVANCE();
+                ++digit_length;
             }
-            // Imaginary
-            else if(ch == 'j' || ch == 'J') {
-                // digit_length = imag_count;
+        }
+
+        // Exponents (Float)
+        if(peek(lexer) == 'e' || peek(lexer) == 'E') {
+            is_float = true;
+            // Skip over [eE]
+            ADVANCE();
+            ++digit_length;
+            if(peek(lexer) == '+' || peek(lexer) == '-') {
+                ADVANCE();
+                ++digit_length;
+            }
+
+            int exp_digits = 0;
+            while(char_is_digit(peek(lexer))) {
+                ADVANCE();
+                ++exp_digits;
             }
+            if(exp_digits == 0)
+                lexer_error(ErrorSyntaxError, "Invalid character after exponent `e`. Expected a digit, got `%c`", 
+                            peek(lexer));
+            digit_length += exp_digits;
         }
-        // ch = ADVANCE();
-    }
 
-    // CORETEN_ENFORCE(tokenkind != TOK_ILLEGAL);
+        tokenkind = is_float ? FLOAT_LIT : INTEGER;
+    }
 
-    int offset_diff = cast(int)(lexer->offset - prev_offset);
-    CORETEN_ENFORCE(offset_diff != 0);
+    if(char_is_letter(peek(lexer)))
+        lexer_error(ErrorSyntaxError, "Invalid character `%c` in a number", peek(lexer));
 
     if(digit_length > MAX_TOKEN_LENGTH)
         WARN("A number can never have more than 256 characters");
 
-    // digit_length can be 0 and we can still have a number. Reasoning is as follows:
-    // This function is guaranteed to be called when there's at least one "number-like". We simply check if
-    // there are more digits to lex.
-    // If digit_length = 0, this means that there's only one digit in the number (eg. 0, 2, 9)
-    Buff* digit_value = buff_slice(lexer->buffer, prev_offset, offset_diff - 1);
+    Buff* digit_value = buff_slice(lexer->buffer, prev_offset, cast(int)(lexer->offset - prev_offset));
     CORETEN_ENFORCE_NN(digit_value, "`digit_value` must not be null");
-    if(!digit_value)
-        printf("digit_value = null\n");
     maketoken(lexer, tokenkind, digit_value, prev_offset, line, col);
-
-    LEXER_DECREMENT_OFFSET;
 }
 
 // Lex the Source files
 void lexer_lex(Lexer* lexer) {
+    // Validate the entire buffer as UTF-8 up front. This way, the rest of the Lexer never has to check the
+    // multi-byte characters it decodes.
+    if(CORETEN_UNLIKELY(!utf8_validate(lexer->buffer->data, lexer->buff_cap)))
+        lexer_invalid_utf8(lexer);
+
     // Some UTF8 text may start with a 3-byte 'BOM' marker sequence. If it exists, skip over them because they 
     // are useless bytes. Generally, it is not recommended to add BOM markers to UTF8 texts, but it's not 
     // uncommon (especially on Windows).
@@ -612,7 +692,13 @@ void lexer_lex(Lexer* lexer) {
                 tokenkind = TOK_NULL;
                 break;
             // Identifier
-            case ALPHA: case '_': tokenkind = TOK_NULL; lex_identifier(lexer); break;
+            case ALPHA: case '_':
+                tokenkind = TOK_NULL;
+                if(curr == 'f' && next == '"')
+                    lex_format_string(lexer);
+                else
+                    lex_identifier(lexer);
+                break;
             case DIGIT: tokenkind = TOK_NULL; lex_digit(lexer); break;
             case '"':
                 switch(next) {
@@ -701,7 +787,7 @@ void lexer_lex(Lexer* lexer) {
             case '!':
                 switch(next) {
                     case '=': LEXER_INCREMENT_OFFSET; tokenkind = EXCLAMATION_EQUALS; break;
-                    default: tokenkind = MINUS_MINUS; break;
+                    default: tokenkind = EXCLAMATION; break;
                 }
                 break;
             case '%':
@@ -795,6 +881,17 @@ void lexer_lex(Lexer* lexer) {
             case '?': tokenkind = QUESTION; break;
             case '@': tokenkind = TOK_NULL; lex_macro(lexer); break;
             default:
+                // Non-ASCII characters may only start identifiers (and only if they're XID_Start)
+                if(cast(Byte)curr >= 0x80) {
+                    UInt32 nbytes;
+                    Rune rune = utf8_decode(lexer->buffer->data + lexer->offset - 1, &nbytes);
+                    if(utf8_is_xid_start(rune)) {
+                        tokenkind = TOK_NULL;
+                        lex_identifier(lexer);
+                        break;
+                    }
+                    lexer_error(ErrorInvalidCharacter, "Invalid character `U+%04X`", rune);
+                }
                 lexer_error(ErrorSyntaxError, "Invalid character `%c`", curr);
                 break;
         } // switch(ch)
@@ -18,6 +18,7 @@ Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
 #include <adorad/core/char.h> 
 #include <adorad/core/vector.h>
 #include <adorad/core/buffer.h>
+#include <adorad/core/utf8.h>
 #include <adorad/core/debug.h>
 
 #include <adorad/compiler/tokens.h>
@@ -32,6 +33,10 @@ Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
 
     In case of a scan error, ILLEGAL is returned and the error details can be extracted from the token itself.
 
+    Source files are UTF-8. The whole buffer is validated once (vectorized) before lexing starts, so the Lexer
+    itself works on bytes and only decodes a character when it sees a non-ASCII lead byte (in identifiers).
+    Identifiers follow UAX #31: an XID_Start character (or `_`), then any number of XID_Continue characters.
+
     Reference: 
         1. ASCII Table: http://www.theasciicode.com.ar 
 */
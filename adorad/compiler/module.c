@@ -0,0 +1,472 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <adorad/compiler/module.h>
+#include <adorad/core/clock.h>
+#include <adorad/core/debug.h>
+#include <adorad/core/io.h>
+#include <adorad/core/misc.h>
+#include <adorad/core/os.h>
+
+static inline Module* modgraph_at(ModuleGraph* graph, UInt64 index) {
+    return *cast(Module**)vec_at(graph->modules, index);
+}
+
+static char* modgraph_strdup(const char* str, UInt64 len) {
+    char* copy = cast(char*)malloc(len + 1);
+    CORETEN_ENFORCE_NN(copy, "Could not allocate memory. Memory full.");
+    memcpy(copy, str, len);
+    copy[len] = nullchar;
+    return copy;
+}
+
+ATTRIBUTE_PRINTF(3, 4)
+static void modgraph_error(ModuleGraph* graph, Loc* loc, const char* format, ...) {
+    char buffer[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    CheckerDiagnostic diag;
+    diag.fname = SOME(loc) ? loc->fname : null;
+    diag.line = SOME(loc) ? loc->line : 0;
+    diag.col = SOME(loc) ? loc->col : 0;
+    diag.msg = modgraph_strdup(buffer, strlen(buffer));
+    vec_push(graph->diagnostics, &diag);
+}
+
+// Length of the directory part of `path` (without the trailing separator). 0 if there is none.
+static UInt64 module_dirname_len(const char* path) {
+    UInt64 len = strlen(path);
+    while(len > 0 && !os_is_sep(path[len - 1]))
+        len--;
+    // Keep the separator if it's the root
+    return len > 1 ? len - 1 : len;
+}
+
+// Takes ownership of `path`
+static Module* modgraph_add(ModuleGraph* graph, char* path) {
+    Module* module = cast(Module*)calloc(1, sizeof(Module));
+    CORETEN_ENFORCE_NN(module, "Could not allocate memory. Memory full.");
+
+    // `dir/foo.ad` is `foo`
+    const char* basename = path + module_dirname_len(path);
+    if(os_is_sep(*basename))
+        basename++;
+    UInt64 len = strlen(basename);
+    UInt64 ext_len = strlen(MODULE_FILE_EXT);
+    if(len > ext_len && strcmp(basename + len - ext_len, MODULE_FILE_EXT) == 0)
+        len -= ext_len;
+
+    module->name = buff_new(modgraph_strdup(basename, len));
+    module->path = path;
+    module->deps = VEC_NEW(ModuleDep, 4);
+    module->index = cast(UInt32)vec_size(graph->modules);
+    module->wave = MODULE_NONE;
+    module->critical_dep = MODULE_NONE;
+    vec_push(graph->modules, &module);
+    return module;
+}
+
+static Module* modgraph_find_path(ModuleGraph* graph, const char* path) {
+    for(UInt64 i = 0; i < vec_size(graph->modules); i++) {
+        Module* module = modgraph_at(graph, i);
+        if(strcmp(module->path, path) == 0)
+            return module;
+    }
+    return null;
+}
+
+// Returns the path of `file` in `dir` if it exists (null otherwise)
+static char* module_find_file(const char* dir, UInt64 dir_len, char* file) {
+    char* dir_copy = modgraph_strdup(dir_len > 0 ? dir : ".", dir_len > 0 ? dir_len : 1);
+    cstlBuffView joined = os_path_join(buffview_new(dir_copy), buffview_new(file));
+    free(dir_copy);
+
+    char* path = cast(char*)joined.data;
+    if(file_exists(path))
+        return path;
+    free(path);
+    return null;
+}
+
+// Find the module every `use` statement of `module` refers to (loading it, if it's new)
+static void modgraph_resolve_uses(ModuleGraph* graph, Module* module) {
+    Vec* nodelist = module->parser->nodelist;
+    for(UInt64 i = 0; i < vec_size(nodelist); i++) {
+        AstNode* node = cast(AstNode*)vec_at(nodelist, i);
+        if(node->kind != AstNodeKindUseStatement)
+            continue;
+
+        Buff* name = node->data.stmt->use_stmt->name;
+        UInt64 ext_len = strlen(MODULE_FILE_EXT);
+        char* file = cast(char*)malloc(name->len + ext_len + 1);
+        CORETEN_ENFORCE_NN(file, "Could not allocate memory. Memory full.");
+        memcpy(file, name->data, name->len);
+        memcpy(file + name->len, MODULE_FILE_EXT, ext_len + 1);
+
+        // Next to `module` first, then in the search paths
+        char* path = module_find_file(module->path, module_dirname_len(module->path), file);
+        for(UInt64 p = 0; NONE(path) && p < vec_size(graph->search_paths); p++) {
+            char* dir = *cast(char**)vec_at(graph->search_paths, p);
+            path = module_find_file(dir, strlen(dir), file);
+        }
+        free(file);
+
+        if(NONE(path)) {
+            modgraph_error(graph, node->loc, "Cannot find module `%s`", name->data);
+            continue;
+        }
+
+        Module* dep = modgraph_find_path(graph, path);
+        if(SOME(dep))
+            free(path);
+        else
+            dep = modgraph_add(graph, path);
+
+        bool is_duplicate = false;
+        for(UInt64 d = 0; d < vec_size(module->deps); d++)
+            is_duplicate |= (cast(ModuleDep*)vec_at(module->deps, d))->module == dep->index;
+        if(!is_duplicate) {
+            ModuleDep edge = { .module = dep->index, .loc = node->loc };
+            vec_push(module->deps, &edge);
+        }
+    }
+}
+
+typedef struct {
+    ModuleGraph* graph;
+    UInt64 begin;
+} ModuleParseBatch;
+
+static void modgraph_parse_task(void* arg, UInt64 index, UInt32 worker) {
+    ModuleParseBatch* batch = cast(ModuleParseBatch*)arg;
+    Module* module = modgraph_at(batch->graph, batch->begin + index);
+
+    double start = clock_monotonic();
+    module->source = read_file(module->path);
+    Lexer* lexer = lexer_init(module->source, module->path);
+    lexer_lex(lexer);
+    module->parser = parser_init(lexer);
+    parser_parse(module->parser);
+    module->cost += clock_monotonic() - start;
+}
+
+// Report the cycle that `start` leads into
+static void modgraph_report_cycle(ModuleGraph* graph, UInt32 start, UInt32* indegree) {
+    UInt64 num_modules = vec_size(graph->modules);
+    UInt32* position = cast(UInt32*)malloc(num_modules * sizeof(UInt32));
+    UInt32* path = cast(UInt32*)malloc((num_modules + 1) * sizeof(UInt32));
+    CORETEN_ENFORCE(SOME(position) && SOME(path), "Could not allocate memory. Memory full.");
+    for(UInt64 i = 0; i < num_modules; i++)
+        position[i] = MODULE_NONE;
+
+    // Every module left over after the topological sort has a dependency that's left over too, so walking those
+    // dependencies has to come back to a module that was seen before
+    UInt32 len = 0;
+    UInt32 curr = start;
+    while(position[curr] == MODULE_NONE) {
+        position[curr] = len;
+        path[len++] = curr;
+        Module* module = modgraph_at(graph, curr);
+        for(UInt64 d = 0; d < vec_size(module->deps); d++) {
+            UInt32 dep = (cast(ModuleDep*)vec_at(module->deps, d))->module;
+            if(indegree[dep] > 0) {
+                curr = dep;
+                break;
+            }
+        }
+    }
+
+    char buffer[384];
+    UInt64 n = 0;
+    for(UInt32 i = position[curr]; i < len && n < sizeof(buffer); i++)
+        n += cast(UInt64)snprintf(buffer + n, sizeof(buffer) - n, "%s -> ", modgraph_at(graph, path[i])->name->data);
+    if(n < sizeof(buffer))
+        snprintf(buffer + n, sizeof(buffer) - n, "%s", modgraph_at(graph, curr)->name->data);
+
+    // Report it at the first `use` of the cycle
+    Module* first = modgraph_at(graph, curr);
+    UInt32 next = position[curr] + 1 < len ? path[position[curr] + 1] : curr;
+    Loc* loc = null;
+    for(UInt64 d = 0; d < vec_size(first->deps) && NONE(loc); d++) {
+        ModuleDep* dep = cast(ModuleDep*)vec_at(first->deps, d);
+        if(dep->module == next)
+            loc = dep->loc;
+    }
+    modgraph_error(graph, loc, "Import cycle: %s", buffer);
+
+    free(position);
+    free(path);
+}
+
+// Sort the modules into waves (Kahn's algorithm, one layer at a time)
+static void modgraph_schedule(ModuleGraph* graph) {
+    UInt64 num_modules = vec_size(graph->modules);
+    if(num_modules == 0)
+        return;
+
+    // Dependents of every module (CSR: the dependents of `i` are `dependents[offsets[i]..offsets[i + 1]]`)
+    UInt32* indegree = cast(UInt32*)calloc(num_modules, sizeof(UInt32));
+    UInt32* offsets = cast(UInt32*)calloc(num_modules + 1, sizeof(UInt32));
+    CORETEN_ENFORCE(SOME(indegree) && SOME(offsets), "Could not allocate memory. Memory full.");
+    UInt64 num_edges = 0;
+    for(UInt64 i = 0; i < num_modules; i++) {
+        Module* module = modgraph_at(graph, i);
+        indegree[i] = cast(UInt32)vec_size(module->deps);
+        num_edges += vec_size(module->deps);
+        for(UInt64 d = 0; d < vec_size(module->deps); d++)
+            offsets[(cast(ModuleDep*)vec_at(module->deps, d))->module + 1]++;
+    }
+    for(UInt64 i = 0; i < num_modules; i++)
+        offsets[i + 1] += offsets[i];
+
+    UInt32* dependents = cast(UInt32*)malloc((num_edges + 1) * sizeof(UInt32));
+    UInt32* fill = cast(UInt32*)malloc(num_modules * sizeof(UInt32));
+    CORETEN_ENFORCE(SOME(dependents) && SOME(fill), "Could not allocate memory. Memory full.");
+    memcpy(fill, offsets, num_modules * sizeof(UInt32));
+    for(UInt64 i = 0; i < num_modules; i++) {
+        Module* module = modgraph_at(graph, i);
+        for(UInt64 d = 0; d < vec_size(module->deps); d++)
+            dependents[fill[(cast(ModuleDep*)vec_at(module->deps, d))->module]++] = cast(UInt32)i;
+    }
+
+    Vec* wave = VEC_NEW(UInt32, 8);
+    for(UInt32 i = 0; i < num_modules; i++)
+        if(indegree[i] == 0)
+            vec_push(wave, &i);
+
+    UInt64 num_scheduled = 0;
+    while(vec_size(wave) > 0) {
+        Vec* next = VEC_NEW(UInt32, 8);
+        for(UInt64 w = 0; w < vec_size(wave); w++) {
+            UInt32 index = *cast(UInt32*)vec_at(wave, w);
+            modgraph_at(graph, index)->wave = cast(UInt32)vec_size(graph->waves);
+            for(UInt32 e = offsets[index]; e < offsets[index + 1]; e++)
+                if(--indegree[dependents[e]] == 0)
+                    vec_push(next, &dependents[e]);
+        }
+        num_scheduled += vec_size(wave);
+        vec_push(graph->waves, &wave);
+        wave = next;
+    }
+    vec_free(wave);
+
+    if(num_scheduled < num_modules) {
+        for(UInt32 i = 0; i < num_modules; i++) {
+            if(indegree[i] > 0) {
+                modgraph_report_cycle(graph, i, indegree);
+                break;
+            }
+        }
+
+        // Nothing can be scheduled
+        for(UInt64 w = 0; w < vec_size(graph->waves); w++)
+            vec_free(*cast(Vec**)vec_at(graph->waves, w));
+        while(vec_size(graph->waves) > 0)
+            vec_pop(graph->waves);
+        for(UInt64 i = 0; i < num_modules; i++)
+            modgraph_at(graph, i)->wave = MODULE_NONE;
+    }
+
+    free(indegree);
+    free(offsets);
+    free(dependents);
+    free(fill);
+}
+
+ModuleGraph* modgraph_new(UInt32 num_threads) {
+    ModuleGraph* graph = cast(ModuleGraph*)calloc(1, sizeof(ModuleGraph));
+    CORETEN_ENFORCE_NN(graph, "Could not allocate memory. Memory full.");
+    graph->pool = threadpool_new(num_threads);
+    graph->modules = VEC_NEW(Module*, 16);
+    graph->search_paths = VEC_NEW(char*, 4);
+    graph->waves = VEC_NEW(Vec*, 8);
+    graph->diagnostics = VEC_NEW(CheckerDiagnostic, 4);
+    return graph;
+}
+
+void modgraph_free(ModuleGraph* graph) {
+    if(NONE(graph))
+        return;
+
+    for(UInt64 i = 0; i < vec_size(graph->modules); i++) {
+        Module* module = modgraph_at(graph, i);
+        checker_free(module->checker);
+        parser_free(module->parser);
+        free(module->source);
+        free(module->path);
+        free(module->name->data);
+        buff_free(module->name);
+        vec_free(module->deps);
+        free(module);
+    }
+    for(UInt64 i = 0; i < vec_size(graph->search_paths); i++)
+        free(*cast(char**)vec_at(graph->search_paths, i));
+    for(UInt64 i = 0; i < vec_size(graph->waves); i++)
+        vec_free(*cast(Vec**)vec_at(graph->waves, i));
+    for(UInt64 i = 0; i < vec_size(graph->diagnostics); i++)
+        free((cast(CheckerDiagnostic*)vec_at(graph->diagnostics, i))->msg);
+
+    vec_free(graph->modules);
+    vec_free(graph->search_paths);
+    vec_free(graph->waves);
+    vec_free(graph->diagnostics);
+    threadpool_free(graph->pool);
+    free(graph);
+}
+
+void modgraph_add_search_path(ModuleGraph* graph, const char* dir) {
+    char* copy = modgraph_strdup(dir, strlen(dir));
+    vec_push(graph->search_paths, &copy);
+}
+
+UInt64 modgraph_load(ModuleGraph* graph, const char* path) {
+    CORETEN_ENFORCE(vec_size(graph->modules) == 0, "A ModuleGraph can only load one root module");
+    if(!file_exists(path)) {
+        modgraph_error(graph, null, "Cannot find `%s`", path);
+        return vec_size(graph->diagnostics);
+    }
+    modgraph_add(graph, modgraph_strdup(path, strlen(path)));
+
+    // Breadth-first: parse everything discovered in the last round in parallel, then look for what it uses
+    UInt64 begin = 0;
+    while(begin < vec_size(graph->modules)) {
+        UInt64 end = vec_size(graph->modules);
+        ModuleParseBatch batch = { .graph = graph, .begin = begin };
+        threadpool_parallel_for(graph->pool, end - begin, modgraph_parse_task, &batch);
+        for(UInt64 i = begin; i < end; i++)
+            modgraph_resolve_uses(graph, modgraph_at(graph, i));
+        begin = end;
+    }
+
+    modgraph_schedule(graph);
+    return vec_size(graph->diagnostics);
+}
+
+Module* modgraph_find(ModuleGraph* graph, const char* name, UInt64 len) {
+    for(UInt64 i = 0; i < vec_size(graph->modules); i++) {
+        Module* module = modgraph_at(graph, i);
+        if(module->name->len == len && memcmp(module->name->data, name, len) == 0)
+            return module;
+    }
+    return null;
+}
+
+typedef struct {
+    ModuleGraph* graph;
+    Vec* wave;
+    ModuleTask task;
+    void* ctx;
+} ModuleRunBatch;
+
+static void modgraph_run_task(void* arg, UInt64 index, UInt32 worker) {
+    ModuleRunBatch* batch = cast(ModuleRunBatch*)arg;
+    Module* module = modgraph_at(batch->graph, *cast(UInt32*)vec_at(batch->wave, index));
+
+    double start = clock_monotonic();
+    batch->task(batch->ctx, module, worker);
+    module->cost += clock_monotonic() - start;
+}
+
+void modgraph_run(ModuleGraph* graph, ModuleTask task, void* ctx) {
+    for(UInt64 w = 0; w < vec_size(graph->waves); w++) {
+        ModuleRunBatch batch = { .graph = graph, .wave = *cast(Vec**)vec_at(graph->waves, w), .task = task, .ctx = ctx };
+        threadpool_parallel_for(graph->pool, vec_size(batch.wave), modgraph_run_task, &batch);
+    }
+}
+
+static void modgraph_check_task(void* ctx, Module* module, UInt32 worker) {
+    // Modules are already checked in parallel, so every module gets a single thread
+    module->checker = checker_new(1);
+    checker_check(module->checker, &module->parser, 1);
+}
+
+UInt64 modgraph_check(ModuleGraph* graph) {
+    modgraph_run(graph, modgraph_check_task, null);
+
+    UInt64 num_errors = 0;
+    for(UInt64 i = 0; i < vec_size(graph->modules); i++) {
+        Module* module = modgraph_at(graph, i);
+        if(SOME(module->checker))
+            num_errors += vec_size(module->checker->diagnostics);
+    }
+    return num_errors;
+}
+
+Module* modgraph_critical_path(ModuleGraph* graph) {
+    Module* last = null;
+    for(UInt64 w = 0; w < vec_size(graph->waves); w++) {
+        Vec* wave = *cast(Vec**)vec_at(graph->waves, w);
+        for(UInt64 i = 0; i < vec_size(wave); i++) {
+            Module* module = modgraph_at(graph, *cast(UInt32*)vec_at(wave, i));
+            module->critical_path = 0;
+            module->critical_dep = MODULE_NONE;
+            // Dependencies are in earlier waves, so they're up to date
+            for(UInt64 d = 0; d < vec_size(module->deps); d++) {
+                Module* dep = modgraph_at(graph, (cast(ModuleDep*)vec_at(module->deps, d))->module);
+                if(module->critical_dep == MODULE_NONE || dep->critical_path > module->critical_path) {
+                    module->critical_path = dep->critical_path;
+                    module->critical_dep = dep->index;
+                }
+            }
+            module->critical_path += module->cost;
+            if(NONE(last) || module->critical_path > last->critical_path)
+                last = module;
+        }
+    }
+    return last;
+}
+
+void modgraph_print_schedule(ModuleGraph* graph, FILE* stream) {
+    double total = 0;
+    for(UInt64 w = 0; w < vec_size(graph->waves); w++) {
+        Vec* wave = *cast(Vec**)vec_at(graph->waves, w);
+        fprintf(stream, "wave %" CORETEN_PRIu64 " (%" CORETEN_PRIu64 " modules):", w, vec_size(wave));
+        for(UInt64 i = 0; i < vec_size(wave); i++) {
+            Module* module = modgraph_at(graph, *cast(UInt32*)vec_at(wave, i));
+            fprintf(stream, " %s", module->name->data);
+            total += module->cost;
+        }
+        fprintf(stream, "\n");
+    }
+
+    Module* last = modgraph_critical_path(graph);
+    if(NONE(last))
+        return;
+
+    // The chain is found backwards (from the module that finishes last)
+    fprintf(stream, "critical path: %s", last->name->data);
+    for(UInt32 dep = last->critical_dep; dep != MODULE_NONE; dep = modgraph_at(graph, dep)->critical_dep)
+        fprintf(stream, " <- %s", modgraph_at(graph, dep)->name->data);
+    fprintf(stream, "\n%.3f ms of %.3f ms total (at most %.2fx faster in parallel)\n", last->critical_path * 1e3,
+            total * 1e3, last->critical_path > 0 ? total / last->critical_path : 1.0);
+}
+
+void modgraph_print_diagnostics(ModuleGraph* graph, FILE* stream) {
+    for(UInt64 i = 0; i < vec_size(graph->diagnostics); i++) {
+        CheckerDiagnostic* diag = cast(CheckerDiagnostic*)vec_at(graph->diagnostics, i);
+        fprintf(stream, "%s:%u:%u: error: %s\n", SOME(diag->fname) ? diag->fname->data : "<unknown>", diag->line,
+                diag->col, diag->msg);
+    }
+    for(UInt64 i = 0; i < vec_size(graph->modules); i++) {
+        Module* module = modgraph_at(graph, i);
+        if(SOME(module->checker))
+            checker_print_diagnostics(module->checker, stream);
+    }
+}
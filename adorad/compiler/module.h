@@ -0,0 +1,97 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#ifndef ADORAD_MODULE_H
+#define ADORAD_MODULE_H
+
+#include <stdio.h>
+#include <adorad/core/types.h>
+#include <adorad/core/buffer.h>
+#include <adorad/core/vector.h>
+#include <adorad/core/thread.h>
+#include <adorad/compiler/lexer.h>
+#include <adorad/compiler/parser.h>
+#include <adorad/compiler/checker.h>
+
+/*
+    The Module Graph.
+
+    Every source file is a module, and `use foo` makes the module depend on `foo.ad`, which is looked for next to the
+    module that uses it first, and then in every search path (in the order they were added).
+
+    Loading the root module discovers the whole graph breadth-first: all modules found at the same depth are read,
+    lexed and parsed in parallel, and then their `use` statements are resolved (serially, so the graph is the same
+    no matter how many threads are used).
+    Once the graph is complete, it's sorted into topological "waves": a module's wave is one more than the latest wave
+    of its dependencies, so the modules of a wave never depend on each other and can be processed in parallel (every
+    dependency of a module is done before its wave starts). Import cycles are reported as errors.
+
+    The time spent on every module is recorded, which gives the critical path - the most expensive chain of
+    dependencies, and a lower bound on how long compiling the graph can take, no matter the number of threads.
+*/
+
+#define MODULE_FILE_EXT     ".ad"
+#define MODULE_NONE         UINT32_MAX
+
+typedef struct ModuleDep {
+    UInt32 module;      // index of the dependency
+    Loc* loc;           // location of the `use` statement
+} ModuleDep;
+
+typedef struct Module {
+    Buff* name;         // `foo` for `foo.ad`
+    char* path;         // path of the source file
+    char* source;
+    Parser* parser;     // null until parsed
+    Checker* checker;   // null until checked
+    Vec* deps;          // `ModuleDep`s, in order of the `use` statements
+    UInt32 index;       // index in `ModuleGraph.modules`
+    UInt32 wave;
+
+    double cost;            // seconds spent on this module (parsing, checking, ...)
+    double critical_path;   // cost of the most expensive chain of dependencies ending with this module (inclusive)
+    UInt32 critical_dep;    // the dependency on that chain (MODULE_NONE if there are no dependencies)
+} Module;
+
+typedef struct ModuleGraph {
+    ThreadPool* pool;
+    Vec* modules;       // `Module*`s, in discovery order (the root module is first)
+    Vec* search_paths;  // `char*`s
+    Vec* waves;         // `Vec*`s of module indices (UInt32), in dependency order. Empty if there's a cycle
+    Vec* diagnostics;   // `CheckerDiagnostic`s of the graph itself (missing modules, cycles)
+} ModuleGraph;
+
+// Runs once for every module, on any of the graph's threads
+typedef void (*ModuleTask)(void* ctx, Module* module, UInt32 worker);
+
+// `num_threads` is the number of threads used to process the modules of a wave (0 = one per CPU)
+ModuleGraph* modgraph_new(UInt32 num_threads);
+void modgraph_free(ModuleGraph* graph);
+void modgraph_add_search_path(ModuleGraph* graph, const char* dir);
+// Load (and parse) the module at `path` and everything it uses. Returns the number of errors.
+UInt64 modgraph_load(ModuleGraph* graph, const char* path);
+// Returns the first module named `name` (or null)
+Module* modgraph_find(ModuleGraph* graph, const char* name, UInt64 len);
+// Run `task` on every module, wave by wave. The time spent in `task` is added to each module's cost.
+void modgraph_run(ModuleGraph* graph, ModuleTask task, void* ctx);
+// Type check every module. Returns the total number of errors.
+UInt64 modgraph_check(ModuleGraph* graph);
+// Update the critical path of every module from the current costs. Returns the last module on the overall
+// critical path (follow `critical_dep` from there), or null if there are no waves.
+Module* modgraph_critical_path(ModuleGraph* graph);
+// Print the waves, and the critical path
+void modgraph_print_schedule(ModuleGraph* graph, FILE* stream);
+// Print the errors of the graph and of every checked module
+void modgraph_print_diagnostics(ModuleGraph* graph, FILE* stream);
+
+#endif // ADORAD_MODULE_H
@@ -0,0 +1,1157 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <adorad/compiler/opt.h>
+#include <adorad/core/clock.h>
+#include <adorad/core/debug.h>
+
+static const char* opt_pass_names[OptPassCount] = { "fold", "cse", "dce", "inline" };
+
+const char* opt_pass_name(OptPass pass) {
+    return pass < OptPassCount ? opt_pass_names[pass] : "<invalid>";
+}
+
+static inline IrValue opt_at(Vec* values, UInt64 index) {
+    return *cast(IrValue*)vec_at(values, index);
+}
+
+// Drop the `nop`s (removed instructions) from every block
+static void opt_compact(IrFunc* func) {
+    for(UInt64 i = 0; i < vec_size(func->blocks); i++) {
+        IrBlock* block = ir_block(func, cast(UInt32)i);
+        Vec* lists[2] = { block->phis, block->insts };
+        for(UInt32 l = 0; l < 2; l++) {
+            UInt64 len = 0;
+            for(UInt64 j = 0; j < vec_size(lists[l]); j++) {
+                IrValue value = opt_at(lists[l], j);
+                if(ir_inst(func, value)->op != IrOpNop)
+                    *cast(IrValue*)vec_at(lists[l], len++) = value;
+            }
+            lists[l]->core.len = len;
+        }
+    }
+}
+
+// Replace every use of `value` with `replacement`, and remove `value`
+static void opt_replace(IrFunc* func, IrValue value, IrValue replacement) {
+    ir_replace_uses(func, value, replacement);
+    ir_kill(func, value);
+}
+
+// The index of `pred` in the predecessors of `block`, or IR_NONE if there's no edge from it
+static UInt32 opt_find_pred(IrFunc* func, UInt32 block, UInt32 pred) {
+    Vec* preds = ir_block(func, block)->preds;
+    for(UInt64 i = vec_size(preds); i > 0; i--)
+        if(*cast(UInt32*)vec_at(preds, i - 1) == pred)
+            return cast(UInt32)i - 1;
+    return IR_NONE;
+}
+
+// Constant folding ------------------------------------------------------------------------------------------------
+
+// The number of bits in a value of `type`, or 0 if its constants aren't folded as integers
+UInt32 opt_int_bits(Type* type) {
+    if(type->kind == AdoradTypeBool)
+        return 1;
+    return type_is_integer(type) ? 8 * type_size(type) : 0;
+}
+
+// `value` truncated to `type`, and sign-extended (for signed types) or zero-extended to 64 bits
+UInt64 opt_normalize(Type* type, UInt64 value) {
+    UInt32 bits = opt_int_bits(type);
+    if(bits == 0 || bits == 64)
+        return value;
+    UInt64 mask = (cast(UInt64)1 << bits) - 1;
+    value &= mask;
+    if(type_is_signed(type) && (value >> (bits - 1)) & 1)
+        value |= ~mask;
+    return value;
+}
+
+double opt_round(Type* type, double value) {
+    return type->kind == AdoradTypeFloat32 ? cast(double)cast(float)value : value;
+}
+
+static bool opt_is_int_const(IrFunc* func, IrValue value) {
+    // Operands can be IR_NONE while the instruction that has them is being rewritten
+    if(value >= vec_size(func->insts))
+        return false;
+    IrInst* inst = ir_inst(func, value);
+    return inst->op == IrOpConst && opt_int_bits(type_get(inst->type)) > 0;
+}
+
+static UInt64 opt_int_value(IrFunc* func, IrValue value) {
+    IrInst* inst = ir_inst(func, value);
+    return opt_normalize(type_get(inst->type), inst->imm);
+}
+
+static bool opt_is_int_const_eq(IrFunc* func, IrValue value, UInt64 imm) {
+    if(!opt_is_int_const(func, value))
+        return false;
+    return opt_int_value(func, value) == opt_normalize(type_get(ir_inst(func, value)->type), imm);
+}
+
+// Turn `value` into a constant (in place, so its uses stay)
+static void opt_make_const(IrFunc* func, IrValue value, UInt64 imm) {
+    IrInst* inst = ir_inst(func, value);
+    for(UInt32 i = 0; i < inst->num_operands; i++)
+        ir_set_operand(func, value, i, IR_NONE);
+    inst = ir_inst(func, value);
+    inst->op = IrOpConst;
+    inst->num_operands = 0;
+    inst->imm = opt_normalize(type_get(inst->type), imm);
+}
+
+static void opt_make_float_const(IrFunc* func, IrValue value, double fimm) {
+    opt_make_const(func, value, 0);
+    IrInst* inst = ir_inst(func, value);
+    inst->op = IrOpConstFloat;
+    inst->fimm = opt_round(type_get(inst->type), fimm);
+}
+
+bool opt_compare_int(IrOp op, bool is_signed, UInt64 a, UInt64 b) {
+    Int64 sa = cast(Int64)a;
+    Int64 sb = cast(Int64)b;
+    switch(op) {
+        case IrOpEq: return a == b;
+        case IrOpNe: return a != b;
+        case IrOpLt: return is_signed ? sa < sb : a < b;
+        case IrOpLe: return is_signed ? sa <= sb : a <= b;
+        case IrOpGt: return is_signed ? sa > sb : a > b;
+        case IrOpGe: return is_signed ? sa >= sb : a >= b;
+        default: unreachable(); return false;
+    }
+}
+
+bool opt_compare_float(IrOp op, double a, double b) {
+    switch(op) {
+        case IrOpEq: return a == b;
+        case IrOpNe: return a != b;
+        case IrOpLt: return a < b;
+        case IrOpLe: return a <= b;
+        case IrOpGt: return a > b;
+        case IrOpGe: return a >= b;
+        default: unreachable(); return false;
+    }
+}
+
+// `a op b` for integers of type `type`. Returns false if it can't be folded (division by zero, shifting by too much).
+bool opt_fold_int(IrOp op, Type* type, UInt64 a, UInt64 b, UInt64* out) {
+    bool is_signed = type_is_signed(type);
+    UInt32 bits = opt_int_bits(type);
+    switch(op) {
+        case IrOpAdd: *out = a + b; break;
+        case IrOpSub: *out = a - b; break;
+        case IrOpMul: *out = a * b; break;
+        case IrOpDiv:
+        case IrOpMod:
+            if(b == 0 || (is_signed && cast(Int64)a == INT64_MIN && cast(Int64)b == -1))
+                return false;
+            if(is_signed)
+                *out = cast(UInt64)(op == IrOpDiv ? cast(Int64)a / cast(Int64)b : cast(Int64)a % cast(Int64)b);
+            else
+                *out = op == IrOpDiv ? a / b : a % b;
+            break;
+        case IrOpAnd: *out = a & b; break;
+        case IrOpOr: *out = a | b; break;
+        case IrOpXor: *out = a ^ b; break;
+        case IrOpShl:
+        case IrOpShr:
+            if(b >= bits)
+                return false;
+            if(op == IrOpShl)
+                *out = a << b;
+            else
+                *out = is_signed ? cast(UInt64)(cast(Int64)a >> b) : a >> b;
+            break;
+        default:
+            return false;
+    }
+    *out = opt_normalize(type, *out);
+    return true;
+}
+
+bool opt_fold_float(IrOp op, double a, double b, double* out) {
+    switch(op) {
+        case IrOpAdd: *out = a + b; return true;
+        case IrOpSub: *out = a - b; return true;
+        case IrOpMul: *out = a * b; return true;
+        case IrOpDiv: *out = a / b; return true;
+        default: return false;
+    }
+}
+
+static inline bool opt_is_compare(IrOp op) {
+    return op >= IrOpEq && op <= IrOpGe;
+}
+
+// Algebraic identities that hold for integers (`x + 0`, `x * 1`, `x - x`, ...). Returns true if `value` was changed.
+static bool opt_fold_identity(IrFunc* func, IrValue value, IrOp op, IrValue lhs, IrValue rhs) {
+    if(opt_int_bits(type_get(ir_inst(func, lhs)->type)) == 0)
+        return false;
+
+    // `x op x`
+    if(lhs == rhs) {
+        switch(op) {
+            case IrOpSub: case IrOpXor: opt_make_const(func, value, 0); return true;
+            case IrOpAnd: case IrOpOr: opt_replace(func, value, lhs); return true;
+            case IrOpEq: case IrOpLe: case IrOpGe: opt_make_const(func, value, 1); return true;
+            case IrOpNe: case IrOpLt: case IrOpGt: opt_make_const(func, value, 0); return true;
+            default: break;
+        }
+    }
+
+    IrValue zero_identity = IR_NONE;
+    switch(op) {
+        // `x op 0` is `x`
+        case IrOpAdd: case IrOpOr: case IrOpXor:
+            if(opt_is_int_const_eq(func, lhs, 0))
+                zero_identity = rhs;
+            // fallthrough
+        case IrOpSub: case IrOpShl: case IrOpShr:
+            if(opt_is_int_const_eq(func, rhs, 0))
+                zero_identity = lhs;
+            break;
+        // `x * 1` is `x`, and `x * 0` is 0
+        case IrOpMul:
+            if(opt_is_int_const_eq(func, rhs, 0) || opt_is_int_const_eq(func, lhs, 0)) {
+                opt_make_const(func, value, 0);
+                return true;
+            }
+            if(opt_is_int_const_eq(func, rhs, 1))
+                zero_identity = lhs;
+            else if(opt_is_int_const_eq(func, lhs, 1))
+                zero_identity = rhs;
+            break;
+        case IrOpDiv:
+            if(opt_is_int_const_eq(func, rhs, 1))
+                zero_identity = lhs;
+            break;
+        // `x & 0` is 0, and `x & ~0` is `x`
+        case IrOpAnd:
+            if(opt_is_int_const_eq(func, rhs, 0) || opt_is_int_const_eq(func, lhs, 0)) {
+                opt_make_const(func, value, 0);
+                return true;
+            }
+            if(opt_is_int_const_eq(func, rhs, UINT64_MAX))
+                zero_identity = lhs;
+            else if(opt_is_int_const_eq(func, lhs, UINT64_MAX))
+                zero_identity = rhs;
+            break;
+        default:
+            break;
+    }
+    if(zero_identity == IR_NONE)
+        return false;
+    opt_replace(func, value, zero_identity);
+    return true;
+}
+
+// Returns true if `value` was changed (or removed)
+static bool opt_fold_inst(IrFunc* func, IrValue value) {
+    IrInst inst = *ir_inst(func, value);
+    IrOp op = cast(IrOp)inst.op;
+    Type* type = inst.type != TYPE_ID_NONE ? type_get(inst.type) : null;
+
+    switch(op) {
+        case IrOpPhi: {
+            // All operands are the same value (or the phi itself)
+            IrValue same = IR_NONE;
+            for(UInt32 i = 0; i < inst.num_operands; i++) {
+                IrValue operand = ir_operand(func, value, i);
+                if(operand == same || operand == value)
+                    continue;
+                if(same != IR_NONE)
+                    return false;
+                same = operand;
+            }
+            if(same == IR_NONE)
+                return false;
+            opt_replace(func, value, same);
+            return true;
+        }
+
+        case IrOpNeg:
+        case IrOpNot: {
+            IrValue operand = ir_operand(func, value, 0);
+            IrInst* arg = ir_inst(func, operand);
+            if(arg->op == op && op == IrOpNot) {
+                // `!!x`
+                opt_replace(func, value, ir_operand(func, operand, 0));
+                return true;
+            }
+            if(opt_is_int_const(func, operand)) {
+                UInt64 a = opt_int_value(func, operand);
+                opt_make_const(func, value, op == IrOpNeg ? 0 - a : ~a);
+                return true;
+            }
+            if(arg->op == IrOpConstFloat && op == IrOpNeg) {
+                opt_make_float_const(func, value, -arg->fimm);
+                return true;
+            }
+            return false;
+        }
+
+        case IrOpAdd: case IrOpSub: case IrOpMul: case IrOpDiv: case IrOpMod:
+        case IrOpAnd: case IrOpOr: case IrOpXor: case IrOpShl: case IrOpShr:
+        case IrOpEq: case IrOpNe: case IrOpLt: case IrOpLe: case IrOpGt: case IrOpGe: {
+            IrValue lhs = ir_operand(func, value, 0);
+            IrValue rhs = ir_operand(func, value, 1);
+            Type* operand_type = type_get(ir_inst(func, lhs)->type);
+            if(opt_is_int_const(func, lhs) && opt_is_int_const(func, rhs)) {
+                UInt64 a = opt_int_value(func, lhs);
+                UInt64 b = opt_int_value(func, rhs);
+                if(opt_is_compare(op)) {
+                    opt_make_const(func, value, opt_compare_int(op, type_is_signed(operand_type), a, b));
+                    return true;
+                }
+                UInt64 result = 0;
+                if(!opt_fold_int(op, type, a, b, &result))
+                    return false;
+                opt_make_const(func, value, result);
+                return true;
+            }
+
+            IrInst* a = ir_inst(func, lhs);
+            IrInst* b = ir_inst(func, rhs);
+            if(a->op == IrOpConstFloat && b->op == IrOpConstFloat) {
+                double x = a->fimm;
+                double y = b->fimm;
+                if(opt_is_compare(op)) {
+                    opt_make_const(func, value, opt_compare_float(op, x, y));
+                    return true;
+                }
+                double result = 0;
+                if(!opt_fold_float(op, x, y, &result))
+                    return false;
+                opt_make_float_const(func, value, result);
+                return true;
+            }
+            return opt_fold_identity(func, value, op, lhs, rhs);
+        }
+
+        case IrOpConvert: {
+            IrValue operand = ir_operand(func, value, 0);
+            IrInst* arg = ir_inst(func, operand);
+            Type* from = type_get(arg->type);
+            if(opt_is_int_const(func, operand) && from->kind != AdoradTypeBool) {
+                UInt64 a = opt_int_value(func, operand);
+                if(opt_int_bits(type) > 0 && type->kind != AdoradTypeBool) {
+                    opt_make_const(func, value, a);
+                    return true;
+                }
+                if(type_is_float(type)) {
+                    opt_make_float_const(func, value, type_is_signed(from) ? cast(double)cast(Int64)a : cast(double)a);
+                    return true;
+                }
+            }
+            if(arg->op == IrOpConstFloat && type_is_float(type)) {
+                opt_make_float_const(func, value, arg->fimm);
+                return true;
+            }
+            return false;
+        }
+
+        case IrOpIsNull: {
+            IrInst* arg = ir_inst(func, ir_operand(func, value, 0));
+            // `T` converted to `?T` is never null
+            if(arg->op == IrOpNull || arg->op == IrOpConvert) {
+                opt_make_const(func, value, arg->op == IrOpNull);
+                return true;
+            }
+            return false;
+        }
+
+        case IrOpBranch: {
+            IrValue cond = ir_operand(func, value, 0);
+            UInt32 taken = IR_NONE;
+            UInt32 untaken = IR_NONE;
+            if(inst.targets[0] == inst.targets[1]) {
+                taken = untaken = inst.targets[0];
+            } else if(opt_is_int_const(func, cond)) {
+                bool is_true = opt_int_value(func, cond) != 0;
+                taken = inst.targets[is_true ? 0 : 1];
+                untaken = inst.targets[is_true ? 1 : 0];
+            } else {
+                return false;
+            }
+            // The branch becomes a jump, and the untaken edge goes away
+            ir_set_operand(func, value, 0, IR_NONE);
+            IrInst* jump = ir_inst(func, value);
+            jump->op = IrOpJump;
+            jump->num_operands = 0;
+            jump->targets[0] = taken;
+            UInt32 pred = opt_find_pred(func, untaken, inst.block);
+            if(pred != IR_NONE)
+                ir_remove_pred(func, untaken, pred);
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+static UInt64 opt_fold(IrFunc* func) {
+    UInt64 changes = 0;
+    UInt64 num_blocks = vec_size(func->blocks);
+    bool changed = true;
+    while(changed) {
+        changed = false;
+        for(UInt64 i = 0; i < vec_size(func->blocks); i++) {
+            IrBlock* block = ir_block(func, cast(UInt32)i);
+            Vec* lists[2] = { block->phis, block->insts };
+            for(UInt32 l = 0; l < 2; l++) {
+                for(UInt64 j = 0; j < vec_size(lists[l]); j++) {
+                    IrValue value = opt_at(lists[l], j);
+                    if(ir_inst(func, value)->op != IrOpNop && opt_fold_inst(func, value)) {
+                        changes++;
+                        changed = true;
+                    }
+                }
+            }
+        }
+    }
+    // Folded branches can leave blocks unreachable
+    opt_compact(func);
+    ir_order_blocks(func);
+    return changes + num_blocks - vec_size(func->blocks);
+}
+
+// Common subexpression elimination --------------------------------------------------------------------------------
+
+// The dominator tree, as preorder/postorder intervals: `a` dominates `b` iff [pre, post] of `b` is within `a`'s
+typedef struct {
+    UInt32* idom;
+    UInt32* pre;
+    UInt32* post;
+} OptDomTree;
+
+// "A Simple, Fast Dominance Algorithm" (Cooper, Harvey, Kennedy). The blocks are in reverse postorder.
+static void opt_dom_tree(IrFunc* func, OptDomTree* tree) {
+    UInt32 num_blocks = cast(UInt32)vec_size(func->blocks);
+    tree->idom = cast(UInt32*)malloc(num_blocks * sizeof(UInt32));
+    tree->pre = cast(UInt32*)malloc(num_blocks * sizeof(UInt32));
+    tree->post = cast(UInt32*)malloc(num_blocks * sizeof(UInt32));
+    UInt32* children = cast(UInt32*)malloc((2 * num_blocks + 1) * sizeof(UInt32));
+    CORETEN_ENFORCE(SOME(tree->idom) && SOME(tree->pre) && SOME(tree->post) && SOME(children),
+                    "Could not allocate memory. Memory full.");
+
+    UInt32* idom = tree->idom;
+    for(UInt32 i = 0; i < num_blocks; i++)
+        idom[i] = IR_NONE;
+    idom[0] = 0;
+    bool changed = true;
+    while(changed) {
+        changed = false;
+        for(UInt32 b = 1; b < num_blocks; b++) {
+            Vec* preds = ir_block(func, b)->preds;
+            UInt32 new_idom = IR_NONE;
+            for(UInt64 i = 0; i < vec_size(preds); i++) {
+                UInt32 pred = *cast(UInt32*)vec_at(preds, i);
+                if(idom[pred] == IR_NONE)
+                    continue;
+                if(new_idom == IR_NONE) {
+                    new_idom = pred;
+                    continue;
+                }
+                UInt32 x = pred;
+                UInt32 y = new_idom;
+                while(x != y) {
+                    while(x > y) x = idom[x];
+                    while(y > x) y = idom[y];
+                }
+                new_idom = x;
+            }
+            if(idom[b] != new_idom) {
+                idom[b] = new_idom;
+                changed = true;
+            }
+        }
+    }
+
+    // Children lists (counting sort by parent), then an iterative DFS to number them
+    UInt32* first = children;                       // [num_blocks + 1]
+    UInt32* list = children + num_blocks + 1;       // [num_blocks - 1]
+    for(UInt32 i = 0; i <= num_blocks; i++)
+        first[i] = 0;
+    for(UInt32 b = 1; b < num_blocks; b++)
+        first[idom[b] + 1]++;
+    for(UInt32 i = 0; i < num_blocks; i++)
+        first[i + 1] += first[i];
+    UInt32* fill = tree->post;      // used as scratch until the numbering below
+    for(UInt32 i = 0; i < num_blocks; i++)
+        fill[i] = first[i];
+    for(UInt32 b = 1; b < num_blocks; b++)
+        list[fill[idom[b]]++] = b;
+
+    UInt32* stack = cast(UInt32*)malloc(2 * num_blocks * sizeof(UInt32));    // (block, next child) pairs
+    CORETEN_ENFORCE_NN(stack, "Could not allocate memory. Memory full.");
+    UInt32 counter = 0;
+    UInt32 depth = 1;
+    stack[0] = 0;
+    stack[1] = first[0];
+    tree->pre[0] = counter++;
+    while(depth > 0) {
+        UInt32 block = stack[2 * (depth - 1)];
+        UInt32* next = &stack[2 * (depth - 1) + 1];
+        if(*next < first[block + 1]) {
+            UInt32 child = list[(*next)++];
+            tree->pre[child] = counter++;
+            stack[2 * depth] = child;
+            stack[2 * depth + 1] = first[child];
+            depth++;
+        } else {
+            tree->post[block] = counter++;
+            depth--;
+        }
+    }
+    free(stack);
+    free(children);
+}
+
+static void opt_dom_tree_free(OptDomTree* tree) {
+    free(tree->idom);
+    free(tree->pre);
+    free(tree->post);
+}
+
+static inline bool opt_dominates(OptDomTree* tree, UInt32 a, UInt32 b) {
+    return tree->pre[a] <= tree->pre[b] && tree->post[b] <= tree->post[a];
+}
+
+// Instructions whose value only depends on their operands (and payload)
+static bool opt_is_pure(IrOp op) {
+    switch(op) {
+        case IrOpConst: case IrOpConstFloat: case IrOpConstString: case IrOpNull: case IrOpZero: case IrOpFunc:
+        case IrOpGlobalAddr:
+        case IrOpAdd: case IrOpSub: case IrOpMul: case IrOpDiv: case IrOpMod:
+        case IrOpAnd: case IrOpOr: case IrOpXor: case IrOpShl: case IrOpShr: case IrOpNeg: case IrOpNot:
+        case IrOpEq: case IrOpNe: case IrOpLt: case IrOpLe: case IrOpGt: case IrOpGe: case IrOpIsNull:
+        case IrOpConvert:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static inline bool opt_is_commutative(IrOp op) {
+    switch(op) {
+        case IrOpAdd: case IrOpMul: case IrOpAnd: case IrOpOr: case IrOpXor: case IrOpEq: case IrOpNe:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// The operands of a pure instruction, with those of commutative ones in a canonical order
+static void opt_operands(IrFunc* func, IrValue value, IrValue* out) {
+    IrInst* inst = ir_inst(func, value);
+    for(UInt32 i = 0; i < inst->num_operands && i < 2; i++)
+        out[i] = ir_operand(func, value, i);
+    if(inst->num_operands == 2 && opt_is_commutative(cast(IrOp)inst->op) && out[0] > out[1]) {
+        IrValue tmp = out[0];
+        out[0] = out[1];
+        out[1] = tmp;
+    }
+}
+
+static UInt64 opt_value_hash(IrFunc* func, IrValue value) {
+    IrInst* inst = ir_inst(func, value);
+    UInt64 hash = (cast(UInt64)inst->op << 32) ^ inst->type;
+    IrValue operands[2] = { IR_NONE, IR_NONE };
+    opt_operands(func, value, operands);
+    hash = hash * 0x9E3779B97F4A7C15ULL ^ operands[0];
+    hash = hash * 0x9E3779B97F4A7C15ULL ^ operands[1];
+    switch(inst->op) {
+        case IrOpConst: case IrOpConstFloat: hash = hash * 0x9E3779B97F4A7C15ULL ^ inst->imm; break;
+        case IrOpConstString: hash = hash * 0x9E3779B97F4A7C15ULL ^ inst->str->len; break;
+        case IrOpFunc: case IrOpGlobalAddr:
+            hash = hash * 0x9E3779B97F4A7C15ULL ^ cast(UInt64)cast(uintptr_t)inst->symbol;
+            break;
+        default: break;
+    }
+    return hash ^ (hash >> 29);
+}
+
+static bool opt_values_equal(IrFunc* func, IrValue a, IrValue b) {
+    IrInst* x = ir_inst(func, a);
+    IrInst* y = ir_inst(func, b);
+    if(x->op != y->op || x->type != y->type || x->num_operands != y->num_operands)
+        return false;
+    IrValue xs[2] = { IR_NONE, IR_NONE };
+    IrValue ys[2] = { IR_NONE, IR_NONE };
+    opt_operands(func, a, xs);
+    opt_operands(func, b, ys);
+    if(xs[0] != ys[0] || xs[1] != ys[1])
+        return false;
+    switch(x->op) {
+        // Floats are compared bit by bit (so 0.0 and -0.0 are different)
+        case IrOpConst: case IrOpConstFloat: return x->imm == y->imm;
+        case IrOpConstString: return x->str->len == y->str->len && memcmp(x->str->data, y->str->data, x->str->len) == 0;
+        case IrOpFunc: case IrOpGlobalAddr: return x->symbol == y->symbol;
+        default: return true;
+    }
+}
+
+// Global value numbering: the blocks are visited in reverse postorder (so dominators come first), and an instruction
+// is replaced by an equal one that dominates it. Every hash bucket is a chain of all candidates, so nothing ever
+// needs to be removed from the table when leaving a subtree of the dominator tree - candidates that don't dominate
+// are simply skipped.
+static UInt64 opt_cse(IrFunc* func) {
+    UInt64 num_insts = vec_size(func->insts);
+    UInt64 capacity = 16;
+    while(capacity < 2 * num_insts)
+        capacity *= 2;
+    UInt32* heads = cast(UInt32*)malloc(capacity * sizeof(UInt32));
+    UInt32* next = cast(UInt32*)malloc((num_insts + 1) * sizeof(UInt32));
+    CORETEN_ENFORCE(SOME(heads) && SOME(next), "Could not allocate memory. Memory full.");
+    for(UInt64 i = 0; i < capacity; i++)
+        heads[i] = IR_NONE;
+
+    OptDomTree tree;
+    opt_dom_tree(func, &tree);
+
+    UInt64 changes = 0;
+    for(UInt64 i = 0; i < vec_size(func->blocks); i++) {
+        Vec* insts = ir_block(func, cast(UInt32)i)->insts;
+        for(UInt64 j = 0; j < vec_size(insts); j++) {
+            IrValue value = opt_at(insts, j);
+            if(!opt_is_pure(cast(IrOp)ir_inst(func, value)->op))
+                continue;
+
+            UInt64 bucket = opt_value_hash(func, value) & (capacity - 1);
+            IrValue found = IR_NONE;
+            for(IrValue candidate = heads[bucket]; candidate != IR_NONE; candidate = next[candidate]) {
+                if(opt_dominates(&tree, ir_inst(func, candidate)->block, cast(UInt32)i) &&
+                   opt_values_equal(func, candidate, value)) {
+                    found = candidate;
+                    break;
+                }
+            }
+            if(found != IR_NONE) {
+                opt_replace(func, value, found);
+                changes++;
+            } else {
+                next[value] = heads[bucket];
+                heads[bucket] = value;
+            }
+        }
+    }
+
+    opt_dom_tree_free(&tree);
+    free(heads);
+    free(next);
+    opt_compact(func);
+    return changes;
+}
+
+// Dead code elimination -------------------------------------------------------------------------------------------
+
+static bool opt_has_side_effects(IrOp op) {
+    switch(op) {
+        case IrOpStore: case IrOpStoreGlobal: case IrOpTensorPush: case IrOpTensorSet: case IrOpBoundsCheck:
+        case IrOpTensorSlice: case IrOpTensorSort: case IrOpTensorSortByKey: case IrOpCall:
+        case IrOpJump: case IrOpBranch: case IrOpReturn: case IrOpUnreachable:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Merge blocks into their only predecessor, if it always jumps to them. Returns the number of blocks merged.
+static UInt64 opt_merge_blocks(IrFunc* func) {
+    UInt64 merged = 0;
+    for(UInt32 a = 0; a < vec_size(func->blocks); a++) {
+        for(;;) {
+            // Blocks that were merged into another one are empty
+            Vec* insts = ir_block(func, a)->insts;
+            if(vec_size(insts) == 0)
+                break;
+            IrValue jump = opt_at(insts, vec_size(insts) - 1);
+            if(ir_inst(func, jump)->op != IrOpJump)
+                break;
+            UInt32 b = ir_inst(func, jump)->targets[0];
+            if(b == a || b == 0 || vec_size(ir_block(func, b)->preds) != 1)
+                break;
+
+            // The phis of `b` have a single operand
+            Vec* phis = ir_block(func, b)->phis;
+            for(UInt64 i = 0; i < vec_size(phis); i++) {
+                IrValue phi = opt_at(phis, i);
+                opt_replace(func, phi, ir_operand(func, phi, 0));
+            }
+            vec_clear(phis);
+
+            ir_kill(func, jump);
+            vec_pop(ir_block(func, a)->insts);
+            Vec* moved = ir_block(func, b)->insts;
+            for(UInt64 i = 0; i < vec_size(moved); i++) {
+                IrValue value = opt_at(moved, i);
+                ir_inst(func, value)->block = a;
+                vec_push(ir_block(func, a)->insts, &value);
+            }
+            vec_clear(moved);
+            vec_clear(ir_block(func, b)->preds);
+
+            // The successors of `b` are now reached from `a`
+            UInt32 succs[2];
+            UInt32 num_succs = ir_successors(func, a, succs);
+            for(UInt32 i = 0; i < num_succs; i++) {
+                if(i == 1 && succs[1] == succs[0])
+                    break;
+                Vec* preds = ir_block(func, succs[i])->preds;
+                for(UInt64 j = 0; j < vec_size(preds); j++)
+                    if(*cast(UInt32*)vec_at(preds, j) == b)
+                        *cast(UInt32*)vec_at(preds, j) = a;
+            }
+            merged++;
+        }
+    }
+    return merged;
+}
+
+// Locals whose address is taken but that are only ever stored to
+static UInt64 opt_remove_dead_stores(IrFunc* func) {
+    UInt64 removed = 0;
+    for(UInt64 i = 0; i < vec_size(func->blocks); i++) {
+        Vec* insts = ir_block(func, cast(UInt32)i)->insts;
+        for(UInt64 j = 0; j < vec_size(insts); j++) {
+            IrValue slot = opt_at(insts, j);
+            if(ir_inst(func, slot)->op != IrOpSlot)
+                continue;
+
+            bool only_stored = true;
+            for(UInt32 use = ir_inst(func, slot)->uses; use != IR_NONE && only_stored;) {
+                IrUse* u = cast(IrUse*)vec_at(func->uses, use);
+                IrInst* user = ir_inst(func, u->user);
+                only_stored = user->op == IrOpStore && u->operand == user->operands;
+                use = u->next;
+            }
+            if(!only_stored)
+                continue;
+            while(ir_inst(func, slot)->uses != IR_NONE) {
+                ir_kill(func, (cast(IrUse*)vec_at(func->uses, ir_inst(func, slot)->uses))->user);
+                removed++;
+            }
+        }
+    }
+    return removed;
+}
+
+static UInt64 opt_dce(IrFunc* func) {
+    UInt64 num_blocks = vec_size(func->blocks);
+    UInt64 changes = opt_merge_blocks(func) + opt_remove_dead_stores(func);
+
+    // Everything with a side effect is live, and so is everything a live instruction uses
+    UInt64 num_insts = vec_size(func->insts);
+    bool* is_live = cast(bool*)calloc(num_insts + 1, sizeof(bool));
+    IrValue* worklist = cast(IrValue*)malloc((num_insts + 1) * sizeof(IrValue));
+    CORETEN_ENFORCE(SOME(is_live) && SOME(worklist), "Could not allocate memory. Memory full.");
+    UInt64 num_work = 0;
+    for(UInt64 i = 0; i < vec_size(func->blocks); i++) {
+        Vec* insts = ir_block(func, cast(UInt32)i)->insts;
+        for(UInt64 j = 0; j < vec_size(insts); j++) {
+            IrValue value = opt_at(insts, j);
+            if(opt_has_side_effects(cast(IrOp)ir_inst(func, value)->op)) {
+                is_live[value] = true;
+                worklist[num_work++] = value;
+            }
+        }
+    }
+    while(num_work > 0) {
+        IrValue value = worklist[--num_work];
+        UInt32 num_operands = ir_inst(func, value)->num_operands;
+        for(UInt32 i = 0; i < num_operands; i++) {
+            IrValue operand = ir_operand(func, value, i);
+            if(operand != IR_NONE && !is_live[operand]) {
+                is_live[operand] = true;
+                worklist[num_work++] = operand;
+            }
+        }
+    }
+
+    for(UInt64 i = 0; i < vec_size(func->blocks); i++) {
+        IrBlock* block = ir_block(func, cast(UInt32)i);
+        Vec* lists[2] = { block->phis, block->insts };
+        for(UInt32 l = 0; l < 2; l++) {
+            for(UInt64 j = 0; j < vec_size(lists[l]); j++) {
+                IrValue value = opt_at(lists[l], j);
+                if(!is_live[value] && ir_inst(func, value)->op != IrOpNop) {
+                    ir_kill(func, value);
+                    changes++;
+                }
+            }
+        }
+    }
+    free(is_live);
+    free(worklist);
+
+    opt_compact(func);
+    ir_order_blocks(func);
+    return changes + num_blocks - vec_size(func->blocks);
+}
+
+// Passes ----------------------------------------------------------------------------------------------------------
+
+UInt64 opt_run_pass(IrFunc* func, OptPass pass) {
+    if(vec_size(func->blocks) == 0)
+        return 0;
+    switch(pass) {
+        case OptPassFold: return opt_fold(func);
+        case OptPassCSE: return opt_cse(func);
+        case OptPassDCE: return opt_dce(func);
+        default:
+            CORETEN_ENFORCE(false, "`inline` only runs on a whole module");
+            return 0;
+    }
+}
+
+static UInt64 opt_timed(IrFunc* func, OptPass pass, OptStats* stats) {
+    double start = clock_monotonic();
+    UInt64 changes = opt_run_pass(func, pass);
+    if(SOME(stats)) {
+        stats->passes[pass].runs++;
+        stats->passes[pass].changes += changes;
+        stats->passes[pass].seconds += clock_monotonic() - start;
+    }
+    return changes;
+}
+
+void opt_func(IrFunc* func, OptStats* stats) {
+    if(vec_size(func->blocks) == 0)
+        return;
+    // Each pass can expose more work for the others (a folded branch leaves dead code, CSE makes operands equal, ...)
+    for(UInt32 round = 0; round < 4; round++) {
+        UInt64 changes = opt_timed(func, OptPassFold, stats);
+        changes += opt_timed(func, OptPassCSE, stats);
+        changes += opt_timed(func, OptPassDCE, stats);
+        if(changes == 0)
+            break;
+    }
+}
+
+// Inlining --------------------------------------------------------------------------------------------------------
+
+// The function `call` calls, if it's known
+static IrFunc* opt_callee(IrModule* module, IrFunc* func, IrValue call) {
+    IrInst* callee = ir_inst(func, ir_operand(func, call, 0));
+    if(callee->op != IrOpFunc)
+        return null;
+    return *cast(IrFunc**)vec_at(module->funcs, callee->symbol->unit);
+}
+
+static UInt64 opt_func_size(IrFunc* func) {
+    UInt64 size = 0;
+    for(UInt64 i = 0; i < vec_size(func->blocks); i++) {
+        IrBlock* block = ir_block(func, cast(UInt32)i);
+        size += vec_size(block->phis) + vec_size(block->insts);
+    }
+    return size;
+}
+
+static bool opt_should_inline(IrFunc* caller, IrFunc* callee) {
+    if(callee == caller || vec_size(callee->blocks) == 0 || callee->symbol->type->is_variadic)
+        return false;
+    // The entry is jumped to from the caller, so nothing else may jump to it
+    if(vec_size(ir_block(callee, 0)->preds) > 0)
+        return false;
+
+    // Callees that never return aren't worth it
+    bool returns = false;
+    for(UInt64 i = 0; i < vec_size(callee->blocks) && !returns; i++) {
+        Vec* insts = ir_block(callee, cast(UInt32)i)->insts;
+        returns = ir_inst(callee, opt_at(insts, vec_size(insts) - 1))->op == IrOpReturn;
+    }
+    if(!returns)
+        return false;
+
+    AstNodeFuncDecl* decl = callee->symbol->decl->data.decl->func_decl;
+    if(decl->is_noinline)
+        return false;
+    if(decl->is_inline)
+        return true;
+    return opt_func_size(callee) <= OPT_INLINE_THRESHOLD && opt_func_size(caller) <= OPT_MAX_FUNC_SIZE;
+}
+
+// Copy the body of `callee` into `func` in place of `call`
+static void opt_inline_call(IrFunc* func, IrValue call, IrFunc* callee) {
+    UInt32 block = ir_inst(func, call)->block;
+    Vec* insts = ir_block(func, block)->insts;
+    UInt64 position = 0;
+    while(opt_at(insts, position) != call)
+        position++;
+
+    // Split the block after the call: the rest goes into `cont`, where the inlined returns jump to
+    UInt32 cont = ir_add_block(func);
+    insts = ir_block(func, block)->insts;
+    for(UInt64 i = position + 1; i < vec_size(insts); i++) {
+        IrValue value = opt_at(insts, i);
+        ir_inst(func, value)->block = cont;
+        vec_push(ir_block(func, cont)->insts, &value);
+    }
+    insts->core.len = position;
+    UInt32 succs[2];
+    UInt32 num_succs = ir_successors(func, cont, succs);
+    for(UInt32 i = 0; i < num_succs; i++) {
+        Vec* preds = ir_block(func, succs[i])->preds;
+        for(UInt64 j = 0; j < vec_size(preds); j++)
+            if(*cast(UInt32*)vec_at(preds, j) == block)
+                *cast(UInt32*)vec_at(preds, j) = cont;
+    }
+
+    // Copy the blocks and instructions. Operands are set once every value has a copy, since phis can refer to values
+    // that come later.
+    UInt32 base = cast(UInt32)vec_size(func->blocks);
+    UInt32 num_blocks = cast(UInt32)vec_size(callee->blocks);
+    UInt64 num_insts = vec_size(callee->insts);
+    IrValue* map = cast(IrValue*)malloc((num_insts + 1) * sizeof(IrValue));
+    CORETEN_ENFORCE_NN(map, "Could not allocate memory. Memory full.");
+    for(UInt32 i = 0; i < num_blocks; i++) {
+        UInt32 copy = ir_add_block(func);
+        Vec* preds = ir_block(callee, i)->preds;
+        for(UInt64 j = 0; j < vec_size(preds); j++) {
+            UInt32 pred = base + *cast(UInt32*)vec_at(preds, j);
+            vec_push(ir_block(func, copy)->preds, &pred);
+        }
+    }
+
+    Vec* returns = VEC_NEW(IrValue, 4);     // the `return`s of the callee
+    for(UInt32 i = 0; i < num_blocks; i++) {
+        IrBlock* from = ir_block(callee, i);
+        Vec* lists[2] = { from->phis, from->insts };
+        for(UInt32 l = 0; l < 2; l++) {
+            for(UInt64 j = 0; j < vec_size(lists[l]); j++) {
+                IrValue value = opt_at(lists[l], j);
+                IrInst inst = *ir_inst(callee, value);
+                if(inst.op == IrOpParam) {
+                    map[value] = ir_operand(func, call, cast(UInt32)inst.imm + 1);
+                    continue;
+                }
+                bool is_return = inst.op == IrOpReturn;
+                if(is_return) {
+                    vec_push(returns, &value);
+                    inst.op = IrOpJump;
+                    inst.num_operands = 0;
+                }
+                IrValue copy = ir_new_inst(func, base + i, cast(IrOp)inst.op, inst.type);
+                IrInst* to = ir_inst(func, copy);
+                to->imm = inst.imm;
+                if(is_return) {
+                    to->targets[0] = cont;
+                } else if(inst.op == IrOpJump || inst.op == IrOpBranch) {
+                    to->targets[0] = base + inst.targets[0];
+                    to->targets[1] = base + inst.targets[1];
+                }
+                ir_alloc_operands(func, copy, inst.num_operands);
+                vec_push(l == 0 ? ir_block(func, base + i)->phis : ir_block(func, base + i)->insts, &copy);
+                map[value] = copy;
+            }
+        }
+    }
+    for(UInt32 i = 0; i < num_blocks; i++) {
+        IrBlock* from = ir_block(callee, i);
+        Vec* lists[2] = { from->phis, from->insts };
+        for(UInt32 l = 0; l < 2; l++) {
+            for(UInt64 j = 0; j < vec_size(lists[l]); j++) {
+                IrValue value = opt_at(lists[l], j);
+                IrInst* inst = ir_inst(callee, value);
+                if(inst->op == IrOpParam || inst->op == IrOpReturn)
+                    continue;
+                for(UInt32 k = 0; k < inst->num_operands; k++)
+                    ir_set_operand(func, map[value], k, map[ir_operand(callee, value, k)]);
+            }
+        }
+    }
+
+    // The returns jump to `cont`, and the call's value is whatever they return
+    IrValue result = IR_NONE;
+    TypeId type = ir_inst(func, call)->type;
+    if(type != TYPE_ID_NONE && vec_size(returns) > 1) {
+        result = ir_new_inst(func, cont, IrOpPhi, type);
+        vec_push(ir_block(func, cont)->phis, &result);
+        ir_alloc_operands(func, result, cast(UInt32)vec_size(returns));
+    }
+    for(UInt64 i = 0; i < vec_size(returns); i++) {
+        IrValue ret = opt_at(returns, i);
+        UInt32 from = base + ir_inst(callee, ret)->block;
+        vec_push(ir_block(func, cont)->preds, &from);
+        if(type == TYPE_ID_NONE)
+            continue;
+        IrValue value = map[ir_operand(callee, ret, 0)];
+        if(result != IR_NONE && vec_size(returns) > 1)
+            ir_set_operand(func, result, cast(UInt32)i, value);
+        else
+            result = value;
+    }
+    if(type != TYPE_ID_NONE)
+        ir_replace_uses(func, call, result);
+    ir_kill(func, call);
+
+    // Jump from the call to the callee's entry
+    IrValue jump = ir_new_inst(func, block, IrOpJump, TYPE_ID_NONE);
+    ir_inst(func, jump)->targets[0] = base;
+    vec_push(ir_block(func, block)->insts, &jump);
+    vec_push(ir_block(func, base)->preds, &block);
+
+    vec_free(returns);
+    free(map);
+}
+
+// Inline into `func` (once its callees have been optimized). Returns the number of calls inlined.
+static UInt64 opt_inline_into(IrModule* module, IrFunc* func) {
+    // Only the calls that were there to begin with: calls in inlined code aren't inlined again
+    Vec* calls = VEC_NEW(IrValue, 8);
+    for(UInt64 i = 0; i < vec_size(func->blocks); i++) {
+        Vec* insts = ir_block(func, cast(UInt32)i)->insts;
+        for(UInt64 j = 0; j < vec_size(insts); j++) {
+            IrValue value = opt_at(insts, j);
+            if(ir_inst(func, value)->op == IrOpCall && SOME(opt_callee(module, func, value)))
+                vec_push(calls, &value);
+        }
+    }
+
+    UInt64 inlined = 0;
+    for(UInt64 i = 0; i < vec_size(calls); i++) {
+        IrValue call = opt_at(calls, i);
+        IrFunc* callee = opt_callee(module, func, call);
+        if(!opt_should_inline(func, callee))
+            continue;
+        opt_inline_call(func, call, callee);
+        inlined++;
+    }
+    vec_free(calls);
+    if(inlined > 0)
+        ir_order_blocks(func);
+    return inlined;
+}
+
+// Functions in an order where callees come before their callers (except in cycles)
+static UInt32* opt_callees_first(IrModule* module) {
+    UInt32 num_funcs = cast(UInt32)vec_size(module->funcs);
+    UInt32* order = cast(UInt32*)malloc((num_funcs + 1) * sizeof(UInt32));
+    UInt32* stack = cast(UInt32*)malloc((2 * num_funcs + 1) * sizeof(UInt32));
+    bool* is_visited = cast(bool*)calloc(num_funcs + 1, sizeof(bool));
+    CORETEN_ENFORCE(SOME(order) && SOME(stack) && SOME(is_visited), "Could not allocate memory. Memory full.");
+
+    // Callees of every function, as a flat list
+    Vec* callees = VEC_NEW(UInt32, 16);
+    UInt32* first = cast(UInt32*)malloc((num_funcs + 1) * sizeof(UInt32));
+    CORETEN_ENFORCE_NN(first, "Could not allocate memory. Memory full.");
+    for(UInt32 f = 0; f < num_funcs; f++) {
+        first[f] = cast(UInt32)vec_size(callees);
+        IrFunc* func = *cast(IrFunc**)vec_at(module->funcs, f);
+        for(UInt64 i = 0; i < vec_size(func->blocks); i++) {
+            Vec* insts = ir_block(func, cast(UInt32)i)->insts;
+            for(UInt64 j = 0; j < vec_size(insts); j++) {
+                IrValue value = opt_at(insts, j);
+                if(ir_inst(func, value)->op != IrOpCall)
+                    continue;
+                IrInst* callee = ir_inst(func, ir_operand(func, value, 0));
+                if(callee->op == IrOpFunc)
+                    vec_push(callees, &callee->symbol->unit);
+            }
+        }
+    }
+    first[num_funcs] = cast(UInt32)vec_size(callees);
+
+    UInt32 num_ordered = 0;
+    for(UInt32 root = 0; root < num_funcs; root++) {
+        if(is_visited[root])
+            continue;
+        is_visited[root] = true;
+        UInt32 depth = 1;
+        stack[0] = root;
+        stack[1] = first[root];
+        while(depth > 0) {
+            UInt32 f = stack[2 * (depth - 1)];
+            UInt32* next = &stack[2 * (depth - 1) + 1];
+            if(*next < first[f + 1]) {
+                UInt32 callee = *cast(UInt32*)vec_at(callees, (*next)++);
+                if(!is_visited[callee]) {
+                    is_visited[callee] = true;
+                    stack[2 * depth] = callee;
+                    stack[2 * depth + 1] = first[callee];
+                    depth++;
+                }
+            } else {
+                order[num_ordered++] = f;
+                depth--;
+            }
+        }
+    }
+
+    vec_free(callees);
+    free(first);
+    free(stack);
+    free(is_visited);
+    return order;
+}
+
+typedef struct {
+    IrModule* module;
+    OptStats* stats;    // one for every function
+} OptCtx;
+
+static void opt_func_task(void* arg, UInt64 index, UInt32 worker) {
+    OptCtx* ctx = cast(OptCtx*)arg;
+    opt_func(*cast(IrFunc**)vec_at(ctx->module->funcs, index), &ctx->stats[index]);
+}
+
+void opt_module(IrModule* module, OptStats* stats) {
+    UInt64 num_funcs = vec_size(module->funcs);
+    OptCtx ctx;
+    ctx.module = module;
+    ctx.stats = cast(OptStats*)calloc(num_funcs + 1, sizeof(OptStats));
+    CORETEN_ENFORCE_NN(ctx.stats, "Could not allocate memory. Memory full.");
+    threadpool_parallel_for(module->checker->pool, num_funcs, opt_func_task, &ctx);
+
+    // Inlining depends on the (optimized) callees, so it's done serially
+    UInt32* order = opt_callees_first(module);
+    for(UInt64 i = 0; i < num_funcs; i++) {
+        IrFunc* func = *cast(IrFunc**)vec_at(module->funcs, order[i]);
+        OptStats* func_stats = &ctx.stats[order[i]];
+        double start = clock_monotonic();
+        UInt64 inlined = opt_inline_into(module, func);
+        func_stats->passes[OptPassInline].runs++;
+        func_stats->passes[OptPassInline].changes += inlined;
+        func_stats->passes[OptPassInline].seconds += clock_monotonic() - start;
+        if(inlined > 0)
+            opt_func(func, func_stats);
+    }
+    free(order);
+
+    // Summed in a fixed order, so the statistics (other than the timings) don't depend on the number of threads
+    for(UInt64 i = 0; SOME(stats) && i < num_funcs; i++) {
+        for(UInt32 p = 0; p < OptPassCount; p++) {
+            stats->passes[p].runs += ctx.stats[i].passes[p].runs;
+            stats->passes[p].changes += ctx.stats[i].passes[p].changes;
+            stats->passes[p].seconds += ctx.stats[i].passes[p].seconds;
+        }
+    }
+    free(ctx.stats);
+}
+
+void opt_print_stats(OptStats* stats, FILE* out) {
+    fprintf(out, "%-8s %8s %10s %12s\n", "pass", "runs", "changes", "time (ms)");
+    double total = 0;
+    for(UInt32 p = 0; p < OptPassCount; p++) {
+        OptPassStats* pass = &stats->passes[p];
+        fprintf(out, "%-8s %8" CORETEN_PRIu64 " %10" CORETEN_PRIu64 " %12.3f\n", opt_pass_name(cast(OptPass)p),
+                pass->runs, pass->changes, pass->seconds * 1000);
+        total += pass->seconds;
+    }
+    fprintf(out, "%-8s %8s %10s %12.3f\n", "total", "", "", total * 1000);
+}
@@ -0,0 +1,85 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#ifndef ADORAD_OPT_H
+#define ADORAD_OPT_H
+
+#include <stdio.h>
+#include <adorad/core/types.h>
+#include <adorad/compiler/ir.h>
+
+/*
+    The optimizer. Every pass works on the IR of one function at a time:
+        - `fold`: constant folding and propagation (arithmetic, comparisons and conversions of constants, algebraic
+          identities, trivial phis, and branches on constants - which makes the untaken side unreachable).
+        - `cse`: common subexpression elimination by (dominator-based) global value numbering. Only instructions
+          without side effects are numbered.
+        - `dce`: dead code elimination. Removes instructions nothing (with a side effect) depends on, merges blocks
+          into their only predecessor, and drops unreachable blocks.
+        - `inline`: copies the bodies of small callees into their callers. `[inline]` functions are always inlined
+          (regardless of their size), and `[noinline]` ones never are. Functions are never inlined into themselves.
+
+    `opt_module()` first runs the function-local passes on every function in parallel (on the checker's thread pool),
+    and then inlines, callees first - so a callee is always optimized (and has had its own calls inlined) before it's
+    copied anywhere. Callers that something was inlined into are optimized again.
+*/
+
+// Functions with at most this many instructions are inlined (unless they're `[noinline]`)
+#define OPT_INLINE_THRESHOLD    24
+// Inlining stops once the caller has grown to this many instructions (`[inline]` callees are still inlined)
+#define OPT_MAX_FUNC_SIZE       4096
+
+typedef enum OptPass {
+    OptPassFold,
+    OptPassCSE,
+    OptPassDCE,
+    OptPassInline,
+    OptPassCount
+} OptPass;
+
+typedef struct OptPassStats {
+    UInt64 runs;        // number of times the pass ran (on some function)
+    UInt64 changes;     // instructions folded/replaced/removed (and blocks merged or removed), or calls inlined
+    double seconds;     // total time spent in the pass, summed over all threads
+} OptPassStats;
+
+typedef struct OptStats {
+    OptPassStats passes[OptPassCount];
+} OptStats;
+
+// Optimize every function of `module`. `stats` can be null; otherwise the statistics are added to it.
+void opt_module(IrModule* module, OptStats* stats);
+// Run the function-local passes (everything but `inline`) on `func`, until they stop changing anything
+void opt_func(IrFunc* func, OptStats* stats);
+// Run a single pass on `func`. Returns the number of changes. `inline` can't run on its own, since it needs a module.
+UInt64 opt_run_pass(IrFunc* func, OptPass pass);
+
+// Constant arithmetic, the way the target does it (shared with the compile-time evaluator).
+//
+// The number of bits in a value of `type`, or 0 if it isn't an integer (or a `Bool`)
+UInt32 opt_int_bits(Type* type);
+// `value` truncated to `type`, and sign- or zero-extended to 64 bits
+UInt64 opt_normalize(Type* type, UInt64 value);
+// `value` rounded to `type` (`Float32` or `Float64`)
+double opt_round(Type* type, double value);
+bool opt_compare_int(IrOp op, bool is_signed, UInt64 a, UInt64 b);
+bool opt_compare_float(IrOp op, double a, double b);
+// `a op b`. Returns false if it's undefined (division by zero, shifting by too much) or `op` isn't arithmetic.
+bool opt_fold_int(IrOp op, Type* type, UInt64 a, UInt64 b, UInt64* out);
+bool opt_fold_float(IrOp op, double a, double b, double* out);
+
+const char* opt_pass_name(OptPass pass);
+// Write a table of per-pass statistics to `out`
+void opt_print_stats(OptStats* stats, FILE* out);
+
+#endif // ADORAD_OPT_H
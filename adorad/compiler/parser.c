@@ -27,6 +27,7 @@ Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
         TODO
 */
 
+#include <string.h>
 #include <adorad/compiler/ast.h>
 #include <adorad/compiler/parser.h>
 #include <adorad/core/debug.h>
@@ -65,9 +66,19 @@ Parser* parser_init(Lexer* lexer) {
     parser->fullpath = lexer->loc->fname;
     // Generally, the ratio of lexer tokens to parser nodes is about 4:1
     // So, preallocate roughly 25% of the number of lexer tokens
-    parser->nodelist = VEC_NEW(AstNode, cast(UInt64)(vec_size(lexer->toklist) * .25));
+    parser->nodelist = VEC_NEW(AstNode, cast(UInt64)(vec_size(lexer->toklist) * .25) + 1);
+    parser->spans = VEC_NEW(ParserSpan, vec_cap(parser->nodelist));
     parser->lexer = lexer;
-    parser->toklist = lexer->toklist;
+    // Comments are of no use to the grammar, so the Parser works on a copy of the token list without them
+    parser->toklist = VEC_NEW(Token, vec_size(lexer->toklist) + 1);
+    for(UInt64 i = 0; i < vec_size(lexer->toklist); i++) {
+        Token* tok = cast(Token*)vec_at(lexer->toklist, i);
+        if(tok->kind != COMMENT && tok->kind != DOCS_COMMENT)
+            vec_push(parser->toklist, tok);
+    }
+    CORETEN_ENFORCE(vec_size(parser->toklist) > 0 &&
+                    (cast(Token*)vec_at(parser->toklist, vec_size(parser->toklist) - 1))->kind == TOK_EOF,
+                    "Expected the token list to end with TOK_EOF");
     parser->curr_tok = cast(Token*)vec_at(parser->toklist, 0);
     parser->offset = 0;
     parser->num_tokens = vec_size(parser->toklist);
@@ -80,17 +91,19 @@ static inline Token* parser_peek_next(Parser* parser) {
     if(parser->offset + 1 >= parser->num_tokens)
         return null;
 
-    return cast(Token*)(parser->toklist + parser->offset + 1);
+    return parser->curr_tok + 1;
 }
 
-// Consumes a token and moves on to the next `n` tokens
+// Consumes `n` tokens and returns the first of them (the current token).
+// Never moves past the final `TOK_EOF` token.
 static inline Token* parser_chomp(Parser* parser, UInt64 n) {
+    Token* tok = parser->curr_tok;
     if(parser->offset + n >= parser->num_tokens)
-        return null;
+        n = parser->num_tokens - 1 - parser->offset;
 
     parser->offset += n;
     parser->curr_tok += n;
-    return cast(Token*)parser->curr_tok;
+    return tok;
 }
 
 // Expect the current token's kind to match `tokenkind`.
@@ -131,13 +144,163 @@ static inline void parser_put_back(Parser* parser) {
     parser->offset -= 1;
 }
 
+static inline void* ast_alloc(UInt64 size) {
+    void* mem = calloc(1, size);
+    CORETEN_ENFORCE_NN(mem, "Could not allocate memory. Memory full.");
+    return mem;
+}
+
+#define AST_ALLOC(field)        (field) = ast_alloc(sizeof(*(field)))
+
+// Create a new AstNode of kind `kind`, along with the (zeroed) payload that `kind` is accessed through.
 AstNode* ast_create_node(AstNodeKind kind) {
-    AstNode* node = cast(AstNode*)calloc(1, sizeof(AstNode));
+    AstNode* node = cast(AstNode*)ast_alloc(sizeof(AstNode));
     node->kind = kind;
+
+    switch(kind) {
+        case AstNodeKindIdentifier: AST_ALLOC(node->data.identifier); break;
+        case AstNodeKindFuncDecl:
+            AST_ALLOC(node->data.decl);
+            AST_ALLOC(node->data.decl->func_decl);
+            break;
+        case AstNodeKindVariableDecl:
+            AST_ALLOC(node->data.scope_obj);
+            AST_ALLOC(node->data.scope_obj->var);
+            break;
+        case AstNodeKindTypeDecl: AST_ALLOC(node->data.type_decl); break;
+
+        // Literals
+        case AstNodeKindIntLiteral:
+            AST_ALLOC(node->data.literal);
+            AST_ALLOC(node->data.literal->int_value);
+            break;
+        case AstNodeKindFloatLiteral:
+            AST_ALLOC(node->data.literal);
+            AST_ALLOC(node->data.literal->float_value);
+            break;
+        case AstNodeKindCharLiteral:
+            AST_ALLOC(node->data.literal);
+            AST_ALLOC(node->data.literal->char_value);
+            break;
+        case AstNodeKindStringLiteral:
+            AST_ALLOC(node->data.literal);
+            AST_ALLOC(node->data.literal->str_value);
+            break;
+        case AstNodeKindBoolLiteral:
+            AST_ALLOC(node->data.literal);
+            AST_ALLOC(node->data.literal->bool_value);
+            break;
+
+        // Statements
+        case AstNodeKindBlock:
+            AST_ALLOC(node->data.stmt);
+            AST_ALLOC(node->data.stmt->block_stmt);
+            break;
+        case AstNodeKindBreak:
+        case AstNodeKindContinue:
+            AST_ALLOC(node->data.stmt);
+            AST_ALLOC(node->data.stmt->branch_stmt);
+            break;
+        case AstNodeKindDefer:
+            AST_ALLOC(node->data.stmt);
+            AST_ALLOC(node->data.stmt->defer_stmt);
+            break;
+        case AstNodeKindReturn:
+            AST_ALLOC(node->data.stmt);
+            AST_ALLOC(node->data.stmt->return_stmt);
+            break;
+        case AstNodeKindModuleStatement:
+            AST_ALLOC(node->data.stmt);
+            AST_ALLOC(node->data.stmt->module_stmt);
+            break;
+        case AstNodeKindUseStatement:
+            AST_ALLOC(node->data.stmt);
+            AST_ALLOC(node->data.stmt->use_stmt);
+            break;
+
+        // Expressions
+        case AstNodeKindFuncCallExpr:
+            AST_ALLOC(node->data.expr);
+            AST_ALLOC(node->data.expr->func_call_expr);
+            break;
+        case AstNodeKindIfExpr:
+            AST_ALLOC(node->data.expr);
+            AST_ALLOC(node->data.expr->if_expr);
+            break;
+        case AstNodeKindLoopInfExpr:
+            AST_ALLOC(node->data.expr);
+            AST_ALLOC(node->data.expr->loop_expr);
+            AST_ALLOC(node->data.expr->loop_expr->loop_inf_expr);
+            break;
+        case AstNodeKindLoopCExpr:
+            AST_ALLOC(node->data.expr);
+            AST_ALLOC(node->data.expr->loop_expr);
+            AST_ALLOC(node->data.expr->loop_expr->loop_c_expr);
+            break;
+        case AstNodeKindLoopInExpr:
+            AST_ALLOC(node->data.expr);
+            AST_ALLOC(node->data.expr->loop_expr);
+            AST_ALLOC(node->data.expr->loop_expr->loop_in_expr);
+            break;
+        case AstNodeKindMatchExpr:
+            AST_ALLOC(node->data.expr);
+            AST_ALLOC(node->data.expr->match_expr);
+            break;
+        case AstNodeKindMatchBranch:
+            AST_ALLOC(node->data.expr);
+            AST_ALLOC(node->data.expr->match_branch_expr);
+            break;
+        case AstNodeKindMatchRange:
+            AST_ALLOC(node->data.expr);
+            AST_ALLOC(node->data.expr->match_range_expr);
+            break;
+        case AstNodeKindCatchExpr:
+            AST_ALLOC(node->data.expr);
+            AST_ALLOC(node->data.expr->catch_expr);
+            break;
+        case AstNodeKindBinaryOpExpr:
+            AST_ALLOC(node->data.expr);
+            AST_ALLOC(node->data.expr->binary_op_expr);
+            break;
+        case AstNodeKindAttributeExpr:
+            AST_ALLOC(node->data.expr);
+            AST_ALLOC(node->data.expr->attr_expr);
+            break;
+        case AstNodeKindGroupedExpr:
+            AST_ALLOC(node->data.expr);
+            AST_ALLOC(node->data.expr->grouped_expr);
+            break;
+        case AstNodeKindTypeExpr:
+            AST_ALLOC(node->data.expr);
+            AST_ALLOC(node->data.expr->type_expr);
+            break;
+        case AstNodeKindInitExpr:
+        case AstNodeKindStructExpr:
+        case AstNodeKindArrayInitExpr:
+            AST_ALLOC(node->data.expr);
+            AST_ALLOC(node->data.expr->init_expr);
+            break;
+        case AstNodeKindSliceExpr:
+            AST_ALLOC(node->data.expr);
+            AST_ALLOC(node->data.expr->slice_expr);
+            break;
+        case AstNodeKindPrefixOpExpr: AST_ALLOC(node->data.prefix_op_expr); break;
+        case AstNodeKindFieldAccessExpr: AST_ALLOC(node->data.field_access_expr); break;
+        case AstNodeKindArrayAccessExpr: AST_ALLOC(node->data.array_access_expr); break;
+        case AstNodeKindArrayType: AST_ALLOC(node->data.array_type); break;
+        case AstNodeKindInferredArrayType: AST_ALLOC(node->data.inferred_array_type); break;
+
+        // Misc
+        case AstNodeKindParamDecl: AST_ALLOC(node->data.param_decl); break;
+        case AstNodeKindParamList: AST_ALLOC(node->data.param_list); break;
+        case AstNodeKindTopLevelComptime: AST_ALLOC(node->data.toplevel_comptime_expr); break;
+        default: break; // no payload
+    }
     return node;
 }
 
 static AstNode* ast_parse_root(Parser* parser);
+static AstNode* ast_parse_identifier(Parser* parser);
 static AstNode* ast_parse_string_literal(Parser* parser);
 static AstNode* ast_parse_suffix_op(Parser* parser);
 static AstNode* ast_parse_field_init(Parser* parser);
@@ -151,6 +314,7 @@ static AstNode* ast_parse_match_clause(Parser* );
 static AstNode* ast_parse_match_branch(Parser* parser);
 static AstNode* ast_parse_match_expr(Parser* parser);
 static AstNode* ast_parse_primary_type_expr(Parser* parser);
+static AstNode* ast_parse_suffix_expr(Parser* parser);
 static AstNode* ast_parse_brace_suffix_expr(Parser* parser);
 static AstNode* ast_parse_block(Parser* parser);
 static AstNode* ast_parse_primary_expr(Parser* parser);
@@ -224,6 +388,7 @@ static AstNode* ast_parse_module_statement(Parser* parser) {
     Token* semicolon = CHOMP_IF(SEMICOLON); // this is optional
 
     AstNode* node = ast_create_node(AstNodeKindModuleStatement);
+    node->loc = module_kwd->loc;
     node->data.stmt->module_stmt->name = module_name->value;
 
     return node;
@@ -254,6 +419,7 @@ static AstNode* ast_parse_use_statement(Parser* parser) {
     Token* semicolon = CHOMP_IF(SEMICOLON); // this is optional
 
     AstNode* node = ast_create_node(AstNodeKindUseStatement);
+    node->loc = use_kwd->loc;
     node->data.stmt->use_stmt->name = use_name->value;
     return node;
 }
@@ -266,33 +432,48 @@ static AstNode* ast_parse_use_statement(Parser* parser) {
 //      | put mutable y: &StructMutability = ...
 //      | put mutable z = 34
 static AstNode* ast_parse_variable_decl(Parser* parser) {
-    Token* comptime_attr = CHOMP_IF(ATTR_COMPTIME);
+    // `[comptime]` can decorate a function as well
+    Token* comptime_attr = null;
+    Token* next = parser_peek_next(parser);
+    if(pc->kind == ATTR_COMPTIME && SOME(next) && next->kind == PUT)
+        comptime_attr = CHOMP(1);
+
     Token* put_kwd = CHOMP_IF(PUT);
     if(NONE(put_kwd))
-        AST_EXPECTED("put keyword");
+        return null;
 
     Token* mutable_kwd = CHOMP_IF(MUTABLE);
 
-    AstNode* type_expr = ast_parse_type_expr(parser);
-    if(NONE(type_expr)) {
-        AST_EXPECTED("a type");
-    }
-
     Token* identifier = CHOMP_IF(IDENTIFIER);
     if(NONE(identifier))
         AST_EXPECTED("an identifier");
+
+    AstNode* type_expr = null;
+    Token* colon = CHOMP_IF(COLON);
+    if(SOME(colon)) {
+        type_expr = ast_parse_type_expr(parser);
+        if(NONE(type_expr))
+            AST_EXPECTED("a type");
+    }
     
     Token* equals = CHOMP_IF(EQUALS);
     AstNode* init_expr = null;
     if(SOME(equals)) {
         // Expect an expression
         init_expr = ast_parse_expr(parser);
+        if(NONE(init_expr))
+            AST_EXPECTED("an expression");
     }
+    if(NONE(type_expr) && NONE(init_expr))
+        AST_ERROR("Variable `%s` needs a type or an initial value", identifier->value->data);
 
     Token* semicolon = CHOMP_IF(SEMICOLON);
 
     AstNode* node = ast_create_node(AstNodeKindVariableDecl);
+    node->loc = identifier->loc;
+    node->data.scope_obj->name = identifier->value;
     node->data.scope_obj->var->name = identifier->value;
+    node->data.scope_obj->var->type_expr = type_expr;
     node->data.scope_obj->var->init_expr = init_expr;
     node->data.scope_obj->var->is_local = !parser->is_in_global_context;
     node->data.scope_obj->var->is_comptime = cast(bool)SOME(comptime_attr);
@@ -301,16 +482,21 @@ static AstNode* ast_parse_variable_decl(Parser* parser) {
 }
 
 // FuncDecl
-//      <Attributes> KEYWORD(export)? KEYWORD(func) IDENTIFIER? LPAREN ParamList RPAREN LARROW TypeExpr (SEMICOLON? / BLOCK)
+//      <Attributes> KEYWORD(export)? KEYWORD(func) IDENTIFIER? LPAREN ParamList RPAREN (RARROW TypeExpr)? (SEMICOLON? / BLOCK)
 // where <Attributes> can be one of:
 //      | ATTR_NORETURN
 //      | ATTR_COMPTIME
 //      | ATTR_INLINE
 //      | ATTR_NOINLINE
 //
+// A function without a return type returns `void`.
+//
 // Example:
 //      [comptime] func foo(arg1: UInt64, arg2: String) -> FooBarStruct { ... }
 static AstNode* ast_parse_func_decl(Parser* parser) {
+    if(!token_is_attribute(pc->kind) && pc->kind != EXPORT && pc->kind != FUNC)
+        return null;
+
     bool is_noreturn = false;
     bool is_comptime = false;
     bool is_inline = false;
@@ -342,23 +528,28 @@ func_no_attrs:;
     Token* identifier = CHOMP_IF(IDENTIFIER);
     AstNode* params = ast_parse_param_list(parser, &is_variadic);
     
-    Token* larrow = CHOMP_IF(LARROW);
-    AstNode* return_type_expr = ast_parse_type_expr(parser);
-    if(NONE(return_type_expr))
-        AST_EXPECTED("Return type expression. Use `void` if your function doesn't return anything");
-    if(NONE(larrow) && SOME(return_type_expr))
-        AST_EXPECTED("trailing `->` after function prototype");
+    AstNode* return_type_expr = null;
+    Token* rarrow = CHOMP_IF(RARROW);
+    if(SOME(rarrow)) {
+        return_type_expr = ast_parse_type_expr(parser);
+        if(NONE(return_type_expr))
+            AST_EXPECTED("Return type expression after `->`");
+    }
     
     bool no_body = false;
     AstNode* body = null;
     AstNode* node = ast_create_node(AstNodeKindFuncDecl);
+    node->loc = SOME(identifier) ? identifier->loc : func_kwd->loc;
+    bool was_in_global_context = parser->is_in_global_context;
     switch(pc->kind) {
         case SEMICOLON:
             CHOMP(1);
             no_body = true;
             break;
         case LBRACE:
+            parser->is_in_global_context = false;
             body = ast_parse_block(parser);
+            parser->is_in_global_context = was_in_global_context;
             if(NONE(body))
                 AST_EXPECTED("Expected a body");
             break;
@@ -366,7 +557,9 @@ func_no_attrs:;
             AST_EXPECTED("Semicolon or Function Body");
     } // switch
 
-    node->data.decl->func_decl->name = identifier->value;
+    node->data.decl->name = SOME(identifier) ? identifier->value : null;
+    node->data.decl->visibility = SOME(export_kwd) ? VisibilityModePublic : VisibilityModePrivate;
+    node->data.decl->func_decl->name = SOME(identifier) ? identifier->value : null;
     node->data.decl->func_decl->params = params;
     node->data.decl->func_decl->return_type = return_type_expr;
     node->data.decl->func_decl->no_body = no_body;
@@ -388,35 +581,35 @@ func_no_attrs:;
 //
 // Example:
 //      (arg1: Foo, arg2: Bar)
+//      (fmt: String, ...)
 static AstNode* ast_parse_param_list(Parser* parser, bool* is_variadic) {
     Token* lparen = EXPECT_TOK(LPAREN);
     bool seen_varargs = false;
     Vec* params = VEC_NEW(AstNode, 1);
-    while(true) {
-        if(NONE(CHOMP_IF(RPAREN)))
-            break;
-        AstNode* param = ast_parse_param_decl(parser);
-        if(SOME(param)) {
-            vec_push(params, param);
-        } else if((pc - 1)->kind == ELLIPSIS) {
+    while(NONE(CHOMP_IF(RPAREN))) {
+        if(seen_varargs)
+            AST_ERROR("`...` must be the last parameter");
+
+        Token* ellipsis = CHOMP_IF(ELLIPSIS);
+        if(SOME(ellipsis)) {
             seen_varargs = true;
+        } else {
+            AstNode* param = ast_parse_param_decl(parser);
+            if(NONE(param))
+                AST_EXPECTED("a parameter");
+            vec_push(params, param);
         }
 
         switch(pc->kind) {
             case COMMA: CHOMP(1); break;
-            case RPAREN: CHOMP(1); break;
-            case COLON: 
-            case RBRACE: 
-            case RSQUAREBRACK: 
-                AST_EXPECTED("RPAREN");
+            case RPAREN: break;
             default:
-                WARN("Expected comma");
-                break;
+                AST_EXPECTED("`,` or `)`");
         }
     }
 
     AstNode* node = ast_create_node(AstNodeKindParamList);
-    node->data.param_list->is_variadic = cast(bool)seen_varargs;
+    node->loc = lparen->loc;
     node->data.param_list->params = params;
     node->data.param_list->is_variadic = seen_varargs;
     *is_variadic = seen_varargs;
@@ -424,9 +617,22 @@ static AstNode* ast_parse_param_list(Parser* parser, bool* is_variadic) {
 }
 
 // ParamDecl
+//      IDENTIFIER COLON TypeExpr
 static AstNode* ast_parse_param_decl(Parser* parser) {
-    CORETEN_ENFORCE(false, "TODO");
-    return null;
+    Token* identifier = CHOMP_IF(IDENTIFIER);
+    if(NONE(identifier))
+        return null;
+
+    Token* colon = EXPECT_TOK(COLON);
+    AstNode* type_expr = ast_parse_type_expr(parser);
+    if(NONE(type_expr))
+        AST_EXPECTED("parameter type");
+
+    AstNode* node = ast_create_node(AstNodeKindParamDecl);
+    node->loc = identifier->loc;
+    node->data.param_decl->name = identifier->value;
+    node->data.param_decl->type = type_expr;
+    return node;
 }
 
 // Statement
@@ -437,6 +643,10 @@ static AstNode* ast_parse_param_decl(Parser* parser) {
 //      | MatchExpr
 //      | AssignmentExpr SEMICOLON?
 static AstNode* ast_parse_statement(Parser* parser) {
+    // End of the enclosing block
+    if(pc->kind == RBRACE)
+        return null;
+
     AstNode* var_decl = ast_parse_variable_decl(parser);
     if(SOME(var_decl))
         return var_decl;
@@ -454,8 +664,10 @@ static AstNode* ast_parse_statement(Parser* parser) {
         return match_expr;
     
     AstNode* assignment_expr = ast_parse_assignment_expr(parser);
-    if(SOME(assignment_expr))
+    if(SOME(assignment_expr)) {
+        Token* semicolon = CHOMP_IF(SEMICOLON); // this is optional
         return assignment_expr;
+    }
     
     WARN("Hmmm could not parse a suitable statement. Returning null");
     return null;
@@ -470,6 +682,8 @@ static AstNode* ast_parse_statement(Parser* parser) {
 //          name: BarBar
 //      }
 static AstNode* ast_parse_struct_decl(Parser* parser) {
+    if(pc->kind != STRUCT)
+        return null;
     CORETEN_ENFORCE(false, "TODO");
     return null;
 }
@@ -483,18 +697,20 @@ static AstNode* ast_parse_struct_decl(Parser* parser) {
 //          BarBar
 //      }
 static AstNode* ast_parse_enum_decl(Parser* parser) {
+    if(pc->kind != ENUM)
+        return null;
     CORETEN_ENFORCE(false, "TODO");
     return null;
 }
 
 // IfExpr
-//      | IfPrefix BlockExpr (KEYWORD(else) Statement)?
-//      | IfPrefix AssignmentExpr (SEMICOLON / KEYWORD(else) Statement)?
+//      | IfPrefix BlockExpr (KEYWORD(else) (IfExpr / BlockExpr))?
+//      | IfPrefix AssignmentExpr (SEMICOLON / KEYWORD(else) (IfExpr / BlockExpr))?
 // where IfPrefix is:
 //      KEYWORD(if) LPAREN? Expr RPAREN?
 // 
 // Example:
-//      if cond { ... } else { ... }
+//      if cond { ... } else if other_cond { ... } else { ... }
 static AstNode* ast_parse_if_expr(Parser* parser) {
     Token* if_token = CHOMP_IF(IF);
     if(NONE(if_token))
@@ -530,13 +746,17 @@ static AstNode* ast_parse_if_expr(Parser* parser) {
     
     AstNode* else_body = null;
     Token* else_kwd = CHOMP_IF(ELSE);
-    if(SOME(else_kwd))
-        else_body = ast_parse_block_expr(parser);
+    if(SOME(else_kwd)) {
+        else_body = pc->kind == IF ? ast_parse_if_expr(parser) : ast_parse_block_expr(parser);
+        if(NONE(else_body))
+            AST_EXPECTED("`if` or a block after `else`");
+    }
     
     if(NONE(else_body) && SOME(semicolon))
         AST_EXPECTED("Semicolon or `else` block");
 
     AstNode* node = ast_create_node(AstNodeKindIfExpr);
+    node->loc = if_token->loc;
     node->data.expr->if_expr->condition = condition;
     node->data.expr->if_expr->if_body = if_body;
     node->data.expr->if_expr->has_else = SOME(else_body);
@@ -545,22 +765,24 @@ static AstNode* ast_parse_if_expr(Parser* parser) {
 }
 
 // LoopExpr
-//      ATTRIBUTE(inline)? (LoopInExpr / LoopCExpr / LoopInExpr)
+//      ATTRIBUTE(inline)? KEYWORD(loop) (LoopInExpr / LoopCExpr / LoopInfExpr)
 // 
 // Example:
 //      LoopInExpr
-//          loop foo in bar { ... } // `bar` needs to be an Iterator
+//          loop i in 0..10 { ... } // only ranges can be iterated over for now
 //      LoopCExpr
-//          loop i=0; i<=30; i++ { ... }
+//          loop i=0; i<=30; i+=1 { ... }
 //      LoopInfExpr
 //          loop { ... }
+//          loop cond { ... }
 static AstNode* ast_parse_loop_expr(Parser* parser) {
     Token* inline_attr = CHOMP_IF(ATTR_INLINE);
+    Token* loop_kwd = EXPECT_TOK(LOOP);
     AstNode* node = null;
 
-    AstNode* loop_inf_expr = ast_parse_loop_inf_expr(parser);
-    if(SOME(loop_inf_expr)) {
-        node = loop_inf_expr;
+    AstNode* loop_in_expr = ast_parse_loop_in_expr(parser);
+    if(SOME(loop_in_expr)) {
+        node = loop_in_expr;
         goto outexpect;
     }
 
@@ -570,9 +792,9 @@ static AstNode* ast_parse_loop_expr(Parser* parser) {
         goto outexpect;
     }
 
-    AstNode* loop_in_expr = ast_parse_loop_in_expr(parser);
-    if(SOME(loop_in_expr)) {
-        node = loop_in_expr;
+    AstNode* loop_inf_expr = ast_parse_loop_inf_expr(parser);
+    if(SOME(loop_inf_expr)) {
+        node = loop_inf_expr;
         goto outexpect;
     }
 
@@ -580,29 +802,117 @@ outexpect:
     if(NONE(node))
         AST_EXPECTED("loop expression");
 
+    node->loc = loop_kwd->loc;
     node->data.expr->loop_expr->is_inline = cast(bool)SOME(inline_attr);
     return node;
 }
 
-/*
-    TODO: Add implementation for:
-        1. ast_parse_loop_inf_expr(parser)
-        2. ast_parse_loop_c_expr(parser)
-        3. ast_parse_loop_in_expr(parser)
-*/
+// The body of a loop
+static Vec* ast_parse_loop_body(Parser* parser) {
+    return ast_parse_block(parser)->data.stmt->block_stmt->statements;
+}
+
+// LoopInfExpr
+//      Expr? Block
 static AstNode* ast_parse_loop_inf_expr(Parser* parser) {
-    CORETEN_ENFORCE(false, "TODO");
-    return null;
+    AstNode* cond = null;
+    if(pc->kind != LBRACE) {
+        cond = ast_parse_expr(parser);
+        if(NONE(cond))
+            AST_EXPECTED("loop condition");
+    }
+
+    AstNode* node = ast_create_node(AstNodeKindLoopInfExpr);
+    node->data.expr->loop_expr->loop_inf_expr->cond = cond;
+    node->data.expr->loop_expr->loop_inf_expr->statements = ast_parse_loop_body(parser);
+    return node;
 }
 
+// LoopCExpr
+//      (IDENTIFIER EQUALS Expr)? SEMICOLON Expr? SEMICOLON AssignmentExpr? Block
+//
+// `loop i = 0; ...` declares a mutable `i` that only lives as long as the loop.
 static AstNode* ast_parse_loop_c_expr(Parser* parser) {
-    CORETEN_ENFORCE(false, "TODO");
-    return null;
+    bool has_init = pc->kind == IDENTIFIER && (pc + 1)->kind == EQUALS;
+    if(!has_init && pc->kind != SEMICOLON)
+        return null;
+
+    AstNode* init = null;
+    if(has_init) {
+        Token* identifier = CHOMP(2);
+        AstNode* init_expr = ast_parse_expr(parser);
+        if(NONE(init_expr))
+            AST_EXPECTED("an expression");
+
+        init = ast_create_node(AstNodeKindVariableDecl);
+        init->loc = identifier->loc;
+        init->data.scope_obj->name = identifier->value;
+        init->data.scope_obj->var->name = identifier->value;
+        init->data.scope_obj->var->init_expr = init_expr;
+        init->data.scope_obj->var->is_local = true;
+        init->data.scope_obj->var->is_mutable = true;
+    }
+    EXPECT_TOK(SEMICOLON);
+
+    AstNode* cond = null;
+    if(pc->kind != SEMICOLON) {
+        cond = ast_parse_expr(parser);
+        if(NONE(cond))
+            AST_EXPECTED("loop condition");
+    }
+    EXPECT_TOK(SEMICOLON);
+
+    AstNode* updation = null;
+    if(pc->kind != LBRACE) {
+        updation = ast_parse_assignment_expr(parser);
+        if(NONE(updation))
+            AST_EXPECTED("an assignment expression");
+    }
+
+    AstNode* node = ast_create_node(AstNodeKindLoopCExpr);
+    AstNodeLoopCExpr* loop = node->data.expr->loop_expr->loop_c_expr;
+    loop->init = init;
+    loop->has_init = cast(bool)SOME(init);
+    loop->cond = cond;
+    loop->has_cond = cast(bool)SOME(cond);
+    loop->updation = updation;
+    loop->has_updation = cast(bool)SOME(updation);
+    loop->statements = ast_parse_loop_body(parser);
+    return node;
 }
 
+// LoopInExpr
+//      IDENTIFIER KEYWORD(in) Expr (DDOT Expr)? Block
 static AstNode* ast_parse_loop_in_expr(Parser* parser) {
-    CORETEN_ENFORCE(false, "TODO");
-    return null;
+    if(pc->kind != IDENTIFIER || (pc + 1)->kind != IN)
+        return null;
+    Token* identifier = CHOMP(2);
+
+    AstNode* cond = ast_parse_expr(parser);
+    if(NONE(cond))
+        AST_EXPECTED("an expression after `in`");
+    
+    Token* dot_dot = CHOMP_IF(DDOT);
+    if(SOME(dot_dot)) {
+        AstNode* end = ast_parse_expr(parser);
+        if(NONE(end))
+            AST_EXPECTED("Expected expression after `..`");
+
+        AstNode* range = ast_create_node(AstNodeKindMatchRange);
+        range->loc = dot_dot->loc;
+        range->data.expr->match_range_expr->begin = cond;
+        range->data.expr->match_range_expr->end = end;
+        cond = range;
+    }
+
+    AstNode* node = ast_create_node(AstNodeKindLoopInExpr);
+    AstNodeLoopInExpr* loop = node->data.expr->loop_expr->loop_in_expr;
+    loop->val_var = identifier->value;
+    loop->cond = cond;
+    loop->is_range = cast(bool)SOME(dot_dot);
+    loop->tokenkind = IN;
+    loop->statements = ast_parse_loop_body(parser);
+    return node;
 }
 
 // BlockExprStatement
@@ -626,11 +936,15 @@ static AstNode* ast_parse_block_expr_statement(Parser* parser) {
 // BlockExpr
 //      BlockLabel? Block
 static AstNode* ast_parse_block_expr(Parser* parser) {
+    AstNode* block = null;
     switch(pc->kind) {
         case IDENTIFIER:
-            if((pc->kind + 1) == COLON && (pc->kind + 2) == LBRACE) {
-                pc += 2;
-                return ast_parse_block(parser);    
+            // `pc` is never TOK_EOF here, and neither is the COLON after it, so both lookaheads are in bounds
+            if((pc + 1)->kind == COLON && (pc + 2)->kind == LBRACE) {
+                Token* label = CHOMP(2);
+                block = ast_parse_block(parser);
+                block->data.stmt->block_stmt->label = label->value;
+                return block;
             } else {
                 return null;
             }
@@ -678,12 +992,14 @@ static AstNode* ast_parse_assignment_expr(Parser* parser) {
 
         default: return lhs;
     }
+    Token* op_token = CHOMP(1);
 
     AstNode* rhs = ast_parse_expr(parser);
     if(NONE(rhs))
         AST_EXPECTED("an expression after assignment op");
 
     AstNode* node = ast_create_node(AstNodeKindBinaryOpExpr);
+    node->loc = op_token->loc;
     node->data.expr->binary_op_expr->op = op;
     node->data.expr->binary_op_expr->lhs = lhs;
     node->data.expr->binary_op_expr->rhs = rhs;
@@ -707,11 +1023,13 @@ static const ast_prec precedence_table[] = {
 
     { .tok_kind = PLUS,         .prec = 50, .bin_kind = BinaryOpKindAdd },
     { .tok_kind = MINUS,        .prec = 50, .bin_kind = BinaryOpKindSubtract },
-    { .tok_kind = PLUS_EQUALS,  .prec = 50, .bin_kind = BinaryOpKindAssignmentPlus },
-    { .tok_kind = MINUS_EQUALS, .prec = 50, .bin_kind = BinaryOpKindAssignmentMinus },
 
     { .tok_kind = LBITSHIFT, .prec = 40, .bin_kind = BinaryOpKindBitshitLeft },
     { .tok_kind = RBITSHIFT, .prec = 40, .bin_kind = BinaryOpKindBitshitRight },
+
+    { .tok_kind = AND, .prec = 35, .bin_kind = BinaryOpKindBitAnd },
+    { .tok_kind = XOR, .prec = 35, .bin_kind = BinaryOpKindBitXor },
+    { .tok_kind = OR,  .prec = 35, .bin_kind = BinaryOpKindBitOr },
     
     { .tok_kind = LESS_THAN,                 .prec = 30, .bin_kind = BinaryOpKindCmpLessThan },
     { .tok_kind = GREATER_THAN,              .prec = 30, .bin_kind = BinaryOpKindCmpGreaterThan },
@@ -720,18 +1038,18 @@ static const ast_prec precedence_table[] = {
     { .tok_kind = LESS_THAN_OR_EQUAL_TO,     .prec = 30, .bin_kind = BinaryOpKindCmpLessThanorEqualTo },
     { .tok_kind = GREATER_THAN_OR_EQUAL_TO,  .prec = 30, .bin_kind = BinaryOpKindCmpGreaterThanorEqualTo },
 
-    { .tok_kind = AND, .prec = 20, .bin_kind = BinaryOpKindBoolAnd },
+    { .tok_kind = AND_AND, .prec = 20, .bin_kind = BinaryOpKindBoolAnd },
 
-    { .tok_kind = OR,  .prec = 10, .bin_kind = BinaryOpKindBoolOr },
+    { .tok_kind = OR_OR,   .prec = 10, .bin_kind = BinaryOpKindBoolOr },
 };
 
+// Returns a precedence of 0 if `kind` isn't a binary operator
 static inline ast_prec lookup_precedence(TokenKind kind) {
     for(int i = 0; i < PRECEDENCE_TABLE_SIZE; i++) {
         if(precedence_table[i].tok_kind == kind)
             return precedence_table[i];
     }
-    AST_ERROR("Expected a valid assignment token op");
-    return cast(ast_prec) {0}; // Clang complains despite this point never being reached
+    return cast(ast_prec) {0};
 }
 
 static AstNode* ast_parse_precedence(Parser* parser, UInt8 min_prec) {
@@ -743,21 +1061,24 @@ static AstNode* ast_parse_precedence(Parser* parser, UInt8 min_prec) {
 
     while(true) {
         ast_prec prec = lookup_precedence(pc->kind);
-        if(prec.prec < min_prec || prec.prec == banned_prec)
+        if(prec.prec == 0 || prec.prec < min_prec || prec.prec == banned_prec)
             break;
         
-        CHOMP(1);
-        Token* op_token = pc;
+        Token* op_token = CHOMP(1);
 
         AstNode* rhs = ast_parse_precedence(parser, prec.prec + 1);
         if(NONE(rhs))
-            AST_ERROR("Invalid token");
+            AST_EXPECTED("an expression after the binary operator");
         
-        node->data.expr->binary_op_expr->lhs = node;
+        AstNode* lhs = node;
+        node = ast_create_node(AstNodeKindBinaryOpExpr);
+        node->loc = op_token->loc;
+        node->data.expr->binary_op_expr->lhs = lhs;
         node->data.expr->binary_op_expr->op = prec.bin_kind;
         node->data.expr->binary_op_expr->rhs = rhs;
 
-        switch(pc->kind) {
+        // Comparison operators don't chain (`a < b < c`)
+        switch(op_token->kind) {
             case EQUALS_EQUALS:
             case EXCLAMATION_EQUALS:
             case GREATER_THAN:
@@ -789,50 +1110,101 @@ static AstNode* ast_parse_prefix_expr(Parser* parser) {
     switch(parser->curr_tok->kind) {
         case NOT: op = PrefixOpKindBoolNot; break;
         case EXCLAMATION: op = PrefixOpKindNegation; break;
+        case MINUS: op = PrefixOpKindMinus; break;
         case AND: op = PrefixOpKindAddrOf; break;
         default: return ast_parse_primary_expr(parser);
     }
+    Token* op_token = CHOMP(1);
 
     AstNode* lhs = ast_parse_prefix_expr(parser);
     if(NONE(lhs))
         AST_EXPECTED("prefix op expression");
 
     AstNode* node = ast_create_node(AstNodeKindPrefixOpExpr);
+    node->loc = op_token->loc;
     node->data.prefix_op_expr->op = op;
     node->data.prefix_op_expr->expr = lhs;
     return node;
 }
 
 // TypeExpr
-//      (QUESTION / AND)? IDENTIFIER SliceExpr?
+//      | (QUESTION / AND) TypeExpr
+//      | IDENTIFIER(Tensor) LESS_THAN TypeExpr COMMA INTEGER GREATER_THAN
+//      | IDENTIFIER SliceExpr?
 // where SliceExpr is:
-//      LSQUAREBRACK (COLON Expr)? RSQUAREBRACK
+//      LSQUAREBRACK Expr? RSQUAREBRACK
+//
+// `expr` is either another TypeExpr (for `&T` and `?T`) or the Identifier naming the type.
+// `T[]` is a TypeExpr with `is_slice_expr` set, and `T[N]` is an ArrayType whose `child_type` is the TypeExpr `T`.
+// `Tensor<T, N>` is an ArrayType with `is_tensor` set.
 static AstNode* ast_parse_type_expr(Parser* parser) {
     AstNode* node = null;
     AstNode* expr = null;
-    TokenKind kind;
+    Token* tok = null;
 
     switch(pc->kind) {
         case QUESTION:
         case AND:
-            kind = pc->kind;
-            expr = ast_parse_expr(parser);
+            tok = CHOMP(1);
+            expr = ast_parse_type_expr(parser);
+            if(NONE(expr))
+                AST_EXPECTED("a type");
 
             node = ast_create_node(AstNodeKindTypeExpr);
+            node->loc = tok->loc;
             node->data.expr->type_expr->expr = expr;
-            node->data.expr->type_expr->is_address = kind == AND;
-            node->data.expr->type_expr->is_optional = kind == QUESTION;
+            node->data.expr->type_expr->is_address = tok->kind == AND;
+            node->data.expr->type_expr->is_optional = tok->kind == QUESTION;
             node->data.expr->type_expr->is_slice_expr = false;
             break;
-        case IDENTIFIER:
-            expr = ast_parse_expr(parser);
+        case IDENTIFIER: {
+            tok = CHOMP(1);
+            BuffView tensor_kwd = BV("Tensor");
+            if(buff_cmp(tok->value, &tensor_kwd) && pc->kind == LESS_THAN) {
+                CHOMP(1);
+                node = ast_create_node(AstNodeKindArrayType);
+                node->loc = tok->loc;
+                node->data.array_type->is_tensor = true;
+                node->data.array_type->child_type = ast_parse_type_expr(parser);
+                if(NONE(node->data.array_type->child_type))
+                    AST_EXPECTED("the element type of the tensor");
+                EXPECT_TOK(COMMA);
+                if(pc->kind != INTEGER)
+                    AST_EXPECTED("the rank of the tensor");
+                AstNode* rank = ast_create_node(AstNodeKindIntLiteral);
+                rank->loc = pc->loc;
+                rank->data.literal->int_value->value = pc->value;
+                CHOMP(1);
+                node->data.array_type->size = rank;
+                EXPECT_TOK(GREATER_THAN);
+                break;
+            }
+            expr = ast_create_node(AstNodeKindIdentifier);
+            expr->loc = tok->loc;
+            expr->data.identifier->name = tok->value;
+
+            node = ast_create_node(AstNodeKindTypeExpr);
+            node->loc = tok->loc;
+            node->data.expr->type_expr->expr = expr;
             if(pc->kind == LSQUAREBRACK) {
-                CORETEN_ENFORCE(false, "TODO: Parse optional SliceExpr");
+                CHOMP(1);
+                if(pc->kind == RSQUAREBRACK) {
+                    node->data.expr->type_expr->is_slice_expr = true;
+                } else {
+                    AstNode* array = ast_create_node(AstNodeKindArrayType);
+                    array->loc = tok->loc;
+                    array->data.array_type->child_type = node;
+                    array->data.array_type->size = ast_parse_expr(parser);
+                    if(NONE(array->data.array_type->size))
+                        AST_EXPECTED("the length of the array");
+                    node = array;
+                }
+                EXPECT_TOK(RSQUAREBRACK);
             }
             break;
+        }
         default:
-            AST_EXPECTED("Something");
-            break;
+            return null;
     }
 
     return node;
@@ -850,29 +1222,35 @@ static AstNode* ast_parse_primary_expr(Parser* parser) {
     AstNode* node = null;
     AstNode* expr = null;
     Token* label = null;
+    Token* tok = null;
     switch(pc->kind) {
         case IF: return ast_parse_if_expr(parser);
         case BREAK: 
-            CHOMP(1);
+            tok = CHOMP(1);
             label = ast_parse_break_label(parser);
-            expr = ast_parse_expr(parser);
+            // A value has to start on the same line, or the next statement would be taken for one
+            if(pc->kind != RBRACE && pc->loc->line == tok->loc->line)
+                expr = ast_parse_expr(parser);
 
             node = ast_create_node(AstNodeKindBreak);
+            node->loc = tok->loc;
             node->data.stmt->branch_stmt->type = AstNodeBranchStatementBreak;
             node->data.stmt->branch_stmt->name = SOME(label) ? label->value : null;
             node->data.stmt->branch_stmt->expr = expr;
             return node;
         case CONTINUE:
-            CHOMP(1);
+            tok = CHOMP(1);
             label = ast_parse_break_label(parser);
-            node = ast_create_node(AstNodeKindBreak);
+            node = ast_create_node(AstNodeKindContinue);
+            node->loc = tok->loc;
             node->data.stmt->branch_stmt->type = AstNodeBranchStatementContinue;
             node->data.stmt->branch_stmt->name = SOME(label) ? label->value : null;
             node->data.stmt->branch_stmt->expr = null;
             return node;
         case ATTR_COMPTIME:
-            CHOMP(1);
+            tok = CHOMP(1);
             node = ast_create_node(AstNodeKindAttributeExpr);
+            node->loc = tok->loc;
             expr = ast_parse_expr(parser);
             if(NONE(expr))
                 AST_EXPECTED("expression");
@@ -880,8 +1258,9 @@ static AstNode* ast_parse_primary_expr(Parser* parser) {
             node->data.expr->attr_expr->expr = expr;
             return node;
         case RETURN:
-            CHOMP(1);
+            tok = CHOMP(1);
             node = ast_create_node(AstNodeKindReturn);
+            node->loc = tok->loc;
             expr = ast_parse_expr(parser);
             node->data.stmt->return_stmt->expr = expr;
             return node;
@@ -890,35 +1269,35 @@ static AstNode* ast_parse_primary_expr(Parser* parser) {
             if((pc + 1)->kind == COLON) {
                 switch((pc + 2)->kind) {
                     case ATTR_INLINE:
-                        CHOMP(3);
-                        switch(pc->kind) {
-                            case LOOP: return ast_parse_loop_expr(parser);
-                            default: AST_EXPECTED("inlinable expression");
-                        }
                     case LOOP:
-                        CHOMP(2);
-                        return ast_parse_loop_expr(parser);
+                        label = CHOMP(2);
+                        if(pc->kind == ATTR_INLINE && (pc + 1)->kind != LOOP) {
+                            CHOMP(1);
+                            AST_EXPECTED("inlinable expression");
+                        }
+                        node = ast_parse_loop_expr(parser);
+                        node->data.expr->loop_expr->label = label->value;
+                        return node;
                     case LBRACE:
-                        CHOMP(2);
-                        return ast_parse_block(parser);
+                        return ast_parse_block_expr(parser);
                     default:
                         unreachable();
                 }
             }
             break;
         case ATTR_INLINE:
-            CHOMP(1);
-            switch(pc->kind) {
-                case LOOP: return ast_parse_loop_expr(parser);
-                default: AST_EXPECTED("inlinable expression");
+            if((pc + 1)->kind != LOOP) {
+                CHOMP(1);
+                AST_EXPECTED("inlinable expression");
             }
+            return ast_parse_loop_expr(parser);
         case LOOP: 
             return ast_parse_loop_expr(parser);
         default:
-            AST_ERROR("Invalid parser pattern");
+            break;
     } // switch(pc->kind)
-    AST_ERROR("Invalid parser pattern");
-    return null; // Clang complains despite this point never being reached
+
+    return ast_parse_suffix_expr(parser);
 }
 
 // Block
@@ -938,6 +1317,7 @@ static AstNode* ast_parse_block(Parser* parser) {
         AST_EXPECTED("RBRACE `}`");
     
     AstNode* node = ast_create_node(AstNodeKindBlock);
+    node->loc = lbrace->loc;
     node->data.stmt->block_stmt->statements = statements;
     return node;
 }
@@ -1013,10 +1393,7 @@ static AstNode* ast_parse_brace_suffix_expr(Parser* parser) {
     return node;
 }
 
-/* WIP */
-/*
 // SuffixExpr
-//      PrimaryTypeExpr SuffixOp* FuncCallArgs
 //      PrimaryTypeExpr (SuffixOp / FuncCallArgs)*
 // where FuncCallArgs are:
 //      LPAREN ExprList RPAREN
@@ -1024,36 +1401,167 @@ static AstNode* ast_parse_brace_suffix_expr(Parser* parser) {
 //      (Expr COMMA)* Expr?
 static AstNode* ast_parse_suffix_expr(Parser* parser) {
     AstNode* node = ast_parse_primary_type_expr(parser);
+    if(NONE(node))
+        return null;
+
     while(true) {
         AstNode* suffix_op = ast_parse_suffix_op(parser);
-        if(NONE(suffix_op))
+        if(SOME(suffix_op)) {
+            switch(suffix_op->kind) {
+                case AstNodeKindSliceExpr: suffix_op->data.expr->slice_expr->array_ref_expr = node; break;
+                case AstNodeKindArrayAccessExpr: suffix_op->data.array_access_expr->array_ref_expr = node; break;
+                case AstNodeKindFieldAccessExpr: suffix_op->data.field_access_expr->struct_expr = node; break;
+                default: unreachable();
+            }
+            node = suffix_op;
+            continue;
+        }
+
+        Token* lparen = CHOMP_IF(LPAREN);
+        if(NONE(lparen))
             break;
-        node = suffix_op;
-    }
-    Token* lparen = CHOMP_IF(LPAREN);
-    if(NONE(lparen)) {
-        WARN("expected param list");
-        return node;
+
+        Vec* args = VEC_NEW(AstNode, 1);
+        while(NONE(CHOMP_IF(RPAREN))) {
+            AstNode* arg = ast_parse_expr(parser);
+            if(NONE(arg))
+                AST_EXPECTED("an argument");
+            vec_push(args, arg);
+
+            switch(pc->kind) {
+                case COMMA: CHOMP(1); break;
+                case RPAREN: break;
+                default:
+                    AST_EXPECTED("`,` or `)`");
+            }
+        }
+
+        AstNode* call = ast_create_node(AstNodeKindFuncCallExpr);
+        call->loc = node->loc;
+        call->data.expr->func_call_expr->func_call_expr = node;
+        call->data.expr->func_call_expr->params = args;
+        node = call;
     }
+    return node;
+}
 
-    Vec* params = VEC_NEW(AstNode, 1);
-    AstNode* param = null;
-    while(CHOMP(1)->kind != RPAREN) {
-        param = ast_parse_expr(parser);
-        if(NONE(param))
+// Parse the expression of a format string's hole (`len` bytes of `data`), which starts at `line`:`col` in the source.
+// It gets a Lexer and a Parser of its own (the nodes outlive both).
+static AstNode* ast_parse_format_hole(Parser* parser, const char* data, UInt64 len, UInt32 line, UInt32 col) {
+    char* source = cast(char*)ast_alloc(len + 1);
+    memcpy(source, data, len);
+    Lexer* lexer = lexer_init(source, parser->fullpath->data);
+    lexer->loc->line = line;
+    lexer->loc->col = col;
+    lexer_lex(lexer);
+
+    Parser* hole = parser_init(lexer);
+    AstNode* expr = ast_parse_expr(hole);
+    if(NONE(expr))
+        AST_ERROR("Expected an expression inside `{}` in a format string (at %d:%d)", line, col);
+    if(hole->curr_tok->kind != TOK_EOF)
+        AST_ERROR("Unexpected `%s` inside `{}` in a format string (at %d:%d)", tokenHash[hole->curr_tok->kind],
+                  hole->curr_tok->loc->line, hole->curr_tok->loc->col);
+    parser_free(hole);
+    free(source);
+    return expr;
+}
+
+// FormatStringLiteral
+//      FORMAT_STRING
+// The literal is split into its pieces of text, each one (but the last) followed by a hole: `{expr}`, `{expr:spec}`
+// or `${expr}`.
+static AstNode* ast_parse_format_string(Parser* parser) {
+    Token* tok = EXPECT_TOK(FORMAT_STRING);
+    AstNode* node = ast_create_node(AstNodeKindStringLiteral);
+    node->loc = tok->loc;
+    AstNodeStringLiteral* literal = node->data.literal->str_value;
+    literal->value = tok->value;
+    literal->is_special = true;
+    literal->type = AstNodeStringLiteralFormat;
+    literal->parts = VEC_NEW(AstNodeFormatPart, 2);
+
+    const char* data = tok->value->data;
+    UInt64 len = tok->value->len;
+    // The text of the current piece, with `{{` and `}}` folded
+    char* text = cast(char*)ast_alloc(len + 1);
+    UInt64 text_len = 0;
+    UInt64 i = 0;
+    while(true) {
+        char ch = i < len ? data[i] : nullchar;
+        if(ch == '\\' && i + 1 < len) {
+            text[text_len++] = ch;
+            text[text_len++] = data[i + 1];
+            i += 2;
+            continue;
+        }
+        if((ch == '{' || ch == '}') && i + 1 < len && data[i + 1] == ch) {
+            text[text_len++] = ch;
+            i += 2;
+            continue;
+        }
+        bool is_dollar = ch == '$' && i + 1 < len && data[i + 1] == '{';
+        if(i < len && ch != '{' && !is_dollar) {
+            text[text_len++] = ch;
+            i++;
+            continue;
+        }
+
+        AstNodeFormatPart part = {0};
+        char* piece = cast(char*)ast_alloc(text_len + 1);
+        memcpy(piece, text, text_len);
+        part.text = BUFF_NEW(piece);
+        text_len = 0;
+        if(i == len) {
+            vec_push(literal->parts, &part);
             break;
-        vec_push(params, param);
-        switch(pc->kind) {
-            case COMMA: CHOMP(1);
-            case RPAREN: CHOMP(1); break;
-            case COLON: case RBRACE: case RSQUAREBRACK:
-                AST_EXPECTED("RBRACE");
-            default:
-                WARN("expected comma");
         }
+
+        // A hole: find its closing `}`, and the `:` before its spec (the last one outside of brackets and strings)
+        i += is_dollar ? 2 : 1;
+        UInt64 begin = i;
+        UInt64 end = len;
+        Int32 braces = 0;
+        Int32 nesting = 0;
+        for(; i < len; i++) {
+            ch = data[i];
+            if(ch == '}' && braces == 0)
+                break;
+            switch(ch) {
+                case '"':
+                    for(i++; i < len && data[i] != '"'; i++)
+                        if(data[i] == '\\')
+                            i++;
+                    break;
+                case '{': braces++; nesting++; break;
+                case '}': braces--; nesting--; break;
+                case '(': case '[': nesting++; break;
+                case ')': case ']': nesting--; break;
+                case ':':
+                    if(i + 1 < len && data[i + 1] == ':')
+                        i++;
+                    else if(nesting == 0)
+                        end = i;
+                    break;
+            }
+        }
+        if(i >= len)
+            AST_ERROR("Missing `}` in a format string (at %d:%d)", tok->loc->line, tok->loc->col);
+        if(end == len)
+            end = i;
+        else if(i - end > 1)
+            part.spec = buff_slice(tok->value, cast(int)(end + 1), cast(int)(i - end - 1));
+        else
+            part.spec = BUFF_NEW("");
+        // The content starts after `f"`
+        part.expr = ast_parse_format_hole(parser, data + begin, end - begin, tok->loc->line,
+                                          tok->loc->col + 2 + cast(UInt32)begin);
+        vec_push(literal->parts, &part);
+        i++;
     }
+    free(text);
+    return node;
 }
-*/
 
 // PrimaryTypeExpr
 //      BUILTINIDENTIFIER FuncCallArgs
@@ -1084,27 +1592,37 @@ static AstNode* ast_parse_primary_type_expr(Parser* parser) {
     switch(pc->kind) {
         case CHAR_LIT:
             node = ast_create_node(AstNodeKindCharLiteral);
+            node->loc = pc->loc;
             node->data.literal->char_value->value = pc->value;
             CHOMP(1);
             return node;
         case INTEGER:
+        case HEX_INT:
+        case BIN_INT:
+        case OCT_INT:
             node = ast_create_node(AstNodeKindIntLiteral);
+            node->loc = pc->loc;
             node->data.literal->int_value->value = pc->value;
             CHOMP(1);
             return node;
         case FLOAT_LIT:
             node = ast_create_node(AstNodeKindFloatLiteral);
+            node->loc = pc->loc;
             node->data.literal->float_value->value = pc->value;
             CHOMP(1);
             return node;
         case UNREACHABLE:
             node = ast_create_node(AstNodeKindUnreachable);
+            node->loc = pc->loc;
             CHOMP(1);
             return node;
         case STRING:
             node = ast_create_node(AstNodeKindStringLiteral);
+            node->loc = pc->loc;
+            node->data.literal->str_value->value = pc->value;
             CHOMP(1);
             return node;
+        case FORMAT_STRING: return ast_parse_format_string(parser);
         case BUILTIN: return ast_parse_builtin_call(parser);
         case FUNC: return ast_parse_func_decl(parser);
         case IF: return ast_parse_if_expr(parser);
@@ -1112,7 +1630,9 @@ static AstNode* ast_parse_primary_type_expr(Parser* parser) {
         case STRUCT: return ast_parse_struct_decl(parser);
         case ENUM: return ast_parse_enum_decl(parser);
         case ATTR_COMPTIME:
+            tok = CHOMP(1);
             node = ast_create_node(AstNodeKindAttributeExpr);
+            node->loc = tok->loc;
             expr = ast_parse_type_expr(parser);
             if(NONE(expr))
                 AST_EXPECTED("type expr");
@@ -1132,17 +1652,12 @@ static AstNode* ast_parse_primary_type_expr(Parser* parser) {
                             CHOMP(2);
                             return ast_parse_loop_expr(parser);
                         case LBRACE:
-                            CHOMP(2);
-                            return ast_parse_block(parser);
+                            return ast_parse_block_expr(parser);
                         default:
-                            node = ast_create_node(AstNodeKindIdentifier);
-                            CHOMP(1);
-                            return node;
+                            return ast_parse_identifier(parser);
                     }
                 default:
-                    node = ast_create_node(AstNodeKindIdentifier);
-                    CHOMP(1);
-                    return node;
+                    return ast_parse_identifier(parser);
             }
             break;
         case ATTR_INLINE:
@@ -1163,7 +1678,9 @@ static AstNode* ast_parse_primary_type_expr(Parser* parser) {
             }
             break;
         case LPAREN:
+            tok = CHOMP(1);
             node = ast_create_node(AstNodeKindGroupedExpr);
+            node->loc = tok->loc;
             expr = ast_parse_expr(parser);
             if(NONE(expr))
                 AST_EXPECTED("expression");
@@ -1173,10 +1690,33 @@ static AstNode* ast_parse_primary_type_expr(Parser* parser) {
 
             node->data.expr->grouped_expr->expr = expr;
             return node;
+        default:
+            break;
     }
     return null;
 }
 
+// Identifier
+//      IDENTIFIER
+// The identifiers `true` and `false` are Bool literals.
+static AstNode* ast_parse_identifier(Parser* parser) {
+    Token* identifier = EXPECT_TOK(IDENTIFIER);
+    BuffView true_kwd = BV("true");
+    BuffView false_kwd = BV("false");
+    bool is_true = buff_cmp(identifier->value, &true_kwd);
+
+    AstNode* node = null;
+    if(is_true || buff_cmp(identifier->value, &false_kwd)) {
+        node = ast_create_node(AstNodeKindBoolLiteral);
+        node->data.literal->bool_value->value = is_true;
+    } else {
+        node = ast_create_node(AstNodeKindIdentifier);
+        node->data.identifier->name = identifier->value;
+    }
+    node->loc = identifier->loc;
+    return node;
+}
+
 static AstNode* ast_parse_builtin_call(Parser* parser) {
     CORETEN_ENFORCE(false, "TODO");
     return null;
@@ -1189,7 +1729,7 @@ static AstNode* ast_parse_builtin_call(Parser* parser) {
 static AstNode* ast_parse_match_expr(Parser* parser) {
     Token* match_kwd = CHOMP_IF(MATCH);
     if(NONE(match_kwd))
-        AST_EXPECTED("`match` keyword");
+        return null;
     
     Token* lparen = CHOMP_IF(LPAREN); // this is optional
     AstNode* expr = ast_parse_expr(parser);
@@ -1197,7 +1737,7 @@ static AstNode* ast_parse_match_expr(Parser* parser) {
         AST_EXPECTED("expression");
     Token* rparen = CHOMP_IF(RPAREN); // this is optional
     
-    Token* lbrace = EXPECT_TOK(RBRACE); // required
+    Token* lbrace = EXPECT_TOK(LBRACE); // required
 
     // Branches
     AstNode* branch_node = ast_parse_match_branch(parser);
@@ -1210,8 +1750,10 @@ static AstNode* ast_parse_match_expr(Parser* parser) {
 
     // Parse any trailing comma
     Token* comma = CHOMP_IF(COMMA);
+    Token* rbrace = EXPECT_TOK(RBRACE);
 
     AstNode* node = ast_create_node(AstNodeKindMatchExpr);
+    node->loc = match_kwd->loc;
     node->data.expr->match_expr->expr = expr;
     node->data.expr->match_expr->branches = branches;
     return node;
@@ -1224,13 +1766,14 @@ static AstNode* ast_parse_match_expr(Parser* parser) {
 static AstNode* ast_parse_match_branch(Parser* parser) {
     Token* when_kwd = CHOMP_IF(WHEN);
     if(NONE(when_kwd))
-        AST_EXPECTED("`when` keyword");
+        return null;
 
     // MatchClause
     AstNode* node = ast_parse_match_clause(parser);
-    CORETEN_ENFORCE(node->kind == AstNodeKindMatchBranch);
     if(NONE(node))
-        return null;
+        AST_EXPECTED("a `when` clause");
+    CORETEN_ENFORCE(node->kind == AstNodeKindMatchBranch);
+    node->loc = when_kwd->loc;
     
     Token* equals_arrow = CHOMP_IF(EQUALS_ARROW); // `=>`
     if(NONE(equals_arrow))
@@ -1275,9 +1818,6 @@ static AstNode* ast_parse_match_clause(Parser* parser) {
     }
     
     out->data.expr->match_branch_expr->cond_node = cond_node;
-
-    CORETEN_ENFORCE(parser_peek_next(parser)->kind == EQUALS_ARROW, "Expected `=>` after expression.");
-
     return out;
 }
 
@@ -1322,33 +1862,38 @@ static AstNode* ast_parse_field_init(Parser* parser) {
 }
 
 // SuffixOp
-//      | LBRACKET Expr (DOT2 (Expr (COLON Expr)?)?)? RBRACKET
+//      | LSQUAREBRACK Expr? (DDOT Expr? (COLON Expr)?)? RSQUAREBRACK
+// A slice (`[lower..upper:step]`) can leave out any of its parts.
 //      | DOT IDENTIFIER
 static AstNode* ast_parse_suffix_op(Parser* parser) {
-    Token* lbrace = CHOMP_IF(LBRACE);
-    if(SOME(lbrace)) {
+    Token* lbrack = CHOMP_IF(LSQUAREBRACK);
+    if(SOME(lbrack)) {
         AstNode* lower = ast_parse_expr(parser);
         AstNode* upper = null;
-        Token* ellipsis = CHOMP_IF(ELLIPSIS);
-        if(SOME(ellipsis)) {
-            AstNode* sentinel = null;
+        Token* ddot = CHOMP_IF(DDOT);
+        if(SOME(ddot)) {
+            AstNode* step = null;
             upper = ast_parse_expr(parser);
             Token* colon = CHOMP_IF(COLON);
             if(SOME(colon)) {
-                sentinel = ast_parse_expr(parser);
+                step = ast_parse_expr(parser);
+                if(NONE(step))
+                    AST_EXPECTED("the step of the slice");
             }
-            Token* rbrace = EXPECT_TOK(RBRACE);
+            Token* rbrack = EXPECT_TOK(RSQUAREBRACK);
 
             AstNode* node = ast_create_node(AstNodeKindSliceExpr);
+            node->loc = lbrack->loc;
             node->data.expr->slice_expr->lower = lower;
             node->data.expr->slice_expr->upper = upper;
-            node->data.expr->slice_expr->sentinel = sentinel;
+            node->data.expr->slice_expr->step = step;
             return node;
         }
 
-        Token* rbrace = EXPECT_TOK(RBRACE);
+        Token* rbrack = EXPECT_TOK(RSQUAREBRACK);
 
         AstNode* node = ast_create_node(AstNodeKindArrayAccessExpr);
+        node->loc = lbrack->loc;
         node->data.array_access_expr->subscript = lower;
         return node;
     }
@@ -1357,6 +1902,7 @@ static AstNode* ast_parse_suffix_op(Parser* parser) {
     if(SOME(dot)) {
         Token* identifier = EXPECT_TOK(IDENTIFIER);
         AstNode* node = ast_create_node(AstNodeKindFieldAccessExpr);
+        node->loc = identifier->loc;
         node->data.field_access_expr->field_name = identifier->value;
         return node;
     }
@@ -1398,12 +1944,30 @@ AstNode* return_result(Parser* parser) {
     return ast_parse_block_expr(parser);
 }
 
+// Parse the whole token list. Every top-level declaration is appended to `parser->nodelist`, in source order.
+void parser_parse(Parser* parser) {
+    parser->is_in_global_context = true;
+    while(pc->kind != TOK_EOF) {
+        ParserSpan span;
+        span.begin = parser->offset;
+        AstNode* decl = ast_parse_toplevel_decl(parser);
+        if(NONE(decl))
+            AST_EXPECTED("a top-level declaration");
+        span.end = parser->offset;
+        NODEPUSH(decl);
+        vec_push(parser->spans, &span);
+        free(decl); // `nodelist` holds a copy
+    }
+}
+
 // Free a Parser* instance
-static void parser_free(Parser* parser) {
+void parser_free(Parser* parser) {
     if(SOME(parser)) {
         lexer_free(parser->lexer);
         buff_free(parser->mod_name);
+        vec_free(parser->toklist);
         vec_free(parser->nodelist);
+        vec_free(parser->spans);
         free(parser);
     }
 }
\ No newline at end of file
@@ -18,15 +18,22 @@ Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
 #include <adorad/compiler/lexer.h>
 #include <adorad/compiler/tokens.h>
 
+// The range of tokens `[begin, end)` (in `Parser.toklist`) a top-level node was parsed from
+typedef struct ParserSpan {
+    UInt32 begin;
+    UInt32 end;
+} ParserSpan;
+
 // Each Adorad source file can be represented by a `Parser` structure.
 // This means if there are `n` source files, there will be `n` Parser instances (one for each file).
 typedef struct Parser {
     UInt32 id;
     Buff* fullpath;     // path/to/file.ad
     // Buff* basename;     // file.ad
-    Vec* nodelist;      // List of `AstNode*`s
+    Vec* nodelist;      // List of top-level `AstNode`s
+    Vec* spans;         // `ParserSpan` of every node in `nodelist`
     Lexer* lexer;
-    Vec* toklist;       // shortcut to `lexer->toklist`
+    Vec* toklist;       // `lexer->toklist`, without comments
     Token* curr_tok;
     UInt32 offset;      // offset of `curr_tok` in `toklist`
     UInt64 num_tokens;
@@ -39,7 +46,8 @@ typedef struct Parser {
 } Parser;
 
 Parser* parser_init(Lexer* lexer);
-static void parser_free(Parser* parser);
+void parser_free(Parser* parser);
+void parser_parse(Parser* parser);
 AstNode* ast_create_node(AstNodeKind type);
 AstNode* return_result(Parser* parser);
 
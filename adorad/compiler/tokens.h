@@ -52,6 +52,7 @@ TOKENKIND(TOK___LITERALS_BEGIN, ""), \
     TOKENKIND(STRING,        "STRING"),       \
     TOKENKIND(RAW_STRING,    "RAW_STRING"),   \
     TOKENKIND(TRIPLE_STRING, "TRIPLE_STRING"), \
+    TOKENKIND(FORMAT_STRING, "FORMAT_STRING"), \
     TOKENKIND(TOK_TRUE,      "TRUE"),         \
     TOKENKIND(TOK_FALSE,     "FALSE"),        \
 TOKENKIND(TOK___LITERALS_END, ""), \
@@ -0,0 +1,473 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <adorad/compiler/types.h>
+#include <adorad/core/debug.h>
+#include <adorad/core/misc.h>
+#include <adorad/core/thread.h>
+
+#define PRIMITIVE(kind_, name_)     [kind_] = { .kind = kind_, .id = kind_ + 1, .name = name_ }
+
+static Type primitive_types[ADORAD_NUM_PRIMITIVE_TYPES] = {
+    PRIMITIVE(AdoradTypeAny,            "Any"),
+    PRIMITIVE(AdoradTypeNull,           "Null"),
+    PRIMITIVE(AdoradTypeBool,           "Bool"),
+    PRIMITIVE(AdoradTypeByte,           "Byte"),
+    PRIMITIVE(AdoradTypeString,         "String"),
+    PRIMITIVE(AdoradTypeRune,           "Rune"),
+    PRIMITIVE(AdoradTypeInt8,           "Int8"),
+    PRIMITIVE(AdoradTypeInt16,          "Int16"),
+    PRIMITIVE(AdoradTypeInt,            "Int"),
+    PRIMITIVE(AdoradTypeInt64,          "Int64"),
+    PRIMITIVE(AdoradTypeFloat32,        "Float32"),
+    PRIMITIVE(AdoradTypeFloat64,        "Float64"),
+    PRIMITIVE(AdoradTypeUInt16,         "UInt16"),
+    PRIMITIVE(AdoradTypeUInt32,         "UInt32"),
+    PRIMITIVE(AdoradTypeUInt64,         "UInt64"),
+    PRIMITIVE(AdoradTypeTensorInt16,    "TensorInt16"),
+    PRIMITIVE(AdoradTypeTensorInt32,    "TensorInt32"),
+    PRIMITIVE(AdoradTypeTensorInt64,    "TensorInt64"),
+    PRIMITIVE(AdoradTypeTensorFloat32,  "TensorFloat32"),
+    PRIMITIVE(AdoradTypeTensorFloat64,  "TensorFloat64"),
+    PRIMITIVE(AdoradTypeComplex32,      "Complex32"),
+    PRIMITIVE(AdoradTypeComplex64,      "Complex64"),
+    PRIMITIVE(AdoradTypeQuaternion128,  "Quaternion128"),
+    PRIMITIVE(AdoradTypeQuaternion256,  "Quaternion256"),
+    PRIMITIVE(AdoradTypeVoid,           "Void"),
+    PRIMITIVE(AdoradTypeInvalid,        "<invalid>"),
+};
+
+#undef PRIMITIVE
+
+// Alternative spellings
+static const struct {
+    const char* name;
+    AdoradTypes kind;
+} type_aliases[] = {
+    { "Int32", AdoradTypeInt },
+    { "UInt8", AdoradTypeByte },
+    { "void",  AdoradTypeVoid },
+};
+
+/*
+    The type interner.
+
+    Composite types are stored in fixed-size chunks (so a `Type*` stays valid forever), and indexed by a hash table 
+    of TypeIds (open addressing, linear probing).
+    Lookups are lock-free. Creating a type takes `intern_lock`, checks again, and then publishes the new type 
+    (its chunk, then its id in the hash table) with atomic stores, so a reader that finds an id always sees a 
+    fully-initialized `Type`.
+    The hash table is replaced (not resized in place) when it fills up. Old tables are kept around, since readers may 
+    still be probing them - a reader that misses in an old table simply takes the lock and tries again.
+*/
+#define TYPE_CHUNK_SHIFT        10
+#define TYPE_CHUNK_SIZE         (1 << TYPE_CHUNK_SHIFT)
+#define TYPE_MAX_CHUNKS         4096
+
+typedef struct InternTable {
+    volatile UInt32* slots;     // TypeIds (TYPE_ID_NONE = empty)
+    UInt32 mask;                // capacity - 1 (the capacity is a power of 2)
+    struct InternTable* prev;   // the table this one replaced
+} InternTable;
+
+static Type* volatile type_chunks[TYPE_MAX_CHUNKS];
+static volatile UInt32 num_composite_types = 0;
+static InternTable* volatile intern_table = null;
+static volatile UInt32 intern_lock = 0;
+
+static void interner_lock() {
+    while(!atomic32_cas(&intern_lock, 0, 1))
+        ;
+}
+
+static void interner_unlock() {
+    atomic32_store(&intern_lock, 0);
+}
+
+Type* type_get(TypeId id) {
+    CORETEN_ENFORCE(id != TYPE_ID_NONE, "Expected a valid TypeId");
+    if(id <= ADORAD_NUM_PRIMITIVE_TYPES)
+        return &primitive_types[id - 1];
+
+    UInt32 index = id - ADORAD_NUM_PRIMITIVE_TYPES - 1;
+    CORETEN_ENFORCE(index < atomic32_load(&num_composite_types), "Expected a valid TypeId");
+    Type* chunk = cast(Type*)atomicptr_load(cast(void* volatile*)&type_chunks[index >> TYPE_CHUNK_SHIFT]);
+    return &chunk[index & (TYPE_CHUNK_SIZE - 1)];
+}
+
+UInt32 type_count() {
+    return ADORAD_NUM_PRIMITIVE_TYPES + atomic32_load(&num_composite_types);
+}
+
+Type* type_primitive(AdoradTypes kind) {
+    CORETEN_ENFORCE(kind < ADORAD_NUM_PRIMITIVE_TYPES, "Not a primitive type");
+    return &primitive_types[kind];
+}
+
+Type* type_from_name(const char* name, UInt64 len) {
+    for(UInt32 kind = 0; kind < AdoradTypeInvalid; kind++) {
+        const char* spelling = primitive_types[kind].name;
+        if(spelling && strlen(spelling) == len && memcmp(spelling, name, len) == 0)
+            return &primitive_types[kind];
+    }
+    for(UInt32 i = 0; i < sizeof(type_aliases)/sizeof(type_aliases[0]); i++) {
+        if(strlen(type_aliases[i].name) == len && memcmp(type_aliases[i].name, name, len) == 0)
+            return &primitive_types[type_aliases[i].kind];
+    }
+    return null;
+}
+
+// FNV-1a over the structure of `key`. The components are already interned, so their ids stand in for them.
+static UInt64 type_hash(Type* key) {
+    UInt64 hash = 14695981039346656037ULL;
+    #define HASH_U64(x)     do { hash ^= cast(UInt64)(x); hash *= 1099511628211ULL; } while(0)
+    HASH_U64(key->kind);
+    HASH_U64(SOME(key->elem) ? key->elem->id : 0);
+    HASH_U64(key->len);
+    HASH_U64(SOME(key->ret) ? key->ret->id : 0);
+    HASH_U64(key->is_variadic);
+    for(UInt32 i = 0; i < key->num_params; i++)
+        HASH_U64(key->params[i]->id);
+    if(SOME(key->name)) {
+        for(const char* c = key->name; *c; c++)
+            HASH_U64(cast(Byte)*c);
+    }
+    #undef HASH_U64
+    return hash;
+}
+
+static bool type_matches(Type* type, Type* key) {
+    if(type->kind != key->kind || type->elem != key->elem || type->len != key->len || type->ret != key->ret ||
+       type->is_variadic != key->is_variadic || type->num_params != key->num_params)
+        return false;
+    if(key->num_params > 0 && memcmp(type->params, key->params, key->num_params * sizeof(Type*)) != 0)
+        return false;
+    if(SOME(key->name))
+        return SOME(type->name) && strcmp(type->name, key->name) == 0;
+    return true;
+}
+
+static Type* intern_table_find(InternTable* table, Type* key, UInt64 hash) {
+    for(UInt32 i = cast(UInt32)hash & table->mask; ; i = (i + 1) & table->mask) {
+        TypeId id = atomic32_load(&table->slots[i]);
+        if(id == TYPE_ID_NONE)
+            return null;
+        Type* type = type_get(id);
+        if(type_matches(type, key))
+            return type;
+    }
+}
+
+static void intern_table_insert(InternTable* table, TypeId id, UInt64 hash) {
+    UInt32 i = cast(UInt32)hash & table->mask;
+    while(table->slots[i] != TYPE_ID_NONE)
+        i = (i + 1) & table->mask;
+    atomic32_store(&table->slots[i], id);
+}
+
+static InternTable* intern_table_new(UInt32 capacity, InternTable* prev) {
+    InternTable* table = cast(InternTable*)calloc(1, sizeof(InternTable));
+    CORETEN_ENFORCE_NN(table, "Could not allocate memory. Memory full.");
+    table->slots = cast(volatile UInt32*)calloc(capacity, sizeof(UInt32));
+    CORETEN_ENFORCE_NN(table->slots, "Could not allocate memory. Memory full.");
+    table->mask = capacity - 1;
+    table->prev = prev;
+
+    // Existing types are all in `prev`'s chunks
+    UInt32 count = atomic32_load(&num_composite_types);
+    for(UInt32 i = 0; i < count; i++) {
+        TypeId id = ADORAD_NUM_PRIMITIVE_TYPES + 1 + i;
+        intern_table_insert(table, id, type_hash(type_get(id)));
+    }
+    return table;
+}
+
+// Return the interned type with the same structure as `key` (creating it if it doesn't exist yet)
+static Type* type_intern(Type* key) {
+    UInt64 hash = type_hash(key);
+    InternTable* table = cast(InternTable*)atomicptr_load(cast(void* volatile*)&intern_table);
+    Type* type = SOME(table) ? intern_table_find(table, key, hash) : null;
+    if(SOME(type))
+        return type;
+
+    interner_lock();
+    table = intern_table;
+    type = SOME(table) ? intern_table_find(table, key, hash) : null;
+    if(SOME(type)) {
+        interner_unlock();
+        return type;
+    }
+
+    // Keep the load factor at 50% or lower
+    UInt32 index = num_composite_types;
+    if(NONE(table) || 2 * (index + 1) > table->mask + 1) {
+        table = intern_table_new(NONE(table) ? 256 : 2 * (table->mask + 1), table);
+        atomicptr_store(cast(void* volatile*)&intern_table, table);
+    }
+
+    CORETEN_ENFORCE((index >> TYPE_CHUNK_SHIFT) < TYPE_MAX_CHUNKS, "Too many types");
+    Type* chunk = type_chunks[index >> TYPE_CHUNK_SHIFT];
+    if(NONE(chunk)) {
+        chunk = cast(Type*)calloc(TYPE_CHUNK_SIZE, sizeof(Type));
+        CORETEN_ENFORCE_NN(chunk, "Could not allocate memory. Memory full.");
+        atomicptr_store(cast(void* volatile*)&type_chunks[index >> TYPE_CHUNK_SHIFT], chunk);
+    }
+
+    type = &chunk[index & (TYPE_CHUNK_SIZE - 1)];
+    *type = *key;
+    type->id = ADORAD_NUM_PRIMITIVE_TYPES + 1 + index;
+    if(key->num_params > 0) {
+        type->params = cast(Type**)malloc(key->num_params * sizeof(Type*));
+        CORETEN_ENFORCE_NN(type->params, "Could not allocate memory. Memory full.");
+        memcpy(type->params, key->params, key->num_params * sizeof(Type*));
+    }
+    if(SOME(key->name)) {
+        UInt64 name_len = strlen(key->name);
+        char* name = cast(char*)malloc(name_len + 1);
+        CORETEN_ENFORCE_NN(name, "Could not allocate memory. Memory full.");
+        memcpy(name, key->name, name_len + 1);
+        type->name = name;
+    }
+
+    atomic32_store(&num_composite_types, index + 1);
+    intern_table_insert(table, type->id, hash);
+    interner_unlock();
+    return type;
+}
+
+static Type* type_derived(AdoradTypes kind, Type* elem, UInt64 len) {
+    CORETEN_ENFORCE_NN(elem, "Expected not null");
+    Type key = { .kind = kind, .elem = elem, .len = len };
+    return type_intern(&key);
+}
+
+Type* type_pointer_to(Type* elem) {
+    return type_derived(AdoradTypePointer, elem, 0);
+}
+
+Type* type_optional_of(Type* elem) {
+    CORETEN_ENFORCE_NN(elem, "Expected not null");
+    // `??T` is just `?T`
+    if(elem->kind == AdoradTypeOptional)
+        return elem;
+    return type_derived(AdoradTypeOptional, elem, 0);
+}
+
+Type* type_slice_of(Type* elem) {
+    return type_derived(AdoradTypeSlice, elem, 0);
+}
+
+Type* type_array_of(Type* elem, UInt64 len) {
+    return type_derived(AdoradTypeArray, elem, len);
+}
+
+Type* type_tensor_of(Type* elem, UInt64 rank) {
+    return type_derived(AdoradTypeTensor, elem, rank);
+}
+
+Type* type_func(Type** params, UInt32 num_params, bool is_variadic, Type* ret) {
+    CORETEN_ENFORCE_NN(ret, "Expected not null");
+    Type key = { .kind = AdoradTypeFunc, .params = params, .num_params = num_params, .is_variadic = is_variadic,
+                 .ret = ret };
+    return type_intern(&key);
+}
+
+Type* type_struct(const char* name, UInt64 len) {
+    char buffer[256];
+    CORETEN_ENFORCE(len > 0 && len < sizeof(buffer), "Invalid struct name");
+    memcpy(buffer, name, len);
+    buffer[len] = nullchar;
+
+    Type key = { .kind = AdoradTypeStruct, .name = buffer };
+    return type_intern(&key);
+}
+
+bool type_equals(Type* a, Type* b) {
+    return a == b;
+}
+
+bool type_is_integer(Type* type) {
+    switch(type->kind) {
+        case AdoradTypeByte:
+        case AdoradTypeInt8:
+        case AdoradTypeInt16:
+        case AdoradTypeInt:
+        case AdoradTypeInt64:
+        case AdoradTypeUInt16:
+        case AdoradTypeUInt32:
+        case AdoradTypeUInt64:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool type_is_signed(Type* type) {
+    switch(type->kind) {
+        case AdoradTypeInt8:
+        case AdoradTypeInt16:
+        case AdoradTypeInt:
+        case AdoradTypeInt64:
+        case AdoradTypeFloat32:
+        case AdoradTypeFloat64:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool type_is_float(Type* type) {
+    return type->kind == AdoradTypeFloat32 || type->kind == AdoradTypeFloat64;
+}
+
+bool type_is_numeric(Type* type) {
+    return type_is_integer(type) || type_is_float(type);
+}
+
+// Tensors of every element type there's a tensor type for (in the order of `AdoradTypeTensorInt16`...)
+static const AdoradTypes type_tensor_elems[] = {
+    AdoradTypeInt16, AdoradTypeInt, AdoradTypeInt64, AdoradTypeFloat32, AdoradTypeFloat64,
+};
+
+Type* type_tensor_elem(Type* type) {
+    if(type->kind == AdoradTypeTensor)
+        return type->elem;
+    if(type->kind < AdoradTypeTensorInt16 || type->kind > AdoradTypeTensorFloat64)
+        return null;
+    return type_primitive(type_tensor_elems[type->kind - AdoradTypeTensorInt16]);
+}
+
+UInt32 type_tensor_rank(Type* type) {
+    if(type->kind == AdoradTypeTensor)
+        return cast(UInt32)type->len;
+    return SOME(type_tensor_elem(type)) ? 1 : 0;
+}
+
+Type* type_tensor_for(Type* elem) {
+    for(UInt32 i = 0; i < sizeof(type_tensor_elems) / sizeof(type_tensor_elems[0]); i++)
+        if(elem->kind == type_tensor_elems[i])
+            return type_primitive(cast(AdoradTypes)(AdoradTypeTensorInt16 + i));
+    return null;
+}
+
+UInt32 type_size(Type* type) {
+    switch(type->kind) {
+        case AdoradTypeByte:
+        case AdoradTypeInt8:
+            return 1;
+        case AdoradTypeInt16:
+        case AdoradTypeUInt16:
+            return 2;
+        case AdoradTypeInt:
+        case AdoradTypeUInt32:
+        case AdoradTypeFloat32:
+            return 4;
+        case AdoradTypeInt64:
+        case AdoradTypeUInt64:
+        case AdoradTypeFloat64:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
+bool type_is_assignable(Type* to, Type* from) {
+    if(type_equals(to, from))
+        return true;
+    // Don't pile more errors on top of an expression that has already failed
+    if(to->kind == AdoradTypeInvalid || from->kind == AdoradTypeInvalid)
+        return true;
+    if(to->kind == AdoradTypeAny)
+        return true;
+    if(to->kind == AdoradTypeOptional)
+        return from->kind == AdoradTypeNull || type_is_assignable(to->elem, from);
+    if(to->kind == AdoradTypeSlice && from->kind == AdoradTypeArray)
+        return to->elem == from->elem;
+
+    if(type_is_integer(to) && type_is_integer(from)) {
+        // Widening only. Unsigned values also fit into a wider signed type, but not the other way around.
+        if(type_size(from) >= type_size(to))
+            return false;
+        return type_is_signed(from) == type_is_signed(to) || !type_is_signed(from);
+    }
+    if(type_is_float(to) && type_is_numeric(from))
+        return type_size(from) < type_size(to);
+
+    return false;
+}
+
+void type_to_str(Type* type, char* buf, UInt64 len) {
+    CORETEN_ENFORCE(len > 0);
+    buf[0] = nullchar;
+    if(NONE(type))
+        return;
+
+    switch(type->kind) {
+        case AdoradTypePointer:
+        case AdoradTypeOptional:
+            buf[0] = type->kind == AdoradTypePointer ? '&' : '?';
+            if(len > 1)
+                type_to_str(type->elem, buf + 1, len - 1);
+            else
+                buf[0] = nullchar;
+            break;
+        case AdoradTypeSlice:
+        case AdoradTypeArray: {
+            type_to_str(type->elem, buf, len);
+            UInt64 n = strlen(buf);
+            if(type->kind == AdoradTypeSlice)
+                snprintf(buf + n, len - n, "[]");
+            else
+                snprintf(buf + n, len - n, "[%" CORETEN_PRIu64 "]", type->len);
+            break;
+        }
+        case AdoradTypeTensor: {
+            UInt64 n = cast(UInt64)snprintf(buf, len, "Tensor<");
+            if(n < len) {
+                type_to_str(type->elem, buf + n, len - n);
+                n += strlen(buf + n);
+            }
+            if(n < len) {
+                if(type->len > 0)
+                    snprintf(buf + n, len - n, ", %" CORETEN_PRIu64 ">", type->len);
+                else
+                    snprintf(buf + n, len - n, ">");
+            }
+            break;
+        }
+        case AdoradTypeFunc: {
+            UInt64 n = cast(UInt64)snprintf(buf, len, "func(");
+            for(UInt32 i = 0; i < type->num_params && n < len; i++) {
+                if(i > 0)
+                    n += cast(UInt64)snprintf(buf + n, len - n, ", ");
+                if(n < len) {
+                    type_to_str(type->params[i], buf + n, len - n);
+                    n += strlen(buf + n);
+                }
+            }
+            if(type->is_variadic && n < len)
+                n += cast(UInt64)snprintf(buf + n, len - n, type->num_params > 0 ? ", ..." : "...");
+            if(n < len)
+                n += cast(UInt64)snprintf(buf + n, len - n, ") -> ");
+            if(n < len)
+                type_to_str(type->ret, buf + n, len - n);
+            break;
+        }
+        default:
+            snprintf(buf, len, "%s", type->name);
+            break;
+    }
+}
@@ -14,6 +14,8 @@ Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
 #ifndef ADORAD_TYPES_H 
 #define ADORAD_TYPES_H 
 
+#include <adorad/core/types.h>
+
 // list of Data types used in the Adorad Programming Language
 typedef enum {
     AdoradTypeAny, 
@@ -50,8 +52,90 @@ typedef enum {
 
     // Quaternion
     AdoradTypeQuaternion128, 
-    AdoradTypeQuaternion256 
+    AdoradTypeQuaternion256,
+
+    // Types that aren't spelled out by name (or only exist inside the compiler)
+    AdoradTypeVoid,     // the return type of functions that don't return anything
+    AdoradTypeInvalid,  // the type of an expression that failed to check (so that errors aren't reported twice)
+
+    // Composite types (see `type_pointer_to()` and friends)
+    AdoradTypePointer,  // `&T`
+    AdoradTypeOptional, // `?T`
+    AdoradTypeSlice,    // `T[]`
+    AdoradTypeArray,    // `T[N]`
+    AdoradTypeTensor,   // `Tensor<T, N>`, for N > 1 (`Tensor<Int, 1>` is `TensorInt32`)
+    AdoradTypeFunc,
+    AdoradTypeStruct,
 } AdoradTypes; 
 
+// Number of primitive types (every kind up to and including `AdoradTypeInvalid`)
+#define ADORAD_NUM_PRIMITIVE_TYPES  (AdoradTypeInvalid + 1)
+
+// Every type is interned: there is exactly one `Type` for every distinct type, and it's known by a unique 32-bit 
+// TypeId. Comparing two types is an integer (or pointer) comparison, no matter how deeply nested they are.
+// Primitive types have the TypeIds `1 + kind`; composite types are numbered in order of creation.
+typedef UInt32 TypeId;
+#define TYPE_ID_NONE    0   // "not yet typed"
+
+typedef struct Type Type;
+
+// A resolved type, as seen by the checker. Types are immutable and live for as long as the program does.
+struct Type {
+    AdoradTypes kind;
+    TypeId id;
+    const char* name;       // spelling of primitive types, or the name of a struct (null otherwise)
+    Type* elem;             // `T` in `&T`, `?T`, `T[]`, `T[N]` and tensors of `T`
+    UInt64 len;             // `N` in `T[N]`, or the rank of a tensor (0 if unknown)
+    Type** params;          // parameter types (functions only)
+    UInt32 num_params;
+    bool is_variadic;
+    Type* ret;              // return type (functions only)
+};
+
+// The type `id` refers to (never null)
+Type* type_get(TypeId id);
+// Number of distinct types created so far (primitives included)
+UInt32 type_count();
+
+// The type that `kind` names (primitives, `Void` and `Invalid` only)
+Type* type_primitive(AdoradTypes kind);
+// Look up a primitive type by its spelling (eg: `Int`, `Float64`). Returns null for unknown names.
+Type* type_from_name(const char* name, UInt64 len);
+
+// Composite types. These return the one and only `Type` with the given structure, creating it if needed.
+// They are safe to call from any thread.
+Type* type_pointer_to(Type* elem);
+Type* type_optional_of(Type* elem);
+Type* type_slice_of(Type* elem);
+Type* type_array_of(Type* elem, UInt64 len);
+// `rank` can be 0 if the number of dimensions is unknown
+Type* type_tensor_of(Type* elem, UInt64 rank);
+// `params` is copied
+Type* type_func(Type** params, UInt32 num_params, bool is_variadic, Type* ret);
+// Structs are nominal: there is one struct type per name. `name` is copied.
+Type* type_struct(const char* name, UInt64 len);
+
+// Types are interned, so this is a pointer comparison
+bool type_equals(Type* a, Type* b);
+
+bool type_is_integer(Type* type);
+bool type_is_signed(Type* type);
+bool type_is_float(Type* type);
+bool type_is_numeric(Type* type);
+// The element type of a tensor type (`Int` for `TensorInt32` and `Tensor<Int, 2>`), or null if `type` isn't one
+Type* type_tensor_elem(Type* type);
+// The number of dimensions of a tensor type (1 for `TensorInt32`, 0 if `type` isn't one)
+UInt32 type_tensor_rank(Type* type);
+// The tensor type of `elem`s (`TensorInt32` for `Int`), or null if there isn't one
+Type* type_tensor_for(Type* elem);
+// Size (in bytes) of a primitive numeric type (0 for anything else)
+UInt32 type_size(Type* type);
+// Can a value of type `from` be stored in a location of type `to`?
+// Besides identical types, this allows lossless numeric promotions (`Int8` -> `Int`, `Int` -> `Float64`, ...), 
+// `T` -> `?T`, `Null` -> `?T`, `T[N]` -> `T[]`, and anything -> `Any`.
+bool type_is_assignable(Type* to, Type* from);
+// Write a readable spelling of `type` into `buf` (always null-terminated)
+void type_to_str(Type* type, char* buf, UInt64 len);
+
 
 #endif // ADORAD_TYPES_H 
\ No newline at end of file
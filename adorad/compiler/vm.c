@@ -0,0 +1,1996 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <adorad/core/compilers.h>
+#include <adorad/compiler/vm.h>
+#include <adorad/compiler/opt.h>
+#include <adorad/runtime/matmul.h>
+#include <adorad/runtime/sort.h>
+
+static const char* vm_op_names[VmOpCount + 1] = {
+    #define VMOP(op, name)  name
+        ALLVMOPS
+    #undef VMOP
+};
+
+const char* vm_op_name(VmOp op) {
+    return op < VmOpCount ? vm_op_names[op] : "<invalid>";
+}
+
+#define VM_MAX_REGS     UINT16_MAX
+
+// Types --------------------------------------------------------------------------------------------------------------
+
+// Registers taken by a value of `type`, or -1 if the VM can't hold one (yet)
+static Int32 vm_width(Type* type) {
+    switch(type->kind) {
+        case AdoradTypeVoid:
+        case AdoradTypeNull:
+            return 0;
+        case AdoradTypeBool: case AdoradTypeByte: case AdoradTypeString: case AdoradTypeRune:
+        case AdoradTypeInt8: case AdoradTypeInt16: case AdoradTypeInt: case AdoradTypeInt64:
+        case AdoradTypeUInt16: case AdoradTypeUInt32: case AdoradTypeUInt64:
+        case AdoradTypeFloat32: case AdoradTypeFloat64:
+        case AdoradTypePointer: case AdoradTypeFunc:
+        case AdoradTypeTensorInt16: case AdoradTypeTensorInt32: case AdoradTypeTensorInt64:
+        case AdoradTypeTensorFloat32: case AdoradTypeTensorFloat64: case AdoradTypeTensor:
+            return 1;
+        case AdoradTypeOptional:
+            return vm_width(type->elem) == 1 ? 2 : -1;
+        default:
+            return -1;
+    }
+}
+
+// Integers, `Bool`s, `Rune`s, pointers and functions: compared (and moved around) as plain 64-bit integers
+static bool vm_is_int_like(Type* type) {
+    return opt_int_bits(type) > 0 || type->kind == AdoradTypeRune || type->kind == AdoradTypePointer ||
+           type->kind == AdoradTypeFunc;
+}
+
+// The number of bits of an integer type (`Rune`s are 32-bit), or 0
+static UInt32 vm_int_bits(Type* type) {
+    return type->kind == AdoradTypeRune ? 32 : opt_int_bits(type);
+}
+
+static bool vm_is_signed(Type* type) {
+    return type->kind == AdoradTypeRune || type_is_signed(type);
+}
+
+// Is every value of type `from` already a value of type `to`, bit for bit?
+static bool vm_is_noop_convert(Type* from, Type* to) {
+    if(from == to)
+        return true;
+    if(from->kind == AdoradTypeOptional && to->kind == AdoradTypeOptional)
+        return vm_is_noop_convert(from->elem, to->elem);
+    if(from->kind == AdoradTypeFloat32 && to->kind == AdoradTypeFloat64)
+        return true;
+
+    UInt32 from_bits = vm_int_bits(from);
+    UInt32 to_bits = vm_int_bits(to);
+    if(from_bits == 0 || to_bits == 0)
+        return false;
+    if(to_bits == 64)
+        return true;
+    if(vm_is_signed(to))
+        return vm_is_signed(from) ? from_bits <= to_bits : from_bits < to_bits;
+    return !vm_is_signed(from) && from_bits <= to_bits;
+}
+
+static inline Type* vm_type_of(IrFunc* func, IrValue value) {
+    return type_get(ir_inst(func, value)->type);
+}
+
+// Strings -----------------------------------------------------------------------------------------------------------
+
+static VmString* vm_alloc_string(UInt64 len) {
+    VmString* str = cast(VmString*)malloc(sizeof(VmString) + len + 1);
+    CORETEN_ENFORCE_NN(str, "Could not allocate memory. Memory full.");
+    str->len = len;
+    str->is_marked = false;
+    str->data[len] = nullchar;
+    return str;
+}
+
+// A string literal, with its escape sequences resolved. Literals live until the next `vm_load()`.
+static VmString* vm_literal(Vm* vm, Buff* spelled) {
+    VmString* str = vm_alloc_string(spelled->len);
+    str->len = ir_unescape(spelled, str->data);
+    str->next = vm->literals;
+    vm->literals = str;
+    return str;
+}
+
+static void vm_mark_frame(VmValue* base, UInt16* regs, UInt32 num_regs) {
+    for(UInt32 i = 0; i < num_regs; i++) {
+        VmString* str = base[regs[i]].s;
+        if(SOME(str))
+            str->is_marked = true;
+    }
+}
+
+// Free every string that no register (of a live frame) or global refers to
+static void vm_collect(Vm* vm) {
+    for(UInt32 i = 0; i < vm->num_frames; i++) {
+        VmFrame* frame = &vm->frames[i];
+        vm_mark_frame(frame->base, frame->func->string_regs, frame->func->num_string_regs);
+    }
+    if(SOME(vm->globals))
+        vm_mark_frame(vm->globals, vm->string_globals, vm->num_string_globals);
+
+    VmString** link = &vm->strings;
+    UInt64 live = 0;
+    while(SOME(*link)) {
+        VmString* str = *link;
+        if(str->is_marked) {
+            str->is_marked = false;
+            live += sizeof(VmString) + str->len + 1;
+            link = &str->next;
+        } else {
+            *link = str->next;
+            free(str);
+            vm->strings_freed++;
+        }
+    }
+    vm->heap_bytes = live;
+    vm->gc_threshold = live * 2 > VM_GC_INITIAL_THRESHOLD ? live * 2 : VM_GC_INITIAL_THRESHOLD;
+    vm->num_collections++;
+}
+
+// A new string of `len` bytes (to be filled in by the caller). It may collect first, so everything that has to survive
+// must be in a register or a global.
+static VmString* vm_gc_string(Vm* vm, UInt64 len) {
+    UInt64 bytes = sizeof(VmString) + len + 1;
+    if(vm->heap_bytes + bytes > vm->gc_threshold)
+        vm_collect(vm);
+    VmString* str = vm_alloc_string(len);
+    str->next = vm->strings;
+    vm->strings = str;
+    vm->heap_bytes += bytes;
+    return str;
+}
+
+VmString* vm_new_string(Vm* vm, const char* data, UInt64 len) {
+    VmString* str = vm_gc_string(vm, len);
+    memcpy(str->data, data, len);
+    return str;
+}
+
+static void vm_free_strings(VmString* str) {
+    while(SOME(str)) {
+        VmString* next = str->next;
+        free(str);
+        str = next;
+    }
+}
+
+// Errors -------------------------------------------------------------------------------------------------------------
+
+bool vm_error(Vm* vm, const char* format, ...) {
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    free(vm->error);
+    vm->error = cast(char*)malloc(strlen(buffer) + 1);
+    CORETEN_ENFORCE_NN(vm->error, "Could not allocate memory. Memory full.");
+    strcpy(vm->error, buffer);
+    return false;
+}
+
+static void vm_diagnostic(Vm* vm, Symbol* symbol, const char* format, ...) {
+    char buffer[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    Loc* loc = symbol->decl->loc;
+    CheckerDiagnostic diag;
+    diag.fname = SOME(loc) ? loc->fname : null;
+    diag.line = SOME(loc) ? loc->line : 0;
+    diag.col = SOME(loc) ? loc->col : 0;
+    diag.msg = cast(char*)malloc(strlen(buffer) + 1);
+    CORETEN_ENFORCE_NN(diag.msg, "Could not allocate memory. Memory full.");
+    strcpy(diag.msg, buffer);
+    vec_push(vm->diagnostics, &diag);
+}
+
+// Compiling IR to bytecode ------------------------------------------------------------------------------------------
+
+typedef struct VmMove {
+    UInt32 dst;
+    UInt32 src;
+} VmMove;
+
+typedef struct VmFixup {
+    UInt32 at;          // the jump
+    UInt32 target;      // a block, or `num_blocks + i` for the moves on edge `i` (in `VmCompiler.edges`)
+} VmFixup;
+
+typedef struct VmEdge {
+    UInt32 from;
+    UInt32 to;
+} VmEdge;
+
+typedef struct VmCompiler {
+    Vm* vm;
+    IrFunc* ir;
+    Vec* code;          // `VmInst`s
+    Vec* consts;        // `VmValue`s
+    Vec* string_regs;   // `UInt16`s
+    Vec* fixups;        // `VmFixup`s
+    Vec* edges;         // `VmEdge`s: edges into blocks with phis that need code of their own
+    Vec* moves;         // `VmMove`s (scratch)
+    UInt32* regs;       // by IR value: its (first) register, or IR_NONE
+    UInt8* flags;       // by IR value: `VmValue*` flags
+    UInt32* offsets;    // by block (then by edge): where its code starts
+    UInt32 num_regs;
+    UInt32 temp;        // a scratch register, for cycles of moves
+    bool fuse;          // fuse comparisons with branches (their offsets are only 16 bits)
+    bool failed;
+} VmCompiler;
+
+enum {
+    VmValuePhi = 1,     // the register belongs to a phi, so it's written on the edges into its block
+    VmValueFused = 2,   // a comparison that's part of the branch it feeds
+    VmValueHoisted = 4, // a constant (or function), loaded once on entry
+    VmValueImm = 8,     // a constant that's only ever an immediate operand (so it doesn't need a register)
+};
+
+static void vm_unsupported(VmCompiler* c, Type* type) {
+    if(c->failed)
+        return;
+    char buf[64];
+    type_to_str(type, buf, sizeof(buf));
+    vm_diagnostic(c->vm, c->ir->symbol, "`%s` can't run in the VM: values of type `%s` aren't supported yet",
+                  c->ir->symbol->name->data, buf);
+    c->failed = true;
+}
+
+static UInt32 vm_emit(VmCompiler* c, VmOp op, UInt32 x, UInt32 a, UInt32 b, UInt32 cc) {
+    VmInst inst;
+    inst.op = cast(UInt8)op;
+    inst.x = cast(UInt8)x;
+    inst.a = cast(UInt16)a;
+    inst.b = cast(UInt16)b;
+    inst.c = cast(UInt16)cc;
+    vec_push(c->code, &inst);
+    return cast(UInt32)vec_size(c->code) - 1;
+}
+
+static UInt32 vm_emit_bx(VmCompiler* c, VmOp op, UInt32 x, UInt32 a, UInt32 bx) {
+    VmInst inst;
+    inst.op = cast(UInt8)op;
+    inst.x = cast(UInt8)x;
+    inst.a = cast(UInt16)a;
+    inst.bx = bx;
+    vec_push(c->code, &inst);
+    return cast(UInt32)vec_size(c->code) - 1;
+}
+
+static void vm_emit_jump(VmCompiler* c, VmOp op, UInt32 a, UInt32 b, UInt32 target) {
+    VmFixup fixup;
+    fixup.at = op >= VmOpJumpEq && op <= VmOpJumpLeU ? vm_emit(c, op, 0, a, b, 0) : vm_emit_bx(c, op, 0, a, 0);
+    fixup.target = target;
+    vec_push(c->fixups, &fixup);
+}
+
+static UInt32 vm_const(VmCompiler* c, VmValue value) {
+    vec_push(c->consts, &value);
+    return cast(UInt32)vec_size(c->consts) - 1;
+}
+
+static void vm_emit_int(VmCompiler* c, UInt32 reg, UInt64 value) {
+    if(cast(Int64)value >= INT32_MIN && cast(Int64)value <= INT32_MAX) {
+        vm_emit_bx(c, VmOpLoadI, 0, reg, cast(UInt32)cast(Int32)cast(Int64)value);
+    } else {
+        VmValue k;
+        k.u = value;
+        vm_emit_bx(c, VmOpLoadK, 0, reg, vm_const(c, k));
+    }
+}
+
+static void vm_emit_string(VmCompiler* c, UInt32 reg, Buff* spelled) {
+    VmValue k;
+    k.s = vm_literal(c->vm, spelled);
+    vm_emit_bx(c, VmOpLoadK, 0, reg, vm_const(c, k));
+}
+
+static void vm_emit_zero(VmCompiler* c, Type* type, UInt32 reg) {
+    if(type->kind == AdoradTypeString) {
+        Buff empty = {0};
+        vm_emit_string(c, reg, &empty);
+        return;
+    }
+    vm_emit_int(c, reg, 0);
+    if(type->kind == AdoradTypeOptional)
+        vm_emit_int(c, reg + 1, 1);
+}
+
+static inline UInt32 vm_reg(VmCompiler* c, IrValue value) {
+    return c->regs[value];
+}
+
+static UInt32 vm_alloc_regs(VmCompiler* c, Type* type) {
+    Int32 width = vm_width(type);
+    if(width < 0) {
+        vm_unsupported(c, type);
+        width = 0;
+    }
+    UInt32 reg = c->num_regs;
+    c->num_regs += cast(UInt32)width;
+    if(type->kind == AdoradTypeString || (type->kind == AdoradTypeOptional && type->elem->kind == AdoradTypeString)) {
+        UInt16 string_reg = cast(UInt16)reg;
+        vec_push(c->string_regs, &string_reg);
+    }
+    return reg;
+}
+
+// Can constant `k` be operand `operand` of `user` as an immediate (the right-hand side of `add`/`sub`)?
+static bool vm_is_imm(VmCompiler* c, IrInst* user, UInt32 operand, IrInst* k) {
+    if(k->op != IrOpConst || (user->op != IrOpAdd && user->op != IrOpSub) || vm_int_bits(type_get(user->type)) == 0)
+        return false;
+    Int64 value = cast(Int64)opt_normalize(type_get(k->type), k->imm);
+    if(user->op == IrOpAdd)
+        return value >= INT16_MIN && value <= INT16_MAX;
+    return user->op == IrOpSub && operand == 1 && value > INT16_MIN && value <= INT16_MAX + 1;
+}
+
+// The operand of `user` that is an immediate: the right-hand side if it can be, or else the left-hand side (`k + x`).
+// IR_NONE if neither can. Only one of them can be, even if both are constants.
+static UInt32 vm_imm_operand(VmCompiler* c, IrInst* user) {
+    if(user->num_operands != 2)
+        return IR_NONE;
+    for(UInt32 i = 2; i > 0; i--) {
+        IrValue operand = *cast(IrValue*)vec_at(c->ir->operands, user->operands + i - 1);
+        if(vm_is_imm(c, user, i - 1, ir_inst(c->ir, operand)))
+            return i - 1;
+    }
+    return IR_NONE;
+}
+
+// Is every use of constant `inst` an immediate (so it doesn't need a register)?
+static bool vm_is_imm_only(VmCompiler* c, IrInst* inst) {
+    if(inst->op != IrOpConst || inst->num_uses == 0)
+        return false;
+    for(UInt32 use = inst->uses; use != IR_NONE; use = (cast(IrUse*)vec_at(c->ir->uses, use))->next) {
+        IrUse* u = cast(IrUse*)vec_at(c->ir->uses, use);
+        IrInst* user = ir_inst(c->ir, u->user);
+        if(vm_imm_operand(c, user) != u->operand - user->operands)
+            return false;
+    }
+    return true;
+}
+
+// If `value` (instruction `index` of `block`) is only there to be the next value of a phi (`i + 1` in a loop, say),
+// that phi: `value` can simply be written to the phi's register, as long as nothing reads the phi's current value
+// after that (including the moves on the edge).
+static IrValue vm_coalesce(VmCompiler* c, IrValue value, UInt32 block, UInt64 index) {
+    IrFunc* ir = c->ir;
+    IrInst* inst = ir_inst(ir, value);
+    if(inst->num_uses != 1 || (c->flags[value] & VmValueHoisted))
+        return IR_NONE;
+    IrUse* use = cast(IrUse*)vec_at(ir->uses, inst->uses);
+    IrInst* phi = ir_inst(ir, use->user);
+    UInt32 pred = use->operand - phi->operands;
+    IrBlock* from = ir_block(ir, block);
+    IrValue* body = cast(IrValue*)vec_begin(from->insts);
+    UInt64 num_insts = vec_size(from->insts);
+    IrInst* term = ir_inst(ir, body[num_insts - 1]);
+    if(phi->op != IrOpPhi || term->op != IrOpJump || term->targets[0] != phi->block ||
+       *cast(UInt32*)vec_at(ir_block(ir, phi->block)->preds, pred) != block || inst->type != phi->type)
+        return IR_NONE;
+
+    for(UInt64 i = index + 1; i < num_insts; i++)
+        for(UInt32 k = 0; k < ir_inst(ir, body[i])->num_operands; k++)
+            if(ir_operand(ir, body[i], k) == use->user)
+                return IR_NONE;
+    Vec* phis = ir_block(ir, phi->block)->phis;
+    for(UInt64 i = 0; i < vec_size(phis); i++)
+        if(ir_operand(ir, *cast(IrValue*)vec_at(phis, i), pred) == use->user)
+            return IR_NONE;
+    return use->user;
+}
+
+// Give every value its registers (parameters first, then phis, then everything else), and decide what's hoisted,
+// fused, or an immediate
+static void vm_assign_regs(VmCompiler* c) {
+    IrFunc* ir = c->ir;
+    UInt32 num_values = cast(UInt32)vec_size(ir->insts);
+    for(UInt32 i = 0; i < num_values; i++)
+        c->regs[i] = IR_NONE;
+
+    UInt32* param_regs = null;
+    Type* type = ir->symbol->type;
+    if(ir->symbol->kind == SymbolKindFunc) {
+        param_regs = cast(UInt32*)malloc((type->num_params + 1) * sizeof(UInt32));
+        CORETEN_ENFORCE_NN(param_regs, "Could not allocate memory. Memory full.");
+        for(UInt32 i = 0; i < type->num_params; i++)
+            param_regs[i] = vm_alloc_regs(c, type->params[i]);
+    }
+
+    UInt64 num_blocks = vec_size(ir->blocks);
+    for(UInt64 b = 0; b < num_blocks; b++) {
+        IrBlock* block = ir_block(ir, cast(UInt32)b);
+        for(UInt64 i = 0; i < vec_size(block->phis); i++) {
+            IrValue phi = *cast(IrValue*)vec_at(block->phis, i);
+            c->regs[phi] = vm_alloc_regs(c, vm_type_of(ir, phi));
+            c->flags[phi] |= VmValuePhi;
+        }
+    }
+
+    for(UInt64 b = 0; b < num_blocks; b++) {
+        IrBlock* block = ir_block(ir, cast(UInt32)b);
+        UInt64 num_insts = vec_size(block->insts);
+        for(UInt64 i = 0; i < num_insts; i++) {
+            IrValue value = *cast(IrValue*)vec_at(block->insts, i);
+            IrInst* inst = ir_inst(ir, value);
+            Type* inst_type = inst->type != TYPE_ID_NONE ? type_get(inst->type) : null;
+            switch(inst->op) {
+                case IrOpParam:
+                    c->regs[value] = param_regs[inst->imm];
+                    continue;
+                case IrOpConst:
+                case IrOpConstFloat:
+                case IrOpConstString:
+                case IrOpNull:
+                case IrOpZero:
+                    c->flags[value] |= VmValueHoisted;
+                    if(vm_is_imm_only(c, inst)) {
+                        c->flags[value] |= VmValueImm;
+                        continue;
+                    }
+                    break;
+                case IrOpFunc: {
+                    // Only needed in a register if it isn't just called
+                    c->flags[value] |= VmValueHoisted | VmValueImm;
+                    for(UInt32 use = inst->uses; use != IR_NONE;
+                        use = (cast(IrUse*)vec_at(ir->uses, use))->next) {
+                        IrUse* u = cast(IrUse*)vec_at(ir->uses, use);
+                        IrInst* user = ir_inst(ir, u->user);
+                        if(user->op != IrOpCall || u->operand != user->operands)
+                            c->flags[value] &= ~VmValueImm;
+                    }
+                    if(c->flags[value] & VmValueImm)
+                        continue;
+                    break;
+                }
+                case IrOpConvert: {
+                    IrValue from = ir_operand(ir, value, 0);
+                    if(c->regs[from] != IR_NONE && !(c->flags[from] & VmValuePhi) &&
+                       vm_is_noop_convert(vm_type_of(ir, from), inst_type)) {
+                        c->regs[value] = c->regs[from];
+                        continue;
+                    }
+                    break;
+                }
+                case IrOpSlot: {
+                    // The pointer, then the local it points to
+                    c->regs[value] = vm_alloc_regs(c, inst_type);
+                    vm_alloc_regs(c, inst_type->elem);
+                    continue;
+                }
+                case IrOpEq: case IrOpNe: case IrOpLt: case IrOpLe: case IrOpGt: case IrOpGe: {
+                    if(!c->fuse || inst->num_uses != 1 || i + 2 != num_insts)
+                        break;
+                    IrValue* body = cast(IrValue*)vec_begin(block->insts);
+                    IrInst* term = ir_inst(ir, body[num_insts - 1]);
+                    if(term->op == IrOpBranch && ir_operand(ir, body[num_insts - 1], 0) == value &&
+                       vm_is_int_like(vm_type_of(ir, ir_operand(ir, value, 0)))) {
+                        c->flags[value] |= VmValueFused;
+                        continue;
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+            if(NONE(inst_type))
+                continue;
+            IrValue phi = vm_coalesce(c, value, cast(UInt32)b, i);
+            c->regs[value] = phi != IR_NONE ? c->regs[phi] : vm_alloc_regs(c, inst_type);
+        }
+    }
+    free(param_regs);
+    c->temp = c->num_regs++;
+}
+
+// `reg` truncated to (and sign- or zero-extended from) the width of `type`
+static void vm_emit_normalize(VmCompiler* c, Type* type, UInt32 dst, UInt32 src) {
+    UInt32 bits = vm_int_bits(type);
+    if(bits > 0 && bits < 64)
+        vm_emit(c, vm_is_signed(type) ? VmOpSext : VmOpZext, bits, dst, src, 0);
+    else if(dst != src)
+        vm_emit(c, VmOpMov, 0, dst, src, 0);
+}
+
+static void vm_compile_arith(VmCompiler* c, IrValue value, IrInst* inst) {
+    IrOp op = cast(IrOp)inst->op;
+    Type* type = type_get(inst->type);
+    UInt32 dst = vm_reg(c, value);
+    IrValue lhs_value = ir_operand(c->ir, value, 0);
+    IrValue rhs_value = ir_operand(c->ir, value, 1);
+
+    if(type_is_float(type)) {
+        VmOp fop = op == IrOpAdd ? VmOpFAdd : op == IrOpSub ? VmOpFSub : op == IrOpMul ? VmOpFMul : VmOpFDiv;
+        // `FAdd32` is `FAdd` rounded (and so on)
+        if(type->kind == AdoradTypeFloat32)
+            fop = cast(VmOp)(fop + (VmOpFAdd32 - VmOpFAdd));
+        vm_emit(c, fop, 0, dst, vm_reg(c, lhs_value), vm_reg(c, rhs_value));
+        return;
+    }
+
+    bool is_int = type->kind == AdoradTypeInt;
+    // `x + k`, `k + x` and `x - k`
+    if(op == IrOpAdd || op == IrOpSub) {
+        UInt32 operand = vm_imm_operand(c, inst);
+        if(operand != IR_NONE) {
+            IrValue imm = operand == 1 ? rhs_value : lhs_value;
+            IrValue other = operand == 1 ? lhs_value : rhs_value;
+            Int64 k = cast(Int64)opt_normalize(type, ir_inst(c->ir, imm)->imm);
+            if(op == IrOpSub)
+                k = -k;
+            vm_emit(c, is_int ? VmOpAddI32 : VmOpAddI, 0, dst, vm_reg(c, other), cast(UInt16)cast(Int16)k);
+            if(!is_int)
+                vm_emit_normalize(c, type, dst, dst);
+            return;
+        }
+    }
+
+    bool is_signed = vm_is_signed(type);
+    UInt32 bits = vm_int_bits(type);
+    VmOp vop = VmOpAdd;
+    bool normalize = true;
+    switch(op) {
+        case IrOpAdd: vop = is_int ? VmOpAdd32 : VmOpAdd; normalize = !is_int; break;
+        case IrOpSub: vop = is_int ? VmOpSub32 : VmOpSub; normalize = !is_int; break;
+        case IrOpMul: vop = is_int ? VmOpMul32 : VmOpMul; normalize = !is_int; break;
+        case IrOpDiv: vop = is_signed ? VmOpDiv : VmOpDivU; normalize = is_signed; break;
+        // The remainder is always smaller than the divisor
+        case IrOpMod: vop = is_signed ? VmOpMod : VmOpModU; normalize = false; break;
+        case IrOpAnd: vop = VmOpAnd; normalize = false; break;
+        case IrOpOr: vop = VmOpOr; normalize = false; break;
+        case IrOpXor: vop = VmOpXor; normalize = false; break;
+        case IrOpShl: vop = VmOpShl; break;
+        case IrOpShr: vop = is_signed ? VmOpShr : VmOpShrU; normalize = false; break;
+        default: unreachable(); break;
+    }
+    vm_emit(c, vop, bits, dst, vm_reg(c, lhs_value), vm_reg(c, rhs_value));
+    if(normalize)
+        vm_emit_normalize(c, type, dst, dst);
+}
+
+// `dst = lhs op rhs` (`Bool`)
+static void vm_compile_compare(VmCompiler* c, IrOp op, Type* type, UInt32 dst, UInt32 lhs, UInt32 rhs) {
+    if(op == IrOpGt || op == IrOpGe) {
+        UInt32 tmp = lhs;
+        lhs = rhs;
+        rhs = tmp;
+        op = op == IrOpGt ? IrOpLt : IrOpLe;
+    }
+
+    if(type_is_float(type)) {
+        VmOp fop = op == IrOpEq ? VmOpFEq : op == IrOpNe ? VmOpFNe : op == IrOpLt ? VmOpFLt : VmOpFLe;
+        vm_emit(c, fop, 0, dst, lhs, rhs);
+    } else if(vm_is_int_like(type)) {
+        bool is_signed = vm_is_signed(type);
+        VmOp iop = op == IrOpEq ? VmOpEq : op == IrOpNe ? VmOpNe :
+                   op == IrOpLt ? (is_signed ? VmOpLt : VmOpLtU) : (is_signed ? VmOpLe : VmOpLeU);
+        vm_emit(c, iop, 0, dst, lhs, rhs);
+    } else if((op == IrOpEq || op == IrOpNe) &&
+              (type->kind == AdoradTypeString || type->kind == AdoradTypeOptional)) {
+        if(type->kind == AdoradTypeString) {
+            vm_emit(c, VmOpStrEq, 0, dst, lhs, rhs);
+        } else {
+            Type* elem = type->elem;
+            UInt32 kind = type_is_float(elem) ? 1 : elem->kind == AdoradTypeString ? 2 : 0;
+            vm_emit(c, VmOpOptEq, kind, dst, lhs, rhs);
+        }
+        if(op == IrOpNe)
+            vm_emit(c, VmOpNot, 0, dst, dst, 0);
+    } else {
+        vm_unsupported(c, type);
+    }
+}
+
+// Convert the value of type `from` in `src` to `to`, into `dst` (neither is optional)
+static void vm_convert_scalar(VmCompiler* c, Type* from, Type* to, UInt32 dst, UInt32 src) {
+    if(vm_is_noop_convert(from, to)) {
+        if(dst != src)
+            vm_emit(c, VmOpMov, 0, dst, src, 0);
+    } else if(type_is_float(to)) {
+        if(!type_is_float(from))
+            vm_emit(c, vm_is_signed(from) ? VmOpIToF : VmOpUToF, 0, dst, src, 0);
+        vm_emit(c, VmOpRound32, 0, dst, type_is_float(from) ? src : dst, 0);
+        if(to->kind == AdoradTypeFloat64)
+            // `Int64` to `Float64` doesn't need rounding: undo the last instruction
+            c->code->core.len--;
+    } else if(vm_int_bits(to) > 0 && type_is_float(from)) {
+        vm_emit(c, vm_is_signed(to) ? VmOpFToI : VmOpFToU, 0, dst, src, 0);
+        vm_emit_normalize(c, to, dst, dst);
+    } else if(vm_int_bits(to) > 0 && vm_int_bits(from) > 0) {
+        vm_emit_normalize(c, to, dst, src);
+    } else {
+        vm_unsupported(c, to);
+    }
+}
+
+static void vm_compile_convert(VmCompiler* c, IrValue value, IrInst* inst) {
+    IrValue operand = ir_operand(c->ir, value, 0);
+    Type* from = vm_type_of(c->ir, operand);
+    Type* to = type_get(inst->type);
+    UInt32 dst = vm_reg(c, value);
+    UInt32 src = vm_reg(c, operand);
+    if(dst == src)
+        return;
+
+    if(to->kind != AdoradTypeOptional) {
+        vm_convert_scalar(c, from, to, dst, src);
+    } else if(from->kind == AdoradTypeNull) {
+        vm_emit_zero(c, to, dst);
+    } else if(from->kind == AdoradTypeOptional) {
+        vm_convert_scalar(c, from->elem, to->elem, dst, src);
+        vm_emit(c, VmOpMov, 0, dst + 1, src + 1, 0);
+    } else {
+        vm_convert_scalar(c, from, to->elem, dst, src);
+        vm_emit_int(c, dst + 1, 0);
+    }
+}
+
+static void vm_compile_call(VmCompiler* c, IrValue value, IrInst* inst) {
+    IrFunc* ir = c->ir;
+    IrValue callee = ir_operand(ir, value, 0);
+    IrInst* callee_inst = ir_inst(ir, callee);
+    UInt32 dst = inst->type != TYPE_ID_NONE && vm_width(type_get(inst->type)) > 0 ? vm_reg(c, value) : 0;
+
+    // The registers of the arguments, one by one
+    UInt32 num_args = 0;
+    for(UInt32 i = 1; i < inst->num_operands; i++) {
+        Int32 width = vm_width(vm_type_of(ir, ir_operand(ir, value, i)));
+        num_args += width > 0 ? cast(UInt32)width : 0;
+    }
+    if(callee_inst->op == IrOpFunc)
+        vm_emit_bx(c, VmOpCall, 0, dst, callee_inst->symbol->unit);
+    else
+        vm_emit(c, VmOpCallR, 0, dst, vm_reg(c, callee), num_args);
+
+    VmInst words = {0};
+    UInt32 n = 0;
+    for(UInt32 i = 1; i < inst->num_operands; i++) {
+        IrValue arg = ir_operand(ir, value, i);
+        Int32 width = vm_width(vm_type_of(ir, arg));
+        for(Int32 w = 0; w < width; w++) {
+            words.args[n++ % 4] = cast(UInt16)(vm_reg(c, arg) + cast(UInt32)w);
+            if(n % 4 == 0) {
+                vec_push(c->code, &words);
+                memset(&words, 0, sizeof(words));
+            }
+        }
+    }
+    if(n % 4 != 0)
+        vec_push(c->code, &words);
+}
+
+// The registers of the values of the holes follow the `fmt`, like the arguments of a call
+static void vm_compile_format(VmCompiler* c, IrValue value, IrInst* inst) {
+    VmValue k;
+    k.fmt = inst->format;
+    vm_emit_bx(c, VmOpFormat, 0, vm_reg(c, value), vm_const(c, k));
+
+    VmInst words = {0};
+    for(UInt32 i = 0; i < inst->num_operands; i++) {
+        words.args[i % 4] = cast(UInt16)vm_reg(c, ir_operand(c->ir, value, i));
+        if(i % 4 == 3) {
+            vec_push(c->code, &words);
+            memset(&words, 0, sizeof(words));
+        }
+    }
+    if(inst->num_operands % 4 != 0)
+        vec_push(c->code, &words);
+}
+
+// Moves for the phis of `to`, when it's entered from `from`, in an order that doesn't overwrite a register before
+// it's read
+static void vm_compile_moves(VmCompiler* c, UInt32 from, UInt32 to) {
+    IrBlock* block = ir_block(c->ir, to);
+    UInt64 num_phis = vec_size(block->phis);
+    if(num_phis == 0)
+        return;
+    UInt32 pred = 0;
+    while(*cast(UInt32*)vec_at(block->preds, pred) != from)
+        pred++;
+
+    vec_clear(c->moves);
+    for(UInt64 i = 0; i < num_phis; i++) {
+        IrValue phi = *cast(IrValue*)vec_at(block->phis, i);
+        IrValue operand = ir_operand(c->ir, phi, pred);
+        Int32 width = vm_width(vm_type_of(c->ir, phi));
+        for(Int32 w = 0; w < width; w++) {
+            VmMove move;
+            move.dst = vm_reg(c, phi) + cast(UInt32)w;
+            move.src = vm_reg(c, operand) + cast(UInt32)w;
+            if(move.dst != move.src)
+                vec_push(c->moves, &move);
+        }
+    }
+
+    VmMove* moves = cast(VmMove*)vec_begin(c->moves);
+    UInt64 num_moves = vec_size(c->moves);
+    while(num_moves > 0) {
+        bool found = false;
+        for(UInt64 i = 0; i < num_moves && !found; i++) {
+            bool is_read = false;
+            for(UInt64 k = 0; k < num_moves && !is_read; k++)
+                is_read = k != i && moves[k].src == moves[i].dst;
+            if(!is_read) {
+                vm_emit(c, VmOpMov, 0, moves[i].dst, moves[i].src, 0);
+                moves[i] = moves[--num_moves];
+                found = true;
+            }
+        }
+        if(!found) {
+            // A cycle: save one of the registers, and read it from the copy instead
+            UInt32 saved = moves[0].dst;
+            vm_emit(c, VmOpMov, 0, c->temp, saved, 0);
+            for(UInt64 k = 0; k < num_moves; k++)
+                if(moves[k].src == saved)
+                    moves[k].src = c->temp;
+        }
+    }
+}
+
+// Where to jump to go from `from` to `to`: the block itself, or code that sets its phis first
+static UInt32 vm_edge_target(VmCompiler* c, UInt32 from, UInt32 to) {
+    if(vec_size(ir_block(c->ir, to)->phis) == 0)
+        return to;
+    VmEdge edge;
+    edge.from = from;
+    edge.to = to;
+    vec_push(c->edges, &edge);
+    return cast(UInt32)(vec_size(c->ir->blocks) + vec_size(c->edges) - 1);
+}
+
+static void vm_compile_branch(VmCompiler* c, UInt32 block, IrValue value, IrInst* inst) {
+    IrValue cond = ir_operand(c->ir, value, 0);
+    UInt32 next = block + 1;
+    UInt32 then_block = inst->targets[0];
+    UInt32 else_block = inst->targets[1];
+    UInt32 then_target = vm_edge_target(c, block, then_block);
+    UInt32 else_target = vm_edge_target(c, block, else_block);
+
+    if(c->flags[cond] & VmValueFused) {
+        IrInst* cmp = ir_inst(c->ir, cond);
+        IrOp op = cast(IrOp)cmp->op;
+        UInt32 lhs = vm_reg(c, ir_operand(c->ir, cond, 0));
+        UInt32 rhs = vm_reg(c, ir_operand(c->ir, cond, 1));
+        bool is_signed = vm_is_signed(vm_type_of(c->ir, ir_operand(c->ir, cond, 0)));
+
+        // Jump to `then` if the comparison holds, or to `else` if it doesn't (when `then` comes next)
+        bool invert = then_target == next && else_target != next;
+        if(invert) {
+            UInt32 tmp = then_target;
+            then_target = else_target;
+            else_target = tmp;
+            switch(op) {
+                case IrOpEq: op = IrOpNe; break;
+                case IrOpNe: op = IrOpEq; break;
+                case IrOpLt: op = IrOpGe; break;
+                case IrOpLe: op = IrOpGt; break;
+                case IrOpGt: op = IrOpLe; break;
+                case IrOpGe: op = IrOpLt; break;
+                default: break;
+            }
+        }
+        if(op == IrOpGt || op == IrOpGe) {
+            UInt32 tmp = lhs;
+            lhs = rhs;
+            rhs = tmp;
+            op = op == IrOpGt ? IrOpLt : IrOpLe;
+        }
+        VmOp jop = op == IrOpEq ? VmOpJumpEq : op == IrOpNe ? VmOpJumpNe :
+                   op == IrOpLt ? (is_signed ? VmOpJumpLt : VmOpJumpLtU) : (is_signed ? VmOpJumpLe : VmOpJumpLeU);
+        vm_emit_jump(c, jop, lhs, rhs, then_target);
+    } else if(then_target == next && else_target != next) {
+        vm_emit_jump(c, VmOpJumpIfNot, vm_reg(c, cond), 0, else_target);
+        else_target = next;
+    } else {
+        vm_emit_jump(c, VmOpJumpIf, vm_reg(c, cond), 0, then_target);
+    }
+    if(else_target != next)
+        vm_emit_jump(c, VmOpJump, 0, 0, else_target);
+}
+
+static void vm_compile_inst(VmCompiler* c, UInt32 block, IrValue value) {
+    IrFunc* ir = c->ir;
+    IrInst* inst = ir_inst(ir, value);
+    Type* type = inst->type != TYPE_ID_NONE ? type_get(inst->type) : null;
+    UInt32 dst = c->regs[value];
+
+    switch(inst->op) {
+        case IrOpNop:
+        case IrOpParam:
+        case IrOpPhi:
+            break;
+
+        case IrOpConst: vm_emit_int(c, dst, opt_normalize(type, inst->imm)); break;
+        case IrOpConstFloat: {
+            VmValue k;
+            k.f = inst->fimm;
+            vm_emit_bx(c, VmOpLoadK, 0, dst, vm_const(c, k));
+            break;
+        }
+        case IrOpConstString: vm_emit_string(c, dst, inst->str); break;
+        case IrOpNull:
+            if(type->kind == AdoradTypeOptional)
+                vm_emit_zero(c, type, dst);
+            break;
+        case IrOpZero: vm_emit_zero(c, type, dst); break;
+        case IrOpFunc: vm_emit_bx(c, VmOpLoadF, 0, dst, inst->symbol->unit); break;
+
+        case IrOpLoadGlobal:
+            vm_emit_bx(c, VmOpGetGlobal, cast(UInt32)vm_width(type), dst, c->vm->global_offsets[inst->symbol->unit]);
+            break;
+        case IrOpStoreGlobal:
+            vm_emit_bx(c, VmOpSetGlobal, cast(UInt32)vm_width(inst->symbol->type), vm_reg(c, ir_operand(ir, value, 0)),
+                       c->vm->global_offsets[inst->symbol->unit]);
+            break;
+        case IrOpGlobalAddr:
+            vm_emit_bx(c, VmOpGlobalAddr, 0, dst, c->vm->global_offsets[inst->symbol->unit]);
+            break;
+        case IrOpSlot:
+            // Locals whose address is taken start out as zero, like any other
+            vm_emit_zero(c, type->elem, dst + 1);
+            vm_emit(c, VmOpAddr, 0, dst, dst + 1, 0);
+            break;
+        case IrOpLoad:
+            vm_emit(c, VmOpLoad, cast(UInt32)vm_width(type), dst, vm_reg(c, ir_operand(ir, value, 0)), 0);
+            break;
+        case IrOpStore: {
+            IrValue stored = ir_operand(ir, value, 1);
+            vm_emit(c, VmOpStore, cast(UInt32)vm_width(vm_type_of(ir, stored)), vm_reg(c, ir_operand(ir, value, 0)),
+                    vm_reg(c, stored), 0);
+            break;
+        }
+
+        // The dtypes are in the same order as the tensor types
+        case IrOpTensorNew:
+            vm_emit(c, VmOpTensorNew, type->kind - AdoradTypeTensorInt16, dst, vm_reg(c, ir_operand(ir, value, 0)), 0);
+            break;
+        case IrOpTensorLen: vm_emit(c, VmOpTensorLen, 0, dst, vm_reg(c, ir_operand(ir, value, 0)), 0); break;
+        case IrOpTensorGet:
+            vm_emit(c, VmOpTensorGet, 0, dst, vm_reg(c, ir_operand(ir, value, 0)), vm_reg(c, ir_operand(ir, value, 1)));
+            break;
+        case IrOpTensorPush:
+            vm_emit(c, VmOpTensorPush, 0, vm_reg(c, ir_operand(ir, value, 0)), vm_reg(c, ir_operand(ir, value, 1)), 0);
+            break;
+        case IrOpTensorDim:
+            vm_emit(c, VmOpTensorDim, cast(UInt32)inst->imm, dst, vm_reg(c, ir_operand(ir, value, 0)), 0);
+            break;
+        case IrOpTensorSet:
+            vm_emit(c, VmOpTensorSet, 0, vm_reg(c, ir_operand(ir, value, 0)), vm_reg(c, ir_operand(ir, value, 1)),
+                    vm_reg(c, ir_operand(ir, value, 2)));
+            break;
+        case IrOpTensorSlice: {
+            vm_emit(c, VmOpTensorSlice, 0, dst, vm_reg(c, ir_operand(ir, value, 0)), vm_reg(c, ir_operand(ir, value, 1)));
+            VmInst words = {0};
+            words.args[0] = cast(UInt16)vm_reg(c, ir_operand(ir, value, 2));
+            words.args[1] = cast(UInt16)vm_reg(c, ir_operand(ir, value, 3));
+            vec_push(c->code, &words);
+            break;
+        }
+        case IrOpTensorClone: vm_emit(c, VmOpTensorClone, 0, dst, vm_reg(c, ir_operand(ir, value, 0)), 0); break;
+        case IrOpTensorSort:
+            vm_emit(c, VmOpTensorSort, cast(UInt32)inst->imm, vm_reg(c, ir_operand(ir, value, 0)), 0, 0);
+            break;
+        case IrOpTensorSortByKey:
+            vm_emit(c, VmOpTensorSortByKey, cast(UInt32)inst->imm, vm_reg(c, ir_operand(ir, value, 0)),
+                    vm_reg(c, ir_operand(ir, value, 1)), 0);
+            break;
+        case IrOpBoundsCheck:
+            vm_emit(c, VmOpBoundsCheck, 0, vm_reg(c, ir_operand(ir, value, 0)), vm_reg(c, ir_operand(ir, value, 1)), 0);
+            break;
+
+        case IrOpAdd: case IrOpSub: case IrOpMul: case IrOpDiv: case IrOpMod:
+        case IrOpAnd: case IrOpOr: case IrOpXor: case IrOpShl: case IrOpShr:
+            vm_compile_arith(c, value, inst);
+            break;
+        case IrOpNeg:
+            if(type_is_float(type)) {
+                vm_emit(c, VmOpFNeg, 0, dst, vm_reg(c, ir_operand(ir, value, 0)), 0);
+            } else {
+                vm_emit(c, VmOpNeg, 0, dst, vm_reg(c, ir_operand(ir, value, 0)), 0);
+                vm_emit_normalize(c, type, dst, dst);
+            }
+            break;
+        case IrOpNot: vm_emit(c, VmOpNot, 0, dst, vm_reg(c, ir_operand(ir, value, 0)), 0); break;
+        case IrOpConcat:
+            vm_emit(c, VmOpConcat, 0, dst, vm_reg(c, ir_operand(ir, value, 0)), vm_reg(c, ir_operand(ir, value, 1)));
+            break;
+        case IrOpFormat: vm_compile_format(c, value, inst); break;
+
+        case IrOpEq: case IrOpNe: case IrOpLt: case IrOpLe: case IrOpGt: case IrOpGe:
+            if(!(c->flags[value] & VmValueFused)) {
+                IrValue lhs = ir_operand(ir, value, 0);
+                vm_compile_compare(c, cast(IrOp)inst->op, vm_type_of(ir, lhs), dst, vm_reg(c, lhs),
+                                   vm_reg(c, ir_operand(ir, value, 1)));
+            }
+            break;
+        case IrOpIsNull: vm_emit(c, VmOpIsNull, 0, dst, vm_reg(c, ir_operand(ir, value, 0)), 0); break;
+        case IrOpConvert: vm_compile_convert(c, value, inst); break;
+        case IrOpCall: vm_compile_call(c, value, inst); break;
+
+        case IrOpJump:
+            vm_compile_moves(c, block, inst->targets[0]);
+            if(inst->targets[0] != block + 1)
+                vm_emit_jump(c, VmOpJump, 0, 0, inst->targets[0]);
+            break;
+        case IrOpBranch: vm_compile_branch(c, block, value, inst); break;
+        case IrOpReturn:
+            if(inst->num_operands == 0) {
+                vm_emit(c, VmOpReturn, 0, 0, 0, 0);
+            } else {
+                IrValue result = ir_operand(ir, value, 0);
+                vm_emit(c, VmOpReturn, cast(UInt32)vm_width(vm_type_of(ir, result)), vm_reg(c, result), 0, 0);
+            }
+            break;
+        case IrOpUnreachable: vm_emit(c, VmOpUnreachable, 0, 0, 0, 0); break;
+
+        default:
+            vm_diagnostic(c->vm, ir->symbol, "`%s` can't run in the VM: `%s` isn't supported yet",
+                          ir->symbol->name->data, ir_op_name(cast(IrOp)inst->op));
+            c->failed = true;
+            break;
+    }
+}
+
+// Returns false if a fused branch is too far from its target (so it has to be compiled again, without fusing)
+static bool vm_compile_body(VmCompiler* c) {
+    IrFunc* ir = c->ir;
+    UInt32 num_blocks = cast(UInt32)vec_size(ir->blocks);
+    vm_assign_regs(c);
+    if(c->num_regs > VM_MAX_REGS) {
+        vm_diagnostic(c->vm, ir->symbol, "`%s` is too big for the VM (it needs more than %u registers)",
+                      ir->symbol->name->data, VM_MAX_REGS);
+        c->failed = true;
+    }
+    if(c->failed)
+        return true;
+
+    // Constants (and functions) are loaded once, on entry: their registers are never written again
+    for(UInt32 b = 0; b < num_blocks; b++) {
+        IrBlock* block = ir_block(ir, b);
+        for(UInt64 i = 0; i < vec_size(block->insts); i++) {
+            IrValue value = *cast(IrValue*)vec_at(block->insts, i);
+            if((c->flags[value] & (VmValueHoisted | VmValueImm)) == VmValueHoisted)
+                vm_compile_inst(c, b, value);
+        }
+    }
+    for(UInt32 b = 0; b < num_blocks; b++) {
+        c->offsets[b] = cast(UInt32)vec_size(c->code);
+        IrBlock* block = ir_block(ir, b);
+        for(UInt64 i = 0; i < vec_size(block->insts); i++) {
+            IrValue value = *cast(IrValue*)vec_at(block->insts, i);
+            if(!(c->flags[value] & VmValueHoisted))
+                vm_compile_inst(c, b, value);
+        }
+    }
+    for(UInt64 i = 0; i < vec_size(c->edges); i++) {
+        VmEdge edge = *cast(VmEdge*)vec_at(c->edges, i);
+        c->offsets[num_blocks + i] = cast(UInt32)vec_size(c->code);
+        vm_compile_moves(c, edge.from, edge.to);
+        vm_emit_jump(c, VmOpJump, 0, 0, edge.to);
+    }
+
+    VmInst* code = cast(VmInst*)vec_begin(c->code);
+    for(UInt64 i = 0; i < vec_size(c->fixups); i++) {
+        VmFixup* fixup = cast(VmFixup*)vec_at(c->fixups, i);
+        Int64 offset = cast(Int64)c->offsets[fixup->target] - cast(Int64)(fixup->at + 1);
+        VmInst* jump = &code[fixup->at];
+        if(jump->op >= VmOpJumpEq && jump->op <= VmOpJumpLeU) {
+            if(offset < INT16_MIN || offset > INT16_MAX)
+                return false;
+            jump->c = cast(UInt16)cast(Int16)offset;
+        } else {
+            jump->sbx = cast(Int32)offset;
+        }
+    }
+    return true;
+}
+
+static VmFunc* vm_compile_func(Vm* vm, IrFunc* ir) {
+    VmFunc* func = cast(VmFunc*)calloc(1, sizeof(VmFunc));
+    CORETEN_ENFORCE_NN(func, "Could not allocate memory. Memory full.");
+    func->symbol = ir->symbol;
+    Type* type = ir->symbol->type;
+    Type* ret = ir->symbol->kind == SymbolKindFunc ? type->ret : type;
+    func->ret_width = vm_width(ret) > 0 ? cast(UInt32)vm_width(ret) : 0;
+
+    if(vec_size(ir->blocks) == 0) {
+        if(ir->symbol->kind == SymbolKindFunc) {
+            // Bound to a native (if there is one). Its frame is its arguments.
+            for(UInt64 i = 0; i < vec_size(vm->natives); i++) {
+                VmNative* native = cast(VmNative*)vec_at(vm->natives, i);
+                if(native->type == type && strcmp(native->name, ir->symbol->name->data) == 0)
+                    func->native = native->fn;
+            }
+            if(NONE(func->native))
+                vm_diagnostic(vm, ir->symbol, "`%s` doesn't have a body, and there's no native function by that name "
+                              "(and type)", ir->symbol->name->data);
+            Vec* string_regs = VEC_NEW(UInt16, 4);
+            for(UInt32 i = 0; i < type->num_params; i++) {
+                Type* param = type->params[i];
+                if(param->kind == AdoradTypeString ||
+                   (param->kind == AdoradTypeOptional && param->elem->kind == AdoradTypeString)) {
+                    UInt16 reg = cast(UInt16)func->num_params;
+                    vec_push(string_regs, &reg);
+                }
+                func->num_params += vm_width(param) > 0 ? cast(UInt32)vm_width(param) : 0;
+            }
+            func->num_regs = func->num_params > func->ret_width ? func->num_params : func->ret_width;
+            func->num_string_regs = cast(UInt32)vec_size(string_regs);
+            func->string_regs = cast(UInt16*)malloc((func->num_string_regs + 1) * sizeof(UInt16));
+            CORETEN_ENFORCE_NN(func->string_regs, "Could not allocate memory. Memory full.");
+            if(func->num_string_regs > 0)
+                memcpy(func->string_regs, vec_begin(string_regs), func->num_string_regs * sizeof(UInt16));
+            vec_free(string_regs);
+        }
+        return func;
+    }
+
+    UInt64 num_values = vec_size(ir->insts);
+    UInt64 num_blocks = vec_size(ir->blocks);
+    VmCompiler c = {0};
+    c.vm = vm;
+    c.ir = ir;
+    c.code = VEC_NEW(VmInst, 64);
+    c.consts = VEC_NEW(VmValue, 8);
+    c.string_regs = VEC_NEW(UInt16, 8);
+    c.fixups = VEC_NEW(VmFixup, 16);
+    c.edges = VEC_NEW(VmEdge, 8);
+    c.moves = VEC_NEW(VmMove, 8);
+    c.regs = cast(UInt32*)malloc((num_values + 1) * sizeof(UInt32));
+    c.flags = cast(UInt8*)calloc(num_values + 1, 1);
+    // Every branch adds at most 2 edges
+    c.offsets = cast(UInt32*)malloc((3 * num_blocks + 1) * sizeof(UInt32));
+    CORETEN_ENFORCE(SOME(c.regs) && SOME(c.flags) && SOME(c.offsets), "Could not allocate memory. Memory full.");
+
+    c.fuse = true;
+    while(!vm_compile_body(&c)) {
+        vec_clear(c.code);
+        vec_clear(c.consts);
+        vec_clear(c.string_regs);
+        vec_clear(c.fixups);
+        vec_clear(c.edges);
+        memset(c.flags, 0, num_values + 1);
+        c.num_regs = 0;
+        c.fuse = false;
+    }
+
+    if(ir->symbol->kind == SymbolKindFunc)
+        for(UInt32 i = 0; i < type->num_params; i++)
+            func->num_params += vm_width(type->params[i]) > 0 ? cast(UInt32)vm_width(type->params[i]) : 0;
+    func->num_regs = c.num_regs;
+    func->code_len = cast(UInt32)vec_size(c.code);
+    func->code = cast(VmInst*)malloc((func->code_len + 1) * sizeof(VmInst));
+    func->num_consts = cast(UInt32)vec_size(c.consts);
+    func->consts = cast(VmValue*)malloc((func->num_consts + 1) * sizeof(VmValue));
+    func->num_string_regs = cast(UInt32)vec_size(c.string_regs);
+    func->string_regs = cast(UInt16*)malloc((func->num_string_regs + 1) * sizeof(UInt16));
+    CORETEN_ENFORCE(SOME(func->code) && SOME(func->consts) && SOME(func->string_regs),
+                    "Could not allocate memory. Memory full.");
+    if(func->code_len > 0)
+        memcpy(func->code, vec_begin(c.code), func->code_len * sizeof(VmInst));
+    if(func->num_consts > 0)
+        memcpy(func->consts, vec_begin(c.consts), func->num_consts * sizeof(VmValue));
+    if(func->num_string_regs > 0)
+        memcpy(func->string_regs, vec_begin(c.string_regs), func->num_string_regs * sizeof(UInt16));
+
+    vec_free(c.code);
+    vec_free(c.consts);
+    vec_free(c.string_regs);
+    vec_free(c.fixups);
+    vec_free(c.edges);
+    vec_free(c.moves);
+    free(c.regs);
+    free(c.flags);
+    free(c.offsets);
+    return func;
+}
+
+// The interpreter ---------------------------------------------------------------------------------------------------
+
+#if defined(CORETEN_COMPILER_GCC) || defined(CORETEN_COMPILER_CLANG)
+    #define VM_THREADED_DISPATCH 1
+#endif
+
+#ifdef VM_THREADED_DISPATCH
+    #define VM_CASE(op)     label_##op:
+    #define VM_NEXT()       goto *labels[pc->op]
+#else
+    #define VM_CASE(op)     case VmOp##op:
+    #define VM_NEXT()       goto dispatch
+#endif
+
+// Run from the top frame until the frame `vm_call()` pushed returns
+static bool vm_exec(Vm* vm, VmValue* result) {
+#ifdef VM_THREADED_DISPATCH
+    static void* labels[VmOpCount + 1] = {
+        #define VMOP(op, name)  &&label_##op
+            ALLVMOPS
+        #undef VMOP
+    };
+#endif
+    VmFunc** funcs = cast(VmFunc**)vec_begin(vm->funcs);
+    VmValue* globals = vm->globals;
+    VmValue* stack_end = vm->stack + vm->stack_size;
+    VmFrame* frame = &vm->frames[vm->num_frames - 1];
+    VmFunc* func = frame->func;
+    VmValue* base = frame->base;
+    VmValue* consts = func->consts;
+    VmInst* pc = func->code;
+    VmFunc* callee = null;
+
+#define R(reg)          base[reg]
+#define VM_FAIL(...)    do { vm_error(vm, __VA_ARGS__); return false; } while(0)
+
+#ifdef VM_THREADED_DISPATCH
+    VM_NEXT();
+#else
+dispatch:
+    switch(pc->op) {
+#endif
+
+    VM_CASE(Mov) { VmInst in = *pc++; R(in.a) = R(in.b); VM_NEXT(); }
+    VM_CASE(LoadI) { VmInst in = *pc++; R(in.a).i = in.sbx; VM_NEXT(); }
+    VM_CASE(LoadK) { VmInst in = *pc++; R(in.a) = consts[in.bx]; VM_NEXT(); }
+    VM_CASE(LoadF) { VmInst in = *pc++; R(in.a).fn = funcs[in.bx]; VM_NEXT(); }
+    VM_CASE(GetGlobal) {
+        VmInst in = *pc++;
+        R(in.a) = globals[in.bx];
+        if(in.x == 2)
+            R(in.a + 1) = globals[in.bx + 1];
+        VM_NEXT();
+    }
+    VM_CASE(SetGlobal) {
+        VmInst in = *pc++;
+        globals[in.bx] = R(in.a);
+        if(in.x == 2)
+            globals[in.bx + 1] = R(in.a + 1);
+        VM_NEXT();
+    }
+    VM_CASE(GlobalAddr) { VmInst in = *pc++; R(in.a).p = &globals[in.bx]; VM_NEXT(); }
+    VM_CASE(Addr) { VmInst in = *pc++; R(in.a).p = &R(in.b); VM_NEXT(); }
+    VM_CASE(Load) {
+        VmInst in = *pc++;
+        VmValue* from = R(in.b).p;
+        R(in.a) = from[0];
+        if(in.x == 2)
+            R(in.a + 1) = from[1];
+        VM_NEXT();
+    }
+    VM_CASE(Store) {
+        VmInst in = *pc++;
+        VmValue* to = R(in.a).p;
+        to[0] = R(in.b);
+        if(in.x == 2)
+            to[1] = R(in.b + 1);
+        VM_NEXT();
+    }
+
+    VM_CASE(Add) { VmInst in = *pc++; R(in.a).u = R(in.b).u + R(in.c).u; VM_NEXT(); }
+    VM_CASE(Sub) { VmInst in = *pc++; R(in.a).u = R(in.b).u - R(in.c).u; VM_NEXT(); }
+    VM_CASE(Mul) { VmInst in = *pc++; R(in.a).u = R(in.b).u * R(in.c).u; VM_NEXT(); }
+    VM_CASE(Div) {
+        VmInst in = *pc++;
+        Int64 lhs = R(in.b).i;
+        Int64 rhs = R(in.c).i;
+        if(rhs == 0)
+            VM_FAIL("division by zero in `%s`", func->symbol->name->data);
+        if(lhs == INT64_MIN && rhs == -1)
+            VM_FAIL("division overflows in `%s`", func->symbol->name->data);
+        R(in.a).i = lhs / rhs;
+        VM_NEXT();
+    }
+    VM_CASE(DivU) {
+        VmInst in = *pc++;
+        if(R(in.c).u == 0)
+            VM_FAIL("division by zero in `%s`", func->symbol->name->data);
+        R(in.a).u = R(in.b).u / R(in.c).u;
+        VM_NEXT();
+    }
+    VM_CASE(Mod) {
+        VmInst in = *pc++;
+        Int64 lhs = R(in.b).i;
+        Int64 rhs = R(in.c).i;
+        if(rhs == 0)
+            VM_FAIL("division by zero in `%s`", func->symbol->name->data);
+        if(lhs == INT64_MIN && rhs == -1)
+            VM_FAIL("division overflows in `%s`", func->symbol->name->data);
+        R(in.a).i = lhs % rhs;
+        VM_NEXT();
+    }
+    VM_CASE(ModU) {
+        VmInst in = *pc++;
+        if(R(in.c).u == 0)
+            VM_FAIL("division by zero in `%s`", func->symbol->name->data);
+        R(in.a).u = R(in.b).u % R(in.c).u;
+        VM_NEXT();
+    }
+    VM_CASE(And) { VmInst in = *pc++; R(in.a).u = R(in.b).u & R(in.c).u; VM_NEXT(); }
+    VM_CASE(Or) { VmInst in = *pc++; R(in.a).u = R(in.b).u | R(in.c).u; VM_NEXT(); }
+    VM_CASE(Xor) { VmInst in = *pc++; R(in.a).u = R(in.b).u ^ R(in.c).u; VM_NEXT(); }
+    VM_CASE(Shl) {
+        VmInst in = *pc++;
+        if(R(in.c).u >= in.x)
+            VM_FAIL("shift by %" PRId64 " bits in `%s`", R(in.c).i, func->symbol->name->data);
+        R(in.a).u = R(in.b).u << R(in.c).u;
+        VM_NEXT();
+    }
+    VM_CASE(Shr) {
+        VmInst in = *pc++;
+        if(R(in.c).u >= in.x)
+            VM_FAIL("shift by %" PRId64 " bits in `%s`", R(in.c).i, func->symbol->name->data);
+        R(in.a).i = R(in.b).i >> R(in.c).u;
+        VM_NEXT();
+    }
+    VM_CASE(ShrU) {
+        VmInst in = *pc++;
+        if(R(in.c).u >= in.x)
+            VM_FAIL("shift by %" PRId64 " bits in `%s`", R(in.c).i, func->symbol->name->data);
+        R(in.a).u = R(in.b).u >> R(in.c).u;
+        VM_NEXT();
+    }
+    VM_CASE(Neg) { VmInst in = *pc++; R(in.a).u = 0 - R(in.b).u; VM_NEXT(); }
+    VM_CASE(Not) { VmInst in = *pc++; R(in.a).u = !R(in.b).u; VM_NEXT(); }
+    VM_CASE(AddI) { VmInst in = *pc++; R(in.a).u = R(in.b).u + cast(UInt64)cast(Int64)cast(Int16)in.c; VM_NEXT(); }
+
+    VM_CASE(Add32) { VmInst in = *pc++; R(in.a).i = cast(Int32)cast(UInt32)(R(in.b).u + R(in.c).u); VM_NEXT(); }
+    VM_CASE(Sub32) { VmInst in = *pc++; R(in.a).i = cast(Int32)cast(UInt32)(R(in.b).u - R(in.c).u); VM_NEXT(); }
+    VM_CASE(Mul32) { VmInst in = *pc++; R(in.a).i = cast(Int32)cast(UInt32)(R(in.b).u * R(in.c).u); VM_NEXT(); }
+    VM_CASE(AddI32) {
+        VmInst in = *pc++;
+        R(in.a).i = cast(Int32)cast(UInt32)(R(in.b).u + cast(UInt64)cast(Int64)cast(Int16)in.c);
+        VM_NEXT();
+    }
+    VM_CASE(Sext) {
+        VmInst in = *pc++;
+        UInt32 shift = 64 - in.x;
+        R(in.a).i = cast(Int64)(R(in.b).u << shift) >> shift;
+        VM_NEXT();
+    }
+    VM_CASE(Zext) {
+        VmInst in = *pc++;
+        UInt32 shift = 64 - in.x;
+        R(in.a).u = (R(in.b).u << shift) >> shift;
+        VM_NEXT();
+    }
+
+    VM_CASE(FAdd) { VmInst in = *pc++; R(in.a).f = R(in.b).f + R(in.c).f; VM_NEXT(); }
+    VM_CASE(FSub) { VmInst in = *pc++; R(in.a).f = R(in.b).f - R(in.c).f; VM_NEXT(); }
+    VM_CASE(FMul) { VmInst in = *pc++; R(in.a).f = R(in.b).f * R(in.c).f; VM_NEXT(); }
+    VM_CASE(FDiv) { VmInst in = *pc++; R(in.a).f = R(in.b).f / R(in.c).f; VM_NEXT(); }
+    VM_CASE(FAdd32) { VmInst in = *pc++; R(in.a).f = cast(float)(R(in.b).f + R(in.c).f); VM_NEXT(); }
+    VM_CASE(FSub32) { VmInst in = *pc++; R(in.a).f = cast(float)(R(in.b).f - R(in.c).f); VM_NEXT(); }
+    VM_CASE(FMul32) { VmInst in = *pc++; R(in.a).f = cast(float)(R(in.b).f * R(in.c).f); VM_NEXT(); }
+    VM_CASE(FDiv32) { VmInst in = *pc++; R(in.a).f = cast(float)(R(in.b).f / R(in.c).f); VM_NEXT(); }
+    VM_CASE(FNeg) { VmInst in = *pc++; R(in.a).f = -R(in.b).f; VM_NEXT(); }
+    VM_CASE(Round32) { VmInst in = *pc++; R(in.a).f = cast(double)cast(float)R(in.b).f; VM_NEXT(); }
+    VM_CASE(IToF) { VmInst in = *pc++; R(in.a).f = cast(double)R(in.b).i; VM_NEXT(); }
+    VM_CASE(UToF) { VmInst in = *pc++; R(in.a).f = cast(double)R(in.b).u; VM_NEXT(); }
+    VM_CASE(FToI) {
+        VmInst in = *pc++;
+        double value = R(in.b).f;
+        if(!(value > -9223372036854775809.0 && value < 9223372036854775808.0))
+            VM_FAIL("`%g` doesn't fit in an integer in `%s`", value, func->symbol->name->data);
+        R(in.a).i = cast(Int64)value;
+        VM_NEXT();
+    }
+    VM_CASE(FToU) {
+        VmInst in = *pc++;
+        double value = R(in.b).f;
+        if(!(value > -1.0 && value < 18446744073709551616.0))
+            VM_FAIL("`%g` doesn't fit in an integer in `%s`", value, func->symbol->name->data);
+        R(in.a).u = cast(UInt64)value;
+        VM_NEXT();
+    }
+
+    VM_CASE(Eq) { VmInst in = *pc++; R(in.a).u = R(in.b).u == R(in.c).u; VM_NEXT(); }
+    VM_CASE(Ne) { VmInst in = *pc++; R(in.a).u = R(in.b).u != R(in.c).u; VM_NEXT(); }
+    VM_CASE(Lt) { VmInst in = *pc++; R(in.a).u = R(in.b).i < R(in.c).i; VM_NEXT(); }
+    VM_CASE(Le) { VmInst in = *pc++; R(in.a).u = R(in.b).i <= R(in.c).i; VM_NEXT(); }
+    VM_CASE(LtU) { VmInst in = *pc++; R(in.a).u = R(in.b).u < R(in.c).u; VM_NEXT(); }
+    VM_CASE(LeU) { VmInst in = *pc++; R(in.a).u = R(in.b).u <= R(in.c).u; VM_NEXT(); }
+    VM_CASE(FEq) { VmInst in = *pc++; R(in.a).u = R(in.b).f == R(in.c).f; VM_NEXT(); }
+    VM_CASE(FNe) { VmInst in = *pc++; R(in.a).u = R(in.b).f != R(in.c).f; VM_NEXT(); }
+    VM_CASE(FLt) { VmInst in = *pc++; R(in.a).u = R(in.b).f < R(in.c).f; VM_NEXT(); }
+    VM_CASE(FLe) { VmInst in = *pc++; R(in.a).u = R(in.b).f <= R(in.c).f; VM_NEXT(); }
+    VM_CASE(StrEq) {
+        VmInst in = *pc++;
+        VmString* lhs = R(in.b).s;
+        VmString* rhs = R(in.c).s;
+        R(in.a).u = lhs->len == rhs->len && memcmp(lhs->data, rhs->data, lhs->len) == 0;
+        VM_NEXT();
+    }
+    VM_CASE(OptEq) {
+        VmInst in = *pc++;
+        UInt64 lhs_null = R(in.b + 1).u;
+        UInt64 rhs_null = R(in.c + 1).u;
+        if(lhs_null || rhs_null)
+            R(in.a).u = lhs_null && rhs_null;
+        else if(in.x == 1)
+            R(in.a).u = R(in.b).f == R(in.c).f;
+        else if(in.x == 2)
+            R(in.a).u = R(in.b).s->len == R(in.c).s->len &&
+                        memcmp(R(in.b).s->data, R(in.c).s->data, R(in.b).s->len) == 0;
+        else
+            R(in.a).u = R(in.b).u == R(in.c).u;
+        VM_NEXT();
+    }
+    VM_CASE(IsNull) { VmInst in = *pc++; R(in.a).u = R(in.b + 1).u; VM_NEXT(); }
+    VM_CASE(Concat) {
+        VmInst in = *pc++;
+        VmString* lhs = R(in.b).s;
+        VmString* rhs = R(in.c).s;
+        if(lhs->len == 0 || rhs->len == 0) {
+            R(in.a).s = lhs->len == 0 ? rhs : lhs;
+        } else {
+            // Both halves are in registers, so they survive a collection
+            VmString* str = vm_gc_string(vm, lhs->len + rhs->len);
+            memcpy(str->data, lhs->data, lhs->len);
+            memcpy(str->data + lhs->len, rhs->data, rhs->len);
+            R(in.a).s = str;
+        }
+        VM_NEXT();
+    }
+
+    VM_CASE(Format) {
+        VmInst in = *pc++;
+        const Format* format = consts[in.bx].fmt;
+        UInt32 num_holes = format->num_holes;
+        FormatArg stack_args[8];
+        FormatField stack_fields[8];
+        FormatArg* args = stack_args;
+        FormatField* fields = stack_fields;
+        if(num_holes > 8) {
+            args = cast(FormatArg*)malloc(num_holes * (sizeof(FormatArg) + sizeof(FormatField)));
+            CORETEN_ENFORCE_NN(args, "Could not allocate memory. Memory full.");
+            fields = cast(FormatField*)(args + num_holes);
+        }
+        const UInt16* regs = cast(const UInt16*)pc;
+        for(UInt32 i = 0; i < num_holes; i++) {
+            VmValue value = R(regs[i]);
+            if(format->holes[i].kind == FormatKindString) {
+                args[i].s.data = value.s->data;
+                args[i].s.len = value.s->len;
+            } else {
+                args[i].u = value.u;
+            }
+        }
+        pc += (num_holes + 3) / 4;
+
+        // The strings are all in registers, so they survive a collection
+        VmString* str = vm_gc_string(vm, format_length(format, args, fields));
+        format_write(format, args, fields, str->data);
+        R(in.a).s = str;
+        if(args != stack_args)
+            free(args);
+        VM_NEXT();
+    }
+
+    VM_CASE(TensorNew) {
+        VmInst in = *pc++;
+        Tensor* tensor = tensor_new(cast(TensorDType)in.x, 0, R(in.b).u);
+        vec_push(vm->tensors, &tensor);
+        R(in.a).t = tensor;
+        VM_NEXT();
+    }
+    VM_CASE(TensorLen) { VmInst in = *pc++; R(in.a).u = SOME(R(in.b).t) ? R(in.b).t->len : 0; VM_NEXT(); }
+    VM_CASE(TensorGet) { VmInst in = *pc++; R(in.a).i = tensor_get(R(in.b).t, R(in.c).u).i; VM_NEXT(); }
+    VM_CASE(TensorPush) {
+        VmInst in = *pc++;
+        TensorScalar value;
+        value.i = R(in.b).i;
+        tensor_push(R(in.a).t, value);
+        VM_NEXT();
+    }
+    VM_CASE(TensorDim) {
+        VmInst in = *pc++;
+        R(in.a).u = SOME(R(in.b).t) ? tensor_dim(R(in.b).t, in.x) : 0;
+        VM_NEXT();
+    }
+    VM_CASE(TensorSet) {
+        VmInst in = *pc++;
+        TensorScalar value;
+        value.i = R(in.c).i;
+        tensor_set(R(in.a).t, R(in.b).u, value);
+        VM_NEXT();
+    }
+    VM_CASE(TensorSlice) {
+        VmInst in = *pc++;
+        VmInst words = *pc++;
+        Tensor* tensor = R(in.b).t;
+        Int64 lower = R(in.c).i;
+        Int64 upper = R(words.args[0]).i;
+        Int64 step = R(words.args[1]).i;
+        Tensor* view = cast(Tensor*)calloc(1, sizeof(Tensor));
+        CORETEN_ENFORCE_NN(view, "Could not allocate memory. Memory full.");
+        vec_push(vm->tensors, &view);
+        if(NONE(tensor) && lower == 0 && upper == 0 && step > 0) {
+            view->rank = 1;
+            view->stride = 1;
+        } else if(NONE(tensor) || lower < 0 || upper < 0 || step <= 0 ||
+                  !tensor_slice(view, tensor, cast(UInt64)lower, cast(UInt64)upper, cast(UInt64)step)) {
+            if(step <= 0)
+                VM_FAIL("the step of a slice must be positive; got %" CORETEN_PRId64 " in `%s`", step,
+                        func->symbol->name->data);
+            VM_FAIL("slice [%" CORETEN_PRId64 "..%" CORETEN_PRId64 "] is out of bounds (the length is %" CORETEN_PRIu64
+                    ") in `%s`", lower, upper, SOME(tensor) ? tensor->len : 0, func->symbol->name->data);
+        }
+        R(in.a).t = view;
+        VM_NEXT();
+    }
+    VM_CASE(TensorClone) {
+        VmInst in = *pc++;
+        Tensor* clone = SOME(R(in.b).t) ? tensor_clone(R(in.b).t) : null;
+        if(SOME(clone))
+            vec_push(vm->tensors, &clone);
+        R(in.a).t = clone;
+        VM_NEXT();
+    }
+    VM_CASE(TensorSort) {
+        VmInst in = *pc++;
+        Tensor* tensor = R(in.a).t;
+        if(SOME(tensor)) {
+            if(NONE(vm->pool) && tensor->len >= SORT_PARALLEL_MIN)
+                vm->pool = threadpool_new(0);
+            tensor_sort(tensor, in.x != 0, vm->pool);
+        }
+        VM_NEXT();
+    }
+    VM_CASE(TensorSortByKey) {
+        VmInst in = *pc++;
+        Tensor* tensor = R(in.a).t;
+        // The keys were computed from the elements, so there are as many of them
+        if(SOME(tensor) && SOME(R(in.b).t)) {
+            if(NONE(vm->pool) && tensor->len >= SORT_PARALLEL_MIN)
+                vm->pool = threadpool_new(0);
+            tensor_sort_by_key(tensor, R(in.b).t, in.x != 0, vm->pool);
+        }
+        VM_NEXT();
+    }
+    VM_CASE(BoundsCheck) {
+        VmInst in = *pc++;
+        if(R(in.a).u >= R(in.b).u)
+            VM_FAIL("index %" CORETEN_PRId64 " is out of bounds (the length is %" CORETEN_PRIu64 ") in `%s`", R(in.a).i,
+                    R(in.b).u, func->symbol->name->data);
+        VM_NEXT();
+    }
+
+    VM_CASE(Jump) { pc += pc->sbx + 1; VM_NEXT(); }
+    VM_CASE(JumpIf) { VmInst in = *pc++; if(R(in.a).u) pc += in.sbx; VM_NEXT(); }
+    VM_CASE(JumpIfNot) { VmInst in = *pc++; if(!R(in.a).u) pc += in.sbx; VM_NEXT(); }
+    VM_CASE(JumpEq) { VmInst in = *pc++; if(R(in.a).u == R(in.b).u) pc += cast(Int16)in.c; VM_NEXT(); }
+    VM_CASE(JumpNe) { VmInst in = *pc++; if(R(in.a).u != R(in.b).u) pc += cast(Int16)in.c; VM_NEXT(); }
+    VM_CASE(JumpLt) { VmInst in = *pc++; if(R(in.a).i < R(in.b).i) pc += cast(Int16)in.c; VM_NEXT(); }
+    VM_CASE(JumpLe) { VmInst in = *pc++; if(R(in.a).i <= R(in.b).i) pc += cast(Int16)in.c; VM_NEXT(); }
+    VM_CASE(JumpLtU) { VmInst in = *pc++; if(R(in.a).u < R(in.b).u) pc += cast(Int16)in.c; VM_NEXT(); }
+    VM_CASE(JumpLeU) { VmInst in = *pc++; if(R(in.a).u <= R(in.b).u) pc += cast(Int16)in.c; VM_NEXT(); }
+
+    VM_CASE(Call) {
+        callee = funcs[pc->bx];
+        goto call;
+    }
+    VM_CASE(CallR) {
+        callee = R(pc->b).fn;
+        if(NONE(callee))
+            VM_FAIL("`%s` calls a function value that was never set", func->symbol->name->data);
+        goto call;
+    }
+    VM_CASE(Return) {
+        VmInst in = *pc;
+        VmFrame* done = &vm->frames[--vm->num_frames];
+        VmValue* to = result;
+        if(SOME(done->pc)) {
+            frame = &vm->frames[vm->num_frames - 1];
+            to = frame->base + done->dst;
+        }
+        if(in.x > 0) {
+            to[0] = R(in.a);
+            if(in.x == 2)
+                to[1] = R(in.a + 1);
+        }
+        if(NONE(done->pc))
+            return true;
+        func = frame->func;
+        base = frame->base;
+        consts = func->consts;
+        pc = done->pc;
+        VM_NEXT();
+    }
+    VM_CASE(Unreachable) { VM_FAIL("`%s` reached `unreachable`", func->symbol->name->data); }
+    VM_CASE(Count) { unreachable(); return false; }
+
+#ifndef VM_THREADED_DISPATCH
+    }
+#endif
+
+call: {
+        VmInst in = *pc++;
+        VmValue* callee_base = base + func->num_regs;
+        if(callee_base + callee->num_regs > stack_end)
+            VM_FAIL("stack overflow: `%s` needs more than %" CORETEN_PRIu64 " registers", callee->symbol->name->data,
+                    vm->stack_size);
+        if(vm->num_frames == vm->max_frames)
+            VM_FAIL("stack overflow: calls are nested more than %u deep", vm->max_frames);
+
+        UInt16* args = cast(UInt16*)pc;
+        for(UInt32 i = 0; i < callee->num_params; i++)
+            callee_base[i] = base[args[i]];
+        pc += (callee->num_params + 3) / 4;
+
+        frame = &vm->frames[vm->num_frames++];
+        frame->func = callee;
+        frame->base = callee_base;
+        frame->pc = pc;
+        frame->dst = in.a;
+        if(SOME(callee->native)) {
+            VmValue ret[2] = {0};
+            if(!callee->native(vm, callee_base, ret))
+                return false;
+            vm->num_frames--;
+            frame = &vm->frames[vm->num_frames - 1];
+            for(UInt32 i = 0; i < callee->ret_width; i++)
+                R(in.a + i) = ret[i];
+            VM_NEXT();
+        }
+        if(callee->code_len == 0)
+            VM_FAIL("`%s` doesn't have a body", callee->symbol->name->data);
+
+        // Strings are roots from the start, so they can't be left over from an earlier frame
+        for(UInt32 i = 0; i < callee->num_string_regs; i++)
+            if(callee->string_regs[i] >= callee->num_params)
+                callee_base[callee->string_regs[i]].s = null;
+        func = callee;
+        base = callee_base;
+        consts = func->consts;
+        pc = func->code;
+        VM_NEXT();
+    }
+
+#undef R
+#undef VM_FAIL
+}
+
+bool vm_call(Vm* vm, VmFunc* func, VmValue* args, VmValue* result) {
+    free(vm->error);
+    vm->error = null;
+    VmValue* base = vm->stack;
+    if(vm->num_frames > 0) {
+        VmFrame* top = &vm->frames[vm->num_frames - 1];
+        base = top->base + top->func->num_regs;
+    }
+    if(base + func->num_regs > vm->stack + vm->stack_size || vm->num_frames == vm->max_frames)
+        return vm_error(vm, "stack overflow: can't call `%s`", func->symbol->name->data);
+
+    VmValue none[2] = {0};
+    if(NONE(result))
+        result = none;
+    UInt32 num_frames = vm->num_frames;
+    if(func->num_params > 0)
+        memcpy(base, args, func->num_params * sizeof(VmValue));
+    VmFrame* frame = &vm->frames[vm->num_frames++];
+    frame->func = func;
+    frame->base = base;
+    frame->pc = null;
+    frame->dst = 0;
+
+    bool ok = false;
+    if(SOME(func->native)) {
+        ok = func->native(vm, base, result);
+    } else if(func->code_len == 0) {
+        ok = vm_error(vm, "`%s` doesn't have a body", func->symbol->name->data);
+    } else {
+        for(UInt32 i = 0; i < func->num_string_regs; i++)
+            if(func->string_regs[i] >= func->num_params)
+                base[func->string_regs[i]].s = null;
+        ok = vm_exec(vm, result);
+    }
+    vm->num_frames = num_frames;
+    return ok;
+}
+
+// Natives -----------------------------------------------------------------------------------------------------------
+
+static void vm_write(Vm* vm, const char* data, UInt64 len) {
+    if(SOME(vm->output))
+        strbuilder_append_n(vm->output, data, len);
+    else
+        fwrite(data, 1, len, stdout);
+}
+
+static bool vm_native_print(Vm* vm, VmValue* args, VmValue* result) {
+    vm_write(vm, args[0].s->data, args[0].s->len);
+    return true;
+}
+
+static bool vm_native_println(Vm* vm, VmValue* args, VmValue* result) {
+    vm_write(vm, args[0].s->data, args[0].s->len);
+    vm_write(vm, "\n", 1);
+    return true;
+}
+
+static bool vm_native_int_to_str(Vm* vm, VmValue* args, VmValue* result) {
+    char buffer[32];
+    int len = snprintf(buffer, sizeof(buffer), "%" PRId64, args[0].i);
+    result[0].s = vm_new_string(vm, buffer, cast(UInt64)len);
+    return true;
+}
+
+static bool vm_native_float_to_str(Vm* vm, VmValue* args, VmValue* result) {
+    char buffer[32];
+    int len = snprintf(buffer, sizeof(buffer), "%g", args[0].f);
+    result[0].s = vm_new_string(vm, buffer, cast(UInt64)len);
+    return true;
+}
+
+// `zeros(d0, d1, ...)`: a tensor of the shape given (its dtype and rank are those of the declaration's return type)
+static bool vm_native_zeros(Vm* vm, VmValue* args, VmValue* result) {
+    VmFunc* func = vm->frames[vm->num_frames - 1].func;
+    Type* ret = func->symbol->type->ret;
+    UInt64 shape[TENSOR_MAX_RANK];
+    for(UInt32 i = 0; i < func->num_params; i++) {
+        if(args[i].i < 0)
+            return vm_error(vm, "`zeros()` of a negative length (%" PRId64 ")", args[i].i);
+        shape[i] = args[i].u;
+    }
+    TensorDType dtype = cast(TensorDType)(type_tensor_for(type_tensor_elem(ret))->kind - AdoradTypeTensorInt16);
+    Tensor* tensor = tensor_new_shape(dtype, func->num_params, shape);
+    vec_push(vm->tensors, &tensor);
+    result[0].t = tensor;
+    return true;
+}
+
+// `matmul(a, b)`
+static bool vm_native_matmul(Vm* vm, VmValue* args, VmValue* result) {
+    Tensor* a = args[0].t;
+    Tensor* b = args[1].t;
+    if(NONE(a) || NONE(b))
+        return vm_error(vm, "`matmul()` of a tensor that was never created");
+    if(NONE(vm->pool))
+        vm->pool = threadpool_new(0);
+    Tensor* c = tensor_new(a->dtype, 0, 0);
+    vec_push(vm->tensors, &c);
+    if(!tensor_matmul(c, a, b, vm->pool))
+        return vm_error(vm, "`matmul()` of a %" PRIu64 " x %" PRIu64 " and a %" PRIu64 " x %" PRIu64 " matrix",
+                        a->shape[0], a->shape[1], b->shape[0], b->shape[1]);
+    result[0].t = c;
+    return true;
+}
+
+void vm_add_native(Vm* vm, const char* name, Type* type, VmNativeFn fn) {
+    VmNative native;
+    native.name = name;
+    native.type = type;
+    native.fn = fn;
+    vec_push(vm->natives, &native);
+}
+
+// Loading and running -----------------------------------------------------------------------------------------------
+
+static void vm_unload(Vm* vm) {
+    for(UInt64 i = 0; SOME(vm->funcs) && i < vec_size(vm->funcs); i++) {
+        VmFunc* func = *cast(VmFunc**)vec_at(vm->funcs, i);
+        free(func->code);
+        free(func->consts);
+        free(func->string_regs);
+        free(func);
+    }
+    vec_clear(vm->funcs);
+    for(UInt64 i = 0; i < vec_size(vm->diagnostics); i++)
+        free((cast(CheckerDiagnostic*)vec_at(vm->diagnostics, i))->msg);
+    vec_clear(vm->diagnostics);
+    free(vm->globals);
+    free(vm->global_offsets);
+    free(vm->string_globals);
+    vm->globals = null;
+    vm->global_offsets = null;
+    vm->string_globals = null;
+    vm->num_string_globals = 0;
+    vm_free_strings(vm->literals);
+    vm_free_strings(vm->strings);
+    for(UInt64 i = 0; i < vec_size(vm->tensors); i++)
+        tensor_free(*cast(Tensor**)vec_at(vm->tensors, i));
+    vec_clear(vm->tensors);
+    vm->literals = null;
+    vm->strings = null;
+    vm->heap_bytes = 0;
+    vm->num_frames = 0;
+}
+
+UInt64 vm_load(Vm* vm, IrModule* module) {
+    vm_unload(vm);
+    vm->module = module;
+
+    // Every global gets its registers (in declaration order)
+    UInt64 num_funcs = vec_size(module->funcs);
+    vm->global_offsets = cast(UInt32*)calloc(num_funcs + 1, sizeof(UInt32));
+    CORETEN_ENFORCE_NN(vm->global_offsets, "Could not allocate memory. Memory full.");
+    Vec* string_globals = VEC_NEW(UInt16, 8);
+    UInt32 num_globals = 0;
+    for(UInt64 i = 0; i < num_funcs; i++) {
+        Symbol* symbol = (*cast(IrFunc**)vec_at(module->funcs, i))->symbol;
+        if(symbol->kind != SymbolKindVariable)
+            continue;
+        vm->global_offsets[i] = num_globals;
+        Int32 width = vm_width(symbol->type);
+        if(symbol->type->kind == AdoradTypeString ||
+           (symbol->type->kind == AdoradTypeOptional && symbol->type->elem->kind == AdoradTypeString)) {
+            UInt16 reg = cast(UInt16)num_globals;
+            vec_push(string_globals, &reg);
+        }
+        num_globals += width > 0 ? cast(UInt32)width : 0;
+    }
+    if(num_globals > VM_MAX_REGS) {
+        Symbol* first = (*cast(IrFunc**)vec_at(module->funcs, 0))->symbol;
+        vm_diagnostic(vm, first, "The program has too many globals for the VM (more than %u registers)", VM_MAX_REGS);
+    }
+    vm->globals = cast(VmValue*)calloc(num_globals + 1, sizeof(VmValue));
+    vm->num_string_globals = cast(UInt32)vec_size(string_globals);
+    vm->string_globals = cast(UInt16*)malloc((vm->num_string_globals + 1) * sizeof(UInt16));
+    CORETEN_ENFORCE(SOME(vm->globals) && SOME(vm->string_globals), "Could not allocate memory. Memory full.");
+    if(vm->num_string_globals > 0)
+        memcpy(vm->string_globals, vec_begin(string_globals), vm->num_string_globals * sizeof(UInt16));
+    vec_free(string_globals);
+
+    for(UInt64 i = 0; i < num_funcs; i++) {
+        IrFunc* ir = *cast(IrFunc**)vec_at(module->funcs, i);
+        if(ir->symbol->kind == SymbolKindVariable && vm_width(ir->symbol->type) < 0) {
+            char buf[64];
+            type_to_str(ir->symbol->type, buf, sizeof(buf));
+            vm_diagnostic(vm, ir->symbol, "`%s` can't be loaded into the VM: values of type `%s` aren't supported yet",
+                          ir->symbol->name->data, buf);
+        }
+        VmFunc* func = vm_compile_func(vm, ir);
+        vec_push(vm->funcs, &func);
+    }
+    return vec_size(vm->diagnostics);
+}
+
+// Initialize the global of unit `index`, after the globals it depends on (through any number of functions).
+// `state` is 0 for units not visited yet, 1 for units being visited, and 2 for units done.
+static bool vm_init_in_order(Vm* vm, UInt64 index, UInt8* state) {
+    if(state[index] != 0)
+        return true;
+    state[index] = 1;
+
+    Checker* checker = vm->module->checker;
+    CheckerUnit* unit = cast(CheckerUnit*)vec_at(checker->units, index);
+    for(UInt64 i = 0; SOME(unit->deps) && i < vec_size(unit->deps); i++) {
+        Buff* name = *cast(Buff**)vec_at(unit->deps, i);
+        Symbol* dep = checker_lookup(checker, name->data, name->len);
+        if(SOME(dep) && !vm_init_in_order(vm, dep->unit, state))
+            return false;
+    }
+
+    VmFunc* func = *cast(VmFunc**)vec_at(vm->funcs, index);
+    state[index] = 2;
+    if(func->symbol->kind != SymbolKindVariable)
+        return true;
+    VmValue* global = &vm->globals[vm->global_offsets[index]];
+    if(func->code_len > 0)
+        return vm_call(vm, func, null, global);
+
+    // The zero value
+    Type* type = func->symbol->type;
+    if(type->kind == AdoradTypeString) {
+        Buff empty = {0};
+        global->s = vm_literal(vm, &empty);
+    } else if(type->kind == AdoradTypeOptional) {
+        global[1].u = 1;
+    }
+    return true;
+}
+
+bool vm_init(Vm* vm) {
+    UInt64 num_funcs = vec_size(vm->funcs);
+    UInt8* state = cast(UInt8*)calloc(num_funcs + 1, 1);
+    CORETEN_ENFORCE_NN(state, "Could not allocate memory. Memory full.");
+    bool ok = true;
+    for(UInt64 i = 0; i < num_funcs && ok; i++)
+        ok = vm_init_in_order(vm, i, state);
+    free(state);
+    return ok;
+}
+
+bool vm_run(Vm* vm, Int64* exit_code) {
+    if(SOME(exit_code))
+        *exit_code = 0;
+    if(!vm_init(vm))
+        return false;
+
+    VmFunc* main_func = vm_func(vm, "main");
+    if(NONE(main_func) || main_func->symbol->kind != SymbolKindFunc)
+        return true;
+    if(main_func->num_params > 0)
+        return vm_error(vm, "`main()` can't take any parameters");
+    VmValue result[2] = {0};
+    if(!vm_call(vm, main_func, null, result))
+        return false;
+    if(SOME(exit_code) && vm_int_bits(main_func->symbol->type->ret) > 0)
+        *exit_code = result[0].i;
+    return true;
+}
+
+VmFunc* vm_func(Vm* vm, const char* name) {
+    if(NONE(vm->module))
+        return null;
+    Symbol* symbol = checker_lookup(vm->module->checker, name, strlen(name));
+    return SOME(symbol) ? *cast(VmFunc**)vec_at(vm->funcs, symbol->unit) : null;
+}
+
+Vm* vm_new() {
+    Vm* vm = cast(Vm*)calloc(1, sizeof(Vm));
+    CORETEN_ENFORCE_NN(vm, "Could not allocate memory. Memory full.");
+    vm->natives = VEC_NEW(VmNative, 8);
+    vm->funcs = VEC_NEW(VmFunc*, 64);
+    vm->diagnostics = VEC_NEW(CheckerDiagnostic, 4);
+    vm->tensors = VEC_NEW(Tensor*, 4);
+    vm->stack_size = VM_STACK_SIZE;
+    vm->max_frames = VM_MAX_FRAMES;
+    vm->stack = cast(VmValue*)malloc(vm->stack_size * sizeof(VmValue));
+    vm->frames = cast(VmFrame*)malloc(vm->max_frames * sizeof(VmFrame));
+    CORETEN_ENFORCE(SOME(vm->stack) && SOME(vm->frames), "Could not allocate memory. Memory full.");
+    vm->gc_threshold = VM_GC_INITIAL_THRESHOLD;
+
+    Type* string = type_primitive(AdoradTypeString);
+    Type* void_type = type_primitive(AdoradTypeVoid);
+    Type* int64 = type_primitive(AdoradTypeInt64);
+    Type* float64 = type_primitive(AdoradTypeFloat64);
+    vm_add_native(vm, "print", type_func(&string, 1, false, void_type), vm_native_print);
+    vm_add_native(vm, "println", type_func(&string, 1, false, void_type), vm_native_println);
+    vm_add_native(vm, "int_to_str", type_func(&int64, 1, false, string), vm_native_int_to_str);
+    vm_add_native(vm, "float_to_str", type_func(&float64, 1, false, string), vm_native_float_to_str);
+    Type* dims[] = { int64, int64, int64, int64 };
+    AdoradTypes elems[] = { AdoradTypeInt16, AdoradTypeInt, AdoradTypeInt64, AdoradTypeFloat32, AdoradTypeFloat64 };
+    for(int i = 0; i < 5; i++) {
+        Type* elem = type_primitive(elems[i]);
+        vm_add_native(vm, "zeros", type_func(dims, 1, false, type_tensor_for(elem)), vm_native_zeros);
+        for(UInt32 rank = 2; rank <= TENSOR_MAX_RANK; rank++)
+            vm_add_native(vm, "zeros", type_func(dims, rank, false, type_tensor_of(elem, rank)), vm_native_zeros);
+        if(type_is_float(elem)) {
+            Type* matrix = type_tensor_of(elem, 2);
+            Type* params[] = { matrix, matrix };
+            vm_add_native(vm, "matmul", type_func(params, 2, false, matrix), vm_native_matmul);
+        }
+    }
+    return vm;
+}
+
+void vm_free(Vm* vm) {
+    if(NONE(vm))
+        return;
+    vm_unload(vm);
+    vec_free(vm->natives);
+    vec_free(vm->funcs);
+    vec_free(vm->diagnostics);
+    vec_free(vm->tensors);
+    threadpool_free(vm->pool);
+    free(vm->stack);
+    free(vm->frames);
+    free(vm->error);
+    free(vm);
+}
+
+void vm_print_diagnostics(Vm* vm, FILE* stream) {
+    for(UInt64 i = 0; i < vec_size(vm->diagnostics); i++) {
+        CheckerDiagnostic* diag = cast(CheckerDiagnostic*)vec_at(vm->diagnostics, i);
+        fprintf(stream, "%s:%u:%u: error: %s\n", SOME(diag->fname) ? diag->fname->data : "<unknown>", diag->line,
+                diag->col, diag->msg);
+    }
+}
+
+// Disassembly -------------------------------------------------------------------------------------------------------
+
+static const char* vm_func_name(Vm* vm, UInt32 unit) {
+    return unit < vec_size(vm->funcs) ? (*cast(VmFunc**)vec_at(vm->funcs, unit))->symbol->name->data : "?";
+}
+
+void vm_dump_func(Vm* vm, VmFunc* func, StrBuilder* out) {
+    strbuilder_appendf(out, "%s @%s: %u registers, %u constants\n",
+                       func->symbol->kind == SymbolKindFunc ? "func" : "global", func->symbol->name->data,
+                       func->num_regs, func->num_consts);
+    if(SOME(func->native)) {
+        strbuilder_append_cstr(out, "    native\n");
+        return;
+    }
+    for(UInt32 pc = 0; pc < func->code_len; pc++) {
+        VmInst in = func->code[pc];
+        VmOp op = cast(VmOp)in.op;
+        strbuilder_appendf(out, "%5u  %-8s", pc, vm_op_name(op));
+        switch(op) {
+            case VmOpLoadI: strbuilder_appendf(out, " r%u, %d", in.a, in.sbx); break;
+            case VmOpLoadK: strbuilder_appendf(out, " r%u, k%u", in.a, in.bx); break;
+            case VmOpLoadF: strbuilder_appendf(out, " r%u, @%s", in.a, vm_func_name(vm, in.bx)); break;
+            case VmOpGetGlobal: case VmOpSetGlobal: case VmOpGlobalAddr:
+                strbuilder_appendf(out, " r%u, g%u", in.a, in.bx);
+                break;
+            case VmOpMov: case VmOpAddr: case VmOpLoad: case VmOpStore: case VmOpNeg: case VmOpNot: case VmOpFNeg:
+            case VmOpRound32: case VmOpIToF: case VmOpUToF: case VmOpFToI: case VmOpFToU: case VmOpIsNull:
+            case VmOpTensorLen: case VmOpTensorPush: case VmOpBoundsCheck: case VmOpTensorClone:
+                strbuilder_appendf(out, " r%u, r%u", in.a, in.b);
+                break;
+            case VmOpSext: case VmOpZext: case VmOpTensorNew: case VmOpTensorDim: strbuilder_appendf(out, " r%u, r%u, %u", in.a, in.b, in.x); break;
+            case VmOpTensorSort: strbuilder_appendf(out, " r%u, %u", in.a, in.x); break;
+            case VmOpTensorSortByKey: strbuilder_appendf(out, " r%u, r%u, %u", in.a, in.b, in.x); break;
+            case VmOpAddI: case VmOpAddI32:
+                strbuilder_appendf(out, " r%u, r%u, %d", in.a, in.b, cast(Int16)in.c);
+                break;
+            case VmOpJump: strbuilder_appendf(out, " %d", cast(Int32)pc + 1 + in.sbx); break;
+            case VmOpJumpIf: case VmOpJumpIfNot:
+                strbuilder_appendf(out, " r%u, %d", in.a, cast(Int32)pc + 1 + in.sbx);
+                break;
+            case VmOpJumpEq: case VmOpJumpNe: case VmOpJumpLt: case VmOpJumpLe: case VmOpJumpLtU: case VmOpJumpLeU:
+                strbuilder_appendf(out, " r%u, r%u, %d", in.a, in.b, cast(Int32)pc + 1 + cast(Int16)in.c);
+                break;
+            case VmOpCall:
+            case VmOpCallR: {
+                UInt32 num_args = 0;
+                if(op == VmOpCall) {
+                    VmFunc* callee = *cast(VmFunc**)vec_at(vm->funcs, in.bx);
+                    num_args = callee->num_params;
+                    strbuilder_appendf(out, " r%u, @%s(", in.a, callee->symbol->name->data);
+                } else {
+                    num_args = in.c;
+                    strbuilder_appendf(out, " r%u, r%u(", in.a, in.b);
+                }
+                UInt16* args = cast(UInt16*)&func->code[pc + 1];
+                for(UInt32 i = 0; i < num_args; i++)
+                    strbuilder_appendf(out, i > 0 ? ", r%u" : "r%u", args[i]);
+                strbuilder_append_char(out, ')');
+                pc += (num_args + 3) / 4;
+                break;
+            }
+            case VmOpFormat: {
+                UInt32 num_holes = func->consts[in.bx].fmt->num_holes;
+                strbuilder_appendf(out, " r%u, k%u(", in.a, in.bx);
+                UInt16* args = cast(UInt16*)&func->code[pc + 1];
+                for(UInt32 i = 0; i < num_holes; i++)
+                    strbuilder_appendf(out, i > 0 ? ", r%u" : "r%u", args[i]);
+                strbuilder_append_char(out, ')');
+                pc += (num_holes + 3) / 4;
+                break;
+            }
+            case VmOpTensorSlice: {
+                VmInst words = func->code[++pc];
+                strbuilder_appendf(out, " r%u, r%u[r%u..r%u:r%u]", in.a, in.b, in.c, words.args[0], words.args[1]);
+                break;
+            }
+            case VmOpReturn:
+                if(in.x > 0)
+                    strbuilder_appendf(out, " r%u", in.a);
+                break;
+            case VmOpUnreachable: break;
+            default: strbuilder_appendf(out, " r%u, r%u, r%u", in.a, in.b, in.c); break;
+        }
+        // Trailing spaces of ops without operands
+        while(out->len > 0 && out->data[out->len - 1] == ' ')
+            out->data[--out->len] = nullchar;
+        strbuilder_append_char(out, '\n');
+    }
+}
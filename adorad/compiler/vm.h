@@ -0,0 +1,288 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#ifndef ADORAD_VM_H
+#define ADORAD_VM_H
+
+#include <stdio.h>
+#include <adorad/core/types.h>
+#include <adorad/core/vector.h>
+#include <adorad/core/strbuilder.h>
+#include <adorad/compiler/ir.h>
+#include <adorad/core/thread.h>
+#include <adorad/runtime/tensor.h>
+
+/*
+    The bytecode VM: runs a program without a C compiler (scripts, tests and the REPL).
+
+    `vm_load()` compiles the (optimized) IR of every function into a compact register-based bytecode:
+        - Every instruction is 8 bytes: an opcode, an 8-bit `x`, and three 16-bit operands `a`, `b`, `c` (or `a` and a
+          32-bit `bx`/`sbx`). Operands are register numbers, indices into the function's constants, or jump offsets.
+        - Every SSA value gets its own register (a `?T` gets two: the payload, then the null flag), and phis become
+          moves on the edges into their block - unless the value is only there to become the phi's next value (a loop
+          counter, say), which then gets the phi's register. Conversions that don't change the bits (`Int` to `Int64`,
+          ...) don't need an instruction, and a comparison that only feeds a branch is fused with it.
+        - Operations are typed (`add`, `fadd`, `add32`, ...), so nothing is decided at run time: integers narrower than
+          64 bits are kept sign- or zero-extended (like `IrOpConst`), and the `Int` arithmetic that most code is made
+          of has its own instructions that do that on the fly.
+    The interpreter is a single loop with threaded dispatch (every instruction jumps straight to the next one's
+    handler through a table of label addresses) where the compiler supports it, and a `switch` otherwise. Calls don't
+    recurse in C: frames live on the VM's own stack.
+
+    Strings are garbage collected: every function knows which of its registers hold strings, so the roots are exact.
+    A collection only ever happens when a string is allocated. Tensors (see <adorad/runtime/tensor.h>) aren't
+    collected yet: the ones a program makes live until the next `vm_load()`.
+
+    Functions without a body are bound to native (C) functions of the same name and type (see `vm_add_native()`);
+    `print()`, `println()`, `int_to_str()` and `float_to_str()` always exist, as do `zeros(d0, d1, ...)` (a tensor of
+    zeroes of that shape, for every `Tensor<T, N>`) and `matmul(a, b)` (the product of two `Tensor<Float32, 2>` or
+    `Tensor<Float64, 2>` matrices; see <adorad/runtime/matmul.h>), which runs on a thread pool the VM starts the first
+    time it's called.
+*/
+
+// Default limits (in registers, and nested calls)
+#define VM_STACK_SIZE           (1 << 20)
+#define VM_MAX_FRAMES           (1 << 16)
+// Strings allocated before the first collection (in bytes)
+#define VM_GC_INITIAL_THRESHOLD (1 << 20)
+
+#define ALLVMOPS \
+    VMOP(Mov,       "mov"),         /* R[a] = R[b] */                                                   \
+    VMOP(LoadI,     "loadi"),       /* R[a] = sbx */                                                    \
+    VMOP(LoadK,     "loadk"),       /* R[a] = K[bx] */                                                  \
+    VMOP(LoadF,     "loadf"),       /* R[a] = function bx */                                            \
+    VMOP(GetGlobal, "getg"),        /* R[a..] = G[bx..] (x registers) */                                \
+    VMOP(SetGlobal, "setg"),        /* G[bx..] = R[a..] (x registers) */                                \
+    VMOP(GlobalAddr,"gaddr"),       /* R[a] = &G[bx] */                                                 \
+    VMOP(Addr,      "addr"),        /* R[a] = &R[b] */                                                  \
+    VMOP(Load,      "load"),        /* R[a..] = *R[b] (x registers) */                                  \
+    VMOP(Store,     "store"),       /* *R[a] = R[b..] (x registers) */                                  \
+    /* 64-bit integers */                                                                               \
+    VMOP(Add,       "add"),         /* R[a] = R[b] + R[c] */                                            \
+    VMOP(Sub,       "sub"),                                                                             \
+    VMOP(Mul,       "mul"),                                                                             \
+    VMOP(Div,       "div"),                                                                             \
+    VMOP(DivU,      "divu"),                                                                            \
+    VMOP(Mod,       "mod"),                                                                             \
+    VMOP(ModU,      "modu"),                                                                            \
+    VMOP(And,       "and"),                                                                             \
+    VMOP(Or,        "or"),                                                                              \
+    VMOP(Xor,       "xor"),                                                                             \
+    VMOP(Shl,       "shl"),         /* shifts by at least x (the width of the type) are an error */     \
+    VMOP(Shr,       "shr"),                                                                             \
+    VMOP(ShrU,      "shru"),                                                                            \
+    VMOP(Neg,       "neg"),         /* R[a] = -R[b] */                                                  \
+    VMOP(Not,       "not"),         /* R[a] = !R[b] */                                                  \
+    VMOP(AddI,      "addi"),        /* R[a] = R[b] + (Int16)c */                                        \
+    /* `Int`: the 64-bit operation, sign-extended from 32 bits */                                       \
+    VMOP(Add32,     "add32"),                                                                           \
+    VMOP(Sub32,     "sub32"),                                                                           \
+    VMOP(Mul32,     "mul32"),                                                                           \
+    VMOP(AddI32,    "addi32"),                                                                          \
+    VMOP(Sext,      "sext"),        /* R[a] = R[b] sign-extended from x bits */                         \
+    VMOP(Zext,      "zext"),        /* R[a] = R[b] zero-extended from x bits */                         \
+    /* Floats (held as `Float64`s: `Float32` arithmetic rounds its result) */                           \
+    VMOP(FAdd,      "fadd"),                                                                            \
+    VMOP(FSub,      "fsub"),                                                                            \
+    VMOP(FMul,      "fmul"),                                                                            \
+    VMOP(FDiv,      "fdiv"),                                                                            \
+    VMOP(FAdd32,    "fadd32"),      /* R[a] = (Float32)(R[b] + R[c]) */                                 \
+    VMOP(FSub32,    "fsub32"),                                                                          \
+    VMOP(FMul32,    "fmul32"),                                                                          \
+    VMOP(FDiv32,    "fdiv32"),                                                                          \
+    VMOP(FNeg,      "fneg"),                                                                            \
+    VMOP(Round32,   "round32"),     /* R[a] = (Float32)R[b] */                                          \
+    VMOP(IToF,      "itof"),                                                                            \
+    VMOP(UToF,      "utof"),                                                                            \
+    VMOP(FToI,      "ftoi"),        /* out of the range of 64-bit integers is an error */               \
+    VMOP(FToU,      "ftou"),                                                                            \
+    /* Comparisons (R[a] = R[b] op R[c]). `>` and `>=` swap their operands. */                          \
+    VMOP(Eq,        "eq"),                                                                              \
+    VMOP(Ne,        "ne"),                                                                              \
+    VMOP(Lt,        "lt"),                                                                              \
+    VMOP(Le,        "le"),                                                                              \
+    VMOP(LtU,       "ltu"),                                                                             \
+    VMOP(LeU,       "leu"),                                                                             \
+    VMOP(FEq,       "feq"),                                                                             \
+    VMOP(FNe,       "fne"),                                                                             \
+    VMOP(FLt,       "flt"),                                                                             \
+    VMOP(FLe,       "fle"),                                                                             \
+    VMOP(StrEq,     "streq"),                                                                           \
+    VMOP(OptEq,     "opteq"),       /* `?T == ?T`. x: 0 for integers, 1 for floats, 2 for strings */    \
+    VMOP(IsNull,    "isnull"),      /* R[a] = R[b + 1] */                                               \
+    VMOP(Concat,    "concat"),                                                                          \
+    VMOP(Format,    "fmt"),         /* R[a] = format K[bx] of the registers that follow, like a call */ \
+    /* Tensors. Elements are moved in and out bit for bit (a `TensorScalar` is a `VmValue`). */       \
+    VMOP(TensorNew, "tnew"),        /* R[a] = an empty tensor of dtype x, with room for R[b] elems */   \
+    VMOP(TensorLen, "tlen"),        /* R[a] = R[b]->len (0 for the zero value) */                       \
+    VMOP(TensorGet, "tget"),        /* R[a] = R[b][R[c]] */                                             \
+    VMOP(TensorPush,"tpush"),       /* R[a] << R[b] */                                                  \
+    VMOP(TensorDim, "tdim"),        /* R[a] = the length of dimension x of R[b] (0 for the zero value) */\
+    VMOP(TensorSet, "tset"),        /* R[a][R[b]] = R[c] */                                             \
+    VMOP(TensorSlice,"tslice"),     /* R[a] = R[b][R[c]..R[args0]:R[args1]] (the next word is `args`) */\
+    VMOP(TensorClone,"tclone"),     /* R[a] = a copy of R[b] (null for the zero value) */               \
+    VMOP(TensorSort,"tsort"),       /* sort R[a] in place (in descending order if x is 1) */            \
+    VMOP(TensorSortByKey,"tsortk"), /* sort R[a] in place by the elements of R[b], like tsort */        \
+    VMOP(BoundsCheck,"chk"),        /* fail unless 0 <= R[a] < R[b] */                                  \
+    /* Control flow. Jump offsets are relative to the next instruction. */                              \
+    VMOP(Jump,      "jmp"),         /* pc += sbx */                                                     \
+    VMOP(JumpIf,    "jt"),          /* if R[a]: pc += sbx */                                            \
+    VMOP(JumpIfNot, "jf"),          /* if !R[a]: pc += sbx */                                           \
+    VMOP(JumpEq,    "jeq"),         /* if R[a] == R[b]: pc += (Int16)c */                               \
+    VMOP(JumpNe,    "jne"),                                                                             \
+    VMOP(JumpLt,    "jlt"),                                                                             \
+    VMOP(JumpLe,    "jle"),                                                                             \
+    VMOP(JumpLtU,   "jltu"),                                                                            \
+    VMOP(JumpLeU,   "jleu"),                                                                            \
+    VMOP(Call,      "call"),        /* R[a..] = function bx(...), followed by the argument registers */ \
+    VMOP(CallR,     "callr"),       /* R[a..] = R[b](...), followed by the c argument registers */      \
+    VMOP(Return,    "ret"),         /* return R[a..] (x registers) */                                   \
+    VMOP(Unreachable, "unreachable"),                                                                   \
+    VMOP(Count,     "")
+
+typedef enum VmOp {
+    #define VMOP(op, name)  VmOp##op
+        ALLVMOPS
+    #undef VMOP
+} VmOp;
+
+// The arguments of a call follow it, 4 registers per `VmInst` (`args`)
+typedef union VmInst {
+    struct {
+        UInt8 op;           // `VmOp`
+        UInt8 x;
+        UInt16 a;
+        union {
+            struct {
+                UInt16 b;
+                UInt16 c;
+            };
+            UInt32 bx;
+            Int32 sbx;
+        };
+    };
+    UInt16 args[4];
+} VmInst;
+
+typedef struct VmString {
+    struct VmString* next;  // the next string the collector knows about
+    UInt64 len;
+    bool is_marked;
+    char data[];            // null-terminated
+} VmString;
+
+typedef struct VmFunc VmFunc;
+
+// A register (or global). `?T` takes two: the payload, then `u` = 1 if it's null.
+typedef union VmValue {
+    Int64 i;
+    UInt64 u;
+    double f;
+    VmString* s;
+    union VmValue* p;
+    VmFunc* fn;
+    Tensor* t;
+    const Format* fmt;      // a constant: the `Format` belongs to the `IrModule`
+} VmValue;
+
+typedef struct Vm Vm;
+
+// A native function gets its arguments (one value per register) and writes its result to `result`. Returning false
+// stops the program (after setting an error with `vm_error()`).
+typedef bool (*VmNativeFn)(Vm* vm, VmValue* args, VmValue* result);
+
+typedef struct VmNative {
+    const char* name;
+    Type* type;
+    VmNativeFn fn;
+} VmNative;
+
+struct VmFunc {
+    Symbol* symbol;         // the function, or the global variable this is the initializer of
+    VmInst* code;
+    UInt32 code_len;        // in `VmInst`s
+    VmValue* consts;
+    UInt32 num_consts;
+    UInt32 num_regs;        // the size of a frame
+    UInt32 num_params;      // registers taken by the parameters (the first ones)
+    UInt32 ret_width;       // registers taken by the result
+    UInt16* string_regs;    // the registers that can hold strings (the collector's roots)
+    UInt32 num_string_regs;
+    VmNativeFn native;      // for functions without a body (null if there's no native of that name)
+};
+
+typedef struct VmFrame {
+    VmFunc* func;
+    VmValue* base;
+    VmInst* pc;             // where to continue once the callee returns
+    UInt16 dst;             // the register the callee's result goes into
+} VmFrame;
+
+struct Vm {
+    IrModule* module;       // of the last `vm_load()`
+    Vec* natives;           // `VmNative`s
+    Vec* funcs;             // `VmFunc*`s, one for every `CheckerUnit`
+    VmValue* globals;
+    UInt32* global_offsets; // by unit: the first register of the global in `globals`
+    UInt16* string_globals; // not a `Vec`, so they can be scanned with the frames
+    UInt32 num_string_globals;
+    VmString* literals;     // the string constants of every function (never collected)
+    Vec* diagnostics;       // `CheckerDiagnostic`s of `vm_load()`
+    StrBuilder* output;     // where `print()` writes to. null means stdout
+    Vec* tensors;           // `Tensor*`s made by the program (freed by the next `vm_load()`)
+    ThreadPool* pool;       // for `matmul()` (null until it's first called)
+
+    VmValue* stack;
+    UInt64 stack_size;      // in registers
+    VmFrame* frames;
+    UInt32 max_frames;
+    UInt32 num_frames;
+    char* error;            // why the last `vm_run()`/`vm_call()` failed (null if it didn't)
+
+    // The collector
+    VmString* strings;
+    UInt64 heap_bytes;      // allocated since the last collection, plus what survived it
+    UInt64 gc_threshold;
+    UInt64 num_collections;
+    UInt64 strings_freed;
+};
+
+Vm* vm_new();
+void vm_free(Vm* vm);
+// Bind every function called `name` without a body whose type is `type` to `fn`. Must be called before `vm_load()`.
+void vm_add_native(Vm* vm, const char* name, Type* type, VmNativeFn fn);
+// Compile every function of `module` (which should be optimized) to bytecode. Returns the number of errors (values
+// of types the VM doesn't support yet, calls to functions without a body or a native).
+// A `Vm` can load several modules, one after the other: loading one drops the previous one.
+UInt64 vm_load(Vm* vm, IrModule* module);
+// Initialize the globals (in dependency order). Returns false if there was a run-time error.
+bool vm_init(Vm* vm);
+// `vm_init()`, then call `main()`, if there is one. `exit_code` (can be null) is the result of `main()` if it returns
+// an integer, and 0 otherwise. Returns false if there was a run-time error.
+bool vm_run(Vm* vm, Int64* exit_code);
+// Call `func` (the globals need to be initialized first). `args` and `result` have one value per register.
+// Strings in the result only live until the next call.
+bool vm_call(Vm* vm, VmFunc* func, VmValue* args, VmValue* result);
+// The function called `name`, or null
+VmFunc* vm_func(Vm* vm, const char* name);
+// Stop with a run-time error (for natives). Always returns false.
+bool vm_error(Vm* vm, const char* format, ...);
+// A new string (which the collector takes care of), for natives
+VmString* vm_new_string(Vm* vm, const char* data, UInt64 len);
+
+void vm_print_diagnostics(Vm* vm, FILE* stream);
+// Append the disassembly of `func` to `out`
+void vm_dump_func(Vm* vm, VmFunc* func, StrBuilder* out);
+const char* vm_op_name(VmOp op);
+
+#endif // ADORAD_VM_H
@@ -0,0 +1,2080 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <adorad/compiler/x64.h>
+#include <adorad/compiler/opt.h>
+
+// Registers, numbered the way they're encoded. `xmm<i>` is `X64Xmm0 + i`.
+enum {
+    X64Rax, X64Rcx, X64Rdx, X64Rbx, X64Rsp, X64Rbp, X64Rsi, X64Rdi,
+    X64R8, X64R9, X64R10, X64R11, X64R12, X64R13, X64R14, X64R15,
+    X64Xmm0,
+    X64Xmm14 = X64Xmm0 + 14,
+    X64Xmm15 = X64Xmm0 + 15,
+    X64Rip,             // not a register: a memory operand relative to the next instruction
+};
+
+// Condition codes (`jcc`/`setcc`). `cc ^ 1` is the opposite of `cc`.
+enum {
+    X64CondB = 0x2, X64CondAe = 0x3, X64CondE = 0x4, X64CondNe = 0x5, X64CondBe = 0x6, X64CondA = 0x7,
+    X64CondS = 0x8, X64CondP = 0xA, X64CondNp = 0xB, X64CondL = 0xC, X64CondGe = 0xD, X64CondLe = 0xE,
+    X64CondG = 0xF,
+};
+
+#define X64_IS_XMM(reg)     ((reg) >= X64Xmm0)
+
+// The callee-saved registers (that the allocator hands out)
+#define X64_CALLEE_SAVED    ((1u << X64Rbx) | (1u << X64R12) | (1u << X64R13) | (1u << X64R14) | (1u << X64R15))
+
+// Integer arguments, in order (System V)
+static const UInt32 x64_int_args[6] = { X64Rdi, X64Rsi, X64Rdx, X64Rcx, X64R8, X64R9 };
+// The registers values are allocated to: the caller-saved ones first, then (from `X64_POOL_CALLEE_SAVED`) the
+// callee-saved ones, which are the only ones values live across a call can have. `rax`, `rcx`, `rdx`, `r10`, `r11`,
+// `xmm14` and `xmm15` are left as scratch registers.
+static const UInt32 x64_gpr_pool[9] = { X64Rsi, X64Rdi, X64R8, X64R9, X64Rbx, X64R12, X64R13, X64R14, X64R15 };
+#define X64_POOL_CALLEE_SAVED   4
+
+// ELF
+#define X64_SHT_PROGBITS    1
+#define X64_SHT_SYMTAB      2
+#define X64_SHT_STRTAB      3
+#define X64_SHT_RELA        4
+#define X64_SHT_NOBITS      8
+#define X64_SHF_WRITE       0x1
+#define X64_SHF_ALLOC       0x2
+#define X64_SHF_EXECINSTR   0x4
+#define X64_SHF_INFO_LINK   0x40
+#define X64_STT_NOTYPE      0
+#define X64_STT_OBJECT      1
+#define X64_STT_FUNC        2
+#define X64_STT_SECTION     3
+#define X64_R_PC32          2
+#define X64_R_PLT32         4
+
+// Section indices (in the order `x64_write()` writes them)
+enum {
+    X64SectionText = 1,
+    X64SectionRelaText,
+    X64SectionRodata,
+    X64SectionBss,
+    X64SectionSymtab,
+    X64SectionStrtab,
+    X64SectionShstrtab,
+    X64SectionNoteStack,
+    X64NumSections,
+};
+
+// What a relocation of a function's code refers to
+typedef enum X64RefKind {
+    X64RefUnit,         // the function or global of unit `index`
+    X64RefInit,         // the initializer of the global of unit `index`
+    X64RefRodata,       // offset `index` in the function's `.rodata`
+    X64RefHelper,       // `X64Helper` `index`
+    X64RefSymbol,       // symbol `index`
+} X64RefKind;
+
+typedef enum X64Helper {
+    X64HelperStringEq,
+    X64HelperConcat,
+    X64HelperMalloc,
+    X64HelperMemcpy,
+    X64HelperMemcmp,
+    X64NumHelpers,
+} X64Helper;
+
+static const char* x64_helper_names[X64NumHelpers] = {
+    "adorad_string_eq", "adorad_string_concat", "malloc", "memcpy", "memcmp"
+};
+
+typedef struct X64Ref {
+    UInt64 offset;      // of the 32-bit field, in the function's code
+    UInt32 kind;        // `X64RefKind`
+    UInt32 index;
+    Int64 addend;
+    UInt32 type;        // `R_X86_64_*`
+} X64Ref;
+
+struct X64Func {
+    StrBuilder* code;
+    StrBuilder* rodata; // its string literals
+    Vec* refs;          // `X64Ref`s
+    Vec* diagnostics;   // `CheckerDiagnostic`s. null if there are none
+    UInt64 offset;      // of the code, in `.text`
+    UInt64 rodata_offset;
+    UInt32 num_intervals;
+    UInt32 num_spilled;
+    bool uses_helper[X64NumHelpers];
+};
+
+// Types --------------------------------------------------------------------------------------------------------------
+
+// Registers (8-byte words) taken by a value of `type`, or -1 if the backend can't handle one (yet)
+static Int32 x64_parts(Type* type) {
+    switch(type->kind) {
+        case AdoradTypeVoid:
+        case AdoradTypeNull:
+            return 0;
+        case AdoradTypeBool: case AdoradTypeByte: case AdoradTypeRune:
+        case AdoradTypeInt8: case AdoradTypeInt16: case AdoradTypeInt: case AdoradTypeInt64:
+        case AdoradTypeUInt16: case AdoradTypeUInt32: case AdoradTypeUInt64:
+        case AdoradTypeFloat32: case AdoradTypeFloat64:
+        case AdoradTypePointer: case AdoradTypeFunc:
+            return 1;
+        case AdoradTypeString:
+            return 2;
+        default:
+            return -1;
+    }
+}
+
+// The size of a value of `type` in memory (the same as in C)
+static UInt32 x64_size(Type* type) {
+    switch(type->kind) {
+        case AdoradTypeBool: return 1;
+        case AdoradTypeRune: return 4;
+        case AdoradTypePointer: case AdoradTypeFunc: return 8;
+        case AdoradTypeString: return 16;
+        default: return type_size(type);
+    }
+}
+
+static bool x64_is_int_like(Type* type) {
+    return opt_int_bits(type) > 0 || type->kind == AdoradTypeRune || type->kind == AdoradTypePointer ||
+           type->kind == AdoradTypeFunc;
+}
+
+static bool x64_is_signed(Type* type) {
+    return type->kind == AdoradTypeRune || type_is_signed(type);
+}
+
+// The number of bits an integer of `type` is extended from (`Bool`s are bytes, as far as C is concerned), or 0
+static UInt32 x64_int_bits(Type* type) {
+    if(type->kind == AdoradTypeBool)
+        return 8;
+    return type->kind == AdoradTypeRune ? 32 : opt_int_bits(type);
+}
+
+static inline Type* x64_type_of(IrFunc* func, IrValue value) {
+    return type_get(ir_inst(func, value)->type);
+}
+
+static UInt64 x64_float_bits(Type* type, double value) {
+    if(type->kind == AdoradTypeFloat32) {
+        float f = cast(float)value;
+        UInt32 bits;
+        memcpy(&bits, &f, sizeof(bits));
+        return bits;
+    }
+    UInt64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// Encoding -----------------------------------------------------------------------------------------------------------
+
+static inline void x64_byte(StrBuilder* out, UInt64 byte) {
+    strbuilder_append_char(out, cast(char)cast(UInt8)byte);
+}
+
+static void x64_u32(StrBuilder* out, UInt64 value) {
+    for(UInt32 i = 0; i < 4; i++)
+        x64_byte(out, value >> (8 * i));
+}
+
+static void x64_u64(StrBuilder* out, UInt64 value) {
+    for(UInt32 i = 0; i < 8; i++)
+        x64_byte(out, value >> (8 * i));
+}
+
+static void x64_patch32(StrBuilder* out, UInt64 at, UInt64 value) {
+    for(UInt32 i = 0; i < 4; i++)
+        out->data[at + i] = cast(char)cast(UInt8)(value >> (8 * i));
+}
+
+// The mandatory prefix (if any), REX (if needed) and opcode (up to 3 bytes) of an instruction whose ModRM fields are
+// `reg` and `rm`
+static void x64_head(StrBuilder* out, UInt32 prefix, bool w, UInt32 op, UInt32 reg, UInt32 rm) {
+    if(prefix != 0)
+        x64_byte(out, prefix);
+    UInt32 rex = 0x40 | (w ? 8 : 0) | ((reg & 8) >> 1) | ((rm & 8) >> 3);
+    if(rex != 0x40)
+        x64_byte(out, rex);
+    if(op > 0xFFFF)
+        x64_byte(out, op >> 16);
+    if(op > 0xFF)
+        x64_byte(out, op >> 8);
+    x64_byte(out, op);
+}
+
+// `op reg, rm` with two registers (`reg` is an opcode extension for the `/digit` forms)
+static void x64_rr(StrBuilder* out, UInt32 prefix, bool w, UInt32 op, UInt32 reg, UInt32 rm) {
+    x64_head(out, prefix, w, op, reg, rm);
+    x64_byte(out, 0xC0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+// `op reg, [base + disp]`
+static void x64_rm(StrBuilder* out, UInt32 prefix, bool w, UInt32 op, UInt32 reg, UInt32 base, Int32 disp) {
+    x64_head(out, prefix, w, op, reg, base);
+    UInt32 mod = disp == 0 && (base & 7) != X64Rbp ? 0 : disp >= -128 && disp <= 127 ? 1 : 2;
+    x64_byte(out, (mod << 6) | ((reg & 7) << 3) | (base & 7));
+    if((base & 7) == X64Rsp)
+        x64_byte(out, 0x24);
+    if(mod == 1)
+        x64_byte(out, cast(UInt32)disp);
+    else if(mod == 2)
+        x64_u32(out, cast(UInt32)disp);
+}
+
+// `op reg, [rip + disp32]`. Returns where the displacement is (for its relocation).
+static UInt64 x64_rip(StrBuilder* out, UInt32 prefix, bool w, UInt32 op, UInt32 reg) {
+    x64_head(out, prefix, w, op, reg, 0);
+    x64_byte(out, ((reg & 7) << 3) | 5);
+    UInt64 at = out->len;
+    x64_u32(out, 0);
+    return at;
+}
+
+// `reg = imm`, in as few bytes as it takes
+static void x64_mov_imm(StrBuilder* out, UInt32 reg, UInt64 imm) {
+    if(imm == 0) {
+        x64_rr(out, 0, false, 0x31, reg, reg);
+    } else if(imm <= UINT32_MAX) {
+        x64_head(out, 0, false, 0xB8 + (reg & 7), 0, reg);
+        x64_u32(out, imm);
+    } else if(cast(Int64)imm >= INT32_MIN && cast(Int64)imm < 0) {
+        x64_rr(out, 0, true, 0xC7, 0, reg);
+        x64_u32(out, imm);
+    } else {
+        x64_head(out, 0, true, 0xB8 + (reg & 7), 0, reg);
+        x64_u64(out, imm);
+    }
+}
+
+static void x64_push(StrBuilder* out, UInt32 reg) {
+    x64_head(out, 0, false, 0x50 + (reg & 7), 0, reg);
+}
+
+static void x64_pop(StrBuilder* out, UInt32 reg) {
+    x64_head(out, 0, false, 0x58 + (reg & 7), 0, reg);
+}
+
+// A short `jcc` (or `jmp`, if `cc` is negative) forward, to be patched with `x64_patch8()`
+static UInt64 x64_jump8(StrBuilder* out, Int32 cc) {
+    x64_byte(out, cc < 0 ? 0xEB : 0x70 + cast(UInt32)cc);
+    x64_byte(out, 0);
+    return out->len - 1;
+}
+
+static void x64_patch8(StrBuilder* out, UInt64 at) {
+    out->data[at] = cast(char)cast(UInt8)(out->len - (at + 1));
+}
+
+// Generating a function ----------------------------------------------------------------------------------------------
+
+// Where a (part of a) value is: a register, or `[rbp + offset]` if `reg` is negative
+typedef struct X64Loc {
+    Int32 reg;
+    Int32 offset;
+} X64Loc;
+
+typedef struct X64Move {
+    X64Loc dst;
+    X64Loc src;
+    IrValue remat;      // a value to rematerialize instead of `src` (or IR_NONE)
+    UInt32 part;
+} X64Move;
+
+typedef struct X64Interval {
+    Int32 start;
+    Int32 end;
+    UInt32 vreg;
+    bool is_float;
+    bool crosses_call;
+} X64Interval;
+
+typedef struct X64Fixup {
+    UInt64 at;          // the `rel32` of a jump
+    UInt32 target;      // a block, or `num_blocks + i` for the moves on edge `i` (in `X64Gen.edges`)
+} X64Fixup;
+
+typedef struct X64Edge {
+    UInt32 from;
+    UInt32 to;
+} X64Edge;
+
+typedef struct X64Gen {
+    IrFunc* ir;
+    X64Func* out;
+    StrBuilder* code;
+    UInt32* vregs;      // by IR value: its first virtual register (one per part), or IR_NONE
+    UInt8* flags;       // by IR value: `X64Value*` flags
+    Int32* slots;       // by IR value: the offset of the memory of a `slot`
+    Int64* strings;     // by IR value: the offset of a string literal in `out->rodata` (-1 until it's needed)
+    X64Loc* locs;       // by virtual register
+    UInt8* is_float;    // by virtual register
+    UInt32 num_vregs;
+    UInt32 frame_size;
+    UInt32 saved;       // the callee-saved registers that are used (a bit per register)
+    Int32 save_offsets[16];
+    UInt32* offsets;    // by block (then by edge): where its code starts
+    Vec* fixups;        // `X64Fixup`s
+    Vec* edges;         // `X64Edge`s: edges into blocks with phis that need code of their own
+    Vec* moves;         // `X64Move`s (scratch)
+    bool failed;
+} X64Gen;
+
+enum {
+    X64ValueRemat = 1,  // a constant or an address, materialized wherever it's used (it has no register)
+    X64ValueFused = 2,  // a comparison that's part of the branch it feeds
+};
+
+static void x64_diagnostic(X64Func* func, Symbol* symbol, const char* format, ...) {
+    char buffer[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    Loc* loc = symbol->decl->loc;
+    CheckerDiagnostic diag;
+    diag.fname = SOME(loc) ? loc->fname : null;
+    diag.line = SOME(loc) ? loc->line : 0;
+    diag.col = SOME(loc) ? loc->col : 0;
+    diag.msg = cast(char*)malloc(strlen(buffer) + 1);
+    CORETEN_ENFORCE_NN(diag.msg, "Could not allocate memory. Memory full.");
+    strcpy(diag.msg, buffer);
+    if(NONE(func->diagnostics))
+        func->diagnostics = VEC_NEW(CheckerDiagnostic, 2);
+    vec_push(func->diagnostics, &diag);
+}
+
+static void x64_unsupported(X64Gen* g, Type* type) {
+    if(g->failed)
+        return;
+    char buf[64];
+    type_to_str(type, buf, sizeof(buf));
+    x64_diagnostic(g->out, g->ir->symbol, "`%s` can't be compiled to machine code yet: values of type `%s` aren't "
+                   "supported", g->ir->symbol->name->data, buf);
+    g->failed = true;
+}
+
+static void x64_ref(X64Gen* g, UInt64 at, X64RefKind kind, UInt32 index, Int64 addend, UInt32 type) {
+    X64Ref ref;
+    ref.offset = at;
+    ref.kind = kind;
+    ref.index = index;
+    ref.addend = addend;
+    ref.type = type;
+    vec_push(g->out->refs, &ref);
+}
+
+static void x64_call(X64Gen* g, X64RefKind kind, UInt32 index) {
+    x64_byte(g->code, 0xE8);
+    x64_ref(g, g->code->len, kind, index, -4, X64_R_PLT32);
+    x64_u32(g->code, 0);
+    if(kind == X64RefHelper)
+        g->out->uses_helper[index] = true;
+}
+
+// `op reg, [base + disp]`, where `base` can be `X64Rip` (then the operand is the global of unit `unit`, plus `disp`)
+static void x64_mem(X64Gen* g, UInt32 prefix, bool w, UInt32 op, UInt32 reg, UInt32 base, Int32 disp, UInt32 unit) {
+    if(base == X64Rip) {
+        UInt64 at = x64_rip(g->code, prefix, w, op, reg);
+        x64_ref(g, at, X64RefUnit, unit, cast(Int64)disp - 4, X64_R_PC32);
+    } else {
+        x64_rm(g->code, prefix, w, op, reg, base, disp);
+    }
+}
+
+// Load (one part of) a value of `type` from memory into `reg`, sign- or zero-extending it
+static void x64_load_mem(X64Gen* g, Type* type, UInt32 reg, UInt32 base, Int32 disp, UInt32 unit) {
+    bool is_signed = x64_is_signed(type);
+    switch(type->kind == AdoradTypeFloat32 || type->kind == AdoradTypeFloat64 ? 0 : x64_size(type)) {
+        case 0:
+            x64_mem(g, type->kind == AdoradTypeFloat32 ? 0xF3 : 0xF2, false, 0x0F10, reg, base, disp, unit);
+            break;
+        case 1: x64_mem(g, 0, is_signed, is_signed ? 0x0FBE : 0x0FB6, reg, base, disp, unit); break;
+        case 2: x64_mem(g, 0, is_signed, is_signed ? 0x0FBF : 0x0FB7, reg, base, disp, unit); break;
+        case 4: x64_mem(g, 0, is_signed, is_signed ? 0x63 : 0x8B, reg, base, disp, unit); break;
+        default: x64_mem(g, 0, true, 0x8B, reg, base, disp, unit); break;
+    }
+}
+
+// Store (one part of) a value of `type` from `reg` to memory. Bytes can only be stored from `rax`..`rbx`.
+static void x64_store_mem(X64Gen* g, Type* type, UInt32 reg, UInt32 base, Int32 disp, UInt32 unit) {
+    switch(type->kind == AdoradTypeFloat32 || type->kind == AdoradTypeFloat64 ? 0 : x64_size(type)) {
+        case 0:
+            x64_mem(g, type->kind == AdoradTypeFloat32 ? 0xF3 : 0xF2, false, 0x0F11, reg, base, disp, unit);
+            break;
+        case 1: x64_mem(g, 0, false, 0x88, reg, base, disp, unit); break;
+        case 2: x64_mem(g, 0x66, false, 0x89, reg, base, disp, unit); break;
+        case 4: x64_mem(g, 0, false, 0x89, reg, base, disp, unit); break;
+        default: x64_mem(g, 0, true, 0x89, reg, base, disp, unit); break;
+    }
+}
+
+// The type of part `part` of a value of `type` (the parts of a `String` are 8-byte words)
+static Type* x64_part_type(Type* type, UInt32 part) {
+    return type->kind == AdoradTypeString ? type_primitive(part == 0 ? AdoradTypeUInt64 : AdoradTypeInt64) : type;
+}
+
+// `rax` truncated to (and sign- or zero-extended from) the width of `type`
+static void x64_normalize(X64Gen* g, Type* type) {
+    bool is_signed = x64_is_signed(type);
+    switch(x64_int_bits(type)) {
+        case 8: x64_rr(g->code, 0, is_signed, is_signed ? 0x0FBE : 0x0FB6, X64Rax, X64Rax); break;
+        case 16: x64_rr(g->code, 0, is_signed, is_signed ? 0x0FBF : 0x0FB7, X64Rax, X64Rax); break;
+        case 32: x64_rr(g->code, 0, is_signed, is_signed ? 0x63 : 0x89, X64Rax, X64Rax); break;
+        default: break;
+    }
+}
+
+// Put (part `part` of) a constant or an address in `reg`
+static void x64_materialize(X64Gen* g, UInt32 reg, IrValue value, UInt32 part) {
+    IrInst* inst = ir_inst(g->ir, value);
+    Type* type = type_get(inst->type);
+    switch(inst->op) {
+        case IrOpConst:
+            x64_mov_imm(g->code, reg, opt_normalize(type, inst->imm));
+            break;
+        case IrOpConstFloat: {
+            UInt64 bits = x64_float_bits(type, inst->fimm);
+            if(!X64_IS_XMM(reg)) {
+                x64_mov_imm(g->code, reg, bits);
+            } else if(bits == 0) {
+                x64_rr(g->code, 0x66, false, 0x0FEF, reg, reg);
+            } else {
+                x64_mov_imm(g->code, X64R11, bits);
+                x64_rr(g->code, 0x66, true, 0x0F6E, reg, X64R11);
+            }
+            break;
+        }
+        case IrOpConstString: {
+            // The literal goes into `.rodata` (once), nul-terminated like the C backend's
+            if(g->strings[value] < 0) {
+                char* data = cast(char*)malloc(inst->str->len + 1);
+                CORETEN_ENFORCE_NN(data, "Could not allocate memory. Memory full.");
+                UInt64 len = ir_unescape(inst->str, data);
+                g->strings[value] = cast(Int64)g->out->rodata->len;
+                strbuilder_append_n(g->out->rodata, data, len + 1);
+                free(data);
+            }
+            if(part == 0) {
+                UInt64 at = x64_rip(g->code, 0, true, 0x8D, reg);
+                x64_ref(g, at, X64RefRodata, cast(UInt32)g->strings[value], -4, X64_R_PC32);
+            } else {
+                // The length is up to the nul
+                x64_mov_imm(g->code, reg, strlen(g->out->rodata->data + g->strings[value]));
+            }
+            break;
+        }
+        case IrOpFunc:
+        case IrOpGlobalAddr: {
+            UInt64 at = x64_rip(g->code, 0, true, 0x8D, reg);
+            x64_ref(g, at, X64RefUnit, inst->symbol->unit, -4, X64_R_PC32);
+            break;
+        }
+        case IrOpSlot:
+            x64_rm(g->code, 0, true, 0x8D, reg, X64Rbp, g->slots[value]);
+            break;
+        case IrOpNull:
+        case IrOpZero:
+            if(X64_IS_XMM(reg))
+                x64_rr(g->code, 0x66, false, 0x0FEF, reg, reg);
+            else
+                x64_mov_imm(g->code, reg, 0);
+            break;
+        default:
+            unreachable();
+            break;
+    }
+}
+
+static inline X64Loc x64_reg_loc(UInt32 reg) {
+    X64Loc loc;
+    loc.reg = cast(Int32)reg;
+    loc.offset = 0;
+    return loc;
+}
+
+static inline bool x64_loc_eq(X64Loc a, X64Loc b) {
+    return a.reg == b.reg && (a.reg >= 0 || a.offset == b.offset);
+}
+
+// Copy 8 bytes between registers (of either class) and stack slots
+static void x64_move(X64Gen* g, X64Loc dst, X64Loc src) {
+    if(x64_loc_eq(dst, src))
+        return;
+    UInt32 d = cast(UInt32)dst.reg;
+    UInt32 s = cast(UInt32)src.reg;
+    if(dst.reg >= 0 && src.reg >= 0) {
+        if(!X64_IS_XMM(d) && !X64_IS_XMM(s))
+            x64_rr(g->code, 0, true, 0x89, s, d);
+        else if(X64_IS_XMM(d) && X64_IS_XMM(s))
+            x64_rr(g->code, 0, false, 0x0F28, d, s);        // movaps
+        else if(X64_IS_XMM(d))
+            x64_rr(g->code, 0x66, true, 0x0F6E, d, s);      // movq xmm, r64
+        else
+            x64_rr(g->code, 0x66, true, 0x0F7E, s, d);      // movq r64, xmm
+    } else if(dst.reg >= 0) {
+        if(X64_IS_XMM(d))
+            x64_rm(g->code, 0xF2, false, 0x0F10, d, X64Rbp, src.offset);
+        else
+            x64_rm(g->code, 0, true, 0x8B, d, X64Rbp, src.offset);
+    } else if(src.reg >= 0) {
+        if(X64_IS_XMM(s))
+            x64_rm(g->code, 0xF2, false, 0x0F11, s, X64Rbp, dst.offset);
+        else
+            x64_rm(g->code, 0, true, 0x89, s, X64Rbp, dst.offset);
+    } else {
+        x64_rm(g->code, 0, true, 0x8B, X64R11, X64Rbp, src.offset);
+        x64_rm(g->code, 0, true, 0x89, X64R11, X64Rbp, dst.offset);
+    }
+}
+
+// Put (part `part` of) `value` in `reg`
+static void x64_load(X64Gen* g, UInt32 reg, IrValue value, UInt32 part) {
+    UInt32 vreg = g->vregs[value];
+    if(vreg == IR_NONE)
+        x64_materialize(g, reg, value, part);
+    else
+        x64_move(g, x64_reg_loc(reg), g->locs[vreg + part]);
+}
+
+// The register (part `part` of) `value` is in: its own, or `scratch` (after loading it there)
+static UInt32 x64_get(X64Gen* g, IrValue value, UInt32 part, UInt32 scratch) {
+    UInt32 vreg = g->vregs[value];
+    if(vreg != IR_NONE && g->locs[vreg + part].reg >= 0)
+        return cast(UInt32)g->locs[vreg + part].reg;
+    x64_load(g, scratch, value, part);
+    return scratch;
+}
+
+// Set (part `part` of) `value` to `reg`
+static void x64_put(X64Gen* g, IrValue value, UInt32 part, UInt32 reg) {
+    x64_move(g, g->locs[g->vregs[value] + part], x64_reg_loc(reg));
+}
+
+static void x64_push_move(X64Gen* g, X64Loc dst, IrValue src, UInt32 part) {
+    X64Move move;
+    move.dst = dst;
+    move.part = part;
+    move.remat = g->vregs[src] == IR_NONE ? src : IR_NONE;
+    if(move.remat == IR_NONE)
+        move.src = g->locs[g->vregs[src] + part];
+    vec_push(g->moves, &move);
+}
+
+// Do all the moves in `g->moves` at once: in an order that doesn't overwrite a location before it's read, going
+// through `rax` (or `xmm15`) to break cycles
+static void x64_resolve_moves(X64Gen* g) {
+    X64Move* moves = cast(X64Move*)vec_begin(g->moves);
+    UInt64 num_moves = vec_size(g->moves);
+    for(UInt64 i = 0; i < num_moves;) {
+        if(moves[i].remat == IR_NONE && x64_loc_eq(moves[i].dst, moves[i].src))
+            moves[i] = moves[--num_moves];
+        else
+            i++;
+    }
+
+    while(num_moves > 0) {
+        bool found = false;
+        for(UInt64 i = 0; i < num_moves && !found; i++) {
+            bool is_read = false;
+            for(UInt64 k = 0; k < num_moves && !is_read; k++)
+                is_read = k != i && moves[k].remat == IR_NONE && x64_loc_eq(moves[k].src, moves[i].dst);
+            if(is_read)
+                continue;
+            if(moves[i].remat == IR_NONE) {
+                x64_move(g, moves[i].dst, moves[i].src);
+            } else if(moves[i].dst.reg >= 0) {
+                x64_materialize(g, cast(UInt32)moves[i].dst.reg, moves[i].remat, moves[i].part);
+            } else {
+                x64_materialize(g, X64R11, moves[i].remat, moves[i].part);
+                x64_move(g, moves[i].dst, x64_reg_loc(X64R11));
+            }
+            moves[i] = moves[--num_moves];
+            found = true;
+        }
+        if(!found) {
+            // A cycle: save one of the locations, and read it from the copy instead
+            X64Loc saved = moves[0].dst;
+            X64Loc stash = x64_reg_loc(saved.reg >= 0 && X64_IS_XMM(cast(UInt32)saved.reg) ? X64Xmm15 : X64Rax);
+            x64_move(g, stash, saved);
+            for(UInt64 k = 0; k < num_moves; k++)
+                if(moves[k].remat == IR_NONE && x64_loc_eq(moves[k].src, saved))
+                    moves[k].src = stash;
+        }
+    }
+    vec_clear(g->moves);
+}
+
+// The registers arguments of `types` are passed in (System V), one per part. Returns false if some of them would
+// have to go on the stack.
+static bool x64_abi_regs(Type** types, UInt32 num_types, UInt32* regs, UInt32* num_floats) {
+    UInt32 num_ints = 0;
+    UInt32 n = 0;
+    *num_floats = 0;
+    for(UInt32 i = 0; i < num_types; i++) {
+        Int32 parts = x64_parts(types[i]);
+        for(Int32 p = 0; p < parts; p++) {
+            if(type_is_float(types[i])) {
+                if(*num_floats == 8)
+                    return false;
+                regs[n++] = X64Xmm0 + (*num_floats)++;
+            } else {
+                if(num_ints == 6)
+                    return false;
+                regs[n++] = x64_int_args[num_ints++];
+            }
+        }
+    }
+    return true;
+}
+
+// Register allocation ------------------------------------------------------------------------------------------------
+
+#define X64_BIT(set, i)     (((set)[(i) >> 6] >> ((i) & 63)) & 1)
+
+static void x64_use(X64Gen* g, UInt64* set, IrValue value) {
+    UInt32 vreg = g->vregs[value];
+    if(vreg == IR_NONE)
+        return;
+    Int32 parts = x64_parts(x64_type_of(g->ir, value));
+    for(Int32 p = 0; p < parts; p++)
+        set[(vreg + cast(UInt32)p) >> 6] |= cast(UInt64)1 << ((vreg + cast(UInt32)p) & 63);
+}
+
+static void x64_def(X64Gen* g, UInt64* set, IrValue value) {
+    UInt32 vreg = g->vregs[value];
+    if(vreg == IR_NONE)
+        return;
+    Int32 parts = x64_parts(x64_type_of(g->ir, value));
+    for(Int32 p = 0; p < parts; p++)
+        set[(vreg + cast(UInt32)p) >> 6] &= ~(cast(UInt64)1 << ((vreg + cast(UInt32)p) & 63));
+}
+
+// The index of `from` in the predecessors of `to`
+static UInt32 x64_pred_index(IrFunc* ir, UInt32 from, UInt32 to) {
+    IrBlock* block = ir_block(ir, to);
+    UInt32 pred = 0;
+    while(*cast(UInt32*)vec_at(block->preds, pred) != from)
+        pred++;
+    return pred;
+}
+
+// Which values need registers, and which comparisons are fused with their branches
+static void x64_number_values(X64Gen* g) {
+    IrFunc* ir = g->ir;
+    UInt32 num_values = cast(UInt32)vec_size(ir->insts);
+    for(UInt32 i = 0; i < num_values; i++)
+        g->vregs[i] = IR_NONE;
+
+    UInt32 num_blocks = cast(UInt32)vec_size(ir->blocks);
+    for(UInt32 b = 0; b < num_blocks; b++) {
+        IrBlock* block = ir_block(ir, b);
+        UInt64 num_phis = vec_size(block->phis);
+        UInt64 num_insts = vec_size(block->insts);
+        for(UInt64 i = 0; i < num_phis + num_insts; i++) {
+            IrValue value = i < num_phis ? *cast(IrValue*)vec_at(block->phis, i)
+                                         : *cast(IrValue*)vec_at(block->insts, i - num_phis);
+            IrInst* inst = ir_inst(ir, value);
+            if(inst->type == TYPE_ID_NONE)
+                continue;
+            Type* type = type_get(inst->type);
+            Int32 parts = x64_parts(type);
+            if(parts < 0 || (inst->op == IrOpSlot && x64_parts(type->elem) < 0)) {
+                x64_unsupported(g, parts < 0 ? type : type->elem);
+                continue;
+            }
+            switch(inst->op) {
+                case IrOpConst: case IrOpConstFloat: case IrOpConstString: case IrOpNull: case IrOpZero:
+                case IrOpFunc: case IrOpGlobalAddr: case IrOpSlot:
+                    g->flags[value] |= X64ValueRemat;
+                    continue;
+                case IrOpEq: case IrOpNe: case IrOpLt: case IrOpLe: case IrOpGt: case IrOpGe: {
+                    UInt64 index = i - num_phis;
+                    if(inst->num_uses != 1 || index + 2 != num_insts)
+                        break;
+                    IrValue term = *cast(IrValue*)vec_at(block->insts, num_insts - 1);
+                    if(ir_inst(ir, term)->op == IrOpBranch && ir_operand(ir, term, 0) == value &&
+                       x64_is_int_like(x64_type_of(ir, ir_operand(ir, value, 0)))) {
+                        g->flags[value] |= X64ValueFused;
+                        continue;
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+            if(parts == 0)
+                continue;
+            g->vregs[value] = g->num_vregs;
+            for(Int32 p = 0; p < parts; p++)
+                g->is_float[g->num_vregs++] = type_is_float(type);
+        }
+    }
+}
+
+// Does `inst` clobber the caller-saved registers?
+static bool x64_is_call(IrFunc* ir, IrValue value, IrInst* inst) {
+    if(inst->op == IrOpCall || inst->op == IrOpConcat)
+        return true;
+    return (inst->op == IrOpEq || inst->op == IrOpNe) &&
+           x64_type_of(ir, ir_operand(ir, value, 0))->kind == AdoradTypeString;
+}
+
+static int x64_compare_intervals(const void* a, const void* b) {
+    const X64Interval* x = cast(const X64Interval*)a;
+    const X64Interval* y = cast(const X64Interval*)b;
+    if(x->start != y->start)
+        return x->start < y->start ? -1 : 1;
+    return x->vreg < y->vreg ? -1 : x->vreg > y->vreg ? 1 : 0;
+}
+
+static inline void x64_extend(X64Interval* intervals, UInt32 vreg, Int32 pos) {
+    if(pos < intervals[vreg].start)
+        intervals[vreg].start = pos;
+    if(pos > intervals[vreg].end)
+        intervals[vreg].end = pos;
+}
+
+// Liveness, then a live interval for every virtual register. Instructions are 2 positions apart (so the end of a
+// block, where the moves on its outgoing edges are, has a position of its own), and parameters are defined at 0.
+static X64Interval* x64_build_intervals(X64Gen* g) {
+    IrFunc* ir = g->ir;
+    UInt32 num_blocks = cast(UInt32)vec_size(ir->blocks);
+    UInt32 words = (g->num_vregs + 63) / 64;
+    UInt64* live_in = cast(UInt64*)calloc(cast(UInt64)num_blocks * words + 1, sizeof(UInt64));
+    UInt64* live_out = cast(UInt64*)calloc(cast(UInt64)num_blocks * words + 1, sizeof(UInt64));
+    UInt64* live = cast(UInt64*)calloc(words + 1, sizeof(UInt64));
+    CORETEN_ENFORCE(SOME(live_in) && SOME(live_out) && SOME(live), "Could not allocate memory. Memory full.");
+
+    bool changed = true;
+    while(changed) {
+        changed = false;
+        for(UInt32 b = num_blocks; b-- > 0;) {
+            IrBlock* block = ir_block(ir, b);
+            memset(live, 0, words * sizeof(UInt64));
+            UInt32 succs[2];
+            UInt32 num_succs = ir_successors(ir, b, succs);
+            for(UInt32 s = 0; s < num_succs; s++) {
+                for(UInt32 w = 0; w < words; w++)
+                    live[w] |= live_in[cast(UInt64)succs[s] * words + w];
+                // Phis read their operands at the end of the predecessor
+                IrBlock* succ = ir_block(ir, succs[s]);
+                if(vec_size(succ->phis) == 0)
+                    continue;
+                UInt32 pred = x64_pred_index(ir, b, succs[s]);
+                for(UInt64 i = 0; i < vec_size(succ->phis); i++)
+                    x64_use(g, live, ir_operand(ir, *cast(IrValue*)vec_at(succ->phis, i), pred));
+            }
+            memcpy(&live_out[cast(UInt64)b * words], live, words * sizeof(UInt64));
+
+            for(UInt64 i = vec_size(block->insts); i-- > 0;) {
+                IrValue value = *cast(IrValue*)vec_at(block->insts, i);
+                IrInst* inst = ir_inst(ir, value);
+                x64_def(g, live, value);
+                for(UInt32 k = 0; k < inst->num_operands; k++)
+                    x64_use(g, live, ir_operand(ir, value, k));
+            }
+            for(UInt64 i = 0; i < vec_size(block->phis); i++)
+                x64_def(g, live, *cast(IrValue*)vec_at(block->phis, i));
+            if(memcmp(&live_in[cast(UInt64)b * words], live, words * sizeof(UInt64)) != 0) {
+                memcpy(&live_in[cast(UInt64)b * words], live, words * sizeof(UInt64));
+                changed = true;
+            }
+        }
+    }
+
+    X64Interval* intervals = cast(X64Interval*)malloc((g->num_vregs + 1) * sizeof(X64Interval));
+    Vec* calls = VEC_NEW(Int32, 16);
+    CORETEN_ENFORCE_NN(intervals, "Could not allocate memory. Memory full.");
+    for(UInt32 v = 0; v < g->num_vregs; v++) {
+        intervals[v].start = INT32_MAX;
+        intervals[v].end = -1;
+        intervals[v].vreg = v;
+        intervals[v].is_float = g->is_float[v];
+        intervals[v].crosses_call = false;
+    }
+
+    Int32 pos = 2;
+    for(UInt32 b = 0; b < num_blocks; b++) {
+        IrBlock* block = ir_block(ir, b);
+        Int32 start = pos;
+        pos += 2;
+        for(UInt64 i = 0; i < vec_size(block->phis); i++) {
+            IrValue phi = *cast(IrValue*)vec_at(block->phis, i);
+            Int32 parts = x64_parts(x64_type_of(ir, phi));
+            for(Int32 p = 0; p < parts && g->vregs[phi] != IR_NONE; p++)
+                x64_extend(intervals, g->vregs[phi] + cast(UInt32)p, start);
+        }
+        UInt64 num_insts = vec_size(block->insts);
+        for(UInt64 i = 0; i < num_insts; i++, pos += 2) {
+            IrValue value = *cast(IrValue*)vec_at(block->insts, i);
+            IrInst* inst = ir_inst(ir, value);
+            Int32 parts = inst->type != TYPE_ID_NONE ? x64_parts(type_get(inst->type)) : 0;
+            for(Int32 p = 0; p < parts && g->vregs[value] != IR_NONE; p++)
+                x64_extend(intervals, g->vregs[value] + cast(UInt32)p, inst->op == IrOpParam ? 0 : pos);
+            // A fused comparison reads its operands at the branch
+            Int32 use = g->flags[value] & X64ValueFused ? pos + 2 : pos;
+            for(UInt32 k = 0; k < inst->num_operands; k++) {
+                IrValue operand = ir_operand(ir, value, k);
+                if(g->vregs[operand] == IR_NONE)
+                    continue;
+                Int32 operand_parts = x64_parts(x64_type_of(ir, operand));
+                for(Int32 p = 0; p < operand_parts; p++)
+                    x64_extend(intervals, g->vregs[operand] + cast(UInt32)p, use);
+            }
+            if(x64_is_call(ir, value, inst))
+                vec_push(calls, &pos);
+        }
+        Int32 end = pos - 2;
+        pos += 2;
+        for(UInt32 v = 0; v < g->num_vregs; v++) {
+            if(X64_BIT(&live_in[cast(UInt64)b * words], v))
+                x64_extend(intervals, v, start);
+            if(X64_BIT(&live_out[cast(UInt64)b * words], v))
+                x64_extend(intervals, v, end + 1);
+        }
+    }
+
+    // Does the interval span a call? (The arguments of a call, and its result, don't.)
+    Int32* call_pos = cast(Int32*)vec_begin(calls);
+    UInt64 num_calls = vec_size(calls);
+    for(UInt32 v = 0; v < g->num_vregs && num_calls > 0; v++) {
+        UInt64 lo = 0, hi = num_calls;
+        while(lo < hi) {
+            UInt64 mid = (lo + hi) / 2;
+            if(call_pos[mid] <= intervals[v].start)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        intervals[v].crosses_call = lo < num_calls && call_pos[lo] < intervals[v].end;
+    }
+
+    vec_free(calls);
+    free(live);
+    free(live_in);
+    free(live_out);
+    return intervals;
+}
+
+// Linear scan, over the intervals in order of their start
+static void x64_alloc_regs(X64Gen* g, X64Interval* intervals) {
+    UInt32 n = g->num_vregs;
+    qsort(intervals, n, sizeof(X64Interval), x64_compare_intervals);
+    UInt32* active = cast(UInt32*)malloc((n + 1) * sizeof(UInt32));
+    CORETEN_ENFORCE_NN(active, "Could not allocate memory. Memory full.");
+    UInt32 num_active = 0;
+    Int32 owner[32];
+    for(UInt32 r = 0; r < 32; r++)
+        owner[r] = -1;
+
+    UInt32 xmm_pool[14];
+    for(UInt32 r = 0; r < 14; r++)
+        xmm_pool[r] = X64Xmm0 + r;
+
+    for(UInt32 i = 0; i < n; i++) {
+        X64Interval* cur = &intervals[i];
+        g->locs[cur->vreg].reg = -1;
+        if(cur->end < 0)
+            continue;
+        for(UInt32 k = 0; k < num_active;) {
+            if(intervals[active[k]].end < cur->start) {
+                owner[g->locs[intervals[active[k]].vreg].reg] = -1;
+                active[k] = active[--num_active];
+            } else {
+                k++;
+            }
+        }
+
+        // Floats have no callee-saved registers, so the ones live across calls are spilled
+        const UInt32* pool = cur->is_float ? xmm_pool : x64_gpr_pool;
+        UInt32 num_pool = cur->is_float ? 14 : 9;
+        if(cur->crosses_call) {
+            pool = cur->is_float ? pool : pool + X64_POOL_CALLEE_SAVED;
+            num_pool = cur->is_float ? 0 : num_pool - X64_POOL_CALLEE_SAVED;
+        }
+        Int32 reg = -1;
+        for(UInt32 k = 0; k < num_pool && reg < 0; k++)
+            if(owner[pool[k]] < 0)
+                reg = cast(Int32)pool[k];
+        if(reg < 0) {
+            // Spill whichever ends last: this interval, or one that has a register it could have
+            Int32 victim = -1;
+            for(UInt32 k = 0; k < num_pool; k++)
+                if(victim < 0 || intervals[owner[pool[k]]].end > intervals[victim].end)
+                    victim = owner[pool[k]];
+            if(victim >= 0 && intervals[victim].end > cur->end) {
+                reg = g->locs[intervals[victim].vreg].reg;
+                g->locs[intervals[victim].vreg].reg = -1;
+                for(UInt32 k = 0; k < num_active; k++)
+                    if(active[k] == cast(UInt32)victim)
+                        active[k] = active[--num_active];
+            }
+        }
+        if(reg >= 0) {
+            g->locs[cur->vreg].reg = reg;
+            owner[reg] = cast(Int32)i;
+            active[num_active++] = i;
+            if(X64_CALLEE_SAVED & (1u << reg))
+                g->saved |= 1u << reg;
+        }
+    }
+    free(active);
+}
+
+// Stack slots for the callee-saved registers, the spilled values and the locals whose address is taken
+static void x64_layout_frame(X64Gen* g) {
+    UInt32 size = 0;
+    for(UInt32 r = 0; r < 16; r++) {
+        if(g->saved & (1u << r)) {
+            size += 8;
+            g->save_offsets[r] = -cast(Int32)size;
+        }
+    }
+    for(UInt32 v = 0; v < g->num_vregs; v++) {
+        if(g->locs[v].reg < 0) {
+            size += 8;
+            g->locs[v].offset = -cast(Int32)size;
+            g->out->num_spilled++;
+        }
+    }
+    UInt32 num_values = cast(UInt32)vec_size(g->ir->insts);
+    for(IrValue v = 0; v < num_values; v++) {
+        IrInst* inst = ir_inst(g->ir, v);
+        if(inst->op == IrOpSlot && (g->flags[v] & X64ValueRemat)) {
+            size += (x64_size(type_get(inst->type)->elem) + 7) & ~cast(UInt32)7;
+            g->slots[v] = -cast(Int32)size;
+        }
+    }
+    g->frame_size = (size + 15) & ~cast(UInt32)15;
+}
+
+// Instructions -------------------------------------------------------------------------------------------------------
+
+static void x64_gen_arith(X64Gen* g, IrValue value, IrInst* inst) {
+    IrOp op = cast(IrOp)inst->op;
+    Type* type = type_get(inst->type);
+    IrValue lhs = ir_operand(g->ir, value, 0);
+    IrValue rhs = ir_operand(g->ir, value, 1);
+
+    if(type_is_float(type)) {
+        UInt32 fop = op == IrOpAdd ? 0x0F58 : op == IrOpSub ? 0x0F5C : op == IrOpMul ? 0x0F59 : 0x0F5E;
+        x64_load(g, X64Xmm14, lhs, 0);
+        UInt32 r = x64_get(g, rhs, 0, X64Xmm15);
+        x64_rr(g->code, type->kind == AdoradTypeFloat32 ? 0xF3 : 0xF2, false, fop, X64Xmm14, r);
+        x64_put(g, value, 0, X64Xmm14);
+        return;
+    }
+
+    bool is_signed = x64_is_signed(type);
+    bool normalize = true;
+    UInt32 r = X64Rcx;
+    if(op == IrOpShl || op == IrOpShr)
+        x64_load(g, X64Rcx, rhs, 0);
+    else
+        r = x64_get(g, rhs, 0, X64Rcx);
+    x64_load(g, X64Rax, lhs, 0);
+    switch(op) {
+        case IrOpAdd: x64_rr(g->code, 0, true, 0x01, r, X64Rax); break;
+        case IrOpSub: x64_rr(g->code, 0, true, 0x29, r, X64Rax); break;
+        case IrOpMul: x64_rr(g->code, 0, true, 0x0FAF, X64Rax, r); break;
+        case IrOpDiv:
+        case IrOpMod:
+            if(is_signed) {
+                x64_byte(g->code, 0x48);                            // cqo
+                x64_byte(g->code, 0x99);
+                x64_rr(g->code, 0, true, 0xF7, 7, r);               // idiv
+            } else {
+                x64_rr(g->code, 0, false, 0x31, X64Rdx, X64Rdx);
+                x64_rr(g->code, 0, true, 0xF7, 6, r);               // div
+            }
+            if(op == IrOpMod)
+                x64_rr(g->code, 0, true, 0x89, X64Rdx, X64Rax);
+            // The remainder is always smaller than the divisor
+            normalize = op == IrOpDiv && is_signed;
+            break;
+        case IrOpAnd: x64_rr(g->code, 0, true, 0x21, r, X64Rax); normalize = false; break;
+        case IrOpOr: x64_rr(g->code, 0, true, 0x09, r, X64Rax); normalize = false; break;
+        case IrOpXor: x64_rr(g->code, 0, true, 0x31, r, X64Rax); normalize = false; break;
+        case IrOpShl: x64_rr(g->code, 0, true, 0xD3, 4, X64Rax); break;
+        case IrOpShr: x64_rr(g->code, 0, true, 0xD3, is_signed ? 7 : 5, X64Rax); normalize = false; break;
+        default: unreachable(); break;
+    }
+    if(normalize)
+        x64_normalize(g, type);
+    x64_put(g, value, 0, X64Rax);
+}
+
+static UInt32 x64_int_cond(IrOp op, bool is_signed) {
+    switch(op) {
+        case IrOpEq: return X64CondE;
+        case IrOpNe: return X64CondNe;
+        case IrOpLt: return is_signed ? X64CondL : X64CondB;
+        case IrOpLe: return is_signed ? X64CondLe : X64CondBe;
+        case IrOpGt: return is_signed ? X64CondG : X64CondA;
+        default: return is_signed ? X64CondGe : X64CondAe;
+    }
+}
+
+// `cmp lhs, rhs` for an integer comparison. Returns the condition that holds if the comparison does.
+static UInt32 x64_gen_cmp(X64Gen* g, IrValue value, IrOp op) {
+    IrValue lhs = ir_operand(g->ir, value, 0);
+    UInt32 r = x64_get(g, ir_operand(g->ir, value, 1), 0, X64Rcx);
+    x64_load(g, X64Rax, lhs, 0);
+    x64_rr(g->code, 0, true, 0x39, r, X64Rax);
+    return x64_int_cond(op, x64_is_signed(x64_type_of(g->ir, lhs)));
+}
+
+// A call to `helper`, with the two strings `lhs` and `rhs` as arguments
+static void x64_gen_string_call(X64Gen* g, X64Helper helper, IrValue lhs, IrValue rhs) {
+    for(UInt32 p = 0; p < 2; p++) {
+        x64_push_move(g, x64_reg_loc(x64_int_args[p]), lhs, p);
+        x64_push_move(g, x64_reg_loc(x64_int_args[2 + p]), rhs, p);
+    }
+    x64_resolve_moves(g);
+    x64_call(g, X64RefHelper, helper);
+}
+
+static void x64_gen_compare(X64Gen* g, IrValue value, IrOp op) {
+    IrValue lhs = ir_operand(g->ir, value, 0);
+    IrValue rhs = ir_operand(g->ir, value, 1);
+    Type* type = x64_type_of(g->ir, lhs);
+
+    if(type->kind == AdoradTypeString) {
+        if(op != IrOpEq && op != IrOpNe) {
+            x64_unsupported(g, type);
+            return;
+        }
+        x64_gen_string_call(g, X64HelperStringEq, lhs, rhs);
+        x64_rr(g->code, 0, false, 0x0FB6, X64Rax, X64Rax);
+        if(op == IrOpNe) {
+            x64_rr(g->code, 0, false, 0x83, 6, X64Rax);             // xor eax, 1
+            x64_byte(g->code, 1);
+        }
+    } else if(type_is_float(type)) {
+        // `a < b` is `b > a`: "above" is false if either is NaN (and so is "equal", if the parity flag is checked)
+        bool swap = op == IrOpLt || op == IrOpLe;
+        x64_load(g, X64Xmm14, swap ? rhs : lhs, 0);
+        UInt32 r = x64_get(g, swap ? lhs : rhs, 0, X64Xmm15);
+        x64_rr(g->code, type->kind == AdoradTypeFloat32 ? 0 : 0x66, false, 0x0F2E, X64Xmm14, r);   // ucomis
+        switch(op) {
+            case IrOpEq:
+            case IrOpNe:
+                x64_rr(g->code, 0, false, 0x0F90 | (op == IrOpEq ? X64CondE : X64CondNe), 0, X64Rax);
+                x64_rr(g->code, 0, false, 0x0F90 | (op == IrOpEq ? X64CondNp : X64CondP), 0, X64Rcx);
+                x64_rr(g->code, 0, false, op == IrOpEq ? 0x20 : 0x08, X64Rcx, X64Rax);
+                break;
+            case IrOpLt:
+            case IrOpGt:
+                x64_rr(g->code, 0, false, 0x0F90 | X64CondA, 0, X64Rax);
+                break;
+            default:
+                x64_rr(g->code, 0, false, 0x0F90 | X64CondAe, 0, X64Rax);
+                break;
+        }
+        x64_rr(g->code, 0, false, 0x0FB6, X64Rax, X64Rax);
+    } else if(x64_is_int_like(type)) {
+        UInt32 cc = x64_gen_cmp(g, value, op);
+        x64_rr(g->code, 0, false, 0x0F90 | cc, 0, X64Rax);
+        x64_rr(g->code, 0, false, 0x0FB6, X64Rax, X64Rax);
+    } else {
+        x64_unsupported(g, type);
+        return;
+    }
+    x64_put(g, value, 0, X64Rax);
+}
+
+// Is every value of type `from` already a value of type `to`, bit for bit (in a register)?
+static bool x64_is_noop_convert(Type* from, Type* to) {
+    if(from == to)
+        return true;
+    if((from->kind == AdoradTypePointer || from->kind == AdoradTypeFunc) && from->kind == to->kind)
+        return true;
+    UInt32 from_bits = from->kind == AdoradTypeRune ? 32 : opt_int_bits(from);
+    UInt32 to_bits = to->kind == AdoradTypeRune ? 32 : opt_int_bits(to);
+    if(from_bits == 0 || to_bits == 0)
+        return false;
+    if(to_bits == 64)
+        return true;
+    if(x64_is_signed(to))
+        return x64_is_signed(from) ? from_bits <= to_bits : from_bits < to_bits;
+    return !x64_is_signed(from) && from_bits <= to_bits;
+}
+
+static void x64_gen_convert(X64Gen* g, IrValue value, IrInst* inst) {
+    IrValue operand = ir_operand(g->ir, value, 0);
+    Type* from = x64_type_of(g->ir, operand);
+    Type* to = type_get(inst->type);
+    bool is_float = type_is_float(to);
+    UInt32 prefix = to->kind == AdoradTypeFloat32 ? 0xF3 : 0xF2;
+
+    if(x64_is_noop_convert(from, to)) {
+        for(Int32 p = 0; p < x64_parts(to); p++) {
+            UInt32 r = x64_get(g, operand, cast(UInt32)p, is_float ? X64Xmm14 : X64Rax);
+            x64_put(g, value, cast(UInt32)p, r);
+        }
+        return;
+    }
+    if(is_float && type_is_float(from)) {
+        UInt32 r = x64_get(g, operand, 0, X64Xmm15);
+        x64_rr(g->code, from->kind == AdoradTypeFloat32 ? 0xF3 : 0xF2, false, 0x0F5A, X64Xmm14, r);
+        x64_put(g, value, 0, X64Xmm14);
+    } else if(is_float && x64_is_int_like(from)) {
+        x64_load(g, X64Rax, operand, 0);
+        if(from->kind == AdoradTypeUInt64) {
+            // Too big for `cvtsi2sd` if the top bit is set: halve it (keeping the low bit, for rounding), and double it
+            x64_rr(g->code, 0, true, 0x85, X64Rax, X64Rax);
+            UInt64 big = x64_jump8(g->code, X64CondS);
+            x64_rr(g->code, prefix, true, 0x0F2A, X64Xmm14, X64Rax);
+            UInt64 done = x64_jump8(g->code, -1);
+            x64_patch8(g->code, big);
+            x64_rr(g->code, 0, true, 0x89, X64Rax, X64Rcx);
+            x64_rr(g->code, 0, true, 0xD1, 5, X64Rcx);              // shr rcx, 1
+            x64_rr(g->code, 0, false, 0x83, 4, X64Rax);             // and eax, 1
+            x64_byte(g->code, 1);
+            x64_rr(g->code, 0, true, 0x09, X64Rax, X64Rcx);
+            x64_rr(g->code, prefix, true, 0x0F2A, X64Xmm14, X64Rcx);
+            x64_rr(g->code, prefix, false, 0x0F58, X64Xmm14, X64Xmm14);
+            x64_patch8(g->code, done);
+        } else {
+            x64_rr(g->code, prefix, true, 0x0F2A, X64Xmm14, X64Rax);
+        }
+        x64_put(g, value, 0, X64Xmm14);
+    } else if(x64_is_int_like(to) && type_is_float(from)) {
+        UInt32 r = x64_get(g, operand, 0, X64Xmm15);
+        x64_rr(g->code, from->kind == AdoradTypeFloat32 ? 0xF3 : 0xF2, true, 0x0F2C, X64Rax, r);     // cvtts?2si
+        x64_normalize(g, to);
+        x64_put(g, value, 0, X64Rax);
+    } else if(x64_is_int_like(to) && x64_is_int_like(from)) {
+        x64_load(g, X64Rax, operand, 0);
+        x64_normalize(g, to);
+        x64_put(g, value, 0, X64Rax);
+    } else {
+        x64_unsupported(g, to);
+    }
+}
+
+static void x64_gen_call(X64Gen* g, IrValue value, IrInst* inst) {
+    IrFunc* ir = g->ir;
+    IrValue callee = ir_operand(ir, value, 0);
+    IrInst* callee_inst = ir_inst(ir, callee);
+
+    UInt32 num_args = inst->num_operands - 1;
+    Type** types = cast(Type**)malloc((num_args + 1) * sizeof(Type*));
+    UInt32* regs = cast(UInt32*)malloc((2 * num_args + 1) * sizeof(UInt32));
+    CORETEN_ENFORCE(SOME(types) && SOME(regs), "Could not allocate memory. Memory full.");
+    for(UInt32 i = 0; i < num_args; i++)
+        types[i] = x64_type_of(ir, ir_operand(ir, value, i + 1));
+    UInt32 num_floats = 0;
+    if(!x64_abi_regs(types, num_args, regs, &num_floats)) {
+        x64_diagnostic(g->out, ir->symbol, "`%s` can't be compiled to machine code yet: calls that pass arguments "
+                       "on the stack aren't supported", ir->symbol->name->data);
+        g->failed = true;
+    } else {
+        UInt32 n = 0;
+        for(UInt32 i = 0; i < num_args; i++)
+            for(Int32 p = 0; p < x64_parts(types[i]); p++)
+                x64_push_move(g, x64_reg_loc(regs[n++]), ir_operand(ir, value, i + 1), cast(UInt32)p);
+        if(callee_inst->op != IrOpFunc)
+            x64_push_move(g, x64_reg_loc(X64R10), callee, 0);
+        x64_resolve_moves(g);
+
+        // The number of vector registers used, for variadic C functions
+        x64_mov_imm(g->code, X64Rax, num_floats);
+        if(callee_inst->op == IrOpFunc)
+            x64_call(g, X64RefUnit, callee_inst->symbol->unit);
+        else
+            x64_rr(g->code, 0, false, 0xFF, 2, X64R10);
+    }
+    free(types);
+    free(regs);
+
+    Type* ret = inst->type != TYPE_ID_NONE ? type_get(inst->type) : null;
+    if(NONE(ret) || g->vregs[value] == IR_NONE)
+        return;
+    if(type_is_float(ret)) {
+        x64_put(g, value, 0, X64Xmm0);
+    } else if(ret->kind == AdoradTypeString) {
+        x64_put(g, value, 0, X64Rax);
+        x64_put(g, value, 1, X64Rdx);
+    } else {
+        // C only sets as many bits as the type has
+        x64_normalize(g, ret);
+        x64_put(g, value, 0, X64Rax);
+    }
+}
+
+// Moves for the phis of `to`, when it's entered from `from`
+static void x64_phi_moves(X64Gen* g, UInt32 from, UInt32 to) {
+    IrBlock* block = ir_block(g->ir, to);
+    UInt64 num_phis = vec_size(block->phis);
+    if(num_phis == 0)
+        return;
+    UInt32 pred = x64_pred_index(g->ir, from, to);
+    for(UInt64 i = 0; i < num_phis; i++) {
+        IrValue phi = *cast(IrValue*)vec_at(block->phis, i);
+        if(g->vregs[phi] == IR_NONE)
+            continue;
+        Int32 parts = x64_parts(x64_type_of(g->ir, phi));
+        for(Int32 p = 0; p < parts; p++)
+            x64_push_move(g, g->locs[g->vregs[phi] + cast(UInt32)p], ir_operand(g->ir, phi, pred), cast(UInt32)p);
+    }
+    x64_resolve_moves(g);
+}
+
+// Where to jump to go from `from` to `to`: the block itself, or code that sets its phis first
+static UInt32 x64_edge_target(X64Gen* g, UInt32 from, UInt32 to) {
+    if(vec_size(ir_block(g->ir, to)->phis) == 0)
+        return to;
+    X64Edge edge;
+    edge.from = from;
+    edge.to = to;
+    vec_push(g->edges, &edge);
+    return cast(UInt32)(vec_size(g->ir->blocks) + vec_size(g->edges) - 1);
+}
+
+// `jmp` (or `jcc`, unless `cc` is negative) to `target`, patched once every block has its offset
+static void x64_jump(X64Gen* g, Int32 cc, UInt32 target) {
+    if(cc < 0) {
+        x64_byte(g->code, 0xE9);
+    } else {
+        x64_byte(g->code, 0x0F);
+        x64_byte(g->code, 0x80 + cast(UInt32)cc);
+    }
+    X64Fixup fixup;
+    fixup.at = g->code->len;
+    fixup.target = target;
+    vec_push(g->fixups, &fixup);
+    x64_u32(g->code, 0);
+}
+
+static void x64_gen_branch(X64Gen* g, UInt32 block, IrValue value, IrInst* inst) {
+    IrValue cond = ir_operand(g->ir, value, 0);
+    UInt32 next = block + 1;
+    UInt32 then_target = x64_edge_target(g, block, inst->targets[0]);
+    UInt32 else_target = x64_edge_target(g, block, inst->targets[1]);
+
+    UInt32 cc = X64CondNe;
+    if(g->flags[cond] & X64ValueFused) {
+        cc = x64_gen_cmp(g, cond, cast(IrOp)ir_inst(g->ir, cond)->op);
+    } else {
+        UInt32 r = x64_get(g, cond, 0, X64Rax);
+        x64_rr(g->code, 0, false, 0x85, r, r);
+    }
+    if(then_target == next && else_target != next) {
+        x64_jump(g, cast(Int32)(cc ^ 1), else_target);
+    } else {
+        x64_jump(g, cast(Int32)cc, then_target);
+        if(else_target != next)
+            x64_jump(g, -1, else_target);
+    }
+}
+
+static void x64_gen_epilogue(X64Gen* g) {
+    for(UInt32 r = 0; r < 16; r++)
+        if(g->saved & (1u << r))
+            x64_rm(g->code, 0, true, 0x8B, r, X64Rbp, g->save_offsets[r]);
+    x64_byte(g->code, 0xC9);    // leave
+    x64_byte(g->code, 0xC3);    // ret
+}
+
+static void x64_gen_inst(X64Gen* g, UInt32 block, IrValue value) {
+    IrFunc* ir = g->ir;
+    IrInst* inst = ir_inst(ir, value);
+    Type* type = inst->type != TYPE_ID_NONE ? type_get(inst->type) : null;
+
+    switch(inst->op) {
+        case IrOpNop: case IrOpParam: case IrOpPhi:
+        case IrOpConst: case IrOpConstFloat: case IrOpConstString: case IrOpNull: case IrOpZero:
+        case IrOpFunc: case IrOpGlobalAddr:
+            break;
+
+        case IrOpSlot: {
+            // Locals whose address is taken start out as zero, like any other
+            UInt32 size = (x64_size(type->elem) + 7) & ~cast(UInt32)7;
+            for(UInt32 i = 0; i < size; i += 8) {
+                x64_rm(g->code, 0, true, 0xC7, 0, X64Rbp, g->slots[value] + cast(Int32)i);
+                x64_u32(g->code, 0);
+            }
+            break;
+        }
+        case IrOpLoadGlobal:
+        case IrOpLoad: {
+            UInt32 base = X64Rip;
+            if(inst->op == IrOpLoad)
+                base = x64_get(g, ir_operand(ir, value, 0), 0, X64Rcx);
+            UInt32 unit = inst->op == IrOpLoadGlobal ? inst->symbol->unit : 0;
+            for(Int32 p = 0; p < x64_parts(type); p++) {
+                UInt32 reg = type_is_float(type) ? X64Xmm14 : X64Rax;
+                x64_load_mem(g, x64_part_type(type, cast(UInt32)p), reg, base, 8 * p, unit);
+                x64_put(g, value, cast(UInt32)p, reg);
+            }
+            break;
+        }
+        case IrOpStoreGlobal:
+        case IrOpStore: {
+            bool is_global = inst->op == IrOpStoreGlobal;
+            IrValue stored = ir_operand(ir, value, is_global ? 0 : 1);
+            Type* stored_type = x64_type_of(ir, stored);
+            UInt32 base = is_global ? X64Rip : x64_get(g, ir_operand(ir, value, 0), 0, X64Rcx);
+            UInt32 unit = is_global ? inst->symbol->unit : 0;
+            for(Int32 p = 0; p < x64_parts(stored_type); p++) {
+                UInt32 reg;
+                if(type_is_float(stored_type)) {
+                    reg = x64_get(g, stored, 0, X64Xmm14);
+                } else if(x64_size(stored_type) == 1) {
+                    // Only `al`..`bl` can be stored without a REX prefix
+                    x64_load(g, X64Rax, stored, 0);
+                    reg = X64Rax;
+                } else {
+                    reg = x64_get(g, stored, cast(UInt32)p, X64Rax);
+                }
+                x64_store_mem(g, x64_part_type(stored_type, cast(UInt32)p), reg, base, 8 * p, unit);
+            }
+            break;
+        }
+
+        case IrOpAdd: case IrOpSub: case IrOpMul: case IrOpDiv: case IrOpMod:
+        case IrOpAnd: case IrOpOr: case IrOpXor: case IrOpShl: case IrOpShr:
+            x64_gen_arith(g, value, inst);
+            break;
+        case IrOpNeg:
+            x64_load(g, X64Rax, ir_operand(ir, value, 0), 0);
+            if(type_is_float(type)) {
+                // Flip the sign bit
+                x64_rr(g->code, 0, true, 0x0FBA, 7, X64Rax);
+                x64_byte(g->code, type->kind == AdoradTypeFloat32 ? 31 : 63);
+            } else {
+                x64_rr(g->code, 0, true, 0xF7, 3, X64Rax);
+                x64_normalize(g, type);
+            }
+            x64_put(g, value, 0, X64Rax);
+            break;
+        case IrOpNot:
+            x64_load(g, X64Rax, ir_operand(ir, value, 0), 0);
+            x64_rr(g->code, 0, false, 0x83, 6, X64Rax);
+            x64_byte(g->code, 1);
+            x64_put(g, value, 0, X64Rax);
+            break;
+        case IrOpConcat:
+            x64_gen_string_call(g, X64HelperConcat, ir_operand(ir, value, 0), ir_operand(ir, value, 1));
+            x64_put(g, value, 0, X64Rax);
+            x64_put(g, value, 1, X64Rdx);
+            break;
+
+        case IrOpEq: case IrOpNe: case IrOpLt: case IrOpLe: case IrOpGt: case IrOpGe:
+            if(!(g->flags[value] & X64ValueFused))
+                x64_gen_compare(g, value, cast(IrOp)inst->op);
+            break;
+        case IrOpConvert: x64_gen_convert(g, value, inst); break;
+        case IrOpCall: x64_gen_call(g, value, inst); break;
+
+        case IrOpJump:
+            x64_phi_moves(g, block, inst->targets[0]);
+            if(inst->targets[0] != block + 1)
+                x64_jump(g, -1, inst->targets[0]);
+            break;
+        case IrOpBranch: x64_gen_branch(g, block, value, inst); break;
+        case IrOpReturn:
+            if(inst->num_operands > 0) {
+                IrValue result = ir_operand(ir, value, 0);
+                Type* ret = x64_type_of(ir, result);
+                if(type_is_float(ret)) {
+                    x64_load(g, X64Xmm0, result, 0);
+                } else if(x64_parts(ret) > 0) {
+                    x64_load(g, X64Rax, result, 0);
+                    if(ret->kind == AdoradTypeString)
+                        x64_load(g, X64Rdx, result, 1);
+                }
+            }
+            x64_gen_epilogue(g);
+            break;
+        case IrOpUnreachable:
+            x64_byte(g->code, 0x0F);    // ud2
+            x64_byte(g->code, 0x0B);
+            break;
+
+        default:
+            if(!g->failed)
+                x64_diagnostic(g->out, ir->symbol, "`%s` can't be compiled to machine code yet: `%s` isn't supported",
+                               ir->symbol->name->data, ir_op_name(cast(IrOp)inst->op));
+            g->failed = true;
+            break;
+    }
+}
+
+// Save the callee-saved registers that are used, and move the parameters to where they were allocated
+static void x64_gen_prologue(X64Gen* g) {
+    IrFunc* ir = g->ir;
+    x64_push(g->code, X64Rbp);
+    x64_rr(g->code, 0, true, 0x89, X64Rsp, X64Rbp);
+    if(g->frame_size > 0) {
+        x64_rr(g->code, 0, true, 0x81, 5, X64Rsp);
+        x64_u32(g->code, g->frame_size);
+    }
+    for(UInt32 r = 0; r < 16; r++)
+        if(g->saved & (1u << r))
+            x64_rm(g->code, 0, true, 0x89, r, X64Rbp, g->save_offsets[r]);
+    if(ir->symbol->kind != SymbolKindFunc)
+        return;
+
+    Type* type = ir->symbol->type;
+    UInt32* regs = cast(UInt32*)malloc((2 * type->num_params + 1) * sizeof(UInt32));
+    UInt32* firsts = cast(UInt32*)malloc((type->num_params + 1) * sizeof(UInt32));
+    CORETEN_ENFORCE(SOME(regs) && SOME(firsts), "Could not allocate memory. Memory full.");
+    UInt32 num_floats = 0;
+    if(!x64_abi_regs(type->params, type->num_params, regs, &num_floats)) {
+        x64_diagnostic(g->out, ir->symbol, "`%s` can't be compiled to machine code yet: parameters passed on the "
+                       "stack aren't supported", ir->symbol->name->data);
+        g->failed = true;
+    } else {
+        for(UInt32 i = 0, n = 0; i < type->num_params; i++) {
+            firsts[i] = n;
+            n += x64_parts(type->params[i]) > 0 ? cast(UInt32)x64_parts(type->params[i]) : 0;
+        }
+        IrBlock* entry = ir_block(ir, 0);
+        for(UInt64 i = 0; i < vec_size(entry->insts); i++) {
+            IrValue value = *cast(IrValue*)vec_at(entry->insts, i);
+            IrInst* inst = ir_inst(ir, value);
+            if(inst->op != IrOpParam || g->vregs[value] == IR_NONE)
+                continue;
+            for(Int32 p = 0; p < x64_parts(type->params[inst->imm]); p++) {
+                X64Move move;
+                move.dst = g->locs[g->vregs[value] + cast(UInt32)p];
+                move.src = x64_reg_loc(regs[firsts[inst->imm] + cast(UInt32)p]);
+                move.remat = IR_NONE;
+                move.part = 0;
+                vec_push(g->moves, &move);
+            }
+        }
+        x64_resolve_moves(g);
+
+        // C callers only set as many bits as the type has
+        for(UInt64 i = 0; i < vec_size(entry->insts); i++) {
+            IrValue value = *cast(IrValue*)vec_at(entry->insts, i);
+            IrInst* inst = ir_inst(ir, value);
+            UInt32 bits = inst->op == IrOpParam ? x64_int_bits(type->params[inst->imm]) : 0;
+            if(bits == 0 || bits == 64 || g->vregs[value] == IR_NONE)
+                continue;
+            x64_load(g, X64Rax, value, 0);
+            x64_normalize(g, type->params[inst->imm]);
+            x64_put(g, value, 0, X64Rax);
+        }
+    }
+    free(regs);
+    free(firsts);
+}
+
+static void x64_gen_func(X64Func* out, IrFunc* ir) {
+    UInt64 num_values = vec_size(ir->insts);
+    UInt32 num_blocks = cast(UInt32)vec_size(ir->blocks);
+    X64Gen g = {0};
+    g.ir = ir;
+    g.out = out;
+    g.code = out->code;
+    g.vregs = cast(UInt32*)malloc((num_values + 1) * sizeof(UInt32));
+    g.flags = cast(UInt8*)calloc(num_values + 1, 1);
+    g.slots = cast(Int32*)calloc(num_values + 1, sizeof(Int32));
+    g.strings = cast(Int64*)malloc((num_values + 1) * sizeof(Int64));
+    // Every value has at most 2 parts
+    g.locs = cast(X64Loc*)calloc(2 * num_values + 1, sizeof(X64Loc));
+    g.is_float = cast(UInt8*)calloc(2 * num_values + 1, 1);
+    // Every branch adds at most 2 edges
+    g.offsets = cast(UInt32*)malloc((3 * cast(UInt64)num_blocks + 1) * sizeof(UInt32));
+    CORETEN_ENFORCE(SOME(g.vregs) && SOME(g.flags) && SOME(g.slots) && SOME(g.strings) && SOME(g.locs) &&
+                    SOME(g.is_float) && SOME(g.offsets), "Could not allocate memory. Memory full.");
+    for(UInt64 i = 0; i < num_values; i++)
+        g.strings[i] = -1;
+    g.fixups = VEC_NEW(X64Fixup, 16);
+    g.edges = VEC_NEW(X64Edge, 8);
+    g.moves = VEC_NEW(X64Move, 8);
+
+    Type* type = ir->symbol->type;
+    Type* ret = ir->symbol->kind == SymbolKindFunc ? type->ret : type;
+    for(UInt32 i = 0; ir->symbol->kind == SymbolKindFunc && i < type->num_params; i++)
+        if(x64_parts(type->params[i]) < 0)
+            x64_unsupported(&g, type->params[i]);
+    if(x64_parts(ret) < 0)
+        x64_unsupported(&g, ret);
+    x64_number_values(&g);
+
+    if(!g.failed) {
+        X64Interval* intervals = x64_build_intervals(&g);
+        x64_alloc_regs(&g, intervals);
+        free(intervals);
+        out->num_intervals = g.num_vregs;
+        x64_layout_frame(&g);
+
+        x64_gen_prologue(&g);
+        for(UInt32 b = 0; b < num_blocks && !g.failed; b++) {
+            g.offsets[b] = cast(UInt32)g.code->len;
+            IrBlock* block = ir_block(ir, b);
+            for(UInt64 i = 0; i < vec_size(block->insts); i++)
+                x64_gen_inst(&g, b, *cast(IrValue*)vec_at(block->insts, i));
+        }
+        for(UInt64 i = 0; i < vec_size(g.edges) && !g.failed; i++) {
+            X64Edge edge = *cast(X64Edge*)vec_at(g.edges, i);
+            g.offsets[num_blocks + i] = cast(UInt32)g.code->len;
+            x64_phi_moves(&g, edge.from, edge.to);
+            x64_jump(&g, -1, edge.to);
+        }
+        for(UInt64 i = 0; i < vec_size(g.fixups) && !g.failed; i++) {
+            X64Fixup* fixup = cast(X64Fixup*)vec_at(g.fixups, i);
+            x64_patch32(g.code, fixup->at, cast(UInt64)(cast(Int64)g.offsets[fixup->target] - cast(Int64)(fixup->at + 4)));
+        }
+    }
+
+    vec_free(g.fixups);
+    vec_free(g.edges);
+    vec_free(g.moves);
+    free(g.vregs);
+    free(g.flags);
+    free(g.slots);
+    free(g.strings);
+    free(g.locs);
+    free(g.is_float);
+    free(g.offsets);
+}
+
+// The module ---------------------------------------------------------------------------------------------------------
+
+static X64Func* x64_func_new() {
+    X64Func* func = cast(X64Func*)calloc(1, sizeof(X64Func));
+    CORETEN_ENFORCE_NN(func, "Could not allocate memory. Memory full.");
+    func->code = strbuilder_new(0);
+    func->rodata = strbuilder_new(0);
+    func->refs = VEC_NEW(X64Ref, 8);
+    return func;
+}
+
+static void x64_func_free(X64Func* func) {
+    strbuilder_free(func->code);
+    strbuilder_free(func->rodata);
+    vec_free(func->refs);
+    // The messages of the diagnostics were handed to `X64.diagnostics`
+    if(SOME(func->diagnostics))
+        vec_free(func->diagnostics);
+    free(func);
+}
+
+static void x64_gen_task(void* ctx, UInt64 index, UInt32 worker) {
+    (void)worker;
+    X64* x64 = cast(X64*)ctx;
+    IrFunc* ir = *cast(IrFunc**)vec_at(x64->module->funcs, index);
+    X64Func* func = *cast(X64Func**)vec_at(x64->funcs, index);
+    if(vec_size(ir->blocks) > 0) {
+        x64_gen_func(func, ir);
+    } else if(ir->symbol->kind == SymbolKindVariable && x64_parts(ir->symbol->type) < 0) {
+        char buf[64];
+        type_to_str(ir->symbol->type, buf, sizeof(buf));
+        x64_diagnostic(func, ir->symbol, "`%s` can't be compiled to machine code yet: values of type `%s` aren't "
+                       "supported", ir->symbol->name->data, buf);
+    }
+}
+
+static UInt32 x64_add_symbol(X64* x64, const char* prefix, const char* name, const char* suffix, UInt16 section,
+                             bool is_global, bool is_func) {
+    X64Symbol symbol = {0};
+    UInt64 len = strlen(prefix) + strlen(name) + strlen(suffix);
+    symbol.name = cast(char*)malloc(len + 1);
+    CORETEN_ENFORCE_NN(symbol.name, "Could not allocate memory. Memory full.");
+    strcpy(symbol.name, prefix);
+    strcat(symbol.name, name);
+    strcat(symbol.name, suffix);
+    symbol.section = section;
+    symbol.is_global = is_global;
+    symbol.is_func = is_func;
+    vec_push(x64->symbols, &symbol);
+    return cast(UInt32)vec_size(x64->symbols) - 1;
+}
+
+// Pad `.text` with `int3`s to a multiple of 16
+static void x64_align_text(X64* x64) {
+    while(x64->text->len % 16 != 0)
+        x64_byte(x64->text, 0xCC);
+}
+
+// Call the initializer of the global of unit `index` (and store what it returns), after the initializers of the
+// globals it depends on. `state` is 0 for units not visited yet, 1 for units being visited, and 2 for units done.
+static void x64_init_in_order(X64* x64, X64Gen* g, UInt64 index, UInt8* state) {
+    if(state[index] != 0)
+        return;
+    state[index] = 1;
+
+    Checker* checker = x64->module->checker;
+    CheckerUnit* unit = cast(CheckerUnit*)vec_at(checker->units, index);
+    for(UInt64 i = 0; SOME(unit->deps) && i < vec_size(unit->deps); i++) {
+        Buff* name = *cast(Buff**)vec_at(unit->deps, i);
+        Symbol* dep = checker_lookup(checker, name->data, name->len);
+        if(SOME(dep))
+            x64_init_in_order(x64, g, dep->unit, state);
+    }
+
+    state[index] = 2;
+    IrFunc* ir = *cast(IrFunc**)vec_at(x64->module->funcs, index);
+    if(ir->symbol->kind != SymbolKindVariable || vec_size(ir->blocks) == 0)
+        return;
+    Type* type = ir->symbol->type;
+    x64_call(g, X64RefInit, cast(UInt32)index);
+    for(Int32 p = 0; p < x64_parts(type); p++) {
+        UInt32 reg = type_is_float(type) ? X64Xmm0 : p == 0 ? X64Rax : X64Rdx;
+        x64_store_mem(g, x64_part_type(type, cast(UInt32)p), reg, X64Rip, 8 * p, cast(UInt32)index);
+    }
+}
+
+// `adorad_string_eq(a.data, a.len, b.data, b.len)`
+static void x64_gen_string_eq(X64Gen* g) {
+    StrBuilder* code = g->code;
+    x64_rr(code, 0, true, 0x39, X64Rcx, X64Rsi);
+    UInt64 different = x64_jump8(code, X64CondNe);
+    x64_rr(code, 0, true, 0x85, X64Rsi, X64Rsi);
+    UInt64 empty = x64_jump8(code, X64CondE);
+    // memcmp(a.data, b.data, len) == 0
+    x64_push(code, X64Rbp);
+    x64_rr(code, 0, true, 0x89, X64Rsp, X64Rbp);
+    x64_rr(code, 0, true, 0x89, X64Rsi, X64Rax);
+    x64_rr(code, 0, true, 0x89, X64Rdx, X64Rsi);
+    x64_rr(code, 0, true, 0x89, X64Rax, X64Rdx);
+    x64_call(g, X64RefHelper, X64HelperMemcmp);
+    x64_rr(code, 0, false, 0x85, X64Rax, X64Rax);
+    x64_rr(code, 0, false, 0x0F90 | X64CondE, 0, X64Rax);
+    x64_rr(code, 0, false, 0x0FB6, X64Rax, X64Rax);
+    x64_pop(code, X64Rbp);
+    x64_byte(code, 0xC3);
+    x64_patch8(code, empty);
+    x64_mov_imm(code, X64Rax, 1);
+    x64_byte(code, 0xC3);
+    x64_patch8(code, different);
+    x64_mov_imm(code, X64Rax, 0);
+    x64_byte(code, 0xC3);
+}
+
+// `adorad_string_concat(a.data, a.len, b.data, b.len)`: a new (nul-terminated) string, which is never freed - like the
+// C backend's
+static void x64_gen_concat(X64Gen* g) {
+    StrBuilder* code = g->code;
+    const UInt32 saved[5] = { X64Rbx, X64R12, X64R13, X64R14, X64R15 };
+    x64_push(code, X64Rbp);
+    x64_rr(code, 0, true, 0x89, X64Rsp, X64Rbp);
+    for(UInt32 i = 0; i < 5; i++)
+        x64_push(code, saved[i]);
+    x64_rr(code, 0, true, 0x83, 5, X64Rsp);                 // sub rsp, 8 (to keep it aligned)
+    x64_byte(code, 8);
+    x64_rr(code, 0, true, 0x89, X64Rdi, X64Rbx);
+    x64_rr(code, 0, true, 0x89, X64Rsi, X64R12);
+    x64_rr(code, 0, true, 0x89, X64Rdx, X64R13);
+    x64_rr(code, 0, true, 0x89, X64Rcx, X64R14);
+    // malloc(a.len + b.len + 1)
+    x64_rr(code, 0, true, 0x89, X64R12, X64Rdi);
+    x64_rr(code, 0, true, 0x01, X64R14, X64Rdi);
+    x64_rr(code, 0, true, 0x83, 0, X64Rdi);
+    x64_byte(code, 1);
+    x64_call(g, X64RefHelper, X64HelperMalloc);
+    x64_rr(code, 0, true, 0x89, X64Rax, X64R15);
+    // memcpy(data, a.data, a.len), then memcpy(data + a.len, b.data, b.len)
+    x64_rr(code, 0, true, 0x89, X64Rax, X64Rdi);
+    x64_rr(code, 0, true, 0x89, X64Rbx, X64Rsi);
+    x64_rr(code, 0, true, 0x89, X64R12, X64Rdx);
+    x64_call(g, X64RefHelper, X64HelperMemcpy);
+    x64_rr(code, 0, true, 0x89, X64R15, X64Rdi);
+    x64_rr(code, 0, true, 0x01, X64R12, X64Rdi);
+    x64_rr(code, 0, true, 0x89, X64R13, X64Rsi);
+    x64_rr(code, 0, true, 0x89, X64R14, X64Rdx);
+    x64_call(g, X64RefHelper, X64HelperMemcpy);
+    // data[len] = 0
+    x64_rr(code, 0, true, 0x89, X64R12, X64Rdx);
+    x64_rr(code, 0, true, 0x01, X64R14, X64Rdx);
+    x64_rr(code, 0, true, 0x89, X64R15, X64Rax);
+    x64_rr(code, 0, true, 0x01, X64Rdx, X64Rax);
+    x64_rm(code, 0, false, 0xC6, 0, X64Rax, 0);
+    x64_byte(code, 0);
+    x64_rr(code, 0, true, 0x89, X64R15, X64Rax);
+    x64_rr(code, 0, true, 0x83, 0, X64Rsp);                 // add rsp, 8
+    x64_byte(code, 8);
+    for(UInt32 i = 5; i-- > 0;)
+        x64_pop(code, saved[i]);
+    x64_pop(code, X64Rbp);
+    x64_byte(code, 0xC3);
+}
+
+// Lay out the code of every function, and turn their references into symbols and relocations
+static void x64_link(X64* x64) {
+    IrModule* module = x64->module;
+    UInt64 num_funcs = vec_size(module->funcs);
+    UInt32* unit_symbols = cast(UInt32*)calloc(num_funcs + 1, sizeof(UInt32));
+    UInt32* init_symbols = cast(UInt32*)calloc(num_funcs + 1, sizeof(UInt32));
+    UInt32 helper_symbols[X64NumHelpers] = {0};
+    CORETEN_ENFORCE(SOME(unit_symbols) && SOME(init_symbols), "Could not allocate memory. Memory full.");
+
+    bool uses_helper[X64NumHelpers] = {0};
+    for(UInt64 i = 0; i < num_funcs; i++) {
+        X64Func* func = *cast(X64Func**)vec_at(x64->funcs, i);
+        for(UInt32 h = 0; h < X64NumHelpers; h++)
+            uses_helper[h] |= func->uses_helper[h];
+        x64->num_intervals += func->num_intervals;
+        x64->num_spilled += func->num_spilled;
+    }
+    uses_helper[X64HelperMemcmp] |= uses_helper[X64HelperStringEq];
+    uses_helper[X64HelperMalloc] |= uses_helper[X64HelperConcat];
+    uses_helper[X64HelperMemcpy] |= uses_helper[X64HelperConcat];
+
+    // The local symbols come first: the sections, the initializers of the globals, and the helpers
+    x64_add_symbol(x64, "", "", "", 0, false, false);
+    x64_add_symbol(x64, "", "", "", X64SectionText, false, false);
+    x64_add_symbol(x64, "", "", "", X64SectionRodata, false, false);
+    x64_add_symbol(x64, "", "", "", X64SectionBss, false, false);
+    for(UInt64 i = 0; i < num_funcs; i++) {
+        IrFunc* ir = *cast(IrFunc**)vec_at(module->funcs, i);
+        if(ir->symbol->kind == SymbolKindVariable && vec_size(ir->blocks) > 0)
+            init_symbols[i] = x64_add_symbol(x64, "ad_", ir->symbol->name->data, ".init", X64SectionText, false, true);
+    }
+    for(UInt32 h = X64HelperStringEq; h <= X64HelperConcat; h++)
+        if(uses_helper[h])
+            helper_symbols[h] = x64_add_symbol(x64, "", x64_helper_names[h], "", X64SectionText, false, true);
+    // Then the global ones
+    for(UInt64 i = 0; i < num_funcs; i++) {
+        IrFunc* ir = *cast(IrFunc**)vec_at(module->funcs, i);
+        Symbol* symbol = ir->symbol;
+        if(symbol->kind == SymbolKindVariable)
+            unit_symbols[i] = x64_add_symbol(x64, "ad_", symbol->name->data, "", X64SectionBss, true, false);
+        else if(vec_size(ir->blocks) > 0)
+            unit_symbols[i] = x64_add_symbol(x64, "ad_", symbol->name->data, "", X64SectionText, true, true);
+        else
+            unit_symbols[i] = x64_add_symbol(x64, "", symbol->name->data, "", 0, true, false);
+    }
+    for(UInt32 h = X64HelperMalloc; h < X64NumHelpers; h++)
+        if(uses_helper[h])
+            helper_symbols[h] = x64_add_symbol(x64, "", x64_helper_names[h], "", 0, true, false);
+    UInt32 init_symbol = x64_add_symbol(x64, "", "adorad_init", "", X64SectionText, true, true);
+    Symbol* main_symbol = checker_lookup(module->checker, "main", 4);
+    IrFunc* main_ir = SOME(main_symbol) ? *cast(IrFunc**)vec_at(module->funcs, main_symbol->unit) : null;
+    bool has_main = SOME(main_ir) && main_symbol->kind == SymbolKindFunc && vec_size(main_ir->blocks) > 0 &&
+                    main_symbol->type->num_params == 0;
+    UInt32 c_main_symbol = has_main ? x64_add_symbol(x64, "", "main", "", X64SectionText, true, true) : 0;
+    X64Symbol* symbols = cast(X64Symbol*)vec_begin(x64->symbols);
+
+    // The globals, in `.bss`
+    for(UInt64 i = 0; i < num_funcs; i++) {
+        Symbol* symbol = (*cast(IrFunc**)vec_at(module->funcs, i))->symbol;
+        if(symbol->kind != SymbolKindVariable)
+            continue;
+        UInt64 size = x64_size(symbol->type);
+        UInt64 align = size >= 8 ? 8 : size > 0 ? size : 1;
+        x64->bss_size = (x64->bss_size + align - 1) / align * align;
+        symbols[unit_symbols[i]].value = x64->bss_size;
+        symbols[unit_symbols[i]].size = size;
+        x64->bss_size += size;
+    }
+
+    // The code and literals of every function, then the helpers, `adorad_init()` and `main()`
+    Vec* funcs = VEC_NEW(X64Func*, num_funcs + 1);
+    for(UInt64 i = 0; i < num_funcs; i++) {
+        X64Func* func = *cast(X64Func**)vec_at(x64->funcs, i);
+        if(func->code->len == 0)
+            continue;
+        IrFunc* ir = *cast(IrFunc**)vec_at(module->funcs, i);
+        UInt32 index = ir->symbol->kind == SymbolKindVariable ? init_symbols[i] : unit_symbols[i];
+        x64_align_text(x64);
+        func->offset = x64->text->len;
+        func->rodata_offset = x64->rodata->len;
+        strbuilder_append_n(x64->text, func->code->data, func->code->len);
+        strbuilder_append_n(x64->rodata, func->rodata->data, func->rodata->len);
+        symbols[index].value = func->offset;
+        symbols[index].size = func->code->len;
+        vec_push(funcs, &func);
+    }
+
+    X64Func* glue = x64_func_new();
+    X64Gen g = {0};
+    g.out = glue;
+    g.code = glue->code;
+    UInt64 starts[X64NumHelpers + 2] = {0};
+    for(UInt32 h = X64HelperStringEq; h <= X64HelperConcat; h++) {
+        if(!uses_helper[h])
+            continue;
+        starts[h] = g.code->len;
+        if(h == X64HelperStringEq)
+            x64_gen_string_eq(&g);
+        else
+            x64_gen_concat(&g);
+    }
+    starts[X64NumHelpers] = g.code->len;
+    x64_push(g.code, X64Rbp);
+    x64_rr(g.code, 0, true, 0x89, X64Rsp, X64Rbp);
+    UInt8* state = cast(UInt8*)calloc(num_funcs + 1, 1);
+    CORETEN_ENFORCE_NN(state, "Could not allocate memory. Memory full.");
+    for(UInt64 i = 0; i < num_funcs; i++)
+        x64_init_in_order(x64, &g, i, state);
+    free(state);
+    x64_pop(g.code, X64Rbp);
+    x64_byte(g.code, 0xC3);
+    if(has_main) {
+        // `adorad_init()`, then `main()` (whose result is the exit code, if it's an integer)
+        starts[X64NumHelpers + 1] = g.code->len;
+        x64_push(g.code, X64Rbp);
+        x64_rr(g.code, 0, true, 0x89, X64Rsp, X64Rbp);
+        x64_call(&g, X64RefSymbol, init_symbol);
+        x64_call(&g, X64RefUnit, main_symbol->unit);
+        Type* ret = main_symbol->type->ret;
+        if(!(x64_is_int_like(ret) && ret->kind != AdoradTypePointer && ret->kind != AdoradTypeFunc))
+            x64_mov_imm(g.code, X64Rax, 0);
+        x64_pop(g.code, X64Rbp);
+        x64_byte(g.code, 0xC3);
+    }
+    x64_align_text(x64);
+    glue->offset = x64->text->len;
+    strbuilder_append_n(x64->text, glue->code->data, glue->code->len);
+    vec_push(funcs, &glue);
+    for(UInt32 h = X64HelperStringEq; h <= X64HelperConcat; h++)
+        if(uses_helper[h])
+            symbols[helper_symbols[h]].value = glue->offset + starts[h];
+    symbols[init_symbol].value = glue->offset + starts[X64NumHelpers];
+    if(has_main)
+        symbols[c_main_symbol].value = glue->offset + starts[X64NumHelpers + 1];
+
+    for(UInt64 i = 0; i < vec_size(funcs); i++) {
+        X64Func* func = *cast(X64Func**)vec_at(funcs, i);
+        for(UInt64 k = 0; k < vec_size(func->refs); k++) {
+            X64Ref* ref = cast(X64Ref*)vec_at(func->refs, k);
+            X64Reloc reloc;
+            reloc.offset = func->offset + ref->offset;
+            reloc.type = ref->type;
+            reloc.addend = ref->addend;
+            switch(ref->kind) {
+                case X64RefUnit: reloc.symbol = unit_symbols[ref->index]; break;
+                case X64RefInit: reloc.symbol = init_symbols[ref->index]; break;
+                case X64RefHelper: reloc.symbol = helper_symbols[ref->index]; break;
+                case X64RefSymbol: reloc.symbol = ref->index; break;
+                default:
+                    reloc.symbol = X64SectionRodata - 1;
+                    reloc.addend += cast(Int64)(func->rodata_offset + ref->index);
+                    break;
+            }
+            vec_push(x64->relocs, &reloc);
+        }
+    }
+
+    vec_free(funcs);
+    x64_func_free(glue);
+    free(unit_symbols);
+    free(init_symbols);
+}
+
+static void x64_reset(X64* x64) {
+    for(UInt64 i = 0; i < vec_size(x64->funcs); i++)
+        x64_func_free(*cast(X64Func**)vec_at(x64->funcs, i));
+    vec_clear(x64->funcs);
+    for(UInt64 i = 0; i < vec_size(x64->symbols); i++)
+        free((cast(X64Symbol*)vec_at(x64->symbols, i))->name);
+    vec_clear(x64->symbols);
+    vec_clear(x64->relocs);
+    for(UInt64 i = 0; i < vec_size(x64->diagnostics); i++)
+        free((cast(CheckerDiagnostic*)vec_at(x64->diagnostics, i))->msg);
+    vec_clear(x64->diagnostics);
+    strbuilder_free(x64->text);
+    strbuilder_free(x64->rodata);
+    x64->text = strbuilder_new(0);
+    x64->rodata = strbuilder_new(0);
+    x64->bss_size = 0;
+    x64->num_intervals = 0;
+    x64->num_spilled = 0;
+}
+
+UInt64 x64_generate(X64* x64, IrModule* module) {
+    x64_reset(x64);
+    x64->module = module;
+    UInt64 num_funcs = vec_size(module->funcs);
+    for(UInt64 i = 0; i < num_funcs; i++) {
+        X64Func* func = x64_func_new();
+        vec_push(x64->funcs, &func);
+    }
+    threadpool_parallel_for(module->checker->pool, num_funcs, x64_gen_task, x64);
+
+    for(UInt64 i = 0; i < num_funcs; i++) {
+        X64Func* func = *cast(X64Func**)vec_at(x64->funcs, i);
+        for(UInt64 k = 0; SOME(func->diagnostics) && k < vec_size(func->diagnostics); k++)
+            vec_push(x64->diagnostics, vec_at(func->diagnostics, k));
+    }
+    if(vec_size(x64->diagnostics) == 0)
+        x64_link(x64);
+    return vec_size(x64->diagnostics);
+}
+
+// The object file ----------------------------------------------------------------------------------------------------
+
+static void x64_pad(StrBuilder* out, UInt64 align) {
+    while(out->len % align != 0)
+        x64_byte(out, 0);
+}
+
+static void x64_u16(StrBuilder* out, UInt64 value) {
+    x64_byte(out, value);
+    x64_byte(out, value >> 8);
+}
+
+static void x64_section_header(StrBuilder* out, UInt32 name, UInt32 type, UInt64 flags, UInt64 offset, UInt64 size,
+                               UInt32 link, UInt32 info, UInt64 align, UInt64 entsize) {
+    x64_u32(out, name);
+    x64_u32(out, type);
+    x64_u64(out, flags);
+    x64_u64(out, 0);
+    x64_u64(out, offset);
+    x64_u64(out, size);
+    x64_u32(out, link);
+    x64_u32(out, info);
+    x64_u64(out, align);
+    x64_u64(out, entsize);
+}
+
+bool x64_write(X64* x64, const char* path) {
+    StrBuilder* out = strbuilder_new(64 + x64->text->len + x64->rodata->len);
+    // The ELF header, with the offset of the section headers patched in at the end
+    const UInt8 ident[16] = { 0x7F, 'E', 'L', 'F', 2, 1, 1, 0 };
+    strbuilder_append_n(out, cast(const char*)ident, sizeof(ident));
+    x64_u16(out, 1);            // ET_REL
+    x64_u16(out, 62);           // EM_X86_64
+    x64_u32(out, 1);
+    x64_u64(out, 0);
+    x64_u64(out, 0);
+    x64_u64(out, 0);            // e_shoff
+    x64_u32(out, 0);
+    x64_u16(out, 64);
+    x64_u16(out, 0);
+    x64_u16(out, 0);
+    x64_u16(out, 64);
+    x64_u16(out, X64NumSections);
+    x64_u16(out, X64SectionShstrtab);
+
+    UInt64 text_offset = out->len;
+    strbuilder_append_n(out, x64->text->data, x64->text->len);
+    x64_pad(out, 16);
+    UInt64 rodata_offset = out->len;
+    strbuilder_append_n(out, x64->rodata->data, x64->rodata->len);
+    x64_pad(out, 8);
+
+    UInt64 rela_offset = out->len;
+    for(UInt64 i = 0; i < vec_size(x64->relocs); i++) {
+        X64Reloc* reloc = cast(X64Reloc*)vec_at(x64->relocs, i);
+        x64_u64(out, reloc->offset);
+        x64_u64(out, (cast(UInt64)reloc->symbol << 32) | reloc->type);
+        x64_u64(out, cast(UInt64)reloc->addend);
+    }
+
+    StrBuilder* strtab = strbuilder_new(0);
+    x64_byte(strtab, 0);
+    UInt64 symtab_offset = out->len;
+    UInt32 first_global = 0;
+    for(UInt64 i = 0; i < vec_size(x64->symbols); i++) {
+        X64Symbol* symbol = cast(X64Symbol*)vec_at(x64->symbols, i);
+        UInt32 type = i > 0 && i < 4 ? X64_STT_SECTION : symbol->is_func ? X64_STT_FUNC :
+                      symbol->section == X64SectionBss ? X64_STT_OBJECT : X64_STT_NOTYPE;
+        if(!symbol->is_global)
+            first_global = cast(UInt32)i + 1;
+        x64_u32(out, symbol->name[0] != nullchar ? strtab->len : 0);
+        if(symbol->name[0] != nullchar)
+            strbuilder_append_n(strtab, symbol->name, strlen(symbol->name) + 1);
+        x64_byte(out, ((symbol->is_global ? 1u : 0u) << 4) | type);
+        x64_byte(out, 0);
+        x64_u16(out, symbol->section);
+        x64_u64(out, symbol->value);
+        x64_u64(out, symbol->size);
+    }
+    UInt64 symtab_size = out->len - symtab_offset;
+    UInt64 strtab_offset = out->len;
+    strbuilder_append_n(out, strtab->data, strtab->len);
+
+    const char* names[X64NumSections] = {
+        "", ".text", ".rela.text", ".rodata", ".bss", ".symtab", ".strtab", ".shstrtab", ".note.GNU-stack"
+    };
+    UInt32 name_offsets[X64NumSections];
+    UInt64 shstrtab_offset = out->len;
+    for(UInt32 i = 0; i < X64NumSections; i++) {
+        name_offsets[i] = cast(UInt32)(out->len - shstrtab_offset);
+        strbuilder_append_n(out, names[i], strlen(names[i]) + 1);
+    }
+    UInt64 shstrtab_size = out->len - shstrtab_offset;
+    x64_pad(out, 8);
+
+    UInt64 shoff = out->len;
+    x64_section_header(out, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    x64_section_header(out, name_offsets[X64SectionText], X64_SHT_PROGBITS, X64_SHF_ALLOC | X64_SHF_EXECINSTR,
+                       text_offset, x64->text->len, 0, 0, 16, 0);
+    x64_section_header(out, name_offsets[X64SectionRelaText], X64_SHT_RELA, X64_SHF_INFO_LINK, rela_offset,
+                       24 * vec_size(x64->relocs), X64SectionSymtab, X64SectionText, 8, 24);
+    x64_section_header(out, name_offsets[X64SectionRodata], X64_SHT_PROGBITS, X64_SHF_ALLOC, rodata_offset,
+                       x64->rodata->len, 0, 0, 8, 0);
+    x64_section_header(out, name_offsets[X64SectionBss], X64_SHT_NOBITS, X64_SHF_ALLOC | X64_SHF_WRITE, 0,
+                       x64->bss_size, 0, 0, 8, 0);
+    x64_section_header(out, name_offsets[X64SectionSymtab], X64_SHT_SYMTAB, 0, symtab_offset, symtab_size,
+                       X64SectionStrtab, first_global, 8, 24);
+    x64_section_header(out, name_offsets[X64SectionStrtab], X64_SHT_STRTAB, 0, strtab_offset, strtab->len, 0, 0, 1, 0);
+    x64_section_header(out, name_offsets[X64SectionShstrtab], X64_SHT_STRTAB, 0, shstrtab_offset, shstrtab_size, 0,
+                       0, 1, 0);
+    // The stack doesn't need to be executable
+    x64_section_header(out, name_offsets[X64SectionNoteStack], X64_SHT_PROGBITS, 0, shoff, 0, 0, 0, 1, 0);
+    for(UInt32 i = 0; i < 8; i++)
+        out->data[40 + i] = cast(char)cast(UInt8)(shoff >> (8 * i));
+
+    FILE* file = fopen(path, "wb");
+    bool ok = SOME(file) && fwrite(out->data, 1, out->len, file) == out->len;
+    if(SOME(file))
+        ok = (fclose(file) == 0) && ok;
+    strbuilder_free(strtab);
+    strbuilder_free(out);
+    return ok;
+}
+
+X64* x64_new(OutputArch arch) {
+    if(arch == OutputArchAuto)
+        arch = output_arch_host();
+    if(arch != OutputArchAmd64)
+        return null;
+    X64* x64 = cast(X64*)calloc(1, sizeof(X64));
+    CORETEN_ENFORCE_NN(x64, "Could not allocate memory. Memory full.");
+    x64->funcs = VEC_NEW(X64Func*, 16);
+    x64->text = strbuilder_new(0);
+    x64->rodata = strbuilder_new(0);
+    x64->symbols = VEC_NEW(X64Symbol, 64);
+    x64->relocs = VEC_NEW(X64Reloc, 64);
+    x64->diagnostics = VEC_NEW(CheckerDiagnostic, 4);
+    return x64;
+}
+
+void x64_free(X64* x64) {
+    if(NONE(x64))
+        return;
+    x64_reset(x64);
+    vec_free(x64->funcs);
+    strbuilder_free(x64->text);
+    strbuilder_free(x64->rodata);
+    vec_free(x64->symbols);
+    vec_free(x64->relocs);
+    vec_free(x64->diagnostics);
+    free(x64);
+}
+
+void x64_print_diagnostics(X64* x64, FILE* stream) {
+    for(UInt64 i = 0; i < vec_size(x64->diagnostics); i++) {
+        CheckerDiagnostic* diag = cast(CheckerDiagnostic*)vec_at(x64->diagnostics, i);
+        fprintf(stream, "%s:%u:%u: error: %s\n", SOME(diag->fname) ? diag->fname->data : "<unknown>", diag->line,
+                diag->col, diag->msg);
+    }
+}
@@ -0,0 +1,93 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#ifndef ADORAD_X64_H
+#define ADORAD_X64_H
+
+#include <stdio.h>
+#include <adorad/core/types.h>
+#include <adorad/core/vector.h>
+#include <adorad/core/strbuilder.h>
+#include <adorad/compiler/compiler.h>
+#include <adorad/compiler/checker.h>
+#include <adorad/compiler/ir.h>
+
+/*
+    The x86-64 Backend.
+
+    Turns the (optimized) IR straight into machine code, in an ELF64 relocatable object (`<name>.o`) that's linked
+    with `cc` like any other. It's meant for debug builds: it's built for compile speed, not for the speed of the code
+    it generates - there's no instruction selection beyond the obvious, and no assembler or C compiler in between.
+
+    Code generation, one function at a time (in parallel on the checker's thread pool):
+        - Liveness is computed on the SSA form (a bitset per block, iterated to a fixpoint), and every value gets a
+          single live interval over the blocks in order ("Linear Scan Register Allocation", Poletto & Sarkar).
+        - Intervals are allocated in order of their start. Values live across a call only get callee-saved registers
+          (and floats, which have none, are spilled); when nothing is free, the interval that ends last is spilled.
+        - Constants, addresses and functions aren't allocated at all: they're rematerialized where they're used.
+        - Phis are resolved with parallel moves on the edges into their blocks (through code of their own when the
+          edge comes from a `branch`), and so are the arguments of calls and the parameters on entry.
+    Every integer in a register is kept sign- or zero-extended to 64 bits, like in the VM. Values are laid out in
+    memory the way the C backend lays them out (`String` is `{ data, len }`), so the object links with C code built
+    against the C backend's header.
+
+    Naming (same as the C backend): top-level functions and variables are `ad_<name>` (functions without a body keep
+    their name, and are called through the PLT), `adorad_init()` initializes the globals in dependency order, and if
+    the program has a `main()`, the object has a C `main()` that runs it.
+    Only scalars, pointers, functions and `String`s are supported so far; anything else is a diagnostic (use the C
+    backend for those).
+*/
+
+typedef struct X64Reloc {
+    UInt64 offset;      // in `.text`
+    UInt32 symbol;      // index in `X64.symbols`
+    UInt32 type;        // `R_X86_64_*`
+    Int64 addend;
+} X64Reloc;
+
+typedef struct X64Symbol {
+    char* name;
+    UInt16 section;     // index of the section it's defined in, or 0 if it's undefined
+    bool is_global;
+    bool is_func;
+    UInt64 value;       // offset in its section
+    UInt64 size;
+} X64Symbol;
+
+typedef struct X64Func X64Func;
+
+typedef struct X64 {
+    IrModule* module;   // of the last `x64_generate()`
+    Vec* funcs;         // `X64Func*`s, one for every unit
+    StrBuilder* text;
+    StrBuilder* rodata;
+    UInt64 bss_size;
+    Vec* symbols;       // `X64Symbol`s (the section symbols first)
+    Vec* relocs;        // `X64Reloc`s
+    Vec* diagnostics;   // `CheckerDiagnostic`s, in declaration order
+
+    // Statistics (of the last `x64_generate()`)
+    UInt64 num_intervals;
+    UInt64 num_spilled;
+} X64;
+
+// A backend for `arch` (`OutputArchAuto` is the host). Returns null if it isn't `OutputArchAmd64`.
+X64* x64_new(OutputArch arch);
+void x64_free(X64* x64);
+// Generate the code of everything in `module`. Returns the number of errors.
+UInt64 x64_generate(X64* x64, IrModule* module);
+// Write the object file. Returns false if it couldn't be written.
+bool x64_write(X64* x64, const char* path);
+void x64_print_diagnostics(X64* x64, FILE* stream);
+
+#endif // ADORAD_X64_H
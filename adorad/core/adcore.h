@@ -61,7 +61,10 @@ CREDITS
 #include <adorad/core/memory.h>
 #include <adorad/core/math.h>
 #include <adorad/core/os.h>
+#include <adorad/core/strops.h>
+#include <adorad/core/thread.h>
 #include <adorad/core/buffer.h>
+#include <adorad/core/strbuilder.h>
 #include <adorad/core/char.h>
 #include <adorad/core/utf8.h>
 #include <adorad/core/vector.h>
@@ -121,93 +121,9 @@ bool buffview_cmp_nocase(cstlBuffView* view1, cstlBuffView* view2);
         return buffer->len == 0;
     }
 
-    // Returns the length of the buffer
-    // Note: The implementation for this was taken from:
-    // https://github.com/lattera/glibc/blob/master/string/strlen.c
-    // All due credit for this goes to the rightful author.
-    // UInt32 __internal_strlength(const char* str, bool is_utf8) {
+    // Returns the length of a null-terminated string (see `str_len()` in strops.h)
     static UInt32 __internal_strlength(const char* str) {
-        // if(!is_utf8) {
-            const char* char_ptr;
-            const unsigned long int* longword_ptr;
-            unsigned long int longword, himagic, lomagic;
-
-            // Handle the first few characters by reading one character at a time.
-            // Do this until CHAR_PTR is aligned on a longword boundary.
-            for(char_ptr = str; (cast(unsigned long int)char_ptr & (sizeof(longword) - 1)) != 0; ++char_ptr) {
-                if(*char_ptr == nullchar)
-                    return char_ptr - str;
-            }
-
-            // All these elucidatory comments refer to 4-byte longwords, but the theory applies equally 
-            // well to 8-byte longwords
-            longword_ptr = cast(unsigned long int*)char_ptr;
-
-            // Bits 31, 24, 16, && 8 of this number are zero. Call these bits the "holes".
-            // Note that there is a hole just to the left of each byte, with an extra at the end:
-            //     bits:  01111110 11111110 11111110 11111111
-            //     bytes: AAAAAAAA BBBBBBBB CCCCCCCC DDDDDDDD
-            // The 1-bits make sure that carries propagate to the next 0-bit.
-            // The 0-bits provide holes forcarries to fall into.
-            himagic = 0x80808080L;
-            lomagic = 0x01010101L;
-
-            if(sizeof(longword) > 4) {
-                // 64-bit version of the magic.
-                // Do the shift in two steps to avoid a warning if long has 32 bits.
-                himagic = ((himagic << 16) << 16) | himagic;
-                lomagic = ((lomagic << 16) << 16) | lomagic;
-            }
-            if(sizeof(longword) > 8)
-                abort();
-
-            // Instead of the traditional loop which tests each character, we will test a longword at a time.
-            // The tricky part is testing if *any of the four* bytes in the longword in question are zero.
-            for(;;) {
-                longword = *longword_ptr++;
-
-                if(((longword - lomagic) & ~longword & himagic) != 0) {
-                    // Which of the bytes was the zero?  If none of them were, it was a misfire; continue the search.
-                    const char* cp = cast(const char*)(longword_ptr - 1);
-
-                    if(cp[0] == 0)
-                        return cp - str;
-                    if(cp[1] == 0)
-                        return cp - str + 1;
-                    if(cp[2] == 0)
-                        return cp - str + 2;
-                    if(cp[3] == 0)
-                        return cp - str + 3;
-
-                    if(sizeof(longword) > 4) {
-                        if(cp[4] == 0)
-                            return cp - str + 4;
-                        if(cp[5] == 0)
-                            return cp - str + 5;
-                        if(cp[6] == 0)
-                            return cp - str + 6;
-                        if(cp[7] == 0)
-                            return cp - str + 7;
-                    }
-                }
-            }
-        // } 
-        // // UTF-8
-        // else {
-        //     UInt32 count = 0;
-        //     for(; *str; count++) {
-        //         UInt8 c = *str;
-        //         UInt32 increment = 0;
-        //              if(c < 0x80)               increment = 1;
-        //         else if((c & 0xe0) == 0xc0)     increment = 2;
-        //         else if((c & 0xf0) == 0xe0)     increment = 3;
-        //         else if((c & 0xf8) == 0xf0)     increment = 4;
-        //         else return -1;
-                
-        //         str += increment;
-        //     }
-        //     return count;
-        // }
+        return cast(UInt32)str_len(str);
     }
 
     // Append `buff2` to the buffer data
@@ -218,11 +134,17 @@ bool buffview_cmp_nocase(cstlBuffView* view1, cstlBuffView* view2);
         CORETEN_ENFORCE_NN(buff2, "Expected not null");
         CORETEN_ENFORCE_NN(buff2->data, "Expected not null");
 
-        UInt64 new_len = buffer->len + buff2->len + 1;
-        char* newstr = cast(char*)calloc(1, new_len);
-        strcpy(newstr, buffer->data);
-        strcat(newstr, buff2->data);
-        buff_set(buffer, newstr);
+        // Both lengths are already known, so there's no need to re-scan either buffer (`strcat`/`strlen`).
+        // For repeated appends, prefer a `cstlStrBuilder` (<adorad/core/strbuilder.h>)
+        UInt64 new_len = buffer->len + buff2->len;
+        char* newstr = cast(char*)malloc(new_len + 1);
+        CORETEN_ENFORCE_NN(newstr, "Could not allocate memory. Memory full.");
+        memcpy(newstr, buffer->data, buffer->len);
+        memcpy(newstr + buffer->len, buff2->data, buff2->len);
+        newstr[new_len] = nullchar;
+
+        buffer->data = newstr;
+        buffer->len = new_len;
     }
 
     // Append a character to the buffer data
@@ -231,12 +153,14 @@ bool buffview_cmp_nocase(cstlBuffView* view1, cstlBuffView* view2);
         CORETEN_ENFORCE_NN(buffer->data, "Expected not null");
 
         UInt64 len = buffer->len;
-        char* newstr = cast(char*)calloc(1, len + 1);
-        strcpy(newstr, buffer->data);
+        char* newstr = cast(char*)malloc(len + 2);
+        CORETEN_ENFORCE_NN(newstr, "Could not allocate memory. Memory full.");
+        memcpy(newstr, buffer->data, len);
         newstr[len] = ch;
         newstr[len + 1] = nullchar;
-        buff_set(buffer, newstr);
-        buffer->len += 2;
+
+        buffer->data = newstr;
+        buffer->len = len + 1;
     }
 
     // Assign `new_buff` to the buffer data
@@ -291,19 +215,7 @@ bool buffview_cmp_nocase(cstlBuffView* view1, cstlBuffView* view2);
     bool buff_cmp(cstlBuffer* buff1, cstlBuffer* buff2) {
         if(buff1->len != buff2->len)
             return false;
-        
-        const unsigned char* s1 = cast(const unsigned char*) buff1->data;
-        const unsigned char* s2 = cast(const unsigned char*) buff2->data;
-        unsigned char ch1, ch2;
-
-        do {
-            ch1 = cast(unsigned char) *s1++;
-            ch2 = cast(unsigned char) *s2++;
-            if(ch1 == nullchar)
-                return (ch1 - ch2) == 0 ? true : false;
-        } while(ch1 == ch2);
-
-        return (ch1 - ch2) == 0 ? true : false;
+        return mem_eq(buff1->data, buff2->data, buff1->len);
     }
 
     // Compare two buffers (ignoring case)
@@ -311,19 +223,7 @@ bool buffview_cmp_nocase(cstlBuffView* view1, cstlBuffView* view2);
     bool buff_cmp_nocase(cstlBuffer* buff1, cstlBuffer* buff2) {
         if(buff1->len != buff2->len)
             return false;
-        
-        const unsigned char* s1 = cast(const unsigned char*) buff1->data;
-        const unsigned char* s2 = cast(const unsigned char*) buff2->data;
-        int result;
-
-        if(s1 == s2)
-            return true;
-        
-        while((result = char_to_lower(*s1) - char_to_lower(*s2++)) == 0) {
-            if(*s1++ == nullchar)
-                break;
-        }
-        return result == 0 ? true : false;
+        return mem_eq_nocase(buff1->data, buff2->data, buff1->len);
     }
 
     // Get a slice of a buffer
@@ -334,7 +234,7 @@ bool buffview_cmp_nocase(cstlBuffView* view1, cstlBuffView* view2);
 
         cstlBuffer* slice = buff_new(null);
         CORETEN_ENFORCE_NN(slice, "`slice` cannot be null");
-        char* temp = cast(char*)calloc(1, num_bytes);
+        char* temp = cast(char*)calloc(1, num_bytes + 1);
         strncpy(temp, &(buffer->data[begin]), num_bytes);
         buff_set(slice, temp);
         CORETEN_ENFORCE_NN(slice, "`slice source` cannot be null");
@@ -389,16 +289,10 @@ bool buffview_cmp_nocase(cstlBuffView* view1, cstlBuffView* view2);
         if(NONE(buffer->data))
             return lower;
 
-        char* temp = cast(char*)calloc(1, buffer->len);    
-        strcpy(temp, buffer->data);
-        int i = 0;
-        while(*temp) {
-            *temp = char_to_lower(*temp);
-            temp++;
-            i++;
-        }
-        // Backtrack `i` times
-        temp -= i;
+        char* temp = cast(char*)malloc(buffer->len + 1);
+        CORETEN_ENFORCE_NN(temp, "Could not allocate memory. Memory full.");
+        mem_to_lower(temp, buffer->data, buffer->len);
+        temp[buffer->len] = nullchar;
         buff_set(lower, temp);
         return lower;
     }
@@ -409,16 +303,10 @@ bool buffview_cmp_nocase(cstlBuffView* view1, cstlBuffView* view2);
         if(NONE(buffer->data))
             return upper;
 
-        char* temp = cast(char*)calloc(1, buffer->len);    
-        strcpy(temp, buffer->data);
-        int i = 0;
-        while(*temp) {
-            *temp = char_to_upper(*temp);
-            temp++;
-            i++;
-        }
-        // Backtrack `i` times
-        temp -= i;
+        char* temp = cast(char*)malloc(buffer->len + 1);
+        CORETEN_ENFORCE_NN(temp, "Could not allocate memory. Memory full.");
+        mem_to_upper(temp, buffer->data, buffer->len);
+        temp[buffer->len] = nullchar;
         buff_set(upper, temp);
         return upper;
     }
@@ -505,19 +393,7 @@ bool buffview_cmp_nocase(cstlBuffView* view1, cstlBuffView* view2);
     bool buffview_cmp(cstlBuffView* view1, cstlBuffView* view2) {
         if(view1->len != view2->len)
             return false;
-        
-        const unsigned char* s1 = cast(const unsigned char*) view1->data;
-        const unsigned char* s2 = cast(const unsigned char*) view2->data;
-        unsigned char ch1, ch2;
-
-        do {
-            ch1 = cast(unsigned char) *s1++;
-            ch2 = cast(unsigned char) *s2++;
-            if(ch1 == nullchar)
-                return (ch1 - ch2) == 0 ? true : false;
-        } while(ch1 == ch2);
-
-        return (ch1 - ch2) == 0 ? true : false;
+        return mem_eq(view1->data, view2->data, view1->len);
     }
 
     // Compare two BuffViews (ignoring case)
@@ -525,19 +401,7 @@ bool buffview_cmp_nocase(cstlBuffView* view1, cstlBuffView* view2);
     bool buffview_cmp_nocase(cstlBuffView* view1, cstlBuffView* view2) {
         if(view1->len != view2->len)
             return false;
-        
-        const unsigned char* s1 = cast(const unsigned char*) view1->data;
-        const unsigned char* s2 = cast(const unsigned char*) view2->data;
-        int result;
-
-        if(s1 == s2)
-            return true;
-        
-        while((result = char_to_lower(*s1) - char_to_lower(*s2++)) == 0) {
-            if(*s1++ == nullchar)
-                break;
-        }
-        return result == 0 ? true : false;
+        return mem_eq_nocase(view1->data, view2->data, view1->len);
     }
 
     // Append `view2` to the end of `view`.
@@ -561,12 +425,12 @@ bool buffview_cmp_nocase(cstlBuffView* view1, cstlBuffView* view2);
         CORETEN_ENFORCE_NN(view->data, "Expected not null");
 
         UInt64 len = view->len;
-        char* newstr = cast(char*)calloc(1, len + 1);
-        strcpy(newstr, view->data);
+        char* newstr = cast(char*)calloc(1, len + 2);
+        CORETEN_ENFORCE_NN(newstr, "Could not allocate memory. Memory full.");
+        memcpy(newstr, view->data, len);
         newstr[len] = ch;
         newstr[len + 1] = nullchar;
         buffview_set(view, newstr);
-        view->len += 2;
     }
 
 #endif // CORETEN_IMPL
@@ -14,6 +14,9 @@ Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
 #ifndef CORETEN_CHAR_H
 #define CORETEN_CHAR_H
 
+#include <adorad/core/types.h>
+#include <adorad/core/strops.h>
+
 bool char_is_upper(char c);
 bool char_is_lower(char c);
 bool char_is_digit(char c);
@@ -111,20 +114,11 @@ char* char_last_occurence(char* str, char ch);
     }
 
     char* char_first_occurence(char* str, char ch) {
-        for(; *str != ch; str++) {
-            if(*str == nullchar)
-                return null; // didn't find a `ch`
-        }
-        return str;
+        return str_find_char(str, ch);
     }
 
     char* char_last_occurence(char* str, char ch) {
-        char* result = null;
-        do {
-            if(*str == ch)
-                result = str;
-        } while(*str++);
-        return result;
+        return str_rfind_char(str, ch);
     }
 
 #endif // CORETEN_IMPL
@@ -18,6 +18,7 @@ Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
 
 double clock_now();
 double clock_duration(clock_t start, clock_t end);
+double clock_monotonic();
 
 #ifdef CORETEN_IMPL
     #include <adorad/core/misc.h>
@@ -31,6 +32,27 @@ double clock_duration(clock_t start, clock_t end);
     double clock_duration(clock_t start, clock_t end) {
         return cast(double)(end - start)/CLOCKS_PER_SEC;
     }
+
+    // Returns a high-resolution, monotonic wall-clock time (in seconds).
+    // Unlike `clock_now()`, this isn't CPU time, so it's suitable for timing multithreaded work and benchmarks.
+    // Only differences between two calls are meaningful.
+    double clock_monotonic() {
+    #if defined(CORETEN_OS_WINDOWS)
+        LARGE_INTEGER freq, counter;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&counter);
+        return cast(double)counter.QuadPart / cast(double)freq.QuadPart;
+    #elif defined(CLOCK_MONOTONIC)
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return cast(double)ts.tv_sec + cast(double)ts.tv_nsec * 1e-9;
+    #else
+        // Strict ISO C builds don't expose `clock_gettime()`; C11's `timespec_get()` is the next best thing
+        struct timespec ts;
+        timespec_get(&ts, TIME_UTC);
+        return cast(double)ts.tv_sec + cast(double)ts.tv_nsec * 1e-9;
+    #endif // CORETEN_OS_WINDOWS
+    }
 #endif // CORETEN_IMPL
 
 #endif // CORETEN_CLOCK_H
\ No newline at end of file
@@ -64,4 +64,105 @@ defined(__ia64__) || defined(__x86_64__)
     #define CORETEN_64BIT    0
 #endif
 
+// SIMD instruction sets available at *compile-time*.
+// SSE2 is part of the x86-64 baseline, so it never needs a runtime check there. Anything wider (AVX2, AVX-512)
+// is compiled per-function with `CORETEN_TARGET(...)` and selected at runtime using `cpu_has_feature()`.
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define CORETEN_SIMD_SSE2    1
+#endif // __SSE2__
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+    #define CORETEN_SIMD_NEON    1
+#endif // __ARM_NEON
+
+// Compile a single function for a wider instruction set than the rest of the translation unit
+// Eg: CORETEN_TARGET("avx2") static void foo() { ... }
+#if defined(CORETEN_CPU_X86) && (defined(__GNUC__) || defined(__clang__))
+    #define CORETEN_SIMD_X86_DISPATCH   1
+    #define CORETEN_TARGET(isa)         __attribute__((target(isa)))
+#elif defined(CORETEN_CPU_X86) && defined(_MSC_VER)
+    // MSVC allows AVX intrinsics in any function without extra flags
+    #define CORETEN_SIMD_X86_DISPATCH   1
+    #define CORETEN_TARGET(isa)
+#else
+    #define CORETEN_TARGET(isa)
+#endif // CORETEN_CPU_X86
+
+#include <adorad/core/compilers.h>
+#include <adorad/core/types.h>
+#include <adorad/core/misc.h>
+
+// CPU features that can be queried at runtime
+typedef enum {
+    CpuFeatureSSE2    = 1 << 0,
+    CpuFeatureSSE42   = 1 << 1,
+    CpuFeatureAVX     = 1 << 2,
+    CpuFeatureAVX2    = 1 << 3,
+    CpuFeatureFMA     = 1 << 4,
+    CpuFeatureAVX512F = 1 << 5,
+    CpuFeatureAVX512BW = 1 << 6,
+    CpuFeatureNEON    = 1 << 7,
+} CpuFeature;
+
+UInt32 cpu_features();
+bool cpu_has_feature(CpuFeature feature);
+
+#ifdef CORETEN_IMPL
+    #if defined(CORETEN_CPU_X86) && defined(_MSC_VER)
+        #include <intrin.h>
+    #endif // _MSC_VER
+
+    // Detect the features supported by the CPU we're running on.
+    // The result is computed once and cached.
+    UInt32 cpu_features() {
+        static UInt32 features = 0;
+        static bool detected = false;
+        if(CORETEN_LIKELY(detected))
+            return features;
+
+        UInt32 result = 0;
+    #if defined(CORETEN_CPU_X86) && (defined(__GNUC__) || defined(__clang__))
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("sse2"))     result |= CpuFeatureSSE2;
+        if(__builtin_cpu_supports("sse4.2"))   result |= CpuFeatureSSE42;
+        if(__builtin_cpu_supports("avx"))      result |= CpuFeatureAVX;
+        if(__builtin_cpu_supports("avx2"))     result |= CpuFeatureAVX2;
+        if(__builtin_cpu_supports("fma"))      result |= CpuFeatureFMA;
+        if(__builtin_cpu_supports("avx512f"))  result |= CpuFeatureAVX512F;
+        if(__builtin_cpu_supports("avx512bw")) result |= CpuFeatureAVX512BW;
+    #elif defined(CORETEN_CPU_X86) && defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        int max_leaf = info[0];
+        __cpuid(info, 1);
+        if(info[3] & (1 << 26)) result |= CpuFeatureSSE2;
+        if(info[2] & (1 << 20)) result |= CpuFeatureSSE42;
+        if(info[2] & (1 << 12)) result |= CpuFeatureFMA;
+        // AVX also needs the OS to save the YMM registers (OSXSAVE + XCR0)
+        bool os_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 0x6) == 0x6);
+        bool os_avx512 = os_avx && ((_xgetbv(0) & 0xe6) == 0xe6);
+        if(os_avx) result |= CpuFeatureAVX;
+        if(max_leaf >= 7) {
+            __cpuidex(info, 7, 0);
+            if(os_avx && (info[1] & (1 << 5)))     result |= CpuFeatureAVX2;
+            if(os_avx512 && (info[1] & (1 << 16))) result |= CpuFeatureAVX512F;
+            if(os_avx512 && (info[1] & (1 << 30))) result |= CpuFeatureAVX512BW;
+        }
+        if(!os_avx)
+            result &= ~cast(UInt32)CpuFeatureFMA;
+    #elif defined(CORETEN_SIMD_NEON)
+        result |= CpuFeatureNEON;
+    #endif // CORETEN_CPU_X86
+
+        features = result;
+        detected = true;
+        return features;
+    }
+
+    // Does the CPU we're running on support `feature`?
+    bool cpu_has_feature(CpuFeature feature) {
+        return (cpu_features() & cast(UInt32)feature) != 0;
+    }
+#endif // CORETEN_IMPL
+
 #endif // CORETEN_CPU_H
\ No newline at end of file
@@ -226,4 +226,16 @@ Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
     #endif // __MINGW32__
 #endif // CORETEN_COMPILER_MSVC
 
+// Opt a function out of AddressSanitizer (and ThreadSanitizer) instrumentation.
+// Only meant for SIMD/word-at-a-time scans that deliberately read (but never use) bytes past the end of a string
+// within the same aligned block - such reads can never cross a page boundary, but ASan can't know that (and TSan
+// would report a race on bytes that belong to whatever another thread keeps next to the string).
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 7)
+    #define CORETEN_NO_SANITIZE_ADDRESS     __attribute__((no_sanitize_address))
+    #define CORETEN_NO_SANITIZE_THREAD      __attribute__((no_sanitize_thread))
+#else
+    #define CORETEN_NO_SANITIZE_ADDRESS
+    #define CORETEN_NO_SANITIZE_THREAD
+#endif // __clang__
+
 #endif // CORETEN_MISCELLANEOUS_H
@@ -147,7 +147,7 @@ bool os_path_is_root(cstlBuffView* path);
     cstlBuffView os_path_join(cstlBuffView path1, cstlBuffView path2) {
         UInt64 length = path1.len;
         if(!length)
-            return path1;
+            return path2;
             
         char* end = buffview_end(&path1);
         if(!os_is_sep(*end))
@@ -0,0 +1,249 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#ifndef CORETEN_STRBUILDER_H
+#define CORETEN_STRBUILDER_H
+
+#include <stdarg.h>
+#include <adorad/core/debug.h>
+#include <adorad/core/types.h>
+#include <adorad/core/misc.h>
+#include <adorad/core/buffer.h>
+
+/*
+    A `cstlStrBuilder` is a growable string buffer.
+
+    Unlike `cstlBuffer` (which is fixed-size and re-allocates on every append), a StrBuilder tracks its capacity
+    separately from its length and grows geometrically, so a sequence of `n` appends costs O(n) amortized with
+    O(log n) reallocations.
+    The data is always kept null-terminated, so `sb->data` can be handed to C APIs at any point.
+
+    Once you're done building, `strbuilder_finish()` hands the underlying memory over to a `cstlBuffer` without
+    copying it.
+*/
+
+typedef struct cstlStrBuilder cstlStrBuilder;
+typedef cstlStrBuilder StrBuilder;
+
+struct cstlStrBuilder {
+    char* data;        // builder data (always null-terminated, if not null)
+    UInt64 len;        // no. of bytes currently used (excluding the null terminator)
+    UInt64 capacity;   // allocated capacity (excluding the null terminator)
+};
+
+// The capacity a StrBuilder starts off with if none is specified
+#define STRBUILDER_INIT_ALLOC_CAP   64
+
+cstlStrBuilder* strbuilder_new(UInt64 capacity);
+void strbuilder_init(cstlStrBuilder* sb, UInt64 capacity);
+void strbuilder_free(cstlStrBuilder* sb);
+void strbuilder_reserve(cstlStrBuilder* sb, UInt64 additional);
+void strbuilder_append(cstlStrBuilder* sb, cstlBuffer* buffer);
+void strbuilder_append_cstr(cstlStrBuilder* sb, const char* cstr);
+void strbuilder_append_n(cstlStrBuilder* sb, const char* data, UInt64 n);
+void strbuilder_append_char(cstlStrBuilder* sb, char ch);
+void strbuilder_append_repeat(cstlStrBuilder* sb, char ch, UInt64 n);
+int ATTRIBUTE_PRINTF(2, 3) strbuilder_appendf(cstlStrBuilder* sb, const char* fmt, ...);
+int strbuilder_vappendf(cstlStrBuilder* sb, const char* fmt, va_list args);
+UInt64 strbuilder_len(cstlStrBuilder* sb);
+UInt64 strbuilder_cap(cstlStrBuilder* sb);
+void strbuilder_clear(cstlStrBuilder* sb);
+cstlBuffView strbuilder_view(cstlStrBuilder* sb);
+cstlBuffer* strbuilder_finish(cstlStrBuilder* sb);
+
+#ifdef CORETEN_IMPL
+    #include <string.h>
+
+    // Create a new (heap-allocated) `cstlStrBuilder` with room for at least `capacity` bytes
+    cstlStrBuilder* strbuilder_new(UInt64 capacity) {
+        cstlStrBuilder* sb = cast(cstlStrBuilder*)calloc(1, sizeof(cstlStrBuilder));
+        CORETEN_ENFORCE_NN(sb, "Could not allocate memory. Memory full.");
+
+        strbuilder_init(sb, capacity);
+        return sb;
+    }
+
+    // Initialize a (usually stack-allocated) `cstlStrBuilder`
+    void strbuilder_init(cstlStrBuilder* sb, UInt64 capacity) {
+        CORETEN_ENFORCE_NN(sb, "Expected not null");
+        if(capacity == 0)
+            capacity = STRBUILDER_INIT_ALLOC_CAP;
+
+        sb->data = cast(char*)malloc(capacity + 1);
+        CORETEN_ENFORCE_NN(sb->data, "Could not allocate memory. Memory full.");
+        sb->data[0] = nullchar;
+        sb->len = 0;
+        sb->capacity = capacity;
+    }
+
+    // Free a heap-allocated `cstlStrBuilder` (created using `strbuilder_new()`) and its data
+    void strbuilder_free(cstlStrBuilder* sb) {
+        if(SOME(sb)) {
+            if(SOME(sb->data))
+                free(sb->data);
+            free(sb);
+        }
+    }
+
+    // Ensure there's room for at least `additional` more bytes without a reallocation.
+    // If more space is needed, we grow to the larger of (len + additional) and twice the current capacity.
+    void strbuilder_reserve(cstlStrBuilder* sb, UInt64 additional) {
+        CORETEN_ENFORCE_NN(sb, "Expected not null");
+
+        UInt64 required = sb->len + additional;
+        if(CORETEN_LIKELY(SOME(sb->data) && required <= sb->capacity))
+            return;
+
+        UInt64 newcapacity = sb->capacity ? sb->capacity * 2 : STRBUILDER_INIT_ALLOC_CAP;
+        if(newcapacity < required)
+            newcapacity = required;
+
+        char* newdata = cast(char*)realloc(sb->data, newcapacity + 1);
+        CORETEN_ENFORCE_NN(newdata, "Could not allocate memory. Memory full.");
+        if(NONE(sb->data))
+            newdata[0] = nullchar;
+
+        sb->data = newdata;
+        sb->capacity = newcapacity;
+    }
+
+    // Append `n` bytes from `data`
+    void strbuilder_append_n(cstlStrBuilder* sb, const char* data, UInt64 n) {
+        if(n == 0)
+            return;
+        CORETEN_ENFORCE_NN(data, "Expected not null");
+
+        strbuilder_reserve(sb, n);
+        memcpy(sb->data + sb->len, data, n);
+        sb->len += n;
+        sb->data[sb->len] = nullchar;
+    }
+
+    // Append the contents of `buffer`
+    void strbuilder_append(cstlStrBuilder* sb, cstlBuffer* buffer) {
+        CORETEN_ENFORCE_NN(buffer, "Expected not null");
+        strbuilder_append_n(sb, buffer->data, buffer->len);
+    }
+
+    // Append a null-terminated C string
+    void strbuilder_append_cstr(cstlStrBuilder* sb, const char* cstr) {
+        CORETEN_ENFORCE_NN(cstr, "Expected not null");
+        strbuilder_append_n(sb, cstr, cast(UInt64)strlen(cstr));
+    }
+
+    // Append a single character
+    void strbuilder_append_char(cstlStrBuilder* sb, char ch) {
+        strbuilder_reserve(sb, 1);
+        sb->data[sb->len++] = ch;
+        sb->data[sb->len] = nullchar;
+    }
+
+    // Append `ch` `n` times (useful for indentation)
+    void strbuilder_append_repeat(cstlStrBuilder* sb, char ch, UInt64 n) {
+        if(n == 0)
+            return;
+
+        strbuilder_reserve(sb, n);
+        memset(sb->data + sb->len, ch, n);
+        sb->len += n;
+        sb->data[sb->len] = nullchar;
+    }
+
+    // `printf`-style append.
+    // The output is formatted directly into the builder's spare capacity; only if it doesn't fit do we grow
+    // (to the exact size reported by `vsnprintf`) and format a second time. No intermediate buffer is used.
+    // Returns the number of bytes appended (or a negative value on an encoding error)
+    int strbuilder_vappendf(cstlStrBuilder* sb, const char* fmt, va_list args) {
+        CORETEN_ENFORCE_NN(fmt, "Expected not null");
+        strbuilder_reserve(sb, 0);
+
+        va_list args_copy;
+        va_copy(args_copy, args);
+        UInt64 spare = sb->capacity - sb->len;
+        int n = vsnprintf(sb->data + sb->len, spare + 1, fmt, args_copy);
+        va_end(args_copy);
+
+        if(n < 0) {
+            sb->data[sb->len] = nullchar;
+            return n;
+        }
+
+        if(cast(UInt64)n > spare) {
+            strbuilder_reserve(sb, cast(UInt64)n);
+            vsnprintf(sb->data + sb->len, cast(UInt64)n + 1, fmt, args);
+        }
+
+        sb->len += cast(UInt64)n;
+        return n;
+    }
+
+    int strbuilder_appendf(cstlStrBuilder* sb, const char* fmt, ...) {
+        va_list args;
+        va_start(args, fmt);
+        int n = strbuilder_vappendf(sb, fmt, args);
+        va_end(args);
+        return n;
+    }
+
+    // Returns the number of bytes in the builder
+    UInt64 strbuilder_len(cstlStrBuilder* sb) {
+        return sb->len;
+    }
+
+    // Returns the allocated capacity of the builder
+    UInt64 strbuilder_cap(cstlStrBuilder* sb) {
+        return sb->capacity;
+    }
+
+    // Clear the contents of the builder (the capacity is kept around for reuse)
+    void strbuilder_clear(cstlStrBuilder* sb) {
+        CORETEN_ENFORCE_NN(sb, "Expected not null");
+        sb->len = 0;
+        if(SOME(sb->data))
+            sb->data[0] = nullchar;
+    }
+
+    // Returns a (stack) view into the builder data.
+    // The view is invalidated by the next append that causes the builder to grow.
+    cstlBuffView strbuilder_view(cstlStrBuilder* sb) {
+        CORETEN_ENFORCE_NN(sb, "Expected not null");
+        if(NONE(sb->data))
+            return buffview_new_from_len("", 0);
+        return buffview_new_from_len(sb->data, sb->len);
+    }
+
+    // Hand the builder data over to a new `cstlBuffer` (zero-copy).
+    // The builder is left empty (with no capacity) and can be reused; the returned buffer now owns the data.
+    cstlBuffer* strbuilder_finish(cstlStrBuilder* sb) {
+        CORETEN_ENFORCE_NN(sb, "Expected not null");
+
+        cstlBuffer* buffer = cast(cstlBuffer*)calloc(1, sizeof(cstlBuffer));
+        CORETEN_ENFORCE_NN(buffer, "Could not allocate memory. Memory full.");
+
+        if(NONE(sb->data)) {
+            buffer->data = "";
+            buffer->len = 0;
+        } else {
+            buffer->data = sb->data;
+            buffer->len = sb->len;
+        }
+
+        sb->data = null;
+        sb->len = 0;
+        sb->capacity = 0;
+        return buffer;
+    }
+
+#endif // CORETEN_IMPL
+
+#endif // CORETEN_STRBUILDER_H
@@ -0,0 +1,785 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#ifndef CORETEN_STROPS_H
+#define CORETEN_STROPS_H
+
+#include <adorad/core/cpu.h>
+#include <adorad/core/debug.h>
+#include <adorad/core/types.h>
+#include <adorad/core/misc.h>
+
+/*
+    Vectorized string primitives.
+
+    Every operation here has three implementations:
+        1. AVX2    (32 bytes at a time; x86 only, selected at runtime)
+        2. SSE2    (16 bytes at a time; the x86-64 baseline)
+        3. Portable SWAR ("SIMD within a register" - 8 bytes at a time in a plain 64-bit integer). This is what
+           every other architecture (including ARM/NEON) gets, and is written with the same
+           compare-mask-then-locate shape as the vector versions.
+
+    The best implementation is picked the first time an operation is called (using `cpu_has_feature()`) and
+    cached in a function pointer, so the dispatch cost is a single indirect call.
+
+    The null-terminated scans (`str_len()`, `str_find_char()` and `str_rfind_char()`) load whole aligned blocks, so
+    they read bytes before `str` and past its terminator: up to the end of the 8-byte (SWAR), 16-byte (SSE2) or
+    64-byte (AVX2, which loads 32-byte blocks in aligned pairs) block the terminator is in. Those bytes are never used,
+    and an aligned block never crosses a page boundary, so the reads can't fault - but they're outside the string as
+    far as ASan and TSan are concerned, so these functions aren't instrumented (see `CORETEN_NO_SANITIZE_ADDRESS`).
+
+    Case conversion and case-insensitive comparison only fold ASCII letters - non-ASCII bytes are left as-is,
+    which matches `char_to_lower()` and `char_to_upper()`.
+*/
+
+// Length of a null-terminated string (like `strlen()`). Reads past the terminator, within its aligned block.
+UInt64 str_len(const char* str);
+// First occurence of `ch` in a null-terminated string, or null (like `strchr()`)
+char* str_find_char(const char* str, char ch);
+// Last occurence of `ch` in a null-terminated string, or null (like `strrchr()`)
+char* str_rfind_char(const char* str, char ch);
+// Are the first `n` bytes of `a` and `b` equal?
+bool mem_eq(const void* a, const void* b, UInt64 n);
+// Are the first `n` bytes of `a` and `b` equal (ignoring ASCII case)?
+bool mem_eq_nocase(const char* a, const char* b, UInt64 n);
+// First occurence of `ch` in the first `n` bytes of `data`, or null (like `memchr()`)
+char* mem_find_char(const char* data, char ch, UInt64 n);
+// Last occurence of `ch` in the first `n` bytes of `data`, or null (like `memrchr()`)
+char* mem_rfind_char(const char* data, char ch, UInt64 n);
+// Convert `n` bytes from `src` to lowercase and store them in `dest` (`dest` may alias `src`)
+void mem_to_lower(char* dest, const char* src, UInt64 n);
+// Convert `n` bytes from `src` to uppercase and store them in `dest` (`dest` may alias `src`)
+void mem_to_upper(char* dest, const char* src, UInt64 n);
+
+#ifdef CORETEN_IMPL
+    #include <string.h>
+    #if defined(CORETEN_SIMD_SSE2)
+        #include <emmintrin.h>
+    #endif // CORETEN_SIMD_SSE2
+    #if defined(CORETEN_SIMD_X86_DISPATCH)
+        #include <immintrin.h>
+    #endif // CORETEN_SIMD_X86_DISPATCH
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #endif // _MSC_VER
+
+    // Index of the lowest set bit in `mask` (`mask` must be non-zero)
+    static CORETEN_ALWAYS_INLINE UInt32 __strops_lowest_bit(UInt32 mask) {
+    #if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return cast(UInt32)index;
+    #else
+        return cast(UInt32)__builtin_ctz(mask);
+    #endif // _MSC_VER
+    }
+
+    // Index of the highest set bit in `mask` (`mask` must be non-zero)
+    static CORETEN_ALWAYS_INLINE UInt32 __strops_highest_bit(UInt32 mask) {
+    #if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long index;
+        _BitScanReverse(&index, mask);
+        return cast(UInt32)index;
+    #else
+        return 31 - cast(UInt32)__builtin_clz(mask);
+    #endif // _MSC_VER
+    }
+
+    /*
+        Portable (SWAR) implementation
+    */
+    #define __STROPS_ONES    0x0101010101010101ULL
+    #define __STROPS_HIGHS   0x8080808080808080ULL
+
+    static CORETEN_ALWAYS_INLINE UInt64 __strops_load64(const void* ptr) {
+        UInt64 word;
+        memcpy(&word, ptr, sizeof(word));
+        return word;
+    }
+
+    static CORETEN_ALWAYS_INLINE void __strops_store64(void* ptr, UInt64 word) {
+        memcpy(ptr, &word, sizeof(word));
+    }
+
+    // Non-zero if any byte in `word` is zero
+    static CORETEN_ALWAYS_INLINE UInt64 __strops_has_zero(UInt64 word) {
+        return (word - __STROPS_ONES) & ~word & __STROPS_HIGHS;
+    }
+
+    // High bit set in every byte of `word` that lies in ['lo', 'lo' + 25] (an ASCII letter range)
+    static CORETEN_ALWAYS_INLINE UInt64 __strops_swar_in_alpha(UInt64 word, unsigned char lo) {
+        UInt64 heptets = word & ~__STROPS_HIGHS;
+        UInt64 ge_lo = heptets + __STROPS_ONES * cast(UInt64)(0x80 - lo);
+        UInt64 gt_hi = heptets + __STROPS_ONES * cast(UInt64)(0x7f - (lo + 25));
+        return ~word & (ge_lo ^ gt_hi) & __STROPS_HIGHS;
+    }
+
+    static CORETEN_ALWAYS_INLINE UInt64 __strops_swar_lower(UInt64 word) {
+        return word | (__strops_swar_in_alpha(word, 'A') >> 2);
+    }
+
+    static CORETEN_ALWAYS_INLINE UInt64 __strops_swar_upper(UInt64 word) {
+        return word & ~(__strops_swar_in_alpha(word, 'a') >> 2);
+    }
+
+    CORETEN_NO_SANITIZE_ADDRESS CORETEN_NO_SANITIZE_THREAD
+    static UInt64 __strops_len_swar(const char* str) {
+        const char* p = str;
+        // Aligned 8-byte reads never cross a page boundary, so reading past the terminator is harmless
+        for(; (cast(uintptr_t)p & 7) != 0; p++) {
+            if(*p == nullchar)
+                return cast(UInt64)(p - str);
+        }
+        while(!__strops_has_zero(__strops_load64(p)))
+            p += 8;
+        while(*p != nullchar)
+            p++;
+        return cast(UInt64)(p - str);
+    }
+
+    CORETEN_NO_SANITIZE_ADDRESS CORETEN_NO_SANITIZE_THREAD
+    static char* __strops_find_char_swar(const char* str, char ch) {
+        const char* p = str;
+        for(; (cast(uintptr_t)p & 7) != 0; p++) {
+            if(*p == ch)
+                return cast(char*)p;
+            if(*p == nullchar)
+                return null;
+        }
+
+        UInt64 pattern = __STROPS_ONES * cast(unsigned char)ch;
+        for(;;) {
+            UInt64 word = __strops_load64(p);
+            if(__strops_has_zero(word) || __strops_has_zero(word ^ pattern))
+                break;
+            p += 8;
+        }
+        for(;; p++) {
+            if(*p == ch)
+                return cast(char*)p;
+            if(*p == nullchar)
+                return null;
+        }
+    }
+
+    CORETEN_NO_SANITIZE_ADDRESS CORETEN_NO_SANITIZE_THREAD
+    static char* __strops_rfind_char_swar(const char* str, char ch) {
+        const char* p = str;
+        const char* last = null;
+        for(; (cast(uintptr_t)p & 7) != 0; p++) {
+            if(*p == ch)
+                last = p;
+            if(*p == nullchar)
+                return cast(char*)last;
+        }
+
+        UInt64 pattern = __STROPS_ONES * cast(unsigned char)ch;
+        for(;; p += 8) {
+            UInt64 word = __strops_load64(p);
+            if(__strops_has_zero(word))
+                break;
+            if(__strops_has_zero(word ^ pattern)) {
+                for(int i = 0; i < 8; i++) {
+                    if(p[i] == ch)
+                        last = p + i;
+                }
+            }
+        }
+        for(;; p++) {
+            if(*p == ch)
+                last = p;
+            if(*p == nullchar)
+                return cast(char*)last;
+        }
+    }
+
+    static bool __strops_eq_swar(const void* a, const void* b, UInt64 n) {
+        const char* s1 = cast(const char*)a;
+        const char* s2 = cast(const char*)b;
+        for(; n >= 8; n -= 8, s1 += 8, s2 += 8) {
+            if(__strops_load64(s1) != __strops_load64(s2))
+                return false;
+        }
+        for(; n > 0; n--) {
+            if(*s1++ != *s2++)
+                return false;
+        }
+        return true;
+    }
+
+    static bool __strops_eq_nocase_swar(const char* s1, const char* s2, UInt64 n) {
+        for(; n >= 8; n -= 8, s1 += 8, s2 += 8) {
+            UInt64 w1 = __strops_load64(s1);
+            UInt64 w2 = __strops_load64(s2);
+            if(w1 != w2 && __strops_swar_lower(w1) != __strops_swar_lower(w2))
+                return false;
+        }
+        for(; n > 0; n--, s1++, s2++) {
+            char c1 = *s1, c2 = *s2;
+            if(c1 >= 'A' && c1 <= 'Z') c1 += 'a' - 'A';
+            if(c2 >= 'A' && c2 <= 'Z') c2 += 'a' - 'A';
+            if(c1 != c2)
+                return false;
+        }
+        return true;
+    }
+
+    static char* __strops_mem_find_char_swar(const char* data, char ch, UInt64 n) {
+        UInt64 pattern = __STROPS_ONES * cast(unsigned char)ch;
+        for(; n >= 8; n -= 8, data += 8) {
+            if(__strops_has_zero(__strops_load64(data) ^ pattern))
+                break;
+        }
+        for(; n > 0; n--, data++) {
+            if(*data == ch)
+                return cast(char*)data;
+        }
+        return null;
+    }
+
+    static char* __strops_mem_rfind_char_swar(const char* data, char ch, UInt64 n) {
+        UInt64 pattern = __STROPS_ONES * cast(unsigned char)ch;
+        for(; n >= 8; n -= 8) {
+            if(__strops_has_zero(__strops_load64(data + n - 8) ^ pattern))
+                break;
+        }
+        for(; n > 0; n--) {
+            if(data[n - 1] == ch)
+                return cast(char*)(data + n - 1);
+        }
+        return null;
+    }
+
+    static void __strops_to_lower_swar(char* dest, const char* src, UInt64 n) {
+        for(; n >= 8; n -= 8, src += 8, dest += 8)
+            __strops_store64(dest, __strops_swar_lower(__strops_load64(src)));
+        for(; n > 0; n--, src++, dest++)
+            *dest = (*src >= 'A' && *src <= 'Z') ? *src + ('a' - 'A') : *src;
+    }
+
+    static void __strops_to_upper_swar(char* dest, const char* src, UInt64 n) {
+        for(; n >= 8; n -= 8, src += 8, dest += 8)
+            __strops_store64(dest, __strops_swar_upper(__strops_load64(src)));
+        for(; n > 0; n--, src++, dest++)
+            *dest = (*src >= 'a' && *src <= 'z') ? *src - ('a' - 'A') : *src;
+    }
+
+    /*
+        SSE2 implementation
+    */
+    #if defined(CORETEN_SIMD_SSE2)
+    // Mask of the bytes in `v` that lie in ['lo', 'lo' + 25].
+    // Shifting the range down to start at -128 lets a single signed compare do the job of two.
+    static CORETEN_ALWAYS_INLINE __m128i __strops_sse2_in_alpha(__m128i v, char lo) {
+        __m128i shifted = _mm_add_epi8(v, _mm_set1_epi8(cast(char)(0x80 - lo)));
+        return _mm_cmplt_epi8(shifted, _mm_set1_epi8(cast(char)(-128 + 26)));
+    }
+
+    static CORETEN_ALWAYS_INLINE __m128i __strops_sse2_lower(__m128i v) {
+        return _mm_or_si128(v, _mm_and_si128(__strops_sse2_in_alpha(v, 'A'), _mm_set1_epi8(0x20)));
+    }
+
+    static CORETEN_ALWAYS_INLINE __m128i __strops_sse2_upper(__m128i v) {
+        return _mm_andnot_si128(_mm_and_si128(__strops_sse2_in_alpha(v, 'a'), _mm_set1_epi8(0x20)), v);
+    }
+
+    // The null-terminated scans below load aligned 16-byte blocks (which can't cross a page boundary) and discard
+    // the bytes before `str`
+    CORETEN_NO_SANITIZE_ADDRESS CORETEN_NO_SANITIZE_THREAD
+    static UInt64 __strops_len_sse2(const char* str) {
+        UInt32 offset = cast(UInt32)(cast(uintptr_t)str & 15);
+        const __m128i* block = cast(const __m128i*)(str - offset);
+        __m128i zero = _mm_setzero_si128();
+
+        UInt32 mask = cast(UInt32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(block), zero)) >> offset;
+        if(mask)
+            return __strops_lowest_bit(mask);
+        for(;;) {
+            block++;
+            mask = cast(UInt32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(block), zero));
+            if(mask)
+                return cast(UInt64)(cast(const char*)block - str) + __strops_lowest_bit(mask);
+        }
+    }
+
+    CORETEN_NO_SANITIZE_ADDRESS CORETEN_NO_SANITIZE_THREAD
+    static char* __strops_find_char_sse2(const char* str, char ch) {
+        UInt32 offset = cast(UInt32)(cast(uintptr_t)str & 15);
+        const char* block = str - offset;
+        __m128i zero = _mm_setzero_si128();
+        __m128i pattern = _mm_set1_epi8(ch);
+
+        __m128i v = _mm_load_si128(cast(const __m128i*)block);
+        UInt32 mask = cast(UInt32)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, zero), _mm_cmpeq_epi8(v, pattern)));
+        mask = (mask >> offset) << offset;
+        while(!mask) {
+            block += 16;
+            v = _mm_load_si128(cast(const __m128i*)block);
+            mask = cast(UInt32)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, zero), _mm_cmpeq_epi8(v, pattern)));
+        }
+        const char* found = block + __strops_lowest_bit(mask);
+        return *found == ch ? cast(char*)found : null;
+    }
+
+    CORETEN_NO_SANITIZE_ADDRESS CORETEN_NO_SANITIZE_THREAD
+    static char* __strops_rfind_char_sse2(const char* str, char ch) {
+        UInt32 offset = cast(UInt32)(cast(uintptr_t)str & 15);
+        const char* block = str - offset;
+        const char* last = null;
+        __m128i zero = _mm_setzero_si128();
+        __m128i pattern = _mm_set1_epi8(ch);
+
+        __m128i v = _mm_load_si128(cast(const __m128i*)block);
+        UInt32 zmask = (cast(UInt32)_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)) >> offset) << offset;
+        UInt32 cmask = (cast(UInt32)_mm_movemask_epi8(_mm_cmpeq_epi8(v, pattern)) >> offset) << offset;
+        for(;;) {
+            if(zmask) {
+                // Only keep matches up to (and including) the terminator
+                cmask &= zmask ^ (zmask - 1);
+                if(cmask)
+                    last = block + __strops_highest_bit(cmask);
+                return cast(char*)last;
+            }
+            if(cmask)
+                last = block + __strops_highest_bit(cmask);
+
+            block += 16;
+            v = _mm_load_si128(cast(const __m128i*)block);
+            zmask = cast(UInt32)_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero));
+            cmask = cast(UInt32)_mm_movemask_epi8(_mm_cmpeq_epi8(v, pattern));
+        }
+    }
+
+    static bool __strops_eq_sse2(const void* a, const void* b, UInt64 n) {
+        const char* s1 = cast(const char*)a;
+        const char* s2 = cast(const char*)b;
+        for(; n >= 16; n -= 16, s1 += 16, s2 += 16) {
+            __m128i v1 = _mm_loadu_si128(cast(const __m128i*)s1);
+            __m128i v2 = _mm_loadu_si128(cast(const __m128i*)s2);
+            if(_mm_movemask_epi8(_mm_cmpeq_epi8(v1, v2)) != 0xffff)
+                return false;
+        }
+        return __strops_eq_swar(s1, s2, n);
+    }
+
+    static bool __strops_eq_nocase_sse2(const char* s1, const char* s2, UInt64 n) {
+        for(; n >= 16; n -= 16, s1 += 16, s2 += 16) {
+            __m128i v1 = __strops_sse2_lower(_mm_loadu_si128(cast(const __m128i*)s1));
+            __m128i v2 = __strops_sse2_lower(_mm_loadu_si128(cast(const __m128i*)s2));
+            if(_mm_movemask_epi8(_mm_cmpeq_epi8(v1, v2)) != 0xffff)
+                return false;
+        }
+        return __strops_eq_nocase_swar(s1, s2, n);
+    }
+
+    static char* __strops_mem_find_char_sse2(const char* data, char ch, UInt64 n) {
+        __m128i pattern = _mm_set1_epi8(ch);
+        for(; n >= 16; n -= 16, data += 16) {
+            UInt32 mask = cast(UInt32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(cast(const __m128i*)data), pattern));
+            if(mask)
+                return cast(char*)(data + __strops_lowest_bit(mask));
+        }
+        return __strops_mem_find_char_swar(data, ch, n);
+    }
+
+    static char* __strops_mem_rfind_char_sse2(const char* data, char ch, UInt64 n) {
+        __m128i pattern = _mm_set1_epi8(ch);
+        for(; n >= 16; n -= 16) {
+            const char* block = data + n - 16;
+            UInt32 mask = cast(UInt32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(cast(const __m128i*)block), pattern));
+            if(mask)
+                return cast(char*)(block + __strops_highest_bit(mask));
+        }
+        return __strops_mem_rfind_char_swar(data, ch, n);
+    }
+
+    static void __strops_to_lower_sse2(char* dest, const char* src, UInt64 n) {
+        for(; n >= 16; n -= 16, src += 16, dest += 16)
+            _mm_storeu_si128(cast(__m128i*)dest, __strops_sse2_lower(_mm_loadu_si128(cast(const __m128i*)src)));
+        __strops_to_lower_swar(dest, src, n);
+    }
+
+    static void __strops_to_upper_sse2(char* dest, const char* src, UInt64 n) {
+        for(; n >= 16; n -= 16, src += 16, dest += 16)
+            _mm_storeu_si128(cast(__m128i*)dest, __strops_sse2_upper(_mm_loadu_si128(cast(const __m128i*)src)));
+        __strops_to_upper_swar(dest, src, n);
+    }
+    #endif // CORETEN_SIMD_SSE2
+
+    /*
+        AVX2 implementation
+    */
+    #if defined(CORETEN_SIMD_X86_DISPATCH) && defined(CORETEN_SIMD_SSE2)
+    #define __STROPS_HAVE_AVX2  1
+
+    CORETEN_TARGET("avx2")
+    static CORETEN_ALWAYS_INLINE __m256i __strops_avx2_in_alpha(__m256i v, char lo) {
+        __m256i shifted = _mm256_add_epi8(v, _mm256_set1_epi8(cast(char)(0x80 - lo)));
+        return _mm256_cmpgt_epi8(_mm256_set1_epi8(cast(char)(-128 + 26)), shifted);
+    }
+
+    CORETEN_TARGET("avx2")
+    static CORETEN_ALWAYS_INLINE __m256i __strops_avx2_lower(__m256i v) {
+        return _mm256_or_si256(v, _mm256_and_si256(__strops_avx2_in_alpha(v, 'A'), _mm256_set1_epi8(0x20)));
+    }
+
+    CORETEN_TARGET("avx2")
+    static CORETEN_ALWAYS_INLINE __m256i __strops_avx2_upper(__m256i v) {
+        return _mm256_andnot_si256(_mm256_and_si256(__strops_avx2_in_alpha(v, 'a'), _mm256_set1_epi8(0x20)), v);
+    }
+
+    CORETEN_TARGET("avx2") CORETEN_NO_SANITIZE_ADDRESS CORETEN_NO_SANITIZE_THREAD
+    static UInt64 __strops_len_avx2(const char* str) {
+        UInt32 offset = cast(UInt32)(cast(uintptr_t)str & 31);
+        const __m256i* block = cast(const __m256i*)(str - offset);
+        __m256i zero = _mm256_setzero_si256();
+
+        UInt32 mask = cast(UInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256(block), zero)) >> offset;
+        if(mask)
+            return __strops_lowest_bit(mask);
+        // Pairs of blocks start 64-byte aligned, so the second one is never past the page the terminator is on
+        block++;
+        if(cast(uintptr_t)block & 32) {
+            mask = cast(UInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256(block), zero));
+            if(mask)
+                return cast(UInt64)(cast(const char*)block - str) + __strops_lowest_bit(mask);
+            block++;
+        }
+        // Two blocks per iteration: the unsigned minimum of both has a zero byte iff either of them does
+        for(;; block += 2) {
+            __m256i v0 = _mm256_load_si256(block);
+            __m256i v1 = _mm256_load_si256(block + 1);
+            if(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(v0, v1), zero)))
+                break;
+        }
+        mask = cast(UInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256(block), zero));
+        if(!mask) {
+            block++;
+            mask = cast(UInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256(block), zero));
+        }
+        return cast(UInt64)(cast(const char*)block - str) + __strops_lowest_bit(mask);
+    }
+
+    // Zero in every byte of `v` that is either `ch` or the null terminator
+    CORETEN_TARGET("avx2")
+    static CORETEN_ALWAYS_INLINE __m256i __strops_avx2_char_or_zero(__m256i v, __m256i pattern) {
+        return _mm256_min_epu8(_mm256_xor_si256(v, pattern), v);
+    }
+
+    CORETEN_TARGET("avx2") CORETEN_NO_SANITIZE_ADDRESS CORETEN_NO_SANITIZE_THREAD
+    static char* __strops_find_char_avx2(const char* str, char ch) {
+        UInt32 offset = cast(UInt32)(cast(uintptr_t)str & 31);
+        const char* block = str - offset;
+        __m256i zero = _mm256_setzero_si256();
+        __m256i pattern = _mm256_set1_epi8(ch);
+
+        __m256i v = __strops_avx2_char_or_zero(_mm256_load_si256(cast(const __m256i*)block), pattern);
+        UInt32 mask = cast(UInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, zero));
+        mask = (mask >> offset) << offset;
+        // Like in `__strops_len_avx2()`, pairs of blocks start 64-byte aligned
+        if(!mask && (cast(uintptr_t)block & 32) == 0) {
+            block += 32;
+            v = __strops_avx2_char_or_zero(_mm256_load_si256(cast(const __m256i*)block), pattern);
+            mask = cast(UInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, zero));
+        }
+        if(!mask) {
+            for(block += 32;; block += 64) {
+                __m256i v0 = __strops_avx2_char_or_zero(_mm256_load_si256(cast(const __m256i*)block), pattern);
+                __m256i v1 = __strops_avx2_char_or_zero(_mm256_load_si256(cast(const __m256i*)(block + 32)), pattern);
+                if(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(v0, v1), zero))) {
+                    mask = cast(UInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v0, zero));
+                    if(!mask) {
+                        block += 32;
+                        mask = cast(UInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v1, zero));
+                    }
+                    break;
+                }
+            }
+        }
+        const char* found = block + __strops_lowest_bit(mask);
+        return *found == ch ? cast(char*)found : null;
+    }
+
+    CORETEN_TARGET("avx2") CORETEN_NO_SANITIZE_ADDRESS CORETEN_NO_SANITIZE_THREAD
+    static char* __strops_rfind_char_avx2(const char* str, char ch) {
+        UInt32 offset = cast(UInt32)(cast(uintptr_t)str & 31);
+        const char* block = str - offset;
+        const char* last = null;
+        __m256i zero = _mm256_setzero_si256();
+        __m256i pattern = _mm256_set1_epi8(ch);
+
+        __m256i v = _mm256_load_si256(cast(const __m256i*)block);
+        UInt32 zmask = (cast(UInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, zero)) >> offset) << offset;
+        UInt32 cmask = (cast(UInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, pattern)) >> offset) << offset;
+        for(;;) {
+            if(zmask) {
+                cmask &= zmask ^ (zmask - 1);
+                if(cmask)
+                    last = block + __strops_highest_bit(cmask);
+                return cast(char*)last;
+            }
+            if(cmask)
+                last = block + __strops_highest_bit(cmask);
+
+            block += 32;
+            v = _mm256_load_si256(cast(const __m256i*)block);
+            zmask = cast(UInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, zero));
+            cmask = cast(UInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, pattern));
+        }
+    }
+
+    CORETEN_TARGET("avx2")
+    static bool __strops_eq_avx2(const void* a, const void* b, UInt64 n) {
+        const char* s1 = cast(const char*)a;
+        const char* s2 = cast(const char*)b;
+        for(; n >= 128; n -= 128, s1 += 128, s2 += 128) {
+            __m256i e0 = _mm256_cmpeq_epi8(_mm256_loadu_si256(cast(const __m256i*)s1),
+                                           _mm256_loadu_si256(cast(const __m256i*)s2));
+            __m256i e1 = _mm256_cmpeq_epi8(_mm256_loadu_si256(cast(const __m256i*)(s1 + 32)),
+                                           _mm256_loadu_si256(cast(const __m256i*)(s2 + 32)));
+            __m256i e2 = _mm256_cmpeq_epi8(_mm256_loadu_si256(cast(const __m256i*)(s1 + 64)),
+                                           _mm256_loadu_si256(cast(const __m256i*)(s2 + 64)));
+            __m256i e3 = _mm256_cmpeq_epi8(_mm256_loadu_si256(cast(const __m256i*)(s1 + 96)),
+                                           _mm256_loadu_si256(cast(const __m256i*)(s2 + 96)));
+            __m256i all = _mm256_and_si256(_mm256_and_si256(e0, e1), _mm256_and_si256(e2, e3));
+            if(cast(UInt32)_mm256_movemask_epi8(all) != 0xffffffffu)
+                return false;
+        }
+        for(; n >= 32; n -= 32, s1 += 32, s2 += 32) {
+            __m256i v1 = _mm256_loadu_si256(cast(const __m256i*)s1);
+            __m256i v2 = _mm256_loadu_si256(cast(const __m256i*)s2);
+            if(cast(UInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v1, v2)) != 0xffffffffu)
+                return false;
+        }
+        return __strops_eq_sse2(s1, s2, n);
+    }
+
+    CORETEN_TARGET("avx2")
+    static bool __strops_eq_nocase_avx2(const char* s1, const char* s2, UInt64 n) {
+        for(; n >= 32; n -= 32, s1 += 32, s2 += 32) {
+            __m256i v1 = __strops_avx2_lower(_mm256_loadu_si256(cast(const __m256i*)s1));
+            __m256i v2 = __strops_avx2_lower(_mm256_loadu_si256(cast(const __m256i*)s2));
+            if(cast(UInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v1, v2)) != 0xffffffffu)
+                return false;
+        }
+        return __strops_eq_nocase_sse2(s1, s2, n);
+    }
+
+    CORETEN_TARGET("avx2")
+    static char* __strops_mem_find_char_avx2(const char* data, char ch, UInt64 n) {
+        __m256i pattern = _mm256_set1_epi8(ch);
+        for(; n >= 128; n -= 128, data += 128) {
+            __m256i e0 = _mm256_cmpeq_epi8(_mm256_loadu_si256(cast(const __m256i*)data), pattern);
+            __m256i e1 = _mm256_cmpeq_epi8(_mm256_loadu_si256(cast(const __m256i*)(data + 32)), pattern);
+            __m256i e2 = _mm256_cmpeq_epi8(_mm256_loadu_si256(cast(const __m256i*)(data + 64)), pattern);
+            __m256i e3 = _mm256_cmpeq_epi8(_mm256_loadu_si256(cast(const __m256i*)(data + 96)), pattern);
+            __m256i any = _mm256_or_si256(_mm256_or_si256(e0, e1), _mm256_or_si256(e2, e3));
+            if(_mm256_movemask_epi8(any))
+                break;  // located by the loop below
+        }
+        for(; n >= 32; n -= 32, data += 32) {
+            __m256i v = _mm256_loadu_si256(cast(const __m256i*)data);
+            UInt32 mask = cast(UInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, pattern));
+            if(mask)
+                return cast(char*)(data + __strops_lowest_bit(mask));
+        }
+        return __strops_mem_find_char_sse2(data, ch, n);
+    }
+
+    CORETEN_TARGET("avx2")
+    static char* __strops_mem_rfind_char_avx2(const char* data, char ch, UInt64 n) {
+        __m256i pattern = _mm256_set1_epi8(ch);
+        for(; n >= 32; n -= 32) {
+            const char* block = data + n - 32;
+            __m256i v = _mm256_loadu_si256(cast(const __m256i*)block);
+            UInt32 mask = cast(UInt32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, pattern));
+            if(mask)
+                return cast(char*)(block + __strops_highest_bit(mask));
+        }
+        return __strops_mem_rfind_char_sse2(data, ch, n);
+    }
+
+    CORETEN_TARGET("avx2")
+    static void __strops_to_lower_avx2(char* dest, const char* src, UInt64 n) {
+        for(; n >= 32; n -= 32, src += 32, dest += 32)
+            _mm256_storeu_si256(cast(__m256i*)dest, __strops_avx2_lower(_mm256_loadu_si256(cast(const __m256i*)src)));
+        __strops_to_lower_sse2(dest, src, n);
+    }
+
+    CORETEN_TARGET("avx2")
+    static void __strops_to_upper_avx2(char* dest, const char* src, UInt64 n) {
+        for(; n >= 32; n -= 32, src += 32, dest += 32)
+            _mm256_storeu_si256(cast(__m256i*)dest, __strops_avx2_upper(_mm256_loadu_si256(cast(const __m256i*)src)));
+        __strops_to_upper_sse2(dest, src, n);
+    }
+    #endif // CORETEN_SIMD_X86_DISPATCH
+
+    /*
+        Runtime dispatch
+    */
+    static void __strops_select();
+
+    static UInt64 __strops_len_resolve(const char* str);
+    static char* __strops_find_char_resolve(const char* str, char ch);
+    static char* __strops_rfind_char_resolve(const char* str, char ch);
+    static bool __strops_eq_resolve(const void* a, const void* b, UInt64 n);
+    static bool __strops_eq_nocase_resolve(const char* a, const char* b, UInt64 n);
+    static char* __strops_mem_find_char_resolve(const char* data, char ch, UInt64 n);
+    static char* __strops_mem_rfind_char_resolve(const char* data, char ch, UInt64 n);
+    static void __strops_to_lower_resolve(char* dest, const char* src, UInt64 n);
+    static void __strops_to_upper_resolve(char* dest, const char* src, UInt64 n);
+
+    // Each of these starts out pointing to a resolver that picks the best implementation on the first call.
+    // Racing threads all store the same pointers, so no synchronization is needed.
+    static UInt64 (*__strops_len)(const char*) = __strops_len_resolve;
+    static char* (*__strops_find_char)(const char*, char) = __strops_find_char_resolve;
+    static char* (*__strops_rfind_char)(const char*, char) = __strops_rfind_char_resolve;
+    static bool (*__strops_eq)(const void*, const void*, UInt64) = __strops_eq_resolve;
+    static bool (*__strops_eq_nocase)(const char*, const char*, UInt64) = __strops_eq_nocase_resolve;
+    static char* (*__strops_mem_find_char)(const char*, char, UInt64) = __strops_mem_find_char_resolve;
+    static char* (*__strops_mem_rfind_char)(const char*, char, UInt64) = __strops_mem_rfind_char_resolve;
+    static void (*__strops_to_lower)(char*, const char*, UInt64) = __strops_to_lower_resolve;
+    static void (*__strops_to_upper)(char*, const char*, UInt64) = __strops_to_upper_resolve;
+
+    static void __strops_select() {
+    #if defined(__STROPS_HAVE_AVX2)
+        if(cpu_has_feature(CpuFeatureAVX2)) {
+            __strops_len = __strops_len_avx2;
+            __strops_find_char = __strops_find_char_avx2;
+            __strops_rfind_char = __strops_rfind_char_avx2;
+            __strops_eq = __strops_eq_avx2;
+            __strops_eq_nocase = __strops_eq_nocase_avx2;
+            __strops_mem_find_char = __strops_mem_find_char_avx2;
+            __strops_mem_rfind_char = __strops_mem_rfind_char_avx2;
+            __strops_to_lower = __strops_to_lower_avx2;
+            __strops_to_upper = __strops_to_upper_avx2;
+            return;
+        }
+    #endif // __STROPS_HAVE_AVX2
+    #if defined(CORETEN_SIMD_SSE2)
+        __strops_len = __strops_len_sse2;
+        __strops_find_char = __strops_find_char_sse2;
+        __strops_rfind_char = __strops_rfind_char_sse2;
+        __strops_eq = __strops_eq_sse2;
+        __strops_eq_nocase = __strops_eq_nocase_sse2;
+        __strops_mem_find_char = __strops_mem_find_char_sse2;
+        __strops_mem_rfind_char = __strops_mem_rfind_char_sse2;
+        __strops_to_lower = __strops_to_lower_sse2;
+        __strops_to_upper = __strops_to_upper_sse2;
+    #else
+        __strops_len = __strops_len_swar;
+        __strops_find_char = __strops_find_char_swar;
+        __strops_rfind_char = __strops_rfind_char_swar;
+        __strops_eq = __strops_eq_swar;
+        __strops_eq_nocase = __strops_eq_nocase_swar;
+        __strops_mem_find_char = __strops_mem_find_char_swar;
+        __strops_mem_rfind_char = __strops_mem_rfind_char_swar;
+        __strops_to_lower = __strops_to_lower_swar;
+        __strops_to_upper = __strops_to_upper_swar;
+    #endif // CORETEN_SIMD_SSE2
+    }
+
+    static UInt64 __strops_len_resolve(const char* str) {
+        __strops_select();
+        return __strops_len(str);
+    }
+
+    static char* __strops_find_char_resolve(const char* str, char ch) {
+        __strops_select();
+        return __strops_find_char(str, ch);
+    }
+
+    static char* __strops_rfind_char_resolve(const char* str, char ch) {
+        __strops_select();
+        return __strops_rfind_char(str, ch);
+    }
+
+    static bool __strops_eq_resolve(const void* a, const void* b, UInt64 n) {
+        __strops_select();
+        return __strops_eq(a, b, n);
+    }
+
+    static bool __strops_eq_nocase_resolve(const char* a, const char* b, UInt64 n) {
+        __strops_select();
+        return __strops_eq_nocase(a, b, n);
+    }
+
+    static char* __strops_mem_find_char_resolve(const char* data, char ch, UInt64 n) {
+        __strops_select();
+        return __strops_mem_find_char(data, ch, n);
+    }
+
+    static char* __strops_mem_rfind_char_resolve(const char* data, char ch, UInt64 n) {
+        __strops_select();
+        return __strops_mem_rfind_char(data, ch, n);
+    }
+
+    static void __strops_to_lower_resolve(char* dest, const char* src, UInt64 n) {
+        __strops_select();
+        __strops_to_lower(dest, src, n);
+    }
+
+    static void __strops_to_upper_resolve(char* dest, const char* src, UInt64 n) {
+        __strops_select();
+        __strops_to_upper(dest, src, n);
+    }
+
+    UInt64 str_len(const char* str) {
+        CORETEN_ENFORCE_NN(str, "Expected not null");
+        return __strops_len(str);
+    }
+
+    char* str_find_char(const char* str, char ch) {
+        CORETEN_ENFORCE_NN(str, "Expected not null");
+        return __strops_find_char(str, ch);
+    }
+
+    char* str_rfind_char(const char* str, char ch) {
+        CORETEN_ENFORCE_NN(str, "Expected not null");
+        return __strops_rfind_char(str, ch);
+    }
+
+    bool mem_eq(const void* a, const void* b, UInt64 n) {
+        if(a == b || n == 0)
+            return true;
+        return __strops_eq(a, b, n);
+    }
+
+    bool mem_eq_nocase(const char* a, const char* b, UInt64 n) {
+        if(a == b || n == 0)
+            return true;
+        return __strops_eq_nocase(a, b, n);
+    }
+
+    char* mem_find_char(const char* data, char ch, UInt64 n) {
+        if(n == 0)
+            return null;
+        return __strops_mem_find_char(data, ch, n);
+    }
+
+    char* mem_rfind_char(const char* data, char ch, UInt64 n) {
+        if(n == 0)
+            return null;
+        return __strops_mem_rfind_char(data, ch, n);
+    }
+
+    void mem_to_lower(char* dest, const char* src, UInt64 n) {
+        __strops_to_lower(dest, src, n);
+    }
+
+    void mem_to_upper(char* dest, const char* src, UInt64 n) {
+        __strops_to_upper(dest, src, n);
+    }
+#endif // CORETEN_IMPL
+
+#endif // CORETEN_STROPS_H
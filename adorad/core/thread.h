@@ -0,0 +1,399 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#ifndef CORETEN_THREAD_H
+#define CORETEN_THREAD_H
+
+/*
+    Threads, locks, atomics and a small thread pool.
+
+    The atomics are sequentially consistent - they're meant for counters, flags and publishing pointers, not for
+    building clever lock-free data structures.
+
+    The thread pool is fork-join: `threadpool_parallel_for()` runs `task(ctx, i, worker)` for every `i` in
+    `[0, count)` and only returns once all of them are done. The calling thread takes part as worker 0, so a pool
+    of size 1 spawns no threads at all (and behaves just like a plain loop).
+    Indices are claimed dynamically (one at a time), so uneven work items balance themselves out.
+*/
+
+#include <adorad/core/os_defs.h>
+#include <adorad/core/compilers.h>
+#include <adorad/core/headers.h>
+#include <adorad/core/types.h>
+#include <adorad/core/misc.h>
+
+#if defined(CORETEN_OS_WINDOWS)
+    #include <intrin.h>
+#else
+    #include <pthread.h>
+    #include <unistd.h>
+#endif // CORETEN_OS_WINDOWS
+
+#if defined(CORETEN_OS_WINDOWS)
+    typedef SRWLOCK                 Mutex;
+    typedef CONDITION_VARIABLE      CondVar;
+    typedef HANDLE                  Thread;
+#else
+    typedef pthread_mutex_t         Mutex;
+    typedef pthread_cond_t          CondVar;
+    typedef pthread_t               Thread;
+#endif // CORETEN_OS_WINDOWS
+
+typedef void (*ThreadProc)(void* arg);
+typedef void (*ThreadPoolTask)(void* ctx, UInt64 index, UInt32 worker);
+typedef struct ThreadPool ThreadPool;
+
+/*
+    Atomics
+*/
+#if defined(CORETEN_COMPILER_MSVC)
+    static CORETEN_ALWAYS_INLINE UInt32 atomic32_load(volatile UInt32* p) {
+        return cast(UInt32)_InterlockedOr(cast(volatile long*)p, 0);
+    }
+    static CORETEN_ALWAYS_INLINE void atomic32_store(volatile UInt32* p, UInt32 value) {
+        _InterlockedExchange(cast(volatile long*)p, cast(long)value);
+    }
+    static CORETEN_ALWAYS_INLINE UInt32 atomic32_fetch_add(volatile UInt32* p, UInt32 value) {
+        return cast(UInt32)_InterlockedExchangeAdd(cast(volatile long*)p, cast(long)value);
+    }
+    static CORETEN_ALWAYS_INLINE bool atomic32_cas(volatile UInt32* p, UInt32 expected, UInt32 desired) {
+        return _InterlockedCompareExchange(cast(volatile long*)p, cast(long)desired, cast(long)expected) ==
+               cast(long)expected;
+    }
+    static CORETEN_ALWAYS_INLINE UInt64 atomic64_load(volatile UInt64* p) {
+        return cast(UInt64)_InterlockedOr64(cast(volatile __int64*)p, 0);
+    }
+    static CORETEN_ALWAYS_INLINE void atomic64_store(volatile UInt64* p, UInt64 value) {
+        _InterlockedExchange64(cast(volatile __int64*)p, cast(__int64)value);
+    }
+    static CORETEN_ALWAYS_INLINE UInt64 atomic64_fetch_add(volatile UInt64* p, UInt64 value) {
+        return cast(UInt64)_InterlockedExchangeAdd64(cast(volatile __int64*)p, cast(__int64)value);
+    }
+    static CORETEN_ALWAYS_INLINE bool atomic64_cas(volatile UInt64* p, UInt64 expected, UInt64 desired) {
+        return _InterlockedCompareExchange64(cast(volatile __int64*)p, cast(__int64)desired, cast(__int64)expected)
+               == cast(__int64)expected;
+    }
+    static CORETEN_ALWAYS_INLINE void* atomicptr_load(void* volatile* p) {
+        return _InterlockedCompareExchangePointer(p, null, null);
+    }
+    static CORETEN_ALWAYS_INLINE void atomicptr_store(void* volatile* p, void* value) {
+        _InterlockedExchangePointer(p, value);
+    }
+    static CORETEN_ALWAYS_INLINE bool atomicptr_cas(void* volatile* p, void* expected, void* desired) {
+        return _InterlockedCompareExchangePointer(p, desired, expected) == expected;
+    }
+#else
+    static CORETEN_ALWAYS_INLINE UInt32 atomic32_load(volatile UInt32* p) {
+        return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+    }
+    static CORETEN_ALWAYS_INLINE void atomic32_store(volatile UInt32* p, UInt32 value) {
+        __atomic_store_n(p, value, __ATOMIC_SEQ_CST);
+    }
+    static CORETEN_ALWAYS_INLINE UInt32 atomic32_fetch_add(volatile UInt32* p, UInt32 value) {
+        return __atomic_fetch_add(p, value, __ATOMIC_SEQ_CST);
+    }
+    static CORETEN_ALWAYS_INLINE bool atomic32_cas(volatile UInt32* p, UInt32 expected, UInt32 desired) {
+        return __atomic_compare_exchange_n(p, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    }
+    static CORETEN_ALWAYS_INLINE UInt64 atomic64_load(volatile UInt64* p) {
+        return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+    }
+    static CORETEN_ALWAYS_INLINE void atomic64_store(volatile UInt64* p, UInt64 value) {
+        __atomic_store_n(p, value, __ATOMIC_SEQ_CST);
+    }
+    static CORETEN_ALWAYS_INLINE UInt64 atomic64_fetch_add(volatile UInt64* p, UInt64 value) {
+        return __atomic_fetch_add(p, value, __ATOMIC_SEQ_CST);
+    }
+    static CORETEN_ALWAYS_INLINE bool atomic64_cas(volatile UInt64* p, UInt64 expected, UInt64 desired) {
+        return __atomic_compare_exchange_n(p, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    }
+    static CORETEN_ALWAYS_INLINE void* atomicptr_load(void* volatile* p) {
+        return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+    }
+    static CORETEN_ALWAYS_INLINE void atomicptr_store(void* volatile* p, void* value) {
+        __atomic_store_n(p, value, __ATOMIC_SEQ_CST);
+    }
+    static CORETEN_ALWAYS_INLINE bool atomicptr_cas(void* volatile* p, void* expected, void* desired) {
+        return __atomic_compare_exchange_n(p, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    }
+#endif // CORETEN_COMPILER_MSVC
+
+// Number of logical CPUs available (at least 1)
+UInt32 thread_num_cpus();
+
+void mutex_init(Mutex* mutex);
+void mutex_destroy(Mutex* mutex);
+void mutex_lock(Mutex* mutex);
+void mutex_unlock(Mutex* mutex);
+
+void condvar_init(CondVar* cv);
+void condvar_destroy(CondVar* cv);
+// `mutex` must be locked by the caller. Spurious wakeups are possible, so always wait in a loop.
+void condvar_wait(CondVar* cv, Mutex* mutex);
+void condvar_signal(CondVar* cv);
+void condvar_broadcast(CondVar* cv);
+
+Thread thread_create(ThreadProc proc, void* arg);
+void thread_join(Thread thread);
+
+// Create a pool of `nthreads` workers (including the calling thread). If `nthreads` is 0, `thread_num_cpus()` is used.
+ThreadPool* threadpool_new(UInt32 nthreads);
+void threadpool_free(ThreadPool* pool);
+// Number of workers (including the calling thread). `worker` indices passed to tasks are in `[0, size)`.
+UInt32 threadpool_size(ThreadPool* pool);
+// Run `task(ctx, i, worker)` for all `i` in `[0, count)` and wait for them to finish.
+// Must not be called from inside a task, or from two threads at once.
+void threadpool_parallel_for(ThreadPool* pool, UInt64 count, ThreadPoolTask task, void* ctx);
+
+#ifdef CORETEN_IMPL
+    #include <stdlib.h>
+    #include <adorad/core/debug.h>
+
+    UInt32 thread_num_cpus() {
+    #if defined(CORETEN_OS_WINDOWS)
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwNumberOfProcessors > 0 ? cast(UInt32)info.dwNumberOfProcessors : 1;
+    #elif defined(_SC_NPROCESSORS_ONLN)
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        return n > 0 ? cast(UInt32)n : 1;
+    #else
+        return 1;
+    #endif // CORETEN_OS_WINDOWS
+    }
+
+#if defined(CORETEN_OS_WINDOWS)
+    void mutex_init(Mutex* mutex)       { InitializeSRWLock(mutex); }
+    void mutex_destroy(Mutex* mutex)    { (void)mutex; }
+    void mutex_lock(Mutex* mutex)       { AcquireSRWLockExclusive(mutex); }
+    void mutex_unlock(Mutex* mutex)     { ReleaseSRWLockExclusive(mutex); }
+
+    void condvar_init(CondVar* cv)                  { InitializeConditionVariable(cv); }
+    void condvar_destroy(CondVar* cv)               { (void)cv; }
+    void condvar_wait(CondVar* cv, Mutex* mutex)    { SleepConditionVariableSRW(cv, mutex, INFINITE, 0); }
+    void condvar_signal(CondVar* cv)                { WakeConditionVariable(cv); }
+    void condvar_broadcast(CondVar* cv)             { WakeAllConditionVariable(cv); }
+
+    typedef struct {
+        ThreadProc proc;
+        void* arg;
+    } __ThreadStart;
+
+    static DWORD WINAPI __thread_trampoline(void* param) {
+        __ThreadStart start = *cast(__ThreadStart*)param;
+        free(param);
+        start.proc(start.arg);
+        return 0;
+    }
+
+    Thread thread_create(ThreadProc proc, void* arg) {
+        __ThreadStart* start = cast(__ThreadStart*)malloc(sizeof(__ThreadStart));
+        CORETEN_ENFORCE_NN(start, "Could not allocate memory. Memory full.");
+        start->proc = proc;
+        start->arg = arg;
+        Thread thread = CreateThread(null, 0, __thread_trampoline, start, 0, null);
+        CORETEN_ENFORCE_NN(thread, "Could not create a thread");
+        return thread;
+    }
+
+    void thread_join(Thread thread) {
+        WaitForSingleObject(thread, INFINITE);
+        CloseHandle(thread);
+    }
+#else
+    void mutex_init(Mutex* mutex)       { pthread_mutex_init(mutex, null); }
+    void mutex_destroy(Mutex* mutex)    { pthread_mutex_destroy(mutex); }
+    void mutex_lock(Mutex* mutex)       { pthread_mutex_lock(mutex); }
+    void mutex_unlock(Mutex* mutex)     { pthread_mutex_unlock(mutex); }
+
+    void condvar_init(CondVar* cv)                  { pthread_cond_init(cv, null); }
+    void condvar_destroy(CondVar* cv)               { pthread_cond_destroy(cv); }
+    void condvar_wait(CondVar* cv, Mutex* mutex)    { pthread_cond_wait(cv, mutex); }
+    void condvar_signal(CondVar* cv)                { pthread_cond_signal(cv); }
+    void condvar_broadcast(CondVar* cv)             { pthread_cond_broadcast(cv); }
+
+    typedef struct {
+        ThreadProc proc;
+        void* arg;
+    } __ThreadStart;
+
+    static void* __thread_trampoline(void* param) {
+        __ThreadStart start = *cast(__ThreadStart*)param;
+        free(param);
+        start.proc(start.arg);
+        return null;
+    }
+
+    Thread thread_create(ThreadProc proc, void* arg) {
+        __ThreadStart* start = cast(__ThreadStart*)malloc(sizeof(__ThreadStart));
+        CORETEN_ENFORCE_NN(start, "Could not allocate memory. Memory full.");
+        start->proc = proc;
+        start->arg = arg;
+        Thread thread;
+        int err = pthread_create(&thread, null, __thread_trampoline, start);
+        CORETEN_ENFORCE(err == 0, "Could not create a thread");
+        return thread;
+    }
+
+    void thread_join(Thread thread) {
+        pthread_join(thread, null);
+    }
+#endif // CORETEN_OS_WINDOWS
+
+    // A single `threadpool_parallel_for()` call. This lives on the caller's stack.
+    typedef struct {
+        ThreadPoolTask task;
+        void* ctx;
+        UInt64 count;
+        volatile UInt64 next;   // next index to hand out
+        UInt32 busy;            // no. of background workers inside this job (guarded by `pool->lock`)
+    } __ThreadPoolJob;
+
+    typedef struct {
+        ThreadPool* pool;
+        UInt32 worker;
+    } __ThreadPoolWorker;
+
+    struct ThreadPool {
+        UInt32 size;                    // no. of workers, including the calling thread
+        Thread* threads;                // `size - 1` background threads
+        __ThreadPoolWorker* workers;
+        Mutex lock;
+        CondVar wake;                   // a job was posted (or the pool is shutting down)
+        CondVar idle;                   // the last background worker left the current job
+        __ThreadPoolJob* job;           // current job (null if there isn't one)
+        UInt64 generation;              // bumped every time a job is posted
+        bool shutdown;
+    };
+
+    static void __threadpool_run_job(__ThreadPoolJob* job, UInt32 worker) {
+        while(true) {
+            UInt64 i = atomic64_fetch_add(&job->next, 1);
+            if(i >= job->count)
+                break;
+            job->task(job->ctx, i, worker);
+        }
+    }
+
+    static void __threadpool_worker_main(void* arg) {
+        __ThreadPoolWorker* self = cast(__ThreadPoolWorker*)arg;
+        ThreadPool* pool = self->pool;
+        UInt64 seen = 0;
+
+        mutex_lock(&pool->lock);
+        while(true) {
+            while(!pool->shutdown && (pool->job == null || pool->generation == seen))
+                condvar_wait(&pool->wake, &pool->lock);
+            if(pool->shutdown)
+                break;
+
+            // Joining under the lock guarantees the job (and the caller's stack frame) outlives us
+            __ThreadPoolJob* job = pool->job;
+            seen = pool->generation;
+            job->busy++;
+            mutex_unlock(&pool->lock);
+
+            __threadpool_run_job(job, self->worker);
+
+            mutex_lock(&pool->lock);
+            if(--job->busy == 0)
+                condvar_signal(&pool->idle);
+        }
+        mutex_unlock(&pool->lock);
+    }
+
+    ThreadPool* threadpool_new(UInt32 nthreads) {
+        if(nthreads == 0)
+            nthreads = thread_num_cpus();
+
+        ThreadPool* pool = cast(ThreadPool*)calloc(1, sizeof(ThreadPool));
+        CORETEN_ENFORCE_NN(pool, "Could not allocate memory. Memory full.");
+        pool->size = nthreads;
+        mutex_init(&pool->lock);
+        condvar_init(&pool->wake);
+        condvar_init(&pool->idle);
+
+        if(nthreads > 1) {
+            pool->threads = cast(Thread*)calloc(nthreads - 1, sizeof(Thread));
+            pool->workers = cast(__ThreadPoolWorker*)calloc(nthreads - 1, sizeof(__ThreadPoolWorker));
+            CORETEN_ENFORCE_NN(pool->threads, "Could not allocate memory. Memory full.");
+            CORETEN_ENFORCE_NN(pool->workers, "Could not allocate memory. Memory full.");
+            for(UInt32 i = 0; i < nthreads - 1; i++) {
+                pool->workers[i].pool = pool;
+                pool->workers[i].worker = i + 1;
+                pool->threads[i] = thread_create(__threadpool_worker_main, &pool->workers[i]);
+            }
+        }
+        return pool;
+    }
+
+    void threadpool_free(ThreadPool* pool) {
+        if(NONE(pool))
+            return;
+
+        mutex_lock(&pool->lock);
+        pool->shutdown = true;
+        condvar_broadcast(&pool->wake);
+        mutex_unlock(&pool->lock);
+
+        for(UInt32 i = 0; i + 1 < pool->size; i++)
+            thread_join(pool->threads[i]);
+
+        condvar_destroy(&pool->idle);
+        condvar_destroy(&pool->wake);
+        mutex_destroy(&pool->lock);
+        free(pool->threads);
+        free(pool->workers);
+        free(pool);
+    }
+
+    UInt32 threadpool_size(ThreadPool* pool) {
+        return SOME(pool) ? pool->size : 1;
+    }
+
+    void threadpool_parallel_for(ThreadPool* pool, UInt64 count, ThreadPoolTask task, void* ctx) {
+        CORETEN_ENFORCE_NN(task, "Expected not null");
+        if(count == 0)
+            return;
+
+        __ThreadPoolJob job;
+        job.task = task;
+        job.ctx = ctx;
+        job.count = count;
+        job.next = 0;
+        job.busy = 0;
+
+        // Not worth waking anyone up for
+        if(NONE(pool) || pool->size == 1 || count == 1) {
+            __threadpool_run_job(&job, 0);
+            return;
+        }
+
+        mutex_lock(&pool->lock);
+        pool->job = &job;
+        pool->generation++;
+        condvar_broadcast(&pool->wake);
+        mutex_unlock(&pool->lock);
+
+        __threadpool_run_job(&job, 0);
+
+        // Every index has been handed out; wait for the workers that are still running theirs
+        mutex_lock(&pool->lock);
+        while(job.busy > 0)
+            condvar_wait(&pool->idle, &pool->lock);
+        pool->job = null;
+        mutex_unlock(&pool->lock);
+    }
+#endif // CORETEN_IMPL
+
+#endif // CORETEN_THREAD_H
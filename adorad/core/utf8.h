@@ -45,34 +45,71 @@ Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
         4. https://github.com/lemire/fastvalidate-utf-8
 */
 
+#include <adorad/core/cpu.h>
+#include <adorad/core/debug.h>
 #include <adorad/core/types.h>
+#include <adorad/core/misc.h>
+#include <adorad/core/strops.h>
 
 #define uBuff  cstlUTF8Str
 typedef struct cstlUTF8Str {
-    Byte* data;    // actual UTF8 data
-    UInt64 len;    // no. of UTF8 characters
-    UInt64 nbytes; // no. of bytes used by the string
+    Byte* data;         // actual UTF8 data (always null-terminated)
+    UInt64 len;         // no. of UTF8 characters
+    UInt64 nbytes;      // no. of bytes used by the string
+    UInt64 capacity;    // no. of bytes allocated for `data` (excluding the null terminator)
+    UInt64* index;      // `index[k]` is the byte offset of character `k * UTF8_INDEX_STRIDE`
+    UInt64 index_cap;   // no. of entries allocated for `index`
 } cstlUTF8Str;
 
+// Distance (in characters) between two entries of a cstlUTF8Str's sparse index.
+// `ubuff_at()` never walks more than this many characters.
+#define UTF8_INDEX_STRIDE_SHIFT     6
+#define UTF8_INDEX_STRIDE           (1 << UTF8_INDEX_STRIDE_SHIFT)
+#define uBUFF_NEW(ubuff_data)       ubuff_new(ubuff_data)
+
 // Is UTF-8 codepoint valid?
 bool utf8_is_codepoint_valid(Rune uc);
 char* utf8_encode(Rune value);
 Ll utf8_encode_nbytes(Rune value);
 Ll utf8_decode_nbytes(Rune byte);
 
+// Is `data` (`nbytes` long) entirely valid UTF-8? 
+// This is vectorized and meant to be run once over a whole buffer (eg: a source file, as soon as it's loaded).
+bool utf8_validate(const char* data, UInt64 nbytes);
+// Returns the byte offset of the first invalid UTF-8 sequence in `data`, or `nbytes` if there isn't one.
+UInt64 utf8_invalid_offset(const char* data, UInt64 nbytes);
+// Decode the codepoint at `str` and store the number of bytes it occupies in `nbytes`.
+// `str` must already be valid UTF-8 (see `utf8_validate()`), so no error checks are made here.
+Rune utf8_decode(const char* str, UInt32* nbytes);
+// Unicode identifier properties (UAX #31). ASCII is answered inline; everything else by a two-stage bitset lookup.
+// Note: `_` is XID_Continue, but not XID_Start.
+bool utf8_is_xid_start(Rune r);
+bool utf8_is_xid_continue(Rune r);
+
 /*
     WIP
 */
-cstlUTF8Str* uBUFF_NEW(Rune* data);
-cstlUTF8Str* ubuff_set(cstlUTF8Str* ubuff, Rune* data);
-void __grow_ubuff(cstlUTF8Str* ubuff, int grow_by);
+// Create a new UTF8 string from the (null-terminated) `data`, which may be null.
+cstlUTF8Str* ubuff_new(const char* data);
+// Replace the contents of `ubuff` with `data`, keeping its allocations.
+void ubuff_set(cstlUTF8Str* ubuff, const char* data);
+void ubuff_free(cstlUTF8Str* ubuff);
+// Make room for at least `nbytes` more bytes. Capacity grows geometrically, so appends are amortized O(1).
+void __grow_ubuff(cstlUTF8Str* ubuff, UInt64 nbytes);
 void __push_byte(cstlUTF8Str* ubuff, Byte byte);
 void __push_ascii_char(cstlUTF8Str* ubuff, Byte byte);
+// Append the codepoint `ch` (encoded as UTF-8).
 void ubuff_push_char(cstlUTF8Str* ubuff, Rune ch);
+// Append `nbytes` bytes of `data`. The bytes are validated (see `utf8_validate()`) before anything is copied.
+void ubuff_append(cstlUTF8Str* ubuff, const char* data, UInt64 nbytes);
+// Same as `ubuff_append()`, but `data` must already be known to be valid UTF-8.
+void ubuff_append_valid(cstlUTF8Str* ubuff, const char* data, UInt64 nbytes);
 UInt64 ubuff_len(cstlUTF8Str* ubuff);
 UInt64 ubuff_nbytes(cstlUTF8Str* ubuff);
-Byte ubuff_byte_offset_at(cstlUTF8Str* ubuff, Int64 n);
-Byte ubuff_at(cstlUTF8Str* ubuff, Int64 n);
+// Returns the byte offset of the `n`th character
+UInt64 ubuff_byte_offset(cstlUTF8Str* ubuff, UInt64 n);
+// Returns the `n`th character
+Rune ubuff_at(cstlUTF8Str* ubuff, UInt64 n);
 
 // Unicode categories
 typedef enum {
@@ -274,6 +311,7 @@ typedef enum {
     #endif // UTF8_UINT16_MAX
 
     #include <adorad/core/utf8_data.h>
+    #include <adorad/core/utf8_xid.h>
     // #include <adorad/core/utf8_properties.h>
 
     const Rune codepoint_decoded_length[256] = {
@@ -424,89 +462,422 @@ typedef enum {
         return dst;
     }
 
+    // Returns the byte offset of the first invalid UTF-8 sequence in `data` (using the grammar at the top of this file).
+    // ASCII is skipped 8 bytes at a time.
+    UInt64 utf8_invalid_offset(const char* data, UInt64 nbytes) {
+        const Byte* str = cast(const Byte*)data;
+        UInt64 i = 0;
+        while(i < nbytes) {
+            if(i + 8 <= nbytes) {
+                UInt64 word;
+                memcpy(&word, str + i, sizeof(word));
+                if((word & 0x8080808080808080ULL) == 0) {
+                    i += 8;
+                    continue;
+                }
+            }
+
+            Byte c = str[i];
+            if(c < 0x80) {
+                i++;
+                continue;
+            }
+
+            UInt64 n = 0;
+            Byte lo = 0x80, hi = 0xbf;  // allowed range for the 2nd byte
+            if(c >= 0xc2 && c <= 0xdf)      { n = 2; }
+            else if(c == 0xe0)              { n = 3; lo = 0xa0; }
+            else if(c >= 0xe1 && c <= 0xec) { n = 3; }
+            else if(c == 0xed)              { n = 3; hi = 0x9f; }  // no surrogates
+            else if(c >= 0xee && c <= 0xef) { n = 3; }
+            else if(c == 0xf0)              { n = 4; lo = 0x90; }
+            else if(c >= 0xf1 && c <= 0xf3) { n = 4; }
+            else if(c == 0xf4)              { n = 4; hi = 0x8f; }  // nothing above U+10FFFF
+            else
+                return i;
+
+            if(i + n > nbytes || str[i + 1] < lo || str[i + 1] > hi)
+                return i;
+            for(UInt64 k = 2; k < n; k++) {
+                if((str[i + k] & 0xc0) != 0x80)
+                    return i;
+            }
+            i += n;
+        }
+        return nbytes;
+    }
+
+    #if defined(CORETEN_SIMD_X86_DISPATCH) && defined(CORETEN_SIMD_SSE2)
+    #include <immintrin.h>
+
+    /*
+        Vectorized UTF-8 validation (AVX2).
+
+        This is the "lookup" algorithm by Keiser & Lemire (Validating UTF-8 In Less Than One Instruction Per Byte,
+        2021 - also used by simdjson/simdutf). Every error in UTF-8 can be detected by looking at the high nibble of
+        the previous byte, the low nibble of the previous byte and the high nibble of the current byte. Each of these
+        nibbles indexes a 16-entry table (one `vpshufb` each) whose bits flag the errors that are possible given that
+        nibble. AND-ing the three lookups leaves a bit set only where an error actually occurs.
+        3- and 4-byte sequences additionally need the 2nd/3rd previous bytes to check that the right number of
+        continuation bytes follow a lead byte.
+    */
+    #define __UTF8_TOO_SHORT      (1 << 0)  // 11______ 0_______  or  11______ 11______
+    #define __UTF8_TOO_LONG       (1 << 1)  // 0_______ 10______
+    #define __UTF8_OVERLONG_3     (1 << 2)  // 11100000 100_____
+    #define __UTF8_TOO_LARGE      (1 << 3)  // 11110100 1001____  and above
+    #define __UTF8_SURROGATE      (1 << 4)  // 11101101 101_____
+    #define __UTF8_OVERLONG_2     (1 << 5)  // 1100000_ 10______
+    #define __UTF8_TOO_LARGE_1000 (1 << 6)  // 11110101 1000____  and above
+    #define __UTF8_OVERLONG_4     (1 << 6)  // 11110000 1000____
+    #define __UTF8_TWO_CONTS      (1 << 7)  // 10______ 10______
+    #define __UTF8_CARRY          (__UTF8_TOO_SHORT | __UTF8_TOO_LONG | __UTF8_TWO_CONTS)
+
+    // The 16 bytes of `input` ending `n` bytes before the end of each lane, shifted in from `prev`
+    #define __UTF8_PREV(input, prev, n) \
+        _mm256_alignr_epi8((input), _mm256_permute2x128_si256((prev), (input), 0x21), 16 - (n))
+
+    CORETEN_TARGET("avx2")
+    static CORETEN_ALWAYS_INLINE __m256i __utf8_lookup16(__m256i nibbles, const Byte table[16]) {
+        __m128i t = _mm_loadu_si128(cast(const __m128i*)table);
+        return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(t), nibbles);
+    }
+
+    CORETEN_TARGET("avx2")
+    static CORETEN_ALWAYS_INLINE __m256i __utf8_check_block(__m256i input, __m256i prev_input) {
+        static const Byte byte_1_high[16] = {
+            // 0_______ (ASCII)
+            __UTF8_TOO_LONG, __UTF8_TOO_LONG, __UTF8_TOO_LONG, __UTF8_TOO_LONG,
+            __UTF8_TOO_LONG, __UTF8_TOO_LONG, __UTF8_TOO_LONG, __UTF8_TOO_LONG,
+            // 10______ (continuation)
+            __UTF8_TWO_CONTS, __UTF8_TWO_CONTS, __UTF8_TWO_CONTS, __UTF8_TWO_CONTS,
+            // 1100____, 1101____ (2-byte lead)
+            __UTF8_TOO_SHORT | __UTF8_OVERLONG_2,
+            __UTF8_TOO_SHORT,
+            // 1110____ (3-byte lead)
+            __UTF8_TOO_SHORT | __UTF8_OVERLONG_3 | __UTF8_SURROGATE,
+            // 1111____ (4-byte lead)
+            __UTF8_TOO_SHORT | __UTF8_TOO_LARGE | __UTF8_TOO_LARGE_1000 | __UTF8_OVERLONG_4
+        };
+        static const Byte byte_1_low[16] = {
+            __UTF8_CARRY | __UTF8_OVERLONG_3 | __UTF8_OVERLONG_2 | __UTF8_OVERLONG_4,  // ____0000
+            __UTF8_CARRY | __UTF8_OVERLONG_2,                                        // ____0001
+            __UTF8_CARRY,                                                            // ____0010
+            __UTF8_CARRY,                                                            // ____0011
+            __UTF8_CARRY | __UTF8_TOO_LARGE,                                         // ____0100
+            __UTF8_CARRY | __UTF8_TOO_LARGE | __UTF8_TOO_LARGE_1000,                 // ____0101
+            __UTF8_CARRY | __UTF8_TOO_LARGE | __UTF8_TOO_LARGE_1000,
+            __UTF8_CARRY | __UTF8_TOO_LARGE | __UTF8_TOO_LARGE_1000,
+            __UTF8_CARRY | __UTF8_TOO_LARGE | __UTF8_TOO_LARGE_1000,
+            __UTF8_CARRY | __UTF8_TOO_LARGE | __UTF8_TOO_LARGE_1000,
+            __UTF8_CARRY | __UTF8_TOO_LARGE | __UTF8_TOO_LARGE_1000,
+            __UTF8_CARRY | __UTF8_TOO_LARGE | __UTF8_TOO_LARGE_1000,
+            __UTF8_CARRY | __UTF8_TOO_LARGE | __UTF8_TOO_LARGE_1000,
+            __UTF8_CARRY | __UTF8_TOO_LARGE | __UTF8_TOO_LARGE_1000 | __UTF8_SURROGATE,  // ____1101
+            __UTF8_CARRY | __UTF8_TOO_LARGE | __UTF8_TOO_LARGE_1000,
+            __UTF8_CARRY | __UTF8_TOO_LARGE | __UTF8_TOO_LARGE_1000
+        };
+        static const Byte byte_2_high[16] = {
+            // ________ 0_______ (ASCII)
+            __UTF8_TOO_SHORT, __UTF8_TOO_SHORT, __UTF8_TOO_SHORT, __UTF8_TOO_SHORT,
+            __UTF8_TOO_SHORT, __UTF8_TOO_SHORT, __UTF8_TOO_SHORT, __UTF8_TOO_SHORT,
+            // ________ 1000____
+            __UTF8_TOO_LONG | __UTF8_OVERLONG_2 | __UTF8_TWO_CONTS | __UTF8_OVERLONG_3 | __UTF8_TOO_LARGE_1000 |
+                __UTF8_OVERLONG_4,
+            // ________ 1001____
+            __UTF8_TOO_LONG | __UTF8_OVERLONG_2 | __UTF8_TWO_CONTS | __UTF8_OVERLONG_3 | __UTF8_TOO_LARGE,
+            // ________ 101_____
+            __UTF8_TOO_LONG | __UTF8_OVERLONG_2 | __UTF8_TWO_CONTS | __UTF8_SURROGATE | __UTF8_TOO_LARGE,
+            __UTF8_TOO_LONG | __UTF8_OVERLONG_2 | __UTF8_TWO_CONTS | __UTF8_SURROGATE | __UTF8_TOO_LARGE,
+            // ________ 11______ (lead byte)
+            __UTF8_TOO_SHORT, __UTF8_TOO_SHORT, __UTF8_TOO_SHORT, __UTF8_TOO_SHORT
+        };
+
+        __m256i low_nibble = _mm256_set1_epi8(0x0f);
+        __m256i prev1 = __UTF8_PREV(input, prev_input, 1);
+        __m256i special_cases = _mm256_and_si256(
+            _mm256_and_si256(
+                __utf8_lookup16(_mm256_and_si256(_mm256_srli_epi16(prev1, 4), low_nibble), byte_1_high),
+                __utf8_lookup16(_mm256_and_si256(prev1, low_nibble), byte_1_low)),
+            __utf8_lookup16(_mm256_and_si256(_mm256_srli_epi16(input, 4), low_nibble), byte_2_high));
+
+        // A continuation byte is required 2 bytes after a 3/4-byte lead, and 3 bytes after a 4-byte lead.
+        // Those positions were flagged TWO_CONTS above (10______ 10______), so the two must line up exactly.
+        __m256i prev2 = __UTF8_PREV(input, prev_input, 2);
+        __m256i prev3 = __UTF8_PREV(input, prev_input, 3);
+        __m256i is_third_byte  = _mm256_subs_epu8(prev2, _mm256_set1_epi8(cast(char)(0xe0 - 0x80)));
+        __m256i is_fourth_byte = _mm256_subs_epu8(prev3, _mm256_set1_epi8(cast(char)(0xf0 - 0x80)));
+        __m256i must_be_cont = _mm256_and_si256(_mm256_or_si256(is_third_byte, is_fourth_byte),
+                                                _mm256_set1_epi8(cast(char)0x80));
+        return _mm256_xor_si256(must_be_cont, special_cases);
+    }
+
+    // Non-zero where the block ends in the middle of a multi-byte sequence
+    CORETEN_TARGET("avx2")
+    static CORETEN_ALWAYS_INLINE __m256i __utf8_is_incomplete(__m256i input) {
+        __m256i max_value = _mm256_setr_epi8(
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            cast(char)(0xf0 - 1), cast(char)(0xe0 - 1), cast(char)(0xc0 - 1));
+        return _mm256_subs_epu8(input, max_value);
+    }
+
+    CORETEN_TARGET("avx2")
+    static bool __utf8_validate_avx2(const char* data, UInt64 nbytes) {
+        __m256i error = _mm256_setzero_si256();
+        __m256i prev_input = _mm256_setzero_si256();
+        __m256i prev_incomplete = _mm256_setzero_si256();
+        UInt64 i = 0;
+
+        for(; i + 32 <= nbytes; i += 32) {
+            __m256i input = _mm256_loadu_si256(cast(const __m256i*)(data + i));
+            // Fast path: a block of pure ASCII is only an error if the previous block was cut short
+            if(_mm256_movemask_epi8(input) == 0) {
+                error = _mm256_or_si256(error, prev_incomplete);
+            } else {
+                error = _mm256_or_si256(error, __utf8_check_block(input, prev_input));
+                prev_incomplete = __utf8_is_incomplete(input);
+            }
+            prev_input = input;
+
+            // Bail out early every 1KB, so an invalid file doesn't get scanned to the end
+            if(CORETEN_UNLIKELY((i & 1023) == 0 && !_mm256_testz_si256(error, error)))
+                return false;
+        }
+
+        if(i < nbytes) {
+            // Pad the tail with zeroes (ASCII), which can't introduce new errors
+            Byte tail[32] = {0};
+            memcpy(tail, data + i, nbytes - i);
+            __m256i input = _mm256_loadu_si256(cast(const __m256i*)tail);
+            error = _mm256_or_si256(error, __utf8_check_block(input, prev_input));
+            prev_incomplete = __utf8_is_incomplete(input);
+        }
+        error = _mm256_or_si256(error, prev_incomplete);
+        return _mm256_testz_si256(error, error) != 0;
+    }
+    #endif // CORETEN_SIMD_X86_DISPATCH
+
+    bool utf8_validate(const char* data, UInt64 nbytes) {
+        CORETEN_ENFORCE(data != null || nbytes == 0, "Expected not null");
+    #if defined(CORETEN_SIMD_X86_DISPATCH) && defined(CORETEN_SIMD_SSE2)
+        if(cpu_has_feature(CpuFeatureAVX2))
+            return __utf8_validate_avx2(data, nbytes);
+    #endif // CORETEN_SIMD_X86_DISPATCH
+        return utf8_invalid_offset(data, nbytes) == nbytes;
+    }
+
+    Rune utf8_decode(const char* str, UInt32* nbytes) {
+        const Byte* s = cast(const Byte*)str;
+        Byte c = s[0];
+        if(CORETEN_LIKELY(c < 0x80)) {
+            *nbytes = 1;
+            return c;
+        }
+        if(c < 0xe0) {
+            *nbytes = 2;
+            return (cast(Rune)(c & 0x1f) << 6) | (s[1] & 0x3f);
+        }
+        if(c < 0xf0) {
+            *nbytes = 3;
+            return (cast(Rune)(c & 0x0f) << 12) | (cast(Rune)(s[1] & 0x3f) << 6) | (s[2] & 0x3f);
+        }
+        *nbytes = 4;
+        return (cast(Rune)(c & 0x07) << 18) | (cast(Rune)(s[1] & 0x3f) << 12) | (cast(Rune)(s[2] & 0x3f) << 6) |
+               (s[3] & 0x3f);
+    }
+
+    // `prop` is 0 for XID_Start, 1 for XID_Continue
+    static inline bool __utf8_xid_lookup(Rune r, UInt32 prop) {
+        const UInt64* block = utf8_xid_stage2[utf8_xid_stage1[r >> 7]];
+        return cast(bool)((block[prop * 2 + ((r >> 6) & 1)] >> (r & 63)) & 1);
+    }
+
+    bool utf8_is_xid_start(Rune r) {
+        if(CORETEN_LIKELY(r < 0x80))
+            return cast(bool)((r | 0x20) - 'a' < 26);
+        if(r >= UTF8_XID_STAGE1_LIMIT)
+            return false;
+        return __utf8_xid_lookup(r, 0);
+    }
+
+    bool utf8_is_xid_continue(Rune r) {
+        if(CORETEN_LIKELY(r < 0x80))
+            return cast(bool)((r | 0x20) - 'a' < 26 || r - '0' < 10 || r == '_');
+        if(r >= UTF8_XID_STAGE1_LIMIT)
+            return r >= UTF8_XID_CONTINUE_HIGH_LO && r <= UTF8_XID_CONTINUE_HIGH_HI;
+        return __utf8_xid_lookup(r, 1);
+    }
+
     /*
         WIP
     */
 
-    cstlUTF8Str* uBUFF_NEW(Rune* data) {
-        cstlUTF8Str* ubuff = cast(cstlUTF8Str*)calloc(1, sizeof(ubuff));
+    cstlUTF8Str* ubuff_new(const char* data) {
+        cstlUTF8Str* ubuff = cast(cstlUTF8Str*)calloc(1, sizeof(cstlUTF8Str));
         CORETEN_ENFORCE_NN(ubuff, "Could not allocate memory. Memory full.");
 
-        // ubuff_set(ubuff, data);
+        // `data` is null-terminated even if the string is empty
+        __grow_ubuff(ubuff, 0);
+        ubuff_set(ubuff, data);
         return ubuff;
     }
 
-    void __grow_ubuff(cstlUTF8Str* ubuff, int grow_by) {
+    void ubuff_set(cstlUTF8Str* ubuff, const char* data) {
         CORETEN_ENFORCE_NN(ubuff, "Expected not null");
-        CORETEN_ENFORCE(grow_by > 0);
+        ubuff->len = 0;
+        ubuff->nbytes = 0;
+        if(ubuff->data)
+            ubuff->data[0] = nullchar;
+        if(data)
+            ubuff_append(ubuff, data, str_len(data));
+    }
 
-        ubuff->data = cast(Byte*)realloc(ubuff->data, grow_by);
-        memset(ubuff->data + ubuff->nbytes, 0, grow_by);
-        ubuff->nbytes += grow_by;
+    void ubuff_free(cstlUTF8Str* ubuff) {
+        if(ubuff) {
+            free(ubuff->data);
+            free(ubuff->index);
+            free(ubuff);
+        }
     }
 
-    void ubuff_push_char(cstlUTF8Str* ubuff, Rune ch) {
-        CORETEN_ENFORCE(ubuff->data[ubuff->len] == 0); // ensure this is writeable (we shouldn't overwrite over a char)
+    void __grow_ubuff(cstlUTF8Str* ubuff, UInt64 nbytes) {
+        CORETEN_ENFORCE_NN(ubuff, "Expected not null");
+        if(CORETEN_LIKELY(ubuff->nbytes + nbytes <= ubuff->capacity && ubuff->data))
+            return;
+
+        UInt64 capacity = ubuff->capacity < 16 ? 16 : ubuff->capacity * 2;
+        while(capacity < ubuff->nbytes + nbytes)
+            capacity *= 2;
+
+        // +1 for the null terminator
+        Byte* data = cast(Byte*)realloc(ubuff->data, capacity + 1);
+        CORETEN_ENFORCE_NN(data, "Could not allocate memory. Memory full.");
+        data[ubuff->nbytes] = nullchar;
+        ubuff->data = data;
+        ubuff->capacity = capacity;
+    }
 
-        // 0b0xxxxxxx
+    // Records `offset` as the start of the character about to be appended, if it falls on an index entry
+    static inline void __ubuff_index_char(cstlUTF8Str* ubuff, UInt64 offset) {
+        if(CORETEN_LIKELY(ubuff->len & (UTF8_INDEX_STRIDE - 1)))
+            return;
+
+        UInt64 k = ubuff->len >> UTF8_INDEX_STRIDE_SHIFT;
+        if(k >= ubuff->index_cap) {
+            UInt64 index_cap = ubuff->index_cap < 8 ? 8 : ubuff->index_cap * 2;
+            UInt64* index = cast(UInt64*)realloc(ubuff->index, index_cap * sizeof(UInt64));
+            CORETEN_ENFORCE_NN(index, "Could not allocate memory. Memory full.");
+            ubuff->index = index;
+            ubuff->index_cap = index_cap;
+        }
+        ubuff->index[k] = offset;
+    }
+
+    void ubuff_push_char(cstlUTF8Str* ubuff, Rune ch) {
+        CORETEN_ENFORCE_NN(ubuff, "Expected not null");
         if(ch <= 0x7f) {
-            __push_ascii_char(ubuff, ch);
+            __push_ascii_char(ubuff, cast(Byte)ch);
+            return;
+        }
+
+        if(!utf8_is_codepoint_valid(ch)) {
+            // TODO (jasmcaus): `dread()` here
+            fprintf(stderr, "Invalid UTF-8 character: %x", ch);
+            exit(1);
         }
+
+        __grow_ubuff(ubuff, 4);
+        __ubuff_index_char(ubuff, ubuff->nbytes);
+        Byte* dst = ubuff->data + ubuff->nbytes;
         // 110xxxxx 10xxxxxx
-        else if(ch >= 0xC080 && ch <= 0xDFBF) {
-            // 2-byte character
-            __grow_ubuff(ubuff, 2);
-            UInt64 nbytes = ubuff->nbytes;
-            ubuff->data[nbytes    ] = cast(Byte)(ch >> 8);
-            ubuff->data[nbytes + 1] = cast(Byte)(ch);
-            ubuff->data[nbytes + 2] = 0;
+        if(ch <= 0x7ff) {
+            dst[0] = cast(Byte)(0xc0 | (ch >> 6));
+            dst[1] = cast(Byte)(0x80 | (ch & 0x3f));
             ubuff->nbytes += 2;
-            ubuff->len += 1;
         }
         // 1110xxxx 10xxxxxx 10xxxxxx
-        else if(ch >= 0xE08080 && ch <= 0xEFBFBF) {
-            // 3-byte character
-            __grow_ubuff(ubuff, 3);
-            UInt64 nbytes = ubuff->nbytes;
-            ubuff->data[nbytes    ] = cast(Byte)(ch >> 16);
-            ubuff->data[nbytes + 1] = cast(Byte)(ch >> 8);
-            ubuff->data[nbytes + 2] = cast(Byte)(ch);
-            ubuff->data[nbytes + 3] = 0;
+        else if(ch <= 0xffff) {
+            dst[0] = cast(Byte)(0xe0 | (ch >> 12));
+            dst[1] = cast(Byte)(0x80 | ((ch >> 6) & 0x3f));
+            dst[2] = cast(Byte)(0x80 | (ch & 0x3f));
             ubuff->nbytes += 3;
-            ubuff->len += 1;
         }
         // 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx
-        else if(ch >= 0xF0808080 && ch <= 0xF7BFBFBF) {
-            // 3-byte character
-            __grow_ubuff(ubuff, 3);
-            UInt64 nbytes = ubuff->nbytes;
-            ubuff->data[nbytes    ] = cast(Byte)(ch >> 24);
-            ubuff->data[nbytes + 1] = cast(Byte)(ch >> 16);
-            ubuff->data[nbytes + 2] = cast(Byte)(ch >> 8);
-            ubuff->data[nbytes + 3] = cast(Byte)(ch);
-            ubuff->data[nbytes + 4] = 0;
-            ubuff->nbytes += 4;
-            ubuff->len += 1;
-        }
         else {
-            // TODO (jasmcaus): `dread()` here
-            fprintf(stderr, "Invalid UTF-8 character: %x", ch);
-            exit(1);
+            dst[0] = cast(Byte)(0xf0 | (ch >> 18));
+            dst[1] = cast(Byte)(0x80 | ((ch >> 12) & 0x3f));
+            dst[2] = cast(Byte)(0x80 | ((ch >> 6) & 0x3f));
+            dst[3] = cast(Byte)(0x80 | (ch & 0x3f));
+            ubuff->nbytes += 4;
         }
+        ubuff->data[ubuff->nbytes] = nullchar;
+        ubuff->len += 1;
     }
 
     void __push_byte(cstlUTF8Str* ubuff, Byte byte) {
         CORETEN_ENFORCE(byte <= 0x7F);
         __grow_ubuff(ubuff, 1);
         ubuff->data[ubuff->nbytes++] = byte;
-        ubuff->data[ubuff->nbytes] = 0;
+        ubuff->data[ubuff->nbytes] = nullchar;
     }
 
     void __push_ascii_char(cstlUTF8Str* ubuff, Byte byte) {
+        __ubuff_index_char(ubuff, ubuff->nbytes);
         __push_byte(ubuff, byte);
         ubuff->len += 1;
     }
 
+    void ubuff_append(cstlUTF8Str* ubuff, const char* data, UInt64 nbytes) {
+        CORETEN_ENFORCE(data != null || nbytes == 0, "Expected not null");
+        if(!utf8_validate(data, nbytes)) {
+            // TODO (jasmcaus): `dread()` here
+            fprintf(stderr, "Invalid UTF-8 byte at offset %" CORETEN_PRIu64, utf8_invalid_offset(data, nbytes));
+            exit(1);
+        }
+        ubuff_append_valid(ubuff, data, nbytes);
+    }
+
+    void ubuff_append_valid(cstlUTF8Str* ubuff, const char* data, UInt64 nbytes) {
+        CORETEN_ENFORCE_NN(ubuff, "Expected not null");
+        if(nbytes == 0)
+            return;
+
+        __grow_ubuff(ubuff, nbytes);
+        UInt64 start = ubuff->nbytes;
+        memcpy(ubuff->data + start, data, nbytes);
+        ubuff->data[start + nbytes] = nullchar;
+        ubuff->nbytes += nbytes;
+
+        // Count the new characters (= bytes that aren't 10xxxxxx), 8 bytes at a time.
+        // Words are only walked byte by byte when they contain a character that needs an index entry.
+        const Byte* str = ubuff->data + start;
+        UInt64 i = 0;
+        while(i + 8 <= nbytes) {
+            UInt64 word;
+            memcpy(&word, str + i, sizeof(word));
+            UInt64 cont = word & ~(word << 1) & 0x8080808080808080ULL;
+            UInt64 nchars = 8 - (((cont >> 7) * 0x0101010101010101ULL) >> 56);
+            UInt64 pos = ubuff->len & (UTF8_INDEX_STRIDE - 1);
+            if(CORETEN_LIKELY(pos != 0 && pos + nchars <= UTF8_INDEX_STRIDE)) {
+                ubuff->len += nchars;
+            } else {
+                for(UInt64 j = i; j < i + 8; j++) {
+                    if((str[j] & 0xc0) != 0x80) {
+                        __ubuff_index_char(ubuff, start + j);
+                        ubuff->len += 1;
+                    }
+                }
+            }
+            i += 8;
+        }
+        for(; i < nbytes; i++) {
+            if((str[i] & 0xc0) != 0x80) {
+                __ubuff_index_char(ubuff, start + i);
+                ubuff->len += 1;
+            }
+        }
+    }
+
     // Returns the number of UTF8 characters in the buffer
     UInt64 ubuff_len(cstlUTF8Str* ubuff) {
         return ubuff->len;
@@ -517,82 +888,22 @@ typedef enum {
         return ubuff->nbytes;
     }
 
-    /*
-    #define WRITE_OUT(val)	if(out)	*out = (val)
-    // Return the byte at the `n`th byte offset
-    // If `out` is null, we don't intend on knowing how many bytes the UTF8 character uses.
-    static int __byte_offset_at(cstlUTF8Str* ubuff, Int64 n, int* out) {
+    // Jump to the closest index entry at or before `n`, then walk forward (at most `UTF8_INDEX_STRIDE - 1` characters)
+    UInt64 ubuff_byte_offset(cstlUTF8Str* ubuff, UInt64 n) {
         CORETEN_ENFORCE_NN(ubuff, "Expected not null");
-        CORETEN_ENFORCE_NN(ubuff->data, "Expected not null");
-        // Fail-fast approach. If this changes, comment this, && uncomment the following (commented) snippet
-        CORETEN_ENFORCE(n < ubuff->nbytes);
-        CORETEN_ENFORCE(n > 0);
-        // if((n >= ubuff->nbytes) || (n < 0)) {
-        // 	return nullchar;
-        // }
-
-        Byte byte = cast(Byte)(ubuff->data[n]);
-        if(byte == 0) {
-            return cast(Byte)0;
-        } 
-        // 1-byte UTF8
-        else if(byte <= 0x07F) {
-            WRITE_OUT(1);
-            return byte;
-        } 
-        // 2-byte UF8
-        else if(byte >= 0x80 && byte <= 0x07FF) {
-            WRITE_OUT(2);
-            byte = (byte << 8) + cast(Byte)(ubuff->data[n + 1]);
-            return byte;
-        } 
-        // 3-byte UTF8
-        else if(byte >= 0x0800 && byte <= 0xFFFF) {
-            WRITE_OUT(3);
-            byte = byte << 16;
-            byte = (byte) | (cast(Byte)(ubuff->data[n + 1]) << 8);
-            byte = (byte) | (cast(Byte)(ubuff->data[n + 2]) << 16);
-            return byte;
-        }
-        // 4-byte UTF8
-        else if(byte >= 0x00010000 && byte <= 0x0010FFFF) {
-            WRITE_OUT(4);
-            byte = byte << 24;
-            byte = (byte) | (cast(Byte)(ubuff->data[n + 1]) << 16);
-            byte = (byte) | (cast(Byte)(ubuff->data[n + 2]) << 8);
-            byte = (byte) | (cast(Byte)(ubuff->data[n + 3]));
-            return byte;
-        } else {
-            // TODO (jasmcaus): `dread()` here
-            fprintf(stderr, "Cannot decode UTF8 byte `%hx` at byte offset %d", byte, n);
-            exit(1);
-        }
-    }
+        CORETEN_ENFORCE(n < ubuff->len);
 
-    // Return the byte at the `n`th byte offset
-    Byte ubuff_byte_offset_at(cstlUTF8Str* ubuff, Int64 n) {
-        return __byte_offset_at(ubuff, n, null);
+        UInt64 offset = ubuff->index[n >> UTF8_INDEX_STRIDE_SHIFT];
+        for(UInt64 k = n & (UTF8_INDEX_STRIDE - 1); k > 0; k--)
+            offset += cast(UInt64)codepoint_decoded_length[ubuff->data[offset]];
+        return offset;
     }
 
-
-    // Returns the byte at `n`th character offset
-    Byte ubuff_at(cstlUTF8Str* ubuff, Int64 n) {
-        CORETEN_ENFORCE_NN(ubuff, "Expected not null");
-        CORETEN_ENFORCE_NN(ubuff->data, "Expected not null");
-        CORETEN_ENFORCE(n < ubuff->len);
-        CORETEN_ENFORCE(n > 0);
-        int a[1];
-
-        UInt64 byte_offset = 0;
-        while(n != 0) {
-            Byte b = __byte_offset_at(ubuff, byte_offset, a); // we only care about `a`
-            byte_offset += cast(UInt64)a;
-            --n;
-        }
-        return ubuff_byte_offset_at(ubuff, byte_offset);
+    Rune ubuff_at(cstlUTF8Str* ubuff, UInt64 n) {
+        UInt32 nbytes;
+        return utf8_decode(cast(const char*)ubuff->data + ubuff_byte_offset(ubuff, n), &nbytes);
     }
-    */
-   
+
 #endif // CORETEN_IMPL
 
 
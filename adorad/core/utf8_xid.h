@@ -0,0 +1,290 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+// Auto-generated by tools/scripts/generate_xid_tables.py from Unicode 14.0.0. DO NOT EDIT.
+
+#ifndef CORETEN_UTF8_XID_H
+#define CORETEN_UTF8_XID_H
+
+// Codepoints at or above this have neither property (except for the range below)
+#define UTF8_XID_STAGE1_LIMIT       0x31380
+// XID_Continue-only range above UTF8_XID_STAGE1_LIMIT (variation selectors)
+#define UTF8_XID_CONTINUE_HIGH_LO   0xE0100
+#define UTF8_XID_CONTINUE_HIGH_HI   0xE01EF
+
+// 1575 bytes: index of the 128-codepoint block in `utf8_xid_stage2`
+static const UInt8 utf8_xid_stage1[1575] = {
+    0, 1, 2, 2, 2, 3, 4, 5, 2, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20,
+    21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 2, 2, 31, 32, 33, 34, 35, 2, 2, 2, 36, 37, 38, 39,
+    40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 2, 50, 2, 2, 51, 52, 53, 54, 55, 56, 57, 57, 57, 57,
+    57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 2, 58, 59, 60, 57, 57, 57, 57,
+    61, 62, 63, 64, 57, 57, 57, 57, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 65, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 66, 2, 2, 67, 68, 69, 70,
+    71, 72, 73, 74, 75, 76, 77, 78, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 79,
+    57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57,
+    57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57,
+    57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 2, 2, 80, 81, 82, 83,
+    84, 2, 85, 86, 87, 88, 89, 90, 91, 92, 93, 94, 57, 95, 96, 97, 2, 98, 99, 100, 2, 2, 101, 102,
+    103, 104, 105, 106, 107, 108, 109, 110, 111, 112, 113, 57, 57, 114, 115, 116, 117, 118, 119, 120, 121, 122, 123, 57,
+    124, 125, 57, 126, 127, 128, 129, 57, 130, 131, 132, 133, 134, 135, 57, 57, 136, 137, 138, 139, 57, 140, 57, 141,
+    2, 2, 2, 2, 2, 2, 2, 142, 143, 2, 144, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57,
+    57, 57, 57, 57, 57, 57, 57, 145, 2, 2, 2, 2, 2, 2, 2, 2, 146, 57, 57, 57, 57, 57, 57, 57,
+    57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57,
+    2, 2, 2, 2, 147, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57,
+    57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57,
+    57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57,
+    2, 2, 2, 2, 148, 149, 150, 151, 57, 57, 57, 57, 152, 57, 153, 154, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 155, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 156, 56, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57,
+    57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57,
+    57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 157,
+    2, 2, 158, 2, 2, 159, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57,
+    160, 161, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57,
+    57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 162, 57, 57, 57, 163, 164, 165, 57, 57, 57,
+    166, 167, 168, 2, 2, 169, 170, 171, 57, 57, 57, 57, 172, 173, 57, 57, 57, 57, 57, 57, 57, 57, 174, 57,
+    175, 57, 176, 57, 57, 177, 57, 57, 57, 57, 57, 57, 57, 57, 57, 178, 2, 179, 180, 57, 57, 57, 57, 57,
+    57, 57, 57, 57, 181, 182, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57,
+    57, 57, 57, 57, 57, 57, 57, 183, 57, 57, 57, 57, 57, 57, 57, 57, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 184, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 185, 2,
+    186, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 187, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 188, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57,
+    57, 57, 57, 57, 57, 57, 57, 57, 2, 2, 2, 2, 189, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57, 57,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 190,
+};
+
+// 191 blocks x 32 bytes: {XID_Start[2], XID_Continue[2]}
+static const UInt64 utf8_xid_stage2[191][4] = {
+    {0x0000000000000000ULL, 0x07FFFFFE07FFFFFEULL, 0x03FF000000000000ULL, 0x07FFFFFE87FFFFFEULL},
+    {0x0420040000000000ULL, 0xFF7FFFFFFF7FFFFFULL, 0x04A0040000000000ULL, 0xFF7FFFFFFF7FFFFFULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0x0000501F0003FFC3ULL, 0xFFFFFFFFFFFFFFFFULL, 0x0000501F0003FFC3ULL},
+    {0x0000000000000000ULL, 0xB8DF000000000000ULL, 0xFFFFFFFFFFFFFFFFULL, 0xB8DFFFFFFFFFFFFFULL},
+    {0xFFFFFFFBFFFFD740ULL, 0xFFBFFFFFFFFFFFFFULL, 0xFFFFFFFBFFFFD7C0ULL, 0xFFBFFFFFFFFFFFFFULL},
+    {0xFFFFFFFFFFFFFC03ULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFCFBULL, 0xFFFFFFFFFFFFFFFFULL},
+    {0xFFFEFFFFFFFFFFFFULL, 0xFFFFFFFF027FFFFFULL, 0xFFFEFFFFFFFFFFFFULL, 0xFFFFFFFF027FFFFFULL},
+    {0x00000000000001FFULL, 0x000787FFFFFF0000ULL, 0xBFFFFFFFFFFE01FFULL, 0x000787FFFFFF00B6ULL},
+    {0xFFFFFFFF00000000ULL, 0xFFFEC000000007FFULL, 0xFFFFFFFF07FF0000ULL, 0xFFFFC3FFFFFFFFFFULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0x9C00C060002FFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0x9FFFFDFF9FEFFFFFULL},
+    {0x0000FFFFFFFD0000ULL, 0xFFFFFFFFFFFFE000ULL, 0xFFFFFFFFFFFF0000ULL, 0xFFFFFFFFFFFFE7FFULL},
+    {0x0002003FFFFFFFFFULL, 0x043007FFFFFFFC00ULL, 0x0003FFFFFFFFFFFFULL, 0x243FFFFFFFFFFFFFULL},
+    {0x00000110043FFFFFULL, 0xFFFF07FF01FFFFFFULL, 0x00003FFFFFFFFFFFULL, 0xFFFF07FF0FFFFFFFULL},
+    {0xFFFFFFFF00007EFFULL, 0x00000000000003FFULL, 0xFFFFFFFFFF007EFFULL, 0xFFFFFFFBFFFFFFFFULL},
+    {0x23FFFFFFFFFFFFF0ULL, 0xFFFE0003FF010000ULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFEFFCFFFFFFFFFULL},
+    {0x23C5FDFFFFF99FE1ULL, 0x10030003B0004000ULL, 0xF3C5FDFFFFF99FEFULL, 0x5003FFCFB080799FULL},
+    {0x036DFDFFFFF987E0ULL, 0x001C00005E000000ULL, 0xD36DFDFFFFF987EEULL, 0x003FFFC05E023987ULL},
+    {0x23EDFDFFFFFBBFE0ULL, 0x0200000300010000ULL, 0xF3EDFDFFFFFBBFEEULL, 0xFE00FFCF00013BBFULL},
+    {0x23EDFDFFFFF99FE0ULL, 0x00020003B0000000ULL, 0xF3EDFDFFFFF99FEEULL, 0x0002FFCFB0E0399FULL},
+    {0x03FFC718D63DC7E8ULL, 0x0000000000010000ULL, 0xC3FFC718D63DC7ECULL, 0x0000FFC000813DC7ULL},
+    {0x23FFFDFFFFFDDFE0ULL, 0x0000000327000000ULL, 0xF3FFFDFFFFFDDFFFULL, 0x0000FFCF27603DDFULL},
+    {0x23EFFDFFFFFDDFE1ULL, 0x0006000360000000ULL, 0xF3EFFDFFFFFDDFEFULL, 0x0006FFCF60603DDFULL},
+    {0x27FFFFFFFFFDDFF0ULL, 0xFC00000380704000ULL, 0xFFFFFFFFFFFDDFFFULL, 0xFC00FFCF80F07DDFULL},
+    {0x2FFBFFFFFC7FFFE0ULL, 0x000000000000007FULL, 0x2FFBFFFFFC7FFFEEULL, 0x000CFFC0FF5F847FULL},
+    {0x0005FFFFFFFFFFFEULL, 0x000000000000007FULL, 0x07FFFFFFFFFFFFFEULL, 0x0000000003FF7FFFULL},
+    {0x2005FFAFFFFFF7D6ULL, 0x00000000F000005FULL, 0x3FFFFFAFFFFFF7D6ULL, 0x00000000F3FF3F5FULL},
+    {0x0000000000000001ULL, 0x00001FFFFFFFFEFFULL, 0xC2A003FF03000001ULL, 0xFFFE1FFFFFFFFEFFULL},
+    {0x0000000000001F00ULL, 0x0000000000000000ULL, 0x1FFFFFFFFEFFFFDFULL, 0x0000000000000040ULL},
+    {0x800007FFFFFFFFFFULL, 0xFFE1C0623C3F0000ULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFF03FFULL},
+    {0xFFFFFFFF00004003ULL, 0xF7FFFFFFFFFF20BFULL, 0xFFFFFFFF3FFFFFFFULL, 0xF7FFFFFFFFFF20BFULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFF3D7F3DFFULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFF3D7F3DFFULL},
+    {0x7F3DFFFFFFFF3DFFULL, 0xFFFFFFFFFF7FFF3DULL, 0x7F3DFFFFFFFF3DFFULL, 0xFFFFFFFFFF7FFF3DULL},
+    {0xFFFFFFFFFF3DFFFFULL, 0x0000000007FFFFFFULL, 0xFFFFFFFFFF3DFFFFULL, 0x0003FE00E7FFFFFFULL},
+    {0xFFFFFFFF0000FFFFULL, 0x3F3FFFFFFFFFFFFFULL, 0xFFFFFFFF0000FFFFULL, 0x3F3FFFFFFFFFFFFFULL},
+    {0xFFFFFFFFFFFFFFFEULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFEULL, 0xFFFFFFFFFFFFFFFFULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0xFFFF9FFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFF9FFFFFFFFFFFULL},
+    {0xFFFFFFFF07FFFFFEULL, 0x01FFC7FFFFFFFFFFULL, 0xFFFFFFFF07FFFFFEULL, 0x01FFC7FFFFFFFFFFULL},
+    {0x0003FFFF8003FFFFULL, 0x0001DFFF0003FFFFULL, 0x001FFFFF803FFFFFULL, 0x000DDFFF000FFFFFULL},
+    {0x000FFFFFFFFFFFFFULL, 0x0000000010800000ULL, 0xFFFFFFFFFFFFFFFFULL, 0x000003FF308FFFFFULL},
+    {0xFFFFFFFF00000000ULL, 0x01FFFFFFFFFFFFFFULL, 0xFFFFFFFF03FFB800ULL, 0x01FFFFFFFFFFFFFFULL},
+    {0xFFFF05FFFFFFFFFFULL, 0x003FFFFFFFFFFFFFULL, 0xFFFF07FFFFFFFFFFULL, 0x003FFFFFFFFFFFFFULL},
+    {0x000000007FFFFFFFULL, 0x001F3FFFFFFF0000ULL, 0x0FFF0FFF7FFFFFFFULL, 0x001F3FFFFFFFFFC0ULL},
+    {0xFFFF0FFFFFFFFFFFULL, 0x00000000000003FFULL, 0xFFFF0FFFFFFFFFFFULL, 0x0000000007FF03FFULL},
+    {0xFFFFFFFF007FFFFFULL, 0x00000000001FFFFFULL, 0xFFFFFFFF0FFFFFFFULL, 0x9FFFFFFF7FFFFFFFULL},
+    {0x0000008000000000ULL, 0x0000000000000000ULL, 0xBFFF008003FF03FFULL, 0x0000000000007FFFULL},
+    {0x000FFFFFFFFFFFE0ULL, 0x0000000000001FE0ULL, 0xFFFFFFFFFFFFFFFFULL, 0x000FF80003FF1FFFULL},
+    {0xFC00C001FFFFFFF8ULL, 0x0000003FFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0x000FFFFFFFFFFFFFULL},
+    {0x0000000FFFFFFFFFULL, 0x3FFFFFFFFC00E000ULL, 0x00FFFFFFFFFFFFFFULL, 0x3FFFFFFFFFFFE3FFULL},
+    {0xE7FFFFFFFFFF01FFULL, 0x046FDE0000000000ULL, 0xE7FFFFFFFFFF01FFULL, 0x07FFFFFFFFF70000ULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0x0000000000000000ULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL},
+    {0xFFFFFFFF3F3FFFFFULL, 0x3FFFFFFFAAFF3F3FULL, 0xFFFFFFFF3F3FFFFFULL, 0x3FFFFFFFAAFF3F3FULL},
+    {0x5FDFFFFFFFFFFFFFULL, 0x1FDC1FFF0FCF1FDCULL, 0x5FDFFFFFFFFFFFFFULL, 0x1FDC1FFF0FCF1FDCULL},
+    {0x0000000000000000ULL, 0x8002000000000000ULL, 0x8000000000000000ULL, 0x8002000000100001ULL},
+    {0x000000001FFF0000ULL, 0x0000000000000000ULL, 0x000000001FFF0000ULL, 0x0001FFE21FFF0000ULL},
+    {0xF3FFFD503F2FFC84ULL, 0xFFFFFFFF000043E0ULL, 0xF3FFFD503F2FFC84ULL, 0xFFFFFFFF000043E0ULL},
+    {0x00000000000001FFULL, 0x0000000000000000ULL, 0x00000000000001FFULL, 0x0000000000000000ULL},
+    {0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0x000C781FFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0x000FF81FFFFFFFFFULL},
+    {0xFFFF20BFFFFFFFFFULL, 0x000080FFFFFFFFFFULL, 0xFFFF20BFFFFFFFFFULL, 0x800080FFFFFFFFFFULL},
+    {0x7F7F7F7F007FFFFFULL, 0x000000007F7F7F7FULL, 0x7F7F7F7F007FFFFFULL, 0xFFFFFFFF7F7F7F7FULL},
+    {0x1F3E03FE000000E0ULL, 0xFFFFFFFFFFFFFFFEULL, 0x1F3EFFFE000000E0ULL, 0xFFFFFFFFFFFFFFFEULL},
+    {0xFFFFFFFEE07FFFFFULL, 0xF7FFFFFFFFFFFFFFULL, 0xFFFFFFFEE67FFFFFULL, 0xF7FFFFFFFFFFFFFFULL},
+    {0xFFFEFFFFFFFFFFE0ULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFEFFFFFFFFFFE0ULL, 0xFFFFFFFFFFFFFFFFULL},
+    {0xFFFFFFFF00007FFFULL, 0xFFFF000000000000ULL, 0xFFFFFFFF00007FFFULL, 0xFFFF000000000000ULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0x0000000000000000ULL, 0xFFFFFFFFFFFFFFFFULL, 0x0000000000000000ULL},
+    {0x0000000000001FFFULL, 0x3FFFFFFFFFFF0000ULL, 0x0000000000001FFFULL, 0x3FFFFFFFFFFF0000ULL},
+    {0x00000C00FFFF1FFFULL, 0x80007FFFFFFFFFFFULL, 0x00000FFFFFFF1FFFULL, 0xBFF0FFFFFFFFFFFFULL},
+    {0xFFFFFFFF3FFFFFFFULL, 0x0000FFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0x0003FFFFFFFFFFFFULL},
+    {0xFFFFFFFCFF800000ULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFCFF800000ULL, 0xFFFFFFFFFFFFFFFFULL},
+    {0xFFFFFFFFFFFFF9FFULL, 0xFFFC000003EB07FFULL, 0xFFFFFFFFFFFFF9FFULL, 0xFFFC000003EB07FFULL},
+    {0x00000007FFFFF7BBULL, 0x000FFFFFFFFFFFFFULL, 0x000010FFFFFFFFFFULL, 0x000FFFFFFFFFFFFFULL},
+    {0x000FFFFFFFFFFFFCULL, 0x68FC000000000000ULL, 0xFFFFFFFFFFFFFFFFULL, 0xE8FFFFFF03FF003FULL},
+    {0xFFFF003FFFFFFC00ULL, 0x1FFFFFFF0000007FULL, 0xFFFF3FFFFFFFFFFFULL, 0x1FFFFFFF000FFFFFULL},
+    {0x0007FFFFFFFFFFF0ULL, 0x7C00FFDF00008000ULL, 0xFFFFFFFFFFFFFFFFULL, 0x7FFFFFFF03FF8001ULL},
+    {0x000001FFFFFFFFFFULL, 0xC47FFFFF00000FF7ULL, 0x007FFFFFFFFFFFFFULL, 0xFC7FFFFF03FF3FFFULL},
+    {0x3E62FFFFFFFFFFFFULL, 0x001C07FF38000005ULL, 0xFFFFFFFFFFFFFFFFULL, 0x007CFFFF38000007ULL},
+    {0xFFFF7F7F007E7E7EULL, 0xFFFF03FFF7FFFFFFULL, 0xFFFF7F7F007E7E7EULL, 0xFFFF03FFF7FFFFFFULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0x00000007FFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0x03FF37FFFFFFFFFFULL},
+    {0xFFFF000FFFFFFFFFULL, 0x0FFFFFFFFFFFF87FULL, 0xFFFF000FFFFFFFFFULL, 0x0FFFFFFFFFFFF87FULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0xFFFF3FFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFF3FFFFFFFFFFFULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0x0000000003FFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0x0000000003FFFFFFULL},
+    {0x5F7FFDFFA0F8007FULL, 0xFFFFFFFFFFFFFFDBULL, 0x5F7FFDFFE0F8007FULL, 0xFFFFFFFFFFFFFFDBULL},
+    {0x0003FFFFFFFFFFFFULL, 0xFFFFFFFFFFF80000ULL, 0x0003FFFFFFFFFFFFULL, 0xFFFFFFFFFFF80000ULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFF03FFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFF03FFFFFFFULL},
+    {0x3FFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFF0000ULL, 0x3FFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFF0000ULL},
+    {0xFFFFFFFFFFFCFFFFULL, 0x03FF0000000000FFULL, 0xFFFFFFFFFFFCFFFFULL, 0x03FF0000000000FFULL},
+    {0x0000000000000000ULL, 0xAA8A000000000000ULL, 0x0018FFFF0000FFFFULL, 0xAA8A00000000E000ULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0x1FFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0x1FFFFFFFFFFFFFFFULL},
+    {0x07FFFFFE00000000ULL, 0xFFFFFFC007FFFFFEULL, 0x87FFFFFE03FF0000ULL, 0xFFFFFFC007FFFFFEULL},
+    {0x7FFFFFFF3FFFFFFFULL, 0x000000001CFCFCFCULL, 0x7FFFFFFFFFFFFFFFULL, 0x000000001CFCFCFCULL},
+    {0xB7FFFF7FFFFFEFFFULL, 0x000000003FFF3FFFULL, 0xB7FFFF7FFFFFEFFFULL, 0x000000003FFF3FFFULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0x07FFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0x07FFFFFFFFFFFFFFULL},
+    {0x0000000000000000ULL, 0x001FFFFFFFFFFFFFULL, 0x0000000000000000ULL, 0x001FFFFFFFFFFFFFULL},
+    {0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x2000000000000000ULL},
+    {0xFFFFFFFF1FFFFFFFULL, 0x000000000001FFFFULL, 0xFFFFFFFF1FFFFFFFULL, 0x000000010001FFFFULL},
+    {0xFFFFE000FFFFFFFFULL, 0x003FFFFFFFFF07FFULL, 0xFFFFE000FFFFFFFFULL, 0x07FFFFFFFFFF07FFULL},
+    {0xFFFFFFFF3FFFFFFFULL, 0x00000000003EFF0FULL, 0xFFFFFFFF3FFFFFFFULL, 0x00000000003EFF0FULL},
+    {0xFFFF00003FFFFFFFULL, 0x0FFFFFFFFF0FFFFFULL, 0xFFFF03FF3FFFFFFFULL, 0x0FFFFFFFFF0FFFFFULL},
+    {0xFFFF00FFFFFFFFFFULL, 0xF7FF000FFFFFFFFFULL, 0xFFFF00FFFFFFFFFFULL, 0xF7FF000FFFFFFFFFULL},
+    {0x1BFBFFFBFFB7F7FFULL, 0x0000000000000000ULL, 0x1BFBFFFBFFB7F7FFULL, 0x0000000000000000ULL},
+    {0x007FFFFFFFFFFFFFULL, 0x000000FF003FFFFFULL, 0x007FFFFFFFFFFFFFULL, 0x000000FF003FFFFFULL},
+    {0x07FDFFFFFFFFFFBFULL, 0x0000000000000000ULL, 0x07FDFFFFFFFFFFBFULL, 0x0000000000000000ULL},
+    {0x91BFFFFFFFFFFD3FULL, 0x007FFFFF003FFFFFULL, 0x91BFFFFFFFFFFD3FULL, 0x007FFFFF003FFFFFULL},
+    {0x000000007FFFFFFFULL, 0x0037FFFF00000000ULL, 0x000000007FFFFFFFULL, 0x0037FFFF00000000ULL},
+    {0x03FFFFFF003FFFFFULL, 0x0000000000000000ULL, 0x03FFFFFF003FFFFFULL, 0x0000000000000000ULL},
+    {0xC0FFFFFFFFFFFFFFULL, 0x0000000000000000ULL, 0xC0FFFFFFFFFFFFFFULL, 0x0000000000000000ULL},
+    {0x003FFFFFFEEF0001ULL, 0x1FFFFFFF00000000ULL, 0x873FFFFFFEEFF06FULL, 0x1FFFFFFF00000000ULL},
+    {0x000000001FFFFFFFULL, 0x0000001FFFFFFEFFULL, 0x000000001FFFFFFFULL, 0x0000007FFFFFFEFFULL},
+    {0x003FFFFFFFFFFFFFULL, 0x0007FFFF003FFFFFULL, 0x003FFFFFFFFFFFFFULL, 0x0007FFFF003FFFFFULL},
+    {0x000000000003FFFFULL, 0x0000000000000000ULL, 0x000000000003FFFFULL, 0x0000000000000000ULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0x00000000000001FFULL, 0xFFFFFFFFFFFFFFFFULL, 0x00000000000001FFULL},
+    {0x0007FFFFFFFFFFFFULL, 0x0007FFFFFFFFFFFFULL, 0x0007FFFFFFFFFFFFULL, 0x0007FFFFFFFFFFFFULL},
+    {0x0000000FFFFFFFFFULL, 0x0000000000000000ULL, 0x03FF00FFFFFFFFFFULL, 0x0000000000000000ULL},
+    {0x000303FFFFFFFFFFULL, 0x0000000000000000ULL, 0x00031BFFFFFFFFFFULL, 0x0000000000000000ULL},
+    {0xFFFF00801FFFFFFFULL, 0xFFFF00000000003FULL, 0xFFFF00801FFFFFFFULL, 0xFFFF00000001FFFFULL},
+    {0xFFFF000000000003ULL, 0x007FFFFF0000001FULL, 0xFFFF00000000003FULL, 0x007FFFFF0000001FULL},
+    {0x00FFFFFFFFFFFFF8ULL, 0x0026000000000000ULL, 0xFFFFFFFFFFFFFFFFULL, 0x803FFFC00000007FULL},
+    {0x0000FFFFFFFFFFF8ULL, 0x000001FFFFFF0000ULL, 0x07FFFFFFFFFFFFFFULL, 0x03FF01FFFFFF0004ULL},
+    {0x0000007FFFFFFFF8ULL, 0x0047FFFFFFFF0090ULL, 0xFFDFFFFFFFFFFFFFULL, 0x004FFFFFFFFF00F0ULL},
+    {0x0007FFFFFFFFFFF8ULL, 0x000000001400001EULL, 0xFFFFFFFFFFFFFFFFULL, 0x0000000017FFDE1FULL},
+    {0x00000FFFFFFBFFFFULL, 0x0000000000000000ULL, 0x40FFFFFFFFFBFFFFULL, 0x0000000000000000ULL},
+    {0xFFFF01FFBFFFBD7FULL, 0x000000007FFFFFFFULL, 0xFFFF01FFBFFFBD7FULL, 0x03FF07FFFFFFFFFFULL},
+    {0x23EDFDFFFFF99FE0ULL, 0x00000003E0010000ULL, 0xFBEDFDFFFFF99FEFULL, 0x001F1FCFE081399FULL},
+    {0x001FFFFFFFFFFFFFULL, 0x0000000380000780ULL, 0xFFFFFFFFFFFFFFFFULL, 0x00000003C3FF07FFULL},
+    {0x0000FFFFFFFFFFFFULL, 0x00000000000000B0ULL, 0xFFFFFFFFFFFFFFFFULL, 0x0000000003FF00BFULL},
+    {0x00007FFFFFFFFFFFULL, 0x000000000F000000ULL, 0xFF3FFFFFFFFFFFFFULL, 0x000000003F000001ULL},
+    {0x0000FFFFFFFFFFFFULL, 0x0000000000000010ULL, 0xFFFFFFFFFFFFFFFFULL, 0x0000000003FF0011ULL},
+    {0x010007FFFFFFFFFFULL, 0x0000000000000000ULL, 0x01FFFFFFFFFFFFFFULL, 0x00000000000003FFULL},
+    {0x0000000007FFFFFFULL, 0x000000000000007FULL, 0x03FF0FFFE7FFFFFFULL, 0x000000000000007FULL},
+    {0x00000FFFFFFFFFFFULL, 0x0000000000000000ULL, 0x07FFFFFFFFFFFFFFULL, 0x0000000000000000ULL},
+    {0xFFFFFFFF00000000ULL, 0x80000000FFFFFFFFULL, 0xFFFFFFFF00000000ULL, 0x800003FFFFFFFFFFULL},
+    {0x8000FFFFFF6FF27FULL, 0x0000000000000002ULL, 0xF9BFFFFFFF6FF27FULL, 0x0000000003FF000FULL},
+    {0xFFFFFCFF00000000ULL, 0x0000000A0001FFFFULL, 0xFFFFFCFF00000000ULL, 0x0000001BFCFFFFFFULL},
+    {0x0407FFFFFFFFF801ULL, 0xFFFFFFFFF0010000ULL, 0x7FFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFF0080ULL},
+    {0xFFFF0000200003FFULL, 0x01FFFFFFFFFFFFFFULL, 0xFFFF000023FFFFFFULL, 0x01FFFFFFFFFFFFFFULL},
+    {0x00007FFFFFFFFDFFULL, 0xFFFC000000000001ULL, 0xFF7FFFFFFFFFFDFFULL, 0xFFFC000003FF0001ULL},
+    {0x000000000000FFFFULL, 0x0000000000000000ULL, 0x007FFEFFFFFCFFFFULL, 0x0000000000000000ULL},
+    {0x0001FFFFFFFFFB7FULL, 0xFFFFFDBF00000040ULL, 0xB47FFFFFFFFFFB7FULL, 0xFFFFFDBF03FF00FFULL},
+    {0x00000000010003FFULL, 0x0000000000000000ULL, 0x000003FF01FB7FFFULL, 0x0000000000000000ULL},
+    {0x0000000000000000ULL, 0x0007FFFF00000000ULL, 0x0000000000000000ULL, 0x007FFFFF00000000ULL},
+    {0x0001000000000000ULL, 0x0000000000000000ULL, 0x0001000000000000ULL, 0x0000000000000000ULL},
+    {0x0000000003FFFFFFULL, 0x0000000000000000ULL, 0x0000000003FFFFFFULL, 0x0000000000000000ULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0x00007FFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0x00007FFFFFFFFFFFULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0x000000000000000FULL, 0xFFFFFFFFFFFFFFFFULL, 0x000000000000000FULL},
+    {0xFFFFFFFFFFFF0000ULL, 0x0001FFFFFFFFFFFFULL, 0xFFFFFFFFFFFF0000ULL, 0x0001FFFFFFFFFFFFULL},
+    {0x00007FFFFFFFFFFFULL, 0x0000000000000000ULL, 0x00007FFFFFFFFFFFULL, 0x0000000000000000ULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0x000000000000007FULL, 0xFFFFFFFFFFFFFFFFULL, 0x000000000000007FULL},
+    {0x01FFFFFFFFFFFFFFULL, 0xFFFF00007FFFFFFFULL, 0x01FFFFFFFFFFFFFFULL, 0xFFFF03FF7FFFFFFFULL},
+    {0x7FFFFFFFFFFFFFFFULL, 0x00003FFFFFFF0000ULL, 0x7FFFFFFFFFFFFFFFULL, 0x001F3FFFFFFF03FFULL},
+    {0x0000FFFFFFFFFFFFULL, 0xE0FFFFF80000000FULL, 0x007FFFFFFFFFFFFFULL, 0xE0FFFFF803FF000FULL},
+    {0x000000000000FFFFULL, 0x0000000000000000ULL, 0x000000000000FFFFULL, 0x0000000000000000ULL},
+    {0x0000000000000000ULL, 0xFFFFFFFFFFFFFFFFULL, 0x0000000000000000ULL, 0xFFFFFFFFFFFFFFFFULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0x00000000000107FFULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFF87FFULL},
+    {0x00000000FFF80000ULL, 0x0000000B00000000ULL, 0x00000000FFFF80FFULL, 0x0003001B00000000ULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0x00FFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0x00FFFFFFFFFFFFFFULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0x00000000003FFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0x00000000003FFFFFULL},
+    {0x0000000000000000ULL, 0x6FEF000000000000ULL, 0x0000000000000000ULL, 0x6FEF000000000000ULL},
+    {0x00000007FFFFFFFFULL, 0xFFFF00F000070000ULL, 0x00000007FFFFFFFFULL, 0xFFFF00F000070000ULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0x0FFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0x0FFFFFFFFFFFFFFFULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0x1FFF07FFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0x1FFF07FFFFFFFFFFULL},
+    {0x0000000003FF01FFULL, 0x0000000000000000ULL, 0x0000000063FF01FFULL, 0x0000000000000000ULL},
+    {0x0000000000000000ULL, 0x0000000000000000ULL, 0xFFFF3FFFFFFFFFFFULL, 0x000000000000007FULL},
+    {0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0xF807E3E000000000ULL},
+    {0x0000000000000000ULL, 0x0000000000000000ULL, 0x00003C0000000FE7ULL, 0x0000000000000000ULL},
+    {0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x000000000000001CULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFDFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFFFFDFFFFFULL},
+    {0xEBFFDE64DFFFFFFFULL, 0xFFFFFFFFFFFFFFEFULL, 0xEBFFDE64DFFFFFFFULL, 0xFFFFFFFFFFFFFFEFULL},
+    {0x7BFFFFFFDFDFE7BFULL, 0xFFFFFFFFFFFDFC5FULL, 0x7BFFFFFFDFDFE7BFULL, 0xFFFFFFFFFFFDFC5FULL},
+    {0xFFFFFF3FFFFFFFFFULL, 0xF7FFFFFFF7FFFFFDULL, 0xFFFFFF3FFFFFFFFFULL, 0xF7FFFFFFF7FFFFFDULL},
+    {0xFFDFFFFFFFDFFFFFULL, 0xFFFF7FFFFFFF7FFFULL, 0xFFDFFFFFFFDFFFFFULL, 0xFFFF7FFFFFFF7FFFULL},
+    {0xFFFFFDFFFFFFFDFFULL, 0x0000000000000FF7ULL, 0xFFFFFDFFFFFFFDFFULL, 0xFFFFFFFFFFFFCFF7ULL},
+    {0x0000000000000000ULL, 0x0000000000000000ULL, 0xF87FFFFFFFFFFFFFULL, 0x00201FFFFFFFFFFFULL},
+    {0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000FFFEF8000010ULL, 0x0000000000000000ULL},
+    {0x000000007FFFFFFFULL, 0x0000000000000000ULL, 0x000000007FFFFFFFULL, 0x0000000000000000ULL},
+    {0x0000000000000000ULL, 0x0000000000000000ULL, 0x000007DBF9FFFF7FULL, 0x0000000000000000ULL},
+    {0x3F801FFFFFFFFFFFULL, 0x0000000000004000ULL, 0x3FFF1FFFFFFFFFFFULL, 0x00000000000043FFULL},
+    {0x00003FFFFFFF0000ULL, 0x00000FFFFFFFFFFFULL, 0x00007FFFFFFF0000ULL, 0x03FFFFFFFFFFFFFFULL},
+    {0x0000000000000000ULL, 0x7FFF6F7F00000000ULL, 0x0000000000000000ULL, 0x7FFF6F7F00000000ULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0x000000000000001FULL, 0xFFFFFFFFFFFFFFFFULL, 0x00000000007F001FULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0x000000000000080FULL, 0xFFFFFFFFFFFFFFFFULL, 0x0000000003FF0FFFULL},
+    {0x0AF7FE96FFFFFFEFULL, 0x5EF7F796AA96EA84ULL, 0x0AF7FE96FFFFFFEFULL, 0x5EF7F796AA96EA84ULL},
+    {0x0FFFFBEE0FFFFBFFULL, 0x0000000000000000ULL, 0x0FFFFBEE0FFFFBFFULL, 0x0000000000000000ULL},
+    {0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x03FF000000000000ULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0x00000000FFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0x00000000FFFFFFFFULL},
+    {0x01FFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0x01FFFFFFFFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL},
+    {0xFFFFFFFF3FFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFF3FFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL},
+    {0xFFFF0003FFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFF0003FFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0x00000001FFFFFFFFULL, 0xFFFFFFFFFFFFFFFFULL, 0x00000001FFFFFFFFULL},
+    {0x000000003FFFFFFFULL, 0x0000000000000000ULL, 0x000000003FFFFFFFULL, 0x0000000000000000ULL},
+    {0xFFFFFFFFFFFFFFFFULL, 0x00000000000007FFULL, 0xFFFFFFFFFFFFFFFFULL, 0x00000000000007FFULL},
+};
+
+#endif // CORETEN_UTF8_XID_H
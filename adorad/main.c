@@ -1,29 +1,250 @@
 #include <adorad/adorad.h>
 
 static void usage(int status) {
-    fprintf(stderr, "Usage: adorad [ -c ] <file>\n");
+    fprintf(stderr, "Usage: adorad [ -c | -x ] <file>\n");
+    fprintf(stderr, "    adorad <file>       run <file> (in the bytecode VM)\n");
+    fprintf(stderr, "    adorad -c <file>    generate C for <file> (in the current directory)\n");
+    fprintf(stderr, "    adorad -x <file>    compile <file> to a native object file (x86-64 ELF only, for now)\n");
+    fprintf(stderr, "    adorad              start the REPL\n");
     exit(status);
 }
 
+// Everything a program goes through before it's run (or turned into C)
+typedef struct Program {
+    Parser* parser;
+    Checker* checker;
+    IrModule* module;
+    Comptime* ct;
+} Program;
+
+static void program_free(Program* program) {
+    comptime_free(program->ct);
+    ir_module_free(program->module);
+    checker_free(program->checker);
+    parser_free(program->parser);
+}
+
+// Returns false (having reported why) if `source` has errors. Errors are only reported if `quiet` is false.
+static bool program_build(Program* program, char* source, char* fname, bool quiet) {
+    memset(program, 0, sizeof(Program));
+    Lexer* lexer = lexer_init(source, fname);
+    lexer_lex(lexer);
+    program->parser = parser_init(lexer);
+    parser_parse(program->parser);
+
+    program->checker = checker_new(0);
+    if(checker_check(program->checker, &program->parser, 1) > 0) {
+        if(!quiet)
+            checker_print_diagnostics(program->checker, stderr);
+        return false;
+    }
+    program->module = ir_lower(program->checker);
+    program->ct = comptime_new(program->module);
+    if(comptime_module(program->ct) > 0) {
+        if(!quiet)
+            comptime_print_diagnostics(program->ct, stderr);
+        return false;
+    }
+    opt_module(program->module, null);
+    return true;
+}
+
+static int run_file(char* fname) {
+    char* source = read_file(fname);
+    if(NONE(source)) {
+        fprintf(stderr, "adorad: can't read `%s`\n", fname);
+        return 1;
+    }
+    Program program;
+    if(!program_build(&program, source, fname, false)) {
+        program_free(&program);
+        return 1;
+    }
+
+    Vm* vm = vm_new();
+    Int64 exit_code = 1;
+    if(vm_load(vm, program.module) > 0)
+        vm_print_diagnostics(vm, stderr);
+    else if(!vm_run(vm, &exit_code))
+        fprintf(stderr, "%s: error: %s\n", fname, vm->error);
+    vm_free(vm);
+    program_free(&program);
+    return cast(int)exit_code;
+}
+
+// `dir/hello.ad` is `hello`
+static char* output_name(char* fname) {
+    char* base = strrchr(fname, '/');
+    base = SOME(base) ? base + 1 : fname;
+    char* name = cast(char*)malloc(strlen(base) + 3);
+    CORETEN_ENFORCE_NN(name, "Could not allocate memory. Memory full.");
+    strcpy(name, base);
+    char* dot = strrchr(name, '.');
+    if(SOME(dot) && dot != name)
+        *dot = nullchar;
+    return name;
+}
+
+static int compile_file(char* fname, bool native) {
+    char* source = read_file(fname);
+    if(NONE(source)) {
+        fprintf(stderr, "adorad: can't read `%s`\n", fname);
+        return 1;
+    }
+    Program program;
+    if(!program_build(&program, source, fname, false)) {
+        program_free(&program);
+        return 1;
+    }
+
+    // `dir/hello.ad` generates `hello.h` and `hello_<i>.c` (or `hello.o`)
+    char* name = output_name(fname);
+    int status = 0;
+    if(native) {
+        X64* x64 = x64_new(OutputArchAuto);
+        if(NONE(x64)) {
+            fprintf(stderr, "adorad: native code generation isn't supported on this architecture (yet)\n");
+            status = 1;
+        } else if(x64_generate(x64, program.module) > 0) {
+            x64_print_diagnostics(x64, stderr);
+            status = 1;
+        } else if(!x64_write(x64, strcat(name, ".o"))) {
+            fprintf(stderr, "adorad: can't write `%s`\n", name);
+            status = 1;
+        }
+        x64_free(x64);
+    } else {
+        CGen* gen = cgen_new(0, 1);
+        gen->comptime = program.ct;
+        if(cgen_generate(gen, program.checker, name) > 0) {
+            cgen_print_diagnostics(gen, stderr);
+            status = 1;
+        } else if(!cgen_write(gen, ".")) {
+            fprintf(stderr, "adorad: can't write `%s.h`\n", name);
+            status = 1;
+        }
+        cgen_free(gen);
+    }
+    free(name);
+    program_free(&program);
+    return status;
+}
+
+// The REPL -----------------------------------------------------------------------------------------------------------
+
+static void repl_print(Type* type, VmValue* value) {
+    if(type->kind == AdoradTypeOptional) {
+        if(value[1].u) {
+            puts("null");
+            return;
+        }
+        type = type->elem;
+    }
+    if(type_is_float(type))
+        printf("%g\n", value->f);
+    else if(type->kind == AdoradTypeBool)
+        puts(value->u ? "true" : "false");
+    else if(type->kind == AdoradTypeString)
+        printf("\"%.*s\"\n", cast(int)value->s->len, value->s->data);
+    else if(type_is_signed(type) || type->kind == AdoradTypeRune)
+        printf("%" PRId64 "\n", value->i);
+    else if(opt_int_bits(type) > 0)
+        printf("%" CORETEN_PRIu64 "\n", value->u);
+}
+
+static bool repl_is_decl(char* line) {
+    const char* keywords[] = { "func ", "put ", "type ", "struct ", "enum ", "import ", "[" };
+    while(*line == ' ' || *line == '\t')
+        line++;
+    for(UInt64 i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++)
+        if(strncmp(line, keywords[i], strlen(keywords[i])) == 0)
+            return true;
+    return false;
+}
+
+// Run `source` (the declarations so far, plus the line being evaluated as `__repl`). The initializers of the
+// declarations so far already ran once, so what they print is dropped.
+// Returns -1 if `source` doesn't check, 0 if running it failed, and 1 otherwise.
+static int repl_run(char* source, bool quiet) {
+    Program program;
+    if(!program_build(&program, source, "<repl>", quiet)) {
+        program_free(&program);
+        return -1;
+    }
+    Vm* vm = vm_new();
+    bool ok = vm_load(vm, program.module) == 0;
+    if(!ok) {
+        vm_print_diagnostics(vm, stderr);
+    } else {
+        StrBuilder* dropped = strbuilder_new(0);
+        vm->output = dropped;
+        VmFunc* repl = vm_func(vm, "__repl");
+        ok = vm_init(vm);
+        vm->output = null;
+        if(ok && SOME(repl)) {
+            VmValue result[2] = {0};
+            ok = vm_call(vm, repl, null, result);
+            if(ok && repl->symbol->kind == SymbolKindVariable)
+                repl_print(repl->symbol->type, result);
+        }
+        if(!ok)
+            fprintf(stderr, "error: %s\n", vm->error);
+        strbuilder_free(dropped);
+    }
+    fflush(stdout);
+    vm_free(vm);
+    program_free(&program);
+    return ok ? 1 : 0;
+}
+
+// Declarations are kept (if they check), everything else is evaluated as an expression and its value printed.
+// Parse errors still end the session, like they end every other compilation.
+static int repl() {
+    puts("Adorad 0.0.1 (bytecode VM). Declarations are kept, expressions are evaluated. Ctrl-D to quit.");
+    StrBuilder* decls = strbuilder_new(0);
+    char line[4096];
+    while(true) {
+        printf("adorad> ");
+        fflush(stdout);
+        if(NONE(fgets(line, sizeof(line), stdin)))
+            break;
+        UInt64 len = strlen(line);
+        while(len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+            line[--len] = nullchar;
+        if(len == 0)
+            continue;
+
+        StrBuilder* source = strbuilder_new(0);
+        strbuilder_append_n(source, decls->data, decls->len);
+        if(repl_is_decl(line)) {
+            strbuilder_appendf(source, "%s\n", line);
+            if(repl_run(source->data, false) > 0)
+                strbuilder_appendf(decls, "%s\n", line);
+        } else {
+            // A value (`put __repl = ...`), or something without one (a call to a function returning `Void`)
+            strbuilder_appendf(source, "put __repl = %s\n", line);
+            if(repl_run(source->data, true) < 0) {
+                strbuilder_free(source);
+                source = strbuilder_new(0);
+                strbuilder_append_n(source, decls->data, decls->len);
+                strbuilder_appendf(source, "func __repl() { %s }\n", line);
+                repl_run(source->data, false);
+            }
+        }
+        strbuilder_free(source);
+    }
+    puts("");
+    strbuilder_free(decls);
+    return 0;
+}
+
 int main(int argc, char** argv) {
-    // C - Example: 
-    // To compile a Adorad source file:
-    // >> adorad compile hello.ad
-    // if(argc<3) {
-    //     printf("Too few arguments"); 
-    //     return 1;
-    // }
-
-    // puts("    Adorad Language 0.0.1 (May 22 2021 02:39:23)");
-    // puts("    GCC version: 9.3.0 on Windows");
-    // puts("    All engines are a go!");
-
-    // while(true) {
-    //     printf("adorad> ");
-    //     char buffer[20];
-    //     fgets(buffer, 20, stdin);
-    //     printf("%s", buffer);
-    //     // printf("\n");
-    // }
-    return 0; 
-}
\ No newline at end of file
+    if(argc == 1)
+        return repl();
+    if(argc == 2 && strcmp(argv[1], "-h") != 0 && strcmp(argv[1], "--help") != 0)
+        return argv[1][0] == '-' ? (usage(1), 1) : run_file(argv[1]);
+    if(argc == 3 && (strcmp(argv[1], "-c") == 0 || strcmp(argv[1], "-x") == 0))
+        return compile_file(argv[2], argv[1][1] == 'x');
+    usage(argc == 2 ? 0 : 1);
+    return 1;
+}
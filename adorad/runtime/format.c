@@ -0,0 +1,901 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <adorad/core/debug.h>
+#include <adorad/core/misc.h>
+#include <adorad/runtime/format.h>
+#include <adorad/runtime/format_tables.h>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif // _MSC_VER
+
+// `FormatField.flags`
+#define FORMAT_NEGATIVE     1   // a minus sign
+#define FORMAT_SIGN         2   // a sign (`-`, or `+` for the `+` flag)
+#define FORMAT_SPECIAL      4   // `nan` or `inf`
+#define FORMAT_SCIENTIFIC   8   // a float in scientific notation
+#define FORMAT_FIXED        16  // a float with `f` and a precision: `digits` is its value times `10^precision`
+#define FORMAT_SLOW         32  // the whole field (padding and all) comes from `snprintf()`
+
+static const char format_digit_pairs[201] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static const UInt64 format_pow10[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+    10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+    1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL,
+    10000000000000000000ULL,
+};
+
+// 5^0 to 5^27 (the largest that fits in 63 bits)
+#define FORMAT_MAX_POW5     27
+static const UInt64 format_pow5[FORMAT_MAX_POW5 + 1] = {
+    1ULL, 5ULL, 25ULL, 125ULL, 625ULL, 3125ULL, 15625ULL, 78125ULL, 390625ULL, 1953125ULL, 9765625ULL, 48828125ULL,
+    244140625ULL, 1220703125ULL, 6103515625ULL, 30517578125ULL, 152587890625ULL, 762939453125ULL,
+    3814697265625ULL, 19073486328125ULL, 95367431640625ULL, 476837158203125ULL, 2384185791015625ULL,
+    11920928955078125ULL, 59604644775390625ULL, 298023223876953125ULL, 1490116119384765625ULL,
+    7450580596923828125ULL,
+};
+
+// Integers -----------------------------------------------------------------------------------------------------------
+
+// The number of bits of `x` (which must be non-zero)
+static CORETEN_ALWAYS_INLINE UInt32 format_bit_length(UInt64 x) {
+#if defined(CORETEN_COMPILER_GCC) || defined(CORETEN_COMPILER_CLANG)
+    return 64 - cast(UInt32)__builtin_clzll(x);
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long index;
+    _BitScanReverse64(&index, x);
+    return cast(UInt32)index + 1;
+#else
+    UInt32 bits = 0;
+    while(x != 0) {
+        x >>= 1;
+        bits++;
+    }
+    return bits;
+#endif
+}
+
+// The number of decimal digits of `x`. 1233 / 4096 is just above log10(2), so `t` is the number of digits, or one less.
+static CORETEN_ALWAYS_INLINE UInt32 format_count_digits(UInt64 x) {
+    if(x < 10)
+        return 1;
+    UInt32 t = (format_bit_length(x) * 1233) >> 12;
+    return t + (x >= format_pow10[t]);
+}
+
+// Write the `n` digits of `x` (`format_count_digits()`), two at a time from the last one back
+static CORETEN_ALWAYS_INLINE void format_write_digits(UInt64 x, char* out, UInt32 n) {
+    char* p = out + n;
+    while(x >= 100) {
+        UInt64 q = x / 100;
+        UInt32 r = cast(UInt32)(x - q * 100);
+        p -= 2;
+        memcpy(p, &format_digit_pairs[2 * r], 2);
+        x = q;
+    }
+    if(x >= 10) {
+        p -= 2;
+        memcpy(p, &format_digit_pairs[2 * x], 2);
+    } else {
+        *--p = cast(char)('0' + x);
+    }
+}
+
+// Bits per digit of an integer verb (0 for decimal)
+static inline UInt32 format_radix_shift(char verb) {
+    switch(verb) {
+        case 'x': case 'X': return 4;
+        case 'o': return 3;
+        case 'b': return 1;
+        default: return 0;
+    }
+}
+
+static inline UInt32 format_count_radix_digits(UInt64 x, UInt32 shift) {
+    return (format_bit_length(x | 1) + shift - 1) / shift;
+}
+
+static void format_write_radix_digits(UInt64 x, char* out, UInt32 n, UInt32 shift, bool upper) {
+    const char* chars = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    UInt64 mask = (1ULL << shift) - 1;
+    for(UInt32 i = n; i > 0; i--) {
+        out[i - 1] = chars[x & mask];
+        x >>= shift;
+    }
+}
+
+UInt32 format_uint(UInt64 x, char* out) {
+    UInt32 n = format_count_digits(x);
+    format_write_digits(x, out, n);
+    return n;
+}
+
+UInt32 format_int(Int64 x, char* out) {
+    if(x >= 0)
+        return format_uint(cast(UInt64)x, out);
+    *out = '-';
+    return 1 + format_uint(0 - cast(UInt64)x, out + 1);
+}
+
+// Ryu -------------------------------------------------------------------------------------------------------------
+
+// The low 64 bits of `a * b` (and the high ones in `hi`)
+static CORETEN_ALWAYS_INLINE UInt64 format_umul128(UInt64 a, UInt64 b, UInt64* hi) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = cast(unsigned __int128)a * b;
+    *hi = cast(UInt64)(product >> 64);
+    return cast(UInt64)product;
+#else
+    UInt64 a_lo = a & 0xFFFFFFFFULL;
+    UInt64 a_hi = a >> 32;
+    UInt64 b_lo = b & 0xFFFFFFFFULL;
+    UInt64 b_hi = b >> 32;
+    UInt64 lo_lo = a_lo * b_lo;
+    UInt64 hi_lo = a_hi * b_lo;
+    UInt64 lo_hi = a_lo * b_hi;
+    UInt64 hi_hi = a_hi * b_hi;
+    UInt64 mid = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFFULL) + lo_hi;
+    *hi = hi_hi + (hi_lo >> 32) + (mid >> 32);
+    return (mid << 32) | (lo_lo & 0xFFFFFFFFULL);
+#endif
+}
+
+// `(m * mul) >> j`, where `mul` is a 128-bit number ({low, high}) and `64 < j < 128`
+static CORETEN_ALWAYS_INLINE UInt64 format_mul_shift(UInt64 m, const UInt64* mul, Int32 j) {
+    UInt64 high0;
+    format_umul128(m, mul[0], &high0);
+    UInt64 high1;
+    UInt64 low1 = format_umul128(m, mul[1], &high1);
+    UInt64 sum = high0 + low1;
+    if(sum < high0)
+        high1++;
+    UInt32 shift = cast(UInt32)(j - 64);
+    return (sum >> shift) | (high1 << (64 - shift));
+}
+
+// ceil(log2(5^e)) (and 1 for e = 0), for 0 <= e <= 3528
+static inline Int32 format_pow5_bits(Int32 e) {
+    return cast(Int32)((cast(UInt32)e * 1217359) >> 19) + 1;
+}
+
+// floor(log10(2^e)) for 0 <= e <= 1650, and floor(log10(5^e)) for 0 <= e <= 2620
+static inline UInt32 format_log10_pow2(Int32 e) {
+    return (cast(UInt32)e * 78913) >> 18;
+}
+
+static inline UInt32 format_log10_pow5(Int32 e) {
+    return (cast(UInt32)e * 732923) >> 20;
+}
+
+static inline bool format_is_multiple_of_pow5(UInt64 x, UInt32 p) {
+    UInt32 count = 0;
+    while(x % 5 == 0 && count < p) {
+        x /= 5;
+        count++;
+    }
+    return count >= p;
+}
+
+static inline bool format_is_multiple_of_pow2(UInt64 x, UInt32 p) {
+    return (x & ((1ULL << p) - 1)) == 0;
+}
+
+typedef struct FormatDecimal {
+    UInt64 digits;      // without trailing zeroes
+    Int32 exponent;
+} FormatDecimal;
+
+// The shortest decimal that reads back as the (positive, finite) float with a mantissa of `mantissa_bits` bits, and
+// an exponent with a bias of `bias`. Among the shortest, the one closest to the float.
+static FormatDecimal format_shortest(UInt64 ieee_mantissa, UInt32 ieee_exponent, UInt32 mantissa_bits, Int32 bias) {
+    FormatDecimal result;
+    UInt64 m2 = ieee_exponent == 0 ? ieee_mantissa : (1ULL << mantissa_bits) | ieee_mantissa;
+    Int32 exponent = ieee_exponent == 0 ? 1 : cast(Int32)ieee_exponent;
+
+    // Integers (below 2^mantissa_bits) are their own shortest representation
+    Int32 int_shift = bias + cast(Int32)mantissa_bits - exponent;
+    if(ieee_exponent != 0 && int_shift >= 0 && int_shift <= cast(Int32)mantissa_bits &&
+       (m2 & ((1ULL << int_shift) - 1)) == 0) {
+        result.digits = m2 >> int_shift;
+        result.exponent = 0;
+        while(result.digits % 10 == 0) {
+            result.digits /= 10;
+            result.exponent++;
+        }
+        return result;
+    }
+
+    // The float is `m2 * 2^e2` (with two extra bits for the bounds), and everything that rounds to it is in
+    // [mm, mp] (`4 * m2 - 1 - mm_shift`, `4 * m2 + 2`), inclusive if `m2` is even
+    Int32 e2 = exponent - bias - cast(Int32)mantissa_bits - 2;
+    bool accept_bounds = (m2 & 1) == 0;
+    UInt64 mv = 4 * m2;
+    UInt32 mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+
+    // The bounds, times 10^-e10 (truncated), and whether the ones that matter were exact
+    UInt64 vr, vp, vm;
+    Int32 e10;
+    bool vm_is_trailing_zeros = false;
+    bool vr_is_trailing_zeros = false;
+    if(e2 >= 0) {
+        UInt32 q = format_log10_pow2(e2) - (e2 > 3);
+        e10 = cast(Int32)q;
+        Int32 k = FORMAT_POW5_INV_BITCOUNT + format_pow5_bits(cast(Int32)q) - 1;
+        Int32 i = -e2 + cast(Int32)q + k;
+        vr = format_mul_shift(mv, format_pow5_inv_split[q], i);
+        vp = format_mul_shift(mv + 2, format_pow5_inv_split[q], i);
+        vm = format_mul_shift(mv - 1 - mm_shift, format_pow5_inv_split[q], i);
+        if(q <= 21) {
+            // Only one of mp, mv and mm can be a multiple of 5, if any
+            if(mv % 5 == 0)
+                vr_is_trailing_zeros = format_is_multiple_of_pow5(mv, q);
+            else if(accept_bounds)
+                vm_is_trailing_zeros = format_is_multiple_of_pow5(mv - 1 - mm_shift, q);
+            else
+                vp -= format_is_multiple_of_pow5(mv + 2, q);
+        }
+    } else {
+        UInt32 q = format_log10_pow5(-e2) - (-e2 > 1);
+        e10 = cast(Int32)q + e2;
+        Int32 i = -e2 - cast(Int32)q;
+        Int32 k = format_pow5_bits(i) - FORMAT_POW5_BITCOUNT;
+        Int32 j = cast(Int32)q - k;
+        vr = format_mul_shift(mv, format_pow5_split[i], j);
+        vp = format_mul_shift(mv + 2, format_pow5_split[i], j);
+        vm = format_mul_shift(mv - 1 - mm_shift, format_pow5_split[i], j);
+        if(q <= 1) {
+            // mv has at least 2 trailing zero bits, and so does mp (mm too, if mm_shift is 1)
+            vr_is_trailing_zeros = true;
+            if(accept_bounds)
+                vm_is_trailing_zeros = mm_shift == 1;
+            else
+                vp--;
+        } else if(q < 63) {
+            vr_is_trailing_zeros = format_is_multiple_of_pow2(mv, q);
+        }
+    }
+
+    // Drop digits while the bounds still differ. `last_removed` decides the rounding.
+    Int32 removed = 0;
+    UInt32 last_removed = 0;
+    UInt64 output;
+    if(vm_is_trailing_zeros || vr_is_trailing_zeros) {
+        // Rare: the bounds or the value itself are exact
+        while(vp / 10 > vm / 10) {
+            vm_is_trailing_zeros &= vm % 10 == 0;
+            vr_is_trailing_zeros &= last_removed == 0;
+            last_removed = cast(UInt32)(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        if(vm_is_trailing_zeros) {
+            while(vm % 10 == 0) {
+                vr_is_trailing_zeros &= last_removed == 0;
+                last_removed = cast(UInt32)(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+        // A tie: round to even
+        if(vr_is_trailing_zeros && last_removed == 5 && vr % 2 == 0)
+            last_removed = 4;
+        output = vr + ((vr == vm && (!accept_bounds || !vm_is_trailing_zeros)) || last_removed >= 5);
+    } else {
+        bool round_up = false;
+        if(vp / 100 > vm / 100) {
+            round_up = vr % 100 >= 50;
+            vr /= 100;
+            vp /= 100;
+            vm /= 100;
+            removed += 2;
+        }
+        while(vp / 10 > vm / 10) {
+            round_up = vr % 10 >= 5;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        output = vr + (vr == vm || round_up);
+    }
+
+    result.digits = output;
+    result.exponent = e10 + removed;
+    while(result.digits % 10 == 0) {
+        result.digits /= 10;
+        result.exponent++;
+    }
+    return result;
+}
+
+// The shortest digits of `x` (finite and positive), as a `Float32` if `is_float32`
+static FormatDecimal format_shortest_of(double x, bool is_float32) {
+    if(is_float32) {
+        float f = cast(float)x;
+        UInt32 bits;
+        memcpy(&bits, &f, sizeof(bits));
+        return format_shortest(bits & 0x7FFFFF, (bits >> 23) & 0xFF, 23, 127);
+    }
+    UInt64 bits;
+    memcpy(&bits, &x, sizeof(bits));
+    return format_shortest(bits & 0xFFFFFFFFFFFFFULL, cast(UInt32)(bits >> 52) & 0x7FF, 52, 1023);
+}
+
+// `x * 10^precision` (x finite and positive), rounded half to even, into `out`. Returns false if that doesn't fit in
+// 64 bits (or `precision` is too big to tell).
+static bool format_fixed(double x, Int32 precision, UInt64* out) {
+    UInt64 bits;
+    memcpy(&bits, &x, sizeof(bits));
+    UInt32 ieee_exponent = cast(UInt32)(bits >> 52) & 0x7FF;
+    UInt64 m = bits & 0xFFFFFFFFFFFFFULL;
+    Int32 e2 = -1074;
+    if(ieee_exponent != 0) {
+        m |= 1ULL << 52;
+        e2 = cast(Int32)ieee_exponent - 1075;
+    }
+    if(precision > FORMAT_MAX_POW5)
+        return false;
+
+    // x * 10^precision is exactly (m * 5^precision) * 2^(e2 + precision), and m * 5^precision takes at most 116 bits
+    UInt64 hi;
+    UInt64 lo = format_umul128(m, format_pow5[precision], &hi);
+    Int32 shift = e2 + precision;
+    if(shift >= 0) {
+        if(hi != 0 || shift >= 64 || (shift > 0 && (lo >> (64 - shift)) != 0))
+            return false;
+        *out = lo << shift;
+        return true;
+    }
+
+    UInt32 k = cast(UInt32)-shift;
+    if(k >= 128) {
+        *out = 0;
+        return true;
+    }
+    // Split it into the quotient and the remainder of the division by 2^k, and compare the remainder with half of 2^k
+    UInt64 q, rem_hi, rem_lo, half_hi, half_lo;
+    if(k < 64) {
+        if((hi >> k) != 0)
+            return false;
+        q = (lo >> k) | (hi << (64 - k));
+        rem_hi = 0;
+        rem_lo = lo & ((1ULL << k) - 1);
+        half_hi = 0;
+        half_lo = 1ULL << (k - 1);
+    } else if(k == 64) {
+        q = hi;
+        rem_hi = 0;
+        rem_lo = lo;
+        half_hi = 0;
+        half_lo = 1ULL << 63;
+    } else {
+        q = hi >> (k - 64);
+        rem_hi = hi & ((1ULL << (k - 64)) - 1);
+        rem_lo = lo;
+        half_hi = 1ULL << (k - 65);
+        half_lo = 0;
+    }
+    int cmp = rem_hi != half_hi ? (rem_hi > half_hi ? 1 : -1) : (rem_lo > half_lo) - (rem_lo < half_lo);
+    if(cmp > 0 || (cmp == 0 && (q & 1))) {
+        if(q == UINT64_MAX)
+            return false;
+        q++;
+    }
+    *out = q;
+    return true;
+}
+
+// Floats -----------------------------------------------------------------------------------------------------------
+
+// Length of the exponent of scientific notation (`e+05`, `e-123`)
+static inline UInt64 format_exponent_len(Int32 exponent) {
+    Int32 magnitude = exponent < 0 ? -exponent : exponent;
+    return magnitude >= 100 ? 5 : 4;
+}
+
+static char* format_write_exponent(char* out, Int32 exponent) {
+    *out++ = 'e';
+    *out++ = exponent < 0 ? '-' : '+';
+    UInt32 magnitude = cast(UInt32)(exponent < 0 ? -exponent : exponent);
+    if(magnitude >= 100) {
+        *out++ = cast(char)('0' + magnitude / 100);
+        magnitude %= 100;
+    }
+    memcpy(out, &format_digit_pairs[2 * magnitude], 2);
+    return out + 2;
+}
+
+// The significant digits of a float in scientific notation: all of them, or `precision + 1` (padded with zeroes)
+static inline UInt32 format_significant_digits(const FormatField* field, Int16 precision) {
+    return precision >= 0 ? cast(UInt32)precision + 1 : format_count_digits(field->digits);
+}
+
+// The length of a float (without its sign) in plain notation: `digits * 10^exponent`
+static UInt64 format_plain_len(UInt64 digits, Int32 exponent) {
+    Int64 n = format_count_digits(digits);
+    Int64 k = n + exponent;     // digits before the point
+    if(k <= 0)
+        return cast(UInt64)(2 - k + n);
+    if(k < n)
+        return cast(UInt64)(n + 1);
+    return cast(UInt64)(k + 2);
+}
+
+static char* format_write_plain(char* out, UInt64 digits, Int32 exponent) {
+    UInt32 n = format_count_digits(digits);
+    Int64 k = cast(Int64)n + exponent;
+    if(k <= 0) {
+        out[0] = '0';
+        out[1] = '.';
+        memset(out + 2, '0', cast(size_t)-k);
+        out += 2 - k;
+        format_write_digits(digits, out, n);
+        return out + n;
+    }
+    if(k < n) {
+        // Write the digits one to the right, and move the ones before the point back
+        format_write_digits(digits, out + 1, n);
+        memmove(out, out + 1, cast(size_t)k);
+        out[k] = '.';
+        return out + n + 1;
+    }
+    format_write_digits(digits, out, n);
+    memset(out + n, '0', cast(size_t)(k - n));
+    out += k;
+    out[0] = '.';
+    out[1] = '0';
+    return out + 2;
+}
+
+static char* format_write_scientific(char* out, const FormatField* field, Int16 precision) {
+    UInt32 n = format_count_digits(field->digits);
+    UInt32 total = format_significant_digits(field, precision);
+    format_write_digits(field->digits, out + 1, n);
+    out[0] = out[1];
+    if(total == 1)
+        return format_write_exponent(out + 1, field->exponent);
+    out[1] = '.';
+    memset(out + n + 1, '0', total - n);
+    return format_write_exponent(out + total + 1, field->exponent);
+}
+
+// `digits` (the value times 10^precision) with the point `precision` digits from the end
+static char* format_write_fixed(char* out, UInt64 digits, Int16 precision) {
+    UInt32 n = format_count_digits(digits);
+    UInt32 total = n > cast(UInt32)precision ? n : cast(UInt32)precision + 1;
+    memset(out, '0', total - n);
+    format_write_digits(digits, out + total - n, n);
+    if(precision == 0)
+        return out + total;
+    UInt32 before = total - cast(UInt32)precision;
+    memmove(out + before + 1, out + before, cast(size_t)precision);
+    out[before] = '.';
+    return out + total + 1;
+}
+
+static int format_snprintf(char* out, size_t size, FormatSpec spec, double x) {
+    char pattern[16];
+    int n = 0;
+    pattern[n++] = '%';
+    if(spec.left)
+        pattern[n++] = '-';
+    if(spec.plus)
+        pattern[n++] = '+';
+    if(spec.zero)
+        pattern[n++] = '0';
+    memcpy(pattern + n, "*.*", 3);
+    n += 3;
+    pattern[n++] = spec.verb;
+    pattern[n] = nullchar;
+    return snprintf(out, size, pattern, cast(int)spec.width, cast(int)spec.precision, x);
+}
+
+// The digits of a float, and the length of the field (without its sign)
+static UInt64 format_measure_float(FormatSpec spec, double x, bool is_float32, FormatField* field) {
+    if(isnan(x) || isinf(x)) {
+        field->flags = (field->flags & ~FORMAT_SIGN) | FORMAT_SPECIAL;
+        if(isinf(x) && (x < 0 || spec.plus))
+            field->flags |= FORMAT_SIGN;
+        return 3;
+    }
+    double magnitude = fabs(x);
+
+    if(spec.verb == 'f' && spec.precision >= 0) {
+        if(format_fixed(magnitude, spec.precision, &field->digits)) {
+            field->flags |= FORMAT_FIXED;
+            UInt32 n = format_count_digits(field->digits);
+            UInt64 total = n > cast(UInt32)spec.precision ? n : cast(UInt64)spec.precision + 1;
+            return total + (spec.precision > 0);
+        }
+        field->flags |= FORMAT_SLOW;
+        return 0;
+    }
+
+    FormatDecimal decimal = {0, 0};
+    if(magnitude != 0)
+        decimal = format_shortest_of(magnitude, is_float32 && spec.precision < 0);
+    field->digits = decimal.digits;
+    field->exponent = decimal.exponent;
+    Int32 n = cast(Int32)format_count_digits(decimal.digits);
+    // The exponent of the first digit
+    Int32 leading = n + decimal.exponent - 1;
+
+    if(spec.verb == 'e' && spec.precision >= 0) {
+        Int32 wanted = spec.precision + 1;
+        if(n > wanted) {
+            // Round the shortest digits. That's only the same as rounding the exact value when they don't end in a
+            // single 5 that's dropped (a tie, or close enough to one that it takes all of the digits to tell).
+            UInt64 scale = format_pow10[n - wanted];
+            UInt64 kept = decimal.digits / scale;
+            UInt64 rest = decimal.digits - kept * scale;
+            if(rest == scale / 2) {
+                field->flags |= FORMAT_SLOW;
+                return 0;
+            }
+            kept += rest > scale / 2;
+            if(kept == format_pow10[wanted]) {
+                kept /= 10;
+                leading++;
+            }
+            field->digits = kept;
+        } else if((wanted > 15 || magnitude < DBL_MIN) && magnitude != 0) {
+            // More digits than the shortest ones only come out as zeroes if the float is that precise (a normal
+            // `Float64` is, to 15 digits)
+            field->flags |= FORMAT_SLOW;
+            return 0;
+        }
+    }
+
+    bool scientific = spec.verb == 'e' || (spec.verb != 'f' && (leading < -4 || leading > 15));
+    if(scientific) {
+        field->flags |= FORMAT_SCIENTIFIC;
+        field->exponent = leading;
+        UInt32 total = format_significant_digits(field, spec.precision);
+        return total + (total > 1) + format_exponent_len(leading);
+    }
+    return format_plain_len(field->digits, field->exponent);
+}
+
+static char* format_write_float(char* out, FormatSpec spec, double x, const FormatField* field) {
+    if(field->flags & FORMAT_SPECIAL) {
+        memcpy(out, isnan(x) ? "nan" : "inf", 3);
+        return out + 3;
+    }
+    if(field->flags & FORMAT_FIXED)
+        return format_write_fixed(out, field->digits, spec.precision);
+    if(field->flags & FORMAT_SCIENTIFIC)
+        return format_write_scientific(out, field, spec.precision);
+    return format_write_plain(out, field->digits, field->exponent);
+}
+
+// Fields ------------------------------------------------------------------------------------------------------------
+
+static const char* format_bool_str(Int64 x) {
+    return x ? "true" : "false";
+}
+
+// A rune that isn't a valid code point is written as U+FFFD
+static UInt32 format_rune_len(Int64 rune) {
+    if(rune < 0 || rune > 0x10FFFF || (rune >= 0xD800 && rune <= 0xDFFF))
+        return 3;
+    return rune < 0x80 ? 1 : rune < 0x800 ? 2 : rune < 0x10000 ? 3 : 4;
+}
+
+static char* format_write_rune(char* out, Int64 rune) {
+    if(rune < 0 || rune > 0x10FFFF || (rune >= 0xD800 && rune <= 0xDFFF))
+        rune = 0xFFFD;
+    UInt32 r = cast(UInt32)rune;
+    if(r < 0x80) {
+        *out++ = cast(char)r;
+    } else if(r < 0x800) {
+        *out++ = cast(char)(0xC0 | (r >> 6));
+        *out++ = cast(char)(0x80 | (r & 0x3F));
+    } else if(r < 0x10000) {
+        *out++ = cast(char)(0xE0 | (r >> 12));
+        *out++ = cast(char)(0x80 | ((r >> 6) & 0x3F));
+        *out++ = cast(char)(0x80 | (r & 0x3F));
+    } else {
+        *out++ = cast(char)(0xF0 | (r >> 18));
+        *out++ = cast(char)(0x80 | ((r >> 12) & 0x3F));
+        *out++ = cast(char)(0x80 | ((r >> 6) & 0x3F));
+        *out++ = cast(char)(0x80 | (r & 0x3F));
+    }
+    return out;
+}
+
+// The number of characters (not bytes) of a string
+static UInt64 format_count_chars(const char* data, UInt64 len) {
+    UInt64 chars = 0;
+    for(UInt64 i = 0; i < len; i++)
+        chars += (cast(Byte)data[i] & 0xC0) != 0x80;
+    return chars;
+}
+
+static inline bool format_is_integer(const FormatHole* hole) {
+    return hole->kind == FormatKindInt || hole->kind == FormatKindUInt ||
+           (hole->kind == FormatKindRune && hole->spec.verb != 0 && hole->spec.verb != 'c');
+}
+
+// Work out `field` (and return its length, with the padding)
+static UInt64 format_measure(const FormatHole* hole, FormatArg arg, FormatField* field) {
+    FormatSpec spec = hole->spec;
+    field->flags = 0;
+    UInt64 len = 0;
+    UInt64 chars = 0;
+    if(format_is_integer(hole)) {
+        bool negative = hole->kind != FormatKindUInt && arg.i < 0;
+        field->digits = negative ? 0 - arg.u : arg.u;
+        if(negative || spec.plus)
+            field->flags |= FORMAT_SIGN | (negative ? FORMAT_NEGATIVE : 0);
+        UInt32 shift = format_radix_shift(spec.verb);
+        len = shift == 0 ? format_count_digits(field->digits) : format_count_radix_digits(field->digits, shift);
+    } else {
+        switch(hole->kind) {
+            case FormatKindFloat32:
+            case FormatKindFloat64:
+                if(signbit(arg.f) || spec.plus)
+                    field->flags |= FORMAT_SIGN | (signbit(arg.f) ? FORMAT_NEGATIVE : 0);
+                len = format_measure_float(spec, arg.f, hole->kind == FormatKindFloat32, field);
+                if(field->flags & FORMAT_SLOW) {
+                    field->len = cast(UInt64)format_snprintf(null, 0, spec, arg.f);
+                    field->pad = 0;
+                    return field->len;
+                }
+                break;
+            case FormatKindBool: len = arg.i ? 4 : 5; break;
+            case FormatKindRune: len = format_rune_len(arg.i); chars = 1; break;
+            default:
+                len = arg.s.len;
+                chars = spec.width > 0 ? format_count_chars(arg.s.data, arg.s.len) : len;
+                break;
+        }
+    }
+    if(field->flags & FORMAT_SIGN)
+        len++;
+    if(chars == 0)
+        chars = len;
+    field->len = len;
+    field->pad = spec.width > chars ? spec.width - chars : 0;
+    return len + field->pad;
+}
+
+static char* format_write_field(char* out, const FormatHole* hole, FormatArg arg, const FormatField* field) {
+    FormatSpec spec = hole->spec;
+    if(field->flags & FORMAT_SLOW) {
+        // The nul lands on the next byte, which is always written after this one
+        format_snprintf(out, field->len + 1, spec, arg.f);
+        return out + field->len;
+    }
+
+    bool is_number = !(field->flags & FORMAT_SPECIAL) && (format_is_integer(hole) || hole->kind == FormatKindFloat32 ||
+                                                          hole->kind == FormatKindFloat64);
+    bool zero_pad = spec.zero && !spec.left && is_number;
+    if(!spec.left && !zero_pad) {
+        memset(out, ' ', field->pad);
+        out += field->pad;
+    }
+    if(field->flags & FORMAT_SIGN)
+        *out++ = (field->flags & FORMAT_NEGATIVE) ? '-' : '+';
+    if(zero_pad) {
+        memset(out, '0', field->pad);
+        out += field->pad;
+    }
+
+    if(format_is_integer(hole)) {
+        UInt32 shift = format_radix_shift(spec.verb);
+        UInt64 n = field->len - ((field->flags & FORMAT_SIGN) != 0);
+        if(shift == 0)
+            format_write_digits(field->digits, out, cast(UInt32)n);
+        else
+            format_write_radix_digits(field->digits, out, cast(UInt32)n, shift, spec.verb == 'X');
+        out += n;
+    } else {
+        switch(hole->kind) {
+            case FormatKindFloat32:
+            case FormatKindFloat64: out = format_write_float(out, spec, arg.f, field); break;
+            case FormatKindBool: {
+                UInt64 len = arg.i ? 4 : 5;
+                memcpy(out, format_bool_str(arg.i), len);
+                out += len;
+                break;
+            }
+            case FormatKindRune: out = format_write_rune(out, arg.i); break;
+            default:
+                memcpy(out, arg.s.data, arg.s.len);
+                out += arg.s.len;
+                break;
+        }
+    }
+
+    if(spec.left) {
+        memset(out, ' ', field->pad);
+        out += field->pad;
+    }
+    return out;
+}
+
+UInt64 format_length(const Format* format, const FormatArg* args, FormatField* fields) {
+    UInt64 len = format->text_len;
+    for(UInt32 i = 0; i < format->num_holes; i++)
+        len += format_measure(&format->holes[i], args[i], &fields[i]);
+    return len;
+}
+
+void format_write(const Format* format, const FormatArg* args, const FormatField* fields, char* out) {
+    UInt64 at = 0;
+    for(UInt32 i = 0; i < format->num_holes; i++) {
+        const FormatHole* hole = &format->holes[i];
+        memcpy(out, format->text + at, hole->text_end - at);
+        out += hole->text_end - at;
+        at = hole->text_end;
+        out = format_write_field(out, hole, args[i], &fields[i]);
+    }
+    memcpy(out, format->text + at, format->text_len - at);
+    out[format->text_len - at] = nullchar;
+}
+
+static UInt32 format_float_default(double x, bool is_float32, char* out) {
+    FormatHole hole = {0};
+    hole.kind = is_float32 ? FormatKindFloat32 : FormatKindFloat64;
+    hole.spec.precision = -1;
+    FormatArg arg;
+    arg.f = x;
+    FormatField field;
+    format_measure(&hole, arg, &field);
+    return cast(UInt32)(format_write_field(out, &hole, arg, &field) - out);
+}
+
+UInt32 format_float64(double x, char* out) {
+    return format_float_default(x, false, out);
+}
+
+UInt32 format_float32(float x, char* out) {
+    return format_float_default(cast(double)x, true, out);
+}
+
+// Templates --------------------------------------------------------------------------------------------------------
+
+Format* format_new() {
+    Format* format = cast(Format*)calloc(1, sizeof(Format));
+    CORETEN_ENFORCE_NN(format, "Could not allocate memory. Memory full.");
+    // Never null, so `format_write()` can copy from it even when there's no text
+    format->text = cast(char*)calloc(1, 1);
+    CORETEN_ENFORCE_NN(format->text, "Could not allocate memory. Memory full.");
+    return format;
+}
+
+void format_free(Format* format) {
+    if(NONE(format))
+        return;
+    free(format->text);
+    free(format->holes);
+    free(format);
+}
+
+void format_add_text(Format* format, const char* text, UInt64 len) {
+    if(len == 0)
+        return;
+    char* grown = cast(char*)realloc(format->text, format->text_len + len + 1);
+    CORETEN_ENFORCE_NN(grown, "Could not allocate memory. Memory full.");
+    memcpy(grown + format->text_len, text, len);
+    format->text = grown;
+    format->text_len += len;
+    format->text[format->text_len] = nullchar;
+}
+
+void format_add_hole(Format* format, FormatKind kind, FormatSpec spec) {
+    if(format->num_holes == format->cap_holes) {
+        UInt32 cap = format->cap_holes == 0 ? 4 : 2 * format->cap_holes;
+        FormatHole* grown = cast(FormatHole*)realloc(format->holes, cap * sizeof(FormatHole));
+        CORETEN_ENFORCE_NN(grown, "Could not allocate memory. Memory full.");
+        format->holes = grown;
+        format->cap_holes = cap;
+    }
+    FormatHole* hole = &format->holes[format->num_holes++];
+    hole->text_end = format->text_len;
+    hole->kind = kind;
+    hole->spec = spec;
+}
+
+// Specs ------------------------------------------------------------------------------------------------------------
+
+static inline bool format_is_space(char ch) {
+    return ch == ' ' || ch == '\t';
+}
+
+bool format_parse_spec(const char* spec, UInt64 len, FormatSpec* out) {
+    FormatSpec result = {0};
+    result.precision = -1;
+    UInt64 i = 0;
+    while(i < len && format_is_space(spec[i]))
+        i++;
+    while(len > i && format_is_space(spec[len - 1]))
+        len--;
+
+    for(; i < len; i++) {
+        if(spec[i] == '-')
+            result.left = true;
+        else if(spec[i] == '+')
+            result.plus = true;
+        else if(spec[i] == '0')
+            result.zero = true;
+        else
+            break;
+    }
+    UInt32 width = 0;
+    for(; i < len && spec[i] >= '0' && spec[i] <= '9'; i++) {
+        width = width * 10 + cast(UInt32)(spec[i] - '0');
+        if(width > FORMAT_MAX_WIDTH)
+            return false;
+    }
+    result.width = cast(UInt16)width;
+    if(i < len && spec[i] == '.') {
+        i++;
+        if(i == len || spec[i] < '0' || spec[i] > '9')
+            return false;
+        Int32 precision = 0;
+        for(; i < len && spec[i] >= '0' && spec[i] <= '9'; i++) {
+            precision = precision * 10 + (spec[i] - '0');
+            if(precision > FORMAT_MAX_PRECISION)
+                return false;
+        }
+        result.precision = cast(Int16)precision;
+    }
+    if(i < len) {
+        if(strchr("dxXobfecs", spec[i]) == null)
+            return false;
+        result.verb = spec[i++];
+    }
+    if(i != len)
+        return false;
+    *out = result;
+    return true;
+}
+
+bool format_spec_accepts(FormatSpec spec, FormatKind kind) {
+    bool is_int_verb = spec.verb == 0 || strchr("dxXob", spec.verb) != null;
+    switch(kind) {
+        case FormatKindInt:
+        case FormatKindUInt:
+            return is_int_verb && spec.precision < 0;
+        case FormatKindFloat32:
+        case FormatKindFloat64:
+            // A precision needs to say which notation it's for
+            return spec.verb == 0 ? spec.precision < 0 : spec.verb == 'f' || spec.verb == 'e';
+        case FormatKindRune:
+            if(spec.verb == 0 || spec.verb == 'c')
+                return spec.precision < 0 && !spec.plus && !spec.zero;
+            return is_int_verb && spec.precision < 0;
+        case FormatKindBool:
+        case FormatKindString:
+            return (spec.verb == 0 || spec.verb == 's') && spec.precision < 0 && !spec.plus && !spec.zero;
+    }
+    return false;
+}
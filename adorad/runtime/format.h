@@ -0,0 +1,129 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+
+#ifndef ADORAD_RUNTIME_FORMAT_H
+#define ADORAD_RUNTIME_FORMAT_H
+
+#include <adorad/core/types.h>
+
+/*
+    Formatting numbers, and the strings `f"..."` literals build out of them.
+
+    Numbers are written straight into their final place, without `snprintf()`:
+        - Integers: the number of digits is worked out first (from the number of bits), then the digits are written
+          from the last one back, two at a time (out of a table of the 100 pairs).
+        - Floats: in the fewest digits that read back as the same value, in the precision of their type (a `Float32`
+          `0.1` is `0.1`). The digits come from Ryu ("Ryu: Fast Float-to-String Conversion", Adams, PLDI 2018): the
+          bounds of the interval of numbers that round to the float are multiplied by a 128-bit power of 5 (see
+          <adorad/runtime/format_tables.h>), and digits are dropped from all three as long as the bounds still differ.
+          `f` with a precision is exact (the float times `10^precision`, rounded half to even, in 128 bits), and so is
+          `e` (the shortest digits, rounded - which is the same as rounding the exact value, except when they end in a
+          single `5`). What these don't cover (huge numbers with `f`, and ties with `e`) goes through `snprintf()`.
+    Without a spec, a float is written like `1.5`, `100.0`, `1e+16` or `2.5e-07`: in scientific notation when its
+    exponent is below -4 or above 15. `nan`, `inf` and `-inf` are the same whatever the spec.
+
+    A `Format` is the template of a format string: all of its literal text (known at compile time), and for every
+    hole the kind of value that goes there and how to write it (`FormatSpec`, parsed from the `{value:spec}` of the
+    literal). Building the string takes two passes: `format_length()` works out every field (the digits of a float
+    are generated once, into a `FormatField`) and the length of the result, so it can be allocated in one go, and
+    `format_write()` writes the text and the fields into it.
+*/
+
+// Largest width and precision of a spec
+#define FORMAT_MAX_WIDTH        1024
+#define FORMAT_MAX_PRECISION    64
+
+// The value of a hole. `Int`s of every width are passed as `Int64`s (and unsigned ones as `UInt64`s).
+typedef enum FormatKind {
+    FormatKindInt,
+    FormatKindUInt,
+    FormatKindFloat32,
+    FormatKindFloat64,
+    FormatKindBool,
+    FormatKindRune,
+    FormatKindString,
+} FormatKind;
+
+// `[flags][width][.precision][verb]`. Flags are `-` (pad on the right), `+` (a sign for positive numbers too) and `0`
+// (pad numbers with zeroes, after the sign).
+// Verbs: `d`, `x`, `X`, `o`, `b` for integers (and runes), `f`, `e` for floats, `s` for strings and `Bool`s, and `c`
+// for runes. Without one, every kind is written the obvious way (in decimal, for integers).
+typedef struct FormatSpec {
+    UInt16 width;       // in characters (0: no padding)
+    Int16 precision;    // digits after the point (-1 if there isn't one)
+    char verb;          // 0 if there isn't one
+    bool left;
+    bool plus;
+    bool zero;
+} FormatSpec;
+
+typedef struct FormatHole {
+    UInt64 text_end;    // where the literal text before the hole ends, in `Format.text`
+    FormatKind kind;
+    FormatSpec spec;
+} FormatHole;
+
+typedef struct Format {
+    char* text;         // all of the literal text (the pieces between the holes, one after the other)
+    UInt64 text_len;
+    FormatHole* holes;
+    UInt32 num_holes;
+    UInt32 cap_holes;
+} Format;
+
+typedef union FormatArg {
+    Int64 i;            // integers, `Bool`s and runes
+    UInt64 u;
+    double f;           // `Float32`s too
+    struct {
+        const char* data;
+        UInt64 len;
+    } s;
+} FormatArg;
+
+// What `format_length()` worked out about a hole, for `format_write()`
+typedef struct FormatField {
+    UInt64 digits;      // the magnitude of an integer, or the decimal digits of a float
+    Int32 exponent;     // of a float: its value is `digits * 10^exponent`
+    UInt32 flags;
+    UInt64 len;         // of the field, without the padding
+    UInt64 pad;         // characters of padding
+} FormatField;
+
+Format* format_new();
+void format_free(Format* format);
+// Append literal text (whose escape sequences, if any, have already been resolved)
+void format_add_text(Format* format, const char* text, UInt64 len);
+void format_add_hole(Format* format, FormatKind kind, FormatSpec spec);
+
+// Parse `spec` (without the `:`). Whitespace around it is ignored. Returns false if it isn't a valid spec.
+bool format_parse_spec(const char* spec, UInt64 len, FormatSpec* out);
+// Can a value of kind `kind` be written with `spec`?
+bool format_spec_accepts(FormatSpec spec, FormatKind kind);
+
+// The length of `format` with `args` (one per hole). `fields` needs room for one `FormatField` per hole.
+UInt64 format_length(const Format* format, const FormatArg* args, FormatField* fields);
+// Write `format` with `args` (and the `fields` `format_length()` filled in) to `out`, which needs room for the length
+// `format_length()` returned plus a nul (which is written too)
+void format_write(const Format* format, const FormatArg* args, const FormatField* fields, char* out);
+
+// Write `x` in decimal, and return the number of bytes written (at most 20, plus the sign)
+UInt32 format_int(Int64 x, char* out);
+UInt32 format_uint(UInt64 x, char* out);
+// Write `x` in the fewest digits that read back as the same `Float64` (or `Float32`), like a hole without a spec. At
+// most 25 bytes are written. Returns the number of bytes written.
+UInt32 format_float64(double x, char* out);
+UInt32 format_float32(float x, char* out);
+
+#endif // ADORAD_RUNTIME_FORMAT_H
@@ -0,0 +1,624 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+
+#include <math.h>
+#include <adorad/core/cpu.h>
+#include <adorad/core/debug.h>
+#include <adorad/core/misc.h>
+#include <adorad/runtime/hypercomplex.h>
+#include <adorad/runtime/vmath.h>
+
+#if defined(CORETEN_SIMD_X86_DISPATCH) && defined(CORETEN_SIMD_SSE2)
+    #include <immintrin.h>
+    #define HYPER_HAVE_X86      1
+#endif // CORETEN_SIMD_X86_DISPATCH
+
+// Elements of every tensor a batch operation works on at a time (gathered into a buffer, if it isn't contiguous)
+#define HYPER_CHUNK         256
+// The most tensors an operation takes (`slerp`: 8 arguments, and 4 results)
+#define HYPER_MAX_TENSORS   12
+
+/*
+    The operations the kernels are written in, for every instruction set (`P`): `V` is a vector of `W` floats, and `M`
+    a mask (of lanes, from comparisons). `SELECT(m, a, b)` is `a` where `m` is set, and `b` elsewhere. `MAX` and `MIN`
+    return their second argument if either is a NaN (like `maxps`), so that every kernel gives the same results.
+*/
+#define HYPER_NONE_F32_V                Float32
+#define HYPER_NONE_F32_M                bool
+#define HYPER_NONE_F32_W                1
+#define HYPER_NONE_F32_LOAD(p)          (*(p))
+#define HYPER_NONE_F32_STORE(p, v)      (*(p) = (v))
+#define HYPER_NONE_F32_SET1(x)          cast(Float32)(x)
+#define HYPER_NONE_F32_ADD(a, b)        ((a) + (b))
+#define HYPER_NONE_F32_SUB(a, b)        ((a) - (b))
+#define HYPER_NONE_F32_MUL(a, b)        ((a) * (b))
+#define HYPER_NONE_F32_DIV(a, b)        ((a) / (b))
+#define HYPER_NONE_F32_SQRT             sqrtf
+#define HYPER_NONE_F32_ABS              fabsf
+#define HYPER_NONE_F32_MAX(a, b)        ((a) > (b) ? (a) : (b))
+#define HYPER_NONE_F32_MIN(a, b)        ((a) < (b) ? (a) : (b))
+#define HYPER_NONE_F32_LT(a, b)         ((a) < (b))
+#define HYPER_NONE_F32_EQ(a, b)         ((a) == (b))
+#define HYPER_NONE_F32_UNORD(a, b)      ((a) != (a) || (b) != (b))
+#define HYPER_NONE_F32_MOR(a, b)        ((a) || (b))
+#define HYPER_NONE_F32_SELECT(m, a, b)  ((m) ? (a) : (b))
+
+#define HYPER_NONE_F64_V                Float64
+#define HYPER_NONE_F64_M                bool
+#define HYPER_NONE_F64_W                1
+#define HYPER_NONE_F64_LOAD(p)          (*(p))
+#define HYPER_NONE_F64_STORE(p, v)      (*(p) = (v))
+#define HYPER_NONE_F64_SET1(x)          cast(Float64)(x)
+#define HYPER_NONE_F64_ADD(a, b)        ((a) + (b))
+#define HYPER_NONE_F64_SUB(a, b)        ((a) - (b))
+#define HYPER_NONE_F64_MUL(a, b)        ((a) * (b))
+#define HYPER_NONE_F64_DIV(a, b)        ((a) / (b))
+#define HYPER_NONE_F64_SQRT             sqrt
+#define HYPER_NONE_F64_ABS              fabs
+#define HYPER_NONE_F64_MAX(a, b)        ((a) > (b) ? (a) : (b))
+#define HYPER_NONE_F64_MIN(a, b)        ((a) < (b) ? (a) : (b))
+#define HYPER_NONE_F64_LT(a, b)         ((a) < (b))
+#define HYPER_NONE_F64_EQ(a, b)         ((a) == (b))
+#define HYPER_NONE_F64_UNORD(a, b)      ((a) != (a) || (b) != (b))
+#define HYPER_NONE_F64_MOR(a, b)        ((a) || (b))
+#define HYPER_NONE_F64_SELECT(m, a, b)  ((m) ? (a) : (b))
+
+#if defined(HYPER_HAVE_X86)
+    #define HYPER_AVX2                  CORETEN_TARGET("avx2")
+    #define HYPER_AVX512                CORETEN_TARGET("avx512f")
+
+    #define HYPER_AVX2_F32_V            __m256
+    #define HYPER_AVX2_F32_M            __m256
+    #define HYPER_AVX2_F32_W            8
+    #define HYPER_AVX2_F32_LOAD         _mm256_loadu_ps
+    #define HYPER_AVX2_F32_STORE        _mm256_storeu_ps
+    #define HYPER_AVX2_F32_SET1         _mm256_set1_ps
+    #define HYPER_AVX2_F32_ADD          _mm256_add_ps
+    #define HYPER_AVX2_F32_SUB          _mm256_sub_ps
+    #define HYPER_AVX2_F32_MUL          _mm256_mul_ps
+    #define HYPER_AVX2_F32_DIV          _mm256_div_ps
+    #define HYPER_AVX2_F32_SQRT         _mm256_sqrt_ps
+    #define HYPER_AVX2_F32_ABS(v)       _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v)
+    #define HYPER_AVX2_F32_MAX          _mm256_max_ps
+    #define HYPER_AVX2_F32_MIN          _mm256_min_ps
+    #define HYPER_AVX2_F32_LT(a, b)     _mm256_cmp_ps(a, b, _CMP_LT_OQ)
+    #define HYPER_AVX2_F32_EQ(a, b)     _mm256_cmp_ps(a, b, _CMP_EQ_OQ)
+    #define HYPER_AVX2_F32_UNORD(a, b)  _mm256_cmp_ps(a, b, _CMP_UNORD_Q)
+    #define HYPER_AVX2_F32_MOR          _mm256_or_ps
+    #define HYPER_AVX2_F32_SELECT(m, a, b)  _mm256_blendv_ps(b, a, m)
+
+    #define HYPER_AVX2_F64_V            __m256d
+    #define HYPER_AVX2_F64_M            __m256d
+    #define HYPER_AVX2_F64_W            4
+    #define HYPER_AVX2_F64_LOAD         _mm256_loadu_pd
+    #define HYPER_AVX2_F64_STORE        _mm256_storeu_pd
+    #define HYPER_AVX2_F64_SET1         _mm256_set1_pd
+    #define HYPER_AVX2_F64_ADD          _mm256_add_pd
+    #define HYPER_AVX2_F64_SUB          _mm256_sub_pd
+    #define HYPER_AVX2_F64_MUL          _mm256_mul_pd
+    #define HYPER_AVX2_F64_DIV          _mm256_div_pd
+    #define HYPER_AVX2_F64_SQRT         _mm256_sqrt_pd
+    #define HYPER_AVX2_F64_ABS(v)       _mm256_andnot_pd(_mm256_set1_pd(-0.0), v)
+    #define HYPER_AVX2_F64_MAX          _mm256_max_pd
+    #define HYPER_AVX2_F64_MIN          _mm256_min_pd
+    #define HYPER_AVX2_F64_LT(a, b)     _mm256_cmp_pd(a, b, _CMP_LT_OQ)
+    #define HYPER_AVX2_F64_EQ(a, b)     _mm256_cmp_pd(a, b, _CMP_EQ_OQ)
+    #define HYPER_AVX2_F64_UNORD(a, b)  _mm256_cmp_pd(a, b, _CMP_UNORD_Q)
+    #define HYPER_AVX2_F64_MOR          _mm256_or_pd
+    #define HYPER_AVX2_F64_SELECT(m, a, b)  _mm256_blendv_pd(b, a, m)
+
+    #define HYPER_AVX512_F32_V          __m512
+    #define HYPER_AVX512_F32_M          __mmask16
+    #define HYPER_AVX512_F32_W          16
+    #define HYPER_AVX512_F32_LOAD       _mm512_loadu_ps
+    #define HYPER_AVX512_F32_STORE      _mm512_storeu_ps
+    #define HYPER_AVX512_F32_SET1       _mm512_set1_ps
+    #define HYPER_AVX512_F32_ADD        _mm512_add_ps
+    #define HYPER_AVX512_F32_SUB        _mm512_sub_ps
+    #define HYPER_AVX512_F32_MUL        _mm512_mul_ps
+    #define HYPER_AVX512_F32_DIV        _mm512_div_ps
+    #define HYPER_AVX512_F32_SQRT       _mm512_sqrt_ps
+    #define HYPER_AVX512_F32_ABS        _mm512_abs_ps
+    #define HYPER_AVX512_F32_MAX        _mm512_max_ps
+    #define HYPER_AVX512_F32_MIN        _mm512_min_ps
+    #define HYPER_AVX512_F32_LT(a, b)   _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ)
+    #define HYPER_AVX512_F32_EQ(a, b)   _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ)
+    #define HYPER_AVX512_F32_UNORD(a, b)    _mm512_cmp_ps_mask(a, b, _CMP_UNORD_Q)
+    #define HYPER_AVX512_F32_MOR(a, b)      cast(__mmask16)((a) | (b))
+    #define HYPER_AVX512_F32_SELECT(m, a, b)    _mm512_mask_blend_ps(m, b, a)
+
+    #define HYPER_AVX512_F64_V          __m512d
+    #define HYPER_AVX512_F64_M          __mmask8
+    #define HYPER_AVX512_F64_W          8
+    #define HYPER_AVX512_F64_LOAD       _mm512_loadu_pd
+    #define HYPER_AVX512_F64_STORE      _mm512_storeu_pd
+    #define HYPER_AVX512_F64_SET1       _mm512_set1_pd
+    #define HYPER_AVX512_F64_ADD        _mm512_add_pd
+    #define HYPER_AVX512_F64_SUB        _mm512_sub_pd
+    #define HYPER_AVX512_F64_MUL        _mm512_mul_pd
+    #define HYPER_AVX512_F64_DIV        _mm512_div_pd
+    #define HYPER_AVX512_F64_SQRT       _mm512_sqrt_pd
+    #define HYPER_AVX512_F64_ABS        _mm512_abs_pd
+    #define HYPER_AVX512_F64_MAX        _mm512_max_pd
+    #define HYPER_AVX512_F64_MIN        _mm512_min_pd
+    #define HYPER_AVX512_F64_LT(a, b)   _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ)
+    #define HYPER_AVX512_F64_EQ(a, b)   _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ)
+    #define HYPER_AVX512_F64_UNORD(a, b)    _mm512_cmp_pd_mask(a, b, _CMP_UNORD_Q)
+    #define HYPER_AVX512_F64_MOR(a, b)      cast(__mmask8)((a) | (b))
+    #define HYPER_AVX512_F64_SELECT(m, a, b)    _mm512_mask_blend_pd(m, b, a)
+#endif // HYPER_HAVE_X86
+
+/*
+    A kernel computes `n` elements of an operation: `s` are the parts of its arguments, and `d` the parts of its
+    results (arrays of `n` floats each; `d[j]` can be `s[k]`). `t` is `slerp`'s parameter.
+*/
+typedef void (*HyperKernel)(void* const* d, const void* const* s, UInt64 n, Float64 t);
+
+// Element `i` of argument `j` / result `j`, in a kernel
+#define HYPER_IN(T, j)          (cast(const T*)s[j] + i)
+#define HYPER_OUT(T, j)         (cast(T*)d[j] + i)
+// `a * b + c * d` and `a * b - c * d`
+#define HYPER_DOT2(P, a, b, c, d)       P##_ADD(P##_MUL(a, b), P##_MUL(c, d))
+#define HYPER_CROSS2(P, a, b, c, d)     P##_SUB(P##_MUL(a, b), P##_MUL(c, d))
+// The last `n - i` elements (fewer than fit in a vector) go through the scalar kernel
+#define HYPER_TAIL(OP, SFX, T, ND, NS)                                                                          \
+    if(i < n) {                                                                                                 \
+        void* dt[ND];                                                                                           \
+        const void* st[NS];                                                                                     \
+        for(int j = 0; j < ND; j++)                                                                             \
+            dt[j] = cast(T*)d[j] + i;                                                                           \
+        for(int j = 0; j < NS; j++)                                                                             \
+            st[j] = cast(const T*)s[j] + i;                                                                     \
+        hyper_##OP##_##SFX##_scalar(dt, st, n - i, t);                                                          \
+    }
+
+/*
+    The kernels, for every instruction set. `exp` and `slerp` compute their sines (and cosines, and arctangents) with
+    <adorad/runtime/vmath.h>, into buffers (of at most `HYPER_CHUNK` elements), and the rest with the kernels before
+    them:
+        - `div()` scales the divisor by its largest part first (so that its squared norm doesn't overflow).
+        - `abs()` is `hi * sqrt(1 + (lo/hi)^2)`, where `hi` and `lo` are the larger and smaller parts (like `hypot`).
+        - `rotate()` is `v + w * t + u x t`, where `u` is `(x, y, z)` of `q` and `t = 2 * (u x v)` (which is `q v q*`,
+          for unit quaternions).
+        - `slerp()` finds the angle `theta` between `a` and `b` as `2 * atan2(|a - b|, |a + b|)` (accurate when they're
+          close, unlike `acos(a . b)`), and blends them with `sin((1 - t) * theta) / sin(theta)` and
+          `sin(t * theta) / sin(theta)` (or `1 - t` and `t`, if `theta` is 0). `b` is negated first, if `a . b < 0`.
+*/
+#define HYPER_KERNELS(ISA, TARGET, SFX, T, P)                                                                   \
+    TARGET static void hyper_cmul_##SFX##_##ISA(void* const* d, const void* const* s, UInt64 n, Float64 t) {    \
+        UInt64 i = 0;                                                                                           \
+        for(; i + P##_W <= n; i += P##_W) {                                                                     \
+            P##_V ar = P##_LOAD(HYPER_IN(T, 0));                                                                \
+            P##_V ai = P##_LOAD(HYPER_IN(T, 1));                                                                \
+            P##_V br = P##_LOAD(HYPER_IN(T, 2));                                                                \
+            P##_V bi = P##_LOAD(HYPER_IN(T, 3));                                                                \
+            P##_STORE(HYPER_OUT(T, 0), HYPER_CROSS2(P, ar, br, ai, bi));                                        \
+            P##_STORE(HYPER_OUT(T, 1), HYPER_DOT2(P, ar, bi, ai, br));                                          \
+        }                                                                                                       \
+        HYPER_TAIL(cmul, SFX, T, 2, 4)                                                                          \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static void hyper_cdiv_##SFX##_##ISA(void* const* d, const void* const* s, UInt64 n, Float64 t) {    \
+        UInt64 i = 0;                                                                                           \
+        for(; i + P##_W <= n; i += P##_W) {                                                                     \
+            P##_V ar = P##_LOAD(HYPER_IN(T, 0));                                                                \
+            P##_V ai = P##_LOAD(HYPER_IN(T, 1));                                                                \
+            P##_V br = P##_LOAD(HYPER_IN(T, 2));                                                                \
+            P##_V bi = P##_LOAD(HYPER_IN(T, 3));                                                                \
+            P##_V scale = P##_MAX(P##_ABS(br), P##_ABS(bi));                                                    \
+            P##_V cr = P##_DIV(br, scale);                                                                      \
+            P##_V ci = P##_DIV(bi, scale);                                                                      \
+            P##_V den = P##_MUL(HYPER_DOT2(P, cr, cr, ci, ci), scale);                                          \
+            P##_V re = P##_DIV(HYPER_DOT2(P, ar, cr, ai, ci), den);                                             \
+            P##_V im = P##_DIV(HYPER_CROSS2(P, ai, cr, ar, ci), den);                                           \
+            P##_M zero = P##_EQ(scale, P##_SET1(0.0));                                                          \
+            P##_STORE(HYPER_OUT(T, 0), P##_SELECT(zero, P##_DIV(ar, scale), re));                               \
+            P##_STORE(HYPER_OUT(T, 1), P##_SELECT(zero, P##_DIV(ai, scale), im));                               \
+        }                                                                                                       \
+        HYPER_TAIL(cdiv, SFX, T, 2, 4)                                                                          \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static void hyper_cabs_##SFX##_##ISA(void* const* d, const void* const* s, UInt64 n, Float64 t) {    \
+        UInt64 i = 0;                                                                                           \
+        for(; i + P##_W <= n; i += P##_W) {                                                                     \
+            P##_V re = P##_LOAD(HYPER_IN(T, 0));                                                                \
+            P##_V im = P##_LOAD(HYPER_IN(T, 1));                                                                \
+            P##_V are = P##_ABS(re);                                                                            \
+            P##_V aim = P##_ABS(im);                                                                            \
+            P##_V hi = P##_MAX(are, aim);                                                                       \
+            P##_V r = P##_DIV(P##_MIN(are, aim), hi);                                                           \
+            P##_V v = P##_MUL(hi, P##_SQRT(P##_ADD(P##_SET1(1.0), P##_MUL(r, r))));                             \
+            v = P##_SELECT(P##_EQ(hi, P##_SET1(0.0)), P##_SET1(0.0), v);                                        \
+            v = P##_SELECT(P##_UNORD(re, im), P##_ADD(re, im), v);                                              \
+            P##_M inf = P##_MOR(P##_EQ(are, P##_SET1(INFINITY)), P##_EQ(aim, P##_SET1(INFINITY)));              \
+            P##_STORE(HYPER_OUT(T, 0), P##_SELECT(inf, P##_SET1(INFINITY), v));                                 \
+        }                                                                                                       \
+        HYPER_TAIL(cabs, SFX, T, 1, 2)                                                                          \
+    }                                                                                                           \
+                                                                                                                \
+    /* `(e * c, e * s)`, from `e^re`, `cos(im)`, `sin(im)` and `im` (which is kept if it's zero) */             \
+    TARGET static void hyper_cscale_##SFX##_##ISA(void* const* d, const void* const* s, UInt64 n, Float64 t) {  \
+        UInt64 i = 0;                                                                                           \
+        for(; i + P##_W <= n; i += P##_W) {                                                                     \
+            P##_V e = P##_LOAD(HYPER_IN(T, 0));                                                                 \
+            P##_V c = P##_LOAD(HYPER_IN(T, 1));                                                                 \
+            P##_V sn = P##_LOAD(HYPER_IN(T, 2));                                                                \
+            P##_V im = P##_LOAD(HYPER_IN(T, 3));                                                                \
+            P##_STORE(HYPER_OUT(T, 0), P##_MUL(e, c));                                                          \
+            P##_STORE(HYPER_OUT(T, 1), P##_SELECT(P##_EQ(im, P##_SET1(0.0)), im, P##_MUL(e, sn)));              \
+        }                                                                                                       \
+        HYPER_TAIL(cscale, SFX, T, 2, 4)                                                                        \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static void hyper_cexp_##SFX##_##ISA(void* const* d, const void* const* s, UInt64 n, Float64 t) {    \
+        T e[HYPER_CHUNK];                                                                                       \
+        T c[HYPER_CHUNK];                                                                                       \
+        T sn[HYPER_CHUNK];                                                                                      \
+        vmath_##SFX(TensorMathExp, e, cast(const T*)s[0], null, n);                                             \
+        vmath_##SFX(TensorMathCos, c, cast(const T*)s[1], null, n);                                             \
+        vmath_##SFX(TensorMathSin, sn, cast(const T*)s[1], null, n);                                            \
+        const void* args[] = { e, c, sn, s[1] };                                                                \
+        hyper_cscale_##SFX##_##ISA(d, args, n, t);                                                              \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static void hyper_qmul_##SFX##_##ISA(void* const* d, const void* const* s, UInt64 n, Float64 t) {    \
+        UInt64 i = 0;                                                                                           \
+        for(; i + P##_W <= n; i += P##_W) {                                                                     \
+            P##_V aw = P##_LOAD(HYPER_IN(T, 0));                                                                \
+            P##_V ax = P##_LOAD(HYPER_IN(T, 1));                                                                \
+            P##_V ay = P##_LOAD(HYPER_IN(T, 2));                                                                \
+            P##_V az = P##_LOAD(HYPER_IN(T, 3));                                                                \
+            P##_V bw = P##_LOAD(HYPER_IN(T, 4));                                                                \
+            P##_V bx = P##_LOAD(HYPER_IN(T, 5));                                                                \
+            P##_V by = P##_LOAD(HYPER_IN(T, 6));                                                                \
+            P##_V bz = P##_LOAD(HYPER_IN(T, 7));                                                                \
+            P##_V w = P##_SUB(HYPER_CROSS2(P, aw, bw, ax, bx), HYPER_DOT2(P, ay, by, az, bz));                  \
+            P##_V x = P##_ADD(HYPER_DOT2(P, aw, bx, ax, bw), HYPER_CROSS2(P, ay, bz, az, by));                  \
+            P##_V y = P##_ADD(HYPER_CROSS2(P, aw, by, ax, bz), HYPER_DOT2(P, ay, bw, az, bx));                  \
+            P##_V z = P##_ADD(HYPER_CROSS2(P, aw, bz, ay, bx), HYPER_DOT2(P, ax, by, az, bw));                  \
+            P##_STORE(HYPER_OUT(T, 0), w);                                                                      \
+            P##_STORE(HYPER_OUT(T, 1), x);                                                                      \
+            P##_STORE(HYPER_OUT(T, 2), y);                                                                      \
+            P##_STORE(HYPER_OUT(T, 3), z);                                                                      \
+        }                                                                                                       \
+        HYPER_TAIL(qmul, SFX, T, 4, 8)                                                                          \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static void hyper_qnormalize_##SFX##_##ISA(void* const* d, const void* const* s, UInt64 n,           \
+                                                      Float64 t) {                                              \
+        UInt64 i = 0;                                                                                           \
+        for(; i + P##_W <= n; i += P##_W) {                                                                     \
+            P##_V w = P##_LOAD(HYPER_IN(T, 0));                                                                 \
+            P##_V x = P##_LOAD(HYPER_IN(T, 1));                                                                 \
+            P##_V y = P##_LOAD(HYPER_IN(T, 2));                                                                 \
+            P##_V z = P##_LOAD(HYPER_IN(T, 3));                                                                 \
+            P##_V norm = P##_SQRT(P##_ADD(HYPER_DOT2(P, w, w, x, x), HYPER_DOT2(P, y, y, z, z)));               \
+            P##_M zero = P##_EQ(norm, P##_SET1(0.0));                                                           \
+            P##_STORE(HYPER_OUT(T, 0), P##_SELECT(zero, w, P##_DIV(w, norm)));                                  \
+            P##_STORE(HYPER_OUT(T, 1), P##_SELECT(zero, x, P##_DIV(x, norm)));                                  \
+            P##_STORE(HYPER_OUT(T, 2), P##_SELECT(zero, y, P##_DIV(y, norm)));                                  \
+            P##_STORE(HYPER_OUT(T, 3), P##_SELECT(zero, z, P##_DIV(z, norm)));                                  \
+        }                                                                                                       \
+        HYPER_TAIL(qnormalize, SFX, T, 4, 4)                                                                    \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static void hyper_qrotate_##SFX##_##ISA(void* const* d, const void* const* s, UInt64 n, Float64 t) { \
+        UInt64 i = 0;                                                                                           \
+        for(; i + P##_W <= n; i += P##_W) {                                                                     \
+            P##_V qw = P##_LOAD(HYPER_IN(T, 0));                                                                \
+            P##_V qx = P##_LOAD(HYPER_IN(T, 1));                                                                \
+            P##_V qy = P##_LOAD(HYPER_IN(T, 2));                                                                \
+            P##_V qz = P##_LOAD(HYPER_IN(T, 3));                                                                \
+            P##_V vx = P##_LOAD(HYPER_IN(T, 4));                                                                \
+            P##_V vy = P##_LOAD(HYPER_IN(T, 5));                                                                \
+            P##_V vz = P##_LOAD(HYPER_IN(T, 6));                                                                \
+            P##_V two = P##_SET1(2.0);                                                                          \
+            P##_V tx = P##_MUL(two, HYPER_CROSS2(P, qy, vz, qz, vy));                                           \
+            P##_V ty = P##_MUL(two, HYPER_CROSS2(P, qz, vx, qx, vz));                                           \
+            P##_V tz = P##_MUL(two, HYPER_CROSS2(P, qx, vy, qy, vx));                                           \
+            P##_STORE(HYPER_OUT(T, 0), P##_ADD(P##_ADD(vx, P##_MUL(qw, tx)), HYPER_CROSS2(P, qy, tz, qz, ty))); \
+            P##_STORE(HYPER_OUT(T, 1), P##_ADD(P##_ADD(vy, P##_MUL(qw, ty)), HYPER_CROSS2(P, qz, tx, qx, tz))); \
+            P##_STORE(HYPER_OUT(T, 2), P##_ADD(P##_ADD(vz, P##_MUL(qw, tz)), HYPER_CROSS2(P, qx, ty, qy, tx))); \
+        }                                                                                                       \
+        HYPER_TAIL(qrotate, SFX, T, 3, 7)                                                                       \
+    }                                                                                                           \
+                                                                                                                \
+    /* The sign `b` gets, and `|a - b|` and `|a + b|` (after it) */                                             \
+    TARGET static void hyper_slerp_prep_##SFX##_##ISA(void* const* d, const void* const* s, UInt64 n,           \
+                                                      Float64 t) {                                              \
+        UInt64 i = 0;                                                                                           \
+        for(; i + P##_W <= n; i += P##_W) {                                                                     \
+            P##_V a[4], b[4];                                                                                   \
+            for(int j = 0; j < 4; j++) {                                                                        \
+                a[j] = P##_LOAD(HYPER_IN(T, j));                                                                \
+                b[j] = P##_LOAD(HYPER_IN(T, j + 4));                                                            \
+            }                                                                                                   \
+            P##_V dot = P##_ADD(HYPER_DOT2(P, a[0], b[0], a[1], b[1]), HYPER_DOT2(P, a[2], b[2], a[3], b[3]));  \
+            P##_V sign = P##_SELECT(P##_LT(dot, P##_SET1(0.0)), P##_SET1(-1.0), P##_SET1(1.0));                 \
+            P##_V diff = P##_SET1(0.0);                                                                         \
+            P##_V sum = P##_SET1(0.0);                                                                          \
+            for(int j = 0; j < 4; j++) {                                                                        \
+                P##_V sb = P##_MUL(sign, b[j]);                                                                 \
+                P##_V dj = P##_SUB(a[j], sb);                                                                   \
+                P##_V sj = P##_ADD(a[j], sb);                                                                   \
+                diff = P##_ADD(diff, P##_MUL(dj, dj));                                                          \
+                sum = P##_ADD(sum, P##_MUL(sj, sj));                                                            \
+            }                                                                                                   \
+            P##_STORE(HYPER_OUT(T, 0), sign);                                                                   \
+            P##_STORE(HYPER_OUT(T, 1), P##_SQRT(diff));                                                         \
+            P##_STORE(HYPER_OUT(T, 2), P##_SQRT(sum));                                                          \
+        }                                                                                                       \
+        HYPER_TAIL(slerp_prep, SFX, T, 3, 8)                                                                    \
+    }                                                                                                           \
+                                                                                                                \
+    /* `a * wa + b * wb`, normalized, from `sign`, `sin((1 - t) * theta)`, `sin(t * theta)` and `sin(theta)` */ \
+    TARGET static void hyper_slerp_blend_##SFX##_##ISA(void* const* d, const void* const* s, UInt64 n,          \
+                                                       Float64 t) {                                             \
+        UInt64 i = 0;                                                                                           \
+        for(; i + P##_W <= n; i += P##_W) {                                                                     \
+            P##_V sign = P##_LOAD(HYPER_IN(T, 8));                                                              \
+            P##_V sa = P##_LOAD(HYPER_IN(T, 9));                                                                \
+            P##_V sb = P##_LOAD(HYPER_IN(T, 10));                                                               \
+            P##_V st = P##_LOAD(HYPER_IN(T, 11));                                                               \
+            P##_M zero = P##_EQ(st, P##_SET1(0.0));                                                             \
+            P##_V wa = P##_SELECT(zero, P##_SET1(1.0 - t), P##_DIV(sa, st));                                    \
+            P##_V wb = P##_MUL(sign, P##_SELECT(zero, P##_SET1(t), P##_DIV(sb, st)));                           \
+            P##_V r[4];                                                                                         \
+            P##_V norm = P##_SET1(0.0);                                                                         \
+            for(int j = 0; j < 4; j++) {                                                                        \
+                r[j] = HYPER_DOT2(P, P##_LOAD(HYPER_IN(T, j)), wa, P##_LOAD(HYPER_IN(T, j + 4)), wb);           \
+                norm = P##_ADD(norm, P##_MUL(r[j], r[j]));                                                      \
+            }                                                                                                   \
+            norm = P##_SQRT(norm);                                                                              \
+            zero = P##_EQ(norm, P##_SET1(0.0));                                                                 \
+            for(int j = 0; j < 4; j++)                                                                          \
+                P##_STORE(HYPER_OUT(T, j), P##_SELECT(zero, r[j], P##_DIV(r[j], norm)));                        \
+        }                                                                                                       \
+        HYPER_TAIL(slerp_blend, SFX, T, 4, 12)                                                                  \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static void hyper_qslerp_##SFX##_##ISA(void* const* d, const void* const* s, UInt64 n, Float64 t) {  \
+        T sign[HYPER_CHUNK];                                                                                    \
+        T diff[HYPER_CHUNK];                                                                                    \
+        T sum[HYPER_CHUNK];                                                                                     \
+        T angles[3 * HYPER_CHUNK];                                                                              \
+        void* prep[] = { sign, diff, sum };                                                                     \
+        hyper_slerp_prep_##SFX##_##ISA(prep, s, n, t);                                                          \
+        /* `diff` becomes `theta / 2`, and `angles` the three angles whose sines `blend()` takes */             \
+        vmath_##SFX(TensorMathAtan2, diff, diff, sum, n);                                                       \
+        for(UInt64 k = 0; k < n; k++) {                                                                         \
+            T theta = 2 * diff[k];                                                                              \
+            angles[k] = cast(T)(1.0 - t) * theta;                                                               \
+            angles[n + k] = cast(T)t * theta;                                                                   \
+            angles[2 * n + k] = theta;                                                                          \
+        }                                                                                                       \
+        vmath_##SFX(TensorMathSin, angles, angles, null, 3 * n);                                                \
+        const void* args[] = { s[0], s[1], s[2], s[3], s[4], s[5], s[6], s[7],                                  \
+                               sign, angles, angles + n, angles + 2 * n };                                      \
+        hyper_slerp_blend_##SFX##_##ISA(d, args, n, t);                                                         \
+    }
+
+HYPER_KERNELS(scalar, , f32, Float32, HYPER_NONE_F32)
+HYPER_KERNELS(scalar, , f64, Float64, HYPER_NONE_F64)
+
+#if defined(HYPER_HAVE_X86)
+    HYPER_KERNELS(avx2, HYPER_AVX2, f32, Float32, HYPER_AVX2_F32)
+    HYPER_KERNELS(avx2, HYPER_AVX2, f64, Float64, HYPER_AVX2_F64)
+    HYPER_KERNELS(avx512, HYPER_AVX512, f32, Float32, HYPER_AVX512_F32)
+    HYPER_KERNELS(avx512, HYPER_AVX512, f64, Float64, HYPER_AVX512_F64)
+#endif // HYPER_HAVE_X86
+
+typedef enum HyperOp {
+    HyperComplexMul,
+    HyperComplexDiv,
+    HyperComplexAbs,
+    HyperComplexExp,
+    HyperQuaternionMul,
+    HyperQuaternionNormalize,
+    HyperQuaternionRotate,
+    HyperQuaternionSlerp,
+    HyperNumOps,
+} HyperOp;
+
+#define HYPER_TABLE(ISA)                                                                                        \
+    {                                                                                                           \
+        { hyper_cmul_f32_##ISA, hyper_cmul_f64_##ISA },                                                         \
+        { hyper_cdiv_f32_##ISA, hyper_cdiv_f64_##ISA },                                                         \
+        { hyper_cabs_f32_##ISA, hyper_cabs_f64_##ISA },                                                         \
+        { hyper_cexp_f32_##ISA, hyper_cexp_f64_##ISA },                                                         \
+        { hyper_qmul_f32_##ISA, hyper_qmul_f64_##ISA },                                                         \
+        { hyper_qnormalize_f32_##ISA, hyper_qnormalize_f64_##ISA },                                             \
+        { hyper_qrotate_f32_##ISA, hyper_qrotate_f64_##ISA },                                                   \
+        { hyper_qslerp_f32_##ISA, hyper_qslerp_f64_##ISA },                                                     \
+    }
+
+// The kernels, by `TensorIsa`, operation, and dtype (Float32, Float64)
+static const HyperKernel hyper_kernels[3][HyperNumOps][2] = {
+    HYPER_TABLE(scalar),
+#if defined(HYPER_HAVE_X86)
+    HYPER_TABLE(avx2),
+    HYPER_TABLE(avx512),
+#else
+    HYPER_TABLE(scalar),
+    HYPER_TABLE(scalar),
+#endif // HYPER_HAVE_X86
+};
+
+// Runs `op` over tensors (`dst` are the parts of its results, and `src` of its arguments), `HYPER_CHUNK` elements at
+// a time. Contiguous tensors are used in place, and the others are gathered into (and scattered from) a buffer.
+static bool hyper_run(HyperOp op, Tensor** dst, int nd, Tensor** src, int ns, Float64 t) {
+    Tensor* first = src[0];
+    for(int j = 0; j < ns; j++)
+        CORETEN_ENFORCE(src[j]->dtype == first->dtype && src[j]->len == first->len, "Tensors don't match");
+    for(int j = 0; j < nd; j++)
+        CORETEN_ENFORCE(dst[j]->dtype == first->dtype && dst[j]->len == first->len, "Tensors don't match");
+    if(!tensor_dtype_is_float(first->dtype))
+        return false;
+
+    bool is_f64 = first->dtype == TensorDTypeFloat64;
+    UInt64 size = tensor_dtype_size(first->dtype);
+    HyperKernel kernel = hyper_kernels[tensor_isa()][op][is_f64];
+    Float64 buffers[HYPER_MAX_TENSORS][HYPER_CHUNK];
+    for(UInt64 i = 0; i < first->len; i += HYPER_CHUNK) {
+        UInt64 n = first->len - i < HYPER_CHUNK ? first->len - i : HYPER_CHUNK;
+        const void* s[HYPER_MAX_TENSORS];
+        void* d[HYPER_MAX_TENSORS];
+        for(int j = 0; j < ns; j++) {
+            if(src[j]->stride == 1) {
+                s[j] = src[j]->data + i * size;
+                continue;
+            }
+            for(UInt64 k = 0; k < n; k++) {
+                Float64 x = tensor_get(src[j], i + k).f;
+                if(is_f64)
+                    buffers[j][k] = x;
+                else
+                    (cast(Float32*)buffers[j])[k] = cast(Float32)x;
+            }
+            s[j] = buffers[j];
+        }
+        for(int j = 0; j < nd; j++)
+            d[j] = dst[j]->stride == 1 ? cast(void*)(dst[j]->data + i * size) : cast(void*)buffers[ns + j];
+
+        kernel(d, s, n, t);
+
+        for(int j = 0; j < nd; j++) {
+            if(dst[j]->stride == 1)
+                continue;
+            for(UInt64 k = 0; k < n; k++) {
+                TensorScalar x;
+                x.f = is_f64 ? (cast(Float64*)d[j])[k] : (cast(Float32*)d[j])[k];
+                tensor_set(dst[j], i + k, x);
+            }
+        }
+    }
+    return true;
+}
+
+bool complex_tensor_mul(ComplexTensor* dst, ComplexTensor* a, ComplexTensor* b) {
+    Tensor* d[] = { dst->re, dst->im };
+    Tensor* s[] = { a->re, a->im, b->re, b->im };
+    return hyper_run(HyperComplexMul, d, 2, s, 4, 0.0);
+}
+
+bool complex_tensor_div(ComplexTensor* dst, ComplexTensor* a, ComplexTensor* b) {
+    Tensor* d[] = { dst->re, dst->im };
+    Tensor* s[] = { a->re, a->im, b->re, b->im };
+    return hyper_run(HyperComplexDiv, d, 2, s, 4, 0.0);
+}
+
+bool complex_tensor_abs(Tensor* dst, ComplexTensor* a) {
+    Tensor* s[] = { a->re, a->im };
+    return hyper_run(HyperComplexAbs, &dst, 1, s, 2, 0.0);
+}
+
+bool complex_tensor_exp(ComplexTensor* dst, ComplexTensor* a) {
+    Tensor* d[] = { dst->re, dst->im };
+    Tensor* s[] = { a->re, a->im };
+    return hyper_run(HyperComplexExp, d, 2, s, 2, 0.0);
+}
+
+bool quaternion_tensor_mul(QuaternionTensor* dst, QuaternionTensor* a, QuaternionTensor* b) {
+    Tensor* d[] = { dst->w, dst->x, dst->y, dst->z };
+    Tensor* s[] = { a->w, a->x, a->y, a->z, b->w, b->x, b->y, b->z };
+    return hyper_run(HyperQuaternionMul, d, 4, s, 8, 0.0);
+}
+
+bool quaternion_tensor_normalize(QuaternionTensor* dst, QuaternionTensor* q) {
+    Tensor* d[] = { dst->w, dst->x, dst->y, dst->z };
+    Tensor* s[] = { q->w, q->x, q->y, q->z };
+    return hyper_run(HyperQuaternionNormalize, d, 4, s, 4, 0.0);
+}
+
+bool quaternion_tensor_rotate(QuaternionTensor* dst, QuaternionTensor* q, QuaternionTensor* v) {
+    Tensor* d[] = { dst->x, dst->y, dst->z };
+    Tensor* s[] = { q->w, q->x, q->y, q->z, v->x, v->y, v->z };
+    return hyper_run(HyperQuaternionRotate, d, 3, s, 7, 0.0);
+}
+
+bool quaternion_tensor_slerp(QuaternionTensor* dst, QuaternionTensor* a, QuaternionTensor* b, Float64 t) {
+    Tensor* d[] = { dst->w, dst->x, dst->y, dst->z };
+    Tensor* s[] = { a->w, a->x, a->y, a->z, b->w, b->x, b->y, b->z };
+    return hyper_run(HyperQuaternionSlerp, d, 4, s, 8, t);
+}
+
+// The functions on single values: the scalar kernels, on one element
+#define HYPER_SCALAR_API(SFX, CT, CN, QT, QN, T)                                                                \
+    CT CN##_mul(CT a, CT b) {                                                                                   \
+        CT r;                                                                                                   \
+        void* d[] = { &r.re, &r.im };                                                                           \
+        const void* s[] = { &a.re, &a.im, &b.re, &b.im };                                                       \
+        hyper_cmul_##SFX##_scalar(d, s, 1, 0.0);                                                                \
+        return r;                                                                                               \
+    }                                                                                                           \
+                                                                                                                \
+    CT CN##_div(CT a, CT b) {                                                                                   \
+        CT r;                                                                                                   \
+        void* d[] = { &r.re, &r.im };                                                                           \
+        const void* s[] = { &a.re, &a.im, &b.re, &b.im };                                                       \
+        hyper_cdiv_##SFX##_scalar(d, s, 1, 0.0);                                                                \
+        return r;                                                                                               \
+    }                                                                                                           \
+                                                                                                                \
+    T CN##_abs(CT a) {                                                                                          \
+        T r;                                                                                                    \
+        void* d[] = { &r };                                                                                     \
+        const void* s[] = { &a.re, &a.im };                                                                     \
+        hyper_cabs_##SFX##_scalar(d, s, 1, 0.0);                                                                \
+        return r;                                                                                               \
+    }                                                                                                           \
+                                                                                                                \
+    CT CN##_exp(CT a) {                                                                                         \
+        CT r;                                                                                                   \
+        void* d[] = { &r.re, &r.im };                                                                           \
+        const void* s[] = { &a.re, &a.im };                                                                     \
+        hyper_cexp_##SFX##_scalar(d, s, 1, 0.0);                                                                \
+        return r;                                                                                               \
+    }                                                                                                           \
+                                                                                                                \
+    QT QN##_mul(QT a, QT b) {                                                                                   \
+        QT r;                                                                                                   \
+        void* d[] = { &r.w, &r.x, &r.y, &r.z };                                                                 \
+        const void* s[] = { &a.w, &a.x, &a.y, &a.z, &b.w, &b.x, &b.y, &b.z };                                   \
+        hyper_qmul_##SFX##_scalar(d, s, 1, 0.0);                                                                \
+        return r;                                                                                               \
+    }                                                                                                           \
+                                                                                                                \
+    QT QN##_normalize(QT q) {                                                                                   \
+        QT r;                                                                                                   \
+        void* d[] = { &r.w, &r.x, &r.y, &r.z };                                                                 \
+        const void* s[] = { &q.w, &q.x, &q.y, &q.z };                                                           \
+        hyper_qnormalize_##SFX##_scalar(d, s, 1, 0.0);                                                          \
+        return r;                                                                                               \
+    }                                                                                                           \
+                                                                                                                \
+    QT QN##_rotate(QT q, QT v) {                                                                                \
+        QT r;                                                                                                   \
+        r.w = 0;                                                                                                \
+        void* d[] = { &r.x, &r.y, &r.z };                                                                       \
+        const void* s[] = { &q.w, &q.x, &q.y, &q.z, &v.x, &v.y, &v.z };                                         \
+        hyper_qrotate_##SFX##_scalar(d, s, 1, 0.0);                                                             \
+        return r;                                                                                               \
+    }                                                                                                           \
+                                                                                                                \
+    QT QN##_slerp(QT a, QT b, T t) {                                                                            \
+        QT r;                                                                                                   \
+        void* d[] = { &r.w, &r.x, &r.y, &r.z };                                                                 \
+        const void* s[] = { &a.w, &a.x, &a.y, &a.z, &b.w, &b.x, &b.y, &b.z };                                   \
+        hyper_qslerp_##SFX##_scalar(d, s, 1, t);                                                                \
+        return r;                                                                                               \
+    }
+
+HYPER_SCALAR_API(f32, Complex32, complex32, Quaternion128, quaternion128, Float32)
+HYPER_SCALAR_API(f64, Complex64, complex64, Quaternion256, quaternion256, Float64)
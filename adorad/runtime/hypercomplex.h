@@ -0,0 +1,105 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+
+#ifndef ADORAD_RUNTIME_HYPERCOMPLEX_H
+#define ADORAD_RUNTIME_HYPERCOMPLEX_H
+
+#include <adorad/core/types.h>
+#include <adorad/runtime/tensor.h>
+
+/*
+    Complex numbers and quaternions (the `Complex32/64` and `Quaternion128/256` types).
+
+    `Complex32` and `Quaternion128` have Float32 parts, and `Complex64` and `Quaternion256` Float64 parts. A tensor of
+    them is split into one float tensor per part (`ComplexTensor`, `QuaternionTensor`): all the real parts, then all the
+    imaginary ones (SoA), so that a vector register holds the same part of 16 / 8 / 4 elements, and the operations
+    below need no shuffles. The batch operations run over whole tensors, with the kernels of the other tensor
+    operations (see `tensor_isa()`):
+        1. AVX-512 (F): 16 Float32s / 8 Float64s at a time
+        2. AVX2:         8 Float32s / 4 Float64s at a time
+        3. Scalar: one at a time, in plain C
+    and the functions on single values use the scalar kernels. Kernels can round differently in the last bit (the
+    compiler can fuse multiplications and additions in some of them). `exp` and `slerp` use the functions of
+    <adorad/runtime/vmath.h> (with their error bounds).
+
+    Quaternions are `w + xi + yj + zk`. `rotate()` expects unit quaternions, and rotates the vector `(x, y, z)` of a
+    quaternion (whose `w` is ignored). `slerp()` interpolates along the shorter arc, and normalizes its result.
+    Dividing a complex number by zero divides its parts by zero, the absolute value of a complex number with an
+    infinite part is infinite (even if the other is a NaN), and normalizing a zero quaternion leaves it zero.
+*/
+
+typedef struct Complex32 {
+    Float32 re;
+    Float32 im;
+} Complex32;
+
+typedef struct Complex64 {
+    Float64 re;
+    Float64 im;
+} Complex64;
+
+typedef struct Quaternion128 {
+    Float32 w, x, y, z;
+} Quaternion128;
+
+typedef struct Quaternion256 {
+    Float64 w, x, y, z;
+} Quaternion256;
+
+// Tensors of complex numbers and quaternions: one float tensor (all of the same dtype and length) per part
+typedef struct ComplexTensor {
+    Tensor* re;
+    Tensor* im;
+} ComplexTensor;
+
+typedef struct QuaternionTensor {
+    Tensor* w;
+    Tensor* x;
+    Tensor* y;
+    Tensor* z;
+} QuaternionTensor;
+
+Complex32 complex32_mul(Complex32 a, Complex32 b);
+Complex32 complex32_div(Complex32 a, Complex32 b);
+Float32 complex32_abs(Complex32 a);
+Complex32 complex32_exp(Complex32 a);
+Complex64 complex64_mul(Complex64 a, Complex64 b);
+Complex64 complex64_div(Complex64 a, Complex64 b);
+Float64 complex64_abs(Complex64 a);
+Complex64 complex64_exp(Complex64 a);
+
+Quaternion128 quaternion128_mul(Quaternion128 a, Quaternion128 b);
+Quaternion128 quaternion128_normalize(Quaternion128 q);
+// The vector `(v.x, v.y, v.z)` rotated by `q` (the result's `w` is 0)
+Quaternion128 quaternion128_rotate(Quaternion128 q, Quaternion128 v);
+// `a` for `t == 0`, `b` for `t == 1`, and the rotations in between
+Quaternion128 quaternion128_slerp(Quaternion128 a, Quaternion128 b, Float32 t);
+Quaternion256 quaternion256_mul(Quaternion256 a, Quaternion256 b);
+Quaternion256 quaternion256_normalize(Quaternion256 q);
+Quaternion256 quaternion256_rotate(Quaternion256 q, Quaternion256 v);
+Quaternion256 quaternion256_slerp(Quaternion256 a, Quaternion256 b, Float64 t);
+
+// The same, element-wise, over tensors. `dst` can be (or share tensors with) the arguments. All the tensors must have
+// the same dtype and length, and the operations return false if they aren't floats.
+bool complex_tensor_mul(ComplexTensor* dst, ComplexTensor* a, ComplexTensor* b);
+bool complex_tensor_div(ComplexTensor* dst, ComplexTensor* a, ComplexTensor* b);
+bool complex_tensor_abs(Tensor* dst, ComplexTensor* a);
+bool complex_tensor_exp(ComplexTensor* dst, ComplexTensor* a);
+bool quaternion_tensor_mul(QuaternionTensor* dst, QuaternionTensor* a, QuaternionTensor* b);
+bool quaternion_tensor_normalize(QuaternionTensor* dst, QuaternionTensor* q);
+// `v->w` and `dst->w` aren't used (and can be null)
+bool quaternion_tensor_rotate(QuaternionTensor* dst, QuaternionTensor* q, QuaternionTensor* v);
+bool quaternion_tensor_slerp(QuaternionTensor* dst, QuaternionTensor* a, QuaternionTensor* b, Float64 t);
+
+#endif // ADORAD_RUNTIME_HYPERCOMPLEX_H
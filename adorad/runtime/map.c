@@ -0,0 +1,465 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <adorad/core/cpu.h>
+#include <adorad/core/debug.h>
+#include <adorad/core/misc.h>
+#include <adorad/core/os_defs.h>
+#include <adorad/runtime/map.h>
+
+#if defined(CORETEN_SIMD_SSE2)
+    #include <emmintrin.h>
+#endif // CORETEN_SIMD_SSE2
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif // _MSC_VER
+
+// Entries are numbered with `UInt32`s in the table
+#define MAP_MAX_LEN         (1ULL << 32)
+
+// Index of the lowest set bit in `bits` (`bits` must be non-zero)
+static CORETEN_ALWAYS_INLINE UInt32 map_lowest_bit(UInt32 bits) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, bits);
+    return cast(UInt32)index;
+#else
+    return cast(UInt32)__builtin_ctz(bits);
+#endif // _MSC_VER
+}
+
+/*
+    Probing a group: a bitmask with bit `i` set if slot `i` of the group (whose control bytes start at `ctrl`) has the
+    control byte `h2` (`map_match()`), is empty (`map_match_empty()`), or is empty or a tombstone (`map_match_free()`).
+*/
+#if defined(CORETEN_SIMD_SSE2)
+    static CORETEN_ALWAYS_INLINE UInt32 map_match(const Byte* ctrl, Byte h2) {
+        __m128i group = _mm_loadu_si128(cast(const __m128i*)ctrl);
+        return cast(UInt32)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(cast(char)h2)));
+    }
+
+    static CORETEN_ALWAYS_INLINE UInt32 map_match_free(const Byte* ctrl) {
+        // The only control bytes with their top bit set
+        return cast(UInt32)_mm_movemask_epi8(_mm_loadu_si128(cast(const __m128i*)ctrl));
+    }
+#else
+    #define MAP_LOW_BITS    0x7F7F7F7F7F7F7F7FULL
+    #define MAP_HIGH_BITS   0x8080808080808080ULL
+
+    // 8 control bytes, the first one in the lowest byte (whatever the byte order)
+    static CORETEN_ALWAYS_INLINE UInt64 map_load_word(const Byte* ctrl) {
+        UInt64 word = 0;
+        for(int i = 0; i < 8; i++)
+            word |= cast(UInt64)ctrl[i] << (8 * i);
+        return word;
+    }
+
+    // The top bit of every byte of `word`, as 8 bits
+    static CORETEN_ALWAYS_INLINE UInt32 map_word_bits(UInt64 word) {
+        return cast(UInt32)(((word >> 7) * 0x0102040810204080ULL) >> 56);
+    }
+
+    // The top bit of every byte of `word` that's 0 (and no other bit)
+    static CORETEN_ALWAYS_INLINE UInt64 map_word_zeroes(UInt64 word) {
+        return ~(((word & MAP_LOW_BITS) + MAP_LOW_BITS) | word) & MAP_HIGH_BITS;
+    }
+
+    static CORETEN_ALWAYS_INLINE UInt32 map_match(const Byte* ctrl, Byte h2) {
+        UInt64 pattern = h2 * 0x0101010101010101ULL;
+        UInt64 lo = map_word_zeroes(map_load_word(ctrl) ^ pattern);
+        UInt64 hi = map_word_zeroes(map_load_word(ctrl + 8) ^ pattern);
+        return map_word_bits(lo) | map_word_bits(hi) << 8;
+    }
+
+    static CORETEN_ALWAYS_INLINE UInt32 map_match_free(const Byte* ctrl) {
+        UInt64 lo = map_load_word(ctrl) & MAP_HIGH_BITS;
+        UInt64 hi = map_load_word(ctrl + 8) & MAP_HIGH_BITS;
+        return map_word_bits(lo) | map_word_bits(hi) << 8;
+    }
+#endif // CORETEN_SIMD_SSE2
+
+static CORETEN_ALWAYS_INLINE UInt32 map_match_empty(const Byte* ctrl) {
+    return map_match(ctrl, MAP_EMPTY);
+}
+
+/*
+    Hashing. The lowest 7 bits of a hash are the control byte of its key's slot, and the rest pick the first group
+    probed.
+*/
+static CORETEN_ALWAYS_INLINE UInt64 map_hash_int(UInt64 key, UInt64 seed) {
+    UInt64 h = key ^ seed;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    return h ^ (h >> 33);
+}
+
+// Every NaN is the same key, and so are `-0.0` and `0.0`
+static CORETEN_ALWAYS_INLINE UInt64 map_hash_float(Float64 key, UInt64 seed) {
+    UInt64 bits;
+    if(key != key)
+        key = NAN;
+    else if(key == 0)
+        key = 0;
+    memcpy(&bits, &key, 8);
+    return map_hash_int(bits, seed);
+}
+
+static CORETEN_ALWAYS_INLINE UInt64 map_load64(const char* data) {
+    UInt64 x;
+    memcpy(&x, data, 8);
+    return x;
+}
+
+static CORETEN_ALWAYS_INLINE UInt64 map_load32(const char* data) {
+    UInt32 x;
+    memcpy(&x, data, 4);
+    return x;
+}
+
+#define MAP_MUL         0xc6a4a7935bd1e995ULL
+
+// Mix `k` into `h` (a round of MurmurHash64A)
+static CORETEN_ALWAYS_INLINE UInt64 map_mix(UInt64 h, UInt64 k) {
+    k *= MAP_MUL;
+    k ^= k >> 47;
+    k *= MAP_MUL;
+    return (h ^ k) * MAP_MUL;
+}
+
+// MurmurHash64A, except that it reads keys of up to 16 bytes as two (possibly overlapping) loads, without a loop
+static UInt64 map_hash_string(const char* key, UInt64 len, UInt64 seed) {
+    UInt64 h = seed ^ (len * MAP_MUL);
+    if(len >= 8) {
+        for(; len > 16; key += 8, len -= 8)
+            h = map_mix(h, map_load64(key));
+        h = map_mix(h, map_load64(key));
+        h = map_mix(h, map_load64(key + len - 8));
+    } else if(len >= 4) {
+        h = map_mix(h, map_load32(key) | map_load32(key + len - 4) << 32);
+    } else if(len > 0) {
+        Byte first = cast(Byte)key[0], middle = cast(Byte)key[len / 2], last = cast(Byte)key[len - 1];
+        h = map_mix(h, cast(UInt64)first << 16 | cast(UInt64)middle << 8 | last);
+    }
+    h ^= h >> 47;
+    h *= MAP_MUL;
+    return h ^ (h >> 47);
+}
+
+// The key being looked up (in the field for the map's kind)
+typedef struct MapKeyRef {
+    Int64 i;
+    Float64 f;
+    const char* s;
+    UInt64 len;
+} MapKeyRef;
+
+static CORETEN_ALWAYS_INLINE UInt64 map_hash(const Map* map, MapKeyKind kind, const MapKeyRef* key) {
+    switch(kind) {
+        case MapKeyInt: return map_hash_int(cast(UInt64)key->i, map->seed);
+        case MapKeyFloat: return map_hash_float(key->f, map->seed);
+        default: return map_hash_string(key->s, key->len, map->seed);
+    }
+}
+
+static UInt64 map_entry_hash(const Map* map, UInt64 entry) {
+    switch(map->kind) {
+        case MapKeyInt: return map_hash_int(cast(UInt64)map->entries.ints[entry].key, map->seed);
+        case MapKeyFloat: return map_hash_float(map->entries.floats[entry].key, map->seed);
+        default: return map->entries.strings[entry].key.hash;
+    }
+}
+
+static CORETEN_ALWAYS_INLINE MapValue* map_entry_value(Map* map, MapKeyKind kind, UInt64 entry) {
+    switch(kind) {
+        case MapKeyInt: return &map->entries.ints[entry].value;
+        case MapKeyFloat: return &map->entries.floats[entry].value;
+        default: return &map->entries.strings[entry].value;
+    }
+}
+
+static CORETEN_ALWAYS_INLINE bool map_key_equals(const Map* map, MapKeyKind kind, UInt64 entry, UInt64 hash,
+                                                 const MapKeyRef* key) {
+    switch(kind) {
+        case MapKeyInt: return map->entries.ints[entry].key == key->i;
+        case MapKeyFloat: {
+            Float64 x = map->entries.floats[entry].key;
+            return x == key->f || (x != x && key->f != key->f);
+        }
+        default: {
+            const MapString* s = &map->entries.strings[entry].key;
+            return s->hash == hash && s->len == key->len &&
+                   memcmp(map_string_data(s), key->s, key->len) == 0;
+        }
+    }
+}
+
+// The slot of the entry with key `key` (whose hash is `hash`), or -1 if there's none
+static CORETEN_ALWAYS_INLINE Int64 map_find_slot(const Map* map, MapKeyKind kind, UInt64 hash, const MapKeyRef* key) {
+    if(map->len == 0)
+        return -1;
+    UInt64 mask = map->num_slots / MAP_GROUP - 1;
+    UInt64 group = (hash >> 7) & mask;
+    Byte h2 = cast(Byte)(hash & 0x7F);
+    for(UInt64 step = 1; ; step++) {
+        const Byte* ctrl = map->ctrl + group * MAP_GROUP;
+        for(UInt32 bits = map_match(ctrl, h2); bits != 0; bits &= bits - 1) {
+            UInt64 slot = group * MAP_GROUP + map_lowest_bit(bits);
+            if(map_key_equals(map, kind, map->slots[slot], hash, key))
+                return cast(Int64)slot;
+        }
+        if(map_match_empty(ctrl) != 0)
+            return -1;
+        group = (group + step) & mask;
+    }
+}
+
+// The first empty slot (or tombstone) on the probe sequence of `hash`
+static CORETEN_ALWAYS_INLINE UInt64 map_free_slot(const Map* map, UInt64 hash) {
+    UInt64 mask = map->num_slots / MAP_GROUP - 1;
+    UInt64 group = (hash >> 7) & mask;
+    for(UInt64 step = 1; ; step++) {
+        UInt32 bits = map_match_free(map->ctrl + group * MAP_GROUP);
+        if(bits != 0)
+            return group * MAP_GROUP + map_lowest_bit(bits);
+        group = (group + step) & mask;
+    }
+}
+
+// The slot of entry `entry` (whose key's hash is `hash`)
+static UInt64 map_entry_slot(const Map* map, UInt64 hash, UInt64 entry) {
+    UInt64 mask = map->num_slots / MAP_GROUP - 1;
+    UInt64 group = (hash >> 7) & mask;
+    Byte h2 = cast(Byte)(hash & 0x7F);
+    for(UInt64 step = 1; ; step++) {
+        for(UInt32 bits = map_match(map->ctrl + group * MAP_GROUP, h2); bits != 0; bits &= bits - 1) {
+            UInt64 slot = group * MAP_GROUP + map_lowest_bit(bits);
+            if(map->slots[slot] == entry)
+                return slot;
+        }
+        group = (group + step) & mask;
+    }
+}
+
+static void* map_realloc(void* data, UInt64 bytes) {
+    data = realloc(data, bytes > 0 ? bytes : 1);
+    CORETEN_ENFORCE_NN(data, "Could not allocate memory. Memory full.");
+    return data;
+}
+
+// Rebuild the table with `num_slots` slots (dropping every tombstone), and make room for as many entries as it can
+// hold
+static void map_rehash(Map* map, UInt64 num_slots) {
+    UInt64 cap = num_slots - num_slots / 8;
+    CORETEN_ENFORCE(cap <= MAP_MAX_LEN, "Map too large");
+    if(cap > map->cap) {
+        static const UInt64 entry_sizes[] = { sizeof(MapIntEntry), sizeof(MapFloatEntry), sizeof(MapStringEntry) };
+        map->entries.ints = cast(MapIntEntry*)map_realloc(map->entries.ints, cap * entry_sizes[map->kind]);
+        map->cap = cap;
+    }
+    if(num_slots != map->num_slots) {
+        free(map->ctrl);
+        free(map->slots);
+        map->ctrl = cast(Byte*)map_realloc(null, num_slots);
+        map->slots = cast(UInt32*)map_realloc(null, num_slots * sizeof(UInt32));
+        map->num_slots = num_slots;
+    }
+    memset(map->ctrl, MAP_EMPTY, num_slots);
+    map->tombstones = 0;
+    for(UInt64 entry = 0; entry < map->len; entry++) {
+        UInt64 hash = map_entry_hash(map, entry);
+        UInt64 slot = map_free_slot(map, hash);
+        map->ctrl[slot] = cast(Byte)(hash & 0x7F);
+        map->slots[slot] = cast(UInt32)entry;
+    }
+}
+
+// The fewest slots that hold `cap` entries
+static UInt64 map_slots_for(UInt64 cap) {
+    UInt64 num_slots = MAP_GROUP;
+    while(num_slots - num_slots / 8 < cap)
+        num_slots *= 2;
+    return num_slots;
+}
+
+Map* map_new(MapKeyKind kind, UInt64 cap) {
+    Map* map = cast(Map*)calloc(1, sizeof(Map));
+    CORETEN_ENFORCE_NN(map, "Could not allocate memory. Memory full.");
+    map->kind = kind;
+    // Its own address is as good a seed as any, and is different for every map that's alive at the same time
+    map->seed = map_hash_int(cast(UInt64)cast(UIntptr)map, 0x9e3779b97f4a7c15ULL);
+    if(cap > 0)
+        map_rehash(map, map_slots_for(cap));
+    return map;
+}
+
+static void map_free_keys(Map* map) {
+    if(map->kind != MapKeyString)
+        return;
+    for(UInt64 entry = 0; entry < map->len; entry++)
+        if(map->entries.strings[entry].key.len >= MAP_SMALL_STRING)
+            free(map->entries.strings[entry].key.data.heap);
+}
+
+void map_free(Map* map) {
+    if(map == null)
+        return;
+    map_free_keys(map);
+    free(map->entries.ints);
+    free(map->ctrl);
+    free(map->slots);
+    free(map);
+}
+
+void map_reserve(Map* map, UInt64 cap) {
+    if(cap > map->cap)
+        map_rehash(map, map_slots_for(cap));
+}
+
+void map_clear(Map* map) {
+    map_free_keys(map);
+    map->len = 0;
+    map->tombstones = 0;
+    if(map->num_slots > 0)
+        memset(map->ctrl, MAP_EMPTY, map->num_slots);
+}
+
+static CORETEN_ALWAYS_INLINE MapValue* map_find(Map* map, MapKeyKind kind, const MapKeyRef* key) {
+    CORETEN_ENFORCE(map->kind == kind, "Map key of the wrong type");
+    Int64 slot = map_find_slot(map, kind, map_hash(map, kind, key), key);
+    return slot < 0 ? null : map_entry_value(map, kind, map->slots[slot]);
+}
+
+static CORETEN_ALWAYS_INLINE MapValue* map_insert(Map* map, MapKeyKind kind, const MapKeyRef* key, bool* inserted) {
+    CORETEN_ENFORCE(map->kind == kind, "Map key of the wrong type");
+    UInt64 hash = map_hash(map, kind, key);
+    Int64 found = map_find_slot(map, kind, hash, key);
+    if(inserted != null)
+        *inserted = found < 0;
+    if(found >= 0)
+        return map_entry_value(map, kind, map->slots[found]);
+
+    if(map->len + map->tombstones >= map->cap) {
+        // Double the table, unless it's mostly tombstones (then dropping them makes room for as many entries again)
+        UInt64 num_slots = map->num_slots;
+        if(num_slots == 0 || (map->len + 1) * 2 > map->cap)
+            num_slots = num_slots == 0 ? MAP_GROUP : num_slots * 2;
+        map_rehash(map, num_slots);
+    }
+    UInt64 slot = map_free_slot(map, hash);
+    UInt64 entry = map->len++;
+    if(map->ctrl[slot] == MAP_DELETED)
+        map->tombstones--;
+    map->ctrl[slot] = cast(Byte)(hash & 0x7F);
+    map->slots[slot] = cast(UInt32)entry;
+    switch(kind) {
+        case MapKeyInt: map->entries.ints[entry].key = key->i; break;
+        case MapKeyFloat: map->entries.floats[entry].key = key->f == 0 ? 0 : key->f; break;
+        default: {
+            MapString* s = &map->entries.strings[entry].key;
+            char* data = s->data.small;
+            if(key->len >= MAP_SMALL_STRING)
+                data = s->data.heap = cast(char*)map_realloc(null, key->len + 1);
+            memcpy(data, key->s, key->len);
+            data[key->len] = '\0';
+            s->hash = hash;
+            s->len = key->len;
+            break;
+        }
+    }
+    MapValue* value = map_entry_value(map, kind, entry);
+    value->u = 0;
+    return value;
+}
+
+static CORETEN_ALWAYS_INLINE bool map_delete(Map* map, MapKeyKind kind, const MapKeyRef* key) {
+    CORETEN_ENFORCE(map->kind == kind, "Map key of the wrong type");
+    Int64 slot = map_find_slot(map, kind, map_hash(map, kind, key), key);
+    if(slot < 0)
+        return false;
+
+    // A group that has an empty slot ends every probe sequence that reaches it, so no key can have been pushed past
+    // it (and the slot can be empty too). Otherwise, the slot has to stay in the way.
+    UInt64 entry = map->slots[slot];
+    if(map_match_empty(map->ctrl + cast(UInt64)slot / MAP_GROUP * MAP_GROUP) != 0) {
+        map->ctrl[slot] = MAP_EMPTY;
+    } else {
+        map->ctrl[slot] = MAP_DELETED;
+        map->tombstones++;
+    }
+    if(kind == MapKeyString && map->entries.strings[entry].key.len >= MAP_SMALL_STRING)
+        free(map->entries.strings[entry].key.data.heap);
+
+    // Move the last entry into the hole (and point its slot at where it went)
+    UInt64 last = --map->len;
+    if(entry != last) {
+        UInt64 hash = map_entry_hash(map, last);
+        map->slots[map_entry_slot(map, hash, last)] = cast(UInt32)entry;
+        switch(kind) {
+            case MapKeyInt: map->entries.ints[entry] = map->entries.ints[last]; break;
+            case MapKeyFloat: map->entries.floats[entry] = map->entries.floats[last]; break;
+            default: map->entries.strings[entry] = map->entries.strings[last]; break;
+        }
+    }
+    return true;
+}
+
+MapValue* map_find_int(Map* map, Int64 key) {
+    MapKeyRef ref = { .i = key };
+    return map_find(map, MapKeyInt, &ref);
+}
+
+MapValue* map_find_float(Map* map, Float64 key) {
+    MapKeyRef ref = { .f = key };
+    return map_find(map, MapKeyFloat, &ref);
+}
+
+MapValue* map_find_string(Map* map, const char* key, UInt64 len) {
+    MapKeyRef ref = { .s = key, .len = len };
+    return map_find(map, MapKeyString, &ref);
+}
+
+MapValue* map_insert_int(Map* map, Int64 key, bool* inserted) {
+    MapKeyRef ref = { .i = key };
+    return map_insert(map, MapKeyInt, &ref, inserted);
+}
+
+MapValue* map_insert_float(Map* map, Float64 key, bool* inserted) {
+    MapKeyRef ref = { .f = key };
+    return map_insert(map, MapKeyFloat, &ref, inserted);
+}
+
+MapValue* map_insert_string(Map* map, const char* key, UInt64 len, bool* inserted) {
+    MapKeyRef ref = { .s = key, .len = len };
+    return map_insert(map, MapKeyString, &ref, inserted);
+}
+
+bool map_delete_int(Map* map, Int64 key) {
+    MapKeyRef ref = { .i = key };
+    return map_delete(map, MapKeyInt, &ref);
+}
+
+bool map_delete_float(Map* map, Float64 key) {
+    MapKeyRef ref = { .f = key };
+    return map_delete(map, MapKeyFloat, &ref);
+}
+
+bool map_delete_string(Map* map, const char* key, UInt64 len) {
+    MapKeyRef ref = { .s = key, .len = len };
+    return map_delete(map, MapKeyString, &ref);
+}
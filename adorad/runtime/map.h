@@ -0,0 +1,143 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+
+#ifndef ADORAD_RUNTIME_MAP_H
+#define ADORAD_RUNTIME_MAP_H
+
+#include <adorad/core/types.h>
+
+/*
+    Maps (`map[string]int{}`, `map{1: 'one'}`).
+
+    A map keeps its entries (a key and its value, side by side) in a dense array: `entries.<kind>[i]`, for `i` from 0
+    to `len - 1`. So `for k, v in m` is a loop over an array, no matter how many slots the table has or how many entries
+    were deleted, and finding a key reads its value from the cache line it compared the key in. Deleting an entry moves
+    the last one into its place, so iteration sees the entries in the order they were inserted only until the first
+    deletion.
+
+    The hash table itself only holds indices into that array. It's open-addressed, with a control byte per slot:
+    `MAP_EMPTY`, `MAP_DELETED` (a tombstone), or the lowest 7 bits of the hash of the key in it. Slots are probed a
+    group of `MAP_GROUP` at a time: one SSE2 comparison (or a few 64-bit word operations, without SSE2) of the group's
+    control bytes finds every slot that can hold the key, and the keys of those are the only ones compared. The hash
+    picks the first group, and the following ones are triangular steps from there (1, 2, 3... groups), which visits
+    every group. A lookup stops at the first group with an empty slot, so most take a single group. The table grows
+    (doubling) before empty slots and tombstones get fewer than 1/8 of the slots.
+
+    There are functions for every kind of key, so each compares keys in the cheapest way for it:
+        - Integers (and runes and `voidptr`s, as integers) are hashed with a couple of multiplications, and compared
+          directly.
+        - Floats are compared by value, except that every NaN is the same key. `-0.0` is the same key as `0.0`.
+        - Strings are hashed 8 bytes at a time (short ones with a load or two). Every key keeps its hash next to its
+          length and bytes, so they're compared by hash first (and only compared byte for byte when they're almost
+          certainly equal), and the table is rebuilt without hashing them again. The map keeps a copy of every key: in
+          the key itself if it's shorter than `MAP_SMALL_STRING` bytes (so most keys take a single cache line to
+          compare), and in an allocation of its own otherwise.
+    `map_new()` and `map_reserve()` preallocate room for a number of entries (`map[K]V{cap: N}`), so that many can be
+    inserted without the table growing. Every map hashes with a seed of its own, so keys that collide in one map
+    (because an attacker picked them, say) don't in the next.
+
+    The values are 8 bytes, like a `VmValue`, whatever the type of the map. A pointer to one (from `map_find_*()` or
+    `map_insert_*()`) is valid until the next insertion into the map or deletion from it.
+*/
+
+// Slots per group of control bytes (probed at once)
+#define MAP_GROUP           16
+// Control bytes of the slots that don't hold an entry
+#define MAP_EMPTY           0x80
+#define MAP_DELETED         0xFE
+// String keys shorter than this are kept in their entry (which is then 56 bytes)
+#define MAP_SMALL_STRING    24
+
+typedef enum MapKeyKind {
+    MapKeyInt,
+    MapKeyFloat,
+    MapKeyString,
+    MapNumKeyKinds,
+} MapKeyKind;
+
+typedef union MapValue {
+    Int64 i;
+    UInt64 u;
+    double f;
+    void* p;
+} MapValue;
+
+// A string key (null-terminated, see `map_string_data()`)
+typedef struct MapString {
+    UInt64 hash;
+    UInt64 len;
+    union {
+        char small[MAP_SMALL_STRING];   // if `len < MAP_SMALL_STRING`
+        char* heap;
+    } data;
+} MapString;
+
+typedef struct MapIntEntry {
+    Int64 key;
+    MapValue value;
+} MapIntEntry;
+
+typedef struct MapFloatEntry {
+    Float64 key;
+    MapValue value;
+} MapFloatEntry;
+
+typedef struct MapStringEntry {
+    MapString key;
+    MapValue value;
+} MapStringEntry;
+
+typedef struct Map {
+    MapKeyKind kind;
+    UInt64 len;             // entries
+    UInt64 cap;             // entries it can hold before the table grows
+    union {
+        MapIntEntry* ints;
+        MapFloatEntry* floats;
+        MapStringEntry* strings;
+    } entries;
+    Byte* ctrl;             // a control byte per slot
+    UInt32* slots;          // the entry in every slot that has one
+    UInt64 num_slots;       // 0, or a power of 2 that's a multiple of `MAP_GROUP`
+    UInt64 tombstones;      // slots that are `MAP_DELETED`
+    UInt64 seed;
+} Map;
+
+// An empty map with room for `cap` entries
+Map* map_new(MapKeyKind kind, UInt64 cap);
+void map_free(Map* map);
+// Make room for at least `cap` entries
+void map_reserve(Map* map, UInt64 cap);
+// Delete every entry (keeping the room for them)
+void map_clear(Map* map);
+
+static inline const char* map_string_data(const MapString* key) {
+    return key->len < MAP_SMALL_STRING ? key->data.small : key->data.heap;
+}
+
+// The value of `key` (`m[key]`, `key in m`), or null if there's no such key
+MapValue* map_find_int(Map* map, Int64 key);
+MapValue* map_find_float(Map* map, Float64 key);
+MapValue* map_find_string(Map* map, const char* key, UInt64 len);
+// The value of `key` (`m[key] = value`), which is 0 if the key is new. `inserted` (if it isn't null) says whether it
+// is.
+MapValue* map_insert_int(Map* map, Int64 key, bool* inserted);
+MapValue* map_insert_float(Map* map, Float64 key, bool* inserted);
+MapValue* map_insert_string(Map* map, const char* key, UInt64 len, bool* inserted);
+// `m.delete(key)`. Returns false if there's no such key.
+bool map_delete_int(Map* map, Int64 key);
+bool map_delete_float(Map* map, Float64 key);
+bool map_delete_string(Map* map, const char* key, UInt64 len);
+
+#endif // ADORAD_RUNTIME_MAP_H
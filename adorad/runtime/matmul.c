@@ -0,0 +1,358 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <adorad/core/cpu.h>
+#include <adorad/core/debug.h>
+#include <adorad/core/misc.h>
+#include <adorad/core/os_defs.h>
+#include <adorad/runtime/matmul.h>
+
+#if defined(CORETEN_SIMD_X86_DISPATCH) && defined(CORETEN_SIMD_SSE2)
+    #include <immintrin.h>
+    #define MATMUL_HAVE_X86     1
+#endif // CORETEN_SIMD_X86_DISPATCH
+
+// The largest tile of any micro-kernel (in elements)
+#define MATMUL_MAX_TILE     (6 * 32)
+
+// Computes the `mr x nr` tile at `c` (rows `ldc` elements apart) from `kc` columns of a packed strip of `A` and `kc`
+// rows of a packed strip of `B`: `c = tile`, or `c += tile` if `accumulate`
+typedef void (*MatmulKernelFn)(UInt64 kc, const void* a, const void* b, void* c, UInt64 ldc, bool accumulate);
+
+typedef struct MatmulKernel {
+    UInt32 mr;
+    UInt32 nr;
+    MatmulKernelFn fn;
+} MatmulKernel;
+
+// Micro-kernels --------------------------------------------------------------------------------------------------------
+
+#define MATMUL_SCALAR_KERNEL(S, T)                                                                  \
+    static void matmul_kernel_scalar_##S(UInt64 kc, const void* a_, const void* b_, void* c_, UInt64 ldc, \
+                                         bool accumulate) {                                         \
+        const T* a = cast(const T*)a_;                                                              \
+        const T* b = cast(const T*)b_;                                                              \
+        T* c = cast(T*)c_;                                                                          \
+        T acc[4][4] = {{0}};                                                                        \
+        for(UInt64 p = 0; p < kc; p++, a += 4, b += 4)                                              \
+            for(int i = 0; i < 4; i++)                                                              \
+                for(int j = 0; j < 4; j++)                                                          \
+                    acc[i][j] += a[i] * b[j];                                                       \
+        for(int i = 0; i < 4; i++)                                                                  \
+            for(int j = 0; j < 4; j++)                                                              \
+                c[cast(UInt64)i * ldc + cast(UInt64)j] =                                            \
+                    accumulate ? c[cast(UInt64)i * ldc + cast(UInt64)j] + acc[i][j] : acc[i][j];    \
+    }
+
+MATMUL_SCALAR_KERNEL(f32, Float32)
+MATMUL_SCALAR_KERNEL(f64, Float64)
+
+/*
+    The SIMD micro-kernels compute `6 x 2W` tiles (`W` being the number of elements in a vector): 12 accumulators,
+    enough independent FMAs to keep both FMA units busy, plus 2 rows of `B` and a broadcast element of `A`.
+*/
+#define MATMUL_FMA_ROW(i, BCAST, FMA)                                                               \
+    x = BCAST(a + i);                                                                               \
+    c##i##0 = FMA(x, b0, c##i##0);                                                                  \
+    c##i##1 = FMA(x, b1, c##i##1);
+
+#define MATMUL_STORE_ROW(i, W, LOADU, STOREU, ADD)                                                  \
+    if(accumulate) {                                                                                \
+        c##i##0 = ADD(c##i##0, LOADU(c + i * ldc));                                                 \
+        c##i##1 = ADD(c##i##1, LOADU(c + i * ldc + W));                                             \
+    }                                                                                               \
+    STOREU(c + i * ldc, c##i##0);                                                                   \
+    STOREU(c + i * ldc + W, c##i##1);
+
+#define MATMUL_SIMD_KERNEL(S, TARGET, T, V, W, ZERO, LOADU, STOREU, BCAST, FMA, ADD)                \
+    TARGET static void matmul_kernel_##S(UInt64 kc, const void* a_, const void* b_, void* c_, UInt64 ldc, \
+                                         bool accumulate) {                                         \
+        const T* a = cast(const T*)a_;                                                              \
+        const T* b = cast(const T*)b_;                                                              \
+        T* c = cast(T*)c_;                                                                          \
+        V c00 = ZERO(), c01 = ZERO(), c10 = ZERO(), c11 = ZERO(), c20 = ZERO(), c21 = ZERO();       \
+        V c30 = ZERO(), c31 = ZERO(), c40 = ZERO(), c41 = ZERO(), c50 = ZERO(), c51 = ZERO();       \
+        for(UInt64 p = 0; p < kc; p++, a += 6, b += 2 * W) {                                        \
+            V b0 = LOADU(b);                                                                        \
+            V b1 = LOADU(b + W);                                                                    \
+            V x;                                                                                    \
+            MATMUL_FMA_ROW(0, BCAST, FMA)                                                           \
+            MATMUL_FMA_ROW(1, BCAST, FMA)                                                           \
+            MATMUL_FMA_ROW(2, BCAST, FMA)                                                           \
+            MATMUL_FMA_ROW(3, BCAST, FMA)                                                           \
+            MATMUL_FMA_ROW(4, BCAST, FMA)                                                           \
+            MATMUL_FMA_ROW(5, BCAST, FMA)                                                           \
+        }                                                                                           \
+        MATMUL_STORE_ROW(0, W, LOADU, STOREU, ADD)                                                  \
+        MATMUL_STORE_ROW(1, W, LOADU, STOREU, ADD)                                                  \
+        MATMUL_STORE_ROW(2, W, LOADU, STOREU, ADD)                                                  \
+        MATMUL_STORE_ROW(3, W, LOADU, STOREU, ADD)                                                  \
+        MATMUL_STORE_ROW(4, W, LOADU, STOREU, ADD)                                                  \
+        MATMUL_STORE_ROW(5, W, LOADU, STOREU, ADD)                                                  \
+    }
+
+static const MatmulKernel matmul_scalar_f32 = { 4, 4, matmul_kernel_scalar_f32 };
+static const MatmulKernel matmul_scalar_f64 = { 4, 4, matmul_kernel_scalar_f64 };
+
+#if defined(MATMUL_HAVE_X86)
+    #define MATMUL_AVX2         CORETEN_TARGET("avx2,fma")
+    #define MATMUL_AVX512       CORETEN_TARGET("avx512f")
+
+    #define MATMUL_AVX512_BCAST_F32(p)  _mm512_set1_ps(*(p))
+    #define MATMUL_AVX512_BCAST_F64(p)  _mm512_set1_pd(*(p))
+
+    MATMUL_SIMD_KERNEL(avx2_f32, MATMUL_AVX2, Float32, __m256, 8, _mm256_setzero_ps, _mm256_loadu_ps,
+                       _mm256_storeu_ps, _mm256_broadcast_ss, _mm256_fmadd_ps, _mm256_add_ps)
+    MATMUL_SIMD_KERNEL(avx2_f64, MATMUL_AVX2, Float64, __m256d, 4, _mm256_setzero_pd, _mm256_loadu_pd,
+                       _mm256_storeu_pd, _mm256_broadcast_sd, _mm256_fmadd_pd, _mm256_add_pd)
+    MATMUL_SIMD_KERNEL(avx512_f32, MATMUL_AVX512, Float32, __m512, 16, _mm512_setzero_ps, _mm512_loadu_ps,
+                       _mm512_storeu_ps, MATMUL_AVX512_BCAST_F32, _mm512_fmadd_ps, _mm512_add_ps)
+    MATMUL_SIMD_KERNEL(avx512_f64, MATMUL_AVX512, Float64, __m512d, 8, _mm512_setzero_pd, _mm512_loadu_pd,
+                       _mm512_storeu_pd, MATMUL_AVX512_BCAST_F64, _mm512_fmadd_pd, _mm512_add_pd)
+
+    static const MatmulKernel matmul_avx2_f32 = { 6, 16, matmul_kernel_avx2_f32 };
+    static const MatmulKernel matmul_avx2_f64 = { 6, 8, matmul_kernel_avx2_f64 };
+    static const MatmulKernel matmul_avx512_f32 = { 6, 32, matmul_kernel_avx512_f32 };
+    static const MatmulKernel matmul_avx512_f64 = { 6, 16, matmul_kernel_avx512_f64 };
+#endif // MATMUL_HAVE_X86
+
+// The micro-kernel for `dtype`, for the kernels in use (see `tensor_isa()`)
+static const MatmulKernel* matmul_kernel(TensorDType dtype) {
+    bool is_f64 = dtype == TensorDTypeFloat64;
+#if defined(MATMUL_HAVE_X86)
+    switch(tensor_isa()) {
+        case TensorIsaAVX512: return is_f64 ? &matmul_avx512_f64 : &matmul_avx512_f32;
+        case TensorIsaAVX2:
+            if(cpu_has_feature(CpuFeatureFMA))
+                return is_f64 ? &matmul_avx2_f64 : &matmul_avx2_f32;
+            break;
+        default:
+            break;
+    }
+#endif // MATMUL_HAVE_X86
+    return is_f64 ? &matmul_scalar_f64 : &matmul_scalar_f32;
+}
+
+// Blocking -------------------------------------------------------------------------------------------------------------
+
+// A product in progress. The current panel of `B` is rows `[p0, p0 + kc)` and columns `[j0, j0 + nc)`.
+typedef struct MatmulJob {
+    const MatmulKernel* kernel;
+    Tensor* a;
+    Tensor* b;
+    Tensor* c;
+    UInt64 m;
+    UInt64 k;
+    UInt64 n;
+    UInt64 p0;
+    UInt64 kc;
+    UInt64 j0;
+    UInt64 nc;
+    UInt64 mc;          // rows in a block of `A`
+    UInt64 num_blocks;
+    UInt64 num_parts;   // ranges of strips of `B` the blocks are split into
+    Byte* packed_b;
+    Byte* packed_a;     // `mc * MATMUL_KC` elements for every worker
+} MatmulJob;
+
+static Byte* matmul_alloc(UInt64 bytes) {
+    bytes = (bytes + 63) & ~cast(UInt64)63;
+#if defined(CORETEN_OS_WINDOWS)
+    Byte* data = cast(Byte*)_aligned_malloc(bytes, 64);
+#else
+    Byte* data = cast(Byte*)aligned_alloc(64, bytes);
+#endif // CORETEN_OS_WINDOWS
+    CORETEN_ENFORCE_NN(data, "Could not allocate memory. Memory full.");
+    return data;
+}
+
+static void matmul_dealloc(Byte* data) {
+#if defined(CORETEN_OS_WINDOWS)
+    _aligned_free(data);
+#else
+    free(data);
+#endif // CORETEN_OS_WINDOWS
+}
+
+static inline UInt64 matmul_min(UInt64 a, UInt64 b) {
+    return a < b ? a : b;
+}
+
+/*
+    Packing and the loops around the micro-kernel, by element type. Elements of `A`/`B` are read through their
+    stride, so tensors that aren't contiguous don't need to be copied first.
+*/
+#define MATMUL_LOOPS(S, T)                                                                          \
+    /* Strip `s` of the panel of `B`: `dst[p * nr + j]` is element `(p0 + p, j0 + s * nr + j)`, or 0 past the edge */ \
+    static void matmul_pack_b_##S(MatmulJob* job, UInt64 s) {                                       \
+        UInt64 nr = job->kernel->nr;                                                                \
+        T* dst = cast(T*)job->packed_b + s * job->kc * nr;                                          \
+        const T* b = cast(const T*)job->b->data;                                                    \
+        Int64 stride = job->b->stride;                                                              \
+        UInt64 j = job->j0 + s * nr;                                                                \
+        UInt64 cols = matmul_min(nr, job->j0 + job->nc - j);                                        \
+        for(UInt64 p = 0; p < job->kc; p++, dst += nr) {                                            \
+            const T* row = b + cast(Int64)((job->p0 + p) * job->n + j) * stride;                    \
+            for(UInt64 x = 0; x < cols; x++)                                                        \
+                dst[x] = row[cast(Int64)x * stride];                                                \
+            for(UInt64 x = cols; x < nr; x++)                                                       \
+                dst[x] = 0;                                                                         \
+        }                                                                                           \
+    }                                                                                               \
+                                                                                                    \
+    /* Rows `[i0, i0 + rows)` of `A` (in the columns of the panel), as `mr`-tall strips */          \
+    static void matmul_pack_a_##S(MatmulJob* job, T* dst, UInt64 i0, UInt64 rows) {                 \
+        UInt64 mr = job->kernel->mr;                                                                \
+        const T* a = cast(const T*)job->a->data;                                                    \
+        Int64 stride = job->a->stride;                                                              \
+        for(UInt64 s = 0; s < rows; s += mr) {                                                      \
+            UInt64 height = matmul_min(mr, rows - s);                                               \
+            for(UInt64 y = 0; y < height; y++) {                                                    \
+                const T* row = a + cast(Int64)((i0 + s + y) * job->k + job->p0) * stride;           \
+                for(UInt64 p = 0; p < job->kc; p++)                                                 \
+                    dst[p * mr + y] = row[cast(Int64)p * stride];                                   \
+            }                                                                                       \
+            for(UInt64 y = height; y < mr; y++)                                                     \
+                for(UInt64 p = 0; p < job->kc; p++)                                                 \
+                    dst[p * mr + y] = 0;                                                            \
+            dst += job->kc * mr;                                                                    \
+        }                                                                                           \
+    }                                                                                               \
+                                                                                                    \
+    /* Rows `[i0, i0 + rows)` of `C`, in the columns of strips `[s_begin, s_end)` of the panel */   \
+    static void matmul_block_##S(MatmulJob* job, UInt32 worker, UInt64 i0, UInt64 rows, UInt64 s_begin, \
+                                 UInt64 s_end) {                                                    \
+        UInt64 mr = job->kernel->mr;                                                                \
+        UInt64 nr = job->kernel->nr;                                                                \
+        UInt64 kc = job->kc;                                                                        \
+        UInt64 n = job->n;                                                                          \
+        bool accumulate = job->p0 > 0;                                                              \
+        T* packed_a = cast(T*)job->packed_a + cast(UInt64)worker * job->mc * MATMUL_KC;             \
+        matmul_pack_a_##S(job, packed_a, i0, rows);                                                 \
+                                                                                                    \
+        T tile[MATMUL_MAX_TILE];                                                                    \
+        T* c = cast(T*)job->c->data;                                                                \
+        for(UInt64 s = s_begin; s < s_end; s++) {                                                   \
+            UInt64 j = job->j0 + s * nr;                                                            \
+            UInt64 cols = matmul_min(nr, job->j0 + job->nc - j);                                    \
+            const T* strip_b = cast(const T*)job->packed_b + s * kc * nr;                           \
+            for(UInt64 y = 0; y < rows; y += mr) {                                                  \
+                const T* strip_a = packed_a + y / mr * kc * mr;                                     \
+                UInt64 height = matmul_min(mr, rows - y);                                           \
+                T* out = c + (i0 + y) * n + j;                                                      \
+                if(height == mr && cols == nr) {                                                    \
+                    job->kernel->fn(kc, strip_a, strip_b, out, n, accumulate);                      \
+                    continue;                                                                       \
+                }                                                                                   \
+                job->kernel->fn(kc, strip_a, strip_b, tile, nr, false);                             \
+                for(UInt64 r = 0; r < height; r++)                                                  \
+                    for(UInt64 x = 0; x < cols; x++)                                                \
+                        out[r * n + x] = accumulate ? out[r * n + x] + tile[r * nr + x] : tile[r * nr + x]; \
+            }                                                                                       \
+        }                                                                                           \
+    }
+
+MATMUL_LOOPS(f32, Float32)
+MATMUL_LOOPS(f64, Float64)
+
+static void matmul_pack_b_task(void* ctx, UInt64 index, UInt32 worker) {
+    MatmulJob* job = cast(MatmulJob*)ctx;
+    (void)worker;
+    if(job->c->dtype == TensorDTypeFloat64)
+        matmul_pack_b_f64(job, index);
+    else
+        matmul_pack_b_f32(job, index);
+}
+
+// Task `index` is range `index % num_parts` of the strips of `B`, for block `index / num_parts` of `A`
+static void matmul_block_task(void* ctx, UInt64 index, UInt32 worker) {
+    MatmulJob* job = cast(MatmulJob*)ctx;
+    UInt64 block = index / job->num_parts;
+    UInt64 part = index % job->num_parts;
+    UInt64 num_strips = (job->nc + job->kernel->nr - 1) / job->kernel->nr;
+    UInt64 i0 = block * job->mc;
+    UInt64 rows = matmul_min(job->mc, job->m - i0);
+    UInt64 s_begin = part * num_strips / job->num_parts;
+    UInt64 s_end = (part + 1) * num_strips / job->num_parts;
+    if(s_begin == s_end)
+        return;
+    if(job->c->dtype == TensorDTypeFloat64)
+        matmul_block_f64(job, worker, i0, rows, s_begin, s_end);
+    else
+        matmul_block_f32(job, worker, i0, rows, s_begin, s_end);
+}
+
+bool tensor_matmul(Tensor* c, Tensor* a, Tensor* b, ThreadPool* pool) {
+    if(!tensor_dtype_is_float(a->dtype) || b->dtype != a->dtype || c->dtype != a->dtype || a->rank != 2 ||
+       b->rank != 2 || a->shape[1] != b->shape[0] || (b->shape[1] != 0 && a->shape[0] > UINT64_MAX / b->shape[1]))
+        return false;
+    CORETEN_ENFORCE(c != a && c != b, "The product can't overwrite a factor");
+
+    UInt64 m = a->shape[0];
+    UInt64 k = a->shape[1];
+    UInt64 n = b->shape[1];
+    UInt64 c_len = m * n;
+    UInt64 shape[2] = { m, n };
+    // Every element of `c` is overwritten, so none of them are copied if it grows
+    c->len = 0;
+    tensor_reserve(c, c_len);
+    c->len = c_len;
+    tensor_reshape(c, 2, shape);
+    UInt64 size = tensor_dtype_size(c->dtype);
+    if(k == 0) {
+        if(c_len > 0)
+            memset(c->data, 0, c_len * size);
+        return true;
+    }
+    if(c_len == 0)
+        return true;
+
+    MatmulJob job;
+    memset(&job, 0, sizeof(job));
+    job.kernel = matmul_kernel(c->dtype);
+    job.a = a;
+    job.b = b;
+    job.c = c;
+    job.m = m;
+    job.k = k;
+    job.n = n;
+    UInt64 mr = job.kernel->mr;
+    UInt64 nr = job.kernel->nr;
+    UInt64 max_nc = MATMUL_B_BYTES / (MATMUL_KC * size) / nr * nr;
+
+    // Smaller blocks of `A` if there aren't enough for every worker, and ranges of strips of `B` if that isn't enough
+    UInt32 num_workers = threadpool_size(pool);
+    UInt64 rows_per_worker = (m + num_workers - 1) / num_workers;
+    job.mc = matmul_min(MATMUL_MC / mr * mr, (rows_per_worker + mr - 1) / mr * mr);
+    job.num_blocks = (m + job.mc - 1) / job.mc;
+
+    job.packed_b = matmul_alloc(MATMUL_KC * max_nc * size);
+    job.packed_a = matmul_alloc(num_workers * job.mc * MATMUL_KC * size);
+    for(job.j0 = 0; job.j0 < n; job.j0 += max_nc) {
+        job.nc = matmul_min(max_nc, n - job.j0);
+        UInt64 num_strips = (job.nc + nr - 1) / nr;
+        job.num_parts = 1;
+        if(job.num_blocks < num_workers)
+            job.num_parts = matmul_min((num_workers + job.num_blocks - 1) / job.num_blocks, num_strips);
+        for(job.p0 = 0; job.p0 < k; job.p0 += MATMUL_KC) {
+            job.kc = matmul_min(MATMUL_KC, k - job.p0);
+            threadpool_parallel_for(pool, num_strips, matmul_pack_b_task, &job);
+            threadpool_parallel_for(pool, job.num_blocks * job.num_parts, matmul_block_task, &job);
+        }
+    }
+    matmul_dealloc(job.packed_a);
+    matmul_dealloc(job.packed_b);
+    return true;
+}
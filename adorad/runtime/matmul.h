@@ -0,0 +1,53 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#ifndef ADORAD_RUNTIME_MATMUL_H
+#define ADORAD_RUNTIME_MATMUL_H
+
+#include <adorad/core/types.h>
+#include <adorad/core/thread.h>
+#include <adorad/runtime/tensor.h>
+
+/*
+    Matrix multiplication (GEMM) of float tensors, without an external BLAS.
+
+    Matrices are tensors of rank 2 (`Tensor<Float64, 2>`), so element `(i, j)` of an `m x n` matrix is element
+    `i * n + j` of its tensor (see <adorad/runtime/tensor.h>). The product
+    is computed the way BLIS/GotoBLAS do it:
+        1. `B` is split into panels of `KC` rows and `NC` columns, each packed into `NR`-wide column strips (so the
+           micro-kernel reads it sequentially, and a panel stays in the L3 cache).
+        2. For every panel, `A` is split into blocks of `MC` rows, each packed into `MR`-tall row strips (that stay in
+           the L2 cache). Blocks (and, if there are fewer blocks than workers, ranges of strips of `B`) are spread
+           over the thread pool.
+        3. A register-tiled micro-kernel computes every `MR x NR` tile of `C` from a strip of `A` and a strip of `B`,
+           keeping the whole tile in vector registers across the `KC` steps. Tiles at the edges of `C` go through a
+           scratch tile.
+    The micro-kernels are picked like the other tensor kernels (see `tensor_isa()`):
+        1. AVX-512 (F): `6 x 16` (Float64) / `6 x 32` (Float32) tiles
+        2. AVX2 + FMA: `6 x 8` / `6 x 16` tiles
+        3. Scalar: `4 x 4` tiles, in plain C
+    Sums are accumulated in a different order than a naive triple loop's, so results can differ in the last bits.
+*/
+
+// Block sizes (in elements of `A`/`B`). `MC` and `NC` are rounded down to multiples of the tile size.
+#define MATMUL_KC       256
+#define MATMUL_MC       144
+// Bytes of a packed panel of `B`
+#define MATMUL_B_BYTES  (4 << 20)
+
+// `c = a * b`, where `a` is `m x k` and `b` is `k x n`. All three have the same float dtype, and `c` (which must own its
+// elements, and can't be `a` or `b`) becomes `m x n`. Runs on the workers of `pool` (null: only the calling thread).
+// Returns false if the dtypes don't match, or `a` and `b` aren't matrices that can be multiplied.
+bool tensor_matmul(Tensor* c, Tensor* a, Tensor* b, ThreadPool* pool);
+
+#endif // ADORAD_RUNTIME_MATMUL_H
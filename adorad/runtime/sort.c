@@ -0,0 +1,348 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <adorad/core/debug.h>
+#include <adorad/core/misc.h>
+#include <adorad/runtime/sort.h>
+
+// An encoded key, and the index of the element it's the key of (for `tensor_sort_by_key()`)
+typedef struct SortPair {
+    UInt64 key;
+    UInt64 index;
+} SortPair;
+
+static void* sort_alloc(UInt64 bytes) {
+    void* data = malloc(bytes > 0 ? bytes : 1);
+    CORETEN_ENFORCE_NN(data, "Could not allocate memory. Memory full.");
+    return data;
+}
+
+static inline Byte* sort_ptr(Tensor* tensor, UInt64 index) {
+    return tensor->data + cast(Int64)index * tensor->stride * cast(Int64)tensor_dtype_size(tensor->dtype);
+}
+
+// Keys -----------------------------------------------------------------------------------------------------------------
+
+// The key of the element at `ptr`: keys compare (as unsigned integers) the way the elements do
+static UInt64 sort_encode(TensorDType dtype, const Byte* ptr, bool descending) {
+    UInt64 key = 0;
+    switch(dtype) {
+        case TensorDTypeInt16: {
+            Int16 x;
+            memcpy(&x, ptr, sizeof(x));
+            key = cast(UInt16)x ^ 0x8000u;
+            break;
+        }
+        case TensorDTypeInt32: {
+            Int32 x;
+            memcpy(&x, ptr, sizeof(x));
+            key = cast(UInt32)x ^ 0x80000000u;
+            break;
+        }
+        case TensorDTypeInt64: {
+            Int64 x;
+            memcpy(&x, ptr, sizeof(x));
+            key = cast(UInt64)x ^ (cast(UInt64)1 << 63);
+            break;
+        }
+        case TensorDTypeFloat32: {
+            UInt32 bits;
+            memcpy(&bits, ptr, sizeof(bits));
+            // NaNs lose their sign, so that they're all larger than infinity
+            if((bits & 0x7FFFFFFFu) > 0x7F800000u)
+                bits &= 0x7FFFFFFFu;
+            key = (bits & 0x80000000u) ? cast(UInt32)~bits : bits | 0x80000000u;
+            break;
+        }
+        case TensorDTypeFloat64: {
+            UInt64 bits;
+            memcpy(&bits, ptr, sizeof(bits));
+            UInt64 sign = cast(UInt64)1 << 63;
+            if((bits & ~sign) > 0x7FF0000000000000ULL)
+                bits &= ~sign;
+            key = (bits & sign) ? ~bits : bits | sign;
+            break;
+        }
+        default:
+            CORETEN_ENFORCE(false, "Unknown dtype");
+    }
+    return descending ? ~key : key;
+}
+
+// The element `key` is the key of, at `ptr`
+static void sort_decode(TensorDType dtype, UInt64 key, Byte* ptr, bool descending) {
+    if(descending)
+        key = ~key;
+    switch(dtype) {
+        case TensorDTypeInt16: {
+            UInt16 x = cast(UInt16)(key ^ 0x8000u);
+            memcpy(ptr, &x, sizeof(x));
+            break;
+        }
+        case TensorDTypeInt32: {
+            UInt32 x = cast(UInt32)(key ^ 0x80000000u);
+            memcpy(ptr, &x, sizeof(x));
+            break;
+        }
+        case TensorDTypeInt64: {
+            UInt64 x = key ^ (cast(UInt64)1 << 63);
+            memcpy(ptr, &x, sizeof(x));
+            break;
+        }
+        case TensorDTypeFloat32: {
+            UInt32 bits = cast(UInt32)key;
+            bits = (bits & 0x80000000u) ? bits ^ 0x80000000u : ~bits;
+            memcpy(ptr, &bits, sizeof(bits));
+            break;
+        }
+        case TensorDTypeFloat64: {
+            UInt64 sign = cast(UInt64)1 << 63;
+            UInt64 bits = (key & sign) ? key ^ sign : ~key;
+            memcpy(ptr, &bits, sizeof(bits));
+            break;
+        }
+        default:
+            CORETEN_ENFORCE(false, "Unknown dtype");
+    }
+}
+
+// Sorting keys ---------------------------------------------------------------------------------------------------------
+
+#define SORT_LESS_KEY(x, y)     ((x) < (y))
+// Ties are broken by index, so that sorting pairs with pdqsort is stable too
+#define SORT_LESS_PAIR(x, y)    ((x).key < (y).key || ((x).key == (y).key && (x).index < (y).index))
+#define SORT_KEY(x)             (x)
+#define SORT_PAIR_KEY(x)        ((x).key)
+
+SORT_DEFINE_PDQ(sort_pdq_key, UInt64, SORT_LESS_KEY)
+SORT_DEFINE_PDQ(sort_pdq_pair, SortPair, SORT_LESS_PAIR)
+
+/*
+    `sort_##S(data, tmp, n)` sorts the `n` elements of `data` (with `tmp` as scratch space for as many). The radix sort
+    counts the digits of all 8 passes in one read of the elements, and skips the passes where every element has the
+    same digit.
+
+    `sort_merge_##S()` merges the sorted runs `a` and `b` into `dst`, from output element `begin` up to `end` (so one
+    merge can be split between workers). Equal elements are taken from `a` first.
+*/
+#define SORT_DEFINE(S, T, KEY, PDQ)                                                                 \
+    static void sort_##S(T* data, T* tmp, UInt64 n) {                                               \
+        if(n < SORT_RADIX_MIN) {                                                                    \
+            PDQ(data, n);                                                                           \
+            return;                                                                                 \
+        }                                                                                           \
+        UInt64 (*counts)[256] = cast(UInt64(*)[256])calloc(8 * 256, sizeof(UInt64));                \
+        CORETEN_ENFORCE_NN(counts, "Could not allocate memory. Memory full.");                      \
+        for(UInt64 i = 0; i < n; i++) {                                                             \
+            UInt64 key = KEY(data[i]);                                                              \
+            for(UInt32 d = 0; d < 8; d++)                                                           \
+                counts[d][(key >> (d * 8)) & 0xFF]++;                                               \
+        }                                                                                           \
+        T* src = data;                                                                              \
+        T* dst = tmp;                                                                               \
+        for(UInt32 d = 0; d < 8; d++) {                                                             \
+            UInt32 shift = d * 8;                                                                   \
+            UInt64* count = counts[d];                                                              \
+            if(count[(KEY(src[0]) >> shift) & 0xFF] == n)                                           \
+                continue;                                                                           \
+            UInt64 offset = 0;                                                                      \
+            for(UInt32 digit = 0; digit < 256; digit++) {                                           \
+                UInt64 c = count[digit];                                                            \
+                count[digit] = offset;                                                              \
+                offset += c;                                                                        \
+            }                                                                                       \
+            for(UInt64 i = 0; i < n; i++)                                                           \
+                dst[count[(KEY(src[i]) >> shift) & 0xFF]++] = src[i];                               \
+            T* swap = src;                                                                          \
+            src = dst;                                                                              \
+            dst = swap;                                                                             \
+        }                                                                                           \
+        if(src != data)                                                                             \
+            memcpy(data, src, n * sizeof(T));                                                       \
+        free(counts);                                                                               \
+    }                                                                                               \
+                                                                                                    \
+    /* How many of the first `k` elements of the merge of `a` and `b` come from `a` */              \
+    static UInt64 sort_corank_##S(const T* a, UInt64 na, const T* b, UInt64 nb, UInt64 k) {         \
+        UInt64 lo = k > nb ? k - nb : 0;                                                            \
+        UInt64 hi = k < na ? k : na;                                                                \
+        while(lo < hi) {                                                                            \
+            UInt64 i = lo + (hi - lo) / 2;                                                          \
+            UInt64 j = k - i;                                                                       \
+            if(j > 0 && i < na && !(KEY(b[j - 1]) < KEY(a[i])))                                     \
+                lo = i + 1;                                                                         \
+            else                                                                                    \
+                hi = i;                                                                             \
+        }                                                                                           \
+        return lo;                                                                                  \
+    }                                                                                               \
+                                                                                                    \
+    static void sort_merge_##S(T* dst, const T* a, UInt64 na, const T* b, UInt64 nb, UInt64 begin, UInt64 end) { \
+        UInt64 i = sort_corank_##S(a, na, b, nb, begin);                                            \
+        UInt64 j = begin - i;                                                                       \
+        UInt64 i_end = sort_corank_##S(a, na, b, nb, end);                                          \
+        UInt64 j_end = end - i_end;                                                                 \
+        T* out = dst + begin;                                                                       \
+        while(i < i_end && j < j_end) {                                                             \
+            if(KEY(b[j]) < KEY(a[i]))                                                               \
+                *out++ = b[j++];                                                                    \
+            else                                                                                    \
+                *out++ = a[i++];                                                                    \
+        }                                                                                           \
+        while(i < i_end)                                                                            \
+            *out++ = a[i++];                                                                        \
+        while(j < j_end)                                                                            \
+            *out++ = b[j++];                                                                        \
+    }
+
+SORT_DEFINE(key, UInt64, SORT_KEY, sort_pdq_key)
+SORT_DEFINE(pair, SortPair, SORT_PAIR_KEY, sort_pdq_pair)
+
+// Sorting in parallel --------------------------------------------------------------------------------------------------
+
+/*
+    A parallel sort: `num_runs` runs (one per worker), each sorted on its own, then merged pairwise (in
+    `log2(num_runs)` rounds) between `src` and `dst`. Every round splits every merge into `num_pieces` pieces of its
+    output, so all the workers are busy until the last one.
+*/
+typedef struct SortJob {
+    bool pairs;         // sorting `SortPair`s (or keys)
+    Byte* src;
+    Byte* dst;
+    UInt64 bounds[64 + 1];  // run `r` is `[bounds[r], bounds[r + 1])`
+    UInt64 num_runs;
+    UInt64 num_pieces;
+} SortJob;
+
+static void sort_run_task(void* ctx, UInt64 index, UInt32 worker) {
+    SortJob* job = cast(SortJob*)ctx;
+    (void)worker;
+    UInt64 lo = job->bounds[index];
+    UInt64 n = job->bounds[index + 1] - lo;
+    if(job->pairs)
+        sort_pair(cast(SortPair*)job->src + lo, cast(SortPair*)job->dst + lo, n);
+    else
+        sort_key(cast(UInt64*)job->src + lo, cast(UInt64*)job->dst + lo, n);
+}
+
+// Piece `index % num_pieces` of merge `index / num_pieces` (of runs `2m` and `2m + 1`, if there is one)
+static void sort_merge_task(void* ctx, UInt64 index, UInt32 worker) {
+    SortJob* job = cast(SortJob*)ctx;
+    (void)worker;
+    UInt64 m = index / job->num_pieces;
+    UInt64 piece = index % job->num_pieces;
+    UInt64 lo = job->bounds[2 * m];
+    UInt64 mid = job->bounds[2 * m + 1];
+    UInt64 hi = 2 * m + 2 <= job->num_runs ? job->bounds[2 * m + 2] : mid;
+    UInt64 len = hi - lo;
+    UInt64 begin = len * piece / job->num_pieces;
+    UInt64 end = len * (piece + 1) / job->num_pieces;
+    if(job->pairs) {
+        SortPair* src = cast(SortPair*)job->src;
+        sort_merge_pair(cast(SortPair*)job->dst + lo, src + lo, mid - lo, src + mid, hi - mid, begin, end);
+    } else {
+        UInt64* src = cast(UInt64*)job->src;
+        sort_merge_key(cast(UInt64*)job->dst + lo, src + lo, mid - lo, src + mid, hi - mid, begin, end);
+    }
+}
+
+// Sort the `n` keys (or pairs) of `data`, with `tmp` as scratch space
+static void sort_elems(void* data, void* tmp, UInt64 n, bool pairs, ThreadPool* pool) {
+    UInt64 num_workers = threadpool_size(pool);
+    if(num_workers > 64)
+        num_workers = 64;
+    if(n < SORT_PARALLEL_MIN || num_workers < 2) {
+        if(pairs)
+            sort_pair(cast(SortPair*)data, cast(SortPair*)tmp, n);
+        else
+            sort_key(cast(UInt64*)data, cast(UInt64*)tmp, n);
+        return;
+    }
+
+    UInt64 size = pairs ? sizeof(SortPair) : sizeof(UInt64);
+    SortJob job;
+    memset(&job, 0, sizeof(job));
+    job.pairs = pairs;
+    job.src = cast(Byte*)data;
+    job.dst = cast(Byte*)tmp;
+    job.num_runs = num_workers;
+    for(UInt64 r = 0; r <= job.num_runs; r++)
+        job.bounds[r] = n * r / job.num_runs;
+    threadpool_parallel_for(pool, job.num_runs, sort_run_task, &job);
+
+    while(job.num_runs > 1) {
+        UInt64 num_merges = (job.num_runs + 1) / 2;
+        job.num_pieces = (num_workers + num_merges - 1) / num_merges;
+        threadpool_parallel_for(pool, num_merges * job.num_pieces, sort_merge_task, &job);
+        // The merged runs start where every other run did
+        for(UInt64 m = 0; m < num_merges; m++)
+            job.bounds[m] = job.bounds[2 * m];
+        job.bounds[num_merges] = n;
+        job.num_runs = num_merges;
+        Byte* swap = job.src;
+        job.src = job.dst;
+        job.dst = swap;
+    }
+    if(job.src != cast(Byte*)data)
+        memcpy(data, job.src, n * size);
+}
+
+// Tensors --------------------------------------------------------------------------------------------------------------
+
+void tensor_sort(Tensor* tensor, bool descending, ThreadPool* pool) {
+    UInt64 n = tensor->len;
+    if(n < 2)
+        return;
+    UInt64* keys = cast(UInt64*)sort_alloc(n * sizeof(UInt64));
+    UInt64* tmp = cast(UInt64*)sort_alloc(n * sizeof(UInt64));
+    for(UInt64 i = 0; i < n; i++)
+        keys[i] = sort_encode(tensor->dtype, sort_ptr(tensor, i), descending);
+    sort_elems(keys, tmp, n, false, pool);
+    for(UInt64 i = 0; i < n; i++)
+        sort_decode(tensor->dtype, keys[i], sort_ptr(tensor, i), descending);
+    free(keys);
+    free(tmp);
+}
+
+bool tensor_sort_by_key(Tensor* tensor, Tensor* keys, bool descending, ThreadPool* pool) {
+    UInt64 n = tensor->len;
+    if(keys->len != n)
+        return false;
+    if(n < 2)
+        return true;
+    SortPair* pairs = cast(SortPair*)sort_alloc(n * sizeof(SortPair));
+    SortPair* tmp = cast(SortPair*)sort_alloc(n * sizeof(SortPair));
+    for(UInt64 i = 0; i < n; i++) {
+        pairs[i].key = sort_encode(keys->dtype, sort_ptr(keys, i), descending);
+        pairs[i].index = i;
+    }
+    sort_elems(pairs, tmp, n, true, pool);
+
+    // Gather the elements in their new order, then copy them back
+    UInt64 size = tensor_dtype_size(tensor->dtype);
+    Byte* elems = cast(Byte*)tmp;
+    CORETEN_ENFORCE(sizeof(SortPair) >= size, "Elements don't fit in the scratch space");
+    for(UInt64 i = 0; i < n; i++)
+        memcpy(elems + i * size, sort_ptr(tensor, pairs[i].index), size);
+    if(tensor->stride == 1) {
+        memcpy(tensor->data, elems, n * size);
+    } else {
+        for(UInt64 i = 0; i < n; i++)
+            memcpy(sort_ptr(tensor, i), elems + i * size, size);
+    }
+    free(pairs);
+    free(tmp);
+    return true;
+}
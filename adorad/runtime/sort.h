@@ -0,0 +1,267 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#ifndef ADORAD_RUNTIME_SORT_H
+#define ADORAD_RUNTIME_SORT_H
+
+#include <adorad/core/types.h>
+#include <adorad/core/thread.h>
+#include <adorad/runtime/tensor.h>
+
+/*
+    Sorting tensors.
+
+    `tensor_sort()` sorts the elements of a tensor, and `tensor_sort_by_key()` sorts them by the elements of another
+    tensor (their keys). `xs.sort()` and `xs.sort(a > b)` are the first; a comparator that compares the same expression
+    of `a` and `b` (`users.sort(a.age < b.age)`) is the second, with the compiler computing the key of every element
+    once, in a loop of its own (so the comparator is inlined, and never called through a function pointer).
+
+    Neither compares elements one pair at a time:
+        1. Every element (or key) is encoded as a 64-bit unsigned integer that sorts the same way: integers get their
+           sign bit flipped, negative floats get all of their bits flipped and other floats just their sign bit. A
+           descending sort flips every bit of that.
+        2. Fewer than `SORT_RADIX_MIN` encoded elements are sorted with pdqsort. More are sorted with an LSD radix sort
+           (8 bits per pass), which skips the passes where every element has the same digit (all but 2 of them for
+           `Int16`s, for instance).
+        3. `SORT_PARALLEL_MIN` elements or more are split into one run per worker of the thread pool. The runs are
+           sorted in parallel, then merged pairwise, and every merge is split into pieces of the output (found by a
+           binary search for where they start in both runs) that are merged in parallel too.
+    Both sorts are stable: elements that compare equal keep their order. NaNs sort after every other float (before
+    them, in a descending sort) and lose their sign, and `-0.0` sorts before `0.0`.
+
+    `SORT_DEFINE_PDQ()` defines a pdqsort (pattern-defeating quicksort) of an array of any type, with the comparison
+    inlined. It isn't stable.
+*/
+
+// Sorts shorter than this use pdqsort, instead of a radix sort
+#define SORT_RADIX_MIN          256
+// Sorts at least this long run on the thread pool
+#define SORT_PARALLEL_MIN       (1 << 16)
+// pdqsort: partitions shorter than this are insertion sorted, and longer than this take the ninther as the pivot
+#define SORT_INSERTION_MAX      24
+#define SORT_NINTHER_MIN        128
+
+// Sort the elements of `tensor` (of any dtype, shape and stride) in place. Runs on the workers of `pool` (null: only
+// the calling thread) if there are enough of them.
+void tensor_sort(Tensor* tensor, bool descending, ThreadPool* pool);
+// Sort the elements of `tensor` by the elements of `keys` (in place, and stable). Returns false if their lengths
+// differ.
+bool tensor_sort_by_key(Tensor* tensor, Tensor* keys, bool descending, ThreadPool* pool);
+
+// pdqsort ------------------------------------------------------------------------------------------------------------
+
+/*
+    `SORT_DEFINE_PDQ(NAME, T, LESS)` defines `static void NAME(T* data, UInt64 n)`, which sorts `data` so that
+    `LESS(data[i + 1], data[i])` is false for every `i`. `LESS(x, y)` is an expression of the two elements.
+
+    Partitions are Hoare-style around a median of 3 (or the ninther), with the pivot's equal elements put on the left
+    when it's equal to the element before the partition (so runs of equal elements take linear time). A partition
+    that didn't move anything is assumed to be sorted, and gets an insertion sort that gives up after 8 moves. Too many
+    lopsided partitions (more than log2(n)) swap a few elements around to break the pattern, and then fall back to
+    heapsort, so sorting never takes more than O(n log n).
+*/
+#define SORT_DEFINE_PDQ(NAME, T, LESS)                                                                  \
+    static void NAME##_insertion(T* data, UInt64 n) {                                                   \
+        for(UInt64 i = 1; i < n; i++) {                                                                 \
+            T x = data[i];                                                                              \
+            UInt64 j = i;                                                                               \
+            for(; j > 0 && LESS(x, data[j - 1]); j--)                                                   \
+                data[j] = data[j - 1];                                                                  \
+            data[j] = x;                                                                                \
+        }                                                                                               \
+    }                                                                                                   \
+                                                                                                        \
+    /* An insertion sort that gives up (returning false) after 8 elements moved */                    \
+    static bool NAME##_partial_insertion(T* data, UInt64 n) {                                           \
+        UInt64 moved = 0;                                                                               \
+        for(UInt64 i = 1; i < n; i++) {                                                                 \
+            if(!LESS(data[i], data[i - 1]))                                                             \
+                continue;                                                                               \
+            T x = data[i];                                                                              \
+            UInt64 j = i;                                                                               \
+            for(; j > 0 && LESS(x, data[j - 1]); j--)                                                   \
+                data[j] = data[j - 1];                                                                  \
+            data[j] = x;                                                                                \
+            moved += i - j;                                                                             \
+            if(moved > 8)                                                                               \
+                return false;                                                                           \
+        }                                                                                               \
+        return true;                                                                                    \
+    }                                                                                                   \
+                                                                                                        \
+    static void NAME##_sift_down(T* data, UInt64 n, UInt64 root) {                                      \
+        T x = data[root];                                                                               \
+        for(UInt64 child = 2 * root + 1; child < n; child = 2 * root + 1) {                             \
+            if(child + 1 < n && LESS(data[child], data[child + 1]))                                     \
+                child++;                                                                                \
+            if(!LESS(x, data[child]))                                                                   \
+                break;                                                                                  \
+            data[root] = data[child];                                                                   \
+            root = child;                                                                               \
+        }                                                                                               \
+        data[root] = x;                                                                                 \
+    }                                                                                                   \
+                                                                                                        \
+    static void NAME##_heapsort(T* data, UInt64 n) {                                                    \
+        for(UInt64 i = n / 2; i > 0; i--)                                                               \
+            NAME##_sift_down(data, n, i - 1);                                                           \
+        for(UInt64 end = n; end > 1; end--) {                                                           \
+            T x = data[0];                                                                              \
+            data[0] = data[end - 1];                                                                    \
+            data[end - 1] = x;                                                                          \
+            NAME##_sift_down(data, end - 1, 0);                                                         \
+        }                                                                                               \
+    }                                                                                                   \
+                                                                                                        \
+    /* Order `data[a]`, `data[b]` and `data[c]`, so that the median is `data[b]` */                    \
+    static inline void NAME##_sort3(T* data, UInt64 a, UInt64 b, UInt64 c) {                           \
+        T x;                                                                                            \
+        if(LESS(data[b], data[a])) { x = data[a]; data[a] = data[b]; data[b] = x; }                     \
+        if(LESS(data[c], data[b])) { x = data[b]; data[b] = data[c]; data[c] = x; }                     \
+        if(LESS(data[b], data[a])) { x = data[a]; data[a] = data[b]; data[b] = x; }                     \
+    }                                                                                                   \
+                                                                                                        \
+    /* Partition around `data[0]`: elements less than it go on its left. Returns where it ends up, and */\
+    /* sets `*moved` to whether anything had to be swapped. */                                          \
+    static UInt64 NAME##_partition_right(T* data, UInt64 n, bool* moved) {                              \
+        T pivot = data[0];                                                                              \
+        UInt64 first = 1;                                                                               \
+        UInt64 last = n;                                                                                \
+        while(first < n && LESS(data[first], pivot))                                                    \
+            first++;                                                                                    \
+        if(first == 1)                                                                                  \
+            while(first < last && !LESS(data[last - 1], pivot))                                         \
+                last--;                                                                                 \
+        else                                                                                            \
+            while(!LESS(data[last - 1], pivot))                                                         \
+                last--;                                                                                 \
+        *moved = first < last;                                                                          \
+        while(first < last) {                                                                           \
+            T x = data[first];                                                                          \
+            data[first] = data[last - 1];                                                               \
+            data[last - 1] = x;                                                                         \
+            first++;                                                                                    \
+            while(LESS(data[first], pivot))                                                             \
+                first++;                                                                                \
+            last--;                                                                                     \
+            while(!LESS(data[last - 1], pivot))                                                         \
+                last--;                                                                                 \
+        }                                                                                               \
+        UInt64 at = first - 1;                                                                          \
+        data[0] = data[at];                                                                             \
+        data[at] = pivot;                                                                               \
+        return at;                                                                                      \
+    }                                                                                                   \
+                                                                                                        \
+    /* Partition around `data[0]`, with the elements equal to it on its left. Returns where it ends up. */\
+    static UInt64 NAME##_partition_left(T* data, UInt64 n) {                                            \
+        T pivot = data[0];                                                                              \
+        UInt64 first = 0;                                                                               \
+        UInt64 last = n;                                                                                \
+        while(LESS(pivot, data[last - 1]))                                                              \
+            last--;                                                                                     \
+        if(last == n)                                                                                   \
+            while(first + 1 < last && !LESS(pivot, data[first + 1]))                                    \
+                first++;                                                                                \
+        else                                                                                            \
+            while(!LESS(pivot, data[first + 1]))                                                        \
+                first++;                                                                                \
+        first++;                                                                                        \
+        while(first < last - 1) {                                                                       \
+            T x = data[first];                                                                          \
+            data[first] = data[last - 1];                                                               \
+            data[last - 1] = x;                                                                         \
+            last--;                                                                                     \
+            while(LESS(pivot, data[last - 1]))                                                          \
+                last--;                                                                                 \
+            first++;                                                                                    \
+            while(!LESS(pivot, data[first]))                                                            \
+                first++;                                                                                \
+        }                                                                                               \
+        UInt64 at = last - 1;                                                                           \
+        data[0] = data[at];                                                                             \
+        data[at] = pivot;                                                                               \
+        return at;                                                                                      \
+    }                                                                                                   \
+                                                                                                        \
+    static void NAME##_loop(T* data, UInt64 n, UInt32 bad_allowed, bool leftmost) {                    \
+        while(n > SORT_INSERTION_MAX) {                                                                 \
+            /* The median of 3 (or of 3 medians of 3) goes to `data[0]` */                              \
+            UInt64 half = n / 2;                                                                        \
+            if(n > SORT_NINTHER_MIN) {                                                                  \
+                NAME##_sort3(data, 0, half, n - 1);                                                     \
+                NAME##_sort3(data, 1, half - 1, n - 2);                                                 \
+                NAME##_sort3(data, 2, half + 1, n - 3);                                                 \
+                NAME##_sort3(data, half - 1, half, half + 1);                                           \
+            } else {                                                                                    \
+                NAME##_sort3(data, half, 0, n - 1);                                                     \
+            }                                                                                           \
+            T x = data[0];                                                                              \
+            data[0] = data[half];                                                                       \
+            data[half] = x;                                                                             \
+                                                                                                        \
+            /* Equal to the element before this partition (which is <= all of it): put the equal ones */\
+            /* on the left, and they're done */                                                         \
+            if(!leftmost && !LESS(data[-1], data[0])) {                                                 \
+                UInt64 at = NAME##_partition_left(data, n);                                             \
+                data += at + 1;                                                                         \
+                n -= at + 1;                                                                            \
+                continue;                                                                               \
+            }                                                                                           \
+                                                                                                        \
+            bool moved = false;                                                                         \
+            UInt64 at = NAME##_partition_right(data, n, &moved);                                        \
+            UInt64 left = at;                                                                           \
+            UInt64 right = n - at - 1;                                                                  \
+            if(left < n / 8 || right < n / 8) {                                                         \
+                if(--bad_allowed == 0) {                                                                \
+                    NAME##_heapsort(data, n);                                                           \
+                    return;                                                                             \
+                }                                                                                       \
+                /* Break the pattern that caused it */                                                  \
+                if(left >= SORT_INSERTION_MAX) {                                                        \
+                    T y = data[0]; data[0] = data[left / 4]; data[left / 4] = y;                        \
+                    y = data[at - 1]; data[at - 1] = data[at - left / 4]; data[at - left / 4] = y;      \
+                }                                                                                       \
+                if(right >= SORT_INSERTION_MAX) {                                                       \
+                    T y = data[at + 1]; data[at + 1] = data[at + 1 + right / 4];                        \
+                    data[at + 1 + right / 4] = y;                                                       \
+                    y = data[n - 1]; data[n - 1] = data[n - right / 4]; data[n - right / 4] = y;        \
+                }                                                                                       \
+            } else if(!moved && NAME##_partial_insertion(data, at) &&                                   \
+                      NAME##_partial_insertion(data + at + 1, right)) {                                 \
+                return;                                                                                 \
+            }                                                                                           \
+                                                                                                        \
+            /* Recurse into the smaller side, and loop on the other */                                  \
+            if(left < right) {                                                                          \
+                NAME##_loop(data, left, bad_allowed, leftmost);                                         \
+                data += at + 1;                                                                         \
+                n = right;                                                                              \
+                leftmost = false;                                                                       \
+            } else {                                                                                    \
+                NAME##_loop(data + at + 1, right, bad_allowed, false);                                  \
+                n = left;                                                                               \
+            }                                                                                           \
+        }                                                                                               \
+        NAME##_insertion(data, n);                                                                      \
+    }                                                                                                   \
+                                                                                                        \
+    static void NAME(T* data, UInt64 n) {                                                               \
+        UInt32 log2 = 0;                                                                                \
+        for(UInt64 m = n; m > 1; m >>= 1)                                                               \
+            log2++;                                                                                     \
+        NAME##_loop(data, n, log2 + 1, true);                                                           \
+    }
+
+#endif // ADORAD_RUNTIME_SORT_H
@@ -0,0 +1,958 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <adorad/core/cpu.h>
+#include <adorad/core/debug.h>
+#include <adorad/core/misc.h>
+#include <adorad/core/os_defs.h>
+#include <adorad/runtime/tensor.h>
+
+#if defined(CORETEN_SIMD_X86_DISPATCH) && defined(CORETEN_SIMD_SSE2)
+    #include <immintrin.h>
+    #define TENSOR_HAVE_X86     1
+#endif // CORETEN_SIMD_X86_DISPATCH
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif // _MSC_VER
+
+// Index of the lowest set bit in `bits` (`bits` must be non-zero)
+static CORETEN_ALWAYS_INLINE UInt64 tensor_lowest_bit(UInt64 bits) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return index;
+#else
+    return cast(UInt64)__builtin_ctzll(bits);
+#endif // _MSC_VER
+}
+
+static CORETEN_ALWAYS_INLINE UInt64 tensor_popcount(UInt64 bits) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return __popcnt64(bits);
+#else
+    return cast(UInt64)__builtin_popcountll(bits);
+#endif // _MSC_VER
+}
+
+// Integer division, where `INT_MIN / -1` wraps around (to `INT_MIN`) instead of trapping. `b` isn't 0.
+static inline Int64 tensor_div_int(Int64 a, Int64 b) {
+    return b == -1 ? cast(Int64)(0 - cast(UInt64)a) : a / b;
+}
+
+/*
+    Scalar operations on elements of type `T` (the scalar kernels, and the elements the vector loops leave over)
+*/
+#define TENSOR_INT_ADD(T, a, b)     cast(T)(cast(UInt64)(a) + cast(UInt64)(b))
+#define TENSOR_INT_SUB(T, a, b)     cast(T)(cast(UInt64)(a) - cast(UInt64)(b))
+#define TENSOR_INT_MUL(T, a, b)     cast(T)(cast(UInt64)(a) * cast(UInt64)(b))
+#define TENSOR_INT_DIV(T, a, b)     cast(T)tensor_div_int((a), (b))
+#define TENSOR_FLOAT_ADD(T, a, b)   cast(T)((a) + (b))
+#define TENSOR_FLOAT_SUB(T, a, b)   cast(T)((a) - (b))
+#define TENSOR_FLOAT_MUL(T, a, b)   cast(T)((a) * (b))
+#define TENSOR_FLOAT_DIV(T, a, b)   cast(T)((a) / (b))
+// Like `minps`/`maxps` (the second operand if either is NaN)
+#define TENSOR_MIN(T, a, b)         ((a) < (b) ? (a) : (b))
+#define TENSOR_MAX(T, a, b)         ((a) > (b) ? (a) : (b))
+#define TENSOR_CMP(a, b, cmp)                                                           \
+    ((cmp) == TensorCmpEq ? (a) == (b) : (cmp) == TensorCmpNe ? (a) != (b) :            \
+     (cmp) == TensorCmpLt ? (a) < (b) : (cmp) == TensorCmpLe ? (a) <= (b) :             \
+     (cmp) == TensorCmpGt ? (a) > (b) : (a) >= (b))
+
+/*
+    Vector operations, by instruction set and element type: `P_V` is the vector type, `P_W` how many elements it
+    holds, and `P_CMP()` compares two vectors into a bitmask (one bit per element). Operations the instruction set has
+    no instruction for are `P_HAS_<OP>` 0 (and never run).
+    `TENSOR_NONE` is the scalar kernels': they have no vector loops at all.
+*/
+#define TENSOR_NONE_V                   int
+#define TENSOR_NONE_W                   1
+#define TENSOR_NONE_LOAD(p)             0
+#define TENSOR_NONE_STORE(p, v)         ((void)(v))
+#define TENSOR_NONE_SET1(x)             0
+#define TENSOR_NONE_OP(a, b)            (a)
+#define TENSOR_NONE_CMP(a, b, cmp)      0
+#define TENSOR_NONE_HAS_ARITH           0
+#define TENSOR_NONE_HAS_MUL             0
+#define TENSOR_NONE_HAS_DIV             0
+#define TENSOR_NONE_HAS_MINMAX          0
+#define TENSOR_NONE_ADD                 TENSOR_NONE_OP
+#define TENSOR_NONE_SUB                 TENSOR_NONE_OP
+#define TENSOR_NONE_MUL                 TENSOR_NONE_OP
+#define TENSOR_NONE_DIV                 TENSOR_NONE_OP
+#define TENSOR_NONE_MIN                 TENSOR_NONE_OP
+#define TENSOR_NONE_MAX                 TENSOR_NONE_OP
+
+#if defined(TENSOR_HAVE_X86)
+    #define TENSOR_AVX2                 CORETEN_TARGET("avx2")
+    #define TENSOR_AVX512               CORETEN_TARGET("avx512f,avx512bw")
+
+    // AVX2 integer comparisons only come in `==` and `>` (the rest swap the operands and/or negate them)
+    #define TENSOR_AVX2_CMP_INT(NAME, EQ, GT, BITS, ALL)                                \
+        TENSOR_AVX2 static CORETEN_ALWAYS_INLINE UInt64 NAME(__m256i a, __m256i b, TensorCmp cmp) {     \
+            __m256i r;                                                                  \
+            UInt64 invert = 0;                                                          \
+            switch(cmp) {                                                               \
+                case TensorCmpEq: r = EQ(a, b); break;                                  \
+                case TensorCmpNe: r = EQ(a, b); invert = ALL; break;                    \
+                case TensorCmpLt: r = GT(b, a); break;                                  \
+                case TensorCmpLe: r = GT(a, b); invert = ALL; break;                    \
+                case TensorCmpGt: r = GT(a, b); break;                                  \
+                default: r = GT(b, a); invert = ALL; break;                             \
+            }                                                                           \
+            return (BITS(r)) ^ invert;                                                  \
+        }
+
+    #define TENSOR_AVX2_BITS_16(r)      cast(UInt64)cast(UInt32)_mm_movemask_epi8(                      \
+                                            _mm_packs_epi16(_mm256_castsi256_si128(r), _mm256_extracti128_si256(r, 1)))
+    #define TENSOR_AVX2_BITS_32(r)      cast(UInt64)cast(UInt32)_mm256_movemask_ps(_mm256_castsi256_ps(r))
+    #define TENSOR_AVX2_BITS_64(r)      cast(UInt64)cast(UInt32)_mm256_movemask_pd(_mm256_castsi256_pd(r))
+    TENSOR_AVX2_CMP_INT(tensor_avx2_cmp_i16, _mm256_cmpeq_epi16, _mm256_cmpgt_epi16, TENSOR_AVX2_BITS_16, 0xFFFF)
+    TENSOR_AVX2_CMP_INT(tensor_avx2_cmp_i32, _mm256_cmpeq_epi32, _mm256_cmpgt_epi32, TENSOR_AVX2_BITS_32, 0xFF)
+    TENSOR_AVX2_CMP_INT(tensor_avx2_cmp_i64, _mm256_cmpeq_epi64, _mm256_cmpgt_epi64, TENSOR_AVX2_BITS_64, 0xF)
+
+    // Floats compare false if either is NaN (except for `!=`)
+    #define TENSOR_CMP_PREDICATE(CALL, a, b, cmp)                                       \
+        switch(cmp) {                                                                   \
+            case TensorCmpEq: return CALL(a, b, _CMP_EQ_OQ);                            \
+            case TensorCmpNe: return CALL(a, b, _CMP_NEQ_UQ);                           \
+            case TensorCmpLt: return CALL(a, b, _CMP_LT_OQ);                            \
+            case TensorCmpLe: return CALL(a, b, _CMP_LE_OQ);                            \
+            case TensorCmpGt: return CALL(a, b, _CMP_GT_OQ);                            \
+            default: return CALL(a, b, _CMP_GE_OQ);                                     \
+        }
+    #define TENSOR_AVX2_CMP_PS(a, b, p)     cast(UInt64)cast(UInt32)_mm256_movemask_ps(_mm256_cmp_ps(a, b, p))
+    #define TENSOR_AVX2_CMP_PD(a, b, p)     cast(UInt64)cast(UInt32)_mm256_movemask_pd(_mm256_cmp_pd(a, b, p))
+
+    TENSOR_AVX2 static CORETEN_ALWAYS_INLINE UInt64 tensor_avx2_cmp_f32(__m256 a, __m256 b, TensorCmp cmp) {
+        TENSOR_CMP_PREDICATE(TENSOR_AVX2_CMP_PS, a, b, cmp)
+    }
+
+    TENSOR_AVX2 static CORETEN_ALWAYS_INLINE UInt64 tensor_avx2_cmp_f64(__m256d a, __m256d b, TensorCmp cmp) {
+        TENSOR_CMP_PREDICATE(TENSOR_AVX2_CMP_PD, a, b, cmp)
+    }
+
+    // AVX2 has no 64-bit min/max: select with a comparison instead
+    TENSOR_AVX2 static CORETEN_ALWAYS_INLINE __m256i tensor_avx2_min_i64(__m256i a, __m256i b) {
+        return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+    }
+
+    TENSOR_AVX2 static CORETEN_ALWAYS_INLINE __m256i tensor_avx2_max_i64(__m256i a, __m256i b) {
+        return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b));
+    }
+
+    #define TENSOR_AVX2_LOADI(p)            _mm256_loadu_si256(cast(const __m256i*)(p))
+    #define TENSOR_AVX2_STOREI(p, v)        _mm256_storeu_si256(cast(__m256i*)(p), v)
+
+    #define TENSOR_AVX2_I16_V               __m256i
+    #define TENSOR_AVX2_I16_W               16
+    #define TENSOR_AVX2_I16_LOAD            TENSOR_AVX2_LOADI
+    #define TENSOR_AVX2_I16_STORE           TENSOR_AVX2_STOREI
+    #define TENSOR_AVX2_I16_SET1            _mm256_set1_epi16
+    #define TENSOR_AVX2_I16_ADD             _mm256_add_epi16
+    #define TENSOR_AVX2_I16_SUB             _mm256_sub_epi16
+    #define TENSOR_AVX2_I16_MUL             _mm256_mullo_epi16
+    #define TENSOR_AVX2_I16_DIV             TENSOR_NONE_OP
+    #define TENSOR_AVX2_I16_MIN             _mm256_min_epi16
+    #define TENSOR_AVX2_I16_MAX             _mm256_max_epi16
+    #define TENSOR_AVX2_I16_CMP             tensor_avx2_cmp_i16
+    #define TENSOR_AVX2_I16_HAS_ARITH       1
+    #define TENSOR_AVX2_I16_HAS_MUL         1
+    #define TENSOR_AVX2_I16_HAS_DIV         0
+    #define TENSOR_AVX2_I16_HAS_MINMAX      1
+
+    #define TENSOR_AVX2_I32_V               __m256i
+    #define TENSOR_AVX2_I32_W               8
+    #define TENSOR_AVX2_I32_LOAD            TENSOR_AVX2_LOADI
+    #define TENSOR_AVX2_I32_STORE           TENSOR_AVX2_STOREI
+    #define TENSOR_AVX2_I32_SET1            _mm256_set1_epi32
+    #define TENSOR_AVX2_I32_ADD             _mm256_add_epi32
+    #define TENSOR_AVX2_I32_SUB             _mm256_sub_epi32
+    #define TENSOR_AVX2_I32_MUL             _mm256_mullo_epi32
+    #define TENSOR_AVX2_I32_DIV             TENSOR_NONE_OP
+    #define TENSOR_AVX2_I32_MIN             _mm256_min_epi32
+    #define TENSOR_AVX2_I32_MAX             _mm256_max_epi32
+    #define TENSOR_AVX2_I32_CMP             tensor_avx2_cmp_i32
+    #define TENSOR_AVX2_I32_HAS_ARITH       1
+    #define TENSOR_AVX2_I32_HAS_MUL         1
+    #define TENSOR_AVX2_I32_HAS_DIV         0
+    #define TENSOR_AVX2_I32_HAS_MINMAX      1
+
+    #define TENSOR_AVX2_I64_V               __m256i
+    #define TENSOR_AVX2_I64_W               4
+    #define TENSOR_AVX2_I64_LOAD            TENSOR_AVX2_LOADI
+    #define TENSOR_AVX2_I64_STORE           TENSOR_AVX2_STOREI
+    #define TENSOR_AVX2_I64_SET1            _mm256_set1_epi64x
+    #define TENSOR_AVX2_I64_ADD             _mm256_add_epi64
+    #define TENSOR_AVX2_I64_SUB             _mm256_sub_epi64
+    #define TENSOR_AVX2_I64_MUL             TENSOR_NONE_OP
+    #define TENSOR_AVX2_I64_DIV             TENSOR_NONE_OP
+    #define TENSOR_AVX2_I64_MIN             tensor_avx2_min_i64
+    #define TENSOR_AVX2_I64_MAX             tensor_avx2_max_i64
+    #define TENSOR_AVX2_I64_CMP             tensor_avx2_cmp_i64
+    #define TENSOR_AVX2_I64_HAS_ARITH       1
+    #define TENSOR_AVX2_I64_HAS_MUL         0
+    #define TENSOR_AVX2_I64_HAS_DIV         0
+    #define TENSOR_AVX2_I64_HAS_MINMAX      1
+
+    #define TENSOR_AVX2_F32_V               __m256
+    #define TENSOR_AVX2_F32_W               8
+    #define TENSOR_AVX2_F32_LOAD            _mm256_loadu_ps
+    #define TENSOR_AVX2_F32_STORE           _mm256_storeu_ps
+    #define TENSOR_AVX2_F32_SET1            _mm256_set1_ps
+    #define TENSOR_AVX2_F32_ADD             _mm256_add_ps
+    #define TENSOR_AVX2_F32_SUB             _mm256_sub_ps
+    #define TENSOR_AVX2_F32_MUL             _mm256_mul_ps
+    #define TENSOR_AVX2_F32_DIV             _mm256_div_ps
+    #define TENSOR_AVX2_F32_MIN             _mm256_min_ps
+    #define TENSOR_AVX2_F32_MAX             _mm256_max_ps
+    #define TENSOR_AVX2_F32_CMP             tensor_avx2_cmp_f32
+    #define TENSOR_AVX2_F32_HAS_ARITH       1
+    #define TENSOR_AVX2_F32_HAS_MUL         1
+    #define TENSOR_AVX2_F32_HAS_DIV         1
+    #define TENSOR_AVX2_F32_HAS_MINMAX      1
+
+    #define TENSOR_AVX2_F64_V               __m256d
+    #define TENSOR_AVX2_F64_W               4
+    #define TENSOR_AVX2_F64_LOAD            _mm256_loadu_pd
+    #define TENSOR_AVX2_F64_STORE           _mm256_storeu_pd
+    #define TENSOR_AVX2_F64_SET1            _mm256_set1_pd
+    #define TENSOR_AVX2_F64_ADD             _mm256_add_pd
+    #define TENSOR_AVX2_F64_SUB             _mm256_sub_pd
+    #define TENSOR_AVX2_F64_MUL             _mm256_mul_pd
+    #define TENSOR_AVX2_F64_DIV             _mm256_div_pd
+    #define TENSOR_AVX2_F64_MIN             _mm256_min_pd
+    #define TENSOR_AVX2_F64_MAX             _mm256_max_pd
+    #define TENSOR_AVX2_F64_CMP             tensor_avx2_cmp_f64
+    #define TENSOR_AVX2_F64_HAS_ARITH       1
+    #define TENSOR_AVX2_F64_HAS_MUL         1
+    #define TENSOR_AVX2_F64_HAS_DIV         1
+    #define TENSOR_AVX2_F64_HAS_MINMAX      1
+
+    // AVX-512 compares straight into a mask register
+    #define TENSOR_AVX512_CMP_INT(NAME, V, CALL)                                        \
+        TENSOR_AVX512 static CORETEN_ALWAYS_INLINE UInt64 NAME(V a, V b, TensorCmp cmp) {   \
+            switch(cmp) {                                                               \
+                case TensorCmpEq: return cast(UInt64)CALL(a, b, _MM_CMPINT_EQ);         \
+                case TensorCmpNe: return cast(UInt64)CALL(a, b, _MM_CMPINT_NE);         \
+                case TensorCmpLt: return cast(UInt64)CALL(a, b, _MM_CMPINT_LT);         \
+                case TensorCmpLe: return cast(UInt64)CALL(a, b, _MM_CMPINT_LE);         \
+                case TensorCmpGt: return cast(UInt64)CALL(a, b, _MM_CMPINT_NLE);        \
+                default: return cast(UInt64)CALL(a, b, _MM_CMPINT_NLT);                 \
+            }                                                                           \
+        }
+    TENSOR_AVX512_CMP_INT(tensor_avx512_cmp_i16, __m512i, _mm512_cmp_epi16_mask)
+    TENSOR_AVX512_CMP_INT(tensor_avx512_cmp_i32, __m512i, _mm512_cmp_epi32_mask)
+    TENSOR_AVX512_CMP_INT(tensor_avx512_cmp_i64, __m512i, _mm512_cmp_epi64_mask)
+    #define TENSOR_AVX512_CMP_PS(a, b, p)   cast(UInt64)_mm512_cmp_ps_mask(a, b, p)
+    #define TENSOR_AVX512_CMP_PD(a, b, p)   cast(UInt64)_mm512_cmp_pd_mask(a, b, p)
+
+    TENSOR_AVX512 static CORETEN_ALWAYS_INLINE UInt64 tensor_avx512_cmp_f32(__m512 a, __m512 b, TensorCmp cmp) {
+        TENSOR_CMP_PREDICATE(TENSOR_AVX512_CMP_PS, a, b, cmp)
+    }
+
+    TENSOR_AVX512 static CORETEN_ALWAYS_INLINE UInt64 tensor_avx512_cmp_f64(__m512d a, __m512d b, TensorCmp cmp) {
+        TENSOR_CMP_PREDICATE(TENSOR_AVX512_CMP_PD, a, b, cmp)
+    }
+
+    #define TENSOR_AVX512_LOADI(p)          _mm512_loadu_si512(cast(const void*)(p))
+    #define TENSOR_AVX512_STOREI(p, v)      _mm512_storeu_si512(cast(void*)(p), v)
+
+    #define TENSOR_AVX512_I16_V             __m512i
+    #define TENSOR_AVX512_I16_W             32
+    #define TENSOR_AVX512_I16_LOAD          TENSOR_AVX512_LOADI
+    #define TENSOR_AVX512_I16_STORE         TENSOR_AVX512_STOREI
+    #define TENSOR_AVX512_I16_SET1          _mm512_set1_epi16
+    #define TENSOR_AVX512_I16_ADD           _mm512_add_epi16
+    #define TENSOR_AVX512_I16_SUB           _mm512_sub_epi16
+    #define TENSOR_AVX512_I16_MUL           _mm512_mullo_epi16
+    #define TENSOR_AVX512_I16_DIV           TENSOR_NONE_OP
+    #define TENSOR_AVX512_I16_MIN           _mm512_min_epi16
+    #define TENSOR_AVX512_I16_MAX           _mm512_max_epi16
+    #define TENSOR_AVX512_I16_CMP           tensor_avx512_cmp_i16
+    #define TENSOR_AVX512_I16_HAS_ARITH     1
+    #define TENSOR_AVX512_I16_HAS_MUL       1
+    #define TENSOR_AVX512_I16_HAS_DIV       0
+    #define TENSOR_AVX512_I16_HAS_MINMAX    1
+
+    #define TENSOR_AVX512_I32_V             __m512i
+    #define TENSOR_AVX512_I32_W             16
+    #define TENSOR_AVX512_I32_LOAD          TENSOR_AVX512_LOADI
+    #define TENSOR_AVX512_I32_STORE         TENSOR_AVX512_STOREI
+    #define TENSOR_AVX512_I32_SET1          _mm512_set1_epi32
+    #define TENSOR_AVX512_I32_ADD           _mm512_add_epi32
+    #define TENSOR_AVX512_I32_SUB           _mm512_sub_epi32
+    #define TENSOR_AVX512_I32_MUL           _mm512_mullo_epi32
+    #define TENSOR_AVX512_I32_DIV           TENSOR_NONE_OP
+    #define TENSOR_AVX512_I32_MIN           _mm512_min_epi32
+    #define TENSOR_AVX512_I32_MAX           _mm512_max_epi32
+    #define TENSOR_AVX512_I32_CMP           tensor_avx512_cmp_i32
+    #define TENSOR_AVX512_I32_HAS_ARITH     1
+    #define TENSOR_AVX512_I32_HAS_MUL       1
+    #define TENSOR_AVX512_I32_HAS_DIV       0
+    #define TENSOR_AVX512_I32_HAS_MINMAX    1
+
+    #define TENSOR_AVX512_I64_V             __m512i
+    #define TENSOR_AVX512_I64_W             8
+    #define TENSOR_AVX512_I64_LOAD          TENSOR_AVX512_LOADI
+    #define TENSOR_AVX512_I64_STORE         TENSOR_AVX512_STOREI
+    #define TENSOR_AVX512_I64_SET1          _mm512_set1_epi64
+    #define TENSOR_AVX512_I64_ADD           _mm512_add_epi64
+    #define TENSOR_AVX512_I64_SUB           _mm512_sub_epi64
+    #define TENSOR_AVX512_I64_MUL           TENSOR_NONE_OP      // `vpmullq` is AVX-512DQ
+    #define TENSOR_AVX512_I64_DIV           TENSOR_NONE_OP
+    #define TENSOR_AVX512_I64_MIN           _mm512_min_epi64
+    #define TENSOR_AVX512_I64_MAX           _mm512_max_epi64
+    #define TENSOR_AVX512_I64_CMP           tensor_avx512_cmp_i64
+    #define TENSOR_AVX512_I64_HAS_ARITH     1
+    #define TENSOR_AVX512_I64_HAS_MUL       0
+    #define TENSOR_AVX512_I64_HAS_DIV       0
+    #define TENSOR_AVX512_I64_HAS_MINMAX    1
+
+    #define TENSOR_AVX512_F32_V             __m512
+    #define TENSOR_AVX512_F32_W             16
+    #define TENSOR_AVX512_F32_LOAD          _mm512_loadu_ps
+    #define TENSOR_AVX512_F32_STORE         _mm512_storeu_ps
+    #define TENSOR_AVX512_F32_SET1          _mm512_set1_ps
+    #define TENSOR_AVX512_F32_ADD           _mm512_add_ps
+    #define TENSOR_AVX512_F32_SUB           _mm512_sub_ps
+    #define TENSOR_AVX512_F32_MUL           _mm512_mul_ps
+    #define TENSOR_AVX512_F32_DIV           _mm512_div_ps
+    #define TENSOR_AVX512_F32_MIN           _mm512_min_ps
+    #define TENSOR_AVX512_F32_MAX           _mm512_max_ps
+    #define TENSOR_AVX512_F32_CMP           tensor_avx512_cmp_f32
+    #define TENSOR_AVX512_F32_HAS_ARITH     1
+    #define TENSOR_AVX512_F32_HAS_MUL       1
+    #define TENSOR_AVX512_F32_HAS_DIV       1
+    #define TENSOR_AVX512_F32_HAS_MINMAX    1
+
+    #define TENSOR_AVX512_F64_V             __m512d
+    #define TENSOR_AVX512_F64_W             8
+    #define TENSOR_AVX512_F64_LOAD          _mm512_loadu_pd
+    #define TENSOR_AVX512_F64_STORE         _mm512_storeu_pd
+    #define TENSOR_AVX512_F64_SET1          _mm512_set1_pd
+    #define TENSOR_AVX512_F64_ADD           _mm512_add_pd
+    #define TENSOR_AVX512_F64_SUB           _mm512_sub_pd
+    #define TENSOR_AVX512_F64_MUL           _mm512_mul_pd
+    #define TENSOR_AVX512_F64_DIV           _mm512_div_pd
+    #define TENSOR_AVX512_F64_MIN           _mm512_min_pd
+    #define TENSOR_AVX512_F64_MAX           _mm512_max_pd
+    #define TENSOR_AVX512_F64_CMP           tensor_avx512_cmp_f64
+    #define TENSOR_AVX512_F64_HAS_ARITH     1
+    #define TENSOR_AVX512_F64_HAS_MUL       1
+    #define TENSOR_AVX512_F64_HAS_DIV       1
+    #define TENSOR_AVX512_F64_HAS_MINMAX    1
+#endif // TENSOR_HAVE_X86
+
+/*
+    The kernels, for every instruction set `P` and element type `T`. They run over `n` contiguous elements, and `b`
+    is a single element if `scalar` is true.
+*/
+
+// `dst[i] = a[i] <op> b[i]`, `W` elements at a time, then one at a time
+#define TENSOR_ARITH_LOOP(P, T, VOP, SOP, HAS)                                              \
+    if((HAS) && scalar) {                                                                   \
+        P##_V vb = P##_SET1(*b);                                                            \
+        (void)vb;                                                                           \
+        for(; i + P##_W <= n; i += P##_W)                                                   \
+            P##_STORE(dst + i, VOP(P##_LOAD(a + i), vb));                                   \
+    } else if(HAS) {                                                                        \
+        for(; i + P##_W <= n; i += P##_W)                                                   \
+            P##_STORE(dst + i, VOP(P##_LOAD(a + i), P##_LOAD(b + i)));                      \
+    }                                                                                       \
+    for(; i < n; i++)                                                                       \
+        dst[i] = SOP(T, a[i], scalar ? *b : b[i]);
+
+// `mask[i]` = `a[i] <cmp> b[i]` (`mask` starts out zeroed, and `W` divides 64)
+#define TENSOR_COMPARE_LOOP(P, CMP)                                                         \
+    if(P##_W > 1 && scalar) {                                                               \
+        P##_V vb = P##_SET1(*b);                                                            \
+        (void)vb;                                                                           \
+        for(; i + P##_W <= n; i += P##_W)                                                   \
+            mask[i >> 6] |= P##_CMP(P##_LOAD(a + i), vb, CMP) << (i & 63);                  \
+    } else if(P##_W > 1) {                                                                  \
+        for(; i + P##_W <= n; i += P##_W)                                                   \
+            mask[i >> 6] |= P##_CMP(P##_LOAD(a + i), P##_LOAD(b + i), CMP) << (i & 63);     \
+    }                                                                                       \
+    for(; i < n; i++)                                                                       \
+        mask[i >> 6] |= cast(UInt64)TENSOR_CMP(a[i], scalar ? *b : b[i], CMP) << (i & 63);
+
+// `*result = a[0] <op> a[1] <op> ...`, in 4 vectors of lanes at once (for throughput), then across the lanes
+#define TENSOR_REDUCE_LOOP(P, T, VOP, SOP, HAS)                                             \
+    if((HAS) && n >= 4 * P##_W) {                                                           \
+        P##_V acc0 = P##_LOAD(a);                                                           \
+        P##_V acc1 = P##_LOAD(a + P##_W);                                                   \
+        P##_V acc2 = P##_LOAD(a + 2 * P##_W);                                               \
+        P##_V acc3 = P##_LOAD(a + 3 * P##_W);                                               \
+        for(i = 4 * P##_W; i + 4 * P##_W <= n; i += 4 * P##_W) {                            \
+            acc0 = VOP(acc0, P##_LOAD(a + i));                                              \
+            acc1 = VOP(acc1, P##_LOAD(a + i + P##_W));                                      \
+            acc2 = VOP(acc2, P##_LOAD(a + i + 2 * P##_W));                                  \
+            acc3 = VOP(acc3, P##_LOAD(a + i + 3 * P##_W));                                  \
+        }                                                                                   \
+        acc0 = VOP(VOP(acc0, acc1), VOP(acc2, acc3));                                       \
+        for(; i + P##_W <= n; i += P##_W)                                                   \
+            acc0 = VOP(acc0, P##_LOAD(a + i));                                              \
+        T lanes[P##_W];                                                                     \
+        P##_STORE(lanes, acc0);                                                             \
+        acc = lanes[0];                                                                     \
+        for(UInt64 k = 1; k < P##_W; k++)                                                   \
+            acc = SOP(T, acc, lanes[k]);                                                    \
+    } else {                                                                                \
+        acc = a[0];                                                                         \
+        i = 1;                                                                              \
+    }                                                                                       \
+    for(; i < n; i++)                                                                       \
+        acc = SOP(T, acc, a[i]);
+
+#define TENSOR_KERNELS(ISA, TARGET, SFX, T, S, P)                                                               \
+    TARGET static void tensor_arith_##SFX##_##ISA(void* dst_, const void* a_, const void* b_, UInt64 n,         \
+                                                   bool scalar, TensorOp op) {                                  \
+        T* dst = cast(T*)dst_;                                                                                  \
+        const T* a = cast(const T*)a_;                                                                          \
+        const T* b = cast(const T*)b_;                                                                          \
+        UInt64 i = 0;                                                                                           \
+        switch(op) {                                                                                            \
+            case TensorOpAdd: TENSOR_ARITH_LOOP(P, T, P##_ADD, S##_ADD, P##_HAS_ARITH) break;                   \
+            case TensorOpSub: TENSOR_ARITH_LOOP(P, T, P##_SUB, S##_SUB, P##_HAS_ARITH) break;                   \
+            case TensorOpMul: TENSOR_ARITH_LOOP(P, T, P##_MUL, S##_MUL, P##_HAS_MUL) break;                     \
+            case TensorOpDiv: TENSOR_ARITH_LOOP(P, T, P##_DIV, S##_DIV, P##_HAS_DIV) break;                     \
+            case TensorOpMin: TENSOR_ARITH_LOOP(P, T, P##_MIN, TENSOR_MIN, P##_HAS_MINMAX) break;               \
+            default: TENSOR_ARITH_LOOP(P, T, P##_MAX, TENSOR_MAX, P##_HAS_MINMAX) break;                        \
+        }                                                                                                       \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static void tensor_compare_##SFX##_##ISA(UInt64* mask, const void* a_, const void* b_, UInt64 n,     \
+                                                     bool scalar, TensorCmp cmp) {                              \
+        const T* a = cast(const T*)a_;                                                                          \
+        const T* b = cast(const T*)b_;                                                                          \
+        UInt64 i = 0;                                                                                           \
+        switch(cmp) {                                                                                           \
+            case TensorCmpEq: TENSOR_COMPARE_LOOP(P, TensorCmpEq) break;                                        \
+            case TensorCmpNe: TENSOR_COMPARE_LOOP(P, TensorCmpNe) break;                                        \
+            case TensorCmpLt: TENSOR_COMPARE_LOOP(P, TensorCmpLt) break;                                        \
+            case TensorCmpLe: TENSOR_COMPARE_LOOP(P, TensorCmpLe) break;                                        \
+            case TensorCmpGt: TENSOR_COMPARE_LOOP(P, TensorCmpGt) break;                                        \
+            default: TENSOR_COMPARE_LOOP(P, TensorCmpGe) break;                                                 \
+        }                                                                                                       \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static void tensor_reduce_##SFX##_##ISA(void* result, const void* a_, UInt64 n, TensorReduce op) {   \
+        const T* a = cast(const T*)a_;                                                                          \
+        UInt64 i = 0;                                                                                           \
+        T acc;                                                                                                  \
+        switch(op) {                                                                                            \
+            case TensorReduceSum: TENSOR_REDUCE_LOOP(P, T, P##_ADD, S##_ADD, P##_HAS_ARITH) break;              \
+            case TensorReduceMin: TENSOR_REDUCE_LOOP(P, T, P##_MIN, TENSOR_MIN, P##_HAS_MINMAX) break;          \
+            default: TENSOR_REDUCE_LOOP(P, T, P##_MAX, TENSOR_MAX, P##_HAS_MINMAX) break;                       \
+        }                                                                                                       \
+        memcpy(result, &acc, sizeof(T));                                                                        \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static Int64 tensor_find_##SFX##_##ISA(const void* a_, const void* value, UInt64 n) {                \
+        const T* a = cast(const T*)a_;                                                                          \
+        T v = *cast(const T*)value;                                                                             \
+        UInt64 i = 0;                                                                                           \
+        P##_V vv = P##_SET1(v);                                                                                 \
+        (void)vv;                                                                                               \
+        for(; P##_W > 1 && i + P##_W <= n; i += P##_W) {                                                        \
+            UInt64 bits = P##_CMP(P##_LOAD(a + i), vv, TensorCmpEq);                                            \
+            if(bits)                                                                                            \
+                return cast(Int64)(i + tensor_lowest_bit(bits));                                                \
+        }                                                                                                       \
+        for(; i < n; i++)                                                                                       \
+            if(a[i] == v)                                                                                       \
+                return cast(Int64)i;                                                                            \
+        return -1;                                                                                              \
+    }
+
+typedef struct TensorKernels {
+    void (*arith)(void* dst, const void* a, const void* b, UInt64 n, bool scalar, TensorOp op);
+    void (*compare)(UInt64* mask, const void* a, const void* b, UInt64 n, bool scalar, TensorCmp cmp);
+    void (*reduce)(void* result, const void* a, UInt64 n, TensorReduce op);
+    Int64 (*find)(const void* a, const void* value, UInt64 n);
+} TensorKernels;
+
+#define TENSOR_ENTRY(SFX, ISA)  \
+    { tensor_arith_##SFX##_##ISA, tensor_compare_##SFX##_##ISA, tensor_reduce_##SFX##_##ISA, tensor_find_##SFX##_##ISA }
+#define TENSOR_TABLE(ISA)       \
+    { TENSOR_ENTRY(i16, ISA), TENSOR_ENTRY(i32, ISA), TENSOR_ENTRY(i64, ISA), TENSOR_ENTRY(f32, ISA), TENSOR_ENTRY(f64, ISA) }
+
+TENSOR_KERNELS(scalar, , i16, Int16, TENSOR_INT, TENSOR_NONE)
+TENSOR_KERNELS(scalar, , i32, Int32, TENSOR_INT, TENSOR_NONE)
+TENSOR_KERNELS(scalar, , i64, Int64, TENSOR_INT, TENSOR_NONE)
+TENSOR_KERNELS(scalar, , f32, Float32, TENSOR_FLOAT, TENSOR_NONE)
+TENSOR_KERNELS(scalar, , f64, Float64, TENSOR_FLOAT, TENSOR_NONE)
+static const TensorKernels tensor_kernels_scalar[TensorNumDTypes] = TENSOR_TABLE(scalar);
+
+#if defined(TENSOR_HAVE_X86)
+    TENSOR_KERNELS(avx2, TENSOR_AVX2, i16, Int16, TENSOR_INT, TENSOR_AVX2_I16)
+    TENSOR_KERNELS(avx2, TENSOR_AVX2, i32, Int32, TENSOR_INT, TENSOR_AVX2_I32)
+    TENSOR_KERNELS(avx2, TENSOR_AVX2, i64, Int64, TENSOR_INT, TENSOR_AVX2_I64)
+    TENSOR_KERNELS(avx2, TENSOR_AVX2, f32, Float32, TENSOR_FLOAT, TENSOR_AVX2_F32)
+    TENSOR_KERNELS(avx2, TENSOR_AVX2, f64, Float64, TENSOR_FLOAT, TENSOR_AVX2_F64)
+    static const TensorKernels tensor_kernels_avx2[TensorNumDTypes] = TENSOR_TABLE(avx2);
+
+    TENSOR_KERNELS(avx512, TENSOR_AVX512, i16, Int16, TENSOR_INT, TENSOR_AVX512_I16)
+    TENSOR_KERNELS(avx512, TENSOR_AVX512, i32, Int32, TENSOR_INT, TENSOR_AVX512_I32)
+    TENSOR_KERNELS(avx512, TENSOR_AVX512, i64, Int64, TENSOR_INT, TENSOR_AVX512_I64)
+    TENSOR_KERNELS(avx512, TENSOR_AVX512, f32, Float32, TENSOR_FLOAT, TENSOR_AVX512_F32)
+    TENSOR_KERNELS(avx512, TENSOR_AVX512, f64, Float64, TENSOR_FLOAT, TENSOR_AVX512_F64)
+    static const TensorKernels tensor_kernels_avx512[TensorNumDTypes] = TENSOR_TABLE(avx512);
+#endif // TENSOR_HAVE_X86
+
+// The kernels in use (null until they're first needed). Racing threads all pick the same ones, so no synchronization
+// is needed.
+static const TensorKernels* tensor_table = null;
+static TensorIsa tensor_table_isa = TensorIsaScalar;
+
+bool tensor_set_isa(TensorIsa isa) {
+    const TensorKernels* table = tensor_kernels_scalar;
+#if defined(TENSOR_HAVE_X86)
+    if(isa == TensorIsaAVX512) {
+        if(!cpu_has_feature(CpuFeatureAVX512F) || !cpu_has_feature(CpuFeatureAVX512BW))
+            return false;
+        table = tensor_kernels_avx512;
+    } else if(isa == TensorIsaAVX2) {
+        if(!cpu_has_feature(CpuFeatureAVX2))
+            return false;
+        table = tensor_kernels_avx2;
+    }
+#else
+    if(isa != TensorIsaScalar)
+        return false;
+#endif // TENSOR_HAVE_X86
+    tensor_table_isa = isa;
+    tensor_table = table;
+    return true;
+}
+
+TensorIsa tensor_isa() {
+    if(NONE(tensor_table) && !tensor_set_isa(TensorIsaAVX512) && !tensor_set_isa(TensorIsaAVX2))
+        tensor_set_isa(TensorIsaScalar);
+    return tensor_table_isa;
+}
+
+static inline const TensorKernels* tensor_kernels(TensorDType dtype) {
+    tensor_isa();
+    return &tensor_table[dtype];
+}
+
+// Storage ------------------------------------------------------------------------------------------------------------
+
+UInt64 tensor_dtype_size(TensorDType dtype) {
+    switch(dtype) {
+        case TensorDTypeInt16: return 2;
+        case TensorDTypeInt32: case TensorDTypeFloat32: return 4;
+        default: return 8;
+    }
+}
+
+bool tensor_dtype_is_float(TensorDType dtype) {
+    return dtype == TensorDTypeFloat32 || dtype == TensorDTypeFloat64;
+}
+
+// Storage for `count` elements of `size` bytes, aligned for the widest vectors (64 bytes)
+static Byte* tensor_alloc(UInt64 count, UInt64 size) {
+    UInt64 bytes = (count * size + 63) & ~cast(UInt64)63;
+#if defined(CORETEN_OS_WINDOWS)
+    Byte* data = cast(Byte*)_aligned_malloc(bytes, 64);
+#else
+    Byte* data = cast(Byte*)aligned_alloc(64, bytes);
+#endif // CORETEN_OS_WINDOWS
+    CORETEN_ENFORCE_NN(data, "Could not allocate memory. Memory full.");
+    return data;
+}
+
+static void tensor_dealloc(Byte* data) {
+#if defined(CORETEN_OS_WINDOWS)
+    _aligned_free(data);
+#else
+    free(data);
+#endif // CORETEN_OS_WINDOWS
+}
+
+// A buffer a tensor has grown out of, which its slices may still see
+typedef struct TensorRetired {
+    Byte* data;
+    struct TensorRetired* next;
+} TensorRetired;
+
+static inline bool tensor_is_contiguous(Tensor* tensor) {
+    return tensor->stride == 1;
+}
+
+static inline Byte* tensor_ptr(Tensor* tensor, UInt64 index) {
+    return tensor->data + cast(Int64)index * tensor->stride * cast(Int64)tensor_dtype_size(tensor->dtype);
+}
+
+static TensorScalar tensor_load(TensorDType dtype, const Byte* ptr) {
+    TensorScalar value;
+    switch(dtype) {
+        case TensorDTypeInt16: { Int16 x; memcpy(&x, ptr, sizeof(x)); value.i = x; break; }
+        case TensorDTypeInt32: { Int32 x; memcpy(&x, ptr, sizeof(x)); value.i = x; break; }
+        case TensorDTypeInt64: { Int64 x; memcpy(&x, ptr, sizeof(x)); value.i = x; break; }
+        case TensorDTypeFloat32: { Float32 x; memcpy(&x, ptr, sizeof(x)); value.f = x; break; }
+        default: { Float64 x; memcpy(&x, ptr, sizeof(x)); value.f = x; break; }
+    }
+    return value;
+}
+
+// Integers are truncated (they wrap around) to the width of `dtype`
+static void tensor_store(TensorDType dtype, Byte* ptr, TensorScalar value) {
+    switch(dtype) {
+        case TensorDTypeInt16: { Int16 x = cast(Int16)value.i; memcpy(ptr, &x, sizeof(x)); break; }
+        case TensorDTypeInt32: { Int32 x = cast(Int32)value.i; memcpy(ptr, &x, sizeof(x)); break; }
+        case TensorDTypeInt64: { memcpy(ptr, &value.i, sizeof(value.i)); break; }
+        case TensorDTypeFloat32: { Float32 x = cast(Float32)value.f; memcpy(ptr, &x, sizeof(x)); break; }
+        default: { memcpy(ptr, &value.f, sizeof(value.f)); break; }
+    }
+}
+
+Tensor* tensor_new(TensorDType dtype, UInt64 len, UInt64 cap) {
+    Tensor* tensor = cast(Tensor*)calloc(1, sizeof(Tensor));
+    CORETEN_ENFORCE_NN(tensor, "Could not allocate memory. Memory full.");
+    tensor->dtype = dtype;
+    tensor->stride = 1;
+    tensor->rank = 1;
+    tensor->len = len;
+    tensor->cap = cap > len ? cap : len;
+    if(tensor->cap > 0) {
+        tensor->data = tensor_alloc(tensor->cap, tensor_dtype_size(dtype));
+        memset(tensor->data, 0, len * tensor_dtype_size(dtype));
+    }
+    return tensor;
+}
+
+// The number of elements of `shape` (`rank` dimensions). Returns false if it doesn't fit.
+static bool tensor_shape_len(UInt32 rank, const UInt64* shape, UInt64* len) {
+    UInt64 product = 1;
+    for(UInt32 d = 0; d < rank; d++) {
+        if(shape[d] != 0 && product > UINT64_MAX / shape[d])
+            return false;
+        product *= shape[d];
+    }
+    *len = product;
+    return true;
+}
+
+Tensor* tensor_new_shape(TensorDType dtype, UInt32 rank, const UInt64* shape) {
+    UInt64 len = 0;
+    CORETEN_ENFORCE(rank >= 1 && rank <= TENSOR_MAX_RANK && tensor_shape_len(rank, shape, &len),
+                    "Invalid tensor shape");
+    Tensor* tensor = tensor_new(dtype, len, 0);
+    tensor_reshape(tensor, rank, shape);
+    return tensor;
+}
+
+bool tensor_reshape(Tensor* tensor, UInt32 rank, const UInt64* shape) {
+    UInt64 len = 0;
+    if(rank < 1 || rank > TENSOR_MAX_RANK || !tensor_shape_len(rank, shape, &len) || len != tensor->len)
+        return false;
+    tensor->rank = rank;
+    for(UInt32 d = 0; d < rank; d++)
+        tensor->shape[d] = shape[d];
+    return true;
+}
+
+UInt64 tensor_dim(Tensor* tensor, UInt32 dim) {
+    if(tensor->rank <= 1)
+        return tensor->len;
+    CORETEN_ENFORCE(dim < tensor->rank, "Tensor dimension out of range");
+    return tensor->shape[dim];
+}
+
+bool tensor_slice(Tensor* view, Tensor* tensor, UInt64 lower, UInt64 upper, UInt64 step) {
+    if(tensor->rank > 1 || lower > upper || upper > tensor->len || step == 0)
+        return false;
+    view->dtype = tensor->dtype;
+    view->data = lower < tensor->len ? tensor_ptr(tensor, lower) : tensor->data;
+    view->len = (upper - lower + step - 1) / step;
+    view->cap = 0;
+    view->stride = view->len > 1 ? tensor->stride * cast(Int64)step : 1;
+    view->rank = 1;
+    view->has_slices = false;
+    view->retired = null;
+    tensor->has_slices = true;
+    return true;
+}
+
+Tensor* tensor_clone(Tensor* tensor) {
+    Tensor* clone = tensor_new(tensor->dtype, 0, tensor->len);
+    tensor_append(clone, tensor);
+    clone->rank = tensor->rank;
+    memcpy(clone->shape, tensor->shape, sizeof(clone->shape));
+    return clone;
+}
+
+void tensor_free(Tensor* tensor) {
+    if(NONE(tensor))
+        return;
+    if(tensor->cap > 0)
+        tensor_dealloc(tensor->data);
+    while(SOME(tensor->retired)) {
+        TensorRetired* next = tensor->retired->next;
+        tensor_dealloc(tensor->retired->data);
+        free(tensor->retired);
+        tensor->retired = next;
+    }
+    free(tensor);
+}
+
+void tensor_fill(Tensor* tensor, TensorScalar value) {
+    UInt64 size = tensor_dtype_size(tensor->dtype);
+    if(tensor->len == 0)
+        return;
+    // Store the first element, then double the filled part
+    tensor_store(tensor->dtype, tensor_ptr(tensor, 0), value);
+    if(!tensor_is_contiguous(tensor)) {
+        for(UInt64 i = 1; i < tensor->len; i++)
+            memcpy(tensor_ptr(tensor, i), tensor->data, size);
+        return;
+    }
+    for(UInt64 filled = 1; filled < tensor->len; filled *= 2) {
+        UInt64 count = filled * 2 <= tensor->len ? filled : tensor->len - filled;
+        memcpy(tensor->data + filled * size, tensor->data, count * size);
+    }
+}
+
+void tensor_reserve(Tensor* tensor, UInt64 cap) {
+    if(cap <= tensor->cap)
+        return;
+    if(cap < tensor->len)
+        cap = tensor->len;
+    UInt64 size = tensor_dtype_size(tensor->dtype);
+    Byte* data = tensor_alloc(cap, size);
+    if(tensor_is_contiguous(tensor)) {
+        if(tensor->len > 0)
+            memcpy(data, tensor->data, tensor->len * size);
+    } else {
+        for(UInt64 i = 0; i < tensor->len; i++)
+            memcpy(data + i * size, tensor_ptr(tensor, i), size);
+    }
+    if(tensor->cap > 0 && tensor->has_slices) {
+        // Its slices still see the old buffer (geometric growth keeps all of them smaller than the new one)
+        TensorRetired* retired = cast(TensorRetired*)malloc(sizeof(TensorRetired));
+        CORETEN_ENFORCE_NN(retired, "Could not allocate memory. Memory full.");
+        retired->data = tensor->data;
+        retired->next = tensor->retired;
+        tensor->retired = retired;
+    } else if(tensor->cap > 0) {
+        tensor_dealloc(tensor->data);
+    }
+    tensor->data = data;
+    tensor->cap = cap;
+    tensor->stride = 1;
+}
+
+// Make room for `extra` more elements, doubling the capacity (at least)
+static void tensor_grow(Tensor* tensor, UInt64 extra) {
+    CORETEN_ENFORCE(tensor->rank <= 1, "Tensors of fixed shape can't grow");
+    UInt64 needed = tensor->len + extra;
+    if(needed <= tensor->cap)
+        return;
+    UInt64 cap = tensor->cap < 8 ? 8 : tensor->cap * 2;
+    tensor_reserve(tensor, cap > needed ? cap : needed);
+}
+
+TensorScalar tensor_get(Tensor* tensor, UInt64 index) {
+    CORETEN_ENFORCE(index < tensor->len, "Tensor index out of bounds");
+    return tensor_load(tensor->dtype, tensor_ptr(tensor, index));
+}
+
+void tensor_set(Tensor* tensor, UInt64 index, TensorScalar value) {
+    CORETEN_ENFORCE(index < tensor->len, "Tensor index out of bounds");
+    tensor_store(tensor->dtype, tensor_ptr(tensor, index), value);
+}
+
+void tensor_push(Tensor* tensor, TensorScalar value) {
+    tensor_grow(tensor, 1);
+    tensor_store(tensor->dtype, tensor_ptr(tensor, tensor->len), value);
+    tensor->len++;
+}
+
+void tensor_append(Tensor* tensor, Tensor* other) {
+    CORETEN_ENFORCE(tensor->dtype == other->dtype, "Appending a tensor of a different type");
+    UInt64 len = other->len;
+    if(len == 0)
+        return;
+    UInt64 size = tensor_dtype_size(tensor->dtype);
+    tensor_grow(tensor, len);
+    if(tensor_is_contiguous(other)) {
+        // (`other` may be `tensor`, which may have just moved)
+        memcpy(tensor->data + tensor->len * size, other->data, len * size);
+    } else {
+        for(UInt64 i = 0; i < len; i++)
+            memcpy(tensor->data + (tensor->len + i) * size, tensor_ptr(other, i), size);
+    }
+    tensor->len += len;
+}
+
+// Operations ---------------------------------------------------------------------------------------------------------
+
+// `a <op> b` on single elements (for tensors that aren't contiguous). Integers wrap around once they're stored.
+static TensorScalar tensor_apply(TensorDType dtype, TensorOp op, TensorScalar a, TensorScalar b) {
+    TensorScalar r;
+    if(tensor_dtype_is_float(dtype)) {
+        switch(op) {
+            case TensorOpAdd: r.f = a.f + b.f; break;
+            case TensorOpSub: r.f = a.f - b.f; break;
+            case TensorOpMul: r.f = a.f * b.f; break;
+            case TensorOpDiv: r.f = a.f / b.f; break;
+            case TensorOpMin: r.f = TENSOR_MIN(double, a.f, b.f); break;
+            default: r.f = TENSOR_MAX(double, a.f, b.f); break;
+        }
+    } else {
+        switch(op) {
+            case TensorOpAdd: r.i = TENSOR_INT_ADD(Int64, a.i, b.i); break;
+            case TensorOpSub: r.i = TENSOR_INT_SUB(Int64, a.i, b.i); break;
+            case TensorOpMul: r.i = TENSOR_INT_MUL(Int64, a.i, b.i); break;
+            case TensorOpDiv: r.i = tensor_div_int(a.i, b.i); break;
+            case TensorOpMin: r.i = TENSOR_MIN(Int64, a.i, b.i); break;
+            default: r.i = TENSOR_MAX(Int64, a.i, b.i); break;
+        }
+    }
+    return r;
+}
+
+static bool tensor_compare_elems(TensorDType dtype, TensorCmp cmp, TensorScalar a, TensorScalar b) {
+    if(tensor_dtype_is_float(dtype))
+        return TENSOR_CMP(a.f, b.f, cmp);
+    return TENSOR_CMP(a.i, b.i, cmp);
+}
+
+// `value`, converted to an element of `dtype` (in `out`). Returns false if it isn't one (an integer out of range).
+static bool tensor_to_elem(TensorDType dtype, TensorScalar value, Byte* out) {
+    tensor_store(dtype, out, value);
+    return tensor_dtype_is_float(dtype) || tensor_load(dtype, out).i == value.i;
+}
+
+static bool tensor_arith_generic(Tensor* dst, Tensor* a, Tensor* b, TensorScalar* scalar, TensorOp op) {
+    UInt64 n = a->len;
+    bool is_int_div = op == TensorOpDiv && !tensor_dtype_is_float(a->dtype);
+    if(is_int_div) {
+        for(UInt64 i = 0; i < (NONE(scalar) ? n : 1); i++)
+            if((NONE(scalar) ? tensor_get(b, i) : *scalar).i == 0)
+                return false;
+    }
+    if(tensor_is_contiguous(dst) && tensor_is_contiguous(a) && (SOME(scalar) || tensor_is_contiguous(b))) {
+        Byte value[8];
+        if(SOME(scalar))
+            tensor_store(a->dtype, value, *scalar);
+        tensor_kernels(a->dtype)->arith(dst->data, a->data, SOME(scalar) ? value : b->data, n, SOME(scalar), op);
+        return true;
+    }
+    for(UInt64 i = 0; i < n; i++)
+        tensor_set(dst, i, tensor_apply(a->dtype, op, tensor_get(a, i), SOME(scalar) ? *scalar : tensor_get(b, i)));
+    return true;
+}
+
+bool tensor_arith(Tensor* dst, Tensor* a, Tensor* b, TensorOp op) {
+    CORETEN_ENFORCE(dst->dtype == a->dtype && a->dtype == b->dtype, "Tensor types don't match");
+    CORETEN_ENFORCE(dst->len == a->len && a->len == b->len, "Tensor lengths don't match");
+    return tensor_arith_generic(dst, a, b, null, op);
+}
+
+bool tensor_arith_scalar(Tensor* dst, Tensor* a, TensorScalar b, TensorOp op) {
+    CORETEN_ENFORCE(dst->dtype == a->dtype, "Tensor types don't match");
+    CORETEN_ENFORCE(dst->len == a->len, "Tensor lengths don't match");
+    // Wrap `b` around to the element type first, like the kernels do
+    Byte elem[8];
+    tensor_store(a->dtype, elem, b);
+    b = tensor_load(a->dtype, elem);
+    return tensor_arith_generic(dst, a, a, &b, op);
+}
+
+static UInt64 tensor_compare_generic(Tensor* a, Tensor* b, TensorScalar* scalar, TensorCmp cmp, UInt64* mask) {
+    UInt64 n = a->len;
+    UInt64 words = (n + 63) / 64;
+    memset(mask, 0, words * sizeof(UInt64));
+    if(tensor_is_contiguous(a) && (SOME(scalar) || tensor_is_contiguous(b))) {
+        Byte value[8];
+        if(SOME(scalar)) {
+            if(!tensor_to_elem(a->dtype, *scalar, value)) {
+                // No element can be equal to an integer out of range, and it's either above or below all of them
+                bool above = scalar->i > 0;
+                bool all = cmp == TensorCmpNe || ((cmp == TensorCmpLt || cmp == TensorCmpLe) == above);
+                if(cmp == TensorCmpEq || !all)
+                    return 0;
+                for(UInt64 i = 0; i < n; i++)
+                    mask[i >> 6] |= cast(UInt64)1 << (i & 63);
+                return n;
+            }
+        }
+        tensor_kernels(a->dtype)->compare(mask, a->data, SOME(scalar) ? value : b->data, n, SOME(scalar), cmp);
+    } else {
+        for(UInt64 i = 0; i < n; i++) {
+            TensorScalar rhs = SOME(scalar) ? *scalar : tensor_get(b, i);
+            if(tensor_compare_elems(a->dtype, cmp, tensor_get(a, i), rhs))
+                mask[i >> 6] |= cast(UInt64)1 << (i & 63);
+        }
+    }
+    UInt64 count = 0;
+    for(UInt64 w = 0; w < words; w++)
+        count += tensor_popcount(mask[w]);
+    return count;
+}
+
+UInt64 tensor_compare(Tensor* a, Tensor* b, TensorCmp cmp, UInt64* mask) {
+    CORETEN_ENFORCE(a->dtype == b->dtype, "Tensor types don't match");
+    CORETEN_ENFORCE(a->len == b->len, "Tensor lengths don't match");
+    return tensor_compare_generic(a, b, null, cmp, mask);
+}
+
+UInt64 tensor_compare_scalar(Tensor* a, TensorScalar b, TensorCmp cmp, UInt64* mask) {
+    return tensor_compare_generic(a, a, &b, cmp, mask);
+}
+
+bool tensor_reduce(Tensor* a, TensorReduce op, TensorScalar* result) {
+    bool is_float = tensor_dtype_is_float(a->dtype);
+    if(a->len == 0) {
+        if(is_float)
+            result->f = 0.0;
+        else
+            result->i = 0;
+        return op == TensorReduceSum;
+    }
+    if(tensor_is_contiguous(a)) {
+        Byte value[8];
+        tensor_kernels(a->dtype)->reduce(value, a->data, a->len, op);
+        *result = tensor_load(a->dtype, value);
+        return true;
+    }
+    TensorOp elem_op = op == TensorReduceSum ? TensorOpAdd : op == TensorReduceMin ? TensorOpMin : TensorOpMax;
+    TensorScalar acc = tensor_get(a, 0);
+    for(UInt64 i = 1; i < a->len; i++) {
+        acc = tensor_apply(a->dtype, elem_op, acc, tensor_get(a, i));
+        // Wrap around (and round) like the element type does
+        Byte elem[8];
+        tensor_store(a->dtype, elem, acc);
+        acc = tensor_load(a->dtype, elem);
+    }
+    *result = acc;
+    return true;
+}
+
+Int64 tensor_index_of(Tensor* a, TensorScalar value) {
+    Byte elem[8];
+    if(!tensor_to_elem(a->dtype, value, elem))
+        return -1;
+    if(tensor_is_contiguous(a))
+        return tensor_kernels(a->dtype)->find(a->data, elem, a->len);
+    TensorScalar v = tensor_load(a->dtype, elem);
+    for(UInt64 i = 0; i < a->len; i++)
+        if(tensor_compare_elems(a->dtype, TensorCmpEq, tensor_get(a, i), v))
+            return cast(Int64)i;
+    return -1;
+}
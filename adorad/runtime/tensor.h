@@ -0,0 +1,167 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+#ifndef ADORAD_RUNTIME_TENSOR_H
+#define ADORAD_RUNTIME_TENSOR_H
+
+#include <adorad/core/types.h>
+
+/*
+    The Tensor Runtime.
+
+    Tensors (`TensorInt16` ... `TensorFloat64`, see `AdoradTypes`) are the language's arrays. A tensor is a length and
+    a stride over a buffer of elements: `data[i * stride]` is element `i`. Tensors made here are contiguous (their
+    stride is 1) and own their buffer, which is 64-byte aligned and grows geometrically (doubling, from 8 elements)
+    as elements are appended (`<<`), so appending is amortized O(1). `{cap: N}` preallocates room for N elements.
+
+    A tensor of more than one dimension (`Tensor<Float64, 2>`) has a fixed shape, and is laid out the same way, in
+    row-major order: element `[i][j]` of an `m x n` tensor is element `i * n + j`, so the whole tensor is one buffer
+    (not a tensor of rows), and `a[i][j]` is a single computed offset. Everything that works on the elements one after
+    the other (arithmetic, reductions, `filter()`...) sees them in that order. Tensors of fixed shape can't grow.
+
+    A slice (`xs[lower..upper:step]`, see `tensor_slice()`) is a view: a tensor that shares the elements of the one it
+    was sliced from, and owns none of them (its `cap` is 0), so slicing is O(1) no matter how long the tensor is, and
+    writing to an element of a slice writes to the tensor (and to every other slice of that element). A slice with a
+    step is strided. `.clone()` (`tensor_clone()`) makes a copy that owns its elements. Appending to a slice is
+    copy-on-write: the slice first becomes a contiguous copy of its elements (and stops sharing them). Appending to a
+    tensor can move its elements, so slices taken before that still see the old ones; they stay valid for as long as
+    the tensor is (a tensor that has been sliced keeps the buffers it grows out of until it's freed).
+
+    Element-wise arithmetic, comparisons, reductions and `in` (`tensor_index_of()`) run over contiguous tensors with
+    SIMD kernels:
+        1. AVX-512 (F + BW; x86 only, selected at runtime)
+        2. AVX2    (x86 only, selected at runtime)
+        3. Scalar  (everything else, and tensors that aren't contiguous)
+    The kernels are picked the first time they're needed (using `cpu_has_feature()`), like in <adorad/core/strops.h>.
+    Where an instruction set has no instruction for an operation (integer division, 64-bit multiplication on AVX2 and
+    AVX-512F), that operation runs the scalar loop.
+
+    All kernels give the same results, except for:
+        - Sums of floats, which are computed in several lanes at once (so they're rounded in a different order than a
+          sequential sum would be).
+        - The minimum/maximum of floats that include NaNs, which is unspecified.
+    Integer arithmetic wraps around, like Adorad's. Dividing by 0 is an error (`tensor_arith()` returns false).
+    Comparisons produce a bitmask (bit `i % 64` of word `i / 64` is the result for element `i`), which is what
+    `filter()` and friends consume.
+*/
+
+// Dimensions a tensor can have
+#define TENSOR_MAX_RANK     4
+
+typedef enum TensorDType {
+    TensorDTypeInt16,
+    TensorDTypeInt32,
+    TensorDTypeInt64,
+    TensorDTypeFloat32,
+    TensorDTypeFloat64,
+    TensorNumDTypes,
+} TensorDType;
+
+// An element (of any dtype): `i` for integers, `f` for floats
+typedef union TensorScalar {
+    Int64 i;
+    double f;
+} TensorScalar;
+
+typedef struct Tensor {
+    TensorDType dtype;
+    Byte* data;         // element 0
+    UInt64 len;
+    UInt64 cap;         // elements that fit in `data` (0 if the tensor doesn't own it)
+    Int64 stride;       // elements between consecutive elements (1 if the tensor is contiguous)
+    UInt32 rank;        // dimensions (1 for tensors that can grow)
+    UInt64 shape[TENSOR_MAX_RANK];  // the length of every dimension, if `rank` > 1 (their product is `len`)
+    bool has_slices;    // whether it has been sliced (so its slices may see `data`)
+    struct TensorRetired* retired;  // the buffers it has grown out of since it was sliced (freed with it)
+} Tensor;
+
+typedef enum TensorOp {
+    TensorOpAdd,
+    TensorOpSub,
+    TensorOpMul,
+    TensorOpDiv,
+    TensorOpMin,
+    TensorOpMax,
+} TensorOp;
+
+typedef enum TensorCmp {
+    TensorCmpEq,
+    TensorCmpNe,
+    TensorCmpLt,
+    TensorCmpLe,
+    TensorCmpGt,
+    TensorCmpGe,
+} TensorCmp;
+
+typedef enum TensorReduce {
+    TensorReduceSum,
+    TensorReduceMin,
+    TensorReduceMax,
+} TensorReduce;
+
+typedef enum TensorIsa {
+    TensorIsaScalar,
+    TensorIsaAVX2,
+    TensorIsaAVX512,
+} TensorIsa;
+
+UInt64 tensor_dtype_size(TensorDType dtype);
+bool tensor_dtype_is_float(TensorDType dtype);
+
+// A tensor of `len` zeroes, with room for at least `cap` elements (`Int( {len: 5, cap: 100} )`)
+Tensor* tensor_new(TensorDType dtype, UInt64 len, UInt64 cap);
+// A tensor of zeroes of shape `shape` (`rank` dimensions), in a single buffer
+Tensor* tensor_new_shape(TensorDType dtype, UInt32 rank, const UInt64* shape);
+void tensor_free(Tensor* tensor);
+// Set every element to `value` (`{init: value}`)
+void tensor_fill(Tensor* tensor, TensorScalar value);
+// Make room for at least `cap` elements (copying the elements of a slice into a buffer of its own)
+void tensor_reserve(Tensor* tensor, UInt64 cap);
+// Give the elements of `tensor` the shape `shape` (`rank` dimensions). Returns false if there isn't one element for
+// every index of it (or `rank` isn't between 1 and `TENSOR_MAX_RANK`).
+bool tensor_reshape(Tensor* tensor, UInt32 rank, const UInt64* shape);
+// The length of dimension `dim` (`len` for tensors of rank 1)
+UInt64 tensor_dim(Tensor* tensor, UInt32 dim);
+// Make `view` the slice of `tensor` with the elements `lower`, `lower + step`, ... up to (but not including) `upper`.
+// `view` shares them with `tensor` (see above). Returns false unless `lower <= upper <= len`, `step > 0`, and
+// `tensor` has a rank of 1.
+bool tensor_slice(Tensor* view, Tensor* tensor, UInt64 lower, UInt64 upper, UInt64 step);
+// A contiguous copy of `tensor` (of the same shape) that owns its elements
+Tensor* tensor_clone(Tensor* tensor);
+
+TensorScalar tensor_get(Tensor* tensor, UInt64 index);
+void tensor_set(Tensor* tensor, UInt64 index, TensorScalar value);
+// `tensor << value` (`tensor` must have a rank of 1)
+void tensor_push(Tensor* tensor, TensorScalar value);
+// `tensor << other` (`other` can be `tensor`)
+void tensor_append(Tensor* tensor, Tensor* other);
+
+// `dst = a <op> b`, element-wise. `dst` can be `a` or `b`. Returns false if it divides an integer by 0.
+bool tensor_arith(Tensor* dst, Tensor* a, Tensor* b, TensorOp op);
+// `dst = a <op> b`, for every element of `a`
+bool tensor_arith_scalar(Tensor* dst, Tensor* a, TensorScalar b, TensorOp op);
+// `a <cmp> b`, element-wise, into `mask` (`(len + 63) / 64` words). Returns how many elements compare true.
+UInt64 tensor_compare(Tensor* a, Tensor* b, TensorCmp cmp, UInt64* mask);
+UInt64 tensor_compare_scalar(Tensor* a, TensorScalar b, TensorCmp cmp, UInt64* mask);
+// The sum (0 if `a` is empty), minimum or maximum of the elements of `a`. Returns false if there are none to take the
+// minimum/maximum of.
+bool tensor_reduce(Tensor* a, TensorReduce op, TensorScalar* result);
+// The index of the first element equal to `value`, or -1 (`value in a`)
+Int64 tensor_index_of(Tensor* a, TensorScalar value);
+
+// The kernels in use
+TensorIsa tensor_isa();
+// Use the kernels of `isa` (for tests and benchmarks). Returns false if the CPU doesn't support it.
+bool tensor_set_isa(TensorIsa isa);
+
+#endif // ADORAD_RUNTIME_TENSOR_H
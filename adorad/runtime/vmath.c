@@ -0,0 +1,886 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+
+#include <math.h>
+#include <string.h>
+#include <adorad/core/cpu.h>
+#include <adorad/core/debug.h>
+#include <adorad/core/misc.h>
+#include <adorad/runtime/vmath.h>
+
+#if defined(CORETEN_SIMD_X86_DISPATCH) && defined(CORETEN_SIMD_SSE2)
+    #include <immintrin.h>
+    #define VMATH_HAVE_X86      1
+#endif // CORETEN_SIMD_X86_DISPATCH
+
+// Arguments of `sin`, `cos` and `tan` past these go to libm
+#define VMATH_F32_TRIG_MAX      4096.0f
+#define VMATH_F64_TRIG_MAX      0x1.0p20
+// Elements of a Float32 `pow` that are converted to Float64s at a time
+#define VMATH_POW_CHUNK         256
+
+static CORETEN_ALWAYS_INLINE UInt32 vmath_bits_f32(Float32 x) {
+    UInt32 bits;
+    memcpy(&bits, &x, sizeof(bits));
+    return bits;
+}
+
+static CORETEN_ALWAYS_INLINE Float32 vmath_float_f32(UInt32 bits) {
+    Float32 x;
+    memcpy(&x, &bits, sizeof(x));
+    return x;
+}
+
+static CORETEN_ALWAYS_INLINE UInt64 vmath_bits_f64(Float64 x) {
+    UInt64 bits;
+    memcpy(&bits, &x, sizeof(bits));
+    return bits;
+}
+
+static CORETEN_ALWAYS_INLINE Float64 vmath_float_f64(UInt64 bits) {
+    Float64 x;
+    memcpy(&x, &bits, sizeof(x));
+    return x;
+}
+
+// The nearest integer to `x` (ties to even), like `rint()` (which isn't always inlined)
+static CORETEN_ALWAYS_INLINE Float32 vmath_round_f32(Float32 x) {
+    Float32 ax = fabsf(x);
+    return ax < 0x1.0p23f ? copysignf((ax + 0x1.0p23f) - 0x1.0p23f, x) : x;
+}
+
+static CORETEN_ALWAYS_INLINE Float64 vmath_round_f64(Float64 x) {
+    Float64 ax = fabs(x);
+    return ax < 0x1.0p52 ? copysign((ax + 0x1.0p52) - 0x1.0p52, x) : x;
+}
+
+// `a * b - p`, exactly, where `p` is `a * b` rounded (Dekker's product, for CPUs without FMA)
+static CORETEN_ALWAYS_INLINE Float64 vmath_prod_error_f64(Float64 a, Float64 b, Float64 p) {
+    Float64 ca = 134217729.0 * a;
+    Float64 a_hi = ca - (ca - a);
+    Float64 a_lo = a - a_hi;
+    Float64 cb = 134217729.0 * b;
+    Float64 b_hi = cb - (cb - b);
+    Float64 b_lo = b - b_hi;
+    return ((a_hi * b_hi - p) + a_hi * b_lo + a_lo * b_hi) + a_lo * b_lo;
+}
+
+/*
+    The operations the functions are written in, for every instruction set (`P`). `V` is a vector of floats, `I` a
+    vector of integers of the same width (`AS_I`/`AS_F` reinterpret one as the other), and `M` a mask (of lanes, from
+    comparisons). `SELECT(m, a, b)` is `a` where `m` is set, and `b` elsewhere. `FMS(a, b, p)` is the rounding error of
+    `p = a * b`. Comparisons are false for NaNs (`UNORD` is true for them).
+*/
+#define VMATH_NONE_F32_V                Float32
+#define VMATH_NONE_F32_I                UInt32
+#define VMATH_NONE_F32_M                bool
+#define VMATH_NONE_F32_W                1
+#define VMATH_NONE_F32_LOAD(p)          (*(p))
+#define VMATH_NONE_F32_STORE(p, v)      (*(p) = (v))
+#define VMATH_NONE_F32_SET1(x)          cast(Float32)(x)
+#define VMATH_NONE_F32_ISET1(x)         cast(UInt32)(x)
+#define VMATH_NONE_F32_ADD(a, b)        ((a) + (b))
+#define VMATH_NONE_F32_SUB(a, b)        ((a) - (b))
+#define VMATH_NONE_F32_MUL(a, b)        ((a) * (b))
+#define VMATH_NONE_F32_DIV(a, b)        ((a) / (b))
+#define VMATH_NONE_F32_FMA(a, b, c)     ((a) * (b) + (c))
+#define VMATH_NONE_F32_ROUND            vmath_round_f32
+#define VMATH_NONE_F32_LT(a, b)         ((a) < (b))
+#define VMATH_NONE_F32_EQ(a, b)         ((a) == (b))
+#define VMATH_NONE_F32_UNORD(a, b)      ((a) != (a) || (b) != (b))
+#define VMATH_NONE_F32_MOR(a, b)        ((a) || (b))
+#define VMATH_NONE_F32_MAND(a, b)       ((a) && (b))
+#define VMATH_NONE_F32_MANDNOT(a, b)    ((a) && !(b))
+#define VMATH_NONE_F32_SELECT(m, a, b)  ((m) ? (a) : (b))
+#define VMATH_NONE_F32_ANY(m)           (m)
+#define VMATH_NONE_F32_AS_I             vmath_bits_f32
+#define VMATH_NONE_F32_AS_F             vmath_float_f32
+#define VMATH_NONE_F32_IADD(a, b)       ((a) + (b))
+#define VMATH_NONE_F32_IAND(a, b)       ((a) & (b))
+#define VMATH_NONE_F32_IOR(a, b)        ((a) | (b))
+#define VMATH_NONE_F32_IXOR(a, b)       ((a) ^ (b))
+#define VMATH_NONE_F32_ISHL(a, n)       ((a) << (n))
+#define VMATH_NONE_F32_ISHR(a, n)       ((a) >> (n))
+#define VMATH_NONE_F32_ITEST(a, bit)    (((a) & (bit)) != 0)
+
+#define VMATH_NONE_F64_V                Float64
+#define VMATH_NONE_F64_I                UInt64
+#define VMATH_NONE_F64_M                bool
+#define VMATH_NONE_F64_W                1
+#define VMATH_NONE_F64_LOAD(p)          (*(p))
+#define VMATH_NONE_F64_STORE(p, v)      (*(p) = (v))
+#define VMATH_NONE_F64_SET1(x)          cast(Float64)(x)
+#define VMATH_NONE_F64_ISET1(x)         cast(UInt64)(x)
+#define VMATH_NONE_F64_ADD(a, b)        ((a) + (b))
+#define VMATH_NONE_F64_SUB(a, b)        ((a) - (b))
+#define VMATH_NONE_F64_MUL(a, b)        ((a) * (b))
+#define VMATH_NONE_F64_DIV(a, b)        ((a) / (b))
+#define VMATH_NONE_F64_FMA(a, b, c)     ((a) * (b) + (c))
+#define VMATH_NONE_F64_FMS              vmath_prod_error_f64
+#define VMATH_NONE_F64_ROUND            vmath_round_f64
+#define VMATH_NONE_F64_LT(a, b)         ((a) < (b))
+#define VMATH_NONE_F64_EQ(a, b)         ((a) == (b))
+#define VMATH_NONE_F64_UNORD(a, b)      ((a) != (a) || (b) != (b))
+#define VMATH_NONE_F64_MOR(a, b)        ((a) || (b))
+#define VMATH_NONE_F64_MAND(a, b)       ((a) && (b))
+#define VMATH_NONE_F64_MANDNOT(a, b)    ((a) && !(b))
+#define VMATH_NONE_F64_SELECT(m, a, b)  ((m) ? (a) : (b))
+#define VMATH_NONE_F64_ANY(m)           (m)
+#define VMATH_NONE_F64_AS_I             vmath_bits_f64
+#define VMATH_NONE_F64_AS_F             vmath_float_f64
+#define VMATH_NONE_F64_IADD(a, b)       ((a) + (b))
+#define VMATH_NONE_F64_IAND(a, b)       ((a) & (b))
+#define VMATH_NONE_F64_IOR(a, b)        ((a) | (b))
+#define VMATH_NONE_F64_IXOR(a, b)       ((a) ^ (b))
+#define VMATH_NONE_F64_ISHL(a, n)       ((a) << (n))
+#define VMATH_NONE_F64_ISHR(a, n)       ((a) >> (n))
+#define VMATH_NONE_F64_ITEST(a, bit)    (((a) & (bit)) != 0)
+
+#if defined(VMATH_HAVE_X86)
+    #define VMATH_AVX2                  CORETEN_TARGET("avx2,fma")
+    #define VMATH_AVX512                CORETEN_TARGET("avx512f")
+    #define VMATH_ROUND_MODE            (_MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)
+
+    #define VMATH_AVX2_F32_V            __m256
+    #define VMATH_AVX2_F32_I            __m256i
+    #define VMATH_AVX2_F32_M            __m256
+    #define VMATH_AVX2_F32_W            8
+    #define VMATH_AVX2_F32_LOAD         _mm256_loadu_ps
+    #define VMATH_AVX2_F32_STORE        _mm256_storeu_ps
+    #define VMATH_AVX2_F32_SET1         _mm256_set1_ps
+    #define VMATH_AVX2_F32_ISET1(x)     _mm256_set1_epi32(cast(int)cast(UInt32)(x))
+    #define VMATH_AVX2_F32_ADD          _mm256_add_ps
+    #define VMATH_AVX2_F32_SUB          _mm256_sub_ps
+    #define VMATH_AVX2_F32_MUL          _mm256_mul_ps
+    #define VMATH_AVX2_F32_DIV          _mm256_div_ps
+    #define VMATH_AVX2_F32_FMA          _mm256_fmadd_ps
+    #define VMATH_AVX2_F32_ROUND(v)     _mm256_round_ps(v, VMATH_ROUND_MODE)
+    #define VMATH_AVX2_F32_LT(a, b)     _mm256_cmp_ps(a, b, _CMP_LT_OQ)
+    #define VMATH_AVX2_F32_EQ(a, b)     _mm256_cmp_ps(a, b, _CMP_EQ_OQ)
+    #define VMATH_AVX2_F32_UNORD(a, b)  _mm256_cmp_ps(a, b, _CMP_UNORD_Q)
+    #define VMATH_AVX2_F32_MOR          _mm256_or_ps
+    #define VMATH_AVX2_F32_MAND         _mm256_and_ps
+    #define VMATH_AVX2_F32_MANDNOT(a, b)    _mm256_andnot_ps(b, a)
+    #define VMATH_AVX2_F32_SELECT(m, a, b)  _mm256_blendv_ps(b, a, m)
+    #define VMATH_AVX2_F32_ANY(m)       (_mm256_movemask_ps(m) != 0)
+    #define VMATH_AVX2_F32_AS_I         _mm256_castps_si256
+    #define VMATH_AVX2_F32_AS_F         _mm256_castsi256_ps
+    #define VMATH_AVX2_F32_IADD         _mm256_add_epi32
+    #define VMATH_AVX2_F32_IAND         _mm256_and_si256
+    #define VMATH_AVX2_F32_IOR          _mm256_or_si256
+    #define VMATH_AVX2_F32_IXOR         _mm256_xor_si256
+    #define VMATH_AVX2_F32_ISHL         _mm256_slli_epi32
+    #define VMATH_AVX2_F32_ISHR         _mm256_srli_epi32
+    #define VMATH_AVX2_F32_ITEST(a, bit)    _mm256_castsi256_ps(_mm256_cmpeq_epi32(                               \
+                                            _mm256_and_si256(a, VMATH_AVX2_F32_ISET1(bit)), VMATH_AVX2_F32_ISET1(bit)))
+
+    #define VMATH_AVX2_F64_V            __m256d
+    #define VMATH_AVX2_F64_I            __m256i
+    #define VMATH_AVX2_F64_M            __m256d
+    #define VMATH_AVX2_F64_W            4
+    #define VMATH_AVX2_F64_LOAD         _mm256_loadu_pd
+    #define VMATH_AVX2_F64_STORE        _mm256_storeu_pd
+    #define VMATH_AVX2_F64_SET1         _mm256_set1_pd
+    #define VMATH_AVX2_F64_ISET1(x)     _mm256_set1_epi64x(cast(long long)cast(UInt64)(x))
+    #define VMATH_AVX2_F64_ADD          _mm256_add_pd
+    #define VMATH_AVX2_F64_SUB          _mm256_sub_pd
+    #define VMATH_AVX2_F64_MUL          _mm256_mul_pd
+    #define VMATH_AVX2_F64_DIV          _mm256_div_pd
+    #define VMATH_AVX2_F64_FMA          _mm256_fmadd_pd
+    #define VMATH_AVX2_F64_FMS          _mm256_fmsub_pd
+    #define VMATH_AVX2_F64_ROUND(v)     _mm256_round_pd(v, VMATH_ROUND_MODE)
+    #define VMATH_AVX2_F64_LT(a, b)     _mm256_cmp_pd(a, b, _CMP_LT_OQ)
+    #define VMATH_AVX2_F64_EQ(a, b)     _mm256_cmp_pd(a, b, _CMP_EQ_OQ)
+    #define VMATH_AVX2_F64_UNORD(a, b)  _mm256_cmp_pd(a, b, _CMP_UNORD_Q)
+    #define VMATH_AVX2_F64_MOR          _mm256_or_pd
+    #define VMATH_AVX2_F64_MAND         _mm256_and_pd
+    #define VMATH_AVX2_F64_MANDNOT(a, b)    _mm256_andnot_pd(b, a)
+    #define VMATH_AVX2_F64_SELECT(m, a, b)  _mm256_blendv_pd(b, a, m)
+    #define VMATH_AVX2_F64_ANY(m)       (_mm256_movemask_pd(m) != 0)
+    #define VMATH_AVX2_F64_AS_I         _mm256_castpd_si256
+    #define VMATH_AVX2_F64_AS_F         _mm256_castsi256_pd
+    #define VMATH_AVX2_F64_IADD         _mm256_add_epi64
+    #define VMATH_AVX2_F64_IAND         _mm256_and_si256
+    #define VMATH_AVX2_F64_IOR          _mm256_or_si256
+    #define VMATH_AVX2_F64_IXOR         _mm256_xor_si256
+    #define VMATH_AVX2_F64_ISHL         _mm256_slli_epi64
+    #define VMATH_AVX2_F64_ISHR         _mm256_srli_epi64
+    #define VMATH_AVX2_F64_ITEST(a, bit)    _mm256_castsi256_pd(_mm256_cmpeq_epi64(                               \
+                                            _mm256_and_si256(a, VMATH_AVX2_F64_ISET1(bit)), VMATH_AVX2_F64_ISET1(bit)))
+
+    #define VMATH_AVX512_F32_V          __m512
+    #define VMATH_AVX512_F32_I          __m512i
+    #define VMATH_AVX512_F32_M          __mmask16
+    #define VMATH_AVX512_F32_W          16
+    #define VMATH_AVX512_F32_LOAD       _mm512_loadu_ps
+    #define VMATH_AVX512_F32_STORE      _mm512_storeu_ps
+    #define VMATH_AVX512_F32_SET1       _mm512_set1_ps
+    #define VMATH_AVX512_F32_ISET1(x)   _mm512_set1_epi32(cast(int)cast(UInt32)(x))
+    #define VMATH_AVX512_F32_ADD        _mm512_add_ps
+    #define VMATH_AVX512_F32_SUB        _mm512_sub_ps
+    #define VMATH_AVX512_F32_MUL        _mm512_mul_ps
+    #define VMATH_AVX512_F32_DIV        _mm512_div_ps
+    #define VMATH_AVX512_F32_FMA        _mm512_fmadd_ps
+    #define VMATH_AVX512_F32_ROUND(v)   _mm512_roundscale_ps(v, VMATH_ROUND_MODE)
+    #define VMATH_AVX512_F32_LT(a, b)   _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ)
+    #define VMATH_AVX512_F32_EQ(a, b)   _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ)
+    #define VMATH_AVX512_F32_UNORD(a, b)    _mm512_cmp_ps_mask(a, b, _CMP_UNORD_Q)
+    #define VMATH_AVX512_F32_MOR(a, b)      cast(__mmask16)((a) | (b))
+    #define VMATH_AVX512_F32_MAND(a, b)     cast(__mmask16)((a) & (b))
+    #define VMATH_AVX512_F32_MANDNOT(a, b)  cast(__mmask16)((a) & ~(b))
+    #define VMATH_AVX512_F32_SELECT(m, a, b)    _mm512_mask_blend_ps(m, b, a)
+    #define VMATH_AVX512_F32_ANY(m)     ((m) != 0)
+    #define VMATH_AVX512_F32_AS_I       _mm512_castps_si512
+    #define VMATH_AVX512_F32_AS_F       _mm512_castsi512_ps
+    #define VMATH_AVX512_F32_IADD       _mm512_add_epi32
+    #define VMATH_AVX512_F32_IAND       _mm512_and_si512
+    #define VMATH_AVX512_F32_IOR        _mm512_or_si512
+    #define VMATH_AVX512_F32_IXOR       _mm512_xor_si512
+    #define VMATH_AVX512_F32_ISHL       _mm512_slli_epi32
+    #define VMATH_AVX512_F32_ISHR       _mm512_srli_epi32
+    #define VMATH_AVX512_F32_ITEST(a, bit)  _mm512_test_epi32_mask(a, VMATH_AVX512_F32_ISET1(bit))
+
+    #define VMATH_AVX512_F64_V          __m512d
+    #define VMATH_AVX512_F64_I          __m512i
+    #define VMATH_AVX512_F64_M          __mmask8
+    #define VMATH_AVX512_F64_W          8
+    #define VMATH_AVX512_F64_LOAD       _mm512_loadu_pd
+    #define VMATH_AVX512_F64_STORE      _mm512_storeu_pd
+    #define VMATH_AVX512_F64_SET1       _mm512_set1_pd
+    #define VMATH_AVX512_F64_ISET1(x)   _mm512_set1_epi64(cast(long long)cast(UInt64)(x))
+    #define VMATH_AVX512_F64_ADD        _mm512_add_pd
+    #define VMATH_AVX512_F64_SUB        _mm512_sub_pd
+    #define VMATH_AVX512_F64_MUL        _mm512_mul_pd
+    #define VMATH_AVX512_F64_DIV        _mm512_div_pd
+    #define VMATH_AVX512_F64_FMA        _mm512_fmadd_pd
+    #define VMATH_AVX512_F64_FMS        _mm512_fmsub_pd
+    #define VMATH_AVX512_F64_ROUND(v)   _mm512_roundscale_pd(v, VMATH_ROUND_MODE)
+    #define VMATH_AVX512_F64_LT(a, b)   _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ)
+    #define VMATH_AVX512_F64_EQ(a, b)   _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ)
+    #define VMATH_AVX512_F64_UNORD(a, b)    _mm512_cmp_pd_mask(a, b, _CMP_UNORD_Q)
+    #define VMATH_AVX512_F64_MOR(a, b)      cast(__mmask8)((a) | (b))
+    #define VMATH_AVX512_F64_MAND(a, b)     cast(__mmask8)((a) & (b))
+    #define VMATH_AVX512_F64_MANDNOT(a, b)  cast(__mmask8)((a) & ~(b))
+    #define VMATH_AVX512_F64_SELECT(m, a, b)    _mm512_mask_blend_pd(m, b, a)
+    #define VMATH_AVX512_F64_ANY(m)     ((m) != 0)
+    #define VMATH_AVX512_F64_AS_I       _mm512_castpd_si512
+    #define VMATH_AVX512_F64_AS_F       _mm512_castsi512_pd
+    #define VMATH_AVX512_F64_IADD       _mm512_add_epi64
+    #define VMATH_AVX512_F64_IAND       _mm512_and_si512
+    #define VMATH_AVX512_F64_IOR        _mm512_or_si512
+    #define VMATH_AVX512_F64_IXOR       _mm512_xor_si512
+    #define VMATH_AVX512_F64_ISHL       _mm512_slli_epi64
+    #define VMATH_AVX512_F64_ISHR       _mm512_srli_epi64
+    #define VMATH_AVX512_F64_ITEST(a, bit)  _mm512_test_epi64_mask(a, VMATH_AVX512_F64_ISET1(bit))
+#endif // VMATH_HAVE_X86
+
+#define VMATH_ABS_F32(P, x)             P##_AS_F(P##_IAND(P##_AS_I(x), P##_ISET1(0x7FFFFFFFu)))
+#define VMATH_ABS_F64(P, x)             P##_AS_F(P##_IAND(P##_AS_I(x), P##_ISET1(0x7FFFFFFFFFFFFFFFull)))
+// `x`, negated in the lanes where `sign` (a vector of integers) has the sign bit set
+#define VMATH_FLIP(P, x, sign)          P##_AS_F(P##_IXOR(P##_AS_I(x), sign))
+// `x`, with the sign of `y` (`x` must be positive)
+#define VMATH_SIGN_F32(P, x, y)         P##_AS_F(P##_IOR(P##_AS_I(x), P##_IAND(P##_AS_I(y), P##_ISET1(0x80000000u))))
+#define VMATH_SIGN_F64(P, x, y)         P##_AS_F(P##_IOR(P##_AS_I(x),                                               \
+                                            P##_IAND(P##_AS_I(y), P##_ISET1(0x8000000000000000ull))))
+// `x` between `lo` and `hi` (NaNs stay NaNs)
+#define VMATH_CLAMP(P, x, lo, hi)       P##_SELECT(P##_LT(x, P##_SET1(lo)), P##_SET1(lo),                          \
+                                            P##_SELECT(P##_LT(P##_SET1(hi), x), P##_SET1(hi), x))
+
+/*
+    The functions, on a vector of elements of every instruction set `P`:
+        - `pow2(n)` is `2^n` (for integral `n` in the exponent's range), and `scale(p, n)` is `p * 2^n`, in two steps
+          (for twice that range, so that results that are subnormal are only rounded once).
+        - `sincos()` reduces `x` to `r = x - n * pi/2` (`|r| <= pi/4`), and returns `sin(r)` and `cos(r)`. `q` has the
+          last bits of `n` (the quadrant), and `slow` the lanes it isn't accurate for, which go to `libm()`.
+        - `log_reduce()` splits `x` into `2^e * (1 + f)` (`sqrt(2)/2 <= 1 + f < sqrt(2)`), and `log1p()` is
+          `log(1 + f) - f + f^2/2` (fdlibm's `k_log1p()`, which keeps `f^2/2` apart, for accuracy).
+        - `log_special()` fixes up the results of `log()` and `log2()` for arguments that aren't positive and finite.
+        - `atan01()` is `atan(t)`, for `0 <= t <= 1`, and `atan2()` reduces to it.
+*/
+#define VMATH_KERNELS_F32(ISA, TARGET, P)                                                                       \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_pow2_f32_##ISA(P##_V n) {                                   \
+        P##_I bits = P##_AS_I(P##_ADD(n, P##_SET1(0x1.8p23f)));                                                 \
+        return P##_AS_F(P##_IADD(P##_ISHL(bits, 23), P##_ISET1(127u << 23)));                                   \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_scale_f32_##ISA(P##_V p, P##_V n) {                         \
+        P##_V half = P##_ROUND(P##_MUL(n, P##_SET1(0.5f)));                                                     \
+        return P##_MUL(P##_MUL(p, vmath_pow2_f32_##ISA(half)), vmath_pow2_f32_##ISA(P##_SUB(n, half)));         \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static P##_V vmath_libm_f32_##ISA(P##_V x, float (*fn)(float)) {                                     \
+        Float32 lanes[P##_W];                                                                                   \
+        P##_STORE(lanes, x);                                                                                    \
+        for(int k = 0; k < P##_W; k++)                                                                          \
+            lanes[k] = fn(lanes[k]);                                                                            \
+        return P##_LOAD(lanes);                                                                                 \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_sincos_f32_##ISA(P##_V x, P##_V* c, P##_I* q,               \
+                                                                     P##_M* slow) {                             \
+        P##_V n = P##_ROUND(P##_MUL(x, P##_SET1(0.636619772367581343f)));                                       \
+        P##_V r = P##_SUB(x, P##_MUL(n, P##_SET1(1.5703125f)));                                                 \
+        r = P##_SUB(r, P##_MUL(n, P##_SET1(4.837512969970703125e-4f)));                                         \
+        r = P##_SUB(r, P##_MUL(n, P##_SET1(7.54978995489188216e-8f)));                                          \
+        *q = P##_AS_I(P##_ADD(n, P##_SET1(0x1.8p23f)));                                                         \
+        *slow = P##_MOR(P##_LT(P##_SET1(VMATH_F32_TRIG_MAX), VMATH_ABS_F32(P, x)),                              \
+                        P##_LT(VMATH_ABS_F32(P, r), P##_MUL(VMATH_ABS_F32(P, n), P##_SET1(0x1.0p-21f))));       \
+        P##_V z = P##_MUL(r, r);                                                                                \
+        P##_V cp = P##_FMA(P##_SET1(2.443315711809948e-5f), z, P##_SET1(-1.388731625493765e-3f));               \
+        cp = P##_FMA(cp, z, P##_SET1(4.166664568298827e-2f));                                                   \
+        *c = P##_ADD(P##_FMA(cp, P##_MUL(z, z), P##_MUL(z, P##_SET1(-0.5f))), P##_SET1(1.0f));                  \
+        P##_V sp = P##_FMA(P##_SET1(-1.9515295891e-4f), z, P##_SET1(8.3321608736e-3f));                         \
+        sp = P##_FMA(sp, z, P##_SET1(-1.6666654611e-1f));                                                       \
+        return P##_FMA(sp, P##_MUL(z, r), r);                                                                   \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_sin_f32_##ISA(P##_V x) {                                    \
+        P##_V c;                                                                                                \
+        P##_I q;                                                                                                \
+        P##_M slow;                                                                                             \
+        P##_V s = vmath_sincos_f32_##ISA(x, &c, &q, &slow);                                                     \
+        if(P##_ANY(slow))                                                                                       \
+            return vmath_libm_f32_##ISA(x, sinf);                                                               \
+        P##_V v = P##_SELECT(P##_ITEST(q, 1), c, s);                                                            \
+        v = VMATH_FLIP(P, v, P##_ISHL(P##_IAND(q, P##_ISET1(2)), 30));                                          \
+        return P##_SELECT(P##_EQ(x, P##_SET1(0.0f)), x, v);                                                     \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_cos_f32_##ISA(P##_V x) {                                    \
+        P##_V c;                                                                                                \
+        P##_I q;                                                                                                \
+        P##_M slow;                                                                                             \
+        P##_V s = vmath_sincos_f32_##ISA(x, &c, &q, &slow);                                                     \
+        if(P##_ANY(slow))                                                                                       \
+            return vmath_libm_f32_##ISA(x, cosf);                                                               \
+        P##_V v = P##_SELECT(P##_ITEST(q, 1), s, c);                                                            \
+        return VMATH_FLIP(P, v, P##_ISHL(P##_IAND(P##_IADD(q, P##_ISET1(1)), P##_ISET1(2)), 30));               \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_tan_f32_##ISA(P##_V x) {                                    \
+        P##_V c;                                                                                                \
+        P##_I q;                                                                                                \
+        P##_M slow;                                                                                             \
+        P##_V s = vmath_sincos_f32_##ISA(x, &c, &q, &slow);                                                     \
+        if(P##_ANY(slow))                                                                                       \
+            return vmath_libm_f32_##ISA(x, tanf);                                                               \
+        P##_M odd = P##_ITEST(q, 1);                                                                            \
+        P##_V v = P##_DIV(P##_SELECT(odd, c, s), P##_SELECT(odd, s, c));                                        \
+        v = VMATH_FLIP(P, v, P##_ISHL(P##_IAND(q, P##_ISET1(1)), 31));                                          \
+        return P##_SELECT(P##_EQ(x, P##_SET1(0.0f)), x, v);                                                     \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_exp_f32_##ISA(P##_V x) {                                    \
+        x = VMATH_CLAMP(P, x, -104.0f, 89.0f);                                                                  \
+        P##_V n = P##_ROUND(P##_MUL(x, P##_SET1(1.44269504088896341f)));                                        \
+        P##_V r = P##_FMA(n, P##_SET1(-0.693359375f), x);                                                       \
+        r = P##_FMA(n, P##_SET1(2.12194440e-4f), r);                                                            \
+        P##_V p = P##_FMA(P##_SET1(1.9875691500e-4f), r, P##_SET1(1.3981999507e-3f));                           \
+        p = P##_FMA(p, r, P##_SET1(8.3334519073e-3f));                                                          \
+        p = P##_FMA(p, r, P##_SET1(4.1665795894e-2f));                                                          \
+        p = P##_FMA(p, r, P##_SET1(1.6666665459e-1f));                                                          \
+        p = P##_FMA(p, r, P##_SET1(5.0000001201e-1f));                                                          \
+        p = P##_ADD(P##_FMA(p, P##_MUL(r, r), r), P##_SET1(1.0f));                                              \
+        return vmath_scale_f32_##ISA(p, n);                                                                     \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_log_reduce_f32_##ISA(P##_V x, P##_V* e) {                   \
+        P##_M subnormal = P##_LT(x, P##_SET1(0x1.0p-126f));                                                     \
+        P##_I bits = P##_AS_I(P##_SELECT(subnormal, P##_MUL(x, P##_SET1(0x1.0p23f)), x));                       \
+        *e = P##_AS_F(P##_IOR(P##_ISHR(bits, 23), P##_ISET1(0x4B000000u)));                                     \
+        *e = P##_SUB(*e, P##_SELECT(subnormal, P##_SET1(0x1.0p23f + 150.0f), P##_SET1(0x1.0p23f + 127.0f)));    \
+        P##_V m = P##_AS_F(P##_IOR(P##_IAND(bits, P##_ISET1(0x007FFFFFu)), P##_ISET1(0x3F800000u)));            \
+        P##_M big = P##_LT(P##_SET1(1.41421356f), m);                                                           \
+        *e = P##_SELECT(big, P##_ADD(*e, P##_SET1(1.0f)), *e);                                                  \
+        return P##_SUB(P##_SELECT(big, P##_MUL(m, P##_SET1(0.5f)), m), P##_SET1(1.0f));                         \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_log1p_f32_##ISA(P##_V f, P##_V* hfsq) {                     \
+        P##_V s = P##_DIV(f, P##_ADD(P##_SET1(2.0f), f));                                                       \
+        P##_V z = P##_MUL(s, s);                                                                                \
+        P##_V w = P##_MUL(z, z);                                                                                \
+        P##_V t1 = P##_MUL(w, P##_FMA(w, P##_SET1(0xf89e26.0p-26f), P##_SET1(0xccce13.0p-25f)));                \
+        P##_V t2 = P##_MUL(z, P##_FMA(w, P##_SET1(0x91e9ee.0p-25f), P##_SET1(0xaaaaaa.0p-24f)));                \
+        *hfsq = P##_MUL(P##_MUL(P##_SET1(0.5f), f), f);                                                         \
+        return P##_MUL(s, P##_ADD(*hfsq, P##_ADD(t2, t1)));                                                     \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_log_special_f32_##ISA(P##_V x, P##_V r) {                   \
+        r = P##_SELECT(P##_LT(x, P##_SET1(INFINITY)), r, x);                                                    \
+        r = P##_SELECT(P##_EQ(x, P##_SET1(0.0f)), P##_SET1(-INFINITY), r);                                      \
+        return P##_SELECT(P##_LT(x, P##_SET1(0.0f)), P##_SET1(NAN), r);                                         \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_log_f32_##ISA(P##_V x) {                                    \
+        P##_V e, hfsq;                                                                                          \
+        P##_V f = vmath_log_reduce_f32_##ISA(x, &e);                                                            \
+        P##_V r = vmath_log1p_f32_##ISA(f, &hfsq);                                                              \
+        r = P##_SUB(P##_FMA(e, P##_SET1(9.0580006145e-06f), r), hfsq);                                          \
+        r = P##_FMA(e, P##_SET1(6.9313812256e-01f), P##_ADD(r, f));                                             \
+        return vmath_log_special_f32_##ISA(x, r);                                                               \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_log2_f32_##ISA(P##_V x) {                                   \
+        P##_V e, hfsq;                                                                                          \
+        P##_V f = vmath_log_reduce_f32_##ISA(x, &e);                                                            \
+        P##_V r = vmath_log1p_f32_##ISA(f, &hfsq);                                                              \
+        P##_V hi = P##_AS_F(P##_IAND(P##_AS_I(P##_SUB(f, hfsq)), P##_ISET1(0xFFFFF000u)));                      \
+        P##_V lo = P##_ADD(P##_SUB(P##_SUB(f, hi), hfsq), r);                                                   \
+        r = P##_FMA(P##_ADD(lo, hi), P##_SET1(-1.7605285393e-04f), P##_MUL(lo, P##_SET1(1.44287109375f)));      \
+        r = P##_ADD(P##_FMA(hi, P##_SET1(1.44287109375f), r), e);                                               \
+        return vmath_log_special_f32_##ISA(x, r);                                                               \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_atan01_f32_##ISA(P##_V t) {                                 \
+        P##_M big = P##_LT(P##_SET1(0.4142135623730950f), t);                                                   \
+        t = P##_SELECT(big, P##_DIV(P##_SUB(t, P##_SET1(1.0f)), P##_ADD(t, P##_SET1(1.0f))), t);                \
+        P##_V z = P##_MUL(t, t);                                                                                \
+        P##_V p = P##_FMA(P##_SET1(8.05374449538e-2f), z, P##_SET1(-1.38776856032e-1f));                        \
+        p = P##_FMA(p, z, P##_SET1(1.99777106478e-1f));                                                         \
+        p = P##_FMA(p, z, P##_SET1(-3.33329491539e-1f));                                                        \
+        P##_V a = P##_FMA(P##_MUL(p, z), t, t);                                                                 \
+        P##_V pio4 = P##_ADD(P##_ADD(a, P##_SET1(-2.18556941e-8f)), P##_SET1(0.785398185f));                    \
+        return P##_SELECT(big, pio4, a);                                                                        \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_atan2_f32_##ISA(P##_V y, P##_V x) {                         \
+        P##_V ax = VMATH_ABS_F32(P, x);                                                                         \
+        P##_V ay = VMATH_ABS_F32(P, y);                                                                         \
+        P##_M swap = P##_LT(ax, ay);                                                                            \
+        P##_V num = P##_SELECT(swap, ax, ay);                                                                   \
+        P##_V den = P##_SELECT(swap, ay, ax);                                                                   \
+        P##_V t = P##_DIV(num, den);                                                                            \
+        t = P##_SELECT(P##_EQ(den, P##_SET1(0.0f)), P##_SET1(0.0f), t);                                         \
+        t = P##_SELECT(P##_EQ(num, P##_SET1(INFINITY)), P##_SET1(1.0f), t);                                     \
+        P##_V a = vmath_atan01_f32_##ISA(t);                                                                    \
+        P##_V pio2 = P##_ADD(P##_SUB(P##_SET1(1.57079637f), a), P##_SET1(-4.37113883e-8f));                     \
+        a = P##_SELECT(swap, pio2, a);                                                                          \
+        P##_V pi = P##_ADD(P##_SUB(P##_SET1(3.14159274f), a), P##_SET1(-8.74227766e-8f));                       \
+        a = P##_SELECT(P##_ITEST(P##_AS_I(x), 0x80000000u), pi, a);                                             \
+        a = VMATH_SIGN_F32(P, a, y);                                                                            \
+        return P##_SELECT(P##_UNORD(x, y), P##_ADD(x, y), a);                                                   \
+    }
+
+#define VMATH_KERNELS_F64(ISA, TARGET, P)                                                                       \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_pow2_f64_##ISA(P##_V n) {                                   \
+        P##_I bits = P##_AS_I(P##_ADD(n, P##_SET1(0x1.8p52)));                                                  \
+        return P##_AS_F(P##_IADD(P##_ISHL(bits, 52), P##_ISET1(1023ull << 52)));                                \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_scale_f64_##ISA(P##_V p, P##_V n) {                         \
+        P##_V half = P##_ROUND(P##_MUL(n, P##_SET1(0.5)));                                                      \
+        return P##_MUL(P##_MUL(p, vmath_pow2_f64_##ISA(half)), vmath_pow2_f64_##ISA(P##_SUB(n, half)));         \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static P##_V vmath_libm_f64_##ISA(P##_V x, double (*fn)(double)) {                                   \
+        Float64 lanes[P##_W];                                                                                   \
+        P##_STORE(lanes, x);                                                                                    \
+        for(int k = 0; k < P##_W; k++)                                                                          \
+            lanes[k] = fn(lanes[k]);                                                                            \
+        return P##_LOAD(lanes);                                                                                 \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_sincos_f64_##ISA(P##_V x, P##_V* c, P##_I* q,               \
+                                                                     P##_M* slow) {                             \
+        P##_V n = P##_ROUND(P##_MUL(x, P##_SET1(6.36619772367581382433e-01)));                                  \
+        P##_V r1 = P##_SUB(x, P##_MUL(n, P##_SET1(1.57079632673412561417e+00)));                                \
+        P##_V w = P##_MUL(n, P##_SET1(6.07710050630396597660e-11));                                             \
+        P##_V r = P##_SUB(r1, w);                                                                               \
+        P##_V lo = P##_SUB(P##_SUB(P##_SUB(r1, r), w), P##_MUL(n, P##_SET1(2.02226624879595063154e-21)));       \
+        *q = P##_AS_I(P##_ADD(n, P##_SET1(0x1.8p52)));                                                          \
+        *slow = P##_MOR(P##_LT(P##_SET1(VMATH_F64_TRIG_MAX), VMATH_ABS_F64(P, x)),                              \
+                        P##_LT(VMATH_ABS_F64(P, r), P##_MUL(VMATH_ABS_F64(P, n), P##_SET1(0x1.0p-62))));        \
+        P##_V z = P##_MUL(r, r);                                                                                \
+        P##_V cp = P##_FMA(P##_SET1(-1.13596475577881948265e-11), z, P##_SET1(2.08757232129817482790e-09));     \
+        cp = P##_FMA(cp, z, P##_SET1(-2.75573143513906633035e-07));                                             \
+        cp = P##_FMA(cp, z, P##_SET1(2.48015872894767294178e-05));                                              \
+        cp = P##_FMA(cp, z, P##_SET1(-1.38888888888741095749e-03));                                             \
+        cp = P##_MUL(z, P##_FMA(cp, z, P##_SET1(4.16666666666666019037e-02)));                                  \
+        P##_V hz = P##_MUL(z, P##_SET1(0.5));                                                                   \
+        w = P##_SUB(P##_SET1(1.0), hz);                                                                         \
+        P##_V c_lo = P##_SUB(P##_MUL(z, cp), P##_MUL(r, lo));                                                   \
+        *c = P##_ADD(w, P##_ADD(P##_SUB(P##_SUB(P##_SET1(1.0), w), hz), c_lo));                                 \
+        P##_V sp = P##_FMA(P##_SET1(1.58969099521155010221e-10), z, P##_SET1(-2.50507602534068634195e-08));     \
+        sp = P##_FMA(sp, z, P##_SET1(2.75573137070700676789e-06));                                              \
+        sp = P##_FMA(sp, z, P##_SET1(-1.98412698298579493134e-04));                                             \
+        sp = P##_FMA(sp, z, P##_SET1(8.33333333332248946124e-03));                                              \
+        P##_V v = P##_MUL(z, r);                                                                                \
+        P##_V s = P##_SUB(P##_MUL(z, P##_SUB(P##_MUL(P##_SET1(0.5), lo), P##_MUL(v, sp))), lo);                 \
+        return P##_SUB(r, P##_SUB(s, P##_MUL(v, P##_SET1(-1.66666666666666324348e-01))));                       \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_sin_f64_##ISA(P##_V x) {                                    \
+        P##_V c;                                                                                                \
+        P##_I q;                                                                                                \
+        P##_M slow;                                                                                             \
+        P##_V s = vmath_sincos_f64_##ISA(x, &c, &q, &slow);                                                     \
+        if(P##_ANY(slow))                                                                                       \
+            return vmath_libm_f64_##ISA(x, sin);                                                                \
+        P##_V v = P##_SELECT(P##_ITEST(q, 1), c, s);                                                            \
+        v = VMATH_FLIP(P, v, P##_ISHL(P##_IAND(q, P##_ISET1(2)), 62));                                          \
+        return P##_SELECT(P##_EQ(x, P##_SET1(0.0)), x, v);                                                      \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_cos_f64_##ISA(P##_V x) {                                    \
+        P##_V c;                                                                                                \
+        P##_I q;                                                                                                \
+        P##_M slow;                                                                                             \
+        P##_V s = vmath_sincos_f64_##ISA(x, &c, &q, &slow);                                                     \
+        if(P##_ANY(slow))                                                                                       \
+            return vmath_libm_f64_##ISA(x, cos);                                                                \
+        P##_V v = P##_SELECT(P##_ITEST(q, 1), s, c);                                                            \
+        return VMATH_FLIP(P, v, P##_ISHL(P##_IAND(P##_IADD(q, P##_ISET1(1)), P##_ISET1(2)), 62));               \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_tan_f64_##ISA(P##_V x) {                                    \
+        P##_V c;                                                                                                \
+        P##_I q;                                                                                                \
+        P##_M slow;                                                                                             \
+        P##_V s = vmath_sincos_f64_##ISA(x, &c, &q, &slow);                                                     \
+        if(P##_ANY(slow))                                                                                       \
+            return vmath_libm_f64_##ISA(x, tan);                                                                \
+        P##_M odd = P##_ITEST(q, 1);                                                                            \
+        P##_V v = P##_DIV(P##_SELECT(odd, c, s), P##_SELECT(odd, s, c));                                        \
+        v = VMATH_FLIP(P, v, P##_ISHL(P##_IAND(q, P##_ISET1(1)), 63));                                          \
+        return P##_SELECT(P##_EQ(x, P##_SET1(0.0)), x, v);                                                      \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_exp_poly_f64_##ISA(P##_V r) {                               \
+        P##_V p = P##_FMA(P##_SET1(1.0 / 6227020800.0), r, P##_SET1(1.0 / 479001600.0));                        \
+        p = P##_FMA(p, r, P##_SET1(1.0 / 39916800.0));                                                          \
+        p = P##_FMA(p, r, P##_SET1(1.0 / 3628800.0));                                                           \
+        p = P##_FMA(p, r, P##_SET1(1.0 / 362880.0));                                                            \
+        p = P##_FMA(p, r, P##_SET1(1.0 / 40320.0));                                                             \
+        p = P##_FMA(p, r, P##_SET1(1.0 / 5040.0));                                                              \
+        p = P##_FMA(p, r, P##_SET1(1.0 / 720.0));                                                               \
+        p = P##_FMA(p, r, P##_SET1(1.0 / 120.0));                                                               \
+        p = P##_FMA(p, r, P##_SET1(1.0 / 24.0));                                                                \
+        p = P##_FMA(p, r, P##_SET1(1.0 / 6.0));                                                                 \
+        p = P##_FMA(p, r, P##_SET1(0.5));                                                                       \
+        return P##_ADD(P##_FMA(p, P##_MUL(r, r), r), P##_SET1(1.0));                                            \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_exp_f64_##ISA(P##_V x) {                                    \
+        x = VMATH_CLAMP(P, x, -746.0, 710.0);                                                                   \
+        P##_V n = P##_ROUND(P##_MUL(x, P##_SET1(1.44269504088896338700e+00)));                                  \
+        P##_V r = P##_SUB(x, P##_MUL(n, P##_SET1(6.93147180369123816490e-01)));                                 \
+        r = P##_SUB(r, P##_MUL(n, P##_SET1(1.90821492927058770002e-10)));                                       \
+        return vmath_scale_f64_##ISA(vmath_exp_poly_f64_##ISA(r), n);                                           \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_log_reduce_f64_##ISA(P##_V x, P##_V* e) {                   \
+        P##_M subnormal = P##_LT(x, P##_SET1(0x1.0p-1022));                                                     \
+        P##_I bits = P##_AS_I(P##_SELECT(subnormal, P##_MUL(x, P##_SET1(0x1.0p54)), x));                        \
+        *e = P##_AS_F(P##_IOR(P##_ISHR(bits, 52), P##_ISET1(0x4330000000000000ull)));                           \
+        *e = P##_SUB(*e, P##_SELECT(subnormal, P##_SET1(0x1.0p52 + 1077.0), P##_SET1(0x1.0p52 + 1023.0)));      \
+        P##_V m = P##_AS_F(P##_IOR(P##_IAND(bits, P##_ISET1(0x000FFFFFFFFFFFFFull)),                            \
+                                   P##_ISET1(0x3FF0000000000000ull)));                                          \
+        P##_M big = P##_LT(P##_SET1(1.41421356237309504880), m);                                                \
+        *e = P##_SELECT(big, P##_ADD(*e, P##_SET1(1.0)), *e);                                                   \
+        return P##_SUB(P##_SELECT(big, P##_MUL(m, P##_SET1(0.5)), m), P##_SET1(1.0));                           \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_log1p_f64_##ISA(P##_V f, P##_V* hfsq) {                     \
+        P##_V s = P##_DIV(f, P##_ADD(P##_SET1(2.0), f));                                                        \
+        P##_V z = P##_MUL(s, s);                                                                                \
+        P##_V w = P##_MUL(z, z);                                                                                \
+        P##_V t1 = P##_FMA(w, P##_SET1(1.531383769920937332e-01), P##_SET1(2.222219843214978396e-01));          \
+        t1 = P##_FMA(w, t1, P##_SET1(3.999999999940941908e-01));                                                \
+        t1 = P##_MUL(w, t1);                                                                                    \
+        P##_V t2 = P##_FMA(w, P##_SET1(1.479819860511658591e-01), P##_SET1(1.818357216161805012e-01));          \
+        t2 = P##_FMA(w, t2, P##_SET1(2.857142874366239149e-01));                                                \
+        t2 = P##_MUL(z, P##_FMA(w, t2, P##_SET1(6.666666666666735130e-01)));                                    \
+        *hfsq = P##_MUL(P##_MUL(P##_SET1(0.5), f), f);                                                          \
+        return P##_MUL(s, P##_ADD(*hfsq, P##_ADD(t2, t1)));                                                     \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_log_special_f64_##ISA(P##_V x, P##_V r) {                   \
+        r = P##_SELECT(P##_LT(x, P##_SET1(INFINITY)), r, x);                                                    \
+        r = P##_SELECT(P##_EQ(x, P##_SET1(0.0)), P##_SET1(-INFINITY), r);                                       \
+        return P##_SELECT(P##_LT(x, P##_SET1(0.0)), P##_SET1(NAN), r);                                          \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_log_f64_##ISA(P##_V x) {                                    \
+        P##_V e, hfsq;                                                                                          \
+        P##_V f = vmath_log_reduce_f64_##ISA(x, &e);                                                            \
+        P##_V r = vmath_log1p_f64_##ISA(f, &hfsq);                                                              \
+        r = P##_SUB(P##_SUB(hfsq, P##_FMA(e, P##_SET1(1.90821492927058770002e-10), r)), f);                     \
+        r = P##_SUB(P##_MUL(e, P##_SET1(6.93147180369123816490e-01)), r);                                       \
+        return vmath_log_special_f64_##ISA(x, r);                                                               \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_log2_f64_##ISA(P##_V x) {                                   \
+        P##_V e, hfsq;                                                                                          \
+        P##_V f = vmath_log_reduce_f64_##ISA(x, &e);                                                            \
+        P##_V r = vmath_log1p_f64_##ISA(f, &hfsq);                                                              \
+        P##_V hi = P##_AS_F(P##_IAND(P##_AS_I(P##_SUB(f, hfsq)), P##_ISET1(0xFFFFFFFF00000000ull)));            \
+        P##_V lo = P##_ADD(P##_SUB(P##_SUB(f, hi), hfsq), r);                                                   \
+        P##_V val_hi = P##_MUL(hi, P##_SET1(1.44269504072144627571e+00));                                       \
+        P##_V val_lo = P##_FMA(P##_ADD(lo, hi), P##_SET1(1.67517131648865118353e-10),                           \
+                               P##_MUL(lo, P##_SET1(1.44269504072144627571e+00)));                              \
+        P##_V w = P##_ADD(e, val_hi);                                                                           \
+        val_lo = P##_ADD(val_lo, P##_ADD(P##_SUB(e, w), val_hi));                                               \
+        return vmath_log_special_f64_##ISA(x, P##_ADD(val_lo, w));                                              \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_log2_dd_f64_##ISA(P##_V x, P##_V* lo) {                     \
+        P##_V e;                                                                                                \
+        P##_V f = vmath_log_reduce_f64_##ISA(x, &e);                                                            \
+        P##_V d = P##_ADD(f, P##_SET1(2.0));                                                                    \
+        P##_V d_lo = P##_SUB(f, P##_SUB(d, P##_SET1(2.0)));                                                     \
+        P##_V s = P##_DIV(f, d);                                                                                \
+        P##_V p = P##_MUL(s, d);                                                                                \
+        P##_V s_lo = P##_SUB(P##_SUB(f, p), P##_FMS(s, d, p));                                                  \
+        s_lo = P##_DIV(P##_SUB(s_lo, P##_MUL(s, d_lo)), d);                                                     \
+        P##_V z = P##_MUL(s, s);                                                                                \
+        P##_V z_lo = P##_FMA(P##_ADD(s, s), s_lo, P##_FMS(s, s, z));                                            \
+        P##_V c = P##_MUL(s, z);                                                                                \
+        P##_V c_lo = P##_ADD(P##_FMS(s, z, c), P##_FMA(s, z_lo, P##_MUL(s_lo, z)));                             \
+        P##_V t = P##_MUL(c, P##_SET1(6.66666666666666629659e-01));                                             \
+        P##_V t_lo = P##_FMA(c, P##_SET1(3.70074341541718835e-17),                                              \
+                             P##_MUL(c_lo, P##_SET1(6.66666666666666629659e-01)));                              \
+        t_lo = P##_ADD(t_lo, P##_FMS(c, P##_SET1(6.66666666666666629659e-01), t));                              \
+        P##_V series = P##_FMA(P##_SET1(2.0 / 25.0), z, P##_SET1(2.0 / 23.0));                                  \
+        series = P##_FMA(series, z, P##_SET1(2.0 / 21.0));                                                      \
+        series = P##_FMA(series, z, P##_SET1(2.0 / 19.0));                                                      \
+        series = P##_FMA(series, z, P##_SET1(2.0 / 17.0));                                                      \
+        series = P##_FMA(series, z, P##_SET1(2.0 / 15.0));                                                      \
+        series = P##_FMA(series, z, P##_SET1(2.0 / 13.0));                                                      \
+        series = P##_FMA(series, z, P##_SET1(2.0 / 11.0));                                                      \
+        series = P##_FMA(series, z, P##_SET1(2.0 / 9.0));                                                       \
+        series = P##_FMA(series, z, P##_SET1(2.0 / 7.0));                                                       \
+        series = P##_FMA(series, z, P##_SET1(2.0 / 5.0));                                                       \
+        series = P##_MUL(P##_MUL(series, z), c);                                                                \
+        P##_V s2 = P##_ADD(s, s);                                                                               \
+        P##_V ln = P##_ADD(s2, t);                                                                              \
+        P##_V ln_lo = P##_ADD(P##_SUB(t, P##_SUB(ln, s2)), P##_ADD(P##_ADD(s_lo, s_lo), P##_ADD(t_lo, series))); \
+        P##_V l = P##_MUL(ln, P##_SET1(1.44269504088896338700e+00));                                            \
+        P##_V l_lo = P##_FMA(ln, P##_SET1(2.03552737409310331e-17),                                             \
+                             P##_MUL(ln_lo, P##_SET1(1.44269504088896338700e+00)));                             \
+        l_lo = P##_ADD(l_lo, P##_FMS(ln, P##_SET1(1.44269504088896338700e+00), l));                             \
+        P##_V w = P##_ADD(e, l);                                                                                \
+        P##_V b = P##_SUB(w, e);                                                                                \
+        P##_V w_lo = P##_ADD(P##_ADD(P##_SUB(e, P##_SUB(w, b)), P##_SUB(l, b)), l_lo);                          \
+        P##_V r = P##_ADD(w, w_lo);                                                                             \
+        *lo = P##_SUB(w_lo, P##_SUB(r, w));                                                                     \
+        return r;                                                                                               \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_pow_f64_##ISA(P##_V x, P##_V y) {                           \
+        P##_V ax = VMATH_ABS_F64(P, x);                                                                         \
+        P##_V l_lo;                                                                                             \
+        P##_V l = vmath_log2_dd_f64_##ISA(ax, &l_lo);                                                           \
+        P##_M finite = P##_MAND(P##_LT(P##_SET1(0.0), ax), P##_LT(ax, P##_SET1(INFINITY)));                     \
+        l = P##_SELECT(finite, l, P##_SELECT(P##_EQ(ax, P##_SET1(0.0)), P##_SET1(-INFINITY), ax));              \
+        l_lo = P##_SELECT(finite, l_lo, P##_SET1(0.0));                                                         \
+        P##_V t = P##_MUL(y, l);                                                                                \
+        P##_V t_lo = P##_FMA(y, l_lo, P##_FMS(y, l, t));                                                        \
+        /* Dekker's product (in scalar `FMS`) overflows for huge `y`s, which have `|t| >= 1100` or `t == 0` */  \
+        P##_M small = P##_MAND(P##_LT(VMATH_ABS_F64(P, t), P##_SET1(1100.0)),                                   \
+                               P##_LT(VMATH_ABS_F64(P, t_lo), P##_SET1(INFINITY)));                             \
+        t_lo = P##_SELECT(small, t_lo, P##_SET1(0.0));                                                          \
+        t = VMATH_CLAMP(P, t, -1100.0, 1100.0);                                                                 \
+        P##_V n = P##_ROUND(t);                                                                                 \
+        P##_V f = P##_ADD(P##_SUB(t, n), t_lo);                                                                 \
+        P##_V r = P##_FMA(f, P##_SET1(6.93147180559945286227e-01), P##_MUL(f, P##_SET1(2.31904681384629955842e-17))); \
+        r = vmath_scale_f64_##ISA(vmath_exp_poly_f64_##ISA(r), n);                                              \
+        P##_M is_int = P##_EQ(P##_ROUND(y), y);                                                                 \
+        P##_V half = P##_MUL(y, P##_SET1(0.5));                                                                 \
+        P##_M odd = P##_MANDNOT(is_int, P##_EQ(P##_ROUND(half), half));                                         \
+        P##_M flip = P##_MAND(odd, P##_ITEST(P##_AS_I(x), 0x8000000000000000ull));                              \
+        r = P##_SELECT(flip, VMATH_FLIP(P, r, P##_ISET1(0x8000000000000000ull)), r);                            \
+        P##_M negative = P##_MAND(P##_LT(x, P##_SET1(0.0)), P##_LT(P##_SET1(-INFINITY), x));                    \
+        r = P##_SELECT(P##_MANDNOT(negative, is_int), P##_SET1(NAN), r);                                        \
+        P##_M one = P##_MOR(P##_EQ(y, P##_SET1(0.0)), P##_EQ(x, P##_SET1(1.0)));                                \
+        one = P##_MOR(one, P##_MAND(P##_EQ(ax, P##_SET1(1.0)), P##_EQ(VMATH_ABS_F64(P, y), P##_SET1(INFINITY)))); \
+        return P##_SELECT(one, P##_SET1(1.0), r);                                                               \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_atan01_f64_##ISA(P##_V t) {                                 \
+        P##_M small = P##_LT(t, P##_SET1(0.4375));                                                              \
+        P##_M mid = P##_LT(t, P##_SET1(0.6875));                                                                \
+        P##_V u = P##_SELECT(mid, P##_DIV(P##_FMA(t, P##_SET1(2.0), P##_SET1(-1.0)), P##_ADD(t, P##_SET1(2.0))), \
+                             P##_DIV(P##_SUB(t, P##_SET1(1.0)), P##_ADD(t, P##_SET1(1.0))));                    \
+        u = P##_SELECT(small, t, u);                                                                            \
+        P##_V hi = P##_SELECT(mid, P##_SET1(4.63647609000806093515e-01), P##_SET1(7.85398163397448278999e-01)); \
+        P##_V lo = P##_SELECT(mid, P##_SET1(2.26987774529616870924e-17), P##_SET1(3.06161699786838301793e-17)); \
+        P##_V z = P##_MUL(u, u);                                                                                \
+        P##_V w = P##_MUL(z, z);                                                                                \
+        P##_V s1 = P##_FMA(w, P##_SET1(1.62858201153657823623e-02), P##_SET1(4.97687799461593236017e-02));      \
+        s1 = P##_FMA(w, s1, P##_SET1(6.66107313738753120669e-02));                                              \
+        s1 = P##_FMA(w, s1, P##_SET1(9.09088713343650656196e-02));                                              \
+        s1 = P##_FMA(w, s1, P##_SET1(1.42857142725034663711e-01));                                              \
+        s1 = P##_MUL(z, P##_FMA(w, s1, P##_SET1(3.33333333333329318027e-01)));                                  \
+        P##_V s2 = P##_FMA(w, P##_SET1(-3.65315727442169155270e-02), P##_SET1(-5.83357013379057348645e-02));    \
+        s2 = P##_FMA(w, s2, P##_SET1(-7.69187620504482999495e-02));                                             \
+        s2 = P##_FMA(w, s2, P##_SET1(-1.11111104054623557880e-01));                                             \
+        s2 = P##_MUL(w, P##_FMA(w, s2, P##_SET1(-1.99999999998764832476e-01)));                                 \
+        P##_V v = P##_MUL(u, P##_ADD(s1, s2));                                                                  \
+        return P##_SELECT(small, P##_SUB(u, v), P##_SUB(hi, P##_SUB(P##_SUB(v, lo), u)));                       \
+    }                                                                                                           \
+                                                                                                                \
+    TARGET static CORETEN_ALWAYS_INLINE P##_V vmath_atan2_f64_##ISA(P##_V y, P##_V x) {                         \
+        P##_V ax = VMATH_ABS_F64(P, x);                                                                         \
+        P##_V ay = VMATH_ABS_F64(P, y);                                                                         \
+        P##_M swap = P##_LT(ax, ay);                                                                            \
+        P##_V num = P##_SELECT(swap, ax, ay);                                                                   \
+        P##_V den = P##_SELECT(swap, ay, ax);                                                                   \
+        P##_V t = P##_DIV(num, den);                                                                            \
+        t = P##_SELECT(P##_EQ(den, P##_SET1(0.0)), P##_SET1(0.0), t);                                           \
+        t = P##_SELECT(P##_EQ(num, P##_SET1(INFINITY)), P##_SET1(1.0), t);                                      \
+        P##_V a = vmath_atan01_f64_##ISA(t);                                                                    \
+        P##_V pio2 = P##_ADD(P##_SUB(P##_SET1(1.57079632679489655800e+00), a), P##_SET1(6.12323399573676603587e-17)); \
+        a = P##_SELECT(swap, pio2, a);                                                                          \
+        P##_V pi = P##_ADD(P##_SUB(P##_SET1(3.14159265358979311600e+00), a), P##_SET1(1.22464679914735317720e-16)); \
+        a = P##_SELECT(P##_ITEST(P##_AS_I(x), 0x8000000000000000ull), pi, a);                                   \
+        a = VMATH_SIGN_F64(P, a, y);                                                                            \
+        return P##_SELECT(P##_UNORD(x, y), P##_ADD(x, y), a);                                                   \
+    }
+
+// `dst[i] = F(a[i])`, `W` elements at a time. The last few go through a vector of their own (padded with ones).
+#define VMATH_UNARY_LOOP(P, T, F)                                                                               \
+    for(; i + P##_W <= n; i += P##_W)                                                                           \
+        P##_STORE(dst + i, F(P##_LOAD(a + i)));                                                                 \
+    if(i < n) {                                                                                                 \
+        T xs[P##_W];                                                                                            \
+        for(UInt64 k = 0; k < P##_W; k++)                                                                       \
+            xs[k] = i + k < n ? a[i + k] : 1;                                                                   \
+        P##_STORE(xs, F(P##_LOAD(xs)));                                                                         \
+        memcpy(dst + i, xs, (n - i) * sizeof(T));                                                               \
+    }
+
+// `dst[i] = F(a[i], b[i])`
+#define VMATH_BINARY_LOOP(P, T, F)                                                                              \
+    for(; i + P##_W <= n; i += P##_W)                                                                           \
+        P##_STORE(dst + i, F(P##_LOAD(a + i), P##_LOAD(b + i)));                                                \
+    if(i < n) {                                                                                                 \
+        T xs[P##_W];                                                                                            \
+        T ys[P##_W];                                                                                            \
+        for(UInt64 k = 0; k < P##_W; k++) {                                                                     \
+            xs[k] = i + k < n ? a[i + k] : 1;                                                                   \
+            ys[k] = i + k < n ? b[i + k] : 1;                                                                   \
+        }                                                                                                       \
+        P##_STORE(xs, F(P##_LOAD(xs), P##_LOAD(ys)));                                                           \
+        memcpy(dst + i, xs, (n - i) * sizeof(T));                                                               \
+    }
+
+// Float64s `pow` directly, and Float32s convert their arguments to Float64s (a chunk at a time) first
+#define VMATH_POW_f64(ISA, P, T)        VMATH_BINARY_LOOP(P, T, vmath_pow_f64_##ISA)
+#define VMATH_POW_f32(ISA, P, T)                                                                                \
+    for(; i < n; i += VMATH_POW_CHUNK) {                                                                        \
+        Float64 xs[VMATH_POW_CHUNK];                                                                            \
+        Float64 ys[VMATH_POW_CHUNK];                                                                            \
+        UInt64 len = n - i < VMATH_POW_CHUNK ? n - i : VMATH_POW_CHUNK;                                         \
+        for(UInt64 k = 0; k < len; k++) {                                                                       \
+            xs[k] = a[i + k];                                                                                   \
+            ys[k] = b[i + k];                                                                                   \
+        }                                                                                                       \
+        vmath_f64_##ISA(TensorMathPow, xs, xs, ys, len);                                                        \
+        for(UInt64 k = 0; k < len; k++)                                                                         \
+            dst[i + k] = cast(Float32)xs[k];                                                                    \
+    }
+
+#define VMATH_LOOPS(ISA, TARGET, SFX, T, P)                                                                     \
+    TARGET static void vmath_##SFX##_##ISA(TensorMath fn, T* dst, const T* a, const T* b, UInt64 n) {           \
+        UInt64 i = 0;                                                                                           \
+        switch(fn) {                                                                                            \
+            case TensorMathSin: VMATH_UNARY_LOOP(P, T, vmath_sin_##SFX##_##ISA) break;                          \
+            case TensorMathCos: VMATH_UNARY_LOOP(P, T, vmath_cos_##SFX##_##ISA) break;                          \
+            case TensorMathTan: VMATH_UNARY_LOOP(P, T, vmath_tan_##SFX##_##ISA) break;                          \
+            case TensorMathExp: VMATH_UNARY_LOOP(P, T, vmath_exp_##SFX##_##ISA) break;                          \
+            case TensorMathLog: VMATH_UNARY_LOOP(P, T, vmath_log_##SFX##_##ISA) break;                          \
+            case TensorMathLog2: VMATH_UNARY_LOOP(P, T, vmath_log2_##SFX##_##ISA) break;                        \
+            case TensorMathPow: VMATH_POW_##SFX(ISA, P, T) break;                                               \
+            default: VMATH_BINARY_LOOP(P, T, vmath_atan2_##SFX##_##ISA) break;                                  \
+        }                                                                                                       \
+    }
+
+VMATH_KERNELS_F64(scalar, , VMATH_NONE_F64)
+VMATH_LOOPS(scalar, , f64, Float64, VMATH_NONE_F64)
+VMATH_KERNELS_F32(scalar, , VMATH_NONE_F32)
+VMATH_LOOPS(scalar, , f32, Float32, VMATH_NONE_F32)
+
+#if defined(VMATH_HAVE_X86)
+    VMATH_KERNELS_F64(avx2, VMATH_AVX2, VMATH_AVX2_F64)
+    VMATH_LOOPS(avx2, VMATH_AVX2, f64, Float64, VMATH_AVX2_F64)
+    VMATH_KERNELS_F32(avx2, VMATH_AVX2, VMATH_AVX2_F32)
+    VMATH_LOOPS(avx2, VMATH_AVX2, f32, Float32, VMATH_AVX2_F32)
+
+    VMATH_KERNELS_F64(avx512, VMATH_AVX512, VMATH_AVX512_F64)
+    VMATH_LOOPS(avx512, VMATH_AVX512, f64, Float64, VMATH_AVX512_F64)
+    VMATH_KERNELS_F32(avx512, VMATH_AVX512, VMATH_AVX512_F32)
+    VMATH_LOOPS(avx512, VMATH_AVX512, f32, Float32, VMATH_AVX512_F32)
+#endif // VMATH_HAVE_X86
+
+// The kernels to use: the tensor kernels' (see `tensor_isa()`), except that the AVX2 ones also need FMA
+static TensorIsa vmath_isa() {
+    TensorIsa isa = tensor_isa();
+    if(isa == TensorIsaAVX2 && !cpu_has_feature(CpuFeatureFMA))
+        return TensorIsaScalar;
+    return isa;
+}
+
+void vmath_f32(TensorMath fn, Float32* dst, const Float32* a, const Float32* b, UInt64 n) {
+#if defined(VMATH_HAVE_X86)
+    switch(vmath_isa()) {
+        case TensorIsaAVX512: vmath_f32_avx512(fn, dst, a, b, n); return;
+        case TensorIsaAVX2: vmath_f32_avx2(fn, dst, a, b, n); return;
+        default: break;
+    }
+#endif // VMATH_HAVE_X86
+    vmath_f32_scalar(fn, dst, a, b, n);
+}
+
+void vmath_f64(TensorMath fn, Float64* dst, const Float64* a, const Float64* b, UInt64 n) {
+#if defined(VMATH_HAVE_X86)
+    switch(vmath_isa()) {
+        case TensorIsaAVX512: vmath_f64_avx512(fn, dst, a, b, n); return;
+        case TensorIsaAVX2: vmath_f64_avx2(fn, dst, a, b, n); return;
+        default: break;
+    }
+#endif // VMATH_HAVE_X86
+    vmath_f64_scalar(fn, dst, a, b, n);
+}
+
+bool tensor_math(Tensor* dst, Tensor* a, Tensor* b, TensorMath fn) {
+    if(fn != TensorMathPow && fn != TensorMathAtan2)
+        b = a;
+    CORETEN_ENFORCE(dst->dtype == a->dtype && a->dtype == b->dtype, "Tensor types don't match");
+    CORETEN_ENFORCE(dst->len == a->len && a->len == b->len, "Tensor lengths don't match");
+    if(!tensor_dtype_is_float(a->dtype))
+        return false;
+    bool is_f64 = a->dtype == TensorDTypeFloat64;
+    if(dst->stride == 1 && a->stride == 1 && b->stride == 1) {
+        if(is_f64)
+            vmath_f64(fn, cast(Float64*)dst->data, cast(Float64*)a->data, cast(Float64*)b->data, a->len);
+        else
+            vmath_f32(fn, cast(Float32*)dst->data, cast(Float32*)a->data, cast(Float32*)b->data, a->len);
+        return true;
+    }
+    // Slices with a step: one element at a time (through the same kernels)
+    for(UInt64 i = 0; i < a->len; i++) {
+        TensorScalar x = tensor_get(a, i);
+        TensorScalar y = tensor_get(b, i);
+        if(is_f64) {
+            vmath_f64(fn, &x.f, &x.f, &y.f, 1);
+        } else {
+            Float32 xf = cast(Float32)x.f;
+            Float32 yf = cast(Float32)y.f;
+            vmath_f32(fn, &xf, &xf, &yf, 1);
+            x.f = xf;
+        }
+        tensor_set(dst, i, x);
+    }
+    return true;
+}
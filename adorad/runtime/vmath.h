@@ -0,0 +1,70 @@
+/*
+          _____   ____  _____            _____
+    /\   |  __ \ / __ \|  __ \     /\   |  __ \
+   /  \  | |  | | |  | | |__) |   /  \  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\ \ | |  | | |  | |  _  /   / /\ \ | |  | | Languages: C, C++, and Assembly
+ / ____ \| |__| | |__| | | \ \  / ____ \| |__| | https://github.com/adorad/adorad/
+/_/    \_\_____/ \____/|_|  \_\/_/    \_\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+
+#ifndef ADORAD_RUNTIME_VMATH_H
+#define ADORAD_RUNTIME_VMATH_H
+
+#include <adorad/core/types.h>
+#include <adorad/runtime/tensor.h>
+
+/*
+    Element-wise math on float tensors (`sin`, `exp`, `pow`...), several elements at a time.
+
+    Every function is written once, over the vector operations of an instruction set, and compiled for each of the
+    tensor kernels' (see `tensor_isa()`):
+        1. AVX-512 (F): 16 Float32s / 8 Float64s at a time
+        2. AVX2 + FMA:   8 Float32s / 4 Float64s at a time
+        3. Scalar: one at a time, in plain C (everywhere else)
+    They reduce the argument to a short interval (Cody-Waite, with `pi/2` and `ln(2)` split in several parts), then
+    evaluate a polynomial on it (the coefficients are fdlibm's and Cephes'), without tables or branches. Float32s are
+    computed in Float32 arithmetic, except for `pow`, which is computed in Float64 (like a Float64 `pow`, rounded).
+    Float64 `pow` computes `y * log2(x)` in double-double arithmetic (twice the precision of a Float64), so that its
+    error doesn't grow with the size of the result's exponent.
+
+    The error of every function, in ULPs (units in the last place of the exact result), for every instruction set:
+                    Float32     Float64     Arguments
+        sin, cos    2           2           `|x| <= 4096` (Float32), `|x| <= 2^20` (Float64)
+        tan         4           3           same
+        exp         1           1           any
+        log, log2   1           1           any
+        pow         1           2           any
+        atan2       3           2           any
+    (measured against libm in `test/runtime/test_vmath.c`). Arguments of `sin`, `cos` and `tan` out of those ranges (and
+    the few that are so close to a multiple of `pi/2` that the reduction loses too many bits) go to libm instead,
+    a vector at a time. Special values (NaNs, infinities, zeroes, negative arguments of `log`, `pow` of negative
+    numbers...) give the same results as C's <math.h>. Kernels can round differently in the last bit (only the vector
+    ones use FMA), within those bounds.
+*/
+
+typedef enum TensorMath {
+    TensorMathSin,
+    TensorMathCos,
+    TensorMathTan,
+    TensorMathExp,
+    TensorMathLog,
+    TensorMathLog2,
+    // `pow(a, b)` and `atan2(a, b)` (`a` is `y`) take two arguments
+    TensorMathPow,
+    TensorMathAtan2,
+} TensorMath;
+
+// `dst[i] = fn(a[i])` (or `fn(a[i], b[i])`) for `n` contiguous elements. `dst` can be `a` or `b`.
+void vmath_f32(TensorMath fn, Float32* dst, const Float32* a, const Float32* b, UInt64 n);
+void vmath_f64(TensorMath fn, Float64* dst, const Float64* a, const Float64* b, UInt64 n);
+
+// `dst = fn(a)` (or `fn(a, b)`), element-wise. `dst` can be `a` or `b`, and `b` is ignored (and can be null) unless `fn`
+// takes two arguments. Returns false if the tensors aren't floats.
+bool tensor_math(Tensor* dst, Tensor* a, Tensor* b, TensorMath fn);
+
+#endif // ADORAD_RUNTIME_VMATH_H
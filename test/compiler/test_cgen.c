@@ -0,0 +1,255 @@
+#include <AdoradInternalTests/AdoradInternalTests.h>
+#include <tau/tau.h>
+TAU_MAIN()
+
+static Parser* parse(char* source) {
+    Lexer* lexer = lexer_init(source, "test.ad");
+    lexer_lex(lexer);
+    Parser* parser = parser_init(lexer);
+    parser_parse(parser);
+    return parser;
+}
+
+// Does `code` contain `expected`? `expected` spells the C backend's prefix `adorad_`, but the compiler the tests are
+// built against may use another one (see `CGEN_PREFIX`).
+static bool contains(const char* code, const char* expected) {
+    StrBuilder* want = strbuilder_new(0);
+    while(*expected != nullchar) {
+        if(strncmp(expected, "adorad_", 7) == 0) {
+            strbuilder_append_cstr(want, CGEN_PREFIX);
+            expected += 7;
+        } else {
+            strbuilder_append_char(want, *expected++);
+        }
+    }
+    bool found = strstr(code, want->data) != null;
+    strbuilder_free(want);
+    return found;
+}
+
+static char* source =
+    "put mutable counter: Int = 0\n"
+    "put limit: Int64 = base * 2\n"
+    "put base: Int64 = 10\n"
+    "func add(a: Int, b: Int) -> Int {\n"
+    "    put c = a + b * 2\n"
+    "    if c > 10 { return c } else { counter += 1 }\n"
+    "    return add(c, 1)\n"
+    "}\n"
+    "func classify(x: Int) -> Int {\n"
+    "    put mutable r = 0\n"
+    "    match x {\n"
+    "        when 0..3 => { r = 1 }\n"
+    "        when 5 => { r = 2 }\n"
+    "    }\n"
+    "    put mutable maybe: ?Int\n"
+    "    maybe = 4\n"
+    "    put int = 3\n"
+    "    if true { put x = x + int\n r += x }\n"
+    "    return r\n"
+    "}\n"
+    "func main() -> Int { return classify(1) + add(1, 2) }\n";
+
+TEST(CGen, Generate) {
+    Parser* parser = parse(source);
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+
+    CGen* gen = cgen_new(2, 2);
+    REQUIRE_EQ(cgen_generate(gen, checker, "prog"), 0);
+    char* header = gen->header->data;
+    CHECK(contains(header, "typedef struct { adorad_Int value; adorad_Bool some; } adorad_Opt_Int;\n"));
+    CHECK(contains(header, "extern adorad_Int64 ad_limit;\n"));
+    CHECK(contains(header, "adorad_Int ad_add(adorad_Int, adorad_Int);\n"));
+
+    char* unit0 = (*cast(StrBuilder**)vec_at(gen->units, 0))->data;
+    char* unit1 = (*cast(StrBuilder**)vec_at(gen->units, 1))->data;
+    CHECK(strstr(unit0, "#include \"prog.h\"\n") != null);
+    CHECK(strstr(unit1, "#include \"prog.h\"\n") != null);
+    // Every declaration is in exactly one translation unit
+    bool main_in_unit0 = contains(unit0, "adorad_Int ad_main(void) {");
+    bool main_in_unit1 = contains(unit1, "adorad_Int ad_main(void) {");
+    CHECK(main_in_unit0 != main_in_unit1);
+
+    // Globals are initialized in dependency order
+    char* init_base = strstr(unit0, "    ad_base = ");
+    char* init_limit = strstr(unit0, "    ad_limit = ");
+    REQUIRE(init_base != null && init_limit != null);
+    CHECK(init_base < init_limit);
+    CHECK(contains(unit0, "int main(void) {\n    adorad_init();\n    return (int)ad_main();\n}\n"));
+
+    // `int` is a C keyword, and the inner `x` shadows the parameter
+    CHECK(contains(unit0, "adorad_Int int__") || contains(unit1, "adorad_Int int__"));
+    CHECK(contains(unit0, "adorad_Int x__") || contains(unit1, "adorad_Int x__"));
+
+    // Generating again gives the same output
+    StrBuilder* first = strbuilder_new(0);
+    strbuilder_append_n(first, unit0, strlen(unit0));
+    REQUIRE_EQ(cgen_generate(gen, checker, "prog"), 0);
+    CHECK_STREQ((*cast(StrBuilder**)vec_at(gen->units, 0))->data, first->data);
+    strbuilder_free(first);
+
+    cgen_free(gen);
+    checker_free(checker);
+    parser_free(parser);
+}
+
+TEST(CGen, Write) {
+    Parser* parser = parse(source);
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+
+    CGen* gen = cgen_new(2, 3);
+    REQUIRE_EQ(cgen_generate(gen, checker, "test_cgen_out"), 0);
+    REQUIRE(cgen_write(gen, ""));
+
+    static const char* files[] = { "test_cgen_out.h", "test_cgen_out_0.c", "test_cgen_out_1.c", "test_cgen_out_2.c" };
+    for(UInt64 i = 0; i < 4; i++) {
+        StrBuilder* expected = i == 0 ? gen->header : *cast(StrBuilder**)vec_at(gen->units, i - 1);
+        char* contents = read_file(files[i]);
+        CHECK_STREQ(contents, expected->data);
+        free(contents);
+        remove(files[i]);
+    }
+
+    cgen_free(gen);
+    checker_free(checker);
+    parser_free(parser);
+}
+
+TEST(CGen, Unsupported) {
+    Parser* parser = parse("func f(t: TensorFloat32) { }\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+
+    CGen* gen = cgen_new(1, 1);
+    REQUIRE_EQ(cgen_generate(gen, checker, "prog"), 1);
+    CheckerDiagnostic* diag = cast(CheckerDiagnostic*)vec_at(gen->diagnostics, 0);
+    CHECK_STREQ(diag->msg, "The C backend doesn't support values of type `TensorFloat32` yet");
+
+    cgen_free(gen);
+    checker_free(checker);
+    parser_free(parser);
+}
+
+TEST(CGen, Loops) {
+    Parser* parser = parse(
+        "func f(n: Int) -> Int {\n"
+        "    put mutable s = 0\n"
+        "    loop i in 0..n { s += i }\n"
+        "    loop j = 0; j < 10; j += 1 { if j == 3 { continue } s += j }\n"
+        "    outer: loop { loop k in 1..3 { if k == 2 { continue :outer } break :outer } }\n"
+        "    return s\n"
+        "}\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+
+    CGen* gen = cgen_new(1, 1);
+    REQUIRE_EQ(cgen_generate(gen, checker, "prog"), 0);
+    char* unit = (*cast(StrBuilder**)vec_at(gen->units, 0))->data;
+    // The end of a range is only evaluated once
+    CHECK(contains(unit, "for(adorad_Int i = ((adorad_Int)0), adorad_tmp1 = n; i < adorad_tmp1; i++) {\n"));
+    CHECK(contains(unit, "for(; (j < ((adorad_Int)10)); (j = ((adorad_Int)((uint64_t)j + (uint64_t)((adorad_Int)1))))) {\n"));
+    // Labeled `break`/`continue` jump past the end of the loop/its body
+    CHECK(contains(unit, "goto adorad_continue2;\n"));
+    CHECK(contains(unit, "goto adorad_break2;\n"));
+    CHECK(contains(unit, "adorad_continue2: ;\n        }\n        adorad_break2: ;\n"));
+
+    cgen_free(gen);
+    checker_free(checker);
+    parser_free(parser);
+}
+
+// Integer arithmetic wraps around in the generated C like it does in the VM (and without relying on undefined
+// behavior, which `-O2` would exploit)
+static char* arith_source =
+    "func avg(a: Byte, b: Byte) -> Byte { return (a + b) / 2 }\n"
+    "func half(a: Int8) -> Int8 { return (a * 2) / 2 }\n"
+    "func wraps(x: Int) -> Bool { return x + 1 < x }\n"
+    "func neg(x: Int8) -> Int8 { return -x }\n"
+    "func shl(x: Int16, n: Int16) -> Int16 { return x << n }\n"
+    "func shr(x: Int16, n: Int16) -> Int16 { return x >> n }\n"
+    "func shru(x: UInt32, n: UInt32) -> UInt32 { return x >> n }\n"
+    "func mix(a: UInt16, b: UInt16) -> UInt16 { return a * b + (a - b) }\n"
+    "func acc(x: Int8) -> Int8 { put mutable y = x\n y += 100\n y *= 3\n return y }\n"
+    "func div(a: Int, b: Int) -> Int { return a / b + a % b }\n"
+    "func mod(a: Int64, b: Int64) -> Int64 { return a % b }\n"
+    "func big(a: Int64) -> Int64 { return a * a + 1 }\n";
+
+TEST(CGen, Arithmetic) {
+    static const struct { const char* func; Int64 args[2]; UInt64 num_args; } calls[] = {
+        { "avg", { 200, 100 }, 2 },
+        { "half", { 100 }, 1 },
+        { "wraps", { 2147483647 }, 1 },
+        { "wraps", { 5 }, 1 },
+        { "neg", { -128 }, 1 },
+        { "shl", { 300, 8 }, 2 },
+        { "shr", { -100, 3 }, 2 },
+        { "shru", { 4000000000, 4 }, 2 },
+        { "mix", { 65535, 65535 }, 2 },
+        { "mix", { 3, 500 }, 2 },
+        { "acc", { 100 }, 1 },
+        { "div", { -2147483647 - 1, -1 }, 2 },
+        { "div", { -7, 2 }, 2 },
+        { "mod", { -7, 2 }, 2 },
+        { "big", { 3037000500 }, 1 },
+    };
+    UInt64 num_calls = sizeof(calls) / sizeof(calls[0]);
+
+    Parser* parser = parse(arith_source);
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+
+    // What the VM gets
+    IrModule* module = ir_lower(checker);
+    Vm* vm = vm_new();
+    REQUIRE_EQ(vm_load(vm, module), 0);
+    StrBuilder* expected = strbuilder_new(0);
+    for(UInt64 i = 0; i < num_calls; i++) {
+        VmValue args[2] = {0};
+        args[0].i = calls[i].args[0];
+        args[1].i = calls[i].args[1];
+        REQUIRE(vm_call(vm, vm_func(vm, calls[i].func), args, args));
+        strbuilder_appendf(expected, "%" CORETEN_PRId64 "\n", args[0].i);
+    }
+    CHECK_STREQ(expected->data, "22\n-28\n1\n0\n-128\n11264\n-13\n250000000\n1\n1003\n88\n-2147483648\n-4\n-1\n"
+                                "-9223372036709301615\n");
+
+    CGen* gen = cgen_new(1, 1);
+    REQUIRE_EQ(cgen_generate(gen, checker, "test_cgen_arith"), 0);
+    REQUIRE(cgen_write(gen, ""));
+    // The driver includes the generated unit instead of being linked with it: the compiler the tests are built against
+    // drops `static` from the prelude (see `before_tests_ci.py`), so its helpers would be defined twice
+    FILE* driver = fopen("test_cgen_arith_main.c", "w");
+    REQUIRE(driver != null);
+    fputs("#include <stdio.h>\n#include \"test_cgen_arith_0.c\"\nint main(void) {\n", driver);
+    for(UInt64 i = 0; i < num_calls; i++) {
+        fprintf(driver, "    printf(\"%%lld\\n\", (long long)ad_%s(%" CORETEN_PRId64 "LL", calls[i].func, calls[i].args[0]);
+        if(calls[i].num_args > 1)
+            fprintf(driver, ", %" CORETEN_PRId64 "LL", calls[i].args[1]);
+        fputs("));\n", driver);
+    }
+    fputs("    return 0;\n}\n", driver);
+    fclose(driver);
+
+    // What the C compiler gets (if there is one)
+    if(system("cc --version > /dev/null 2>&1") == 0) {
+        REQUIRE_EQ(system("cc -O2 -o test_cgen_arith.out test_cgen_arith_main.c"), 0);
+        REQUIRE_EQ(system("./test_cgen_arith.out > test_cgen_arith.txt"), 0);
+        char* output = read_file("test_cgen_arith.txt");
+        CHECK_STREQ(output, expected->data);
+        free(output);
+        remove("test_cgen_arith.out");
+        remove("test_cgen_arith.txt");
+    }
+    static const char* files[] = { "test_cgen_arith.h", "test_cgen_arith_0.c", "test_cgen_arith_main.c" };
+    for(UInt64 i = 0; i < 3; i++)
+        remove(files[i]);
+
+    strbuilder_free(expected);
+    cgen_free(gen);
+    vm_free(vm);
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+}
@@ -0,0 +1,373 @@
+#include <AdoradInternalTests/AdoradInternalTests.h>
+#include <tau/tau.h>
+TAU_MAIN()
+
+static Parser* parse(char* source) {
+    Lexer* lexer = lexer_init(source, "test.ad");
+    lexer_lex(lexer);
+    Parser* parser = parser_init(lexer);
+    parser_parse(parser);
+    return parser;
+}
+
+static char* source_ok =
+    "put mutable counter: Int = 0\n"
+    "put limit: Int64 = base * 2\n"
+    "put base: Int64 = 10\n"
+    "func add(a: Int, b: Int) -> Int {\n"
+    "    put c = a + b * 2\n"
+    "    if c > 10 && !false { return c } else if c < 0 { return -c } else { counter += 1 }\n"
+    "    return add(c, 1)\n"
+    "}\n"
+    "func main() { add(1, 2); }\n";
+
+static char* source_bad =
+    "put x = y\n"
+    "put y = x\n"
+    "func f(a: Int) -> Int { a = 2\n put s: String = 3\n return zz }\n"
+    "func g() -> Int { if true { return 1 } }\n"
+    "func f() { f(1, 2) }\n";
+
+TEST(Checker, Valid) {
+    Parser* parser = parse(source_ok);
+    Checker* checker = checker_new(1);
+    CHECK_EQ(checker_check(checker, &parser, 1), 0);
+
+    char buf[64];
+    Symbol* add = checker_lookup(checker, "add", 3);
+    REQUIRE(add != null);
+    type_to_str(add->type, buf, sizeof(buf));
+    CHECK_STREQ(buf, "func(Int, Int) -> Int");
+
+    Symbol* limit = checker_lookup(checker, "limit", 5);
+    REQUIRE(limit != null);
+    CHECK_EQ(limit->type->kind, AdoradTypeInt64);
+    CHECK(checker_lookup(checker, "nope", 4) == null);
+
+    checker_free(checker);
+    parser_free(parser);
+}
+
+TEST(Checker, Diagnostics) {
+    Parser* parser = parse(source_bad);
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 7);
+
+    static const char* expected[] = {
+        "The initializer of `x` depends on itself",
+        "Cannot assign to `a`, which isn't `mutable`",
+        "Cannot use a value of type `Int` as `String`",
+        "Undeclared identifier `zz`",
+        "Function `g` doesn't return a value on every path",
+        "Redefinition of `f`",
+        "Expected 1 argument; got 2",
+    };
+    for(UInt64 i = 0; i < 7; i++) {
+        CheckerDiagnostic* diag = cast(CheckerDiagnostic*)vec_at(checker->diagnostics, i);
+        CHECK_STREQ(diag->msg, expected[i]);
+    }
+
+    checker_free(checker);
+    parser_free(parser);
+}
+
+// Diagnostics must not depend on the number of threads
+TEST(Checker, Deterministic) {
+    Parser* parser = parse(source_bad);
+    Checker* serial = checker_new(1);
+    Checker* parallel = checker_new(8);
+    UInt64 num_errors = checker_check(serial, &parser, 1);
+    REQUIRE_EQ(checker_check(parallel, &parser, 1), num_errors);
+
+    for(UInt64 i = 0; i < num_errors; i++) {
+        CheckerDiagnostic* a = cast(CheckerDiagnostic*)vec_at(serial->diagnostics, i);
+        CheckerDiagnostic* b = cast(CheckerDiagnostic*)vec_at(parallel->diagnostics, i);
+        CHECK_STREQ(a->msg, b->msg);
+        CHECK_EQ(a->line, b->line);
+        CHECK_EQ(a->col, b->col);
+    }
+
+    checker_free(serial);
+    checker_free(parallel);
+    parser_free(parser);
+}
+
+TEST(Checker, TypeInterning) {
+    Type* int_type = type_primitive(AdoradTypeInt);
+    CHECK_EQ(int_type->id, AdoradTypeInt + 1);
+    CHECK(type_get(int_type->id) == int_type);
+
+    // Structurally identical types are the same `Type`
+    Type* ptr = type_pointer_to(type_slice_of(int_type));
+    CHECK(type_pointer_to(type_slice_of(int_type)) == ptr);
+    CHECK(type_get(ptr->id) == ptr);
+    CHECK(type_array_of(int_type, 4) == type_array_of(int_type, 4));
+    CHECK(type_array_of(int_type, 4) != type_array_of(int_type, 5));
+    CHECK(type_optional_of(type_optional_of(int_type)) == type_optional_of(int_type));
+    CHECK(type_struct("Point", 5) == type_struct("Point", 5));
+    CHECK(type_tensor_of(type_primitive(AdoradTypeFloat32), 2) != type_tensor_of(type_primitive(AdoradTypeFloat32), 3));
+
+    Type* params[2] = {int_type, ptr};
+    Type* func = type_func(params, 2, false, int_type);
+    CHECK(type_func(params, 2, false, int_type) == func);
+    CHECK(type_func(params, 2, true, int_type) != func);
+    CHECK(type_func(params, 1, false, int_type) != func);
+
+    char buf[64];
+    type_to_str(func, buf, sizeof(buf));
+    CHECK_STREQ(buf, "func(Int, &Int[]) -> Int");
+    type_to_str(type_array_of(type_primitive(AdoradTypeByte), 16), buf, sizeof(buf));
+    CHECK_STREQ(buf, "Byte[16]");
+
+    CHECK(type_is_assignable(type_slice_of(int_type), type_array_of(int_type, 4)));
+    CHECK_FALSE(type_is_assignable(type_array_of(int_type, 4), type_slice_of(int_type)));
+
+    // Many distinct types, to make the interner grow
+    UInt32 count = type_count();
+    for(UInt64 i = 0; i < 5000; i++)
+        type_array_of(int_type, 1000 + i);
+    CHECK_EQ(type_count(), count + 5000);
+    for(UInt64 i = 0; i < 5000; i++)
+        CHECK_EQ(type_array_of(int_type, 1000 + i)->len, 1000 + i);
+    CHECK_EQ(type_count(), count + 5000);
+}
+
+TEST(Checker, ArrayTypes) {
+    Parser* parser = parse(
+        "func sum(values: Int[], extra: Int[4]) -> Int { return 0 }\n"
+        "func bad(a: Int[x]) { }\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 1);
+    CheckerDiagnostic* diag = cast(CheckerDiagnostic*)vec_at(checker->diagnostics, 0);
+    CHECK_STREQ(diag->msg, "The length of an array must be an integer literal");
+
+    char buf[64];
+    type_to_str(checker_lookup(checker, "sum", 3)->type, buf, sizeof(buf));
+    CHECK_STREQ(buf, "func(Int[], Int[4]) -> Int");
+
+    checker_free(checker);
+    parser_free(parser);
+}
+
+TEST(Checker, Loops) {
+    Parser* parser = parse(
+        "func sum(n: Int) -> Int {\n"
+        "    put mutable s = 0\n"
+        "    loop i in 0..n { s += i }\n"
+        "    loop j = 0; j < 10; j += 1 { if j == 3 { continue } s += j }\n"
+        "    outer: loop { loop { break :outer } }\n"
+        "    loop { if s > 5 { return s } s += 1 }\n"
+        "}\n"
+        "func bad(n: Int) -> Int {\n"
+        "    loop n { }\n"
+        "    loop i in n { }\n"
+        "    loop x in 1.5..2 { }\n"
+        "    loop { continue :nope }\n"
+        "    loop { break 1 }\n"
+        "    break\n"
+        "}\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 6);
+
+    // `loop { continue :nope }` never ends, so `bad` doesn't need a `return`
+    static const char* expected[] = {
+        "The condition of a `loop` must be a `Bool`; got `Int`",
+        "Only ranges can be iterated over yet",
+        "A range must be of integers; got `Float32`",
+        "There's no loop labeled `nope` to `continue`",
+        "Loops don't have a value, so `break` can't have one",
+        "`break` outside of a loop",
+    };
+    for(UInt64 i = 0; i < 6; i++) {
+        CheckerDiagnostic* diag = cast(CheckerDiagnostic*)vec_at(checker->diagnostics, i);
+        CHECK_STREQ(diag->msg, expected[i]);
+    }
+
+    checker_free(checker);
+    parser_free(parser);
+}
+
+TEST(Checker, TensorMethods) {
+    Parser* parser = parse(
+        "func ok(xs: TensorInt32) -> Int64 { return xs.filter(it > 0).map(it * 2).count() }\n"
+        "func scaled(xs: TensorFloat64) -> TensorFloat64 { return xs.map(it * 2.5) }\n"
+        "func bad(xs: TensorInt32, n: Int) -> Int {\n"
+        "    put a = n.sum()\n"
+        "    put b = xs.reverse()\n"
+        "    put c = xs.filter(it)\n"
+        "    put d = xs.map(it == 1)\n"
+        "    put e = xs.sum(1)\n"
+        "    return it\n"
+        "}\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 6);
+
+    static const char* expected[] = {
+        "Values of type `Int` don't have methods",
+        "Tensors don't have a method `reverse`",
+        "The condition of a `filter` must be a `Bool`; got `Int`",
+        "A tensor can't hold values of type `Bool`",
+        "Expected no arguments; got 1",
+        "Undeclared identifier `it`",
+    };
+    for(UInt64 i = 0; i < 6; i++) {
+        CheckerDiagnostic* diag = cast(CheckerDiagnostic*)vec_at(checker->diagnostics, i);
+        CHECK_STREQ(diag->msg, expected[i]);
+    }
+
+    checker_free(checker);
+    parser_free(parser);
+}
+
+TEST(Checker, Indexing) {
+    Parser* parser = parse(
+        "func ok(t: Tensor<Int, 2>, xs: TensorInt32, n: Int) -> Int { t[1][n] += xs[0] + t[0][0]\n return t[n][1] }\n"
+        "func elems(t: Tensor<Bool, 2>, u: Tensor<Int, 5>) {}\n"
+        "func bad(t: Tensor<Int, 2>, xs: TensorInt32, n: Int) -> Int {\n"
+        "    put a = t[0]\n"
+        "    put b = n[0]\n"
+        "    put c = xs[0][1]\n"
+        "    put d = t[0][1.5]\n"
+        "    t[0][0] = true\n"
+        "    return 0\n"
+        "}\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 7);
+
+    static const char* expected[] = {
+        "A tensor can't hold values of type `Bool`",
+        "A tensor has 1 to 4 dimensions",
+        "A `Tensor<Int, 2>` takes 2 indices; got 1",
+        "Values of type `Int` can't be indexed",
+        "A `TensorInt32` takes 1 index; got 2",
+        "Cannot use a value of type `Float32` as `Int64`",
+        "Cannot use a value of type `Bool` as `Int`",
+    };
+    for(UInt64 i = 0; i < 7; i++) {
+        CheckerDiagnostic* diag = cast(CheckerDiagnostic*)vec_at(checker->diagnostics, i);
+        CHECK_STREQ(diag->msg, expected[i]);
+    }
+
+    checker_free(checker);
+    parser_free(parser);
+}
+
+TEST(Checker, Slices) {
+    Parser* parser = parse(
+        "func ok(xs: TensorInt32, n: Int) -> TensorInt32 { put a = xs[1..n]\n put b = xs[..2]\n return xs[n..:2] }\n"
+        "func copy(t: Tensor<Float64, 2>) -> Tensor<Float64, 2> { return t.clone() }\n"
+        "func bad(t: Tensor<Int, 2>, xs: TensorInt32, n: Int) -> Int {\n"
+        "    put a = t[0..1]\n"
+        "    put b = n[0..1]\n"
+        "    put c = xs[0..1.5]\n"
+        "    put d = xs.clone(1)\n"
+        "    return 0\n"
+        "}\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 4);
+
+    static const char* expected[] = {
+        "Only tensors of one dimension can be sliced; got a `Tensor<Int, 2>`",
+        "Values of type `Int` can't be sliced",
+        "Cannot use a value of type `Float32` as `Int64`",
+        "Expected no arguments; got 1",
+    };
+    for(UInt64 i = 0; i < 4; i++) {
+        CheckerDiagnostic* diag = cast(CheckerDiagnostic*)vec_at(checker->diagnostics, i);
+        CHECK_STREQ(diag->msg, expected[i]);
+    }
+
+    checker_free(checker);
+    parser_free(parser);
+}
+
+TEST(Checker, Sort) {
+    Parser* parser = parse(
+        "func key(x: Int) -> Byte;\n"
+        "func ok(xs: TensorInt32, fs: TensorFloat64) {\n"
+        "    xs.sort()\n xs.sort(a > b)\n xs.sort(a % 10 < b % 10)\n fs.sort(-b <= -a)\n xs.sort((a * a) >= (b * b))\n"
+        "}\n"
+        "func bad(xs: TensorInt32) {\n"
+        "    xs.sort(a < a)\n"
+        "    xs.sort(a - b < b - a)\n"
+        "    xs.sort(a == b)\n"
+        "    xs.sort(a)\n"
+        "    xs.sort(key(a) < key(b))\n"
+        "    xs.sort(a < b, 1)\n"
+        "}\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 6);
+
+    static const char* expected[] = {
+        "The condition of a `sort` must compare the same expression of `a` and `b` (like `a % 10 < b % 10`)",
+        "The condition of a `sort` must compare the same expression of `a` and `b` (like `a % 10 < b % 10`)",
+        "The condition of a `sort` must compare the same expression of `a` and `b` (like `a % 10 < b % 10`)",
+        "The condition of a `sort` must be a `Bool`; got `Int`",
+        "Can't sort by values of type `Byte`",
+        "Expected at most 1 argument; got 2",
+    };
+    for(UInt64 i = 0; i < 6; i++) {
+        CheckerDiagnostic* diag = cast(CheckerDiagnostic*)vec_at(checker->diagnostics, i);
+        CHECK_STREQ(diag->msg, expected[i]);
+    }
+
+    checker_free(checker);
+    parser_free(parser);
+}
+
+TEST(Checker, FormatStrings) {
+    Parser* parser = parse(
+        "func ok(s: String, x: Float32, n: UInt8) -> String { return f\"{s:-8} {x:.3e} {n:08b} {{}}\" }\n"
+        "func bad(xs: TensorInt32, x: Float64, n: Int) -> String {\n"
+        "    put a = f\"{xs}\"\n"
+        "    put b = f\"{x:q}\"\n"
+        "    return f\"{n:.2f} {x:x}\"\n"
+        "}\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 4);
+
+    static const char* expected[] = {
+        "Values of type `TensorInt32` can't be formatted",
+        "Invalid format spec `q`",
+        "The format spec `.2f` can't be used for values of type `Int`",
+        "The format spec `x` can't be used for values of type `Float64`",
+    };
+    for(UInt64 i = 0; i < 4; i++) {
+        CheckerDiagnostic* diag = cast(CheckerDiagnostic*)vec_at(checker->diagnostics, i);
+        CHECK_STREQ(diag->msg, expected[i]);
+    }
+
+    checker_free(checker);
+    parser_free(parser);
+}
+
+TEST(Checker, IntLiterals) {
+    Parser* parser = parse(
+        "put a: Int8 = -128\n"
+        "put b: Byte = 255\n"
+        "put c: Int64 = -9223372036854775808\n"
+        "put d: UInt64 = 0xFFFF_FFFF_FFFF_FFFF\n"
+        "put e: Float32 = 4000000000\n"
+        "put x: Int8 = 300\n"
+        "put y: Int64 = 99999999999999999999999\n"
+        "put z = 4000000000\n"
+        "put w: Int8 = -129\n"
+        "func f(n: UInt16) -> UInt16 { return n + 65536 }\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 5);
+
+    static const char* expected[] = {
+        "The integer literal `300` doesn't fit in `Int8`",
+        "The integer literal `99999999999999999999999` doesn't fit in `Int64`",
+        "The integer literal `4000000000` doesn't fit in `Int`",
+        "The integer literal `-129` doesn't fit in `Int8`",
+        "The integer literal `65536` doesn't fit in `UInt16`",
+    };
+    for(UInt64 i = 0; i < 5; i++) {
+        CheckerDiagnostic* diag = cast(CheckerDiagnostic*)vec_at(checker->diagnostics, i);
+        CHECK_STREQ(diag->msg, expected[i]);
+    }
+
+    checker_free(checker);
+    parser_free(parser);
+}
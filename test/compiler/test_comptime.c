@@ -0,0 +1,175 @@
+#include <AdoradInternalTests/AdoradInternalTests.h>
+#include <tau/tau.h>
+TAU_MAIN()
+
+static Parser* parse(char* source) {
+    Lexer* lexer = lexer_init(source, "test.ad");
+    lexer_lex(lexer);
+    Parser* parser = parser_init(lexer);
+    parser_parse(parser);
+    return parser;
+}
+
+// Does `code` contain `expected`? `expected` spells the C backend's prefix `adorad_`, but the compiler the tests are
+// built against may use another one (see `CGEN_PREFIX`).
+static bool contains(const char* code, const char* expected) {
+    StrBuilder* want = strbuilder_new(0);
+    while(*expected != nullchar) {
+        if(strncmp(expected, "adorad_", 7) == 0) {
+            strbuilder_append_cstr(want, CGEN_PREFIX);
+            expected += 7;
+        } else {
+            strbuilder_append_char(want, *expected++);
+        }
+    }
+    bool found = strstr(code, want->data) != null;
+    strbuilder_free(want);
+    return found;
+}
+
+static char* dump_of(IrModule* module, UInt64 index) {
+    StrBuilder* out = strbuilder_new(0);
+    ir_dump_func(*cast(IrFunc**)vec_at(module->funcs, index), out);
+    char* dump = strdup(out->data);
+    strbuilder_free(out);
+    return dump;
+}
+
+static char* source =
+    "[comptime] func fib(n: Int64) -> Int64 { if n < 2 { return n } return fib(n - 1) + fib(n - 2) }\n"
+    "[comptime] func half(x: Float64) -> ?Float64 { return x / 2.0 }\n"
+    "func square(x: Int) -> Int { put mutable r = 0\n put p = &r\n r = x * x\n return r }\n"
+    "put name = \"ab\" + \"cd\"\n"
+    "[comptime] put big = fib(90)\n"
+    "[comptime] put greeting = name + \"!\"\n"
+    "[comptime] put maybe: ?Int = 3\n"
+    "func main(k: Int) -> Int64 {\n"
+    "    put x = fib(50)\n"
+    "    [comptime] put y = square(10) + 1\n"
+    "    put h = half(3.0)\n"
+    "    return x + y + k + big\n"
+    "}\n";
+
+TEST(Comptime, Evaluate) {
+    Parser* parser = parse(source);
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+    IrModule* module = ir_lower(checker);
+    Comptime* ct = comptime_new(module);
+    CHECK_EQ(comptime_module(ct), 0);
+    // Every call to `fib` with the same argument is only evaluated once: fib(90) needs 91 of them
+    CHECK_EQ(ct->memo_misses, 91 + 1 + 1);
+    CHECK(ct->memo_hits >= 89);
+
+    // `[comptime]` globals are their values, and so is every read of them
+    char* dump = dump_of(module, 4);
+    CHECK_STREQ(dump,
+        "global @big: Int64 {\n"
+        "b0:\n"
+        "    %0: Int64 = const 2880067194370816120\n"
+        "    return %0\n"
+        "}\n");
+    free(dump);
+    dump = dump_of(module, 5);
+    CHECK(strstr(dump, "    %0: String = const \"abcd!\"\n") != null);
+    free(dump);
+    CHECK_EQ(comptime_global(ct, 6)->imm, 3);
+    CHECK(!comptime_global(ct, 6)->is_null);
+    // `name` isn't `[comptime]`, even though its value had to be computed
+    CHECK(comptime_global(ct, 3) == null);
+
+    // Calls to `[comptime]` functions, and `[comptime]` locals, are constants (pointers to locals are fine)
+    opt_module(module, null);
+    dump = dump_of(module, 7);
+    CHECK(strstr(dump, "call") == null);
+    CHECK(strstr(dump, "load_global") == null);
+    CHECK(strstr(dump, "const 12586269126\n") != null);
+    CHECK(strstr(dump, "const 2880067194370816120\n") != null);
+    for(UInt64 i = 0; i < vec_size(module->funcs); i++)
+        CHECK(ir_verify(*cast(IrFunc**)vec_at(module->funcs, i)) == null);
+    free(dump);
+
+    comptime_free(ct);
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+}
+
+TEST(Comptime, Errors) {
+    Parser* parser = parse(
+        "put mutable counter: Int\n"
+        "func ext(x: Int) -> Int;\n"
+        "[comptime] func spin() -> Int { put mutable i = 0\n loop { i += 1 } return i }\n"
+        "[comptime] func deep(n: Int) -> Int { return deep(n + 1) }\n"
+        "[comptime] func div(a: Int, b: Int) -> Int { return a / b }\n"
+        "[comptime] func count() -> Int { return counter }\n"
+        "[comptime] put mutable m = 1\n"
+        "[comptime] put a = spin()\n"
+        "[comptime] put b = deep(1)\n"
+        "[comptime] put c = div(1, 0)\n"
+        "[comptime] put d = count()\n"
+        "[comptime] put e = ext(1)\n"
+        "func main(k: Int) -> Int { return div(k, 2) }\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+    IrModule* module = ir_lower(checker);
+    Comptime* ct = comptime_new(module);
+    ct->max_steps = 10000;
+    ct->max_depth = 64;
+    REQUIRE_EQ(comptime_module(ct), 7);
+
+    const char* messages[] = {
+        "`[comptime]` variable `m` can't be `mutable`",
+        "Couldn't evaluate `a` at compile time: it takes more than 10000 steps",
+        "Couldn't evaluate `b` at compile time: calls are nested more than 64 deep",
+        "Couldn't evaluate `c` at compile time: division by zero in `div`",
+        "Couldn't evaluate `d` at compile time: `counter` is mutable, so its value is only known at run time",
+        "Couldn't evaluate `e` at compile time: `ext` doesn't have a body",
+        "Couldn't evaluate the call to `div` at compile time: it depends on a value that's only known at run time",
+    };
+    for(UInt64 i = 0; i < vec_size(ct->diagnostics); i++)
+        CHECK_STREQ((cast(CheckerDiagnostic*)vec_at(ct->diagnostics, i))->msg, messages[i]);
+    CHECK_EQ((cast(CheckerDiagnostic*)vec_at(ct->diagnostics, 6))->line, 14);
+
+    // The memory budget covers frames, stack slots and strings
+    ct->max_memory = 16;
+    ComptimeValue args[1] = {0};
+    args[0].imm = 1;
+    CHECK(!comptime_call(ct, *cast(IrFunc**)vec_at(module->funcs, 3), args, &args[0]));
+    CHECK(strstr(ct->error, "bytes of memory") != null);
+
+    comptime_free(ct);
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+}
+
+TEST(Comptime, CGen) {
+    Parser* parser = parse(source);
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+    IrModule* module = ir_lower(checker);
+    Comptime* ct = comptime_new(module);
+    REQUIRE_EQ(comptime_module(ct), 0);
+
+    CGen* gen = cgen_new(1, 1);
+    gen->comptime = ct;
+    REQUIRE_EQ(cgen_generate(gen, checker, "comptime"), 0);
+    char* unit = (*cast(StrBuilder**)vec_at(gen->units, 0))->data;
+    // `[comptime]` globals are initialized statically, everything else still is by `adorad_init()`
+    CHECK(contains(unit, "adorad_Int64 ad_big = ((adorad_Int64)2880067194370816120);\n"));
+    CHECK(contains(unit, "adorad_String ad_greeting = ADORAD_STR_INIT(\"abcd!\");\n"));
+    CHECK(contains(unit, "adorad_Opt_Int ad_maybe = { ((adorad_Int)3), true };\n"));
+    CHECK(strstr(unit, "    ad_name = ") != null);
+    CHECK(strstr(unit, "    ad_big = ") == null);
+    // So are the values of `[comptime]` calls and expressions
+    CHECK(contains(unit, "adorad_Int64 x = ((adorad_Int64)12586269025);\n"));
+    CHECK(!contains(unit, "adorad_Int y = (((adorad_Int)100) + ((adorad_Int)1));\n"));
+    CHECK(contains(unit, "((adorad_Opt_Float64){ ((adorad_Float64)1.5), true })"));
+
+    cgen_free(gen);
+    comptime_free(ct);
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+}
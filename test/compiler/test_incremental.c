@@ -0,0 +1,142 @@
+#include <AdoradInternalTests/AdoradInternalTests.h>
+#include <tau/tau.h>
+TAU_MAIN()
+
+#define DB_PATH     "test_incremental.adincdb"
+
+static UInt64 num_checked;
+static UInt64 num_skipped;
+
+// One "build" of `source`: open the database, check, and save it again. Returns the number of errors.
+static UInt64 build(char* source) {
+    Lexer* lexer = lexer_init(source, "test.ad");
+    lexer_lex(lexer);
+    Parser* parser = parser_init(lexer);
+    parser_parse(parser);
+
+    IncDb* db = incdb_open(DB_PATH);
+    Checker* checker = checker_new(1);
+    UInt64 num_errors = incdb_check(db, checker, parser);
+    CORETEN_ENFORCE(incdb_save(db));
+    num_checked = db->num_checked;
+    num_skipped = db->num_skipped;
+
+    incdb_free(db);
+    checker_free(checker);
+    parser_free(parser);
+    return num_errors;
+}
+
+static char* source =
+    "put base: Int = 10\n"
+    "func add(a: Int, b: Int) -> Int { return a + b }\n"
+    "func twice(a: Int) -> Int { return add(a, a) }\n"
+    "func main() { twice(base) }\n";
+
+TEST(Incremental, Rebuild) {
+    remove(DB_PATH);
+    CHECK_EQ(build(source), 0);
+    CHECK_EQ(num_checked, 4);
+    CHECK_EQ(num_skipped, 0);
+
+    // Nothing changed (whitespace doesn't count)
+    CHECK_EQ(build(source), 0);
+    CHECK_EQ(num_checked, 0);
+    CHECK_EQ(num_skipped, 4);
+    CHECK_EQ(build(
+        "put base: Int = 10\n"
+        "func add(a: Int, b: Int) -> Int {\n    return a + b\n}\n"
+        "func twice(a: Int) -> Int { return add(a, a) }\n"
+        "func main() { twice(base) }\n"), 0);
+    CHECK_EQ(num_checked, 0);
+
+    // Only the body of `add` changed
+    CHECK_EQ(build(
+        "put base: Int = 10\n"
+        "func add(a: Int, b: Int) -> Int { return b + a }\n"
+        "func twice(a: Int) -> Int { return add(a, a) }\n"
+        "func main() { twice(base) }\n"), 0);
+    CHECK_EQ(num_checked, 1);
+
+    // The signature of `add` changed: `twice` (which calls it) is checked again, and fails now
+    CHECK_EQ(build(
+        "put base: Int = 10\n"
+        "func add(a: Int) -> Int { return a }\n"
+        "func twice(a: Int) -> Int { return add(a, a) }\n"
+        "func main() { twice(base) }\n"), 1);
+    CHECK_EQ(num_checked, 2);
+
+    // Declarations with errors are always checked again
+    CHECK_EQ(build(
+        "put base: Int = 10\n"
+        "func add(a: Int) -> Int { return a }\n"
+        "func twice(a: Int) -> Int { return add(a, a) }\n"
+        "func main() { twice(base) }\n"), 1);
+    CHECK_EQ(num_checked, 1);
+
+    // `add` is back to two parameters, but `base` changed type, which breaks `main` (the only one using it)
+    CHECK_EQ(build(
+        "put base: Int64 = 10\n"
+        "func add(a: Int, b: Int) -> Int { return a + b }\n"
+        "func twice(a: Int) -> Int { return add(a, a) }\n"
+        "func main() { twice(base) }\n"), 1);
+    CHECK_EQ(num_checked, 4);
+    // `add` and `twice` are back to what they were the last time they were checked
+    CHECK_EQ(build(source), 0);
+    CHECK_EQ(num_checked, 2);
+    remove(DB_PATH);
+}
+
+TEST(Incremental, Graph) {
+    remove(DB_PATH);
+    for(int i = 0; i < 2; i++) {
+        ModuleGraph* graph = modgraph_new(4);
+        modgraph_add_search_path(graph, "test/compiler/modules/lib");
+        REQUIRE_EQ(modgraph_load(graph, "test/compiler/modules/main.ad"), 0);
+
+        IncDb* db = incdb_open(DB_PATH);
+        CHECK_EQ(incdb_check_graph(db, graph), 0);
+        CHECK_EQ(vec_size(db->modules), 5);
+        // Nothing changed the second time
+        if(i == 0)
+            CHECK(db->num_checked > 0);
+        else
+            CHECK_EQ(db->num_checked, 0);
+        REQUIRE(incdb_save(db));
+
+        incdb_free(db);
+        modgraph_free(graph);
+    }
+    remove(DB_PATH);
+}
+
+TEST(Incremental, Database) {
+    remove(DB_PATH);
+    CHECK_EQ(build(source), 0);
+
+    IncDb* db = incdb_open(DB_PATH);
+    REQUIRE_EQ(vec_size(db->modules), 1);
+    IncModule* module = *cast(IncModule**)vec_at(db->modules, 0);
+    CHECK_STREQ(module->path, "test.ad");
+    REQUIRE_EQ(vec_size(module->decls), 4);
+
+    // Sorted by name
+    IncDecl* add = cast(IncDecl*)vec_at(module->decls, 0);
+    IncDecl* twice = cast(IncDecl*)vec_at(module->decls, 3);
+    CHECK_STREQ(add->name, "add");
+    CHECK_EQ(vec_size(add->deps), 0);
+    CHECK_STREQ(twice->name, "twice");
+    REQUIRE_EQ(vec_size(twice->deps), 1);
+    CHECK_STREQ(*cast(char**)vec_at(twice->deps, 0), "add");
+    incdb_free(db);
+
+    // A corrupt database is thrown away
+    FILE* file = fopen(DB_PATH, "wb");
+    REQUIRE(file != null);
+    fputs("ADINCDB\n garbage", file);
+    fclose(file);
+    db = incdb_open(DB_PATH);
+    CHECK_EQ(vec_size(db->modules), 0);
+    incdb_free(db);
+    remove(DB_PATH);
+}
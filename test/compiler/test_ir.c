@@ -0,0 +1,255 @@
+#include <AdoradInternalTests/AdoradInternalTests.h>
+#include <tau/tau.h>
+TAU_MAIN()
+
+static Parser* parse(char* source) {
+    Lexer* lexer = lexer_init(source, "test.ad");
+    lexer_lex(lexer);
+    Parser* parser = parser_init(lexer);
+    parser_parse(parser);
+    return parser;
+}
+
+static char* source =
+    "put mutable counter: Int\n"
+    "put limit: Int64 = add(1, 2)\n"
+    "func add(a: Int, b: Int) -> Int { return a + b }\n"
+    "func abs(x: Int) -> Int { put mutable r = x\n if x < 0 { r = -x }\n return r }\n"
+    "func sum(n: Int) -> Int {\n"
+    "    put mutable s = 0\n"
+    "    loop i in 0..n { s += i }\n"
+    "    loop j = 0; j < 10; j += 1 { if j == 3 { continue } s += j }\n"
+    "    outer: loop { loop { break :outer } }\n"
+    "    loop { if s > 5 && s < 1000 { return s } s += 1 }\n"
+    "}\n"
+    "func classify(x: Int) -> Int {\n"
+    "    put mutable r = 0\n"
+    "    match x { when 0 => { r = 1 } when 1..10 => { r = 2 } }\n"
+    "    return r\n"
+    "}\n"
+    "func both(a: Bool, b: Bool) -> Bool { return a && b || !a }\n"
+    "func addr() -> Int { put mutable x = 1\n put p = &x\n x = 2\n return x }\n"
+    "func bump() { loop { counter += 1\n break\n counter += 2 } }\n"
+    "func ext(x: Int) -> Int;\n";
+
+static char* dump_of(IrModule* module, UInt64 index) {
+    StrBuilder* out = strbuilder_new(0);
+    ir_dump_func(*cast(IrFunc**)vec_at(module->funcs, index), out);
+    char* dump = strdup(out->data);
+    strbuilder_free(out);
+    return dump;
+}
+
+TEST(IR, Lower) {
+    Parser* parser = parse(source);
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+    IrModule* module = ir_lower(checker);
+    REQUIRE_EQ(vec_size(module->funcs), 10);
+
+    char* dump = dump_of(module, 0);
+    CHECK_STREQ(dump, "global @counter: Int\n");
+    free(dump);
+
+    // Implicit conversions are explicit
+    dump = dump_of(module, 1);
+    CHECK_STREQ(dump,
+        "global @limit: Int64 {\n"
+        "b0:\n"
+        "    %0: func(Int, Int) -> Int = func @add\n"
+        "    %1: Int = const 1\n"
+        "    %2: Int = const 2\n"
+        "    %3: Int = call %0(%1, %2)\n"
+        "    %4: Int64 = convert %3\n"
+        "    return %4\n"
+        "}\n");
+    free(dump);
+
+    // Locals are SSA values, merged by phis
+    dump = dump_of(module, 3);
+    CHECK_STREQ(dump,
+        "func @abs(Int) -> Int {\n"
+        "b0:\n"
+        "    %0: Int = param 0\n"
+        "    %1: Int = const 0\n"
+        "    %2: Bool = lt %0, %1\n"
+        "    branch %2, b1, b2\n"
+        "b1:\n"
+        "    %3: Int = neg %0\n"
+        "    jump b2\n"
+        "b2:\n"
+        "    %4: Int = phi [%0, b0], [%3, b1]\n"
+        "    return %4\n"
+        "}\n");
+    free(dump);
+
+    // A variable that isn't assigned in a loop doesn't get a phi
+    dump = dump_of(module, 4);
+    CHECK(strstr(dump,
+        "b1:\n"
+        "    %3: Int = phi [%2, b0], [%8, b3]\n"
+        "    %4: Int = phi [%1, b0], [%6, b3]\n"
+        "    %5: Bool = lt %3, %0\n"
+        "    branch %5, b2, b4\n") != null);
+    free(dump);
+
+    // The subject of a `match` is evaluated once, and ranges don't include their end
+    dump = dump_of(module, 5);
+    CHECK(strstr(dump, "    %6: Bool = le %5, %0\n") != null);
+    CHECK(strstr(dump, "    %8: Bool = lt %0, %7\n") != null);
+    CHECK(strstr(dump, "    %10: Int = phi [%4, b1], [%1, b2], [%1, b3], [%9, b4]\n") != null);
+    free(dump);
+
+    // Only locals whose address is taken live in memory
+    dump = dump_of(module, 7);
+    CHECK(strstr(dump, "    %1: &Int = slot\n    store %1, %0\n") != null);
+    CHECK(strstr(dump, "    %3: Int = load %1\n    return %3\n") != null);
+    free(dump);
+
+    // Code after `break` isn't lowered
+    dump = dump_of(module, 8);
+    CHECK_STREQ(dump,
+        "func @bump() {\n"
+        "b0:\n"
+        "    jump b1\n"
+        "b1:\n"
+        "    jump b2\n"
+        "b2:\n"
+        "    %0: Int = load_global @counter\n"
+        "    %1: Int = const 1\n"
+        "    %2: Int = add %0, %1\n"
+        "    store_global @counter, %2\n"
+        "    jump b3\n"
+        "b3:\n"
+        "    return\n"
+        "}\n");
+    free(dump);
+
+    dump = dump_of(module, 9);
+    CHECK_STREQ(dump, "func @ext(Int) -> Int\n");
+    free(dump);
+
+    for(UInt64 i = 0; i < vec_size(module->funcs); i++)
+        CHECK(ir_verify(*cast(IrFunc**)vec_at(module->funcs, i)) == null);
+
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+}
+
+TEST(IR, ReplaceUses) {
+    Parser* parser = parse("func add(a: Int, b: Int) -> Int { return (a + b) * a }\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+    IrModule* module = ir_lower(checker);
+    IrFunc* func = *cast(IrFunc**)vec_at(module->funcs, 0);
+
+    // %0 = param 0, %1 = param 1, %2 = add %0, %1, %3 = mul %2, %0
+    CHECK_EQ(ir_inst(func, 0)->num_uses, 2);
+    ir_replace_uses(func, 0, 1);
+    CHECK_EQ(ir_inst(func, 0)->num_uses, 0);
+    CHECK_EQ(ir_inst(func, 1)->num_uses, 3);
+    CHECK_EQ(ir_operand(func, 2, 0), 1);
+    CHECK_EQ(ir_operand(func, 3, 1), 1);
+    CHECK(ir_verify(func) == null);
+
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+}
+
+// Functions are lowered in parallel, but the IR must not depend on the number of threads
+TEST(IR, Deterministic) {
+    Parser* parser = parse(source);
+    Checker* serial = checker_new(1);
+    Checker* parallel = checker_new(8);
+    REQUIRE_EQ(checker_check(serial, &parser, 1), 0);
+    REQUIRE_EQ(checker_check(parallel, &parser, 1), 0);
+
+    IrModule* a = ir_lower(serial);
+    IrModule* b = ir_lower(parallel);
+    StrBuilder* dump_a = strbuilder_new(0);
+    StrBuilder* dump_b = strbuilder_new(0);
+    ir_dump(a, dump_a);
+    ir_dump(b, dump_b);
+    CHECK_STREQ(dump_a->data, dump_b->data);
+
+    strbuilder_free(dump_a);
+    strbuilder_free(dump_b);
+    ir_module_free(a);
+    ir_module_free(b);
+    checker_free(serial);
+    checker_free(parallel);
+    parser_free(parser);
+}
+
+// A chain of tensor methods is a single loop, and only its last method makes a tensor
+TEST(IR, TensorChain) {
+    Parser* parser = parse(
+        "func f(xs: TensorInt32) -> TensorInt32 { return xs.filter(it > 0).map(it * it).filter(it < 100).map(it + 1) }\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+    IrModule* module = ir_lower(checker);
+    REQUIRE(ir_verify(*cast(IrFunc**)vec_at(module->funcs, 0)) == null);
+
+    char* dump = dump_of(module, 0);
+    const char* ops[] = { "tensor_new", "tensor_len", "tensor_get", "tensor_push" };
+    for(UInt64 i = 0; i < 4; i++) {
+        char* at = strstr(dump, ops[i]);
+        CHECK(at != null && strstr(at + 1, ops[i]) == null);
+    }
+    // `it` is never a variable in memory
+    CHECK(strstr(dump, "slot") == null);
+    free(dump);
+
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+}
+
+// `t[i][j]` is one `tensor_get`, at `i * dim1 + j`, after both subscripts are checked
+TEST(IR, Indexing) {
+    Parser* parser = parse(
+        "func at(t: Tensor<Float64, 2>, i: Int64, j: Int64) -> Float64 { return t[i][j] }\n"
+        "func put_at(t: Tensor<Float64, 2>, i: Int64, j: Int64) { t[i][j] = 1.0 }\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+    IrModule* module = ir_lower(checker);
+    for(UInt64 f = 0; f < 2; f++) {
+        REQUIRE(ir_verify(*cast(IrFunc**)vec_at(module->funcs, f)) == null);
+        char* dump = dump_of(module, f);
+        const char* ops[] = { "tensor_dim %0, 0", "tensor_dim %0, 1", "mul", "add", f == 0 ? "tensor_get" : "tensor_set" };
+        for(UInt64 i = 0; i < 5; i++) {
+            char* at = strstr(dump, ops[i]);
+            CHECK(at != null && strstr(at + 1, ops[i]) == null);
+        }
+        char* check = strstr(dump, "bounds_check");
+        CHECK(check != null && strstr(check + 1, "bounds_check") != null);
+        free(dump);
+    }
+
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+}
+
+// A slice doesn't copy (or loop over) anything, and a copy of one is a single instruction
+TEST(IR, Slices) {
+    Parser* parser = parse(
+        "func f(xs: TensorInt32, n: Int64) -> TensorInt32 { return xs[n..:3].clone() }\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+    IrModule* module = ir_lower(checker);
+    REQUIRE(ir_verify(*cast(IrFunc**)vec_at(module->funcs, 0)) == null);
+
+    char* dump = dump_of(module, 0);
+    CHECK(strstr(dump, "tensor_slice") != null);
+    CHECK(strstr(dump, "tensor_clone") != null);
+    CHECK(strstr(dump, "tensor_len") != null);
+    CHECK(strstr(dump, "tensor_get") == null && strstr(dump, "jump") == null);
+    free(dump);
+
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+}
@@ -18,6 +18,76 @@ TEST(Lexer, Init) {
     free(lexer);
 }
 
+TEST(Lexer, Unicode) {
+    char* buffer = "café = \"héllo 世界\"\n变量_1 = café";
+    Lexer* lexer = lexer_init(buffer, null);
+    lexer_lex(lexer);
+
+    // café, =, "héllo 世界", 变量_1, =, café, EOF
+    REQUIRE_EQ(vec_size(lexer->toklist), 7);
+    Token* ident = cast(Token*)vec_at(lexer->toklist, 0);
+    CHECK_EQ(ident->kind, IDENTIFIER);
+    CHECK_STREQ(ident->value->data, "café");
+
+    Token* str = cast(Token*)vec_at(lexer->toklist, 2);
+    CHECK_EQ(str->kind, STRING);
+    CHECK_STREQ(str->value->data, "héllo 世界");
+
+    Token* ident2 = cast(Token*)vec_at(lexer->toklist, 3);
+    CHECK_EQ(ident2->kind, IDENTIFIER);
+    CHECK_STREQ(ident2->value->data, "变量_1");
+    CHECK_EQ(ident2->loc->line, 2);
+
+    lexer_free(lexer);
+}
+
+TEST(Lexer, UnicodeXID) {
+    // A combining mark (U+0301) may continue an identifier, but not start one
+    CHECK_TRUE(utf8_is_xid_continue(0x0301));
+    CHECK_FALSE(utf8_is_xid_start(0x0301));
+    CHECK_TRUE(utf8_is_xid_start(0x4E16));         // 世
+    CHECK_FALSE(utf8_is_xid_continue(0x00A0)); // NO-BREAK SPACE
+    CHECK_FALSE(utf8_is_xid_start('_'));
+
+    char* buffer = "cafe\xcc\x81 = x\xef\xbc\x91";   // café (decomposed), =, x１ (fullwidth digit)
+    Lexer* lexer = lexer_init(buffer, null);
+    lexer_lex(lexer);
+
+    REQUIRE_EQ(vec_size(lexer->toklist), 4);
+    Token* ident = cast(Token*)vec_at(lexer->toklist, 0);
+    CHECK_EQ(ident->kind, IDENTIFIER);
+    CHECK_STREQ(ident->value->data, "cafe\xcc\x81");
+
+    Token* ident2 = cast(Token*)vec_at(lexer->toklist, 2);
+    CHECK_EQ(ident2->kind, IDENTIFIER);
+    CHECK_STREQ(ident2->value->data, "x\xef\xbc\x91");
+
+    lexer_free(lexer);
+}
+
+TEST(Lexer, FormatString) {
+    // Braces (and strings) inside a hole don't end the literal; `f` on its own is still an identifier
+    char* buffer = "f\"{{x}} = {m[\"}\"]:4} {a \\\" b}\" f \"f\" f\"\"";
+    Lexer* lexer = lexer_init(buffer, null);
+    lexer_lex(lexer);
+
+    REQUIRE_EQ(vec_size(lexer->toklist), 5);
+    Token* fstr = cast(Token*)vec_at(lexer->toklist, 0);
+    CHECK_EQ(fstr->kind, FORMAT_STRING);
+    CHECK_STREQ(fstr->value->data, "{{x}} = {m[\"}\"]:4} {a \\\" b}");
+    CHECK_EQ(fstr->loc->col, 1);
+
+    Token* ident = cast(Token*)vec_at(lexer->toklist, 1);
+    CHECK_EQ(ident->kind, IDENTIFIER);
+    CHECK_STREQ(ident->value->data, "f");
+    CHECK_EQ((cast(Token*)vec_at(lexer->toklist, 2))->kind, STRING);
+    Token* empty = cast(Token*)vec_at(lexer->toklist, 3);
+    CHECK_EQ(empty->kind, FORMAT_STRING);
+    CHECK_STREQ(empty->value->data, "");
+
+    lexer_free(lexer);
+}
+
 // // Without newline in buffer
 // TEST(Lexer, advance_without_newline) {
 //     char* buffer = "abcdefghijklmnopqrstuvwxyz0123456789";
@@ -0,0 +1,62 @@
+#include <AdoradInternalTests/AdoradInternalTests.h>
+#include <tau/tau.h>
+TAU_MAIN()
+
+// The tests run from the root of the repository
+#define MODULES_DIR     "test/compiler/modules/"
+
+static UInt32 wave_of(ModuleGraph* graph, const char* path) {
+    for(UInt64 i = 0; i < vec_size(graph->modules); i++) {
+        Module* module = *cast(Module**)vec_at(graph->modules, i);
+        if(strcmp(module->path, path) == 0)
+            return module->wave;
+    }
+    return MODULE_NONE;
+}
+
+TEST(Module, Waves) {
+    ModuleGraph* graph = modgraph_new(4);
+    modgraph_add_search_path(graph, MODULES_DIR "lib");
+    REQUIRE_EQ(modgraph_load(graph, MODULES_DIR "main.ad"), 0);
+    REQUIRE_EQ(vec_size(graph->modules), 5);
+    REQUIRE_EQ(vec_size(graph->waves), 3);
+
+    // `use core` finds the `core` next to the module that uses it first
+    CHECK_EQ(wave_of(graph, MODULES_DIR "core.ad"), 0);
+    CHECK_EQ(wave_of(graph, MODULES_DIR "lib/core.ad"), 0);
+    CHECK_EQ(wave_of(graph, MODULES_DIR "math.ad"), 1);
+    CHECK_EQ(wave_of(graph, MODULES_DIR "lib/strings.ad"), 1);
+    CHECK_EQ(wave_of(graph, MODULES_DIR "main.ad"), 2);
+
+    Module* main_module = modgraph_find(graph, "main", 4);
+    REQUIRE(main_module != null);
+    CHECK_EQ(vec_size(main_module->deps), 2);
+
+    CHECK_EQ(modgraph_check(graph), 0);
+    Module* last = modgraph_critical_path(graph);
+    CHECK(last == main_module);
+    CHECK(last->critical_dep != MODULE_NONE);
+    CHECK(last->critical_path >= last->cost);
+
+    modgraph_free(graph);
+}
+
+TEST(Module, Errors) {
+    ModuleGraph* graph = modgraph_new(1);
+    REQUIRE_EQ(modgraph_load(graph, MODULES_DIR "cycle/a.ad"), 2);
+    CHECK_EQ(vec_size(graph->waves), 0);
+
+    CheckerDiagnostic* missing = cast(CheckerDiagnostic*)vec_at(graph->diagnostics, 0);
+    CHECK_STREQ(missing->msg, "Cannot find module `missing`");
+    CHECK_EQ(missing->line, 4);
+    CheckerDiagnostic* cycle = cast(CheckerDiagnostic*)vec_at(graph->diagnostics, 1);
+    CHECK_STREQ(cycle->msg, "Import cycle: a -> b -> c -> a");
+
+    // Nothing is scheduled (and so nothing is checked) if there's a cycle
+    CHECK_EQ(modgraph_check(graph), 0);
+    modgraph_free(graph);
+
+    graph = modgraph_new(1);
+    CHECK_EQ(modgraph_load(graph, MODULES_DIR "does_not_exist.ad"), 1);
+    modgraph_free(graph);
+}
@@ -0,0 +1,215 @@
+#include <AdoradInternalTests/AdoradInternalTests.h>
+#include <tau/tau.h>
+TAU_MAIN()
+
+static Parser* parse(char* source) {
+    Lexer* lexer = lexer_init(source, "test.ad");
+    lexer_lex(lexer);
+    Parser* parser = parser_init(lexer);
+    parser_parse(parser);
+    return parser;
+}
+
+// Lower and optimize `source`, and return the dump of function `index`
+static char* optimized(char* source, UInt64 index, OptStats* stats) {
+    Parser* parser = parse(source);
+    Checker* checker = checker_new(1);
+    CHECK_EQ(checker_check(checker, &parser, 1), 0);
+    IrModule* module = ir_lower(checker);
+    opt_module(module, stats);
+
+    for(UInt64 i = 0; i < vec_size(module->funcs); i++)
+        CHECK(ir_verify(*cast(IrFunc**)vec_at(module->funcs, i)) == null);
+    StrBuilder* out = strbuilder_new(0);
+    ir_dump_func(*cast(IrFunc**)vec_at(module->funcs, index), out);
+    char* dump = strdup(out->data);
+
+    strbuilder_free(out);
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+    return dump;
+}
+
+TEST(Opt, Fold) {
+    // Constants are propagated through locals, identities and branches, and wrap around like the type does
+    char* dump = optimized(
+        "func f() -> Int { put a = 2 * 3 + 4\n put b = a * 1 + 0\n if b > 100 { return -b }\n return b - 3 }\n", 0,
+        null);
+    CHECK_STREQ(dump,
+        "func @f() -> Int {\n"
+        "b0:\n"
+        "    %0: Int = const 7\n"
+        "    return %0\n"
+        "}\n");
+    free(dump);
+
+    dump = optimized("func g() -> Int8 { put a: Int8 = 100\n return a + a }\n", 0, null);
+    CHECK(strstr(dump, "    %0: Int8 = const -56\n") != null);
+    free(dump);
+
+    dump = optimized("func h(x: Int) -> Bool { return x - x == 0 && !!(x == x) }\n", 0, null);
+    CHECK_STREQ(dump,
+        "func @h(Int) -> Bool {\n"
+        "b0:\n"
+        "    %0: Bool = const true\n"
+        "    return %0\n"
+        "}\n");
+    free(dump);
+
+    // Division by zero is left for run time
+    dump = optimized("func d() -> Int { return 1 / 0 }\n", 0, null);
+    CHECK(strstr(dump, "div") != null);
+    free(dump);
+}
+
+TEST(Opt, CSE) {
+    // `y * x` is `x * y`, and the expression in the branch is dominated by the one before it
+    char* dump = optimized(
+        "func f(x: Int, y: Int) -> Int {\n"
+        "    put a = x * y + x\n"
+        "    put b = y * x + x\n"
+        "    if x > 0 { return x * y }\n"
+        "    return a + b\n"
+        "}\n", 0, null);
+    CHECK_STREQ(dump,
+        "func @f(Int, Int) -> Int {\n"
+        "b0:\n"
+        "    %0: Int = param 0\n"
+        "    %1: Int = param 1\n"
+        "    %2: Int = mul %0, %1\n"
+        "    %3: Int = add %2, %0\n"
+        "    %4: Int = const 0\n"
+        "    %5: Bool = gt %0, %4\n"
+        "    branch %5, b1, b2\n"
+        "b1:\n"
+        "    return %2\n"
+        "b2:\n"
+        "    %6: Int = add %3, %3\n"
+        "    return %6\n"
+        "}\n");
+    free(dump);
+}
+
+TEST(Opt, DCE) {
+    // Unused values, stores to locals that are never read, and jumps between blocks all go away
+    char* dump = optimized(
+        "put mutable counter: Int\n"
+        "func f(x: Int) -> Int {\n"
+        "    put unused = x * 2\n"
+        "    put mutable q = 1\n"
+        "    put p = &q\n"
+        "    outer: loop { loop { counter += 1\n break :outer } }\n"
+        "    return x\n"
+        "}\n", 1, null);
+    CHECK_STREQ(dump,
+        "func @f(Int) -> Int {\n"
+        "b0:\n"
+        "    %0: Int = param 0\n"
+        "    %1: Int = const 1\n"
+        "    %2: Int = load_global @counter\n"
+        "    %3: Int = add %2, %1\n"
+        "    store_global @counter, %3\n"
+        "    return %0\n"
+        "}\n");
+    free(dump);
+}
+
+static char* source_inline =
+    "[noinline] func one(x: Int) -> Int { return x + 1 }\n"
+    "[inline] func squares(x: Int) -> Int { put mutable s = 0\n loop i in 0..x { s += i * i }\n return s }\n"
+    "func pick(c: Bool, x: Int) -> Int { if c { return x } return 0 - x }\n"
+    "func fib(n: Int) -> Int { if n < 2 { return n } return fib(n - 1) + fib(n - 2) }\n"
+    "func main() -> Int { return one(1) + squares(3) + pick(true, 5) + pick(false, 2) + fib(10) }\n";
+
+TEST(Opt, Inline) {
+    OptStats stats = {0};
+    char* dump = optimized(source_inline, 4, &stats);
+    // `[noinline]` isn't inlined, `[inline]` is (even though it's bigger), and `pick` folds away once it's inlined
+    CHECK(strstr(dump, "call %") != null);
+    CHECK(strstr(dump, "func @one") != null);
+    CHECK(strstr(dump, "func @squares") == null);
+    CHECK(strstr(dump, "func @pick") == null);
+    CHECK(strstr(dump, "mul") != null);
+    CHECK(strstr(dump, "    %3: Int = const 3\n") != null);
+    CHECK(strstr(dump, "    %14: Int = const -2\n") != null);
+    // `fib` is inlined into `main` once: its own calls are left alone
+    CHECK(strstr(dump, "    %17: Int = const 9\n    %18: Int = call %16(%17)\n") != null);
+    free(dump);
+    CHECK_EQ(stats.passes[OptPassInline].changes, 4);
+    CHECK_EQ(stats.passes[OptPassInline].runs, 5);
+
+    // Functions are never inlined into themselves
+    dump = optimized(source_inline, 3, null);
+    CHECK(strstr(dump, "    %6: Int = call %3(%5)\n") != null);
+    free(dump);
+}
+
+// A branch folded into a jump drops its edge from the target block, even if a phi of that block was already folded
+// away (here, once `f4` is inlined into the loop of `f5`, and `f5` into `main`)
+TEST(Opt, FoldBranchIntoLoop) {
+    char* source =
+        "func println(s: String);\n"
+        "func int_to_str(x: Int64) -> String;\n"
+        "[inline] func f4(a: Int, b: Int) -> Int { return b }\n"
+        "[inline] func f5(a: Int, b: Int) -> Int {\n"
+        "    put mutable v42: Int = (a * -(b + b))\n"
+        "    put mutable c43: Int = 0\n"
+        "    loop c43 < 2 {\n"
+        "        c43 += 1\n"
+        "        put mutable v44: Int = ((b * v42) & (a + b))\n"
+        "        if true && (v42 - -(a + 255) != f4(a, v42) && v42 * a != (v44 - 85)) { v42 += (a / 100) }\n"
+        "    }\n"
+        "    return ((b * a) % 3)\n"
+        "}\n"
+        "func main() -> Int {\n"
+        "    println(int_to_str(f5(35, 46)))\n"
+        "    return 0\n"
+        "}\n";
+    free(optimized(source, 4, null));
+
+    Parser* parser = parse(source);
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+    IrModule* module = ir_lower(checker);
+    opt_module(module, null);
+    Vm* vm = vm_new();
+    vm->output = strbuilder_new(0);
+    REQUIRE_EQ(vm_load(vm, module), 0);
+    Int64 exit_code = -1;
+    REQUIRE(vm_run(vm, &exit_code));
+    CHECK_STREQ(vm->output->data, "2\n");
+
+    strbuilder_free(vm->output);
+    vm_free(vm);
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+}
+
+// Everything but the timings must be the same no matter how many threads there are
+TEST(Opt, Deterministic) {
+    Parser* parser = parse(source_inline);
+    StrBuilder* dumps[2];
+    OptStats stats[2];
+    for(UInt32 i = 0; i < 2; i++) {
+        Checker* checker = checker_new(i == 0 ? 1 : 8);
+        REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+        IrModule* module = ir_lower(checker);
+        memset(&stats[i], 0, sizeof(OptStats));
+        opt_module(module, &stats[i]);
+        dumps[i] = strbuilder_new(0);
+        ir_dump(module, dumps[i]);
+        ir_module_free(module);
+        checker_free(checker);
+    }
+    CHECK_STREQ(dumps[0]->data, dumps[1]->data);
+    for(UInt32 p = 0; p < OptPassCount; p++) {
+        CHECK_EQ(stats[0].passes[p].runs, stats[1].passes[p].runs);
+        CHECK_EQ(stats[0].passes[p].changes, stats[1].passes[p].changes);
+    }
+
+    strbuilder_free(dumps[0]);
+    strbuilder_free(dumps[1]);
+    parser_free(parser);
+}
@@ -0,0 +1,527 @@
+#include <AdoradInternalTests/AdoradInternalTests.h>
+#include <tau/tau.h>
+TAU_MAIN()
+
+static Parser* parse(char* source) {
+    Lexer* lexer = lexer_init(source, "test.ad");
+    lexer_lex(lexer);
+    Parser* parser = parser_init(lexer);
+    parser_parse(parser);
+    return parser;
+}
+
+static char* source =
+    "func print(s: String);\n"
+    "func println(s: String);\n"
+    "func int_to_str(x: Int64) -> String;\n"
+    "func fib(n: Int) -> Int { if n < 2 { return n } return fib(n - 1) + fib(n - 2) }\n"
+    "func wrap(x: Int8) -> Int8 { return x + 100 }\n"
+    "func halve(x: Float64) -> ?Float64 { return x / 2.0 }\n"
+    "func scale(x: Float32) -> Float32 { return x * 3.0 + 0.1 }\n"
+    "func swap(n: Int) -> Int { put mutable a = 1\n put mutable b = 2\n put mutable i = 0\n"
+    "    loop i < n { put t = a\n a = b\n b = t\n i += 1 }\n return a * 10 + b }\n"
+    "put mutable total = 0\n"
+    "put greeting = \"hello\" + \", \"\n"
+    "func main() -> Int {\n"
+    "    put mutable s = \"-\"\n"
+    "    loop i in 0..1000 { s = s + \"x\" }\n"
+    "    put mutable n = 0\n"
+    "    put p = &n\n"
+    "    n = 1\n"
+    "    total = fib(20)\n"
+    "    println(greeting + \"world\\t!\")\n"
+    "    print(int_to_str(swap(3)))\n"
+    "    return total + wrap(100) + n\n"
+    "}\n";
+
+TEST(Vm, Run) {
+    Parser* parser = parse(source);
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+    IrModule* module = ir_lower(checker);
+    opt_module(module, null);
+
+    Vm* vm = vm_new();
+    vm->output = strbuilder_new(0);
+    REQUIRE_EQ(vm_load(vm, module), 0);
+    Int64 exit_code = -1;
+    REQUIRE(vm_run(vm, &exit_code));
+    // fib(20) + (Int8)200 + 1
+    CHECK_EQ(exit_code, 6765 - 56 + 1);
+    CHECK_STREQ(vm->output->data, "hello, world\t!\n21");
+
+    // Functions can also be called one at a time
+    VmValue args[2] = {0};
+    args[0].i = 25;
+    CHECK(vm_call(vm, vm_func(vm, "fib"), args, args));
+    CHECK_EQ(args[0].i, 75025);
+    args[0].f = 3.0;
+    args[1].u = 1;
+    CHECK(vm_call(vm, vm_func(vm, "halve"), args, args));
+    CHECK(args[0].f == 1.5);
+    CHECK_EQ(args[1].u, 0);
+    // `Float32` arithmetic is rounded like it is in C
+    args[0].f = cast(double)0.7f;
+    CHECK(vm_call(vm, vm_func(vm, "scale"), args, args));
+    CHECK(args[0].f == cast(double)(0.7f * 3.0f + 0.1f));
+
+    // The comparison in `fib` is fused with its branch, and `n - 1` takes an immediate
+    StrBuilder* out = strbuilder_new(0);
+    vm_dump_func(vm, vm_func(vm, "fib"), out);
+    CHECK(strstr(out->data, "jle") != null || strstr(out->data, "jlt") != null);
+    CHECK(strstr(out->data, "addi32") != null);
+    CHECK(strstr(out->data, "    0  ") != null);
+    strbuilder_free(out);
+
+    strbuilder_free(vm->output);
+    vm_free(vm);
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+}
+
+TEST(Vm, Strings) {
+    Parser* parser = parse(
+        "func build(n: Int) -> String { put mutable s = \"-\"\n loop i in 0..n { s = s + \"ab\" } return s }\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+    IrModule* module = ir_lower(checker);
+    Vm* vm = vm_new();
+    REQUIRE_EQ(vm_load(vm, module), 0);
+
+    // Every intermediate string is garbage once the next one is built
+    vm->gc_threshold = 4096;
+    VmValue args[1] = {0};
+    args[0].i = 2000;
+    REQUIRE(vm_call(vm, vm_func(vm, "build"), args, args));
+    CHECK_EQ(args[0].s->len, 4001);
+    CHECK(vm->num_collections > 0);
+    CHECK(vm->strings_freed > 0);
+
+    vm_free(vm);
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+}
+
+// Without optimizations, both operands of an `add` can be constants; only one of them can be an immediate
+TEST(Vm, Immediates) {
+    Parser* parser = parse("func f(x: Int) -> Int { return (6 + 49) * x + (x - 7) + (3 - x) + (x + 40000) }\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+    IrModule* module = ir_lower(checker);
+    Vm* vm = vm_new();
+    REQUIRE_EQ(vm_load(vm, module), 0);
+
+    VmValue args[1] = {0};
+    args[0].i = 2;
+    REQUIRE(vm_call(vm, vm_func(vm, "f"), args, args));
+    CHECK_EQ(args[0].i, 55 * 2 + (2 - 7) + (3 - 2) + (2 + 40000));
+
+    vm_free(vm);
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+}
+
+TEST(Vm, Errors) {
+    Parser* parser = parse(
+        "func ext(x: Int) -> Int;\n"
+        "func deep(n: Int) -> Int { return deep(n + 1) }\n"
+        "func div(a: Int, b: Int) -> Int { return a / b }\n"
+        "func shift(a: Int64, b: Int64) -> Int64 { return a << b }\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+    IrModule* module = ir_lower(checker);
+    Vm* vm = vm_new();
+    REQUIRE_EQ(vm_load(vm, module), 1);
+    CHECK_STREQ((cast(CheckerDiagnostic*)vec_at(vm->diagnostics, 0))->msg,
+                "`ext` doesn't have a body, and there's no native function by that name (and type)");
+
+    VmValue args[2] = {0};
+    CHECK(!vm_call(vm, vm_func(vm, "deep"), args, args));
+    CHECK(strstr(vm->error, "stack overflow") != null);
+    args[0].i = 1;
+    args[1].i = 0;
+    CHECK(!vm_call(vm, vm_func(vm, "div"), args, args));
+    CHECK_STREQ(vm->error, "division by zero in `div`");
+    args[1].i = 64;
+    CHECK(!vm_call(vm, vm_func(vm, "shift"), args, args));
+    CHECK_STREQ(vm->error, "shift by 64 bits in `shift`");
+    args[1].i = 3;
+    CHECK(vm_call(vm, vm_func(vm, "shift"), args, args));
+    CHECK_EQ(args[0].i, 8);
+    CHECK_EQ(vm->num_frames, 0);
+
+    vm_free(vm);
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+}
+
+static Tensor* int_tensor(Int64* values, UInt64 len) {
+    Tensor* tensor = tensor_new(TensorDTypeInt32, 0, len);
+    for(UInt64 i = 0; i < len; i++) {
+        TensorScalar x;
+        x.i = values[i];
+        tensor_push(tensor, x);
+    }
+    return tensor;
+}
+
+TEST(Vm, Tensors) {
+    Parser* parser = parse(
+        "func total(xs: TensorInt32) -> Int { return xs.filter(it > 0).map(it * 3).filter(it != 6).sum() }\n"
+        "func positives(xs: TensorInt32) -> Int64 { return xs.filter(it > 0).count() }\n"
+        "func largest_even(xs: TensorInt32) -> Int { return xs.filter(it % 2 == 0).max() }\n"
+        "func smallest(xs: TensorFloat64) -> Float64 { return xs.map(it * 0.5).min() }\n"
+        "func odds(xs: TensorInt32) -> TensorInt32 { return xs.map(it + 1).filter(it % 2 != 0) }\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+    IrModule* module = ir_lower(checker);
+    opt_module(module, null);
+    Vm* vm = vm_new();
+    REQUIRE_EQ(vm_load(vm, module), 0);
+
+    Int64 values[] = { 4, -1, 2, 7, -6, 0, 3 };
+    Tensor* xs = int_tensor(values, 7);
+    VmValue args[1] = {0};
+    // (4 + 7 + 3) * 3, without the 2 * 3
+    args[0].t = xs;
+    REQUIRE(vm_call(vm, vm_func(vm, "total"), args, args));
+    CHECK_EQ(args[0].i, 42);
+    args[0].t = xs;
+    REQUIRE(vm_call(vm, vm_func(vm, "positives"), args, args));
+    CHECK_EQ(args[0].i, 4);
+    args[0].t = xs;
+    REQUIRE(vm_call(vm, vm_func(vm, "largest_even"), args, args));
+    CHECK_EQ(args[0].i, 4);
+    args[0].t = xs;
+    REQUIRE(vm_call(vm, vm_func(vm, "odds"), args, args));
+    REQUIRE(args[0].t != null);
+    CHECK_EQ(args[0].t->len, 4);
+    CHECK_EQ(tensor_get(args[0].t, 0).i, 5);
+    CHECK_EQ(tensor_get(args[0].t, 2).i, -5);
+    CHECK_EQ(tensor_get(args[0].t, 3).i, 1);
+
+    Tensor* fs = tensor_new(TensorDTypeFloat64, 3, 0);
+    TensorScalar x;
+    x.f = 3.0;
+    tensor_set(fs, 0, x);
+    x.f = -5.0;
+    tensor_set(fs, 1, x);
+    args[0].t = fs;
+    REQUIRE(vm_call(vm, vm_func(vm, "smallest"), args, args));
+    CHECK(args[0].f == -2.5);
+
+    // There's no maximum of no elements
+    Int64 odd[] = { 1, 3 };
+    Tensor* none = int_tensor(odd, 2);
+    args[0].t = none;
+    CHECK(!vm_call(vm, vm_func(vm, "largest_even"), args, args));
+    CHECK(strstr(vm->error, "unreachable") != null);
+
+    tensor_free(none);
+    tensor_free(fs);
+    tensor_free(xs);
+    vm_free(vm);
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+}
+
+// `a[i][j]` is an element of one buffer
+TEST(Vm, Indexing) {
+    Parser* parser = parse(
+        "func zeros(m: Int64, n: Int64) -> Tensor<Int64, 2>;\n"
+        "func table(m: Int64, n: Int64) -> Tensor<Int64, 2> {\n"
+        "    put t = zeros(m, n)\n"
+        "    loop i in 0..m { loop j in 0..n { t[i][j] = i * 10 + j } }\n"
+        "    t[m - 1][n - 1] *= 2\n"
+        "    return t\n"
+        "}\n"
+        "func at(t: Tensor<Int64, 2>, i: Int64, j: Int64) -> Int64 { return t[i][j] }\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+    IrModule* module = ir_lower(checker);
+    opt_module(module, null);
+    Vm* vm = vm_new();
+    REQUIRE_EQ(vm_load(vm, module), 0);
+
+    VmValue args[3] = {0};
+    args[0].i = 2;
+    args[1].i = 3;
+    REQUIRE(vm_call(vm, vm_func(vm, "table"), args, args));
+    Tensor* t = args[0].t;
+    REQUIRE(t != null);
+    CHECK(t->rank == 2 && t->shape[0] == 2 && t->shape[1] == 3 && t->len == 6);
+    CHECK_EQ(tensor_get(t, 1 * 3 + 1).i, 11);
+    CHECK_EQ(tensor_get(t, 5).i, 24);
+
+    args[0].t = t;
+    args[1].i = 1;
+    args[2].i = 0;
+    REQUIRE(vm_call(vm, vm_func(vm, "at"), args, args));
+    CHECK_EQ(args[0].i, 10);
+    // Every subscript is checked against its own dimension (`[0][3]` is in the buffer, but not in the row)
+    args[0].t = t;
+    args[1].i = 0;
+    args[2].i = 3;
+    CHECK(!vm_call(vm, vm_func(vm, "at"), args, args));
+    CHECK_STREQ(vm->error, "index 3 is out of bounds (the length is 3) in `at`");
+    args[0].t = t;
+    args[1].i = -1;
+    args[2].i = 0;
+    CHECK(!vm_call(vm, vm_func(vm, "at"), args, args));
+    CHECK_STREQ(vm->error, "index -1 is out of bounds (the length is 2) in `at`");
+
+    args[0].i = -2;
+    args[1].i = 3;
+    CHECK(!vm_call(vm, vm_func(vm, "table"), args, args));
+    CHECK(strstr(vm->error, "negative length") != null);
+
+    vm_free(vm);
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+}
+
+// Slices share the elements of the tensor; `.clone()` doesn't
+TEST(Vm, Slices) {
+    Parser* parser = parse(
+        "func middle(xs: TensorInt32) -> Int { return xs[1..4].sum() }\n"
+        "func ends(xs: TensorInt32) -> Int { return xs[..2].sum() * 100 + xs[5..].sum() }\n"
+        "func evens(xs: TensorInt32, step: Int64) -> TensorInt32 { return xs[0..:step] }\n"
+        "func poke(xs: TensorInt32) -> Int {\n"
+        "    put view = xs[2..6:2]\n"
+        "    put copy = xs.clone()\n"
+        "    view[1] = 50\n"
+        "    copy[0] = 60\n"
+        "    return view[0] + xs[4] + copy[4]\n"
+        "}\n"
+        "func window(xs: TensorInt32, lower: Int64, upper: Int64) -> Int64 { return xs[lower..upper].count() }\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+    IrModule* module = ir_lower(checker);
+    opt_module(module, null);
+    Vm* vm = vm_new();
+    REQUIRE_EQ(vm_load(vm, module), 0);
+
+    Int64 values[] = { 1, 2, 3, 4, 5, 6, 7 };
+    Tensor* xs = int_tensor(values, 7);
+    VmValue args[3] = {0};
+    args[0].t = xs;
+    REQUIRE(vm_call(vm, vm_func(vm, "middle"), args, args));
+    CHECK_EQ(args[0].i, 2 + 3 + 4);
+    args[0].t = xs;
+    REQUIRE(vm_call(vm, vm_func(vm, "ends"), args, args));
+    CHECK_EQ(args[0].i, 300 + 13);
+    args[0].t = xs;
+    args[1].i = 2;
+    REQUIRE(vm_call(vm, vm_func(vm, "evens"), args, args));
+    Tensor* view = args[0].t;
+    REQUIRE(view != null);
+    CHECK(view->len == 4 && view->stride == 2 && view->cap == 0 && view->data == xs->data);
+
+    // `view` is [3, 5]: writing to it writes to `xs`, and the copy (taken before) keeps the old 5
+    args[0].t = xs;
+    REQUIRE(vm_call(vm, vm_func(vm, "poke"), args, args));
+    CHECK_EQ(args[0].i, 3 + 50 + 5);
+    CHECK_EQ(tensor_get(xs, 4).i, 50);
+    CHECK_EQ(tensor_get(xs, 0).i, 1);
+
+    args[0].t = xs;
+    args[1].i = 7;
+    args[2].i = 7;
+    REQUIRE(vm_call(vm, vm_func(vm, "window"), args, args));
+    CHECK_EQ(args[0].i, 0);
+    args[0].t = xs;
+    args[1].i = 3;
+    args[2].i = 8;
+    CHECK(!vm_call(vm, vm_func(vm, "window"), args, args));
+    CHECK_STREQ(vm->error, "slice [3..8] is out of bounds (the length is 7) in `window`");
+    args[0].t = xs;
+    args[1].i = 0;
+    CHECK(!vm_call(vm, vm_func(vm, "evens"), args, args));
+    CHECK_STREQ(vm->error, "the step of a slice must be positive; got 0 in `evens`");
+
+    tensor_free(xs);
+    vm_free(vm);
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+}
+
+// A slice outlives its tensor growing: it keeps seeing the elements it was taken from
+TEST(Vm, SliceThenGrow) {
+    Parser* parser = parse(
+        "func middle(xs: TensorInt32) -> TensorInt32 { return xs[1..4] }\n"
+        "func total(xs: TensorInt32) -> Int { return xs.sum() }\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+    IrModule* module = ir_lower(checker);
+    opt_module(module, null);
+    Vm* vm = vm_new();
+    REQUIRE_EQ(vm_load(vm, module), 0);
+
+    Int64 values[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    Tensor* xs = int_tensor(values, 8);
+    VmValue args[1] = {0};
+    args[0].t = xs;
+    REQUIRE(vm_call(vm, vm_func(vm, "middle"), args, args));
+    Tensor* view = args[0].t;
+    REQUIRE(view != null && view->data == xs->data + sizeof(Int32));
+
+    // `xs` moves (several times), and `view` still sees the old elements
+    for(Int64 i = 0; i < 100; i++) {
+        TensorScalar x;
+        x.i = i;
+        tensor_push(xs, x);
+    }
+    CHECK(view->data != xs->data + sizeof(Int32));
+    CHECK_EQ(tensor_get(view, 0).i, 2);
+    args[0].t = view;
+    REQUIRE(vm_call(vm, vm_func(vm, "total"), args, args));
+    CHECK_EQ(args[0].i, 2 + 3 + 4);
+
+    tensor_free(xs);
+    vm_free(vm);
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+}
+
+// `sort()` with no condition, a direction, and a key (which is computed once per element)
+TEST(Vm, Sort) {
+    Parser* parser = parse(
+        "func ascending(xs: TensorInt32) { xs.sort() }\n"
+        "func descending(xs: TensorInt32) { xs.sort(a > b) }\n"
+        "func by_last_digit(xs: TensorInt32) { xs.sort(a % 10 < b % 10) }\n"
+        "func by_square_desc(xs: TensorInt32) -> Int { xs.sort(b * b < a * a)\n return xs[0] }\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+    IrModule* module = ir_lower(checker);
+    opt_module(module, null);
+    Vm* vm = vm_new();
+    REQUIRE_EQ(vm_load(vm, module), 0);
+
+    Int64 values[] = { 21, -7, 3, 11, 40, 13, -2 };
+    Tensor* xs = int_tensor(values, 7);
+    VmValue args[1] = {0};
+    args[0].t = xs;
+    REQUIRE(vm_call(vm, vm_func(vm, "ascending"), args, args));
+    Int64 ascending[] = { -7, -2, 3, 11, 13, 21, 40 };
+    for(UInt64 i = 0; i < 7; i++)
+        CHECK_EQ(tensor_get(xs, i).i, ascending[i]);
+    args[0].t = xs;
+    REQUIRE(vm_call(vm, vm_func(vm, "descending"), args, args));
+    for(UInt64 i = 0; i < 7; i++)
+        CHECK_EQ(tensor_get(xs, i).i, ascending[6 - i]);
+
+    // Stable: 21 and 11 (and 13 and 3) keep their order
+    args[0].t = xs;
+    REQUIRE(vm_call(vm, vm_func(vm, "by_last_digit"), args, args));
+    Int64 by_digit[] = { -7, -2, 40, 21, 11, 13, 3 };
+    for(UInt64 i = 0; i < 7; i++)
+        CHECK_EQ(tensor_get(xs, i).i, by_digit[i]);
+    args[0].t = xs;
+    REQUIRE(vm_call(vm, vm_func(vm, "by_square_desc"), args, args));
+    CHECK_EQ(args[0].i, 40);
+    CHECK_EQ(tensor_get(xs, 6).i, -2);
+
+    // The zero value (null) is an empty tensor
+    args[0].t = null;
+    CHECK(vm_call(vm, vm_func(vm, "ascending"), args, args));
+
+    tensor_free(xs);
+    vm_free(vm);
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+}
+
+static Tensor* matrix(UInt64 m, UInt64 n, double first) {
+    UInt64 shape[] = {m, n};
+    Tensor* tensor = tensor_new_shape(TensorDTypeFloat64, 2, shape);
+    for(UInt64 i = 0; i < m * n; i++) {
+        TensorScalar x;
+        x.f = first + cast(double)i;
+        tensor_set(tensor, i, x);
+    }
+    return tensor;
+}
+
+TEST(Vm, Matmul) {
+    Parser* parser = parse(
+        "func matmul(a: Tensor<Float64, 2>, b: Tensor<Float64, 2>) -> Tensor<Float64, 2>;\n"
+        "func total(a: Tensor<Float64, 2>, b: Tensor<Float64, 2>) -> Float64 {\n"
+        "    put c = matmul(a, b)\n"
+        "    return c[1][0] * 1000.0 + c.sum()\n"
+        "}\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+    IrModule* module = ir_lower(checker);
+    opt_module(module, null);
+    Vm* vm = vm_new();
+    REQUIRE_EQ(vm_load(vm, module), 0);
+
+    // [1 2; 3 4] * [5 6; 7 8] = [19 22; 43 50]
+    Tensor* a = matrix(2, 2, 1);
+    Tensor* b = matrix(2, 2, 5);
+    Tensor* c = matrix(3, 3, 0);
+    VmValue args[2] = {0};
+    args[0].t = a;
+    args[1].t = b;
+    REQUIRE(vm_call(vm, vm_func(vm, "total"), args, args));
+    CHECK(args[0].f == 43000 + 19 + 22 + 43 + 50);
+
+    args[0].t = a;
+    args[1].t = c;
+    CHECK(!vm_call(vm, vm_func(vm, "total"), args, args));
+    CHECK_STREQ(vm->error, "`matmul()` of a 2 x 2 and a 3 x 3 matrix");
+
+    tensor_free(a);
+    tensor_free(b);
+    tensor_free(c);
+    vm_free(vm);
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+}
+
+TEST(Vm, FormatStrings) {
+    Parser* parser = parse(
+        "func println(s: String);\n"
+        "func show(name: String, x: Float64, n: Int, r: Rune, b: Bool) -> Int {\n"
+        "    println(f\"Hello, {name}! [{x:10}] [{n:-6}] [{n:06}] {{x}} {x:.2f} {n:x} {b}\")\n"
+        "    println(f\"{r}{r:x} {x / 3.0} {0.1 + 0.2} {1e16} {x:e} ${n * 2}\")\n"
+        "    println(f\"\")\n"
+        "    return 0\n"
+        "}\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+    IrModule* module = ir_lower(checker);
+    opt_module(module, null);
+    Vm* vm = vm_new();
+    vm->output = strbuilder_new(0);
+    REQUIRE_EQ(vm_load(vm, module), 0);
+
+    VmValue args[5] = {0};
+    args[0].s = vm_new_string(vm, "Jill", 4);
+    args[1].f = 123.4567;
+    args[2].i = -42;
+    args[3].i = 0xE9;
+    args[4].u = 1;
+    REQUIRE(vm_call(vm, vm_func(vm, "show"), args, args));
+    // Floats are written in the fewest digits of their type (untyped literals are `Float32`s)
+    CHECK_STREQ(vm->output->data,
+                "Hello, Jill! [  123.4567] [-42   ] [-00042] {x} 123.46 -2a true\n"
+                "\xc3\xa9" "e9 41.152233333333335 0.3 1e+16 1.234567e+02 -84\n"
+                "\n");
+
+    strbuilder_free(vm->output);
+    vm_free(vm);
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+}
@@ -0,0 +1,159 @@
+#include <AdoradInternalTests/AdoradInternalTests.h>
+#include <tau/tau.h>
+#include <sys/wait.h>
+TAU_MAIN()
+
+static Parser* parse(char* source) {
+    Lexer* lexer = lexer_init(source, "test.ad");
+    lexer_lex(lexer);
+    Parser* parser = parser_init(lexer);
+    parser_parse(parser);
+    return parser;
+}
+
+static X64Symbol* find_symbol(X64* x64, const char* name) {
+    for(UInt64 i = 0; i < vec_size(x64->symbols); i++) {
+        X64Symbol* symbol = cast(X64Symbol*)vec_at(x64->symbols, i);
+        if(strcmp(symbol->name, name) == 0)
+            return symbol;
+    }
+    return null;
+}
+
+// Link `object` with `cc` and run it. Returns its exit code, or -1 if there's no C compiler to link it with.
+static int link_and_run(const char* object) {
+    if(system("cc --version > /dev/null 2>&1") != 0)
+        return -1;
+    char command[256];
+    snprintf(command, sizeof(command), "cc %s -o %s.out", object, object);
+    if(system(command) != 0)
+        return -2;
+    snprintf(command, sizeof(command), "./%s.out", object);
+    int status = system(command);
+    snprintf(command, sizeof(command), "%s.out", object);
+    remove(command);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -3;
+}
+
+static char* source =
+    "put base: Int = 40\n"
+    "put limit: Int = base + 2\n"
+    "func fib(n: Int) -> Int { if n < 2 { return n } return fib(n - 1) + fib(n - 2) }\n"
+    "func sum(n: Int) -> Int {\n"
+    "    put mutable s = 0\n"
+    "    loop i in 0..n { s = (s + i * 3 + (i >> 2)) % 1000003 }\n"
+    "    return s\n"
+    "}\n"
+    "func repeat(n: Int) -> String {\n"
+    "    put mutable s = \"-\"\n"
+    "    loop i in 0..n { s = s + \"ab\" }\n"
+    "    return s\n"
+    "}\n"
+    "func half(x: Float64) -> Float64 { return x / 2.0 }\n"
+    "func main() -> Int {\n"
+    "    if repeat(2) != \"-abab\" { return 1 }\n"
+    "    if half(5.0) != 2.5 { return 2 }\n"
+    "    if sum(1000) != 622997 { return 3 }\n"
+    "    return fib(10) + limit\n"
+    "}\n";
+
+TEST(X64, Generate) {
+    X64* x64 = x64_new(OutputArchAuto);
+    if(x64 == null)
+        return;     // not an x86-64 host
+    Parser* parser = parse(source);
+    Checker* checker = checker_new(2);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+    IrModule* module = ir_lower(checker);
+    opt_module(module, null);
+
+    REQUIRE_EQ(x64_generate(x64, module), 0);
+    CHECK(x64->text->len > 0);
+    CHECK(x64->bss_size == 8);
+    CHECK(x64->num_intervals > 0);
+    // Definitions are `ad_<name>`, and the program gets a C `main()`
+    X64Symbol* fib = find_symbol(x64, "ad_fib");
+    REQUIRE(fib != null);
+    CHECK(fib->is_global && fib->is_func && fib->section != 0);
+    X64Symbol* limit = find_symbol(x64, "ad_limit");
+    REQUIRE(limit != null);
+    CHECK(!limit->is_func && limit->size == 4);
+    CHECK(find_symbol(x64, "ad_limit.init") != null);
+    CHECK(find_symbol(x64, CGEN_PREFIX "init") != null);
+    CHECK(find_symbol(x64, "main") != null);
+    // Only the parts of libc that are used are referenced
+    CHECK(find_symbol(x64, "malloc") != null);
+    CHECK(find_symbol(x64, "memcmp") != null);
+
+    // Generating again gives the same code
+    StrBuilder* first = strbuilder_new(0);
+    strbuilder_append_n(first, x64->text->data, x64->text->len);
+    REQUIRE_EQ(x64_generate(x64, module), 0);
+    REQUIRE_EQ(x64->text->len, first->len);
+    CHECK(memcmp(x64->text->data, first->data, first->len) == 0);
+    strbuilder_free(first);
+
+    REQUIRE(x64_write(x64, "test_x64_out.o"));
+    char* contents = read_file("test_x64_out.o");
+    REQUIRE(contents != null);
+    CHECK(memcmp(contents, "\x7F" "ELF", 4) == 0);
+    free(contents);
+    int status = link_and_run("test_x64_out.o");
+    if(status != -1)
+        CHECK_EQ(status, 97);
+    remove("test_x64_out.o");
+
+    x64_free(x64);
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+}
+
+TEST(X64, Spills) {
+    X64* x64 = x64_new(OutputArchAuto);
+    if(x64 == null)
+        return;
+    // More values live across the call than there are callee-saved registers
+    Parser* parser = parse(
+        "func id(x: Int) -> Int { return x }\n"
+        "func f(a: Int, b: Int, c: Int, d: Int, e: Int, g: Int) -> Int {\n"
+        "    put t = id(a)\n"
+        "    put u = a * b + c * d + e * g\n"
+        "    return t + a + b + c + d + e + g + u\n"
+        "}\n"
+        "func main() -> Int { return f(1, 2, 3, 4, 5, 6) }\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+    IrModule* module = ir_lower(checker);
+
+    REQUIRE_EQ(x64_generate(x64, module), 0);
+    CHECK(x64->num_spilled > 0);
+    REQUIRE(x64_write(x64, "test_x64_spills.o"));
+    int status = link_and_run("test_x64_spills.o");
+    if(status != -1)
+        CHECK_EQ(status, 1 + 21 + 44);
+    remove("test_x64_spills.o");
+
+    x64_free(x64);
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+}
+
+TEST(X64, Unsupported) {
+    CHECK(x64_new(OutputArchArm64) == null);
+    X64* x64 = x64_new(OutputArchAmd64);
+    Parser* parser = parse("func f(x: ?Int) -> Int { return 1 }\n");
+    Checker* checker = checker_new(1);
+    REQUIRE_EQ(checker_check(checker, &parser, 1), 0);
+    IrModule* module = ir_lower(checker);
+
+    REQUIRE_EQ(x64_generate(x64, module), 1);
+    CheckerDiagnostic* diag = cast(CheckerDiagnostic*)vec_at(x64->diagnostics, 0);
+    CHECK_STREQ(diag->msg, "`f` can't be compiled to machine code yet: values of type `?Int` aren't supported");
+
+    x64_free(x64);
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+}
@@ -0,0 +1,209 @@
+#include <AdoradInternalTests/AdoradInternalTests.h>
+#include <tau/tau.h>
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif // __unix__
+TAU_MAIN()
+
+// Every implementation in strops.h (they're `static`, but the implementation is compiled into this file too), so each
+// one is tested whichever the dispatch would pick on this machine
+typedef struct Variant {
+    const char* name;
+    UInt64 (*len)(const char*);
+    char* (*find_char)(const char*, char);
+    char* (*rfind_char)(const char*, char);
+    bool (*eq)(const void*, const void*, UInt64);
+    bool (*eq_nocase)(const char*, const char*, UInt64);
+    char* (*mem_find_char)(const char*, char, UInt64);
+    char* (*mem_rfind_char)(const char*, char, UInt64);
+    void (*to_lower)(char*, const char*, UInt64);
+    void (*to_upper)(char*, const char*, UInt64);
+} Variant;
+
+static UInt64 variants(Variant* out) {
+    UInt64 n = 0;
+    out[n++] = (Variant){ "SWAR", __strops_len_swar, __strops_find_char_swar, __strops_rfind_char_swar,
+                          __strops_eq_swar, __strops_eq_nocase_swar, __strops_mem_find_char_swar,
+                          __strops_mem_rfind_char_swar, __strops_to_lower_swar, __strops_to_upper_swar };
+#if defined(CORETEN_SIMD_SSE2)
+    out[n++] = (Variant){ "SSE2", __strops_len_sse2, __strops_find_char_sse2, __strops_rfind_char_sse2,
+                          __strops_eq_sse2, __strops_eq_nocase_sse2, __strops_mem_find_char_sse2,
+                          __strops_mem_rfind_char_sse2, __strops_to_lower_sse2, __strops_to_upper_sse2 };
+#endif // CORETEN_SIMD_SSE2
+#if defined(__STROPS_HAVE_AVX2)
+    if(cpu_has_feature(CpuFeatureAVX2))
+        out[n++] = (Variant){ "AVX2", __strops_len_avx2, __strops_find_char_avx2, __strops_rfind_char_avx2,
+                              __strops_eq_avx2, __strops_eq_nocase_avx2, __strops_mem_find_char_avx2,
+                              __strops_mem_rfind_char_avx2, __strops_to_lower_avx2, __strops_to_upper_avx2 };
+#endif // __STROPS_HAVE_AVX2
+    return n;
+}
+
+static UInt64 next_random(UInt64* seed) {
+    *seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return *seed >> 33;
+}
+
+// Random bytes (none of them zero), with a few `x`s, and both halves of the byte range
+static void random_bytes(char* out, UInt64 n, UInt64* seed) {
+    for(UInt64 i = 0; i < n; i++) {
+        UInt64 r = next_random(seed);
+        out[i] = r % 8 == 0 ? 'x' : cast(char)(1 + r % 255);
+    }
+}
+
+// `buf`, rounded up to a multiple of 64 bytes
+static char* align64(char* buf) {
+    return cast(char*)((cast(uintptr_t)buf + 63) & ~cast(uintptr_t)63);
+}
+
+static char ascii_lower(char c) { return c >= 'A' && c <= 'Z' ? cast(char)(c + 32) : c; }
+static char ascii_upper(char c) { return c >= 'a' && c <= 'z' ? cast(char)(c - 32) : c; }
+
+static const char* mem_rfind_ref(const char* data, char ch, UInt64 n) {
+    for(UInt64 i = n; i > 0; i--)
+        if(data[i - 1] == ch)
+            return data + i - 1;
+    return null;
+}
+
+// Lengths around the 8-, 16-, 32- and 64-byte blocks, at every alignment
+static bool is_tested_len(UInt64 len) {
+    return len < 80 || (len >= 120 && len <= 136) || (len >= 250 && len <= 260);
+}
+
+TEST(Strops, NullTerminated) {
+    Variant vs[3];
+    UInt64 num_variants = variants(vs);
+    static char raw[512 + 128];
+    char* buf = align64(raw);
+    UInt64 seed = 1;
+    for(UInt64 v = 0; v < num_variants; v++) {
+        for(UInt64 align = 0; align < 64; align++) {
+            for(UInt64 len = 0; len < 260; len++) {
+                if(!is_tested_len(len))
+                    continue;
+                char* str = buf + align;
+                random_bytes(buf, 512 + 64, &seed);
+                str[len] = nullchar;
+                // Bytes after the terminator (and an embedded NUL) don't count
+                str[len + 1 + len % 7] = nullchar;
+
+                CHECK_EQ(vs[v].len(str), cast(UInt64)strlen(str));
+                const char needles[] = { 'x', cast(char)0xE9, nullchar, str[len / 2], str[0] };
+                for(UInt64 i = 0; i < sizeof(needles); i++) {
+                    CHECK(vs[v].find_char(str, needles[i]) == strchr(str, needles[i]));
+                    CHECK(vs[v].rfind_char(str, needles[i]) == strrchr(str, needles[i]));
+                }
+            }
+        }
+    }
+}
+
+TEST(Strops, Memory) {
+    Variant vs[3];
+    UInt64 num_variants = variants(vs);
+    static char raw_a[512 + 128];
+    static char raw_b[512 + 128];
+    char* a = align64(raw_a);
+    char* b = align64(raw_b);
+    static char got[512 + 64];
+    static char want[512 + 64];
+    UInt64 seed = 2;
+    for(UInt64 v = 0; v < num_variants; v++) {
+        for(UInt64 align = 0; align < 64; align++) {
+            for(UInt64 n = 0; n < 260; n++) {
+                if(!is_tested_len(n))
+                    continue;
+                char* x = a + align;
+                char* y = b + (align * 7) % 64;
+                random_bytes(x, n, &seed);
+                // Embedded NULs are just bytes
+                if(n > 2)
+                    x[n / 3] = nullchar;
+                memcpy(y, x, n);
+
+                CHECK(vs[v].eq(x, y, n));
+                CHECK(vs[v].eq_nocase(x, y, n));
+                for(UInt64 i = 0; i < n; i++)
+                    y[i] = i % 2 ? ascii_upper(x[i]) : ascii_lower(x[i]);
+                CHECK(vs[v].eq_nocase(x, y, n));
+                CHECK_EQ(vs[v].eq(x, y, n), memcmp(x, y, n) == 0);
+                if(n > 0) {
+                    // A difference in the last byte (which isn't a letter, so it isn't folded)
+                    UInt64 last = n - 1;
+                    char saved = y[last];
+                    y[last] = x[last] == '!' ? '?' : '!';
+                    CHECK(!vs[v].eq(x, y, n));
+                    CHECK(!vs[v].eq_nocase(x, y, n));
+                    y[last] = saved;
+                }
+
+                const char needles[] = { 'x', nullchar, cast(char)0xE9, n > 0 ? x[n - 1] : 'q' };
+                for(UInt64 i = 0; i < sizeof(needles); i++) {
+                    CHECK(vs[v].mem_find_char(x, needles[i], n) == memchr(x, needles[i], n));
+                    CHECK(vs[v].mem_rfind_char(x, needles[i], n) == mem_rfind_ref(x, needles[i], n));
+                }
+
+                // Nothing past `n` is written
+                memset(got, '#', n + 64);
+                vs[v].to_lower(got, x, n);
+                for(UInt64 i = 0; i < n; i++)
+                    want[i] = ascii_lower(x[i]);
+                memset(want + n, '#', 64);
+                CHECK(memcmp(got, want, n + 64) == 0);
+                vs[v].to_upper(got, x, n);
+                for(UInt64 i = 0; i < n; i++)
+                    want[i] = ascii_upper(x[i]);
+                CHECK(memcmp(got, want, n + 64) == 0);
+                // In place
+                memcpy(got, x, n);
+                vs[v].to_lower(got, got, n);
+                for(UInt64 i = 0; i < n; i++)
+                    want[i] = ascii_lower(x[i]);
+                CHECK(memcmp(got, want, n) == 0);
+            }
+        }
+    }
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+// The null-terminated scans read past the terminator, but never onto the next page: strings that end right before an
+// unreadable page
+TEST(Strops, PageBoundary) {
+    Variant vs[3];
+    UInt64 num_variants = variants(vs);
+    UInt64 page = cast(UInt64)sysconf(_SC_PAGESIZE);
+    char* mem = cast(char*)mmap(null, 2 * page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    REQUIRE(mem != MAP_FAILED);
+    REQUIRE_EQ(mprotect(mem + page, page, PROT_NONE), 0);
+
+    UInt64 seed = 3;
+    random_bytes(mem, page, &seed);
+    mem[page - 1] = nullchar;
+    for(UInt64 v = 0; v < num_variants; v++) {
+        for(UInt64 len = 0; len < 300; len++) {
+            char* str = mem + page - 1 - len;
+            CHECK_EQ(vs[v].len(str), len);
+            CHECK(vs[v].find_char(str, nullchar) == str + len);
+            CHECK(vs[v].find_char(str, cast(char)0xFF) == strchr(str, cast(char)0xFF));
+            CHECK(vs[v].rfind_char(str, 'x') == strrchr(str, 'x'));
+        }
+    }
+    munmap(mem, 2 * page);
+}
+#endif // __unix__
+
+TEST(Strops, Dispatch) {
+    // The public functions go through whichever implementation was picked
+    const char* str = "Hello, World";
+    CHECK_EQ(str_len(str), 12);
+    CHECK(str_find_char(str, 'o') == str + 4);
+    CHECK(str_rfind_char(str, 'o') == str + 8);
+    CHECK(str_find_char(str, 'z') == null);
+    CHECK(mem_eq_nocase(str, "hELLO, wORLD", 12));
+    char out[13] = {0};
+    mem_to_upper(out, str, 12);
+    CHECK_STREQ(out, "HELLO, WORLD");
+}
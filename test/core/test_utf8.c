@@ -0,0 +1,157 @@
+#include <AdoradInternalTests/AdoradInternalTests.h>
+#include <tau/tau.h>
+TAU_MAIN()
+
+// One character of every length
+static const char* chars[] = { "a", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80" };
+static const Rune runes[] = { 'a', 0xE9, 0x20AC, 0x1F600 };
+
+static UInt64 next_random(UInt64* seed) {
+    *seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return *seed >> 33;
+}
+
+// `len` random characters of `chars`: their UTF-8 in `out`, and which one each is in `kinds`. Returns the no. of bytes.
+static UInt64 random_text(char* out, UInt64* kinds, UInt64 len, UInt64 seed) {
+    UInt64 nbytes = 0;
+    for(UInt64 i = 0; i < len; i++) {
+        kinds[i] = next_random(&seed) % 4;
+        UInt64 n = strlen(chars[kinds[i]]);
+        memcpy(out + nbytes, chars[kinds[i]], n);
+        nbytes += n;
+    }
+    out[nbytes] = nullchar;
+    return nbytes;
+}
+
+// Every character, and its byte offset, against a walk from the start (the index is only used every
+// `UTF8_INDEX_STRIDE` characters, and its entries land in the middle of runs of multibyte characters)
+static void check_chars(cstlUTF8Str* ubuff, const UInt64* kinds, UInt64 len) {
+    REQUIRE_EQ(ubuff_len(ubuff), len);
+    UInt64 offset = 0;
+    for(UInt64 i = 0; i < len; i++) {
+        REQUIRE_EQ(ubuff_byte_offset(ubuff, i), offset);
+        REQUIRE_EQ(ubuff_at(ubuff, i), runes[kinds[i]]);
+        offset += strlen(chars[kinds[i]]);
+    }
+    REQUIRE_EQ(ubuff_nbytes(ubuff), offset);
+}
+
+TEST(UTF8, Index) {
+    static char text[4 * 1000 + 1];
+    static UInt64 kinds[1000];
+    for(UInt64 len = 0; len < 1000; len += len < 140 ? 1 : 97) {
+        random_text(text, kinds, len, len);
+        cstlUTF8Str* ubuff = ubuff_new(text);
+        check_chars(ubuff, kinds, len);
+        CHECK_STREQ(cast(char*)ubuff->data, text);
+        ubuff_free(ubuff);
+    }
+
+    // Characters pushed one at a time
+    random_text(text, kinds, 300, 7);
+    cstlUTF8Str* ubuff = ubuff_new(null);
+    CHECK_EQ(ubuff_len(ubuff), 0);
+    for(UInt64 i = 0; i < 300; i++)
+        ubuff_push_char(ubuff, runes[kinds[i]]);
+    check_chars(ubuff, kinds, 300);
+    CHECK_STREQ(cast(char*)ubuff->data, text);
+
+    // `ubuff_set()` starts over (and drops the old index)
+    ubuff_set(ubuff, "\xE2\x82\xAC" "b");
+    CHECK_EQ(ubuff_len(ubuff), 2);
+    CHECK_EQ(ubuff_at(ubuff, 0), 0x20AC);
+    CHECK_EQ(ubuff_at(ubuff, 1), 'b');
+    ubuff_free(ubuff);
+}
+
+TEST(UTF8, Append) {
+    static char text[4 * 2000 + 1];
+    static UInt64 kinds[2000];
+    UInt64 nbytes = random_text(text, kinds, 2000, 42);
+    UInt64 seed = 3;
+    for(UInt64 max_chunk = 1; max_chunk <= 300; max_chunk = max_chunk * 3 + 1) {
+        // Chunks of random sizes, split between characters, so the fast path (8 bytes at a time) sees words that
+        // start and end anywhere in the string, and index entries anywhere in a word
+        cstlUTF8Str* ubuff = ubuff_new("");
+        UInt64 start = 0;
+        UInt64 c = 0;
+        while(c < 2000) {
+            UInt64 n = 1 + next_random(&seed) % max_chunk;
+            UInt64 end = start;
+            for(UInt64 i = 0; i < n && c < 2000; i++, c++)
+                end += strlen(chars[kinds[c]]);
+            if(c % 2 == 0)
+                ubuff_append(ubuff, text + start, end - start);
+            else
+                ubuff_append_valid(ubuff, text + start, end - start);
+            start = end;
+        }
+        CHECK_EQ(ubuff_nbytes(ubuff), nbytes);
+        CHECK_STREQ(cast(char*)ubuff->data, text);
+        check_chars(ubuff, kinds, 2000);
+
+        // Appending nothing changes nothing
+        ubuff_append(ubuff, text, 0);
+        CHECK_EQ(ubuff_len(ubuff), 2000);
+        ubuff_free(ubuff);
+    }
+}
+
+TEST(UTF8, Invalid) {
+    // Each one is invalid at its first byte (the ones that are cut short are only invalid at the end of the input)
+    static const struct { const char* bytes; bool is_truncated; } invalid[] = {
+        { "\x80", false },                  // a continuation byte on its own
+        { "\xBF", false },
+        { "\xC0\x80", false },              // overlong
+        { "\xC1\xBF", false },
+        { "\xE0\x80\x80", false },
+        { "\xE0\x9F\xBF", false },
+        { "\xF0\x80\x80\x80", false },
+        { "\xF0\x8F\xBF\xBF", false },
+        { "\xED\xA0\x80", false },          // surrogates
+        { "\xED\xBF\xBF", false },
+        { "\xF4\x90\x80\x80", false },      // past U+10FFFF
+        { "\xF5\x80\x80\x80", false },
+        { "\xFF", false },
+        { "\xC3" "a", false },              // not enough continuation bytes
+        { "\xE2\x82" "a", false },
+        { "\xF0\x9F\x98" "a", false },
+        { "\xC3", true },
+        { "\xE2\x82", true },
+        { "\xF0\x9F\x98", true },
+    };
+    char text[256];
+    for(UInt64 i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        UInt64 n = strlen(invalid[i].bytes);
+        // After ASCII and after multibyte characters, at every position of a 32-byte block (and across blocks)
+        for(UInt64 pos = 0; pos < 100; pos++) {
+            for(UInt64 ascii = 0; ascii < 2; ascii++) {
+                UInt64 len = 0;
+                while(len < pos) {
+                    const char* ch = ascii || pos - len < 4 ? "x" : chars[1 + (len % 3)];
+                    memcpy(text + len, ch, strlen(ch));
+                    len += strlen(ch);
+                }
+                memcpy(text + len, invalid[i].bytes, n);
+                UInt64 nbytes = len + n;
+                if(!invalid[i].is_truncated) {
+                    memset(text + nbytes, 'y', 40);
+                    nbytes += 40;
+                }
+                CHECK(!utf8_validate(text, nbytes));
+                CHECK_EQ(utf8_invalid_offset(text, nbytes), len);
+                // Everything before it is fine
+                CHECK(utf8_validate(text, len));
+                CHECK_EQ(utf8_invalid_offset(text, len), len);
+            }
+        }
+    }
+
+    // The largest and smallest characters of every length are fine
+    static const char* valid = "\x7F\xC2\x80\xDF\xBF\xE0\xA0\x80\xED\x9F\xBF\xEE\x80\x80\xEF\xBF\xBF"
+                               "\xF0\x90\x80\x80\xF4\x8F\xBF\xBF";
+    CHECK(utf8_validate(valid, strlen(valid)));
+    CHECK_EQ(utf8_invalid_offset(valid, strlen(valid)), strlen(valid));
+    CHECK(utf8_validate(null, 0));
+}
@@ -0,0 +1,245 @@
+#include <float.h>
+#include <math.h>
+#include <AdoradInternalTests/AdoradInternalTests.h>
+#include <tau/tau.h>
+TAU_MAIN()
+
+static UInt64 next_random(UInt64* seed) {
+    *seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return *seed;
+}
+
+// `x` through a format of a single hole with `spec`, into `out`
+static const char* format_one(FormatKind kind, const char* spec, FormatArg x, char* out) {
+    FormatSpec parsed;
+    if(!format_parse_spec(spec, strlen(spec), &parsed))
+        return "<invalid spec>";
+    Format* format = format_new();
+    format_add_hole(format, kind, parsed);
+    FormatField field;
+    UInt64 len = format_length(format, &x, &field);
+    format_write(format, &x, &field, out);
+    format_free(format);
+    return strlen(out) == len ? out : "<wrong length>";
+}
+
+static const char* float64_str(double x, char* out) {
+    out[format_float64(x, out)] = nullchar;
+    return out;
+}
+
+static const char* float32_str(float x, char* out) {
+    out[format_float32(x, out)] = nullchar;
+    return out;
+}
+
+// The number of significant digits of a float written by `format_float64()`
+static int significant_digits(const char* str) {
+    int first = -1;
+    int last = -1;
+    int n = 0;
+    for(; *str != nullchar && *str != 'e'; str++) {
+        if(*str < '0' || *str > '9')
+            continue;
+        if(*str != '0') {
+            if(first < 0)
+                first = n;
+            last = n;
+        }
+        n++;
+    }
+    return first < 0 ? 1 : last - first + 1;
+}
+
+TEST(Format, Ints) {
+    char buf[32];
+    static const Int64 values[] = {0, 1, -1, 9, 10, 99, 100, 12345, -987654321, INT64_MAX, INT64_MIN};
+    for(UInt64 i = 0; i < sizeof(values)/sizeof(values[0]); i++) {
+        char expected[32];
+        snprintf(expected, sizeof(expected), "%" CORETEN_PRId64, values[i]);
+        buf[format_int(values[i], buf)] = nullchar;
+        CHECK_STREQ(buf, expected);
+    }
+    buf[format_uint(UINT64_MAX, buf)] = nullchar;
+    CHECK_STREQ(buf, "18446744073709551615");
+
+    // Every number of digits, and its neighbours
+    UInt64 x = 1;
+    for(int digits = 1; digits <= 19; digits++, x *= 10) {
+        char expected[32];
+        snprintf(expected, sizeof(expected), "%" CORETEN_PRIu64, x - 1);
+        buf[format_uint(x - 1, buf)] = nullchar;
+        CHECK_STREQ(buf, expected);
+        snprintf(expected, sizeof(expected), "%" CORETEN_PRIu64, x);
+        buf[format_uint(x, buf)] = nullchar;
+        CHECK_STREQ(buf, expected);
+    }
+}
+
+TEST(Format, ShortestFloats) {
+    char buf[32];
+    CHECK_STREQ(float64_str(1.5, buf), "1.5");
+    CHECK_STREQ(float64_str(100.0, buf), "100.0");
+    CHECK_STREQ(float64_str(0.1, buf), "0.1");
+    CHECK_STREQ(float64_str(0.1 + 0.2, buf), "0.30000000000000004");
+    CHECK_STREQ(float64_str(1.0 / 3, buf), "0.3333333333333333");
+    CHECK_STREQ(float64_str(1e15, buf), "1000000000000000.0");
+    CHECK_STREQ(float64_str(1e16, buf), "1e+16");
+    CHECK_STREQ(float64_str(0.0001, buf), "0.0001");
+    CHECK_STREQ(float64_str(2.5e-7, buf), "2.5e-07");
+    CHECK_STREQ(float64_str(0.0, buf), "0.0");
+    CHECK_STREQ(float64_str(-0.0, buf), "-0.0");
+    CHECK_STREQ(float64_str(5e-324, buf), "5e-324");
+    CHECK_STREQ(float64_str(DBL_MAX, buf), "1.7976931348623157e+308");
+    CHECK_STREQ(float64_str(NAN, buf), "nan");
+    CHECK_STREQ(float64_str(-INFINITY, buf), "-inf");
+
+    // In the precision of their type
+    CHECK_STREQ(float32_str(0.1f, buf), "0.1");
+    CHECK_STREQ(float32_str(1.0f / 3, buf), "0.33333334");
+    CHECK_STREQ(float32_str(16777216.0f, buf), "16777216.0");
+    CHECK_STREQ(float32_str(FLT_MAX, buf), "3.4028235e+38");
+    CHECK_STREQ(float32_str(1e-45f, buf), "1e-45");
+}
+
+TEST(Format, ShortestFloatsRoundTrip) {
+    // Random bit patterns: every one reads back the same, and one digit fewer never does
+    UInt64 seed = 42;
+    char buf[32];
+    char shorter[32];
+    for(int i = 0; i < 200000; i++) {
+        UInt64 bits = next_random(&seed);
+        double x;
+        memcpy(&x, &bits, sizeof(x));
+        if(!isfinite(x))
+            continue;
+        float64_str(x, buf);
+        REQUIRE(strtod(buf, null) == x);
+        int digits = significant_digits(buf);
+        if(digits > 1) {
+            snprintf(shorter, sizeof(shorter), "%.*e", digits - 2, x);
+            CHECK(strtod(shorter, null) != x);
+        }
+
+        UInt32 bits32 = cast(UInt32)(bits >> 32);
+        float f;
+        memcpy(&f, &bits32, sizeof(f));
+        if(!isfinite(f))
+            continue;
+        float32_str(f, buf);
+        REQUIRE(strtof(buf, null) == f);
+        digits = significant_digits(buf);
+        if(digits > 1) {
+            snprintf(shorter, sizeof(shorter), "%.*e", digits - 2, cast(double)f);
+            CHECK(strtof(shorter, null) != f);
+        }
+    }
+}
+
+TEST(Format, Precision) {
+    // `f` and `e` with a precision are the same as `printf()`'s, ties and all
+    UInt64 seed = 7;
+    char buf[512];
+    char expected[512];
+    char spec[16];
+    for(int i = 0; i < 100000; i++) {
+        UInt64 r = next_random(&seed);
+        double x = cast(double)(r >> 11) * 0x1.0p-53 * pow(10, cast(int)(r % 40) - 20);
+        if(i % 16 == 0)
+            x = cast(double)(r % 1000) / 8;     // exact halves, quarters and eighths
+        if(r & 1)
+            x = -x;
+        int precision = cast(int)((r >> 8) % 24);
+        FormatArg arg;
+        arg.f = x;
+        snprintf(spec, sizeof(spec), ".%df", precision);
+        snprintf(expected, sizeof(expected), "%.*f", precision, x);
+        CHECK_STREQ(format_one(FormatKindFloat64, spec, arg, buf), expected);
+        snprintf(spec, sizeof(spec), ".%de", precision);
+        snprintf(expected, sizeof(expected), "%.*e", precision, x);
+        CHECK_STREQ(format_one(FormatKindFloat64, spec, arg, buf), expected);
+    }
+}
+
+TEST(Format, Specs) {
+    char buf[128];
+    FormatArg arg;
+    arg.i = -42;
+    CHECK_STREQ(format_one(FormatKindInt, "6", arg, buf), "   -42");
+    CHECK_STREQ(format_one(FormatKindInt, "-6", arg, buf), "-42   ");
+    CHECK_STREQ(format_one(FormatKindInt, "06", arg, buf), "-00042");
+    CHECK_STREQ(format_one(FormatKindInt, "x", arg, buf), "-2a");
+    arg.i = 255;
+    CHECK_STREQ(format_one(FormatKindInt, "+", arg, buf), "+255");
+    CHECK_STREQ(format_one(FormatKindInt, "X", arg, buf), "FF");
+    CHECK_STREQ(format_one(FormatKindInt, "o", arg, buf), "377");
+    CHECK_STREQ(format_one(FormatKindInt, "010b", arg, buf), "0011111111");
+    arg.u = UINT64_MAX;
+    CHECK_STREQ(format_one(FormatKindUInt, "", arg, buf), "18446744073709551615");
+
+    arg.f = 123.4567;
+    CHECK_STREQ(format_one(FormatKindFloat64, "10", arg, buf), "  123.4567");
+    CHECK_STREQ(format_one(FormatKindFloat64, "4.2f", arg, buf), "123.46");
+    CHECK_STREQ(format_one(FormatKindFloat64, "+010.1f", arg, buf), "+0000123.5");
+    CHECK_STREQ(format_one(FormatKindFloat64, "e", arg, buf), "1.234567e+02");
+    CHECK_STREQ(format_one(FormatKindFloat64, ".0e", arg, buf), "1e+02");
+    arg.f = 1e22;
+    CHECK_STREQ(format_one(FormatKindFloat64, "f", arg, buf), "10000000000000000000000.0");
+    arg.f = NAN;
+    CHECK_STREQ(format_one(FormatKindFloat64, "06.2f", arg, buf), "   nan");
+    arg.f = 0.1f;
+    CHECK_STREQ(format_one(FormatKindFloat32, "", arg, buf), "0.1");
+    CHECK_STREQ(format_one(FormatKindFloat32, ".10f", arg, buf), "0.1000000015");
+
+    // Widths count characters, not bytes
+    arg.s.data = "h\xc3\xa9llo";
+    arg.s.len = 6;
+    CHECK_STREQ(format_one(FormatKindString, "7", arg, buf), "  h\xc3\xa9llo");
+    CHECK_STREQ(format_one(FormatKindString, "-7s", arg, buf), "h\xc3\xa9llo  ");
+    arg.i = 0x1F600;
+    CHECK_STREQ(format_one(FormatKindRune, "3", arg, buf), "  \xf0\x9f\x98\x80");
+    CHECK_STREQ(format_one(FormatKindRune, "x", arg, buf), "1f600");
+    arg.i = 1;
+    CHECK_STREQ(format_one(FormatKindBool, "-6", arg, buf), "true  ");
+
+    FormatSpec spec;
+    static const char* invalid[] = {"y", ".", ".f", "2000", "5.99f", "--q", "5 5"};
+    for(UInt64 i = 0; i < sizeof(invalid)/sizeof(invalid[0]); i++)
+        CHECK(!format_parse_spec(invalid[i], strlen(invalid[i]), &spec));
+    CHECK(format_parse_spec(" -08.3e ", 8, &spec));
+    CHECK(spec.left && spec.zero && !spec.plus && spec.width == 8 && spec.precision == 3 && spec.verb == 'e');
+    CHECK(!format_spec_accepts(spec, FormatKindInt));
+    CHECK(format_spec_accepts(spec, FormatKindFloat32));
+    format_parse_spec("x", 1, &spec);
+    CHECK(format_spec_accepts(spec, FormatKindRune));
+    CHECK(!format_spec_accepts(spec, FormatKindString));
+    format_parse_spec(".2", 2, &spec);
+    CHECK(!format_spec_accepts(spec, FormatKindFloat64));
+}
+
+TEST(Format, Template) {
+    // Text and holes, in one pass over a buffer of exactly the right length
+    Format* format = format_new();
+    format_add_text(format, "x = ", 4);
+    FormatSpec spec = {0};
+    spec.precision = -1;
+    format_add_hole(format, FormatKindInt, spec);
+    format_add_text(format, ", name = ", 9);
+    format_add_hole(format, FormatKindString, spec);
+    format_add_hole(format, FormatKindFloat64, spec);
+    format_add_text(format, "!", 1);
+
+    FormatArg args[3];
+    args[0].i = 7;
+    args[1].s.data = "abc";
+    args[1].s.len = 3;
+    args[2].f = 2.5;
+    FormatField fields[3];
+    UInt64 len = format_length(format, args, fields);
+    char* out = cast(char*)malloc(len + 1);
+    format_write(format, args, fields, out);
+    CHECK_EQ(len, strlen("x = 7, name = abc2.5!"));
+    CHECK_STREQ(out, "x = 7, name = abc2.5!");
+    free(out);
+    format_free(format);
+}
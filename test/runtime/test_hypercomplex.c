@@ -0,0 +1,258 @@
+#include <math.h>
+#include <AdoradInternalTests/AdoradInternalTests.h>
+#include <tau/tau.h>
+TAU_MAIN()
+
+static const TensorIsa isas[] = { TensorIsaScalar, TensorIsaAVX2, TensorIsaAVX512 };
+
+static double next_random(UInt64* seed) {
+    *seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return cast(double)(*seed >> 11) * 0x1.0p-53 * 4.0 - 2.0;
+}
+
+static bool near(double x, double y, double eps) {
+    return fabs(x - y) <= eps * (1.0 + fabs(y));
+}
+
+// Within `eps` of `|x|` (results of products and quotients are as accurate as that, not as their parts)
+static bool near_complex(Complex64 x, double re, double im, double eps) {
+    double scale = 1.0 + sqrt(x.re * x.re + x.im * x.im);
+    return fabs(x.re - re) <= eps * scale && fabs(x.im - im) <= eps * scale;
+}
+
+static bool near_quaternion(Quaternion256 x, double w, double i, double j, double k, double eps) {
+    double scale = 1.0 + sqrt(x.w * x.w + x.x * x.x + x.y * x.y + x.z * x.z);
+    return fabs(x.w - w) <= eps * scale && fabs(x.x - i) <= eps * scale && fabs(x.y - j) <= eps * scale &&
+           fabs(x.z - k) <= eps * scale;
+}
+
+static bool same(double x, double y) {
+    return (isnan(x) && isnan(y)) || (x == y && signbit(x) == signbit(y));
+}
+
+TEST(Hypercomplex, Complex) {
+    Complex64 a = { 3.0, -2.0 };
+    Complex64 b = { 0.5, 4.0 };
+    Complex64 r = complex64_mul(a, b);
+    CHECK(r.re == 9.5 && r.im == 11.0);
+    r = complex64_div(r, b);
+    CHECK(near(r.re, 3.0, 1e-15) && near(r.im, -2.0, 1e-15));
+    CHECK(near(complex64_abs(a), sqrt(13.0), 1e-15));
+    CHECK(complex32_abs((Complex32){ 3e30f, 4e30f }) == 5e30f);
+    r = complex64_exp((Complex64){ 1.0, acos(-1.0) / 2 });
+    CHECK(near(r.re, 0.0, 1e-15) && near(r.im, exp(1.0), 1e-15));
+    Complex32 f = complex32_exp((Complex32){ -1.0f, 3.0f });
+    CHECK(near(f.re, exp(-1.0) * cos(3.0), 1e-6) && near(f.im, exp(-1.0) * sin(3.0), 1e-6));
+    // Huge divisors don't overflow
+    Complex64 big = complex64_div((Complex64){ 1e300, 1e300 }, (Complex64){ 1e300, -1e300 });
+    CHECK(near(big.re, 0.0, 1e-15) && near(big.im, 1.0, 1e-15));
+
+    // Special values
+    r = complex64_div((Complex64){ 1.0, -2.0 }, (Complex64){ 0.0, 0.0 });
+    CHECK(r.re == INFINITY && r.im == -INFINITY);
+    CHECK(complex64_abs((Complex64){ NAN, -INFINITY }) == INFINITY);
+    CHECK(isnan(complex64_abs((Complex64){ NAN, 1.0 })));
+    CHECK(complex64_abs((Complex64){ -0.0, 0.0 }) == 0.0);
+    r = complex64_exp((Complex64){ INFINITY, 0.0 });
+    CHECK(r.re == INFINITY && r.im == 0.0);
+    r = complex64_exp((Complex64){ 0.5, -0.0 });
+    CHECK(r.re == exp(0.5) && same(r.im, -0.0));
+}
+
+TEST(Hypercomplex, Quaternions) {
+    Quaternion256 i = { 0, 1, 0, 0 }, j = { 0, 0, 1, 0 };
+    Quaternion256 k = quaternion256_mul(i, j);
+    CHECK(k.w == 0 && k.x == 0 && k.y == 0 && k.z == 1);
+    k = quaternion256_mul(j, i);
+    CHECK(k.z == -1);
+
+    Quaternion256 q = quaternion256_normalize((Quaternion256){ 1, 2, 2, 4 });
+    CHECK(q.w == 0.2 && q.x == 0.4 && q.y == 0.4 && q.z == 0.8);
+    q = quaternion256_normalize((Quaternion256){ 0, 0, 0, 0 });
+    CHECK(q.w == 0 && q.x == 0 && q.y == 0 && q.z == 0);
+
+    // A quarter turn about z takes x to y
+    double h = sqrt(0.5);
+    Quaternion256 turn = { h, 0, 0, h };
+    Quaternion256 v = quaternion256_rotate(turn, (Quaternion256){ 7, 1, 0, 3 });
+    CHECK(v.w == 0 && near(v.x, 0, 1e-15) && near(v.y, 1, 1e-15) && near(v.z, 3, 1e-15));
+
+    // Halfway to a quarter turn is an eighth of one (from either sign of the end)
+    Quaternion256 one = { 1, 0, 0, 0 };
+    Quaternion256 minus = { -h, 0, 0, -h };
+    Quaternion256 ends[] = { turn, minus };
+    for(int e = 0; e < 2; e++) {
+        Quaternion256 mid = quaternion256_slerp(one, ends[e], 0.5);
+        CHECK(near(mid.w, cos(acos(-1.0) / 8), 1e-15) && near(mid.z, sin(acos(-1.0) / 8), 1e-15));
+        CHECK(mid.x == 0 && mid.y == 0);
+    }
+    Quaternion256 start = quaternion256_slerp(one, turn, 0.0);
+    Quaternion256 end = quaternion256_slerp(one, turn, 1.0);
+    CHECK(start.w == 1 && start.z == 0);
+    CHECK(near(end.w, h, 1e-15) && near(end.z, h, 1e-15));
+    // The same rotation, and two very close ones
+    Quaternion256 same_end = quaternion256_slerp(turn, turn, 0.3);
+    CHECK(near(same_end.w, h, 1e-15) && near(same_end.z, h, 1e-15));
+    Quaternion128 a = { 1, 0, 0, 0 }, b = quaternion128_normalize((Quaternion128){ 1, 1e-6f, 0, 0 });
+    Quaternion128 c = quaternion128_slerp(a, b, 0.5f);
+    CHECK(near(c.x, 5e-7, 1e-6) && near(c.w, 1, 1e-6));
+}
+
+// `len` random elements, in tensors of `dtype` (one per part)
+static void random_parts(Tensor** parts, int count, TensorDType dtype, UInt64 len, UInt64 seed) {
+    for(int j = 0; j < count; j++) {
+        parts[j] = tensor_new(dtype, len, 0);
+        for(UInt64 i = 0; i < len; i++) {
+            TensorScalar x;
+            x.f = next_random(&seed);
+            tensor_set(parts[j], i, x);
+        }
+    }
+}
+
+static double part(Tensor* t, UInt64 i) {
+    return tensor_get(t, i).f;
+}
+
+// The batch operations compute what the functions on single values do (up to the last bits), for every kernel and
+// length
+TEST(Hypercomplex, Batch) {
+    UInt64 lens[] = { 0, 1, 7, 33, 300, 1000 };
+    for(int k = 0; k < 3; k++) {
+        if(!tensor_set_isa(isas[k]))
+            continue;
+        for(UInt64 l = 0; l < sizeof(lens) / sizeof(lens[0]); l++) {
+            UInt64 len = lens[l];
+            Tensor* p[8];
+            Tensor* r[4];
+            random_parts(p, 8, TensorDTypeFloat64, len, len + 1);
+            random_parts(r, 4, TensorDTypeFloat64, len, 0);
+            Tensor* p32[8];
+            Tensor* r32[4];
+            random_parts(p32, 8, TensorDTypeFloat32, len, len + 2);
+            random_parts(r32, 4, TensorDTypeFloat32, len, 0);
+
+            ComplexTensor a = { p[0], p[1] }, b = { p[2], p[3] }, dst = { r[0], r[1] };
+            REQUIRE(complex_tensor_mul(&dst, &a, &b));
+            for(UInt64 i = 0; i < len; i++) {
+                Complex64 x = complex64_mul((Complex64){ part(p[0], i), part(p[1], i) },
+                                            (Complex64){ part(p[2], i), part(p[3], i) });
+                CHECK(near_complex(x, part(r[0], i), part(r[1], i), 1e-15));
+            }
+            REQUIRE(complex_tensor_div(&dst, &a, &b));
+            for(UInt64 i = 0; i < len; i++) {
+                Complex64 x = complex64_div((Complex64){ part(p[0], i), part(p[1], i) },
+                                            (Complex64){ part(p[2], i), part(p[3], i) });
+                CHECK(near_complex(x, part(r[0], i), part(r[1], i), 1e-15));
+            }
+            REQUIRE(complex_tensor_abs(r[2], &a));
+            for(UInt64 i = 0; i < len; i++)
+                CHECK(near(complex64_abs((Complex64){ part(p[0], i), part(p[1], i) }), part(r[2], i), 1e-15));
+            REQUIRE(complex_tensor_exp(&dst, &a));
+            for(UInt64 i = 0; i < len; i++) {
+                Complex64 x = complex64_exp((Complex64){ part(p[0], i), part(p[1], i) });
+                CHECK(near_complex(x, part(r[0], i), part(r[1], i), 1e-15));
+            }
+
+            QuaternionTensor qa = { p[0], p[1], p[2], p[3] }, qb = { p[4], p[5], p[6], p[7] };
+            QuaternionTensor qd = { r[0], r[1], r[2], r[3] };
+            REQUIRE(quaternion_tensor_mul(&qd, &qa, &qb));
+            for(UInt64 i = 0; i < len; i++) {
+                Quaternion256 x = quaternion256_mul(
+                    (Quaternion256){ part(p[0], i), part(p[1], i), part(p[2], i), part(p[3], i) },
+                    (Quaternion256){ part(p[4], i), part(p[5], i), part(p[6], i), part(p[7], i) });
+                CHECK(near_quaternion(x, part(r[0], i), part(r[1], i), part(r[2], i), part(r[3], i), 1e-15));
+            }
+
+            // Float32s, in place: normalize, rotate, and slerp
+            QuaternionTensor fa = { p32[0], p32[1], p32[2], p32[3] }, fb = { p32[4], p32[5], p32[6], p32[7] };
+            Quaternion128* before = cast(Quaternion128*)malloc((len + 1) * sizeof(Quaternion128));
+            for(UInt64 i = 0; i < len; i++)
+                before[i] = (Quaternion128){ cast(Float32)part(p32[0], i), cast(Float32)part(p32[1], i),
+                                             cast(Float32)part(p32[2], i), cast(Float32)part(p32[3], i) };
+            REQUIRE(quaternion_tensor_normalize(&fa, &fa));
+            REQUIRE(quaternion_tensor_normalize(&fb, &fb));
+            for(UInt64 i = 0; i < len; i++) {
+                Quaternion128 x = quaternion128_normalize(before[i]);
+                CHECK(near(x.w, part(p32[0], i), 1e-6) && near(x.x, part(p32[1], i), 1e-6) &&
+                      near(x.y, part(p32[2], i), 1e-6) && near(x.z, part(p32[3], i), 1e-6));
+            }
+            QuaternionTensor rotated = { null, r32[1], r32[2], r32[3] };
+            REQUIRE(quaternion_tensor_rotate(&rotated, &fa, &fb));
+            for(UInt64 i = 0; i < len; i++) {
+                Quaternion128 q = { cast(Float32)part(p32[0], i), cast(Float32)part(p32[1], i),
+                                    cast(Float32)part(p32[2], i), cast(Float32)part(p32[3], i) };
+                Quaternion128 v = { 0, cast(Float32)part(p32[5], i), cast(Float32)part(p32[6], i),
+                                    cast(Float32)part(p32[7], i) };
+                Quaternion128 x = quaternion128_rotate(q, v);
+                CHECK(near(x.x, part(r32[1], i), 1e-5) && near(x.y, part(r32[2], i), 1e-5) &&
+                      near(x.z, part(r32[3], i), 1e-5));
+                // Rotations keep lengths
+                double in = v.x * v.x + v.y * v.y + v.z * v.z;
+                double out = x.x * x.x + x.y * x.y + x.z * x.z;
+                CHECK(near(out, in, 1e-5));
+            }
+            QuaternionTensor fd = { r32[0], r32[1], r32[2], r32[3] };
+            REQUIRE(quaternion_tensor_slerp(&fd, &fa, &fb, 0.25));
+            for(UInt64 i = 0; i < len; i++) {
+                Quaternion128 x = quaternion128_slerp(
+                    (Quaternion128){ cast(Float32)part(p32[0], i), cast(Float32)part(p32[1], i),
+                                     cast(Float32)part(p32[2], i), cast(Float32)part(p32[3], i) },
+                    (Quaternion128){ cast(Float32)part(p32[4], i), cast(Float32)part(p32[5], i),
+                                     cast(Float32)part(p32[6], i), cast(Float32)part(p32[7], i) }, 0.25f);
+                CHECK(near(x.w, part(r32[0], i), 1e-6) && near(x.x, part(r32[1], i), 1e-6) &&
+                      near(x.y, part(r32[2], i), 1e-6) && near(x.z, part(r32[3], i), 1e-6));
+            }
+            free(before);
+            for(int j = 0; j < 8; j++) {
+                tensor_free(p[j]);
+                tensor_free(p32[j]);
+            }
+            for(int j = 0; j < 4; j++) {
+                tensor_free(r[j]);
+                tensor_free(r32[j]);
+            }
+        }
+    }
+    tensor_set_isa(TensorIsaScalar);
+    tensor_isa();
+}
+
+// Slices with a step are gathered and scattered, and the elements around them are left alone
+TEST(Hypercomplex, Strided) {
+    Tensor* p[4];
+    random_parts(p, 4, TensorDTypeFloat64, 2000, 9);
+    Tensor* before = tensor_clone(p[1]);
+    Tensor views[4];
+    for(int j = 0; j < 4; j++)
+        REQUIRE(tensor_slice(&views[j], p[j], 1, 2000, 3));
+    ComplexTensor a = { &views[0], &views[1] }, b = { &views[2], &views[3] };
+    Tensor* expected_re = tensor_new(TensorDTypeFloat64, views[0].len, 0);
+    Tensor* expected_im = tensor_new(TensorDTypeFloat64, views[0].len, 0);
+    for(UInt64 i = 0; i < views[0].len; i++) {
+        Complex64 x = complex64_mul((Complex64){ part(&views[0], i), part(&views[1], i) },
+                                    (Complex64){ part(&views[2], i), part(&views[3], i) });
+        tensor_set(expected_re, i, (TensorScalar){ .f = x.re });
+        tensor_set(expected_im, i, (TensorScalar){ .f = x.im });
+    }
+    REQUIRE(complex_tensor_mul(&a, &a, &b));
+    for(UInt64 i = 0; i < views[0].len; i++) {
+        Complex64 x = { part(&views[0], i), part(&views[1], i) };
+        CHECK(near_complex(x, part(expected_re, i), part(expected_im, i), 1e-15));
+    }
+    for(UInt64 i = 0; i < 2000; i++)
+        if(i % 3 != 1)
+            CHECK(part(p[1], i) == part(before, i));
+
+    // Only floats
+    Tensor* ints = tensor_new(TensorDTypeInt32, 10, 0);
+    ComplexTensor c = { ints, ints };
+    CHECK(!complex_tensor_abs(ints, &c));
+
+    tensor_free(ints);
+    tensor_free(expected_re);
+    tensor_free(expected_im);
+    tensor_free(before);
+    for(int j = 0; j < 4; j++)
+        tensor_free(p[j]);
+}
@@ -0,0 +1,227 @@
+#include <math.h>
+#include <AdoradInternalTests/AdoradInternalTests.h>
+#include <tau/tau.h>
+TAU_MAIN()
+
+static UInt64 next_random(UInt64* seed) {
+    *seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return *seed >> 16;
+}
+
+// Do the entries of `map` hold exactly the keys `k` with `present[k]`, each with the value `values[k]`?
+static bool has_exactly(Map* map, const bool* present, const Int64* values, UInt64 n) {
+    UInt64 expected = 0;
+    for(UInt64 k = 0; k < n; k++)
+        expected += present[k];
+    if(map->len != expected)
+        return false;
+    bool* seen = cast(bool*)calloc(n + 1, sizeof(bool));
+    bool ok = true;
+    for(UInt64 i = 0; ok && i < map->len; i++) {
+        Int64 k = map->entries.ints[i].key;
+        ok = k >= 0 && cast(UInt64)k < n && present[k] && !seen[k] && map->entries.ints[i].value.i == values[k];
+        if(ok)
+            seen[k] = true;
+    }
+    free(seen);
+    return ok;
+}
+
+TEST(Map, Ints) {
+    Map* map = map_new(MapKeyInt, 0);
+    CHECK(map_find_int(map, 1) == null);
+    CHECK(!map_delete_int(map, 1));
+
+    // Keys that are multiples of a power of 2 (the ones a weak hash puts in the same slots)
+    UInt64 n = 20000;
+    for(UInt64 k = 0; k < n; k++) {
+        bool inserted;
+        MapValue* value = map_insert_int(map, cast(Int64)(k << 12), &inserted);
+        CHECK(inserted && value->i == 0);
+        value->i = cast(Int64)k * 3;
+    }
+    CHECK_EQ(map->len, n);
+    for(UInt64 k = 0; k < n; k++) {
+        MapValue* value = map_find_int(map, cast(Int64)(k << 12));
+        REQUIRE(value != null);
+        CHECK_EQ(value->i, cast(Int64)k * 3);
+        CHECK(map_find_int(map, cast(Int64)(k << 12) + 1) == null);
+    }
+    bool inserted = true;
+    map_insert_int(map, 5 << 12, &inserted)->i += 1;
+    CHECK(!inserted);
+    CHECK_EQ(map_find_int(map, 5 << 12)->i, 16);
+
+    // Extreme keys
+    map_insert_int(map, INT64_MIN, null)->i = -1;
+    map_insert_int(map, INT64_MAX, null)->i = 1;
+    CHECK_EQ(map_find_int(map, INT64_MIN)->i, -1);
+    CHECK_EQ(map_find_int(map, INT64_MAX)->i, 1);
+
+    // Every other key, then every key
+    for(UInt64 k = 0; k < n; k += 2)
+        CHECK(map_delete_int(map, cast(Int64)(k << 12)));
+    CHECK(!map_delete_int(map, 0));
+    CHECK_EQ(map->len, n / 2 + 2);
+    for(UInt64 k = 0; k < n; k++)
+        CHECK((map_find_int(map, cast(Int64)(k << 12)) != null) == (k % 2 == 1));
+    for(UInt64 k = 1; k < n; k += 2)
+        CHECK(map_delete_int(map, cast(Int64)(k << 12)));
+    CHECK(map_delete_int(map, INT64_MIN) && map_delete_int(map, INT64_MAX));
+    CHECK_EQ(map->len, 0);
+    CHECK(map_find_int(map, 1 << 12) == null);
+
+    map_insert_int(map, 7, null)->i = 70;
+    map_clear(map);
+    CHECK_EQ(map->len, 0);
+    CHECK(map_find_int(map, 7) == null);
+    map_insert_int(map, 7, null)->i = 71;
+    CHECK_EQ(map_find_int(map, 7)->i, 71);
+    map_free(map);
+}
+
+// Random insertions and deletions (with lots of tombstones) against an array of every key
+TEST(Map, Churn) {
+    UInt64 n = 3000;
+    bool* present = cast(bool*)calloc(n, sizeof(bool));
+    Int64* values = cast(Int64*)calloc(n, sizeof(Int64));
+    Map* map = map_new(MapKeyInt, 0);
+    UInt64 seed = 42;
+    for(UInt64 round = 0; round < 200000; round++) {
+        UInt64 k = next_random(&seed) % n;
+        UInt64 op = next_random(&seed) % 3;
+        if(op == 0) {
+            CHECK_EQ(map_delete_int(map, cast(Int64)k), present[k]);
+            present[k] = false;
+        } else {
+            bool inserted;
+            MapValue* value = map_insert_int(map, cast(Int64)k, &inserted);
+            CHECK_EQ(inserted, !present[k]);
+            value->i = values[k] = cast(Int64)round;
+            present[k] = true;
+        }
+        if(round % 20000 == 0)
+            CHECK(has_exactly(map, present, values, n));
+    }
+    CHECK(has_exactly(map, present, values, n));
+    for(UInt64 k = 0; k < n; k++) {
+        MapValue* value = map_find_int(map, cast(Int64)k);
+        CHECK((value != null) == present[k]);
+        if(value != null)
+            CHECK_EQ(value->i, values[k]);
+    }
+    // Mostly tombstones, so it never needed more than a table for `n` keys
+    CHECK(map->cap < 4 * n);
+    map_free(map);
+    free(present);
+    free(values);
+}
+
+TEST(Map, Floats) {
+    Map* map = map_new(MapKeyFloat, 4);
+    map_insert_float(map, 1.5, null)->i = 1;
+    map_insert_float(map, -0.0, null)->i = 2;
+    map_insert_float(map, NAN, null)->i = 3;
+    map_insert_float(map, INFINITY, null)->i = 4;
+    CHECK_EQ(map->len, 4);
+    CHECK_EQ(map_find_float(map, 1.5)->i, 1);
+    CHECK_EQ(map_find_float(map, 0.0)->i, 2);
+    CHECK(!signbit(map->entries.floats[1].key));
+    CHECK_EQ(map_find_float(map, -NAN)->i, 3);
+    CHECK_EQ(map_find_float(map, INFINITY)->i, 4);
+    CHECK(map_find_float(map, -INFINITY) == null);
+    CHECK(map_find_float(map, 1.5000000000000002) == null);
+    bool inserted = true;
+    map_insert_float(map, 0.0, &inserted);
+    CHECK(!inserted);
+    CHECK(map_delete_float(map, NAN));
+    CHECK(map_find_float(map, NAN) == null);
+    CHECK_EQ(map->len, 3);
+    map_free(map);
+}
+
+TEST(Map, Strings) {
+    Map* map = map_new(MapKeyString, 0);
+    // Around `MAP_SMALL_STRING`, and around the lengths the hash loads differently
+    char key[100];
+    for(UInt64 len = 0; len < sizeof(key); len++) {
+        for(UInt64 i = 0; i < len; i++)
+            key[i] = cast(char)('a' + (i * 7 + len) % 26);
+        bool inserted;
+        map_insert_string(map, key, len, &inserted)->u = len;
+        CHECK(inserted);
+    }
+    // The map keeps copies of the keys
+    memset(key, 'z', sizeof(key));
+    CHECK_EQ(map->len, sizeof(key));
+    for(UInt64 len = 0; len < sizeof(key); len++) {
+        for(UInt64 i = 0; i < len; i++)
+            key[i] = cast(char)('a' + (i * 7 + len) % 26);
+        MapValue* value = map_find_string(map, key, len);
+        REQUIRE(value != null);
+        CHECK_EQ(value->u, len);
+        const MapString* s = &map->entries.strings[len].key;
+        CHECK_EQ(s->len, len);
+        CHECK(memcmp(map_string_data(s), key, len) == 0 && map_string_data(s)[len] == '\0');
+        // Same length, one byte off (at either end)
+        if(len > 0) {
+            key[len - 1] = '#';
+            CHECK(map_find_string(map, key, len) == null);
+            key[0] = '#';
+            CHECK(map_find_string(map, key, len) == null);
+        }
+    }
+
+    // Keys with zero bytes in them, and keys that are prefixes of each other
+    map_clear(map);
+    map_insert_string(map, "ab\0cd", 5, null)->i = 1;
+    map_insert_string(map, "ab\0ce", 5, null)->i = 2;
+    map_insert_string(map, "ab", 2, null)->i = 3;
+    map_insert_string(map, "", 0, null)->i = 4;
+    CHECK_EQ(map_find_string(map, "ab\0cd", 5)->i, 1);
+    CHECK_EQ(map_find_string(map, "ab\0ce", 5)->i, 2);
+    CHECK_EQ(map_find_string(map, "ab", 2)->i, 3);
+    CHECK_EQ(map_find_string(map, "", 0)->i, 4);
+    CHECK(map_find_string(map, "a", 1) == null);
+
+    // Deleting moves the last entry (here, a long key) into the hole
+    const char* long_key = "a key that's too long to be kept in its entry";
+    map_insert_string(map, long_key, strlen(long_key), null)->i = 5;
+    CHECK(map_delete_string(map, "ab\0cd", 5));
+    CHECK_EQ(map->len, 4);
+    CHECK(map_find_string(map, "ab\0cd", 5) == null);
+    CHECK_EQ(map_find_string(map, long_key, strlen(long_key))->i, 5);
+    CHECK(strcmp(map_string_data(&map->entries.strings[0].key), long_key) == 0);
+    CHECK(map_delete_string(map, long_key, strlen(long_key)));
+    CHECK(!map_delete_string(map, long_key, strlen(long_key)));
+    map_free(map);
+}
+
+TEST(Map, Reserve) {
+    Map* map = map_new(MapKeyString, 1000);
+    CHECK(map->cap >= 1000);
+    // Inserting as many entries as there's room for never rebuilds the table
+    Byte* ctrl = map->ctrl;
+    MapStringEntry* entries = map->entries.strings;
+    char key[32];
+    for(Int64 k = 0; k < 1000; k++) {
+        int len = snprintf(key, sizeof(key), "user:%" CORETEN_PRId64, k * 7919);
+        map_insert_string(map, key, cast(UInt64)len, null)->i = k;
+    }
+    CHECK(map->ctrl == ctrl && map->entries.strings == entries);
+    for(Int64 k = 0; k < 1000; k++) {
+        int len = snprintf(key, sizeof(key), "user:%" CORETEN_PRId64, k * 7919);
+        MapValue* value = map_find_string(map, key, cast(UInt64)len);
+        REQUIRE(value != null);
+        CHECK_EQ(value->i, k);
+    }
+
+    UInt64 cap = map->cap;
+    map_reserve(map, 10);
+    CHECK_EQ(map->cap, cap);
+    map_reserve(map, 5000);
+    CHECK(map->cap >= 5000);
+    CHECK_EQ(map->len, 1000);
+    CHECK_EQ(map_find_string(map, "user:0", 6)->i, 0);
+    map_free(map);
+}
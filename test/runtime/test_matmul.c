@@ -0,0 +1,129 @@
+#include <AdoradInternalTests/AdoradInternalTests.h>
+#include <tau/tau.h>
+TAU_MAIN()
+
+// An `m x n` matrix of small integers (so that every product is exact, whatever order its sums are taken in)
+static Tensor* random_matrix(TensorDType dtype, UInt64 m, UInt64 n, UInt64 seed) {
+    UInt64 shape[2] = { m, n };
+    Tensor* tensor = tensor_new_shape(dtype, 2, shape);
+    for(UInt64 i = 0; i < m * n; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        TensorScalar x;
+        x.f = cast(double)(cast(Int64)(seed >> 33) % 9 - 4);
+        tensor_set(tensor, i, x);
+    }
+    return tensor;
+}
+
+static Tensor* naive_matmul(Tensor* a, Tensor* b) {
+    UInt64 m = a->shape[0];
+    UInt64 k = a->shape[1];
+    UInt64 n = b->shape[1];
+    UInt64 shape[2] = { m, n };
+    Tensor* c = tensor_new_shape(a->dtype, 2, shape);
+    for(UInt64 i = 0; i < m; i++) {
+        for(UInt64 j = 0; j < n; j++) {
+            TensorScalar sum;
+            sum.f = 0;
+            for(UInt64 p = 0; p < k; p++)
+                sum.f += tensor_get(a, i * k + p).f * tensor_get(b, p * n + j).f;
+            tensor_set(c, i * n + j, sum);
+        }
+    }
+    return c;
+}
+
+static bool matrices_equal(Tensor* a, Tensor* b) {
+    if(a->rank != 2 || b->rank != 2 || a->shape[0] != b->shape[0] || a->shape[1] != b->shape[1])
+        return false;
+    for(UInt64 i = 0; i < a->len; i++)
+        if(tensor_get(a, i).f != tensor_get(b, i).f)
+            return false;
+    return true;
+}
+
+// Every kernel, with and without a pool, for shapes with edge tiles, several panels of `A` (`k > MATMUL_KC`) and
+// several blocks of `B`
+TEST(Matmul, Shapes) {
+    UInt64 shapes[][3] = {
+        {1, 1, 1}, {7, 5, 3}, {6, 8, 16}, {13, 300, 17}, {150, 20, 70}, {64, 64, 64}, {3, 513, 4200},
+    };
+    TensorIsa isas[] = { TensorIsaScalar, TensorIsaAVX2, TensorIsaAVX512 };
+    TensorDType dtypes[] = { TensorDTypeFloat32, TensorDTypeFloat64 };
+    ThreadPool* pool = threadpool_new(4);
+    for(UInt64 s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++) {
+        UInt64 m = shapes[s][0];
+        UInt64 k = shapes[s][1];
+        UInt64 n = shapes[s][2];
+        for(int d = 0; d < 2; d++) {
+            Tensor* a = random_matrix(dtypes[d], m, k, 1);
+            Tensor* b = random_matrix(dtypes[d], k, n, 2);
+            Tensor* expected = naive_matmul(a, b);
+            Tensor* c = tensor_new(dtypes[d], 0, 0);
+            for(int i = 0; i < 3; i++) {
+                if(!tensor_set_isa(isas[i]))
+                    continue;
+                REQUIRE(tensor_matmul(c, a, b, null));
+                CHECK(matrices_equal(c, expected));
+                tensor_fill(c, a->dtype == TensorDTypeFloat32 ? tensor_get(a, 0) : tensor_get(b, 0));
+                REQUIRE(tensor_matmul(c, a, b, pool));
+                CHECK(matrices_equal(c, expected));
+            }
+            tensor_free(a);
+            tensor_free(b);
+            tensor_free(expected);
+            tensor_free(c);
+        }
+    }
+    threadpool_free(pool);
+    tensor_set_isa(TensorIsaScalar);
+    tensor_isa();
+}
+
+TEST(Matmul, Operands) {
+    Tensor* a = random_matrix(TensorDTypeFloat64, 20, 10, 3);
+    Tensor* b = random_matrix(TensorDTypeFloat64, 10, 10, 4);
+    Tensor* c = tensor_new(TensorDTypeFloat64, 0, 0);
+
+    // Every other element of `a`, as a 10 x 10 matrix
+    Tensor strided = *a;
+    strided.len = 100;
+    strided.cap = 0;
+    strided.stride = 2;
+    UInt64 square[2] = { 10, 10 };
+    REQUIRE(tensor_reshape(&strided, 2, square));
+    Tensor* contiguous = tensor_new(TensorDTypeFloat64, 0, 0);
+    tensor_append(contiguous, &strided);
+    REQUIRE(tensor_reshape(contiguous, 2, square));
+    Tensor* expected = naive_matmul(contiguous, b);
+    REQUIRE(tensor_matmul(c, &strided, b, null));
+    CHECK(matrices_equal(c, expected));
+
+    // An `m x 0` matrix times a `0 x n` one is all zeroes
+    Tensor* empty_a = random_matrix(TensorDTypeFloat64, 4, 0, 5);
+    Tensor* empty_b = random_matrix(TensorDTypeFloat64, 0, 5, 6);
+    REQUIRE(tensor_matmul(c, empty_a, empty_b, null));
+    CHECK(c->rank == 2 && c->shape[0] == 4 && c->shape[1] == 5);
+    for(UInt64 i = 0; i < c->len; i++)
+        CHECK(tensor_get(c, i).f == 0.0);
+
+    // Shapes that don't match, vectors, integers and mixed dtypes
+    CHECK(!tensor_matmul(c, a, a, null));
+    Tensor* vector = tensor_new(TensorDTypeFloat64, 10, 0);
+    CHECK(!tensor_matmul(c, vector, b, null));
+    Tensor* ints = tensor_new_shape(TensorDTypeInt64, 2, square);
+    CHECK(!tensor_matmul(ints, ints, ints, null));
+    Tensor* floats = tensor_new_shape(TensorDTypeFloat32, 2, square);
+    CHECK(!tensor_matmul(c, floats, b, null));
+
+    tensor_free(floats);
+    tensor_free(ints);
+    tensor_free(vector);
+    tensor_free(empty_a);
+    tensor_free(empty_b);
+    tensor_free(expected);
+    tensor_free(contiguous);
+    tensor_free(a);
+    tensor_free(b);
+    tensor_free(c);
+}
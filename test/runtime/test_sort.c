@@ -0,0 +1,222 @@
+#include <math.h>
+#include <AdoradInternalTests/AdoradInternalTests.h>
+#include <tau/tau.h>
+TAU_MAIN()
+
+static UInt64 next_random(UInt64* seed) {
+    *seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return *seed >> 16;
+}
+
+// `len` random elements, over the whole range of `dtype` (or, with `distinct` > 0, out of that many values)
+static Tensor* random_tensor(TensorDType dtype, UInt64 len, UInt64 distinct, UInt64 seed) {
+    Tensor* tensor = tensor_new(dtype, len, 0);
+    for(UInt64 i = 0; i < len; i++) {
+        UInt64 r = next_random(&seed);
+        TensorScalar x;
+        if(distinct > 0) {
+            x.i = cast(Int64)(r % distinct) - 3;
+            if(tensor_dtype_is_float(dtype))
+                x.f = cast(double)x.i;
+        } else {
+            switch(dtype) {
+                case TensorDTypeInt16: x.i = cast(Int16)r; break;
+                case TensorDTypeInt32: x.i = cast(Int32)r; break;
+                case TensorDTypeInt64: x.i = cast(Int64)(r << 16 ^ next_random(&seed)); break;
+                default: x.f = (cast(double)(r % 2000001) - 1000000.0) / 64.0; break;
+            }
+        }
+        tensor_set(tensor, i, x);
+    }
+    return tensor;
+}
+
+static int compare_ints(const void* a, const void* b) {
+    Int64 x = *cast(const Int64*)a;
+    Int64 y = *cast(const Int64*)b;
+    return (x > y) - (x < y);
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *cast(const double*)a;
+    double y = *cast(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Is `sorted` `tensor` (before it was sorted), sorted?
+static bool is_sorted_copy(Tensor* tensor, Tensor* sorted, bool descending) {
+    UInt64 n = tensor->len;
+    bool is_float = tensor_dtype_is_float(tensor->dtype);
+    TensorScalar* expected = cast(TensorScalar*)malloc((n + 1) * sizeof(TensorScalar));
+    for(UInt64 i = 0; i < n; i++)
+        expected[i] = tensor_get(tensor, i);
+    qsort(expected, n, sizeof(TensorScalar), is_float ? compare_doubles : compare_ints);
+    bool ok = sorted->len == n;
+    for(UInt64 i = 0; ok && i < n; i++) {
+        TensorScalar x = tensor_get(sorted, i);
+        TensorScalar y = expected[descending ? n - 1 - i : i];
+        ok = is_float ? x.f == y.f : x.i == y.i;
+    }
+    free(expected);
+    return ok;
+}
+
+TEST(Sort, DTypes) {
+    // Both sides of `SORT_RADIX_MIN`
+    UInt64 lens[] = { 0, 1, 2, 10, 100, 255, 256, 1000, 5000 };
+    for(int d = 0; d < TensorNumDTypes; d++) {
+        for(UInt64 l = 0; l < sizeof(lens) / sizeof(lens[0]); l++) {
+            for(int descending = 0; descending < 2; descending++) {
+                Tensor* tensor = random_tensor(cast(TensorDType)d, lens[l], 0, lens[l] + cast(UInt64)d);
+                Tensor* sorted = tensor_clone(tensor);
+                tensor_sort(sorted, descending, null);
+                CHECK(is_sorted_copy(tensor, sorted, descending));
+                tensor_free(tensor);
+                tensor_free(sorted);
+            }
+        }
+    }
+}
+
+TEST(Sort, Floats) {
+    double nan = NAN;
+    double inf = INFINITY;
+    double values[] = { nan, 1.0, -0.0, 0.0, -inf, inf, -nan, -1.0 };
+    for(int d = TensorDTypeFloat32; d <= TensorDTypeFloat64; d++) {
+        Tensor* tensor = tensor_new(cast(TensorDType)d, 0, 0);
+        for(int i = 0; i < 8; i++) {
+            TensorScalar x;
+            x.f = values[i];
+            tensor_push(tensor, x);
+        }
+        // NaNs go last (and lose their sign), and -0 goes before 0
+        tensor_sort(tensor, false, null);
+        double ascending[] = { -inf, -1.0, -0.0, 0.0, 1.0, inf };
+        for(int i = 0; i < 6; i++)
+            CHECK(tensor_get(tensor, cast(UInt64)i).f == ascending[i]);
+        CHECK(signbit(tensor_get(tensor, 2).f) && !signbit(tensor_get(tensor, 3).f));
+        for(UInt64 i = 6; i < 8; i++)
+            CHECK(isnan(tensor_get(tensor, i).f) && !signbit(tensor_get(tensor, i).f));
+
+        tensor_sort(tensor, true, null);
+        CHECK(isnan(tensor_get(tensor, 0).f) && isnan(tensor_get(tensor, 1).f));
+        for(int i = 0; i < 6; i++)
+            CHECK(tensor_get(tensor, cast(UInt64)(7 - i)).f == ascending[i]);
+        CHECK(!signbit(tensor_get(tensor, 4).f) && signbit(tensor_get(tensor, 5).f));
+        tensor_free(tensor);
+    }
+}
+
+// Sorting a slice only moves its own elements
+TEST(Sort, Strided) {
+    for(UInt64 len = 30; len <= 3000; len *= 10) {
+        Tensor* tensor = random_tensor(TensorDTypeInt32, len, 0, len);
+        Tensor* before = tensor_clone(tensor);
+        Tensor view;
+        REQUIRE(tensor_slice(&view, tensor, 1, len, 3));
+        Tensor* expected = tensor_clone(&view);
+        tensor_sort(&view, false, null);
+        CHECK(is_sorted_copy(expected, &view, false));
+        for(UInt64 i = 0; i < len; i++)
+            if(i % 3 != 1)
+                CHECK_EQ(tensor_get(tensor, i).i, tensor_get(before, i).i);
+        tensor_free(expected);
+        tensor_free(before);
+        tensor_free(tensor);
+    }
+}
+
+TEST(Sort, Parallel) {
+    ThreadPool* pool = threadpool_new(5);
+    UInt64 len = 3 * SORT_PARALLEL_MIN + 17;
+    TensorDType dtypes[] = { TensorDTypeInt16, TensorDTypeInt64, TensorDTypeFloat64 };
+    for(int d = 0; d < 3; d++) {
+        for(int descending = 0; descending < 2; descending++) {
+            Tensor* tensor = random_tensor(dtypes[d], len, 0, cast(UInt64)d + 100);
+            Tensor* sorted = tensor_clone(tensor);
+            tensor_sort(sorted, descending, pool);
+            CHECK(is_sorted_copy(tensor, sorted, descending));
+            tensor_free(tensor);
+            tensor_free(sorted);
+        }
+    }
+    threadpool_free(pool);
+}
+
+// Elements with the same key keep their order, whichever way the keys are sorted
+static bool is_sorted_by_key(Tensor* values, Tensor* keys, bool descending) {
+    for(UInt64 i = 1; i < values->len; i++) {
+        Int64 prev = tensor_get(keys, cast(UInt64)tensor_get(values, i - 1).i).i;
+        Int64 key = tensor_get(keys, cast(UInt64)tensor_get(values, i).i).i;
+        if(descending ? prev < key : prev > key)
+            return false;
+        if(prev == key && tensor_get(values, i - 1).i >= tensor_get(values, i).i)
+            return false;
+    }
+    return true;
+}
+
+TEST(Sort, ByKey) {
+    ThreadPool* pool = threadpool_new(4);
+    UInt64 lens[] = { 0, 1, 50, 1000, 2 * SORT_PARALLEL_MIN + 5 };
+    for(UInt64 l = 0; l < sizeof(lens) / sizeof(lens[0]); l++) {
+        for(int descending = 0; descending < 2; descending++) {
+            // Element `i` is `i`, so it says which key it had
+            UInt64 len = lens[l];
+            Tensor* keys = random_tensor(TensorDTypeInt32, len, 7, len);
+            Tensor* values = tensor_new(TensorDTypeInt64, 0, 0);
+            for(UInt64 i = 0; i < len; i++) {
+                TensorScalar x;
+                x.i = cast(Int64)i;
+                tensor_push(values, x);
+            }
+            REQUIRE(tensor_sort_by_key(values, keys, descending, pool));
+            CHECK(is_sorted_by_key(values, keys, descending));
+            tensor_free(keys);
+            tensor_free(values);
+        }
+    }
+
+    Tensor* values = tensor_new(TensorDTypeFloat32, 3, 0);
+    Tensor* keys = tensor_new(TensorDTypeInt16, 2, 0);
+    CHECK(!tensor_sort_by_key(values, keys, false, null));
+    tensor_free(values);
+    tensor_free(keys);
+    threadpool_free(pool);
+}
+
+#define INT_LESS(x, y)      ((x) < (y))
+SORT_DEFINE_PDQ(pdq_ints, Int64, INT_LESS)
+
+// The inputs that make naive quicksorts quadratic (sorted, reversed, equal elements, organ pipes, sawtooths, and
+// "median-of-3 killers"), against qsort
+TEST(Sort, Pdqsort) {
+    UInt64 lens[] = { 0, 1, 5, 24, 25, 128, 129, 1000, 20000 };
+    for(UInt64 l = 0; l < sizeof(lens) / sizeof(lens[0]); l++) {
+        UInt64 n = lens[l];
+        Int64* data = cast(Int64*)malloc((n + 1) * sizeof(Int64));
+        Int64* expected = cast(Int64*)malloc((n + 1) * sizeof(Int64));
+        for(int pattern = 0; pattern < 7; pattern++) {
+            UInt64 seed = n;
+            for(UInt64 i = 0; i < n; i++) {
+                Int64 k = cast(Int64)i;
+                Int64 len = cast(Int64)n;
+                switch(pattern) {
+                    case 0: data[i] = k; break;
+                    case 1: data[i] = len - k; break;
+                    case 2: data[i] = 42; break;
+                    case 3: data[i] = k < len / 2 ? k : len - k; break;
+                    case 4: data[i] = k % 17; break;
+                    case 5: data[i] = k % 2 == 0 ? k : len / 2 + k; break;
+                    default: data[i] = cast(Int64)(next_random(&seed) % 1000); break;
+                }
+            }
+            memcpy(expected, data, n * sizeof(Int64));
+            qsort(expected, n, sizeof(Int64), compare_ints);
+            pdq_ints(data, n);
+            CHECK(n == 0 || memcmp(data, expected, n * sizeof(Int64)) == 0);
+        }
+        free(data);
+        free(expected);
+    }
+}
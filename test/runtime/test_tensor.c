@@ -0,0 +1,329 @@
+#include <AdoradInternalTests/AdoradInternalTests.h>
+#include <tau/tau.h>
+TAU_MAIN()
+
+static TensorScalar int_scalar(Int64 i) {
+    TensorScalar s;
+    s.i = i;
+    return s;
+}
+
+static TensorScalar float_scalar(double f) {
+    TensorScalar s;
+    s.f = f;
+    return s;
+}
+
+// A tensor of `n` pseudo-random elements (in a small range, so that comparisons go both ways)
+static Tensor* random_tensor(TensorDType dtype, UInt64 n, UInt64 seed) {
+    Tensor* tensor = tensor_new(dtype, n, 0);
+    for(UInt64 i = 0; i < n; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        Int64 x = cast(Int64)(seed >> 33) % 200 - 100;
+        tensor_set(tensor, i, tensor_dtype_is_float(dtype) ? float_scalar(cast(double)x / 4) : int_scalar(x));
+    }
+    return tensor;
+}
+
+static bool tensors_equal(Tensor* a, Tensor* b) {
+    if(a->len != b->len)
+        return false;
+    for(UInt64 i = 0; i < a->len; i++) {
+        TensorScalar x = tensor_get(a, i);
+        TensorScalar y = tensor_get(b, i);
+        if(tensor_dtype_is_float(a->dtype) ? x.f != y.f : x.i != y.i)
+            return false;
+    }
+    return true;
+}
+
+TEST(Tensor, Append) {
+    Tensor* tensor = tensor_new(TensorDTypeInt32, 0, 0);
+    CHECK(tensor->cap == 0);
+    tensor_push(tensor, int_scalar(1));
+    CHECK(tensor->cap == 8);
+    for(Int64 i = 2; i <= 9; i++)
+        tensor_push(tensor, int_scalar(i));
+    CHECK(tensor->len == 9);
+    CHECK(tensor->cap == 16);
+    CHECK((cast(UInt64)tensor->data & 63) == 0);
+    // Appending a tensor to itself
+    tensor_append(tensor, tensor);
+    REQUIRE(tensor->len == 18);
+    for(UInt64 i = 0; i < 18; i++)
+        CHECK_EQ(tensor_get(tensor, i).i, cast(Int64)(i % 9 + 1));
+    // Values wrap around to the element type
+    tensor_push(tensor, int_scalar(0x100000005));
+    CHECK_EQ(tensor_get(tensor, 18).i, 5);
+    tensor_free(tensor);
+
+    // `{cap: N}` doesn't grow until it's full
+    tensor = tensor_new(TensorDTypeFloat64, 2, 100);
+    CHECK(tensor->len == 2 && tensor->cap == 100);
+    CHECK(tensor_get(tensor, 1).f == 0.0);
+    Byte* data = tensor->data;
+    for(UInt64 i = 0; i < 98; i++)
+        tensor_push(tensor, float_scalar(0.5));
+    CHECK(tensor->data == data);
+    tensor_push(tensor, float_scalar(0.5));
+    CHECK(tensor->cap == 200);
+    tensor_fill(tensor, float_scalar(-1.5));
+    for(UInt64 i = 0; i < tensor->len; i++)
+        CHECK(tensor_get(tensor, i).f == -1.5);
+    tensor_free(tensor);
+}
+
+// Every instruction set gives what the scalar kernels give, for every dtype, operation and length
+TEST(Tensor, Kernels) {
+    TensorIsa isas[] = { TensorIsaAVX2, TensorIsaAVX512 };
+    UInt64 lengths[] = { 0, 1, 7, 31, 64, 200, 1027 };
+    for(UInt64 k = 0; k < 2; k++) {
+        if(!tensor_set_isa(isas[k]))
+            continue;
+        for(int dtype = 0; dtype < TensorNumDTypes; dtype++) {
+            for(UInt64 l = 0; l < 7; l++) {
+                UInt64 n = lengths[l];
+                Tensor* a = random_tensor(dtype, n, 1);
+                Tensor* b = random_tensor(dtype, n, 2);
+                // No zero divisors
+                for(UInt64 i = 0; i < n; i++)
+                    if(tensor_dtype_is_float(dtype) ? tensor_get(b, i).f == 0 : tensor_get(b, i).i == 0)
+                        tensor_set(b, i, tensor_dtype_is_float(dtype) ? float_scalar(3) : int_scalar(3));
+                Tensor* expected = tensor_new(dtype, n, 0);
+                Tensor* got = tensor_new(dtype, n, 0);
+                UInt64 words = n / 64 + 1;
+                UInt64* expected_mask = cast(UInt64*)calloc(words, sizeof(UInt64));
+                UInt64* got_mask = cast(UInt64*)calloc(words, sizeof(UInt64));
+
+                TensorScalar seven = tensor_dtype_is_float(dtype) ? float_scalar(7) : int_scalar(7);
+                for(int op = TensorOpAdd; op <= TensorOpMax; op++) {
+                    tensor_set_isa(TensorIsaScalar);
+                    REQUIRE(tensor_arith(expected, a, b, op));
+                    tensor_set_isa(isas[k]);
+                    REQUIRE(tensor_arith(got, a, b, op));
+                    CHECK(tensors_equal(expected, got));
+
+                    tensor_set_isa(TensorIsaScalar);
+                    REQUIRE(tensor_arith_scalar(expected, a, seven, op));
+                    tensor_set_isa(isas[k]);
+                    REQUIRE(tensor_arith_scalar(got, a, seven, op));
+                    CHECK(tensors_equal(expected, got));
+                }
+                for(int cmp = TensorCmpEq; cmp <= TensorCmpGe; cmp++) {
+                    tensor_set_isa(TensorIsaScalar);
+                    UInt64 expected_count = tensor_compare(a, b, cmp, expected_mask);
+                    tensor_set_isa(isas[k]);
+                    CHECK_EQ(tensor_compare(a, b, cmp, got_mask), expected_count);
+                    CHECK(memcmp(expected_mask, got_mask, words * sizeof(UInt64)) == 0);
+                }
+                for(int op = TensorReduceSum; op <= TensorReduceMax; op++) {
+                    TensorScalar expected_result, got_result;
+                    tensor_set_isa(TensorIsaScalar);
+                    bool ok = tensor_reduce(a, op, &expected_result);
+                    tensor_set_isa(isas[k]);
+                    CHECK(tensor_reduce(a, op, &got_result) == ok);
+                    // The elements are multiples of 1/4, so float sums are exact in any order
+                    if(ok)
+                        CHECK(memcmp(&expected_result, &got_result, sizeof(TensorScalar)) == 0);
+                }
+                if(n > 0) {
+                    TensorScalar last = tensor_get(a, n - 1);
+                    Int64 index = tensor_index_of(a, last);
+                    CHECK(index >= 0 && index <= cast(Int64)(n - 1));
+                    tensor_set_isa(TensorIsaScalar);
+                    CHECK_EQ(tensor_index_of(a, last), index);
+                }
+
+                free(expected_mask);
+                free(got_mask);
+                tensor_free(a);
+                tensor_free(b);
+                tensor_free(expected);
+                tensor_free(got);
+            }
+        }
+    }
+    tensor_set_isa(TensorIsaScalar);
+    tensor_isa();
+}
+
+TEST(Tensor, Semantics) {
+    Tensor* a = tensor_new(TensorDTypeInt16, 3, 0);
+    Tensor* b = tensor_new(TensorDTypeInt16, 3, 0);
+    tensor_set(a, 0, int_scalar(-32768));
+    tensor_set(a, 1, int_scalar(32767));
+    tensor_set(a, 2, int_scalar(10));
+    tensor_fill(b, int_scalar(-1));
+    // Integers wrap around
+    REQUIRE(tensor_arith(a, a, b, TensorOpDiv));
+    CHECK_EQ(tensor_get(a, 0).i, -32768);
+    CHECK_EQ(tensor_get(a, 1).i, -32767);
+    REQUIRE(tensor_arith_scalar(a, a, int_scalar(-2), TensorOpSub));
+    CHECK_EQ(tensor_get(a, 0).i, -32766);
+    CHECK_EQ(tensor_get(a, 2).i, -8);
+    // Dividing by 0 fails (and leaves `dst` alone)
+    tensor_set(b, 2, int_scalar(0));
+    CHECK(!tensor_arith(a, a, b, TensorOpDiv));
+    CHECK(!tensor_arith_scalar(a, a, int_scalar(0x10000), TensorOpDiv));
+    CHECK_EQ(tensor_get(a, 2).i, -8);
+
+    // Values out of range are in no tensor, and greater or less than all of its elements
+    UInt64 mask = 0;
+    CHECK_EQ(tensor_index_of(a, int_scalar(-8)), 2);
+    CHECK_EQ(tensor_index_of(a, int_scalar(-8 + 0x10000)), -1);
+    CHECK_EQ(tensor_compare_scalar(a, int_scalar(40000), TensorCmpLt, &mask), 3);
+    CHECK(mask == 7);
+    CHECK_EQ(tensor_compare_scalar(a, int_scalar(40000), TensorCmpGe, &mask), 0);
+    CHECK_EQ(tensor_compare_scalar(a, int_scalar(-8), TensorCmpEq, &mask), 1);
+    CHECK(mask == 4);
+
+    TensorScalar result;
+    Tensor* empty = tensor_new(TensorDTypeInt16, 0, 0);
+    CHECK(!tensor_reduce(empty, TensorReduceMax, &result));
+    CHECK(tensor_reduce(empty, TensorReduceSum, &result) && result.i == 0);
+    tensor_free(empty);
+    CHECK(tensor_reduce(a, TensorReduceMin, &result));
+    CHECK_EQ(result.i, -32766);
+    tensor_free(a);
+    tensor_free(b);
+}
+
+// Tensors that aren't contiguous (every other element of a buffer) take the scalar path
+TEST(Tensor, Strided) {
+    Tensor* buffer = random_tensor(TensorDTypeFloat32, 100, 3);
+    Tensor strided = *buffer;
+    strided.len = 50;
+    strided.cap = 0;
+    strided.stride = 2;
+    Tensor* contiguous = tensor_new(TensorDTypeFloat32, 0, 0);
+    tensor_append(contiguous, &strided);
+    REQUIRE(contiguous->len == 50);
+    for(UInt64 i = 0; i < 50; i++)
+        CHECK(tensor_get(contiguous, i).f == tensor_get(buffer, 2 * i).f);
+
+    TensorScalar x, y;
+    REQUIRE(tensor_reduce(&strided, TensorReduceSum, &x));
+    REQUIRE(tensor_reduce(contiguous, TensorReduceSum, &y));
+    CHECK(x.f == y.f);
+    CHECK_EQ(tensor_index_of(&strided, tensor_get(buffer, 98)), tensor_index_of(contiguous, tensor_get(buffer, 98)));
+
+    REQUIRE(tensor_arith_scalar(&strided, &strided, float_scalar(2.0), TensorOpMul));
+    REQUIRE(tensor_arith_scalar(contiguous, contiguous, float_scalar(2.0), TensorOpMul));
+    CHECK(tensors_equal(&strided, contiguous));
+    // The elements in between are untouched
+    Tensor* original = random_tensor(TensorDTypeFloat32, 100, 3);
+    for(UInt64 i = 1; i < 100; i += 2)
+        CHECK(tensor_get(buffer, i).f == tensor_get(original, i).f);
+
+    tensor_free(original);
+    tensor_free(contiguous);
+    tensor_free(buffer);
+}
+
+// A tensor of several dimensions is one buffer, in row-major order
+TEST(Tensor, Shape) {
+    UInt64 shape[] = {2, 3, 4};
+    Tensor* tensor = tensor_new_shape(TensorDTypeInt64, 3, shape);
+    REQUIRE(tensor->len == 24);
+    CHECK(tensor->rank == 3 && tensor->stride == 1);
+    CHECK(tensor_dim(tensor, 0) == 2 && tensor_dim(tensor, 1) == 3 && tensor_dim(tensor, 2) == 4);
+    for(UInt64 i = 0; i < 24; i++)
+        tensor_set(tensor, i, int_scalar(cast(Int64)i));
+    // [1][2][3]
+    CHECK_EQ(tensor_get(tensor, (1 * 3 + 2) * 4 + 3).i, 23);
+    TensorScalar sum;
+    REQUIRE(tensor_reduce(tensor, TensorReduceSum, &sum));
+    CHECK_EQ(sum.i, 23 * 24 / 2);
+
+    // Reshaping keeps the elements where they are
+    UInt64 matrix[] = {6, 4};
+    REQUIRE(tensor_reshape(tensor, 2, matrix));
+    CHECK(tensor->rank == 2 && tensor_dim(tensor, 0) == 6 && tensor_get(tensor, 5 * 4 + 3).i == 23);
+    UInt64 wrong[] = {5, 5};
+    CHECK(!tensor_reshape(tensor, 2, wrong));
+    CHECK(!tensor_reshape(tensor, TENSOR_MAX_RANK + 1, shape));
+    CHECK(tensor->rank == 2 && tensor_dim(tensor, 1) == 4);
+    UInt64 flat = 24;
+    REQUIRE(tensor_reshape(tensor, 1, &flat));
+    CHECK(tensor_dim(tensor, 0) == 24);
+    tensor_push(tensor, int_scalar(24));
+    CHECK(tensor->len == 25);
+    tensor_free(tensor);
+
+    // Dimensions of length 0
+    UInt64 empty_shape[] = {3, 0};
+    Tensor* empty = tensor_new_shape(TensorDTypeFloat32, 2, empty_shape);
+    CHECK(empty->len == 0 && tensor_dim(empty, 0) == 3 && tensor_dim(empty, 1) == 0);
+    tensor_free(empty);
+}
+
+// Slices share the elements of the tensor they're sliced from
+TEST(Tensor, Slices) {
+    Tensor* tensor = random_tensor(TensorDTypeInt32, 20, 4);
+    Tensor view;
+    // (On the heap, so that `tensor_free()` can free it once it owns its elements)
+    Tensor* every_third = cast(Tensor*)calloc(1, sizeof(Tensor));
+    REQUIRE(tensor_slice(&view, tensor, 2, 12, 1));
+    CHECK(view.len == 10 && view.cap == 0 && view.stride == 1);
+    CHECK(view.data == tensor->data + 2 * sizeof(Int32));
+    tensor_set(&view, 0, int_scalar(1000));
+    CHECK_EQ(tensor_get(tensor, 2).i, 1000);
+
+    // A slice of a slice is a slice of the tensor: elements 3, 6 and 9 of `view` are 5, 8 and 11 of `tensor`
+    REQUIRE(tensor_slice(every_third, &view, 3, 10, 3));
+    REQUIRE(every_third->len == 3);
+    CHECK(every_third->stride == 3);
+    for(UInt64 i = 0; i < 3; i++)
+        CHECK_EQ(tensor_get(every_third, i).i, tensor_get(tensor, 5 + 3 * i).i);
+    REQUIRE(tensor_arith_scalar(every_third, every_third, int_scalar(0), TensorOpMul));
+    CHECK(tensor_get(tensor, 8).i == 0 && tensor_get(tensor, 11).i == 0);
+
+    Tensor empty;
+    CHECK(tensor_slice(&empty, tensor, 20, 20, 1) && empty.len == 0);
+    CHECK(tensor_slice(&empty, tensor, 0, 20, 100) && empty.len == 1);
+    CHECK(!tensor_slice(&empty, tensor, 5, 4, 1));
+    CHECK(!tensor_slice(&empty, tensor, 0, 21, 1));
+    CHECK(!tensor_slice(&empty, tensor, 0, 4, 0));
+
+    // A clone owns its elements, and so does a slice once it's appended to
+    Tensor* clone = tensor_clone(every_third);
+    CHECK(clone->len == 3 && clone->cap >= 3 && clone->stride == 1);
+    tensor_set(clone, 0, int_scalar(7));
+    CHECK_EQ(tensor_get(tensor, 5).i, 0);
+    tensor_push(every_third, int_scalar(42));
+    CHECK(every_third->cap > 0 && every_third->stride == 1 && every_third->len == 4);
+    tensor_set(every_third, 1, int_scalar(9));
+    CHECK_EQ(tensor_get(tensor, 8).i, 0);
+    CHECK_EQ(tensor_get(every_third, 3).i, 42);
+    tensor_free(clone);
+    tensor_free(every_third);
+
+    UInt64 shape[] = {3, 2};
+    Tensor* matrix = tensor_new_shape(TensorDTypeFloat64, 2, shape);
+    CHECK(!tensor_slice(&empty, matrix, 0, 2, 1));
+    clone = tensor_clone(matrix);
+    CHECK(clone->rank == 2 && tensor_dim(clone, 0) == 3 && tensor_dim(clone, 1) == 2);
+    tensor_free(clone);
+    tensor_free(matrix);
+    tensor_free(tensor);
+}
+
+// Growing a tensor moves its elements, but the buffers its slices see stay alive until the tensor is freed
+TEST(Tensor, SliceThenGrow) {
+    Tensor* xs = tensor_new(TensorDTypeInt64, 0, 0);
+    for(Int64 i = 0; i < 8; i++)
+        tensor_push(xs, int_scalar(i));
+    Tensor view;
+    REQUIRE(tensor_slice(&view, xs, 1, 4, 1));
+    tensor_push(xs, int_scalar(8));
+    CHECK(view.data != xs->data + sizeof(Int64));
+    CHECK(tensor_get(&view, 0).i == 1 && tensor_get(&view, 2).i == 3);
+
+    // Appending a slice of a tensor to the tensor itself reads the slice after the tensor has moved
+    REQUIRE(tensor_slice(&view, xs, 0, 9, 1));
+    tensor_append(xs, &view);
+    REQUIRE(xs->len == 18);
+    for(Int64 i = 0; i < 18; i++)
+        CHECK_EQ(tensor_get(xs, cast(UInt64)i).i, i % 9);
+    tensor_free(xs);
+}
@@ -0,0 +1,256 @@
+#include <math.h>
+#include <AdoradInternalTests/AdoradInternalTests.h>
+#include <tau/tau.h>
+TAU_MAIN()
+
+static const TensorIsa isas[] = { TensorIsaScalar, TensorIsaAVX2, TensorIsaAVX512 };
+
+static double next_random(UInt64* seed) {
+    *seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return cast(double)(*seed >> 11) * 0x1.0p-53;
+}
+
+// The arguments every function is checked on: `x` in `[lo, hi]` (or `e^x`, with `log`), and `y` in `[-ylim, ylim]`
+typedef struct MathCase {
+    TensorMath fn;
+    double lo, hi;
+    double ylim;
+    // The error bounds in vmath.h
+    double ulps32, ulps64;
+} MathCase;
+
+static const MathCase cases[] = {
+    { TensorMathSin,    -4096.0, 4096.0,   0.0,   2.0, 2.0 },
+    { TensorMathSin,    -8.0,    8.0,      0.0,   2.0, 2.0 },
+    { TensorMathCos,    -4096.0, 4096.0,   0.0,   2.0, 2.0 },
+    { TensorMathTan,    -4096.0, 4096.0,   0.0,   4.0, 3.0 },
+    { TensorMathExp,    -104.0,  89.0,     0.0,   1.0, 1.0 },
+    { TensorMathExp,    -750.0,  710.0,    0.0,   1.0, 1.0 },
+    { TensorMathLog,    -90.0,   90.0,     0.0,   1.0, 1.0 },
+    { TensorMathLog2,   -745.0,  709.0,    0.0,   1.0, 1.0 },
+    { TensorMathPow,    -8.0,    8.0,      30.0,  1.0, 2.0 },
+    { TensorMathAtan2,  -100.0,  100.0,    100.0, 3.0, 2.0 },
+};
+
+static double reference(TensorMath fn, long double x, long double y) {
+    switch(fn) {
+        case TensorMathSin: return sinl(x);
+        case TensorMathCos: return cosl(x);
+        case TensorMathTan: return tanl(x);
+        case TensorMathExp: return expl(x);
+        case TensorMathLog: return logl(x);
+        case TensorMathLog2: return log2l(x);
+        case TensorMathPow: return powl(x, y);
+        default: return atan2l(x, y);
+    }
+}
+
+// `got`'s distance from `exact`, in units of the last place of a float with `bits` bits of mantissa
+static double ulps(double got, long double exact, int bits, int min_exp) {
+    if(isnan(got) || isinf(got) || isinf(cast(double)exact))
+        return got == cast(double)exact ? 0.0 : INFINITY;
+    int e;
+    frexpl(exact, &e);
+    long double ulp = ldexpl(1.0L, e - bits < min_exp ? min_exp : e - bits);
+    return cast(double)(fabsl(cast(long double)got - exact) / ulp);
+}
+
+TEST(Vmath, Accuracy) {
+    UInt64 n = 4099;
+    Float32* a32 = cast(Float32*)malloc(n * sizeof(Float32));
+    Float32* b32 = cast(Float32*)malloc(n * sizeof(Float32));
+    Float32* d32 = cast(Float32*)malloc(n * sizeof(Float32));
+    Float64* a64 = cast(Float64*)malloc(n * sizeof(Float64));
+    Float64* b64 = cast(Float64*)malloc(n * sizeof(Float64));
+    Float64* d64 = cast(Float64*)malloc(n * sizeof(Float64));
+    for(int k = 0; k < 3; k++) {
+        if(!tensor_set_isa(isas[k]))
+            continue;
+        for(UInt64 c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+            MathCase mc = cases[c];
+            UInt64 seed = c + 1;
+            for(UInt64 i = 0; i < n; i++) {
+                double x = mc.lo + (mc.hi - mc.lo) * next_random(&seed);
+                double y = mc.ylim * (2.0 * next_random(&seed) - 1.0);
+                if(mc.fn == TensorMathLog || mc.fn == TensorMathLog2)
+                    x = exp(x);
+                // Negative numbers, to integral powers
+                if(mc.fn == TensorMathPow && i % 4 == 0) {
+                    x = -exp(x);
+                    y = round(y);
+                } else if(mc.fn == TensorMathPow) {
+                    x = exp(x);
+                }
+                a64[i] = x;
+                b64[i] = y;
+                a32[i] = cast(Float32)x;
+                b32[i] = cast(Float32)y;
+            }
+            vmath_f32(mc.fn, d32, a32, b32, n);
+            vmath_f64(mc.fn, d64, a64, b64, n);
+            double max32 = 0.0, max64 = 0.0;
+            for(UInt64 i = 0; i < n; i++) {
+                // Float32s against the exact result rounded to a Float64 (after its own rounding to a Float32, when
+                // that overflows or underflows to zero)
+                double exact32 = reference(mc.fn, a32[i], b32[i]);
+                Float32 rounded = cast(Float32)exact32;
+                if(isinf(rounded) || rounded == 0.0f)
+                    exact32 = rounded;
+                double err32 = ulps(d32[i], exact32, 24, -149);
+                double err64 = ulps(d64[i], reference(mc.fn, a64[i], b64[i]), 53, -1074);
+                max32 = err32 > max32 ? err32 : max32;
+                max64 = err64 > max64 ? err64 : max64;
+            }
+            CHECK(max32 <= mc.ulps32);
+            CHECK(max64 <= mc.ulps64);
+        }
+    }
+    tensor_set_isa(TensorIsaScalar);
+    tensor_isa();
+    free(a32);
+    free(b32);
+    free(d32);
+    free(a64);
+    free(b64);
+    free(d64);
+}
+
+static bool same(double x, double y) {
+    return (isnan(x) && isnan(y)) || (x == y && signbit(x) == signbit(y));
+}
+
+// Within an ULP, when the results are finite
+static bool within(double got, double expected, double eps) {
+    if(same(got, expected))
+        return true;
+    return isfinite(expected) && isfinite(got) && fabs(got - expected) <= eps * fabs(expected);
+}
+
+// Zeroes, infinities, NaNs, subnormals, and the limits of `exp` give C's results
+TEST(Vmath, SpecialValues) {
+    double values[] = {
+        0.0, -0.0, 1.0, -1.0, 2.0, -2.0, 0.5, -3.0, INFINITY, -INFINITY, NAN, 1e-310, -1e-310, 0x1.0p-1074, 1e-40,
+        1e308, -1e308, 709.8, 710.0, -745.2, -746.0, 89.0, -104.0
+    };
+    int n = sizeof(values) / sizeof(values[0]);
+    for(int k = 0; k < 3; k++) {
+        if(!tensor_set_isa(isas[k]))
+            continue;
+        for(int fn = TensorMathSin; fn <= TensorMathAtan2; fn++) {
+            bool binary = fn == TensorMathPow || fn == TensorMathAtan2;
+            for(int i = 0; i < n; i++) {
+                for(int j = 0; j < (binary ? n : 1); j++) {
+                    Float64 x = values[i], y = values[j], r64;
+                    Float32 xf = cast(Float32)x, yf = cast(Float32)y, r32;
+                    vmath_f64(cast(TensorMath)fn, &r64, &x, &y, 1);
+                    vmath_f32(cast(TensorMath)fn, &r32, &xf, &yf, 1);
+                    double expected64, expected32;
+                    switch(fn) {
+                        case TensorMathSin: expected64 = sin(x); expected32 = sinf(xf); break;
+                        case TensorMathCos: expected64 = cos(x); expected32 = cosf(xf); break;
+                        case TensorMathTan: expected64 = tan(x); expected32 = tanf(xf); break;
+                        case TensorMathExp: expected64 = exp(x); expected32 = expf(xf); break;
+                        case TensorMathLog: expected64 = log(x); expected32 = logf(xf); break;
+                        case TensorMathLog2: expected64 = log2(x); expected32 = log2f(xf); break;
+                        case TensorMathPow: expected64 = pow(x, y); expected32 = powf(xf, yf); break;
+                        default: expected64 = atan2(x, y); expected32 = atan2f(xf, yf); break;
+                    }
+                    CHECK(within(r64, expected64, 0x1.0p-51));
+                    CHECK(within(r32, expected32, 0x1.0p-22));
+                }
+            }
+        }
+    }
+    tensor_set_isa(TensorIsaScalar);
+    tensor_isa();
+}
+
+// Every length (and so every number of leftover elements) gives what the elements give one at a time
+TEST(Vmath, Tails) {
+    Float32 a32[40], b32[40], d32[40];
+    Float64 a64[40], b64[40], d64[40];
+    for(int i = 0; i < 40; i++) {
+        a32[i] = 0.25f + cast(Float32)i * 0.5f;
+        b32[i] = 1.5f - cast(Float32)i * 0.125f;
+        a64[i] = a32[i];
+        b64[i] = b32[i];
+    }
+    for(int k = 0; k < 3; k++) {
+        if(!tensor_set_isa(isas[k]))
+            continue;
+        for(int fn = TensorMathSin; fn <= TensorMathAtan2; fn++) {
+            for(UInt64 n = 0; n <= 33; n++) {
+                for(int i = 0; i < 40; i++) {
+                    d32[i] = -7.0f;
+                    d64[i] = -7.0;
+                }
+                vmath_f32(cast(TensorMath)fn, d32 + 1, a32 + 1, b32 + 1, n);
+                vmath_f64(cast(TensorMath)fn, d64 + 1, a64 + 1, b64 + 1, n);
+                CHECK(d32[0] == -7.0f && d32[n + 1] == -7.0f);
+                CHECK(d64[0] == -7.0 && d64[n + 1] == -7.0);
+                for(UInt64 i = 1; i <= n; i++) {
+                    Float32 r32;
+                    Float64 r64;
+                    vmath_f32(cast(TensorMath)fn, &r32, a32 + i, b32 + i, 1);
+                    vmath_f64(cast(TensorMath)fn, &r64, a64 + i, b64 + i, 1);
+                    CHECK(same(d32[i], r32));
+                    CHECK(same(d64[i], r64));
+                }
+            }
+        }
+    }
+    tensor_set_isa(TensorIsaScalar);
+    tensor_isa();
+}
+
+TEST(Vmath, Tensors) {
+    for(int d = TensorDTypeFloat32; d <= TensorDTypeFloat64; d++) {
+        Tensor* x = tensor_new(cast(TensorDType)d, 100, 0);
+        Tensor* y = tensor_new(cast(TensorDType)d, 100, 0);
+        for(UInt64 i = 0; i < 100; i++) {
+            TensorScalar v;
+            v.f = 0.5 + cast(double)i / 8.0;
+            tensor_set(x, i, v);
+            v.f = 3.0 - cast(double)i / 16.0;
+            tensor_set(y, i, v);
+        }
+        double eps = d == TensorDTypeFloat32 ? 0x1.0p-21 : 0x1.0p-50;
+
+        Tensor* dst = tensor_new(cast(TensorDType)d, 100, 0);
+        REQUIRE(tensor_math(dst, x, null, TensorMathExp));
+        for(UInt64 i = 0; i < 100; i++)
+            CHECK(within(tensor_get(dst, i).f, exp(tensor_get(x, i).f), eps));
+        REQUIRE(tensor_math(dst, x, y, TensorMathPow));
+        for(UInt64 i = 0; i < 100; i++)
+            CHECK(within(tensor_get(dst, i).f, pow(tensor_get(x, i).f, tensor_get(y, i).f), eps));
+
+        // Slices with a step, in place
+        Tensor* copy = tensor_clone(x);
+        Tensor view;
+        REQUIRE(tensor_slice(&view, x, 3, 93, 3));
+        REQUIRE(tensor_math(&view, &view, &view, TensorMathAtan2));
+        for(UInt64 i = 0; i < 100; i++) {
+            double v = tensor_get(copy, i).f;
+            double expected = i >= 3 && i < 93 && i % 3 == 0 ? atan2(v, v) : v;
+            CHECK(within(tensor_get(x, i).f, expected, eps));
+        }
+        tensor_free(copy);
+        tensor_free(dst);
+        tensor_free(x);
+        tensor_free(y);
+    }
+
+    // Only floats
+    Tensor* ints = tensor_new(TensorDTypeInt32, 10, 0);
+    CHECK(!tensor_math(ints, ints, null, TensorMathSin));
+    tensor_free(ints);
+}
+
+TEST(Vmath, CoreMath) {
+    CHECK_EQ(coreten_square(3.0f), 9.0f);
+    CHECK(coreten_arctan2(1.0f, 0.0f) == atan2f(1.0f, 0.0f));
+    CHECK(coreten_arctan2(0.0f, -1.0f) == atan2f(0.0f, -1.0f));
+    CHECK(coreten_exp(1.0f) == expf(1.0f));
+    CHECK(coreten_log(10.0f) == logf(10.0f));
+    CHECK(coreten_pow(2.0f, 0.5f) == powf(2.0f, 0.5f));
+}
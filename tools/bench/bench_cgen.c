@@ -0,0 +1,105 @@
+// Microbenchmark: the C backend (adorad/compiler/cgen.h) on a generated program, with 1..N threads, against writing
+// the same output line by line with `fprintf()`.
+// Usage: bench_cgen [num-functions] [max-threads] [num-units]
+#include <adorad/adorad.h>
+
+static char* make_program(UInt64 num_funcs) {
+    static const char* body =
+        "    put mutable acc: Int64 = 0\n"
+        "    put mutable i = 0\n"
+        "    if a > b && !false { acc += a * 3 + b } else if a < 0 { acc -= (a - b) % 7 } else { acc = 1 }\n"
+        "    match a { when 0..4 => { i += 1 } when 9 => { i -= 1 } }\n"
+        "    i += limit << 2\n"
+        "    return acc + f%" CORETEN_PRIu64 "(a, b - 1)\n";
+    UInt64 cap = 256 + num_funcs * 512;
+    char* data = cast(char*)malloc(cap);
+    CORETEN_ENFORCE_NN(data, "Could not allocate memory. Memory full.");
+
+    UInt64 len = cast(UInt64)snprintf(data, cap, "put limit = 16\n");
+    for(UInt64 i = 0; i < num_funcs; i++) {
+        len += cast(UInt64)snprintf(data + len, cap - len, "func f%" CORETEN_PRIu64 "(a: Int, b: Int) -> Int64 {\n", i);
+        len += cast(UInt64)snprintf(data + len, cap - len, body, (i + 1) % num_funcs);
+        len += cast(UInt64)snprintf(data + len, cap - len, "}\n");
+    }
+    return data;
+}
+
+// What writing the output would cost with one `fprintf()` per line
+static double write_per_line(CGen* gen) {
+    double start = clock_monotonic();
+    for(UInt64 i = 0; i < vec_size(gen->units); i++) {
+        char path[64];
+        snprintf(path, sizeof(path), "bench_cgen_lines_%" CORETEN_PRIu64 ".c", i);
+        FILE* file = fopen(path, "wb");
+        CORETEN_ENFORCE_NN(file, "Could not open the output file");
+
+        char* line = (*cast(StrBuilder**)vec_at(gen->units, i))->data;
+        while(*line) {
+            char* end = strchr(line, '\n');
+            int len = cast(int)(SOME(end) ? end - line : cast(long)strlen(line));
+            fprintf(file, "%.*s\n", len, line);
+            line += len + (SOME(end) ? 1 : 0);
+        }
+        fclose(file);
+        remove(path);
+    }
+    return clock_monotonic() - start;
+}
+
+int main(int argc, char** argv) {
+    UInt64 num_funcs = argc > 1 ? cast(UInt64)atoll(argv[1]) : 20000;
+    UInt32 max_threads = argc > 2 ? cast(UInt32)atoi(argv[2]) : 8;
+    UInt32 num_units = argc > 3 ? cast(UInt32)atoi(argv[3]) : 8;
+    if(num_funcs == 0)
+        num_funcs = 1;
+    if(num_units == 0)
+        num_units = 1;
+
+    char* source = make_program(num_funcs);
+    Lexer* lexer = lexer_init(source, "bench.ad");
+    lexer_lex(lexer);
+    Parser* parser = parser_init(lexer);
+    parser_parse(parser);
+    Checker* checker = checker_new(0);
+    CORETEN_ENFORCE(checker_check(checker, &parser, 1) == 0, "The generated program should type check");
+    printf("%" CORETEN_PRIu64 " functions, %u translation units\n", num_funcs, num_units);
+
+    double base = 0;
+    for(UInt32 threads = 1; threads <= max_threads; threads *= 2) {
+        CGen* gen = cgen_new(threads, num_units);
+        // The second build reuses the buffers of the first one
+        for(int build = 0; build < 2; build++) {
+            double start = clock_monotonic();
+            CORETEN_ENFORCE(cgen_generate(gen, checker, "bench_cgen") == 0, "The program should be supported");
+            double generated = clock_monotonic() - start;
+            CORETEN_ENFORCE(cgen_write(gen, ""), "Could not write the output");
+            double written = clock_monotonic() - start - generated;
+            if(threads == 1 && build == 1)
+                base = generated;
+
+            UInt64 bytes = gen->header->len;
+            for(UInt64 i = 0; i < vec_size(gen->units); i++)
+                bytes += (*cast(StrBuilder**)vec_at(gen->units, i))->len;
+            printf("%2u thread(s) %s   generate %8.2f ms   write %7.2f ms   (%.1f MB/s)", threads,
+                   build == 0 ? "cold" : "warm", generated * 1e3, written * 1e3, cast(double)bytes / 1e6 / written);
+            if(build == 1)
+                printf("   (%.2fx)", base / generated);
+            printf("\n");
+        }
+        if(threads == 1)
+            printf("   per-line fprintf() of the same output: %7.2f ms\n", write_per_line(gen) * 1e3);
+
+        remove("bench_cgen.h");
+        for(UInt32 i = 0; i < num_units; i++) {
+            char path[64];
+            snprintf(path, sizeof(path), "bench_cgen_%u.c", i);
+            remove(path);
+        }
+        cgen_free(gen);
+    }
+
+    checker_free(checker);
+    parser_free(parser);
+    free(source);
+    return 0;
+}
@@ -0,0 +1,58 @@
+// Microbenchmark: the type checker (adorad/compiler/checker.h) on a generated program, with 1..N threads.
+// Usage: bench_checker [num-functions] [max-threads]
+#include <adorad/adorad.h>
+
+// `num_funcs` functions, each with a body that keeps the checker busy for a little while
+static char* make_program(UInt64 num_funcs) {
+    static const char* body =
+        "    put mutable acc: Int64 = 0\n"
+        "    put mutable i = 0\n"
+        "    if a > b && !false { acc += a * 3 + b } else if a < 0 { acc -= (a - b) % 7 } else { acc = 1 }\n"
+        "    put scaled = scale * 2.5 + 1.0\n"
+        "    i += limit << 2\n"
+        "    return acc + f%" CORETEN_PRIu64 "(a, b - 1)\n";
+    UInt64 cap = 256 + num_funcs * 512;
+    char* data = cast(char*)malloc(cap);
+    CORETEN_ENFORCE_NN(data, "Could not allocate memory. Memory full.");
+
+    UInt64 len = cast(UInt64)snprintf(data, cap, "put scale: Float64 = 1.5\nput limit = 16\n");
+    for(UInt64 i = 0; i < num_funcs; i++) {
+        len += cast(UInt64)snprintf(data + len, cap - len, "func f%" CORETEN_PRIu64 "(a: Int, b: Int) -> Int64 {\n", i);
+        len += cast(UInt64)snprintf(data + len, cap - len, body, (i + 1) % num_funcs);
+        len += cast(UInt64)snprintf(data + len, cap - len, "}\n");
+    }
+    return data;
+}
+
+int main(int argc, char** argv) {
+    UInt64 num_funcs = argc > 1 ? cast(UInt64)atoll(argv[1]) : 20000;
+    UInt32 max_threads = argc > 2 ? cast(UInt32)atoi(argv[2]) : 8;
+    if(num_funcs == 0)
+        num_funcs = 1;
+
+    char* source = make_program(num_funcs);
+    Lexer* lexer = lexer_init(source, "bench.ad");
+    lexer_lex(lexer);
+    Parser* parser = parser_init(lexer);
+    parser_parse(parser);
+    printf("%" CORETEN_PRIu64 " functions\n", num_funcs);
+
+    double base = 0;
+    for(UInt32 threads = 1; threads <= max_threads; threads *= 2) {
+        Checker* checker = checker_new(threads);
+        double start = clock_monotonic();
+        UInt64 num_errors = checker_check(checker, &parser, 1);
+        double elapsed = clock_monotonic() - start;
+        CORETEN_ENFORCE(num_errors == 0, "The generated program should type check");
+        if(threads == 1)
+            base = elapsed;
+
+        printf("%2u thread(s)   %8.2f ms   %10.0f functions/s   (%.2fx)\n", threads, elapsed * 1e3,
+               cast(double)num_funcs / elapsed, base / elapsed);
+        checker_free(checker);
+    }
+
+    parser_free(parser);
+    free(source);
+    return 0;
+}
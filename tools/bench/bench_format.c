@@ -0,0 +1,124 @@
+// Microbenchmark: building format strings (adorad/runtime/format.h) vs snprintf, and vs concatenating the pieces one
+// at a time (what `"x = " + int_to_str(x) + ...` does: a new string per `+`).
+// Usage: bench_format [iterations-scale]
+#include <adorad/adorad.h>
+#include <string.h>
+
+// Prevents the compiler from optimizing away the benchmarked calls
+static volatile UInt64 sink = 0;
+
+#define NUM_VALUES  4096
+
+// `a + b`, in a new string
+static char* concat(const char* a, UInt64 a_len, const char* b, UInt64 b_len) {
+    char* out = cast(char*)malloc(a_len + b_len + 1);
+    CORETEN_ENFORCE_NN(out, "Could not allocate memory. Memory full.");
+    memcpy(out, a, a_len);
+    memcpy(out + a_len, b, b_len);
+    out[a_len + b_len] = nullchar;
+    return out;
+}
+
+static UInt64 by_concat(Int64 i, double f, const char* name, UInt64 name_len) {
+    char num[32];
+    char* s = concat("", 0, "id = ", 5);
+    UInt64 len = 5;
+    UInt64 n = cast(UInt64)snprintf(num, sizeof(num), "%" CORETEN_PRId64, i);
+    char* t = concat(s, len, num, n); free(s); s = t; len += n;
+    t = concat(s, len, ", score = ", 10); free(s); s = t; len += 10;
+    n = cast(UInt64)snprintf(num, sizeof(num), "%.17g", f);
+    t = concat(s, len, num, n); free(s); s = t; len += n;
+    t = concat(s, len, ", name = ", 9); free(s); s = t; len += 9;
+    t = concat(s, len, name, name_len); free(s); s = t; len += name_len;
+    t = concat(s, len, "!", 1); free(s); s = t; len += 1;
+    UInt64 result = len + cast(UInt64)s[len - 2];
+    free(s);
+    return result;
+}
+
+static UInt64 by_snprintf(Int64 i, double f, const char* name) {
+    int len = snprintf(null, 0, "id = %" CORETEN_PRId64 ", score = %.17g, name = %s!", i, f, name);
+    char* s = cast(char*)malloc(cast(UInt64)len + 1);
+    CORETEN_ENFORCE_NN(s, "Could not allocate memory. Memory full.");
+    snprintf(s, cast(UInt64)len + 1, "id = %" CORETEN_PRId64 ", score = %.17g, name = %s!", i, f, name);
+    UInt64 result = cast(UInt64)len + cast(UInt64)s[len - 2];
+    free(s);
+    return result;
+}
+
+static UInt64 by_format(const Format* format, const FormatArg* args) {
+    FormatField fields[3];
+    UInt64 len = format_length(format, args, fields);
+    char* s = cast(char*)malloc(len + 1);
+    CORETEN_ENFORCE_NN(s, "Could not allocate memory. Memory full.");
+    format_write(format, args, fields, s);
+    UInt64 result = len + cast(UInt64)s[len - 2];
+    free(s);
+    return result;
+}
+
+#define BENCH(out, iters, expr)                                         \
+    do {                                                                \
+        double start = clock_monotonic();                               \
+        for(UInt64 _i = 0; _i < (iters); _i++) {                        \
+            UInt64 j = _i % NUM_VALUES;                                 \
+            sink += (expr);                                             \
+        }                                                               \
+        out = clock_monotonic() - start;                                \
+    } while(0)
+
+int main(int argc, char** argv) {
+    UInt64 scale = argc > 1 ? cast(UInt64)atoll(argv[1]) : 1;
+    if(scale == 0)
+        scale = 1;
+
+    // f"id = {i}, score = {f}, name = {name}!"
+    Format* format = format_new();
+    FormatSpec spec = {0};
+    spec.precision = -1;
+    format_add_text(format, "id = ", 5);
+    format_add_hole(format, FormatKindInt, spec);
+    format_add_text(format, ", score = ", 10);
+    format_add_hole(format, FormatKindFloat64, spec);
+    format_add_text(format, ", name = ", 9);
+    format_add_hole(format, FormatKindString, spec);
+    format_add_text(format, "!", 1);
+
+    static Int64 ints[NUM_VALUES];
+    static double floats[NUM_VALUES];
+    static const char* names[] = {"Jill", "Bartholomew", "Li", "Anastasia"};
+    UInt64 seed = 1;
+    for(UInt64 i = 0; i < NUM_VALUES; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        ints[i] = cast(Int64)(seed >> 1) >> (seed % 60);
+        // Random digits: the worst case for shortest formatting (`%.17g` is the `printf()` that always round-trips)
+        floats[i] = cast(double)(seed >> 11) * 0x1.0p-53 * 1000.0;
+    }
+
+    UInt64 iters = scale * 2000000ULL;
+    double concatenated, printf_, formatted;
+    BENCH(concatenated, iters, by_concat(ints[j], floats[j], names[j & 3], strlen(names[j & 3])));
+    BENCH(printf_, iters, by_snprintf(ints[j], floats[j], names[j & 3]));
+    FormatArg args[3];
+    BENCH(formatted, iters, (args[0].i = ints[j], args[1].f = floats[j], args[2].s.data = names[j & 3],
+                             args[2].s.len = strlen(names[j & 3]), by_format(format, args)));
+
+    double strings = cast(double)iters;
+    printf("format  3 holes   concat: %7.2f Mstr/s   snprintf: %7.2f Mstr/s   format: %7.2f Mstr/s "
+           "(%.2fx concat, %.2fx snprintf)\n", strings / concatenated * 1e-6, strings / printf_ * 1e-6,
+           strings / formatted * 1e-6, concatenated / formatted, printf_ / formatted);
+
+    // The numbers on their own
+    char buf[32];
+    BENCH(printf_, iters, cast(UInt64)snprintf(buf, sizeof(buf), "%.17g", floats[j]));
+    BENCH(formatted, iters, format_float64(floats[j], buf));
+    printf("float64 shortest  snprintf %%.17g: %7.2f Mnum/s   format_float64: %7.2f Mnum/s (%.2fx)\n",
+           strings / printf_ * 1e-6, strings / formatted * 1e-6, printf_ / formatted);
+    BENCH(printf_, iters, cast(UInt64)snprintf(buf, sizeof(buf), "%" CORETEN_PRId64, ints[j]));
+    BENCH(formatted, iters, format_int(ints[j], buf));
+    printf("int64             snprintf %%d:    %7.2f Mnum/s   format_int:     %7.2f Mnum/s (%.2fx)\n",
+           strings / printf_ * 1e-6, strings / formatted * 1e-6, printf_ / formatted);
+
+    format_free(format);
+    return 0;
+}
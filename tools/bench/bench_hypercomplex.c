@@ -0,0 +1,143 @@
+// Microbenchmark: complex and quaternion tensors (adorad/runtime/hypercomplex.h), split into one tensor per part, vs
+// loops over arrays of structs (the way they'd be written without it).
+// Usage: bench_hypercomplex [iterations-scale]
+#include <math.h>
+#include <adorad/adorad.h>
+
+// Prevents the compiler from optimizing away the benchmarked calls
+static volatile double sink = 0;
+
+static void fill_random(Tensor* tensor, UInt64 seed) {
+    for(UInt64 i = 0; i < tensor->len; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        TensorScalar x;
+        x.f = cast(double)(seed >> 11) * 0x1.0p-53 * 2.0 - 1.0;
+        tensor_set(tensor, i, x);
+    }
+}
+
+// The structs-of-doubles versions
+static void aos_complex_mul(Complex64* dst, const Complex64* a, const Complex64* b, UInt64 n) {
+    for(UInt64 i = 0; i < n; i++) {
+        Complex64 x = a[i], y = b[i];
+        dst[i].re = x.re * y.re - x.im * y.im;
+        dst[i].im = x.re * y.im + x.im * y.re;
+    }
+}
+
+static void aos_complex_exp(Complex64* dst, const Complex64* a, UInt64 n) {
+    for(UInt64 i = 0; i < n; i++) {
+        double e = exp(a[i].re);
+        dst[i].re = e * cos(a[i].im);
+        dst[i].im = e * sin(a[i].im);
+    }
+}
+
+static void aos_quaternion_mul(Quaternion256* dst, const Quaternion256* a, const Quaternion256* b, UInt64 n) {
+    for(UInt64 i = 0; i < n; i++) {
+        Quaternion256 p = a[i], q = b[i];
+        dst[i].w = p.w * q.w - p.x * q.x - p.y * q.y - p.z * q.z;
+        dst[i].x = p.w * q.x + p.x * q.w + p.y * q.z - p.z * q.y;
+        dst[i].y = p.w * q.y - p.x * q.z + p.y * q.w + p.z * q.x;
+        dst[i].z = p.w * q.z + p.x * q.y - p.y * q.x + p.z * q.w;
+    }
+}
+
+static void aos_quaternion_rotate(Quaternion256* dst, const Quaternion256* q, const Quaternion256* v, UInt64 n) {
+    for(UInt64 i = 0; i < n; i++) {
+        Quaternion256 conj = { q[i].w, -q[i].x, -q[i].y, -q[i].z };
+        Quaternion256 t;
+        aos_quaternion_mul(&t, &q[i], &v[i], 1);
+        aos_quaternion_mul(&dst[i], &t, &conj, 1);
+    }
+}
+
+static void aos_quaternion_slerp(Quaternion256* dst, const Quaternion256* a, const Quaternion256* b, double t,
+                                 UInt64 n) {
+    for(UInt64 i = 0; i < n; i++) {
+        Quaternion256 p = a[i], q = b[i];
+        double dot = p.w * q.w + p.x * q.x + p.y * q.y + p.z * q.z;
+        double sign = dot < 0 ? -1.0 : 1.0;
+        double theta = acos(fmin(fabs(dot), 1.0));
+        double s = sin(theta);
+        double wa = s > 1e-9 ? sin((1 - t) * theta) / s : 1 - t;
+        double wb = sign * (s > 1e-9 ? sin(t * theta) / s : t);
+        dst[i] = (Quaternion256){ wa * p.w + wb * q.w, wa * p.x + wb * q.x, wa * p.y + wb * q.y, wa * p.z + wb * q.z };
+    }
+}
+
+#define BENCH(out, iters, expr)                                                 \
+    do {                                                                        \
+        double start = clock_monotonic();                                       \
+        for(UInt64 _i = 0; _i < (iters); _i++) {                                \
+            expr;                                                               \
+            sink += part[0]->data[_i % len];                                    \
+        }                                                                       \
+        out = clock_monotonic() - start;                                        \
+    } while(0)
+
+static void report(const char* name, double aos, double soa, UInt64 len, UInt64 iters) {
+    double elems = cast(double)len * cast(double)iters;
+    printf("%-20s structs: %7.1f Melem/s   tensors: %7.1f Melem/s (%.2fx)\n", name, elems / aos * 1e-6,
+           elems / soa * 1e-6, aos / soa);
+}
+
+int main(int argc, char** argv) {
+    UInt64 scale = argc > 1 ? cast(UInt64)atoll(argv[1]) : 1;
+    if(scale == 0)
+        scale = 1;
+    static const char* isa_names[] = { "scalar", "AVX2", "AVX-512" };
+    printf("Kernels: %s\n", isa_names[tensor_isa()]);
+
+    // Fits in L2, so that this measures the kernels and not memory
+    UInt64 len = 2048;
+    UInt64 iters = scale * 2000;
+    Tensor* part[12];
+    for(int j = 0; j < 12; j++) {
+        part[j] = tensor_new(TensorDTypeFloat64, len, 0);
+        fill_random(part[j], cast(UInt64)j);
+    }
+    Quaternion256* qa = cast(Quaternion256*)malloc(len * sizeof(Quaternion256));
+    Quaternion256* qb = cast(Quaternion256*)malloc(len * sizeof(Quaternion256));
+    Quaternion256* qd = cast(Quaternion256*)malloc(len * sizeof(Quaternion256));
+    Float64* p[12];
+    for(int j = 0; j < 12; j++)
+        p[j] = cast(Float64*)part[j]->data;
+    for(UInt64 i = 0; i < len; i++) {
+        qa[i] = quaternion256_normalize((Quaternion256){ p[0][i], p[1][i], p[2][i], p[3][i] });
+        qb[i] = quaternion256_normalize((Quaternion256){ p[4][i], p[5][i], p[6][i], p[7][i] });
+        p[0][i] = qa[i].w, p[1][i] = qa[i].x, p[2][i] = qa[i].y, p[3][i] = qa[i].z;
+        p[4][i] = qb[i].w, p[5][i] = qb[i].x, p[6][i] = qb[i].y, p[7][i] = qb[i].z;
+    }
+    // Complex numbers use the first parts of the same quaternions
+    Complex64* ca = cast(Complex64*)qa;
+    Complex64* cb = cast(Complex64*)qb;
+    Complex64* cd = cast(Complex64*)qd;
+    ComplexTensor a = { part[0], part[1] }, b = { part[4], part[5] }, cdst = { part[8], part[9] };
+    QuaternionTensor q = { part[0], part[1], part[2], part[3] }, r = { part[4], part[5], part[6], part[7] };
+    QuaternionTensor qdst = { part[8], part[9], part[10], part[11] };
+    double aos, soa;
+
+    BENCH(aos, iters, aos_complex_mul(cd, ca, cb, len));
+    BENCH(soa, iters, complex_tensor_mul(&cdst, &a, &b));
+    report("complex mul", aos, soa, len, iters);
+    BENCH(aos, iters, aos_complex_exp(cd, ca, len));
+    BENCH(soa, iters, complex_tensor_exp(&cdst, &a));
+    report("complex exp", aos, soa, len, iters);
+    BENCH(aos, iters, aos_quaternion_mul(qd, qa, qb, len));
+    BENCH(soa, iters, quaternion_tensor_mul(&qdst, &q, &r));
+    report("quaternion mul", aos, soa, len, iters);
+    BENCH(aos, iters, aos_quaternion_rotate(qd, qa, qb, len));
+    BENCH(soa, iters, quaternion_tensor_rotate(&qdst, &q, &r));
+    report("quaternion rotate", aos, soa, len, iters);
+    BENCH(aos, iters, aos_quaternion_slerp(qd, qa, qb, 0.3, len));
+    BENCH(soa, iters, quaternion_tensor_slerp(&qdst, &q, &r, 0.3));
+    report("quaternion slerp", aos, soa, len, iters);
+
+    free(qa);
+    free(qb);
+    free(qd);
+    for(int j = 0; j < 12; j++)
+        tensor_free(part[j]);
+    return 0;
+}
@@ -0,0 +1,233 @@
+// Microbenchmark: maps (adorad/runtime/map.h) vs a chained hash table (a list of nodes per bucket, the way hash tables
+// are usually written in C), with integer and string keys.
+// Usage: bench_map [iterations-scale]
+#include <adorad/adorad.h>
+
+// Prevents the compiler from optimizing away the benchmarked calls
+static volatile UInt64 sink = 0;
+
+typedef struct ChainNode {
+    struct ChainNode* next;
+    UInt64 hash;
+    Int64 int_key;
+    char* string_key;
+    UInt64 len;
+    MapValue value;
+} ChainNode;
+
+// Doubles its buckets when it has as many entries as buckets
+typedef struct Chained {
+    ChainNode** buckets;
+    UInt64 num_buckets;
+    UInt64 len;
+} Chained;
+
+static UInt64 hash_int(Int64 key) {
+    UInt64 h = cast(UInt64)key;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    return h ^ (h >> 33);
+}
+
+static Chained* chained_new() {
+    Chained* map = cast(Chained*)calloc(1, sizeof(Chained));
+    map->num_buckets = 16;
+    map->buckets = cast(ChainNode**)calloc(map->num_buckets, sizeof(ChainNode*));
+    return map;
+}
+
+static void chained_free(Chained* map) {
+    for(UInt64 b = 0; b < map->num_buckets; b++) {
+        for(ChainNode* node = map->buckets[b]; node != null;) {
+            ChainNode* next = node->next;
+            free(node->string_key);
+            free(node);
+            node = next;
+        }
+    }
+    free(map->buckets);
+    free(map);
+}
+
+static ChainNode** chained_find(Chained* map, UInt64 hash, Int64 int_key, const char* string_key, UInt64 len) {
+    ChainNode** link = &map->buckets[hash & (map->num_buckets - 1)];
+    for(; *link != null; link = &(*link)->next) {
+        ChainNode* node = *link;
+        if(node->hash == hash && (string_key == null ? node->int_key == int_key :
+                                  node->len == len && memcmp(node->string_key, string_key, len) == 0))
+            break;
+    }
+    return link;
+}
+
+static MapValue* chained_insert(Chained* map, Int64 int_key, const char* string_key, UInt64 len) {
+    UInt64 hash = string_key == null ? hash_int(int_key) : hash_murmur64(string_key, cast(Ll)len);
+    ChainNode** link = chained_find(map, hash, int_key, string_key, len);
+    if(*link != null)
+        return &(*link)->value;
+    if(map->len == map->num_buckets) {
+        ChainNode** buckets = cast(ChainNode**)calloc(map->num_buckets * 2, sizeof(ChainNode*));
+        for(UInt64 b = 0; b < map->num_buckets; b++) {
+            for(ChainNode* node = map->buckets[b]; node != null;) {
+                ChainNode* next = node->next;
+                UInt64 to = node->hash & (map->num_buckets * 2 - 1);
+                node->next = buckets[to];
+                buckets[to] = node;
+                node = next;
+            }
+        }
+        free(map->buckets);
+        map->buckets = buckets;
+        map->num_buckets *= 2;
+        link = chained_find(map, hash, int_key, string_key, len);
+    }
+    ChainNode* node = cast(ChainNode*)calloc(1, sizeof(ChainNode));
+    node->hash = hash;
+    node->int_key = int_key;
+    if(string_key != null) {
+        node->string_key = cast(char*)malloc(len + 1);
+        memcpy(node->string_key, string_key, len);
+        node->string_key[len] = '\0';
+        node->len = len;
+    }
+    *link = node;
+    map->len++;
+    return &node->value;
+}
+
+static MapValue* chained_get(Chained* map, Int64 int_key, const char* string_key, UInt64 len) {
+    UInt64 hash = string_key == null ? hash_int(int_key) : hash_murmur64(string_key, cast(Ll)len);
+    ChainNode* node = *chained_find(map, hash, int_key, string_key, len);
+    return node == null ? null : &node->value;
+}
+
+static void chained_delete(Chained* map, Int64 int_key, const char* string_key, UInt64 len) {
+    UInt64 hash = string_key == null ? hash_int(int_key) : hash_murmur64(string_key, cast(Ll)len);
+    ChainNode** link = chained_find(map, hash, int_key, string_key, len);
+    ChainNode* node = *link;
+    if(node != null) {
+        *link = node->next;
+        free(node->string_key);
+        free(node);
+        map->len--;
+    }
+}
+
+#define BENCH(out, iters, expr)                                                 \
+    do {                                                                        \
+        double start = clock_monotonic();                                       \
+        for(UInt64 _i = 0; _i < (iters); _i++) {                                \
+            expr;                                                               \
+        }                                                                       \
+        out = clock_monotonic() - start;                                        \
+    } while(0)
+
+static void report(const char* op, bool strings, UInt64 n, UInt64 iters, double chained, double runtime) {
+    double ops = cast(double)n * cast(double)iters;
+    printf("%-8s %-7s %8" CORETEN_PRIu64 " keys   chained: %7.1f Mop/s   map: %7.1f Mop/s (%.2fx)\n", op,
+           strings ? "string" : "int", n, ops / chained * 1e-6, ops / runtime * 1e-6, chained / runtime);
+}
+
+int main(int argc, char** argv) {
+    UInt64 scale = argc > 1 ? cast(UInt64)atoll(argv[1]) : 1;
+    if(scale == 0)
+        scale = 1;
+
+    static const UInt64 sizes[] = { 1000, 1 << 16, 1 << 20 };
+    for(UInt64 s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        UInt64 n = sizes[s];
+        // Roughly 4M operations per measurement
+        UInt64 iters = scale * ((1ULL << 22) / n);
+        if(iters == 0)
+            iters = 1;
+        // Keys that are looked up (hits), and keys that aren't in the map (misses). They're looked up in an order that
+        // has nothing to do with the order they were inserted in (`ORDER(i)`).
+        #define ORDER(i)    ((i) * 7919 % n)
+        Int64* ints = cast(Int64*)malloc(2 * n * sizeof(Int64));
+        char* strings = cast(char*)malloc(2 * n * 32);
+        UInt64* lens = cast(UInt64*)malloc(2 * n * sizeof(UInt64));
+        UInt64 seed = n;
+        for(UInt64 i = 0; i < 2 * n; i++) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            ints[i] = cast(Int64)(seed >> 1);
+            lens[i] = cast(UInt64)snprintf(strings + i * 32, 32, "session:%" CORETEN_PRIu64, seed >> 20);
+        }
+
+        for(int is_string = 0; is_string < 2; is_string++) {
+            #define KEY(i)      (is_string ? 0 : ints[i]), (is_string ? strings + (i) * 32 : null), lens[i]
+            #define MAP_OP(op, i)                                                       \
+                (is_string ? map_##op##_string(map, strings + (i) * 32, lens[i]) :     \
+                             map_##op##_int(map, ints[i]))
+            double chained_time, map_time, reserved_time;
+            Chained* chained = null;
+            Map* map = null;
+            UInt64 sum = 0;
+
+            // Inserting into a new map (and freeing it), without and with room reserved for every key
+            BENCH(chained_time, iters, {
+                chained = chained_new();
+                for(UInt64 i = 0; i < n; i++)
+                    chained_insert(chained, KEY(i))->u = i;
+                if(_i + 1 < iters)
+                    chained_free(chained);
+            });
+            BENCH(map_time, iters, {
+                map = map_new(is_string ? MapKeyString : MapKeyInt, 0);
+                for(UInt64 i = 0; i < n; i++)
+                    (is_string ? map_insert_string(map, strings + i * 32, lens[i], null) :
+                                 map_insert_int(map, ints[i], null))->u = i;
+                map_free(map);
+            });
+            BENCH(reserved_time, iters, {
+                map = map_new(is_string ? MapKeyString : MapKeyInt, n);
+                for(UInt64 i = 0; i < n; i++)
+                    (is_string ? map_insert_string(map, strings + i * 32, lens[i], null) :
+                                 map_insert_int(map, ints[i], null))->u = i;
+                if(_i + 1 < iters)
+                    map_free(map);
+            });
+            report("insert", is_string, n, iters, chained_time, map_time);
+            report("reserved", is_string, n, iters, chained_time, reserved_time);
+
+            BENCH(chained_time, iters, for(UInt64 i = 0; i < n; i++) sum += chained_get(chained, KEY(ORDER(i)))->u);
+            BENCH(map_time, iters, for(UInt64 i = 0; i < n; i++) sum += MAP_OP(find, ORDER(i))->u);
+            report("hit", is_string, n, iters, chained_time, map_time);
+            BENCH(chained_time, iters,
+                  for(UInt64 i = 0; i < n; i++) sum += chained_get(chained, KEY(n + ORDER(i))) == null);
+            BENCH(map_time, iters, for(UInt64 i = 0; i < n; i++) sum += MAP_OP(find, n + ORDER(i)) == null);
+            report("miss", is_string, n, iters, chained_time, map_time);
+
+            // `for k, v in m`
+            BENCH(chained_time, iters, {
+                for(UInt64 b = 0; b < chained->num_buckets; b++)
+                    for(ChainNode* node = chained->buckets[b]; node != null; node = node->next)
+                        sum += node->value.u + node->len;
+            });
+            BENCH(map_time, iters, {
+                if(is_string)
+                    for(UInt64 i = 0; i < map->len; i++)
+                        sum += map->entries.strings[i].value.u + map->entries.strings[i].key.len;
+                else
+                    for(UInt64 i = 0; i < map->len; i++)
+                        sum += map->entries.ints[i].value.u;
+            });
+            report("iterate", is_string, n, iters, chained_time, map_time);
+
+            BENCH(chained_time, 1, for(UInt64 i = 0; i < n; i++) chained_delete(chained, KEY(ORDER(i))));
+            BENCH(map_time, 1, for(UInt64 i = 0; i < n; i++) MAP_OP(delete, ORDER(i)));
+            report("delete", is_string, n, 1, chained_time, map_time);
+            sink += sum + chained->len + map->len;
+            chained_free(chained);
+            map_free(map);
+            #undef KEY
+            #undef MAP_OP
+        }
+        free(ints);
+        free(strings);
+        free(lens);
+        #undef ORDER
+    }
+    return 0;
+}
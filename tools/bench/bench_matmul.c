@@ -0,0 +1,100 @@
+// Microbenchmark: matrix multiplication (adorad/runtime/matmul.h) vs a naive triple loop, in GFLOP/s.
+// Usage: bench_matmul [max-size]
+#include <adorad/adorad.h>
+
+// An `n x n` matrix
+static Tensor* make_matrix(TensorDType dtype, UInt64 n) {
+    UInt64 shape[2] = { n, n };
+    Tensor* tensor = tensor_new_shape(dtype, 2, shape);
+    for(UInt64 i = 0; i < n * n; i++) {
+        TensorScalar x;
+        x.f = cast(double)(i % 17) * 0.25 - 2.0;
+        tensor_set(tensor, i, x);
+    }
+    return tensor;
+}
+
+#define NAIVE_MATMUL(T)                                                     \
+    do {                                                                    \
+        const T* x = cast(const T*)a->data;                                 \
+        const T* y = cast(const T*)b->data;                                 \
+        T* z = cast(T*)c->data;                                             \
+        for(UInt64 i = 0; i < n; i++)                                       \
+            for(UInt64 j = 0; j < n; j++) {                                 \
+                T sum = 0;                                                  \
+                for(UInt64 p = 0; p < n; p++)                               \
+                    sum += x[i * n + p] * y[p * n + j];                     \
+                z[i * n + j] = sum;                                         \
+            }                                                               \
+    } while(0)
+
+// `c = a * b` (all `n x n`), the textbook way. `c` is already the right size.
+static void naive_matmul(Tensor* c, Tensor* a, Tensor* b, UInt64 n) {
+    if(a->dtype == TensorDTypeFloat64)
+        NAIVE_MATMUL(Float64);
+    else
+        NAIVE_MATMUL(Float32);
+}
+
+// Seconds per product (the best of a few runs, each at least a tenth of a second long)
+#define BENCH(out, expr)                                                    \
+    do {                                                                    \
+        out = 1e30;                                                         \
+        for(int _run = 0; _run < 3; _run++) {                               \
+            UInt64 _iters = 0;                                              \
+            double start = clock_monotonic();                               \
+            double elapsed;                                                 \
+            do {                                                            \
+                expr;                                                       \
+                _iters++;                                                   \
+                elapsed = clock_monotonic() - start;                        \
+            } while(elapsed < 0.1);                                         \
+            if(elapsed / cast(double)_iters < out)                          \
+                out = elapsed / cast(double)_iters;                         \
+        }                                                                   \
+    } while(0)
+
+static const char* isa_name(TensorIsa isa) {
+    switch(isa) {
+        case TensorIsaAVX512: return "avx512";
+        case TensorIsaAVX2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+int main(int argc, char** argv) {
+    UInt64 max_size = argc > 1 ? cast(UInt64)atoll(argv[1]) : 1024;
+    TensorIsa best = tensor_isa();
+    ThreadPool* pool = threadpool_new(0);
+    printf("CPU features: AVX2=%d FMA=%d AVX512F=%d (using %s, %u threads)\n", cpu_has_feature(CpuFeatureAVX2),
+           cpu_has_feature(CpuFeatureFMA), cpu_has_feature(CpuFeatureAVX512F), isa_name(best), threadpool_size(pool));
+
+    static const TensorDType dtypes[] = {TensorDTypeFloat32, TensorDTypeFloat64};
+    for(UInt64 n = 64; n <= max_size; n *= 4) {
+        for(int d = 0; d < 2; d++) {
+            Tensor* a = make_matrix(dtypes[d], n);
+            Tensor* b = make_matrix(dtypes[d], n);
+            Tensor* c = make_matrix(dtypes[d], n);
+            double naive, blocked, simd, threaded;
+            // The naive loop gets slow fast: skip it past 1024
+            naive = 0;
+            if(n <= 1024)
+                BENCH(naive, naive_matmul(c, a, b, n));
+            tensor_set_isa(TensorIsaScalar);
+            BENCH(blocked, tensor_matmul(c, a, b, null));
+            tensor_set_isa(best);
+            BENCH(simd, tensor_matmul(c, a, b, null));
+            BENCH(threaded, tensor_matmul(c, a, b, pool));
+
+            double flops = 2.0 * cast(double)n * cast(double)n * cast(double)n * 1e-9;
+            printf("%-7s %5" CORETEN_PRIu64 "^2   naive: %7.2f   blocked: %7.2f   %s: %7.2f   %s x%u: %8.2f GFLOP/s\n",
+                   d == 0 ? "Float32" : "Float64", n, naive > 0 ? flops / naive : 0.0, flops / blocked,
+                   isa_name(best), flops / simd, isa_name(best), threadpool_size(pool), flops / threaded);
+            tensor_free(a);
+            tensor_free(b);
+            tensor_free(c);
+        }
+    }
+    threadpool_free(pool);
+    return 0;
+}
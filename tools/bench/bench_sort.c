@@ -0,0 +1,100 @@
+// Microbenchmark: sorting tensors (adorad/runtime/sort.h), radix sort vs qsort, on one thread and on a pool.
+// Usage: bench_sort [iterations-scale]
+#include <adorad/adorad.h>
+
+// Prevents the compiler from optimizing away the benchmarked calls
+static volatile UInt64 sink = 0;
+
+static void fill_random(Tensor* tensor, UInt64 seed) {
+    for(UInt64 i = 0; i < tensor->len; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        TensorScalar x;
+        if(tensor_dtype_is_float(tensor->dtype))
+            x.f = cast(double)(seed >> 11) * 0x1.0p-53 - 0.5;
+        else
+            x.i = cast(Int64)(seed >> 1);
+        tensor_set(tensor, i, x);
+    }
+}
+
+static int compare_int32(const void* a, const void* b) {
+    Int32 x = *cast(const Int32*)a;
+    Int32 y = *cast(const Int32*)b;
+    return (x > y) - (x < y);
+}
+
+static int compare_int64(const void* a, const void* b) {
+    Int64 x = *cast(const Int64*)a;
+    Int64 y = *cast(const Int64*)b;
+    return (x > y) - (x < y);
+}
+
+static int compare_float32(const void* a, const void* b) {
+    Float32 x = *cast(const Float32*)a;
+    Float32 y = *cast(const Float32*)b;
+    return (x > y) - (x < y);
+}
+
+static int compare_float64(const void* a, const void* b) {
+    Float64 x = *cast(const Float64*)a;
+    Float64 y = *cast(const Float64*)b;
+    return (x > y) - (x < y);
+}
+
+static const char* dtype_name(TensorDType dtype) {
+    static const char* names[] = { "Int16", "Int32", "Int64", "Float32", "Float64" };
+    return names[dtype];
+}
+
+// Every iteration sorts a fresh copy of `input` (the copy is timed too, for all three)
+#define BENCH(out, iters, expr)                                                 \
+    do {                                                                        \
+        double start = clock_monotonic();                                       \
+        for(UInt64 _i = 0; _i < (iters); _i++) {                                \
+            memcpy(work->data, input->data, input->len * size);                 \
+            expr;                                                               \
+            sink += work->data[0];                                              \
+        }                                                                       \
+        out = clock_monotonic() - start;                                        \
+    } while(0)
+
+int main(int argc, char** argv) {
+    UInt64 scale = argc > 1 ? cast(UInt64)atoll(argv[1]) : 1;
+    if(scale == 0)
+        scale = 1;
+
+    ThreadPool* pool = threadpool_new(0);
+    printf("Workers: %u\n", threadpool_size(pool));
+
+    static const UInt64 sizes[] = {1000, 1 << 20, 1 << 24};
+    static const TensorDType dtypes[] = {TensorDTypeInt32, TensorDTypeInt64, TensorDTypeFloat32, TensorDTypeFloat64};
+    int (*compares[])(const void*, const void*) = { compare_int32, compare_int64, compare_float32, compare_float64 };
+    for(UInt64 s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++) {
+        UInt64 len = sizes[s];
+        // Roughly 32M elements per measurement
+        UInt64 iters = scale * ((1ULL << 25) / len);
+        if(iters == 0)
+            iters = 1;
+        for(UInt64 d = 0; d < sizeof(dtypes)/sizeof(dtypes[0]); d++) {
+            TensorDType dtype = dtypes[d];
+            UInt64 size = tensor_dtype_size(dtype);
+            Tensor* input = tensor_new(dtype, len, 0);
+            Tensor* work = tensor_new(dtype, len, 0);
+            fill_random(input, len + d);
+            double libc, radix, parallel;
+
+            BENCH(libc, iters, qsort(work->data, len, size, compares[d]));
+            BENCH(radix, iters, tensor_sort(work, false, null));
+            BENCH(parallel, iters, tensor_sort(work, false, pool));
+            double elems = cast(double)len * cast(double)iters;
+            printf("sort  %-8s %9" CORETEN_PRIu64 " elems   qsort: %7.1f Melem/s   radix: %7.1f Melem/s (%.2fx)   "
+                   "parallel: %7.1f Melem/s (%.2fx)\n", dtype_name(dtype), len, elems / libc * 1e-6,
+                   elems / radix * 1e-6, libc / radix, elems / parallel * 1e-6, libc / parallel);
+
+            tensor_free(input);
+            tensor_free(work);
+        }
+    }
+    threadpool_free(pool);
+    return 0;
+}
@@ -0,0 +1,102 @@
+// Microbenchmark: Adorad's vectorized string primitives (adorad/core/strops.h) vs the C Standard Library.
+// Usage: bench_strops [iterations-scale]
+#include <adorad/adorad.h>
+#include <string.h>
+#include <ctype.h>
+
+#if defined(CORETEN_OS_WINDOWS)
+    #define strncasecmp     _strnicmp
+#else
+    #include <strings.h>
+#endif // CORETEN_OS_WINDOWS
+
+// Prevents the compiler from optimizing away the benchmarked calls
+static volatile UInt64 sink = 0;
+
+static char* make_input(UInt64 len) {
+    char* data = cast(char*)malloc(len + 1);
+    CORETEN_ENFORCE_NN(data, "Could not allocate memory. Memory full.");
+    for(UInt64 i = 0; i < len; i++)
+        data[i] = cast(char)('A' + (i * 7) % 58);   // mixed-case letters and punctuation (never '#')
+    data[len] = nullchar;
+    return data;
+}
+
+static void report(const char* op, UInt64 len, double ours, double libc, UInt64 iters) {
+    double bytes = cast(double)len * cast(double)iters;
+    printf("%-16s %8" CORETEN_PRIu64 " bytes   adorad: %8.2f GB/s   libc: %8.2f GB/s   (%.2fx)\n",
+           op, len, bytes / ours * 1e-9, bytes / libc * 1e-9, libc / ours);
+}
+
+static void scalar_to_lower(char* dest, const char* src, UInt64 n) {
+    for(UInt64 i = 0; i < n; i++)
+        dest[i] = cast(char)tolower(cast(unsigned char)src[i]);
+}
+
+#define BENCH(out, iters, expr)                             \
+    do {                                                    \
+        double start = clock_monotonic();                   \
+        for(UInt64 _i = 0; _i < (iters); _i++)              \
+            sink += cast(UInt64)(expr);                     \
+        out = clock_monotonic() - start;                    \
+    } while(0)
+
+int main(int argc, char** argv) {
+    UInt64 scale = argc > 1 ? cast(UInt64)atoll(argv[1]) : 1;
+    if(scale == 0)
+        scale = 1;
+
+    printf("CPU features: SSE2=%d AVX2=%d AVX512BW=%d NEON=%d\n",
+           cpu_has_feature(CpuFeatureSSE2), cpu_has_feature(CpuFeatureAVX2),
+           cpu_has_feature(CpuFeatureAVX512BW), cpu_has_feature(CpuFeatureNEON));
+
+    static const UInt64 sizes[] = {16, 64, 256, 4096, 65536, 1 << 20};
+    for(UInt64 s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++) {
+        UInt64 len = sizes[s];
+        // Roughly 1 GB worth of bytes per measurement
+        UInt64 iters = scale * ((1ULL << 30) / len);
+        if(iters > 20000000ULL * scale)
+            iters = 20000000ULL * scale;
+
+        char* a = make_input(len);
+        char* b = make_input(len);
+        char* lowered = make_input(len);
+        char* upper = make_input(len);
+        mem_to_upper(upper, a, len);
+        double ours, libc;
+
+        BENCH(ours, iters, str_len(a));
+        BENCH(libc, iters, strlen(a));
+        report("len", len, ours, libc, iters);
+
+        BENCH(ours, iters, str_find_char(a, '#') == null);
+        BENCH(libc, iters, strchr(a, '#') == null);
+        report("find_char", len, ours, libc, iters);
+
+        BENCH(ours, iters, str_rfind_char(a, 'A') - a);
+        BENCH(libc, iters, strrchr(a, 'A') - a);
+        report("rfind_char", len, ours, libc, iters);
+
+        BENCH(ours, iters, mem_find_char(a, '#', len) == null);
+        BENCH(libc, iters, memchr(a, '#', len) == null);
+        report("mem_find_char", len, ours, libc, iters);
+
+        BENCH(ours, iters, mem_eq(a, b, len));
+        BENCH(libc, iters, memcmp(a, b, len) == 0);
+        report("eq", len, ours, libc, iters);
+
+        BENCH(ours, iters, mem_eq_nocase(a, upper, len));
+        BENCH(libc, iters, strncasecmp(a, upper, len) == 0);
+        report("eq_nocase", len, ours, libc, iters);
+
+        BENCH(ours, iters, (mem_to_lower(lowered, a, len), lowered[0]));
+        BENCH(libc, iters, (scalar_to_lower(lowered, a, len), lowered[0]));
+        report("to_lower", len, ours, libc, iters);
+
+        free(a);
+        free(b);
+        free(lowered);
+        free(upper);
+    }
+    return cast(int)(sink & 0);
+}
@@ -0,0 +1,111 @@
+// Microbenchmark: the tensor runtime's element-wise kernels (adorad/runtime/tensor.h), scalar vs SIMD.
+// Usage: bench_tensor [iterations-scale]
+#include <adorad/adorad.h>
+
+// Prevents the compiler from optimizing away the benchmarked calls
+static volatile UInt64 sink = 0;
+
+static Tensor* make_input(TensorDType dtype, UInt64 len) {
+    Tensor* tensor = tensor_new(dtype, len, 0);
+    for(UInt64 i = 0; i < len; i++) {
+        TensorScalar x;
+        if(tensor_dtype_is_float(dtype))
+            x.f = cast(double)(i % 97) + 0.5;
+        else
+            x.i = cast(Int64)(i % 97) + 1;
+        tensor_set(tensor, i, x);
+    }
+    return tensor;
+}
+
+static const char* isa_name(TensorIsa isa) {
+    switch(isa) {
+        case TensorIsaAVX512: return "avx512";
+        case TensorIsaAVX2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+static const char* dtype_name(TensorDType dtype) {
+    static const char* names[] = { "Int16", "Int32", "Int64", "Float32", "Float64" };
+    return names[dtype];
+}
+
+static void report(const char* op, TensorDType dtype, UInt64 len, double scalar, double simd, UInt64 iters) {
+    double elems = cast(double)len * cast(double)iters;
+    printf("%-8s %-8s %8" CORETEN_PRIu64 " elems   scalar: %8.2f Gelem/s   %s: %8.2f Gelem/s   (%.2fx)\n",
+           op, dtype_name(dtype), len, elems / scalar * 1e-9, isa_name(tensor_isa()), elems / simd * 1e-9,
+           scalar / simd);
+}
+
+#define BENCH(out, isa, iters, expr)                        \
+    do {                                                    \
+        tensor_set_isa(isa);                                \
+        double start = clock_monotonic();                   \
+        for(UInt64 _i = 0; _i < (iters); _i++)              \
+            sink += cast(UInt64)(expr);                     \
+        out = clock_monotonic() - start;                    \
+    } while(0)
+
+int main(int argc, char** argv) {
+    UInt64 scale = argc > 1 ? cast(UInt64)atoll(argv[1]) : 1;
+    if(scale == 0)
+        scale = 1;
+
+    // The best kernels this CPU has
+    TensorIsa best = tensor_isa();
+    printf("CPU features: AVX2=%d AVX512F=%d AVX512BW=%d (using %s)\n",
+           cpu_has_feature(CpuFeatureAVX2), cpu_has_feature(CpuFeatureAVX512F),
+           cpu_has_feature(CpuFeatureAVX512BW), isa_name(best));
+
+    static const UInt64 sizes[] = {64, 4096, 1 << 20};
+    static const TensorDType dtypes[] = {TensorDTypeInt32, TensorDTypeInt64, TensorDTypeFloat32, TensorDTypeFloat64};
+    for(UInt64 s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++) {
+        UInt64 len = sizes[s];
+        // Roughly 256M elements per measurement
+        UInt64 iters = scale * ((1ULL << 28) / len);
+        for(UInt64 d = 0; d < sizeof(dtypes)/sizeof(dtypes[0]); d++) {
+            TensorDType dtype = dtypes[d];
+            Tensor* a = make_input(dtype, len);
+            Tensor* b = make_input(dtype, len);
+            Tensor* dst = tensor_new(dtype, len, 0);
+            UInt64* mask = cast(UInt64*)malloc((len + 63) / 64 * sizeof(UInt64));
+            CORETEN_ENFORCE_NN(mask, "Could not allocate memory. Memory full.");
+            TensorScalar result, needle;
+            needle.i = -1;
+            if(tensor_dtype_is_float(dtype))
+                needle.f = -1.0;
+            double scalar, simd;
+
+            BENCH(scalar, TensorIsaScalar, iters, tensor_arith(dst, a, b, TensorOpAdd));
+            BENCH(simd, best, iters, tensor_arith(dst, a, b, TensorOpAdd));
+            report("add", dtype, len, scalar, simd, iters);
+
+            BENCH(scalar, TensorIsaScalar, iters, tensor_arith(dst, a, b, TensorOpMul));
+            BENCH(simd, best, iters, tensor_arith(dst, a, b, TensorOpMul));
+            report("mul", dtype, len, scalar, simd, iters);
+
+            BENCH(scalar, TensorIsaScalar, iters, tensor_compare(a, b, TensorCmpLt, mask));
+            BENCH(simd, best, iters, tensor_compare(a, b, TensorCmpLt, mask));
+            report("lt", dtype, len, scalar, simd, iters);
+
+            BENCH(scalar, TensorIsaScalar, iters, tensor_reduce(a, TensorReduceSum, &result));
+            BENCH(simd, best, iters, tensor_reduce(a, TensorReduceSum, &result));
+            report("sum", dtype, len, scalar, simd, iters);
+
+            BENCH(scalar, TensorIsaScalar, iters, tensor_reduce(a, TensorReduceMax, &result));
+            BENCH(simd, best, iters, tensor_reduce(a, TensorReduceMax, &result));
+            report("max", dtype, len, scalar, simd, iters);
+
+            BENCH(scalar, TensorIsaScalar, iters, tensor_index_of(a, needle));
+            BENCH(simd, best, iters, tensor_index_of(a, needle));
+            report("in", dtype, len, scalar, simd, iters);
+
+            free(mask);
+            tensor_free(a);
+            tensor_free(b);
+            tensor_free(dst);
+        }
+    }
+    return 0;
+}
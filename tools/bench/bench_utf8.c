@@ -0,0 +1,60 @@
+// Microbenchmark: whole-buffer UTF-8 validation (adorad/core/utf8.h).
+// `utf8_validate()` (vectorized, if the CPU supports it) vs `utf8_invalid_offset()` (the scalar path).
+// Usage: bench_utf8 [iterations-scale]
+#include <adorad/adorad.h>
+
+// Prevents the compiler from optimizing away the benchmarked calls
+static volatile UInt64 sink = 0;
+
+// Fill `len` bytes by repeating `pattern` (whole characters only), and pad the rest with spaces
+static char* make_input(const char* pattern, UInt64 len) {
+    char* data = cast(char*)malloc(len + 1);
+    CORETEN_ENFORCE_NN(data, "Could not allocate memory. Memory full.");
+    UInt64 plen = str_len(pattern);
+    UInt64 i = 0;
+    for(; i + plen <= len; i += plen)
+        memcpy(data + i, pattern, plen);
+    for(; i < len; i++)
+        data[i] = ' ';
+    data[len] = nullchar;
+    return data;
+}
+
+static void bench(const char* name, const char* pattern, UInt64 len, UInt64 iters) {
+    char* data = make_input(pattern, len);
+    CORETEN_ENFORCE(utf8_validate(data, len));
+
+    double start = clock_monotonic();
+    for(UInt64 i = 0; i < iters; i++)
+        sink += cast(UInt64)utf8_validate(data, len);
+    double fast = clock_monotonic() - start;
+
+    start = clock_monotonic();
+    for(UInt64 i = 0; i < iters; i++)
+        sink += utf8_invalid_offset(data, len);
+    double scalar = clock_monotonic() - start;
+
+    double bytes = cast(double)len * cast(double)iters;
+    printf("%-10s %8" CORETEN_PRIu64 " bytes   utf8_validate: %7.2f GB/s   scalar: %7.2f GB/s   (%.2fx)\n",
+           name, len, bytes / fast * 1e-9, bytes / scalar * 1e-9, scalar / fast);
+    free(data);
+}
+
+int main(int argc, char** argv) {
+    UInt64 scale = argc > 1 ? cast(UInt64)atoll(argv[1]) : 1;
+    if(scale == 0)
+        scale = 1;
+
+    printf("CPU features: AVX2=%d\n", cpu_has_feature(CpuFeatureAVX2));
+
+    static const UInt64 sizes[] = {4096, 65536, 1 << 20};
+    for(UInt64 s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++) {
+        UInt64 len = sizes[s];
+        UInt64 iters = scale * ((1ULL << 30) / len);
+        bench("ascii", "func add(a: int, b: int) -> int {\n    return a + b\n}\n", len, iters);
+        bench("latin", "fonction d\xc3\xa9" "finie: \"caf\xc3\xa9 cr\xc3\xa8" "me br\xc3\xbbl\xc3\xa9\xc3\xa9" "\"\n", len, iters);
+        bench("cjk", "\xe5\x8f\x98\xe9\x87\x8f = \"\xe4\xbd\xa0\xe5\xa5\xbd\xef\xbc\x8c\xe4\xb8\x96\xe7\x95\x8c\"\n", len, iters);
+        bench("emoji", "\xf0\x9f\x98\x80\xf0\x9f\x9a\x80 \xf0\x9f\x8e\x89\n", len, iters);
+    }
+    return cast(int)(sink & 0);
+}
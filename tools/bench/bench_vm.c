@@ -0,0 +1,153 @@
+// Microbenchmark: the bytecode VM (adorad/compiler/vm.h), on recursion, integer loops, string building and a
+// float kernel. Every program is timed in the VM, in the compile-time evaluator (which interprets the IR directly),
+// and as the equivalent C. `fib` isn't run in the evaluator: it memoizes pure calls, so it would only make n of them.
+// Usage: bench_vm [iterations-scale]
+#include <adorad/adorad.h>
+
+// Prevents the compiler from optimizing away the benchmarked calls
+static volatile UInt64 sink = 0;
+
+static char* source =
+    "func fib(n: Int) -> Int { if n < 2 { return n } return fib(n - 1) + fib(n - 2) }\n"
+    "func loops(n: Int) -> Int {\n"
+    "    put mutable s = 0\n"
+    "    loop i in 0..n { s = (s + i * 3 + (i >> 2)) % 1000003 }\n"
+    "    return s\n"
+    "}\n"
+    "func strings(n: Int) -> String {\n"
+    "    put mutable s = \"-\"\n"
+    "    loop i in 0..n { s = s + \"ab\" }\n"
+    "    return s\n"
+    "}\n"
+    "func floats(n: Int) -> Float32 {\n"
+    "    put mutable x = 0.0\n"
+    "    put mutable y = 0.0\n"
+    "    loop i in 0..n {\n"
+    "        put t = x * x - y * y - 0.75\n"
+    "        y = 2.0 * x * y + 0.1\n"
+    "        x = t\n"
+    "        if x * x + y * y > 4.0 { x = 0.0\n y = 0.0 }\n"
+    "    }\n"
+    "    return x + y\n"
+    "}\n";
+
+static Int32 c_fib(Int32 n) { return n < 2 ? n : c_fib(n - 1) + c_fib(n - 2); }
+
+static Int32 c_loops(Int32 n) {
+    Int32 s = 0;
+    for(Int32 i = 0; i < n; i++)
+        s = (s + i * 3 + (i >> 2)) % 1000003;
+    return s;
+}
+
+static UInt64 c_strings(Int32 n) {
+    char* s = cast(char*)malloc(2);
+    CORETEN_ENFORCE_NN(s, "Could not allocate memory. Memory full.");
+    memcpy(s, "-", 2);
+    UInt64 len = 1;
+    for(Int32 i = 0; i < n; i++) {
+        // A new string every time, like the VM (and the C backend) do
+        char* t = cast(char*)malloc(len + 3);
+        memcpy(t, s, len);
+        memcpy(t + len, "ab", 3);
+        free(s);
+        s = t;
+        len += 2;
+    }
+    free(s);
+    return len;
+}
+
+static float c_floats(Int32 n) {
+    float x = 0.0f, y = 0.0f;
+    for(Int32 i = 0; i < n; i++) {
+        float t = x * x - y * y - 0.75f;
+        y = 2.0f * x * y + 0.1f;
+        x = t;
+        if(x * x + y * y > 4.0f) { x = 0.0f; y = 0.0f; }
+    }
+    return x + y;
+}
+
+static UInt64 c_run(const char* name, Int32 n) {
+    switch(name[0]) {
+        case 'f': return name[1] == 'i' ? cast(UInt64)c_fib(n) : cast(UInt64)(c_floats(n) * 1000.0f);
+        case 'l': return cast(UInt64)c_loops(n);
+        default: return c_strings(n);
+    }
+}
+
+static void bench(Vm* vm, Comptime* ct, IrModule* module, const char* name, Int32 n, UInt64 iters) {
+    VmFunc* func = vm_func(vm, name);
+    CORETEN_ENFORCE_NN(func, "no such function");
+
+    double start = clock_monotonic();
+    for(UInt64 i = 0; i < iters; i++) {
+        VmValue args[1];
+        args[0].i = n;
+        CORETEN_ENFORCE(vm_call(vm, func, args, args));
+        sink += name[0] == 's' ? args[0].s->len : args[0].u;
+    }
+    double in_vm = clock_monotonic() - start;
+
+    double in_ct = 0.0;
+    if(strcmp(name, "fib") != 0) {
+        IrFunc* ir = *cast(IrFunc**)vec_at(module->funcs, func->symbol->unit);
+        start = clock_monotonic();
+        for(UInt64 i = 0; i < iters; i++) {
+            ComptimeValue args[1] = {0};
+            // Different arguments every time, so nothing is memoized
+            args[0].imm = cast(UInt64)n + i;
+            CORETEN_ENFORCE(comptime_call(ct, ir, args, &args[0]));
+        }
+        in_ct = clock_monotonic() - start;
+    }
+
+    start = clock_monotonic();
+    for(UInt64 i = 0; i < iters; i++)
+        sink += c_run(name, n);
+    double in_c = clock_monotonic() - start;
+
+    printf("%-8s n=%-9d vm: %9.3f ms   ", name, n, in_vm * 1e3 / cast(double)iters);
+    if(in_ct > 0.0)
+        printf("comptime: %9.3f ms (%5.1fx)   ", in_ct * 1e3 / cast(double)iters, in_ct / in_vm);
+    else
+        printf("%-31s", "comptime: -");
+    printf("C: %8.3f ms (vm is %5.1fx slower)\n", in_c * 1e3 / cast(double)iters, in_vm / in_c);
+}
+
+int main(int argc, char** argv) {
+    UInt64 scale = argc > 1 ? cast(UInt64)atoll(argv[1]) : 1;
+    if(scale == 0)
+        scale = 1;
+
+    Lexer* lexer = lexer_init(source, "bench.ad");
+    lexer_lex(lexer);
+    Parser* parser = parser_init(lexer);
+    parser_parse(parser);
+    Checker* checker = checker_new(1);
+    CORETEN_ENFORCE(checker_check(checker, &parser, 1) == 0);
+    IrModule* module = ir_lower(checker);
+    opt_module(module, null);
+
+    Vm* vm = vm_new();
+    CORETEN_ENFORCE(vm_load(vm, module) == 0);
+    CORETEN_ENFORCE(vm_init(vm));
+    Comptime* ct = comptime_new(module);
+    ct->max_steps = UINT64_MAX;
+    ct->max_memory = UINT64_MAX;
+
+    bench(vm, ct, module, "fib", 27, 5 * scale);
+    bench(vm, ct, module, "loops", 1 << 22, 5 * scale);
+    bench(vm, ct, module, "strings", 1 << 13, 5 * scale);
+    bench(vm, ct, module, "floats", 1 << 22, 5 * scale);
+    printf("GC: %" CORETEN_PRIu64 " collections, %" CORETEN_PRIu64 " strings freed\n", vm->num_collections,
+           vm->strings_freed);
+
+    comptime_free(ct);
+    vm_free(vm);
+    ir_module_free(module);
+    checker_free(checker);
+    parser_free(parser);
+    return cast(int)(sink & 0);
+}
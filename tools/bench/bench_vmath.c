@@ -0,0 +1,97 @@
+// Microbenchmark: element-wise math on float tensors (adorad/runtime/vmath.h), a libm loop vs the scalar kernels vs the
+// best vector kernels the CPU has.
+// Usage: bench_vmath [iterations-scale]
+#include <math.h>
+#include <adorad/adorad.h>
+
+// Prevents the compiler from optimizing away the benchmarked calls
+static volatile double sink = 0;
+
+static const char* names[] = { "sin", "cos", "tan", "exp", "log", "log2", "pow", "atan2" };
+
+static void libm_f32(TensorMath fn, Float32* dst, const Float32* a, const Float32* b, UInt64 n) {
+    for(UInt64 i = 0; i < n; i++) {
+        switch(fn) {
+            case TensorMathSin: dst[i] = sinf(a[i]); break;
+            case TensorMathCos: dst[i] = cosf(a[i]); break;
+            case TensorMathTan: dst[i] = tanf(a[i]); break;
+            case TensorMathExp: dst[i] = expf(a[i]); break;
+            case TensorMathLog: dst[i] = logf(a[i]); break;
+            case TensorMathLog2: dst[i] = log2f(a[i]); break;
+            case TensorMathPow: dst[i] = powf(a[i], b[i]); break;
+            default: dst[i] = atan2f(a[i], b[i]); break;
+        }
+    }
+}
+
+static void libm_f64(TensorMath fn, Float64* dst, const Float64* a, const Float64* b, UInt64 n) {
+    for(UInt64 i = 0; i < n; i++) {
+        switch(fn) {
+            case TensorMathSin: dst[i] = sin(a[i]); break;
+            case TensorMathCos: dst[i] = cos(a[i]); break;
+            case TensorMathTan: dst[i] = tan(a[i]); break;
+            case TensorMathExp: dst[i] = exp(a[i]); break;
+            case TensorMathLog: dst[i] = log(a[i]); break;
+            case TensorMathLog2: dst[i] = log2(a[i]); break;
+            case TensorMathPow: dst[i] = pow(a[i], b[i]); break;
+            default: dst[i] = atan2(a[i], b[i]); break;
+        }
+    }
+}
+
+#define BENCH(out, iters, expr)                                                 \
+    do {                                                                        \
+        double start = clock_monotonic();                                       \
+        for(UInt64 _i = 0; _i < (iters); _i++) {                                \
+            expr;                                                               \
+            sink += dst[_i % len];                                              \
+        }                                                                       \
+        out = clock_monotonic() - start;                                        \
+    } while(0)
+
+// The same three measurements for Float32s and Float64s
+#define BENCH_TYPE(SFX, T)                                                                                      \
+    do {                                                                                                        \
+        T* a = cast(T*)malloc(len * sizeof(T));                                                                 \
+        T* b = cast(T*)malloc(len * sizeof(T));                                                                 \
+        T* dst = cast(T*)malloc(len * sizeof(T));                                                               \
+        UInt64 seed = 42;                                                                                       \
+        for(UInt64 i = 0; i < len; i++) {                                                                       \
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;                                      \
+            a[i] = cast(T)(cast(double)(seed >> 11) * 0x1.0p-53 * 20.0 + 0.01);                                 \
+            b[i] = cast(T)(cast(double)(seed & 0xFFFF) / 0x1.0p16 * 8.0 - 4.0);                                 \
+        }                                                                                                       \
+        for(int fn = TensorMathSin; fn <= TensorMathAtan2; fn++) {                                              \
+            double libm, scalar, vector;                                                                        \
+            BENCH(libm, iters, libm_##SFX(cast(TensorMath)fn, dst, a, b, len));                                 \
+            tensor_set_isa(TensorIsaScalar);                                                                    \
+            BENCH(scalar, iters, vmath_##SFX(cast(TensorMath)fn, dst, a, b, len));                              \
+            tensor_set_isa(best);                                                                               \
+            BENCH(vector, iters, vmath_##SFX(cast(TensorMath)fn, dst, a, b, len));                              \
+            double elems = cast(double)len * cast(double)iters;                                                 \
+            printf("%-5s %-7s libm: %7.1f Melem/s   scalar: %7.1f Melem/s (%.2fx)   vector: %7.1f Melem/s "    \
+                   "(%.2fx)\n", names[fn], #T, elems / libm * 1e-6, elems / scalar * 1e-6, libm / scalar,        \
+                   elems / vector * 1e-6, libm / vector);                                                       \
+        }                                                                                                       \
+        free(a);                                                                                                \
+        free(b);                                                                                                \
+        free(dst);                                                                                              \
+    } while(0)
+
+int main(int argc, char** argv) {
+    UInt64 scale = argc > 1 ? cast(UInt64)atoll(argv[1]) : 1;
+    if(scale == 0)
+        scale = 1;
+
+    // The kernels `tensor_isa()` picks (the best ones the CPU has)
+    TensorIsa best = tensor_isa();
+    static const char* isa_names[] = { "scalar", "AVX2", "AVX-512" };
+    printf("Vector kernels: %s\n", isa_names[best]);
+
+    // Fits in L2, so that this measures the kernels and not memory
+    UInt64 len = 4096;
+    UInt64 iters = scale * 1000;
+    BENCH_TYPE(f32, Float32);
+    BENCH_TYPE(f64, Float64);
+    return 0;
+}
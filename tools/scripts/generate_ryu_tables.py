@@ -0,0 +1,107 @@
+# Generates the powers of 5 that the shortest float formatting (Ryu) multiplies by:
+#   adorad/runtime/format_tables.h
+#
+# Every entry is a 125-bit fixed-point number, split into two 64-bit words ({low, high}):
+#   format_pow5_split[i]      ->  5^i, shifted so it's exactly FORMAT_POW5_BITCOUNT bits long (rounded down)
+#   format_pow5_inv_split[i]  ->  2^(bits(5^i) - 1 + FORMAT_POW5_INV_BITCOUNT) / 5^i, rounded up
+# `bits(x)` is the length of `x` in bits. The sizes cover every exponent of a `Float64` (and so of a `Float32`).
+# See "Ryu: Fast Float-to-String Conversion" (Adams, PLDI 2018), section 3.
+#
+# Usage:
+#   python3 tools/scripts/generate_ryu_tables.py
+
+OUTFILE = 'adorad/runtime/format_tables.h'
+POW5_BITCOUNT = 125
+POW5_INV_BITCOUNT = 125
+POW5_TABLE_SIZE = 326
+POW5_INV_TABLE_SIZE = 342
+
+MASK64 = (1 << 64) - 1
+
+
+def pow5_split(i):
+    pow5 = 5 ** i
+    shift = pow5.bit_length() - POW5_BITCOUNT
+    return pow5 >> shift if shift >= 0 else pow5 << -shift
+
+
+def pow5_inv_split(i):
+    pow5 = 5 ** i
+    shift = pow5.bit_length() - 1 + POW5_INV_BITCOUNT
+    return (1 << shift) // pow5 + 1
+
+
+header_template = """\
+/*
+          _____   ____  _____            _____
+    /\\   |  __ \\ / __ \\|  __ \\     /\\   |  __ \\
+   /  \\  | |  | | |  | | |__) |   /  \\  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\\ \\ | |  | | |  | |  _  /   / /\\ \\ | |  | | Languages: C, C++, and Assembly
+ / ____ \\| |__| | |__| | | \\ \\  / ____ \\| |__| | https://github.com/adorad/adorad/
+/_/    \\_\\_____/ \\____/|_|  \\_\\/_/    \\_\\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+// Auto-generated by tools/scripts/generate_ryu_tables.py. DO NOT EDIT.
+
+#ifndef ADORAD_FORMAT_TABLES_H
+#define ADORAD_FORMAT_TABLES_H
+
+#define FORMAT_POW5_BITCOUNT        %(bitcount)d
+#define FORMAT_POW5_INV_BITCOUNT    %(inv_bitcount)d
+
+// 5^i in %(bitcount)d bits: {low, high}
+static const UInt64 format_pow5_split[%(nsplit)d][2] = {
+%(split)s
+};
+
+// The inverse of 5^i in %(inv_bitcount)d bits: {low, high}
+static const UInt64 format_pow5_inv_split[%(ninv)d][2] = {
+%(inv)s
+};
+
+#endif // ADORAD_FORMAT_TABLES_H
+"""
+
+
+def update_file(file, content):
+    try:
+        with open(file, 'r') as fobj:
+            if fobj.read() == content:
+                return False
+
+    except (OSError, ValueError):
+        pass
+
+    with open(file, 'w') as fobj:
+        fobj.write(content)
+    return True
+
+
+def table_lines(values):
+    return '\n'.join('    {0x%016XULL, 0x%016XULL},' % (x & MASK64, x >> 64) for x in values)
+
+
+def main():
+    split = [pow5_split(i) for i in range(POW5_TABLE_SIZE)]
+    inv = [pow5_inv_split(i) for i in range(POW5_INV_TABLE_SIZE)]
+    assert all(x >> 128 == 0 for x in split + inv)
+
+    content = header_template % {
+        'bitcount': POW5_BITCOUNT,
+        'inv_bitcount': POW5_INV_BITCOUNT,
+        'nsplit': len(split),
+        'split': table_lines(split),
+        'ninv': len(inv),
+        'inv': table_lines(inv),
+    }
+
+    if update_file(OUTFILE, content):
+        print("%s regenerated (%d bytes of tables)" % (OUTFILE, (len(split) + len(inv)) * 16))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,191 @@
+# Generates the compact identifier-property tables used by the Lexer:
+#   adorad/core/utf8_xid.h
+#
+# The tables answer exactly one question - is a codepoint XID_Start / XID_Continue (UAX #31)? - so they're a small
+# fraction of the size of the full per-codepoint records in `utf8_data.h`/`utf8_properties.h`.
+#
+# Layout (two stages):
+#   utf8_xid_stage1[cp >> 7]  ->  index of a 128-codepoint block
+#   utf8_xid_stage2[block]    ->  4 x UInt64: the XID_Start bitset (2 words), then the XID_Continue bitset (2 words)
+# Identical blocks are shared, which is what keeps the tables small.
+#
+# Usage:
+#   python3 tools/scripts/generate_xid_tables.py [path/to/DerivedCoreProperties.txt]
+# Without an argument, the properties are taken from the Python interpreter's Unicode database.
+
+import sys
+
+OUTFILE = 'adorad/core/utf8_xid.h'
+MAX_CODEPOINT = 0x10FFFF
+BLOCK_SHIFT = 7
+BLOCK_SIZE = 1 << BLOCK_SHIFT
+
+
+def load_from_ucd(path):
+    xid_start = set()
+    xid_continue = set()
+
+    with open(path, encoding='utf-8') as fp:
+        for line in fp:
+            line = line.split('#', 1)[0].strip()
+            if not line:
+                continue
+
+            fields = [f.strip() for f in line.split(';')]
+            if fields[1] not in ('XID_Start', 'XID_Continue'):
+                continue
+
+            if '..' in fields[0]:
+                lo, hi = (int(x, 16) for x in fields[0].split('..'))
+            else:
+                lo = hi = int(fields[0], 16)
+
+            target = xid_start if fields[1] == 'XID_Start' else xid_continue
+            target.update(range(lo, hi + 1))
+
+    return xid_start, xid_continue, 'DerivedCoreProperties.txt'
+
+
+def load_from_python():
+    import unicodedata
+
+    # `str.isidentifier()` implements UAX #31 (XID_Start followed by XID_Continue), plus `_` as a start character
+    xid_start = set()
+    xid_continue = set()
+    for cp in range(MAX_CODEPOINT + 1):
+        if 0xD800 <= cp <= 0xDFFF:
+            continue
+
+        ch = chr(cp)
+        if ch != '_' and ch.isidentifier():
+            xid_start.add(cp)
+        if ('a' + ch).isidentifier():
+            xid_continue.add(cp)
+
+    return xid_start, xid_continue, 'Unicode %s' % unicodedata.unidata_version
+
+
+def build_tables(xid_start, xid_continue):
+    # Stage 1 only needs to cover up to the last block with a set bit. The (few) XID_Continue codepoints above
+    # that - variation selectors in Plane 14 - are checked as a range instead.
+    high = sorted(cp for cp in xid_continue if cp >= 0xE0000)
+    low_max = max(cp for cp in (xid_start | xid_continue) if cp < 0xE0000)
+    assert not [cp for cp in xid_start if cp >= 0xE0000]
+    assert high == list(range(min(high), max(high) + 1)) if high else True
+
+    nblocks = (low_max >> BLOCK_SHIFT) + 1
+    blocks = {}
+    stage1 = []
+    stage2 = []
+
+    for b in range(nblocks):
+        words = []
+        for prop in (xid_start, xid_continue):
+            for half in range(2):
+                word = 0
+                base = b * BLOCK_SIZE + half * 64
+                for bit in range(64):
+                    if base + bit in prop:
+                        word |= 1 << bit
+                words.append(word)
+
+        key = tuple(words)
+        if key not in blocks:
+            blocks[key] = len(stage2)
+            stage2.append(key)
+        stage1.append(blocks[key])
+
+    assert len(stage2) <= 256, 'stage 1 entries no longer fit in a byte'
+    return stage1, stage2, (min(high), max(high)) if high else (1, 0)
+
+
+header_template = """\
+/*
+          _____   ____  _____            _____
+    /\\   |  __ \\ / __ \\|  __ \\     /\\   |  __ \\
+   /  \\  | |  | | |  | | |__) |   /  \\  | |  | | Adorad - The Fast, Expressive & Elegant Programming Language
+  / /\\ \\ | |  | | |  | |  _  /   / /\\ \\ | |  | | Languages: C, C++, and Assembly
+ / ____ \\| |__| | |__| | | \\ \\  / ____ \\| |__| | https://github.com/adorad/adorad/
+/_/    \\_\\_____/ \\____/|_|  \\_\\/_/    \\_\\_____/
+
+Licensed under the MIT License <http://opensource.org/licenses/MIT>
+SPDX-License-Identifier: MIT
+Copyright (c) 2021-22 Jason Dsouza <@jasmcaus>
+*/
+
+// Auto-generated by tools/scripts/generate_xid_tables.py from %(source)s. DO NOT EDIT.
+
+#ifndef CORETEN_UTF8_XID_H
+#define CORETEN_UTF8_XID_H
+
+// Codepoints at or above this have neither property (except for the range below)
+#define UTF8_XID_STAGE1_LIMIT       0x%(limit)X
+// XID_Continue-only range above UTF8_XID_STAGE1_LIMIT (variation selectors)
+#define UTF8_XID_CONTINUE_HIGH_LO   0x%(high_lo)X
+#define UTF8_XID_CONTINUE_HIGH_HI   0x%(high_hi)X
+
+// %(nstage1)d bytes: index of the %(block_size)d-codepoint block in `utf8_xid_stage2`
+static const UInt8 utf8_xid_stage1[%(nstage1)d] = {
+%(stage1)s
+};
+
+// %(nstage2)d blocks x 32 bytes: {XID_Start[2], XID_Continue[2]}
+static const UInt64 utf8_xid_stage2[%(nstage2)d][4] = {
+%(stage2)s
+};
+
+#endif // CORETEN_UTF8_XID_H
+"""
+
+
+def update_file(file, content):
+    try:
+        with open(file, 'r') as fobj:
+            if fobj.read() == content:
+                return False
+
+    except (OSError, ValueError):
+        pass
+
+    with open(file, 'w') as fobj:
+        fobj.write(content)
+    return True
+
+
+def make_xid_header(xid_start, xid_continue, source, outfile=OUTFILE):
+    stage1, stage2, (high_lo, high_hi) = build_tables(xid_start, xid_continue)
+
+    stage1_lines = []
+    for i in range(0, len(stage1), 24):
+        stage1_lines.append('    ' + ', '.join('%d' % x for x in stage1[i:i + 24]) + ',')
+
+    stage2_lines = []
+    for words in stage2:
+        stage2_lines.append('    {' + ', '.join('0x%016XULL' % w for w in words) + '},')
+
+    content = header_template % {
+        'source': source,
+        'limit': len(stage1) << BLOCK_SHIFT,
+        'high_lo': high_lo,
+        'high_hi': high_hi,
+        'nstage1': len(stage1),
+        'block_size': BLOCK_SIZE,
+        'nstage2': len(stage2),
+        'stage1': '\n'.join(stage1_lines),
+        'stage2': '\n'.join(stage2_lines),
+    }
+
+    if update_file(outfile, content):
+        print("%s regenerated from %s (%d bytes of tables)" % (outfile, source, len(stage1) + len(stage2) * 32))
+
+
+def main(args):
+    if args:
+        xid_start, xid_continue, source = load_from_ucd(args[0])
+    else:
+        xid_start, xid_continue, source = load_from_python()
+    make_xid_header(xid_start, xid_continue, source)
+
+
+if __name__ == '__main__':
+    main(sys.argv[1:])